@@ -0,0 +1,254 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "backend/bulk_load_pipeline.h"
+
+#include <algorithm>
+
+#include "core/sql_utils.h"
+
+namespace scratchrobin::backend {
+
+BulkLoadPipeline::BulkLoadPipeline(std::unique_ptr<BulkLoadSession> session, Options options)
+    : session_(std::move(session)), options_(std::move(options)) {
+  options_.queue_depth = std::max<std::size_t>(1, options_.queue_depth);
+  options_.max_rows_per_statement = std::max<std::size_t>(1, options_.max_rows_per_statement);
+  prefix_ = "INSERT INTO " + options_.table;
+  if (!options_.columns.empty() && !options_.columns.front().name.empty()) {
+    prefix_ += " (";
+    for (std::size_t i = 0; i < options_.columns.size(); ++i) {
+      prefix_ += (i ? ", " : "") + options_.columns[i].name;
+    }
+    prefix_ += ")";
+  }
+  prefix_ += " VALUES ";
+}
+
+BulkLoadPipeline::~BulkLoadPipeline() {
+  if (sender_.joinable()) {
+    Abort();
+  }
+}
+
+core::Status BulkLoadPipeline::Start() {
+  if (options_.use_transaction) {
+    core::Status begun = session_->BeginTransaction();
+    if (!begun.ok) {
+      return core::Status::Error("Cannot start transaction: " + begun.message);
+    }
+    in_transaction_ = true;
+  }
+  if (!options_.setup_sql.empty()) {
+    core::Status setup = session_->Execute(options_.setup_sql);
+    if (!setup.ok) {
+      if (in_transaction_) {
+        session_->Rollback();
+        in_transaction_ = false;
+      }
+      return core::Status::Error("Bulk load setup failed: " + setup.message);
+    }
+  }
+  sender_ = std::thread([this] { Send(); });
+  return core::Status::Ok();
+}
+
+core::Status BulkLoadPipeline::Add(const core::ResultSet& rows, std::int64_t first_row) {
+  const std::size_t count = rows.RowCount();
+  for (std::size_t row = 0; row < count; ++row) {
+    if (pending_.rows.empty()) {
+      pending_.sql.reserve(options_.target_packet_bytes + options_.target_packet_bytes / 8);
+      pending_.sql.assign(prefix_);
+    } else {
+      pending_.sql += ", ";
+    }
+    pending_.offsets.push_back(pending_.sql.size());
+    pending_.rows.push_back(first_row + static_cast<std::int64_t>(row));
+    pending_.sql.push_back('(');
+    for (std::size_t i = 0; i < options_.columns.size(); ++i) {
+      if (i) {
+        pending_.sql += ", ";
+      }
+      const auto& column = options_.columns[i];
+      const core::ColumnBuffer& buffer = rows.Column(column.source);
+      if (column.default_literal && buffer.IsNull(row)) {
+        pending_.sql += *column.default_literal;
+      } else {
+        core::appendSqlLiteral(buffer, row, pending_.sql);
+      }
+    }
+    pending_.sql.push_back(')');
+    if (pending_.sql.size() >= options_.target_packet_bytes ||
+        pending_.rows.size() >= options_.max_rows_per_statement) {
+      core::Status pushed = Push();
+      if (!pushed.ok) {
+        return pushed;
+      }
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  return status_;
+}
+
+core::Status BulkLoadPipeline::Finish(Report* report) {
+  core::Status status = pending_.rows.empty() ? core::Status::Ok() : Push();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closing_ = true;
+  }
+  not_empty_.notify_all();
+  if (sender_.joinable()) {
+    sender_.join();
+  }
+  if (status.ok) {
+    status = status_;
+  }
+  if (in_transaction_) {
+    in_transaction_ = false;
+    if (status.ok) {
+      core::Status committed = session_->Commit();
+      if (!committed.ok) {
+        status = core::Status::Error("Commit failed: " + committed.message);
+      }
+    } else {
+      session_->Rollback();
+    }
+  }
+  if (report) {
+    *report = std::move(report_);
+  }
+  return status;
+}
+
+void BulkLoadPipeline::Abort() {
+  Fail(core::Status::Error("Bulk load aborted"));
+  if (session_->IsConnected()) {
+    session_->Cancel();
+  }
+  if (sender_.joinable()) {
+    sender_.join();
+  }
+  if (in_transaction_ && session_->IsConnected()) {
+    session_->Rollback();
+  }
+  in_transaction_ = false;
+}
+
+core::Status BulkLoadPipeline::Push() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_full_.wait(lock, [&] { return failed_ || queue_.size() < options_.queue_depth; });
+  if (failed_) {
+    pending_ = Statement{};
+    return status_;
+  }
+  queue_.push_back(std::move(pending_));
+  pending_ = Statement{};
+  lock.unlock();
+  not_empty_.notify_one();
+  return core::Status::Ok();
+}
+
+void BulkLoadPipeline::Fail(core::Status status) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!failed_) {
+      failed_ = true;
+      status_ = std::move(status);
+    }
+    queue_.clear();
+  }
+  not_full_.notify_all();
+  not_empty_.notify_all();
+}
+
+bool BulkLoadPipeline::Failed() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return failed_;
+}
+
+// Send stage
+void BulkLoadPipeline::Send() {
+  for (;;) {
+    Statement statement;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_empty_.wait(lock, [&] { return failed_ || closing_ || !queue_.empty(); });
+      if (failed_ || queue_.empty()) {
+        return;
+      }
+      statement = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    not_full_.notify_one();
+    Load(statement, 0, statement.rows.size());
+  }
+}
+
+void BulkLoadPipeline::Load(const Statement& statement, std::size_t begin, std::size_t end) {
+  std::string error;
+  ++report_.statements;
+  if (Execute(statement, begin, end, &error)) {
+    report_.rows_loaded += static_cast<std::int64_t>(end - begin);
+    rows_since_commit_ += static_cast<std::int64_t>(end - begin);
+    MaybeCommit();
+    return;
+  }
+  if (!session_->IsConnected()) {
+    Fail(core::Status::Error("Connection lost during bulk load: " + error));
+    return;
+  }
+  if (options_.stop_on_error) {
+    Fail(core::Status::Error("Rows " + std::to_string(statement.rows[begin]) + "-" +
+                             std::to_string(statement.rows[end - 1]) + ": " + error));
+    return;
+  }
+  if (end - begin == 1) {
+    ++report_.rows_failed;
+    report_.errors.push_back({statement.rows[begin], error});
+    return;
+  }
+  const std::size_t middle = begin + (end - begin) / 2;
+  Load(statement, begin, middle);
+  if (!Failed()) {
+    Load(statement, middle, end);
+  }
+}
+
+bool BulkLoadPipeline::Execute(const Statement& statement, std::size_t begin, std::size_t end,
+                               std::string* error) {
+  const std::string* sql = &statement.sql;
+  if (begin != 0 || end != statement.rows.size()) {
+    const std::size_t from = statement.offsets[begin];
+    const std::size_t to =
+        end < statement.rows.size() ? statement.offsets[end] - 2 : statement.sql.size();
+    retry_sql_.assign(prefix_);
+    retry_sql_.append(statement.sql, from, to - from);
+    sql = &retry_sql_;
+  }
+  core::Status status = session_->Execute(*sql);
+  if (!status.ok) {
+    *error = status.message;
+    return false;
+  }
+  return true;
+}
+
+void BulkLoadPipeline::MaybeCommit() {
+  if (!in_transaction_ || options_.commit_every_rows <= 0 ||
+      rows_since_commit_ < options_.commit_every_rows) {
+    return;
+  }
+  rows_since_commit_ = 0;
+  core::Status status = session_->Commit();
+  if (status.ok) {
+    status = session_->BeginTransaction();
+  }
+  if (!status.ok) {
+    in_transaction_ = false;
+    Fail(core::Status::Error("Commit failed: " + status.message));
+  }
+}
+
+}  // namespace scratchrobin::backend
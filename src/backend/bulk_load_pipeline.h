@@ -0,0 +1,113 @@
+/*
+ * ScratchBird
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ * https://www.firebirdsql.org/en/initial-developer-s-public-license-version-1-0/
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "backend/scratchbird_sbwp_client.h"
+#include "core/result_set.h"
+#include "core/status.h"
+
+namespace scratchrobin::backend {
+
+// The session calls a bulk load makes; ScratchbirdSbwpClient adapts its
+// driver connection. Errors carry the server's message.
+class BulkLoadSession {
+ public:
+  virtual ~BulkLoadSession() = default;
+
+  virtual core::Status Execute(const std::string& sql) = 0;
+  virtual core::Status BeginTransaction() = 0;
+  virtual core::Status Commit() = 0;
+  virtual void Rollback() = 0;
+  // Interrupts the running statement; called from another thread
+  virtual void Cancel() = 0;
+  virtual bool IsConnected() const = 0;
+};
+
+/**
+ * BulkLoadPipeline - convert and send stages of a bulk load
+ *
+ * The caller's thread renders rows into multi-row INSERT statements and
+ * queues them; the sender thread owns the session until the load ends
+ * and runs them in order. The queue is bounded, so a slow server pushes
+ * back on the converter instead of letting statements pile up.
+ *
+ * A rejected statement is bisected and the halves retried, isolating each
+ * bad row in about 2*log2(rows) extra statements. This relies on the
+ * server undoing a failed statement without aborting the transaction.
+ */
+class BulkLoadPipeline {
+ public:
+  using Options = ScratchbirdSbwpClient::BulkLoadOptions;
+  using Report = ScratchbirdSbwpClient::BulkLoadReport;
+
+  BulkLoadPipeline(std::unique_ptr<BulkLoadSession> session, Options options);
+  ~BulkLoadPipeline();
+
+  BulkLoadPipeline(const BulkLoadPipeline&) = delete;
+  BulkLoadPipeline& operator=(const BulkLoadPipeline&) = delete;
+
+  // Opens the transaction, runs setup_sql and starts the sender
+  core::Status Start();
+  // Convert stage: renders each row as a tuple of the pending statement
+  // and queues the statement once it reaches the packet or row limit.
+  // Blocks while queue_depth statements wait for the sender.
+  core::Status Add(const core::ResultSet& rows, std::int64_t first_row);
+  // Flushes, waits for the sender and commits; |report| may be null
+  core::Status Finish(Report* report);
+  // Drops queued statements and rolls back what was not yet committed
+  void Abort();
+
+ private:
+  struct Statement {
+    std::string sql;
+    std::vector<std::size_t> offsets;  // Start of each tuple in sql
+    std::vector<std::int64_t> rows;    // Row number of each tuple
+  };
+
+  core::Status Push();
+  void Fail(core::Status status);
+  bool Failed();
+  void Send();
+  void Load(const Statement& statement, std::size_t begin, std::size_t end);
+  bool Execute(const Statement& statement, std::size_t begin, std::size_t end,
+               std::string* error);
+  void MaybeCommit();
+
+  std::unique_ptr<BulkLoadSession> session_;
+  Options options_;
+  std::string prefix_;
+  Statement pending_;      // Convert stage only
+  std::string retry_sql_;  // Send stage only
+  Report report_;          // Send stage; read after the join
+  std::int64_t rows_since_commit_{0};
+  bool in_transaction_{false};
+  std::thread sender_;
+
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<Statement> queue_;
+  bool closing_{false};
+  bool failed_{false};
+  core::Status status_{core::Status::Ok()};
+};
+
+}  // namespace scratchrobin::backend
@@ -15,7 +15,7 @@ QueryResponse NativeAdapterGateway::SubmitSql(const std::uint16_t port,
   // Compile with runtime config if available
   CompileOutput compile_output;
   if (runtime_config_.has_value()) {
-    compile_output = compiler_->CompileSqlToSblr(sql, runtime_config_.value());
+    compile_output = compiler_->CompileSqlToSblr(sql, runtime_config_.value(), dialect);
   } else {
     compile_output = compiler_->CompileSqlToSblr(sql);
   }
@@ -3,6 +3,9 @@
 #include <chrono>
 #include <QtCore/QtGlobal>
 
+#include "backend/query_router.h"
+#include "core/sql_utils.h"
+
 // ScratchBird SBLR v3 Compiler integration (when available)
 #if defined(SCRATCHROBIN_WITH_SBLR_COMPILER)
 #include <scratchbird/sblr/query_compiler_v3.h>
@@ -11,82 +14,114 @@
 
 namespace scratchrobin::backend {
 
+namespace {
+
+// Separates the SQL from the compile context in cache keys; neither
+// normalized SQL nor configuration values contain it.
+constexpr char kKeySeparator = '\x1f';
+
+}  // namespace
+
+NativeParserCompiler::NativeParserCompiler()
+    : cache_(std::make_shared<SblrCompileCache>()) {}
+
+NativeParserCompiler::NativeParserCompiler(std::shared_ptr<SblrCompileCache> cache)
+    : cache_(std::move(cache)) {}
+
+void NativeParserCompiler::SetCompileCache(std::shared_ptr<SblrCompileCache> cache) {
+  cache_ = std::move(cache);
+}
+
+void NativeParserCompiler::InvalidateCompileCache() const {
+  if (cache_) {
+    cache_->Invalidate();
+  }
+}
+
+const char* NativeParserCompiler::CompilerVersion() {
+#if defined(SCRATCHROBIN_WITH_SBLR_COMPILER)
+  return "v3";
+#else
+  return "placeholder_v1";
+#endif
+}
+
 CompileOutput NativeParserCompiler::CompileSqlToSblr(const std::string& sql) const {
+  return Compile(sql, std::string(), false);
+}
+
+CompileOutput NativeParserCompiler::CompileSqlToSblr(
+    const std::string& sql,
+    const ScratchbirdRuntimeConfig& config,
+    const std::string& dialect) const {
+  // The same text can bind to different objects per server, database and
+  // search path, and a server upgrade can change what it compiles to. The
+  // cache outlives the session on disk, so the server is part of the key.
+  std::string context_key = ToString(config.mode);
+  context_key += kKeySeparator;
+  context_key += config.host;
+  context_key += ':';
+  context_key += std::to_string(config.port);
+  context_key += kKeySeparator;
+  context_key += config.socket_path;
+  context_key += kKeySeparator;
+  context_key += config.server_version;
+  context_key += kKeySeparator;
+  context_key += config.database;
+  context_key += kKeySeparator;
+  context_key += dialect;
+  context_key += kKeySeparator;
+  context_key += config.search_path;
+  return Compile(sql, context_key, true);
+}
+
+CompileOutput NativeParserCompiler::Compile(const std::string& sql,
+                                            const std::string& context_key,
+                                            bool allow_context_fallback) const {
   if (sql.empty()) {
     return {core::Status::Error("SQL input is empty"), {}};
   }
-
-#if defined(SCRATCHROBIN_WITH_SBLR_COMPILER)
-  // REAL IMPLEMENTATION: Use ScratchBird's v3 QueryCompiler
-  scratchbird::sblr::QueryCompilerV3 compiler;
-  compiler.setStatsEnabled(true);
   
-  auto result = compiler.compile(sql);
-  
-  if (!result.success()) {
-    std::string error_msg = "SBLR compilation failed:";
-    for (const auto& err : result.errors()) {
-      error_msg += "\n  - " + err;
+  // DDL changes what cached plans refer to, and is not worth caching itself
+  const bool is_ddl = QueryRouter::isDdl(QueryRouter::classifyQuery(sql));
+  if (!cache_ || is_ddl) {
+    if (is_ddl) {
+      InvalidateCompileCache();
     }
-    return {core::Status::Error(error_msg), {}};
+    auto output = CompileUncached(sql, allow_context_fallback);
+    output.bytecode.metadata["cache"] = "bypass";
+    return output;
   }
   
-  // Convert bytecode vector to string payload
-  const auto& bytecode = result.bytecode();
-  std::string payload_body(bytecode.begin(), bytecode.end());
-  
-  core::QueryPayload payload;
-  payload.type = core::QueryPayloadType::kSblrBytecode;
-  payload.body = payload_body;
-  
-  // Add compilation metadata
-  const auto& stats = result.stats();
-  payload.metadata["bytecode_size"] = std::to_string(stats.bytecode_size);
-  payload.metadata["parser_time_us"] = std::to_string(stats.parser_time.count());
-  payload.metadata["compiler_version"] = "v3";
-  
-  return {core::Status::Ok(), payload};
-#else
-  // FALLBACK: Structured placeholder implementation
-  // This maintains the same interface but doesn't require full ScratchBird libs
-  
-  auto start = std::chrono::steady_clock::now();
-  
-  // Create a structured "pseudo-bytecode" that includes metadata
-  // Format: SBv1|<sql_length>|<sql>|<timestamp>
-  std::string pseudo_bytecode = "SBv1|";
-  pseudo_bytecode += std::to_string(sql.size()) + "|";
-  pseudo_bytecode += sql;
-  pseudo_bytecode += "|";
-  pseudo_bytecode += std::to_string(
-    std::chrono::duration_cast<std::chrono::nanoseconds>(
-      std::chrono::steady_clock::now().time_since_epoch()).count());
-  
-  auto end = std::chrono::steady_clock::now();
-  auto parser_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-  
-  core::QueryPayload payload;
-  payload.type = core::QueryPayloadType::kSblrBytecode;
-  payload.body = pseudo_bytecode;
-  
-  // Add metadata (same as real implementation)
-  payload.metadata["bytecode_size"] = std::to_string(pseudo_bytecode.size());
-  payload.metadata["parser_time_us"] = std::to_string(parser_time.count());
-  payload.metadata["compiler_version"] = "placeholder_v1";
-  payload.metadata["note"] = "Full SBLR compiler not linked - using placeholder";
+  std::string key = core::normalizeStatementText(sql);
+  key += kKeySeparator;
+  key += context_key;
+  
+  auto annotate = [this](core::QueryPayload& payload, const char* outcome) {
+    const auto stats = cache_->GetStats();
+    payload.metadata["cache"] = outcome;
+    payload.metadata["cache_hits"] = std::to_string(stats.hits);
+    payload.metadata["cache_misses"] = std::to_string(stats.misses);
+  };
+  
+  if (auto cached = cache_->Lookup(key)) {
+    CompileOutput output{core::Status::Ok(), std::move(*cached)};
+    annotate(output.bytecode, "hit");
+    return output;
+  }
   
-  return {core::Status::Ok(), payload};
-#endif
+  auto output = CompileUncached(sql, allow_context_fallback);
+  if (output.status.ok) {
+    cache_->Insert(key, output.bytecode);
+  }
+  annotate(output.bytecode, "miss");
+  return output;
 }
 
-CompileOutput NativeParserCompiler::CompileSqlToSblr(
-    const std::string& sql,
-    const ScratchbirdRuntimeConfig& config) const {
-  // Use the runtime config to compile with proper database context
-  Q_UNUSED(config)
-  
+CompileOutput NativeParserCompiler::CompileUncached(const std::string& sql,
+                                                    bool allow_context_fallback) const {
 #if defined(SCRATCHROBIN_WITH_SBLR_COMPILER)
-  // Try to compile with real compiler first
+  // REAL IMPLEMENTATION: Use ScratchBird's v3 QueryCompiler
   scratchbird::sblr::QueryCompilerV3 compiler;
   compiler.setStatsEnabled(true);
   
@@ -105,29 +140,33 @@ CompileOutput NativeParserCompiler::CompileSqlToSblr(
     const auto& stats = result.stats();
     payload.metadata["bytecode_size"] = std::to_string(stats.bytecode_size);
     payload.metadata["parser_time_us"] = std::to_string(stats.parser_time.count());
-    payload.metadata["compiler_version"] = "v3";
+    payload.metadata["compiler_version"] = CompilerVersion();
     
     return {core::Status::Ok(), payload};
   }
   
-  // Check if error is due to missing database context
-  // In that case, fall back to placeholder implementation
+  // With a runtime config, a missing database context falls back to the
+  // placeholder below; any other error is reported.
+  bool missing_context = false;
   for (const auto& err : result.errors()) {
     if (err.find("Database context is required") != std::string::npos ||
         err.find("database connection") != std::string::npos ||
         err.find("context is required") != std::string::npos) {
-      // Fall through to placeholder implementation below
+      missing_context = true;
       break;
     }
-    // For other errors, return the error
+  }
+  if (!allow_context_fallback || !missing_context) {
     std::string error_msg = "SBLR compilation failed:";
-    for (const auto& e : result.errors()) {
-      error_msg += "\n  - " + e;
+    for (const auto& err : result.errors()) {
+      error_msg += "\n  - " + err;
     }
     return {core::Status::Error(error_msg), {}};
   }
   
   // FALLTHROUGH: Use placeholder implementation when database context is not available
+#else
+  Q_UNUSED(allow_context_fallback)
 #endif
   
   // FALLBACK: Structured placeholder implementation
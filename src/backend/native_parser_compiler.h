@@ -1,10 +1,12 @@
 #pragma once
 
+#include <memory>
 #include <sstream>
 #include <string>
 
 #include "core/query_payload.h"
 #include "core/status.h"
+#include "backend/sblr_compile_cache.h"
 #include "backend/scratchbird_runtime_config.h"
 
 namespace scratchrobin::backend {
@@ -20,9 +22,17 @@ struct CompileOutput {
  * Integrates ScratchBird's QueryCompilerV3 to perform real SQL parsing
  * and SBLR bytecode generation. Replaces the previous placeholder
  * implementation that just prefixed SQL with "SBLR:".
+ *
+ * Compiled payloads are cached by normalized SQL and compile context
+ * (server address and version, database, dialect, search path). DDL is never cached and invalidates
+ * the cache. Every payload reports cache, cache_hits and cache_misses in
+ * its metadata.
  */
 class NativeParserCompiler {
  public:
+  NativeParserCompiler();
+  explicit NativeParserCompiler(std::shared_ptr<SblrCompileCache> cache);
+
   /**
    * Compile SQL to SBLR bytecode
    * @param sql The SQL statement to compile
@@ -34,10 +44,12 @@ class NativeParserCompiler {
    * Compile SQL to SBLR bytecode with runtime configuration
    * @param sql The SQL statement to compile
    * @param config Runtime configuration (database, host, etc.)
+   * @param dialect Parser dialect the SQL was submitted under
    * @return CompileOutput with status and bytecode payload
    */
   CompileOutput CompileSqlToSblr(const std::string& sql,
-                                 const ScratchbirdRuntimeConfig& config) const;
+                                 const ScratchbirdRuntimeConfig& config,
+                                 const std::string& dialect = {}) const;
   
   /**
    * Compile with trace/diagnostic output
@@ -47,6 +59,27 @@ class NativeParserCompiler {
    */
   CompileOutput CompileSqlToSblrWithTrace(const std::string& sql,
                                           std::string* trace_output) const;
+
+  /**
+   * Compile cache. Passing nullptr disables caching; the cache may be
+   * shared between compilers and with QueryRouter for DDL invalidation.
+   */
+  void SetCompileCache(std::shared_ptr<SblrCompileCache> cache);
+  std::shared_ptr<SblrCompileCache> CompileCache() const { return cache_; }
+  void InvalidateCompileCache() const;
+
+  /**
+   * Version tag written into payload metadata and cache files
+   */
+  static const char* CompilerVersion();
+
+ private:
+  CompileOutput Compile(const std::string& sql, const std::string& context_key,
+                        bool allow_context_fallback) const;
+  CompileOutput CompileUncached(const std::string& sql,
+                                bool allow_context_fallback) const;
+
+  std::shared_ptr<SblrCompileCache> cache_;
 };
 
 }  // namespace scratchrobin::backend
@@ -0,0 +1,87 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "backend/prepared_statement_cache.h"
+
+#include <algorithm>
+
+namespace scratchrobin::backend {
+
+PreparedStatementCache::PreparedStatementCache(size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1)) {}
+
+std::optional<PreparedStatementCache::Handle> PreparedStatementCache::find(
+    const std::string& key) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return std::nullopt;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->handle;
+}
+
+std::vector<PreparedStatementCache::Handle> PreparedStatementCache::insert(
+    const std::string& key, Handle handle) {
+  std::vector<Handle> evicted;
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    // Re-prepared under the same key; the old handle is no longer reachable
+    if (it->second->handle != handle) {
+      evicted.push_back(it->second->handle);
+    }
+    it->second->handle = handle;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return evicted;
+  }
+  
+  entries_.push_front(Entry{key, handle});
+  index_.emplace(key, entries_.begin());
+  auto overflow = evictOverflow();
+  evicted.insert(evicted.end(), overflow.begin(), overflow.end());
+  return evicted;
+}
+
+std::optional<PreparedStatementCache::Handle> PreparedStatementCache::erase(
+    const std::string& key) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return std::nullopt;
+  }
+  const Handle handle = it->second->handle;
+  entries_.erase(it->second);
+  index_.erase(it);
+  return handle;
+}
+
+std::vector<PreparedStatementCache::Handle> PreparedStatementCache::clear() {
+  std::vector<Handle> handles;
+  handles.reserve(entries_.size());
+  for (const auto& entry : entries_) {
+    handles.push_back(entry.handle);
+  }
+  entries_.clear();
+  index_.clear();
+  return handles;
+}
+
+std::vector<PreparedStatementCache::Handle> PreparedStatementCache::setCapacity(
+    size_t capacity) {
+  capacity_ = std::max<size_t>(capacity, 1);
+  return evictOverflow();
+}
+
+std::vector<PreparedStatementCache::Handle> PreparedStatementCache::evictOverflow() {
+  std::vector<Handle> evicted;
+  while (entries_.size() > capacity_) {
+    const Entry& victim = entries_.back();
+    evicted.push_back(victim.handle);
+    index_.erase(victim.key);
+    entries_.pop_back();
+  }
+  return evicted;
+}
+
+}  // namespace scratchrobin::backend
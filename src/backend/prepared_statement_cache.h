@@ -0,0 +1,74 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "backend/query_request.h"
+#include "backend/query_response.h"
+
+namespace scratchrobin::backend {
+
+// The server side of a PreparedStatementCache; ScratchbirdSbwpClient
+// implements it over its SBWP session. ExecutePrepared fails with the
+// execution path "sbwp::stale_statement" once the session that prepared
+// the handle is gone.
+class PreparedStatementSession {
+ public:
+  using Handle = std::uint64_t;
+
+  virtual ~PreparedStatementSession() = default;
+
+  virtual QueryResponse Prepare(const std::string& sql, Handle* handle) = 0;
+  virtual QueryResponse ExecutePrepared(Handle handle,
+                                        const std::vector<QueryParameter>& parameters) = 0;
+  virtual void ClosePrepared(Handle handle) = 0;
+};
+
+/**
+ * PreparedStatementCache - LRU map from normalized SQL to a server-side
+ * statement handle
+ *
+ * Owned by one session; not thread-safe. The cache never talks to the
+ * server itself: insert() and clear() return the handles that fell out so
+ * the caller can close them on the connection that prepared them.
+ */
+class PreparedStatementCache {
+ public:
+  using Handle = std::uint64_t;
+
+  explicit PreparedStatementCache(size_t capacity = 128);
+
+  std::optional<Handle> find(const std::string& key);
+  std::vector<Handle> insert(const std::string& key, Handle handle);
+  std::optional<Handle> erase(const std::string& key);
+  std::vector<Handle> clear();
+
+  size_t size() const { return entries_.size(); }
+  size_t capacity() const { return capacity_; }
+  std::vector<Handle> setCapacity(size_t capacity);
+
+ private:
+  struct Entry {
+    std::string key;
+    Handle handle;
+  };
+
+  std::vector<Handle> evictOverflow();
+
+  size_t capacity_;
+  std::list<Entry> entries_;  // Most recently used first
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace scratchrobin::backend
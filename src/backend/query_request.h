@@ -106,6 +106,7 @@ struct QueryRequest {
   // Execution control
   QueryFlags flags{QueryFlags::kNone};
   std::uint32_t timeout_ms{30000};
+  std::uint32_t fetch_rows{1000};  // Batch size when kStreaming is set
 
   // Metadata
   std::string client_info;
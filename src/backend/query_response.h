@@ -11,6 +11,7 @@ struct QueryResponse {
   core::Status status;
   core::ResultSet result_set;
   std::string execution_path;
+  bool has_more{false};  // Streaming: further batches can be fetched
 };
 
 }  // namespace scratchrobin::backend
@@ -7,12 +7,16 @@
 #include "backend/query_router.h"
 
 #include <algorithm>
-#include <cctype>
 #include <regex>
+#include <utility>
 
 #include "backend/scratchbird_connection.h"
+#include "backend/scratchbird_sbwp_client.h"
 #include "backend/session_client.h"
 #include "backend/scratchbird_runtime_config.h"
+#include "backend/sblr_compile_cache.h"
+#include "core/sql_lexer.h"
+#include "core/sql_utils.h"
 
 namespace scratchrobin::backend {
 
@@ -38,162 +42,118 @@ void QueryRouter::setDirectConnection(ScratchbirdConnection* connection) {
   direct_connection_ = connection;
 }
 
+void QueryRouter::setSbwpClient(ScratchbirdSbwpClient* client) {
+  sbwp_client_ = client;
+  setStatementSession(client);
+}
+
+void QueryRouter::setStatementSession(PreparedStatementSession* session) {
+  if (session != statement_session_) {
+    clearStatementCache();  // Handles belong to the previous session
+  }
+  statement_session_ = session;
+}
+
 void QueryRouter::setRuntimeConfig(const ScratchbirdRuntimeConfig* config) {
   runtime_config_ = config;
 }
 
+void QueryRouter::setCompileCache(SblrCompileCache* cache) {
+  compile_cache_ = cache;
+}
+
 // =============================================================================
 // Query Classification
 // =============================================================================
 
 QueryType QueryRouter::classifyQuery(const std::string& sql) {
-  // Extract first significant keyword (skip comments and whitespace)
-  std::string normalized;
-  normalized.reserve(sql.size());
-  
-  bool in_single_quote = false;
-  bool in_double_quote = false;
-  bool in_line_comment = false;
-  bool in_block_comment = false;
-  
-  for (size_t i = 0; i < sql.size(); ++i) {
-    char c = sql[i];
-    char next = (i + 1 < sql.size()) ? sql[i + 1] : '\0';
-    
-    // Handle comments
-    if (!in_single_quote && !in_double_quote) {
-      if (!in_line_comment && !in_block_comment) {
-        if (c == '-' && next == '-') {
-          in_line_comment = true;
-          continue;
-        }
-        if (c == '/' && next == '*') {
-          in_block_comment = true;
-          i++;  // Skip *
-          continue;
-        }
-      } else if (in_line_comment) {
-        if (c == '\n') {
-          in_line_comment = false;
-        }
-        continue;
-      } else if (in_block_comment) {
-        if (c == '*' && next == '/') {
-          in_block_comment = false;
-          i++;  // Skip /
-        }
-        continue;
-      }
+  // Lex only the first two words, skipping whitespace, comments and
+  // opening parentheses, and compare them in place
+  static const core::SqlLexer lexer;
+  core::SqlToken words[2];
+  std::size_t found = 0;
+  core::SqlToken token;
+  core::SqlLexState state = core::SqlLexState::kNormal;
+  for (std::size_t pos = 0; pos < sql.size() && found < 2; pos += token.length) {
+    state = lexer.Next(sql, pos, state, &token);
+    if (token.kind == core::SqlTokenKind::kWhitespace ||
+        token.kind == core::SqlTokenKind::kComment ||
+        (found == 0 && token.kind == core::SqlTokenKind::kPunctuation && sql[pos] == '(')) {
+      continue;
     }
-    
-    // Handle string literals
-    if (!in_line_comment && !in_block_comment) {
-      if (c == '\'' && !in_double_quote) {
-        in_single_quote = !in_single_quote;
-        continue;
-      }
-      if (c == '"' && !in_single_quote) {
-        in_double_quote = !in_double_quote;
-        continue;
-      }
-    }
-    
-    // Collect non-comment, non-string content
-    if (!in_single_quote && !in_double_quote && 
-        !in_line_comment && !in_block_comment) {
-      normalized.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+    if (!token.IsWord()) {
+      break;
     }
+    words[found++] = token;
   }
-  
-  // Trim leading whitespace
-  size_t start = 0;
-  while (start < normalized.size() && std::isspace(static_cast<unsigned char>(normalized[start]))) {
-    ++start;
-  }
-  
-  // Extract first word
-  size_t end = start;
-  while (end < normalized.size() && !std::isspace(static_cast<unsigned char>(normalized[end]))) {
-    ++end;
-  }
-  
-  std::string first_word = normalized.substr(start, end - start);
-  
-  // Also get second word for compound statements (CREATE TABLE, ALTER INDEX, etc.)
-  size_t second_start = end;
-  while (second_start < normalized.size() && 
-         std::isspace(static_cast<unsigned char>(normalized[second_start]))) {
-    ++second_start;
-  }
-  size_t second_end = second_start;
-  while (second_end < normalized.size() && 
-         !std::isspace(static_cast<unsigned char>(normalized[second_end]))) {
-    ++second_end;
+  if (found == 0) {
+    return QueryType::kUnknown;
   }
-  std::string second_word = normalized.substr(second_start, second_end - second_start);
+  auto first_is = [&](std::string_view word) { return words[0].Is(sql, word); };
+  auto second_is = [&](std::string_view word) { return found > 1 && words[1].Is(sql, word); };
   
   // Classify based on first keyword
-  if (first_word == "SELECT" || first_word == "WITH" || first_word == "VALUES") {
+  if (first_is("SELECT") || first_is("WITH") || first_is("VALUES")) {
     return QueryType::kDmlSelect;
   }
-  if (first_word == "INSERT") {
+  if (first_is("INSERT")) {
     return QueryType::kDmlInsert;
   }
-  if (first_word == "UPDATE") {
+  if (first_is("UPDATE")) {
     return QueryType::kDmlUpdate;
   }
-  if (first_word == "DELETE") {
+  if (first_is("DELETE")) {
     return QueryType::kDmlDelete;
   }
-  if (first_word == "MERGE") {
+  if (first_is("MERGE")) {
     return QueryType::kDmlMerge;
   }
   
-  if (first_word == "CREATE") {
+  if (first_is("CREATE")) {
     return QueryType::kDdlCreate;
   }
-  if (first_word == "ALTER") {
+  if (first_is("ALTER")) {
     return QueryType::kDdlAlter;
   }
-  if (first_word == "DROP") {
+  if (first_is("DROP")) {
     return QueryType::kDdlDrop;
   }
-  if (first_word == "TRUNCATE") {
+  if (first_is("TRUNCATE")) {
     return QueryType::kDdlTruncate;
   }
   
-  if (first_word == "BEGIN" || first_word == "START") {
+  if (first_is("BEGIN") || first_is("START")) {
     return QueryType::kTxnBegin;
   }
-  if (first_word == "COMMIT") {
+  if (first_is("COMMIT")) {
     return QueryType::kTxnCommit;
   }
-  if (first_word == "ROLLBACK" || first_word == "ABORT") {
+  if (first_is("ROLLBACK") || first_is("ABORT")) {
     return QueryType::kTxnRollback;
   }
-  if (first_word == "SAVEPOINT") {
+  if (first_is("SAVEPOINT")) {
     return QueryType::kTxnSavepoint;
   }
   
-  if (first_word == "SHOW") {
+  if (first_is("SHOW")) {
     return QueryType::kUtilityShow;
   }
-  if (first_word == "SET") {
+  if (first_is("SET")) {
     return QueryType::kUtilitySet;
   }
-  if (first_word == "EXPLAIN") {
+  if (first_is("EXPLAIN")) {
     return QueryType::kUtilityExplain;
   }
-  if (first_word == "ANALYZE") {
+  if (first_is("ANALYZE")) {
     return QueryType::kUtilityAnalyze;
   }
   
-  if (first_word == "EXECUTE" || first_word == "CALL" || first_word == "EXEC") {
-    return QueryType::kCallProcedure;
-  }
-  if (first_word == "EXECUTE" && second_word == "BLOCK") {
+  if (first_is("EXECUTE") && second_is("BLOCK")) {
     return QueryType::kExecuteBlock;
   }
+  if (first_is("EXECUTE") || first_is("CALL") || first_is("EXEC")) {
+    return QueryType::kCallProcedure;
+  }
   
   return QueryType::kUnknown;
 }
@@ -282,18 +242,41 @@ QueryResponse QueryRouter::execute(const std::string& sql,
   
   notifyProgress("classify", queryTypeToString(type));
   
+  // Row-returning statements can be streamed through a cursor
+  if (policy.streaming &&
+      (type == QueryType::kDmlSelect || type == QueryType::kUtilityShow ||
+       type == QueryType::kUtilityExplain)) {
+    return executeStreaming(sql, policy.fetch_rows);
+  }
+  
+  if (isDdl(type)) {
+    // Cached plans and bytecode may reference the objects being changed
+    clearStatementCache();
+    if (compile_cache_) {
+      compile_cache_->Invalidate();
+    }
+    // Strict mode sends everything native; otherwise DDL goes through
+    // direct SQL when allowed (native will likely fail for DDL)
+    QueryResponse response = policy.require_bytecode || !policy.allow_direct_sql
+                                  ? executeNative(sql, policy)
+                                  : executeDirectSql(sql);
+    if (ddl_listener_) {
+      ddl_listener_(type, sql);
+    }
+    return response;
+  }
+  
   // Route based on query type and policy
   if (policy.require_bytecode) {
     // Strict mode - everything goes through native path
     return executeNative(sql, policy);
   }
   
-  if (isDdl(type) || isTransactionControl(type) || type == QueryType::kUtilityShow) {
-    // DDL and utility queries go through direct SQL
+  if (isTransactionControl(type) || type == QueryType::kUtilityShow) {
+    // Utility queries go through direct SQL
     if (policy.allow_direct_sql) {
       return executeDirectSql(sql);
     }
-    // If direct SQL not allowed, try native (will likely fail for DDL)
     return executeNative(sql, policy);
   }
   
@@ -334,13 +317,12 @@ QueryResponse QueryRouter::executeDirectSql(const std::string& sql) {
                                    : core::Status::Error(result.error_message);
   response.execution_path = "query_router::direct_sql";
   
-  // Convert QueryResult to ResultSet
+  // Convert QueryResult to ResultSet; the column buffers are moved, not copied
   for (const auto& col : result.columns) {
     response.result_set.columns.push_back(col.name);
   }
-  for (const auto& row : result.rows) {
-    response.result_set.rows.push_back(row);
-  }
+  response.result_set.column_types = declaredColumnTypes(result.columns);
+  response.result_set.rows = std::move(result.rows);
   
   if (!result.success) {
     ++stats_.execution_errors;
@@ -378,6 +360,13 @@ QueryResponse QueryRouter::execute(const std::string& sql,
     return execute(sql, policy);
   }
   
+  // Bind on the server whenever a session is available; streaming still needs
+  // the cursor path below.
+  if (statement_session_ && !policy.streaming) {
+    ++stats_.total_queries;
+    return executePrepared(sql, parameters);
+  }
+  
   // For direct SQL, substitute parameters
   if (policy.allow_direct_sql && !policy.require_bytecode) {
     std::string substituted = SubstituteParameters(sql, parameters);
@@ -391,7 +380,11 @@ QueryResponse QueryRouter::execute(const std::string& sql,
   request.port = 4044;
   request.dialect = "";
   request.flags = policy.prefer_native ? QueryFlags::kBytecode : QueryFlags::kNone;
+  if (policy.streaming) {
+    request.flags = request.flags | QueryFlags::kStreaming;
+  }
   request.timeout_ms = policy.timeout_ms;
+  request.fetch_rows = policy.fetch_rows;
   
   return executeNative(request);
 }
@@ -403,6 +396,17 @@ QueryResponse QueryRouter::executeDirectSql(const std::string& sql,
 }
 
 QueryResponse QueryRouter::executeNative(const QueryRequest& request) {
+  if (hasFlag(request.flags, QueryFlags::kStreaming)) {
+    std::string sql = request.parameters.empty()
+                          ? request.sql
+                          : SubstituteParameters(request.sql, request.parameters);
+    return executeStreaming(sql, request.fetch_rows);
+  }
+  
+  if (!request.parameters.empty() && statement_session_) {
+    return executePrepared(request.sql, request.parameters);
+  }
+  
   ++stats_.native_queries;
   notifyProgress("execute", "native_sblr_with_params");
   
@@ -414,8 +418,7 @@ QueryResponse QueryRouter::executeNative(const QueryRequest& request) {
     };
   }
   
-  // For now, substitute parameters and execute as SQL
-  // Future: pass parameters to SBWP for prepared statement execution
+  // The session client has no bind path; substitute literals
   std::string sql = request.sql;
   if (!request.parameters.empty()) {
     sql = SubstituteParameters(sql, request.parameters);
@@ -424,5 +427,202 @@ QueryResponse QueryRouter::executeNative(const QueryRequest& request) {
   return session_client_->ExecuteSql(request.port, request.dialect, sql);
 }
 
-}  // namespace scratchrobin::backend
+// =============================================================================
+// Prepared Statements
+// =============================================================================
 
+QueryResponse QueryRouter::executePrepared(const std::string& sql,
+                                           const std::vector<QueryParameter>& parameters) {
+  ++stats_.prepared_executions;
+  const std::string key = core::normalizeStatementText(sql);
+  
+  // A cached handle can go stale when the SBWP session reconnects; in that
+  // case prepare again once and retry.
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    PreparedStatementCache::Handle handle = 0;
+    if (auto cached = statement_cache_.find(key)) {
+      ++stats_.statement_cache_hits;
+      notifyProgress("prepare", "cache_hit");
+      handle = *cached;
+    } else {
+      ++stats_.statement_cache_misses;
+      notifyProgress("prepare", "server");
+      auto prepared = statement_session_->Prepare(sql, &handle);
+      if (!prepared.status.ok) {
+        ++stats_.compilation_errors;
+        return prepared;
+      }
+      closeStatements(statement_cache_.insert(key, handle));
+    }
+    
+    notifyProgress("execute", "prepared");
+    auto response = statement_session_->ExecutePrepared(handle, parameters);
+    if (response.status.ok) {
+      return response;
+    }
+    
+    // Errors such as constraint violations leave the statement usable
+    if (response.execution_path != "sbwp::stale_statement") {
+      ++stats_.execution_errors;
+      return response;
+    }
+    statement_cache_.erase(key);
+    statement_session_->ClosePrepared(handle);
+  }
+  
+  ++stats_.execution_errors;
+  return QueryResponse{
+    core::Status::Error("Prepared statement could not be re-established"),
+    {},
+    "query_router::prepare_retry_failed"
+  };
+}
+
+void QueryRouter::closeStatements(const std::vector<PreparedStatementCache::Handle>& handles) {
+  if (!statement_session_) {
+    return;
+  }
+  for (auto handle : handles) {
+    statement_session_->ClosePrepared(handle);
+  }
+}
+
+void QueryRouter::setStatementCacheCapacity(size_t capacity) {
+  closeStatements(statement_cache_.setCapacity(capacity));
+}
+
+void QueryRouter::clearStatementCache() {
+  closeStatements(statement_cache_.clear());
+}
+
+// =============================================================================
+// Streaming Cursor
+// =============================================================================
+
+namespace {
+
+QueryResponse ToResponse(QueryResult&& result, const char* execution_path) {
+  QueryResponse response;
+  response.status = result.success ? core::Status::Ok()
+                                   : core::Status::Error(result.error_message);
+  response.execution_path = execution_path;
+  response.has_more = result.has_more;
+  for (const auto& col : result.columns) {
+    response.result_set.columns.push_back(col.name);
+  }
+  response.result_set.column_types = declaredColumnTypes(result.columns);
+  response.result_set.rows = std::move(result.rows);
+  return response;
+}
+
+}  // namespace
+
+QueryResponse QueryRouter::executeStreaming(const std::string& sql, uint32_t fetch_rows) {
+  auto opened = openCursorInternal(sql);
+  if (!opened.status.ok) {
+    return opened;
+  }
+  auto batch = fetchRows(fetch_rows);
+  if (batch.status.ok && batch.result_set.columns.empty()) {
+    batch.result_set.columns = std::move(opened.result_set.columns);
+  }
+  return batch;
+}
+
+QueryResponse QueryRouter::openCursor(const std::string& sql) {
+  ++stats_.total_queries;
+  return openCursorInternal(sql);
+}
+
+QueryResponse QueryRouter::openCursorInternal(const std::string& sql) {
+  ++stats_.direct_sql_queries;
+  notifyProgress("execute", "cursor_open");
+  closeCursor();
+  
+  if (direct_connection_) {
+    auto response = ToResponse(direct_connection_->openCursor(sql),
+                               "query_router::cursor_open");
+    if (response.status.ok) {
+      cursor_source_ = CursorSource::kDirect;
+    } else {
+      ++stats_.execution_errors;
+    }
+    return response;
+  }
+  
+  if (sbwp_client_) {
+    auto response = sbwp_client_->OpenCursor(sql);
+    if (response.status.ok) {
+      cursor_source_ = CursorSource::kSbwp;
+    } else {
+      ++stats_.execution_errors;
+    }
+    return response;
+  }
+  
+  return QueryResponse{
+    core::Status::Error("No connection available for cursor"),
+    {},
+    "query_router::no_cursor_connection"
+  };
+}
+
+QueryResponse QueryRouter::fetchRows(size_t max_rows) {
+  QueryResponse response;
+  switch (cursor_source_) {
+    case CursorSource::kDirect:
+      response = ToResponse(direct_connection_->fetchRows(max_rows),
+                            "query_router::cursor_fetch");
+      break;
+    case CursorSource::kSbwp:
+      response = sbwp_client_->FetchRows(max_rows);
+      break;
+    case CursorSource::kNone:
+      return QueryResponse{
+        core::Status::Error("No open cursor"),
+        {},
+        "query_router::no_cursor"
+      };
+  }
+  
+  notifyProgress("fetch", std::to_string(response.result_set.rows.size()) + " rows");
+  if (!response.status.ok) {
+    ++stats_.execution_errors;
+  }
+  if (!response.has_more) {
+    cursor_source_ = CursorSource::kNone;
+  }
+  return response;
+}
+
+void QueryRouter::closeCursor() {
+  switch (cursor_source_) {
+    case CursorSource::kDirect:
+      direct_connection_->closeCursor();
+      break;
+    case CursorSource::kSbwp:
+      sbwp_client_->CloseCursor();
+      break;
+    case CursorSource::kNone:
+      break;
+  }
+  cursor_source_ = CursorSource::kNone;
+}
+
+bool QueryRouter::hasOpenCursor() const {
+  return cursor_source_ != CursorSource::kNone;
+}
+
+bool QueryRouter::cancel() {
+  notifyProgress("cancel", "requested");
+  bool cancelled = false;
+  if (direct_connection_) {
+    cancelled = direct_connection_->cancel() || cancelled;
+  }
+  if (sbwp_client_) {
+    cancelled = sbwp_client_->CancelQuery() || cancelled;
+  }
+  return cancelled;
+}
+
+}  // namespace scratchrobin::backend
@@ -9,8 +9,10 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "backend/prepared_statement_cache.h"
 #include "backend/query_request.h"
 #include "backend/query_response.h"
 #include "core/status.h"
@@ -20,6 +22,8 @@ namespace scratchrobin::backend {
 // Forward declarations
 class SessionClient;
 class ScratchbirdConnection;
+class ScratchbirdSbwpClient;
+class SblrCompileCache;
 struct ScratchbirdRuntimeConfig;
 
 /**
@@ -62,6 +66,8 @@ struct ExecutionPolicy {
   bool allow_direct_sql = true;   // Allow direct SQL for DDL/utility
   bool require_bytecode = false;  // Require SBLR bytecode (strict mode)
   uint32_t timeout_ms = 30000;    // Query timeout
+  bool streaming = false;         // Open a cursor and return the first batch
+  uint32_t fetch_rows = 1000;     // Rows per batch when streaming
 };
 
 /**
@@ -90,7 +96,17 @@ class QueryRouter {
    */
   void setSessionClient(SessionClient* client);
   void setDirectConnection(ScratchbirdConnection* connection);
+  void setSbwpClient(ScratchbirdSbwpClient* client);  // Also the statement session
+  void setStatementSession(PreparedStatementSession* session);
   void setRuntimeConfig(const ScratchbirdRuntimeConfig* config);
+  void setCompileCache(SblrCompileCache* cache);  // Invalidated on DDL
+
+  /**
+   * Called with every DDL statement routed through execute(), after it
+   * ran (whether or not it succeeded), e.g. to invalidate catalog caches.
+   */
+  using DdlListener = std::function<void(QueryType type, const std::string& sql)>;
+  void setDdlListener(DdlListener listener) { ddl_listener_ = std::move(listener); }
 
   /**
    * Main execution entry point - routes based on query type
@@ -115,6 +131,32 @@ class QueryRouter {
                               const ExecutionPolicy& policy = {});
   QueryResponse executeNative(const QueryRequest& request);
 
+  /**
+   * Streaming cursor - rows are fetched in batches instead of being
+   * buffered. Uses the direct connection when set, otherwise SBWP.
+   * Responses carry has_more until the cursor is exhausted.
+   */
+  QueryResponse openCursor(const std::string& sql);
+  QueryResponse fetchRows(size_t max_rows);
+  void closeCursor();
+  bool hasOpenCursor() const;
+
+  /**
+   * Server-side cancel of the statement currently running on the
+   * underlying connection. Safe to call from another thread.
+   */
+  bool cancel();
+
+  /**
+   * Prepared statements - parameterized statements run through the
+   * statement session (SBWP) are prepared once per session and cached by
+   * normalized SQL (LRU). DDL clears the cache so plans are rebuilt
+   * against the new schema.
+   */
+  void setStatementCacheCapacity(size_t capacity);
+  size_t statementCacheSize() const { return statement_cache_.size(); }
+  void clearStatementCache();
+
   /**
    * Query classification (exposed for testing)
    */
@@ -133,6 +175,9 @@ class QueryRouter {
     uint64_t direct_sql_queries = 0;
     uint64_t compilation_errors = 0;
     uint64_t execution_errors = 0;
+    uint64_t prepared_executions = 0;
+    uint64_t statement_cache_hits = 0;
+    uint64_t statement_cache_misses = 0;
   };
   Statistics statistics() const { return stats_; }
   void resetStatistics() { stats_ = {}; }
@@ -146,13 +191,26 @@ class QueryRouter {
 
  private:
   void notifyProgress(const std::string& stage, const std::string& detail);
+  QueryResponse executeStreaming(const std::string& sql, uint32_t fetch_rows);
+  QueryResponse openCursorInternal(const std::string& sql);
+  QueryResponse executePrepared(const std::string& sql,
+                                const std::vector<QueryParameter>& parameters);
+  void closeStatements(const std::vector<PreparedStatementCache::Handle>& handles);
+
+  enum class CursorSource { kNone, kDirect, kSbwp };
 
   SessionClient* session_client_ = nullptr;
   ScratchbirdConnection* direct_connection_ = nullptr;
+  ScratchbirdSbwpClient* sbwp_client_ = nullptr;
+  PreparedStatementSession* statement_session_ = nullptr;
+  CursorSource cursor_source_ = CursorSource::kNone;
   const ScratchbirdRuntimeConfig* runtime_config_ = nullptr;
+  SblrCompileCache* compile_cache_ = nullptr;
+  PreparedStatementCache statement_cache_;
 
   Statistics stats_;
   ProgressCallback progress_callback_;
+  DdlListener ddl_listener_;
 };
 
 }  // namespace scratchrobin::backend
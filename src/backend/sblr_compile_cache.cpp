@@ -0,0 +1,217 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "backend/sblr_compile_cache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace scratchrobin::backend {
+
+namespace {
+
+constexpr char kFileMagic[] = "SBLRCACHE1";
+// Guards against reading a corrupt length field as a huge allocation
+constexpr std::uint64_t kMaxFieldBytes = 256 * 1024 * 1024;
+
+void WriteString(std::ostream& out, const std::string& value) {
+  const std::uint64_t size = value.size();
+  out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+bool ReadString(std::istream& in, std::string* value) {
+  std::uint64_t size = 0;
+  if (!in.read(reinterpret_cast<char*>(&size), sizeof(size)) || size > kMaxFieldBytes) {
+    return false;
+  }
+  value->resize(static_cast<std::size_t>(size));
+  return static_cast<bool>(in.read(value->data(), static_cast<std::streamsize>(size)));
+}
+
+std::string CompilerVersionOf(const core::QueryPayload& payload) {
+  auto it = payload.metadata.find("compiler_version");
+  return it == payload.metadata.end() ? std::string() : it->second;
+}
+
+}  // namespace
+
+SblrCompileCache::SblrCompileCache(std::size_t max_entries, std::size_t max_bytes)
+    : max_entries_(std::max<std::size_t>(max_entries, 1)), max_bytes_(max_bytes) {}
+
+std::optional<core::QueryPayload> SblrCompileCache::Lookup(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++stats_.misses;
+    return std::nullopt;
+  }
+  ++stats_.hits;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->payload;
+}
+
+void SblrCompileCache::Insert(const std::string& key, const core::QueryPayload& payload) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  InsertLocked(key, payload);
+}
+
+void SblrCompileCache::InsertLocked(const std::string& key,
+                                    const core::QueryPayload& payload) {
+  const std::size_t bytes = EntryBytes(key, payload);
+  if (bytes > max_bytes_) {
+    return;  // Would evict everything else and still not fit
+  }
+  
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    stats_.bytes -= it->second->bytes;
+    it->second->payload = payload;
+    it->second->bytes = bytes;
+    entries_.splice(entries_.begin(), entries_, it->second);
+  } else {
+    entries_.push_front(Entry{key, payload, bytes});
+    index_.emplace(key, entries_.begin());
+  }
+  stats_.bytes += bytes;
+  EvictLocked();
+}
+
+void SblrCompileCache::EvictLocked() {
+  while (!entries_.empty() &&
+         (entries_.size() > max_entries_ || stats_.bytes > max_bytes_)) {
+    const Entry& victim = entries_.back();
+    stats_.bytes -= victim.bytes;
+    index_.erase(victim.key);
+    entries_.pop_back();
+    ++stats_.evictions;
+  }
+}
+
+void SblrCompileCache::Invalidate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (entries_.empty()) {
+    return;
+  }
+  entries_.clear();
+  index_.clear();
+  stats_.bytes = 0;
+  ++stats_.invalidations;
+}
+
+void SblrCompileCache::SetLimits(std::size_t max_entries, std::size_t max_bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_entries_ = std::max<std::size_t>(max_entries, 1);
+  max_bytes_ = max_bytes;
+  EvictLocked();
+}
+
+SblrCompileCache::Stats SblrCompileCache::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.entries = entries_.size();
+  return stats;
+}
+
+std::size_t SblrCompileCache::EntryBytes(const std::string& key,
+                                         const core::QueryPayload& payload) {
+  std::size_t bytes = key.size() + payload.body.size();
+  for (const auto& [name, value] : payload.metadata) {
+    bytes += name.size() + value.size();
+  }
+  return bytes;
+}
+
+core::Status SblrCompileCache::SaveToFile(const std::string& path,
+                                          const std::string& compiler_version) const {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    return core::Status::Error("Cannot open SBLR cache file for writing: " + path);
+  }
+  
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<const Entry*> matching;
+  for (const auto& entry : entries_) {
+    if (CompilerVersionOf(entry.payload) == compiler_version) {
+      matching.push_back(&entry);
+    }
+  }
+  
+  out.write(kFileMagic, sizeof(kFileMagic) - 1);
+  WriteString(out, compiler_version);
+  const std::uint64_t count = matching.size();
+  out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  // Least recently used first, so reloading restores the LRU order
+  for (auto it = matching.rbegin(); it != matching.rend(); ++it) {
+    const Entry& entry = **it;
+    WriteString(out, entry.key);
+    WriteString(out, entry.payload.body);
+    const std::uint64_t metadata_count = entry.payload.metadata.size();
+    out.write(reinterpret_cast<const char*>(&metadata_count), sizeof(metadata_count));
+    for (const auto& [name, value] : entry.payload.metadata) {
+      WriteString(out, name);
+      WriteString(out, value);
+    }
+  }
+  
+  if (!out) {
+    return core::Status::Error("Failed to write SBLR cache file: " + path);
+  }
+  return core::Status::Ok();
+}
+
+core::Status SblrCompileCache::LoadFromFile(const std::string& path,
+                                            const std::string& compiler_version) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return core::Status::Error("Cannot open SBLR cache file: " + path);
+  }
+  
+  char magic[sizeof(kFileMagic) - 1];
+  std::string file_version;
+  std::uint64_t count = 0;
+  if (!in.read(magic, sizeof(magic)) ||
+      std::string(magic, sizeof(magic)) != kFileMagic ||
+      !ReadString(in, &file_version) ||
+      !in.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+    return core::Status::Error("Not an SBLR cache file: " + path);
+  }
+  if (file_version != compiler_version) {
+    return core::Status::Error("SBLR cache was written by compiler " + file_version);
+  }
+  
+  // Parse everything before touching the cache so a truncated file
+  // leaves it unchanged
+  std::vector<std::pair<std::string, core::QueryPayload>> loaded;
+  for (std::uint64_t i = 0; i < count; ++i) {
+    std::string key;
+    core::QueryPayload payload;
+    payload.type = core::QueryPayloadType::kSblrBytecode;
+    std::uint64_t metadata_count = 0;
+    if (!ReadString(in, &key) || !ReadString(in, &payload.body) ||
+        !in.read(reinterpret_cast<char*>(&metadata_count), sizeof(metadata_count))) {
+      return core::Status::Error("SBLR cache file is truncated: " + path);
+    }
+    for (std::uint64_t m = 0; m < metadata_count; ++m) {
+      std::string name;
+      std::string value;
+      if (!ReadString(in, &name) || !ReadString(in, &value)) {
+        return core::Status::Error("SBLR cache file is truncated: " + path);
+      }
+      payload.metadata[name] = value;
+    }
+    loaded.emplace_back(std::move(key), std::move(payload));
+  }
+  
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& [key, payload] : loaded) {
+    InsertLocked(key, payload);
+  }
+  return core::Status::Ok();
+}
+
+}  // namespace scratchrobin::backend
@@ -0,0 +1,85 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "core/query_payload.h"
+#include "core/status.h"
+
+namespace scratchrobin::backend {
+
+/**
+ * SblrCompileCache - bounded LRU cache of compiled SBLR payloads
+ *
+ * Keys are built by the compiler from normalized SQL plus the compile
+ * context, so the cache itself is just a thread-safe map with entry and
+ * byte limits. The contents can be written to disk and read back so a
+ * restarted client starts warm; a file written by a different compiler
+ * version is ignored.
+ */
+class SblrCompileCache {
+ public:
+  struct Stats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+    std::uint64_t invalidations = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+  };
+
+  explicit SblrCompileCache(std::size_t max_entries = 1024,
+                            std::size_t max_bytes = 64 * 1024 * 1024);
+
+  SblrCompileCache(const SblrCompileCache&) = delete;
+  SblrCompileCache& operator=(const SblrCompileCache&) = delete;
+
+  // Counts a hit or miss; a hit refreshes the entry's LRU position.
+  std::optional<core::QueryPayload> Lookup(const std::string& key);
+  void Insert(const std::string& key, const core::QueryPayload& payload);
+
+  // Drops every entry, e.g. after DDL changed the objects plans refer to.
+  void Invalidate();
+
+  void SetLimits(std::size_t max_entries, std::size_t max_bytes);
+  Stats GetStats() const;
+
+  // Persistence. Only entries whose metadata compiler_version matches
+  // |compiler_version| are written or loaded.
+  core::Status SaveToFile(const std::string& path,
+                          const std::string& compiler_version) const;
+  core::Status LoadFromFile(const std::string& path,
+                            const std::string& compiler_version);
+
+ private:
+  struct Entry {
+    std::string key;
+    core::QueryPayload payload;
+    std::size_t bytes = 0;
+  };
+
+  static std::size_t EntryBytes(const std::string& key,
+                                const core::QueryPayload& payload);
+  void InsertLocked(const std::string& key, const core::QueryPayload& payload);
+  void EvictLocked();
+
+  mutable std::mutex mutex_;
+  std::size_t max_entries_;
+  std::size_t max_bytes_;
+  std::list<Entry> entries_;  // Most recently used first
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  Stats stats_;
+};
+
+}  // namespace scratchrobin::backend
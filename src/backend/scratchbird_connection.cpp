@@ -1,10 +1,43 @@
 #include "backend/scratchbird_connection.h"
 
+#include <algorithm>
 #include <sstream>
 #include <cstring>
+#include <limits>
+#include <string_view>
+
+#include "core/scratchbird_types.h"
 
 namespace scratchrobin::backend {
 
+std::vector<core::ColumnType> declaredColumnTypes(const std::vector<ColumnMeta>& columns) {
+    std::vector<core::ColumnType> types;
+    types.reserve(columns.size());
+    for (const auto& column : columns) {
+        switch (core::GetTypeCategory(static_cast<core::Oid>(column.type))) {
+            case core::TypeCategory::kInteger:
+                types.push_back(core::ColumnType::kInt64);
+                break;
+            case core::TypeCategory::kFloatingPoint:
+            case core::TypeCategory::kNumeric:
+                types.push_back(core::ColumnType::kDouble);
+                break;
+            case core::TypeCategory::kDate:
+                types.push_back(core::ColumnType::kDate);
+                break;
+            case core::TypeCategory::kInvalid:
+            case core::TypeCategory::kPseudo:
+            case core::TypeCategory::kUserDefined:
+                types.push_back(core::ColumnType::kAuto);  // Let the values decide
+                break;
+            default:
+                types.push_back(core::ColumnType::kText);
+                break;
+        }
+    }
+    return types;
+}
+
 ScratchbirdConnection::ScratchbirdConnection() = default;
 
 ScratchbirdConnection::~ScratchbirdConnection() {
@@ -60,6 +93,7 @@ bool ScratchbirdConnection::connect(const ConnectionInfo& info) {
 }
 
 void ScratchbirdConnection::disconnect() {
+    closeCursor();
 #if SCRATCHBIRD_CLIENT_AVAILABLE
     if (conn_) {
         sb_disconnect(conn_);
@@ -95,6 +129,7 @@ QueryResult ScratchbirdConnection::execute(const std::string& sql) {
     }
     
     clearError();
+    cancel_requested_ = false;
     
 #if SCRATCHBIRD_CLIENT_AVAILABLE
     sb_result* sb_res = sb_execute(conn_, sql.c_str(), &last_error_);
@@ -105,15 +140,19 @@ QueryResult ScratchbirdConnection::execute(const std::string& sql) {
     
     result = resultFromSbResult(sb_res);
     sb_result_free(sb_res);
+    if (cancel_requested_) {
+        result.success = false;
+        result.error_message = "Query cancelled";
+    }
 #else
     // Mock implementation - return sample data for SELECT statements
     if (sql.find("SELECT") != std::string::npos || sql.find("select") != std::string::npos) {
         result.success = true;
         result.columns = {
-            {"ID", 3, 0},
-            {"Name", 11, 1},
-            {"Email", 11, 1},
-            {"Created", 32, 1}
+            {"ID", static_cast<int>(core::kOidInt8), 0},
+            {"Name", static_cast<int>(core::kOidVarchar), 1},
+            {"Email", static_cast<int>(core::kOidVarchar), 1},
+            {"Created", static_cast<int>(core::kOidDate), 1}
         };
         result.rows = {
             {"1", "John Doe", "john@example.com", "2024-01-15"},
@@ -135,6 +174,112 @@ QueryResult ScratchbirdConnection::query(const std::string& sql) {
     return execute(sql);
 }
 
+QueryResult ScratchbirdConnection::openCursor(const std::string& sql) {
+    QueryResult result;
+    
+    if (!connected_) {
+        result.error_message = "Not connected to database";
+        return result;
+    }
+    
+    closeCursor();
+    clearError();
+    cancel_requested_ = false;
+    
+#if SCRATCHBIRD_CLIENT_AVAILABLE
+    cursor_ = sb_execute(conn_, sql.c_str(), &last_error_);
+    if (!cursor_) {
+        result.error_message = last_error_.message;
+        return result;
+    }
+    readColumnMeta(cursor_, cursor_columns_);
+#else
+    mock_cursor_ = execute(sql);
+    mock_cursor_pos_ = 0;
+    if (!mock_cursor_.success) {
+        result.error_message = mock_cursor_.error_message;
+        return result;
+    }
+    cursor_columns_ = mock_cursor_.columns;
+    result.affected_rows = mock_cursor_.affected_rows;
+#endif
+    
+    cursor_open_ = true;
+    result.columns = cursor_columns_;
+    result.success = true;
+    result.has_more = true;
+    return result;
+}
+
+QueryResult ScratchbirdConnection::fetchRows(size_t max_rows) {
+    QueryResult result;
+    
+    if (!cursor_open_) {
+        result.error_message = "No open cursor";
+        return result;
+    }
+    
+    result.columns = cursor_columns_;
+    
+#if SCRATCHBIRD_CLIENT_AVAILABLE
+    fetchInto(cursor_, result, max_rows);
+#else
+    const size_t end = std::min(mock_cursor_.rows.size(), mock_cursor_pos_ + max_rows);
+    for (; mock_cursor_pos_ < end; ++mock_cursor_pos_) {
+        result.rows.push_back(mock_cursor_.rows[mock_cursor_pos_]);
+    }
+    result.has_more = mock_cursor_pos_ < mock_cursor_.rows.size();
+#endif
+    
+    if (cancel_requested_) {
+        result.error_message = "Query cancelled";
+        closeCursor();
+        return result;
+    }
+    
+    result.success = true;
+    if (!result.has_more) {
+        closeCursor();
+    }
+    return result;
+}
+
+void ScratchbirdConnection::closeCursor() {
+#if SCRATCHBIRD_CLIENT_AVAILABLE
+    if (cursor_) {
+        sb_result_free(cursor_);
+        cursor_ = nullptr;
+    }
+#else
+    mock_cursor_ = QueryResult{};
+    mock_cursor_pos_ = 0;
+#endif
+    cursor_columns_.clear();
+    cursor_row_pending_ = false;
+    cursor_open_ = false;
+}
+
+bool ScratchbirdConnection::hasOpenCursor() const {
+    return cursor_open_;
+}
+
+bool ScratchbirdConnection::cancel() {
+    if (!connected_) {
+        return false;
+    }
+    
+    cancel_requested_ = true;
+    
+#if SCRATCHBIRD_CLIENT_AVAILABLE
+    // Use a local error block: last_error_ belongs to the thread running
+    // the statement being cancelled.
+    sb_error err{};
+    return sb_cancel(conn_, &err) == 0;
+#else
+    return true;
+#endif
+}
+
 QueryResult ScratchbirdConnection::getSchemas() {
     // Use the inline query from scratchbird_client.h
     return query(sb_metadata_schemas_query());
@@ -156,45 +301,27 @@ QueryResult ScratchbirdConnection::getTables(const std::string& schema) {
 }
 
 QueryResult ScratchbirdConnection::getColumns(const std::string& table, const std::string& schema) {
-    std::string sql = sb_metadata_columns_query();
-    
-    // Build filter conditions
-    std::vector<std::string> conditions;
-    
-    if (!table.empty() && table != "*") {
-        // Need to look up table_id from table name
-        // For now, we'll add a comment indicating this needs the table_id
-        // A proper implementation would join with sys.tables
-        conditions.push_back("table_id IN (SELECT table_id FROM sys.tables WHERE table_name = '" + 
-                            escapeString(table) + "' AND is_valid = 1)");
-    }
-    
-    if (!schema.empty() && schema != "*") {
-        // Filter by schema through table join
-        conditions.push_back("table_id IN (SELECT table_id FROM sys.tables WHERE schema_id = '" + 
-                            escapeString(schema) + "' AND is_valid = 1)");
+    if (table.empty() || table == "*") {
+        return getColumnsBulk(std::vector<std::string>{}, schema);
     }
-    
-    // Insert conditions into the query
-    if (!conditions.empty()) {
-        size_t order_by_pos = sql.find("ORDER BY");
-        if (order_by_pos != std::string::npos) {
-            std::string where_clause = "AND " + conditions[0];
-            for (size_t i = 1; i < conditions.size(); ++i) {
-                where_clause += " AND " + conditions[i];
-            }
-            where_clause += " ";
-            sql.insert(order_by_pos, where_clause);
-        }
-    }
-    
-    return query(sql);
+    return getColumnsBulk(std::vector<std::string>{table}, schema);
 }
 
 QueryResult ScratchbirdConnection::getIndexes(const std::string& table, const std::string& schema) {
-    (void)table;
-    (void)schema;
-    return query(sb_metadata_indexes_query());
+    if (table.empty() || table == "*") {
+        return getIndexesBulk(std::vector<std::string>{}, schema);
+    }
+    return getIndexesBulk(std::vector<std::string>{table}, schema);
+}
+
+QueryResult ScratchbirdConnection::getColumnsBulk(const std::vector<std::string>& tables,
+                                                  const std::string& schema) {
+    return query(addCondition(sb_metadata_columns_query(), tableFilter(tables, schema)));
+}
+
+QueryResult ScratchbirdConnection::getIndexesBulk(const std::vector<std::string>& tables,
+                                                  const std::string& schema) {
+    return query(addCondition(sb_metadata_indexes_query(), tableFilter(tables, schema)));
 }
 
 bool ScratchbirdConnection::beginTransaction() {
@@ -243,7 +370,15 @@ QueryResult ScratchbirdConnection::resultFromSbResult(sb_result* result) {
         return qr;
     }
     
-    // Get column count and metadata
+    readColumnMeta(result, qr.columns);
+    fetchInto(result, qr, std::numeric_limits<size_t>::max());
+    
+    qr.success = true;
+    return qr;
+}
+
+void ScratchbirdConnection::readColumnMeta(sb_result* result, std::vector<ColumnMeta>& columns) {
+    columns.clear();
     int col_count = sb_column_count(result);
     for (int i = 0; i < col_count; ++i) {
         sb_column_meta meta;
@@ -252,37 +387,113 @@ QueryResult ScratchbirdConnection::resultFromSbResult(sb_result* result) {
             cm.name = meta.name ? meta.name : "";
             cm.type = meta.type;
             cm.nullable = meta.nullable;
-            qr.columns.push_back(cm);
+            columns.push_back(cm);
         }
     }
+}
+
+size_t ScratchbirdConnection::fetchInto(sb_result* result, QueryResult& qr, size_t max_rows) {
+    // Fetch rows straight into the column buffers; sb_get_string() points
+    // into the driver's row buffer so no per-cell string is created.
+    const int col_count = sb_column_count(result);
+    qr.rows.SetColumnCount(static_cast<size_t>(col_count));
+    qr.has_more = false;
     
-    // Fetch rows
+    // The cursor reads one row past each batch so has_more is only set
+    // while rows remain; that row opens the next batch.
+    const bool is_cursor = result == cursor_;
+    bool have_row = is_cursor && cursor_row_pending_;
+    if (is_cursor) {
+        cursor_row_pending_ = false;
+    }
+    sb_row local_row;
+    sb_row& row = is_cursor ? cursor_row_ : local_row;
+    
+    size_t fetched = 0;
     sb_error err;
-    sb_row row;
-    while (sb_fetch(result, &row, &err) == 0) {
-        std::vector<std::string> row_data;
+    for (;;) {
+        if (cancel_requested_) {
+            return fetched;
+        }
+        if (!have_row && sb_fetch(result, &row, &err) != 0) {
+            return fetched;
+        }
+        have_row = false;
+        if (fetched == max_rows) {
+            cursor_row_pending_ = is_cursor;
+            qr.has_more = is_cursor;
+            return fetched;
+        }
         for (int i = 0; i < col_count; ++i) {
             size_t len = 0;
             const char* val = sb_get_string(&row, i, &len);
             if (val) {
-                row_data.emplace_back(val, len);
+                qr.rows.Column(i).AppendText(std::string_view(val, len));
             } else {
-                row_data.push_back("NULL");
+                qr.rows.Column(i).AppendNull();
             }
         }
-        qr.rows.push_back(row_data);
+        qr.rows.EndRow();
+        ++fetched;
     }
-    
-    qr.success = true;
-    return qr;
 }
 #else
-QueryResult ScratchbirdConnection::resultFromSbResult(void* result) {
+QueryResult ScratchbirdConnection::resultFromSbResult(sb_result* result) {
     (void)result;
     return QueryResult{};
 }
+
+void ScratchbirdConnection::readColumnMeta(sb_result* result, std::vector<ColumnMeta>& columns) {
+    (void)result;
+    columns.clear();
+}
+
+size_t ScratchbirdConnection::fetchInto(sb_result* result, QueryResult& qr, size_t max_rows) {
+    (void)result;
+    (void)max_rows;
+    qr.has_more = false;
+    return 0;
+}
 #endif
 
+// Restricts a metadata query to |tables| of |schema| with a single
+// sys.tables subquery; empty when neither is given.
+std::string ScratchbirdConnection::tableFilter(const std::vector<std::string>& tables,
+                                               const std::string& schema) {
+    const bool all_schemas = schema.empty() || schema == "*";
+    if (tables.empty() && all_schemas) {
+        return {};
+    }
+    std::string filter = "table_id IN (SELECT t.table_id FROM sys.tables t "
+                         "JOIN sys.schemas s ON s.schema_id = t.schema_id "
+                         "WHERE t.is_valid = true";
+    if (!all_schemas) {
+        filter += " AND s.schema_name = '" + escapeString(schema) + "'";
+    }
+    if (!tables.empty()) {
+        filter += " AND t.table_name IN (";
+        for (size_t i = 0; i < tables.size(); ++i) {
+            filter += (i == 0 ? "'" : ", '") + escapeString(tables[i]) + "'";
+        }
+        filter += ")";
+    }
+    filter += ")";
+    return filter;
+}
+
+std::string ScratchbirdConnection::addCondition(std::string sql, const std::string& condition) {
+    if (condition.empty()) {
+        return sql;
+    }
+    size_t order_by_pos = sql.rfind("ORDER BY");
+    if (order_by_pos == std::string::npos) {
+        order_by_pos = sql.size();
+    }
+    const bool has_where = sql.rfind("WHERE", order_by_pos) != std::string::npos;
+    sql.insert(order_by_pos, (has_where ? " AND " : " WHERE ") + condition + " ");
+    return sql;
+}
+
 std::string ScratchbirdConnection::escapeString(const std::string& str) {
     std::string escaped;
     escaped.reserve(str.size() * 2);
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
 #include <functional>
 
+#include "core/result_set.h"
+
 // ScratchBird C API
 #if SCRATCHBIRD_CLIENT_AVAILABLE
 extern "C" {
@@ -18,6 +22,20 @@ typedef struct sb_error {
     int code;
     char message[256];
 } sb_error;
+inline const char* sb_metadata_schemas_query() {
+    return "SELECT schema_id, schema_name FROM sys.schemas ORDER BY schema_name";
+}
+inline const char* sb_metadata_tables_query() {
+    return "SELECT table_id, schema_id, table_name FROM sys.tables "
+           "WHERE is_valid = true ORDER BY table_name";
+}
+inline const char* sb_metadata_columns_query() {
+    return "SELECT table_id, column_name, data_type, is_nullable FROM sys.columns "
+           "ORDER BY table_id, ordinal_position";
+}
+inline const char* sb_metadata_indexes_query() {
+    return "SELECT table_id, index_name, is_unique FROM sys.indexes ORDER BY table_id, index_name";
+}
 #endif
 
 namespace scratchrobin::backend {
@@ -34,16 +52,20 @@ struct ConnectionInfo {
 
 struct ColumnMeta {
     std::string name;
-    int type = 0;
+    int type = 0;  // Type Oid, see core/scratchbird_types.h
     int nullable = 1;
 };
 
+// How |columns| go into core::ResultSet::column_types
+std::vector<core::ColumnType> declaredColumnTypes(const std::vector<ColumnMeta>& columns);
+
 struct QueryResult {
     std::vector<ColumnMeta> columns;
-    std::vector<std::vector<std::string>> rows;
+    core::ColumnTable rows;
     std::string error_message;
     bool success = false;
     int affected_rows = 0;
+    bool has_more = false;  // Cursor batches: more rows remain to be fetched
 };
 
 class ScratchbirdConnection {
@@ -61,12 +83,29 @@ class ScratchbirdConnection {
     QueryResult execute(const std::string& sql);
     QueryResult query(const std::string& sql);
     
+    // Streaming cursor (one open cursor per connection). openCursor returns
+    // column metadata only; rows arrive through fetchRows in batches.
+    QueryResult openCursor(const std::string& sql);
+    QueryResult fetchRows(size_t max_rows);
+    void closeCursor();
+    bool hasOpenCursor() const;
+    
+    // Ask the server to abort the running statement; safe to call from
+    // another thread while execute() or fetchRows() is blocked.
+    bool cancel();
+    
     // Metadata queries
     QueryResult getSchemas();
     QueryResult getTables(const std::string& schema = "");
     QueryResult getColumns(const std::string& table, const std::string& schema = "");
     QueryResult getIndexes(const std::string& table, const std::string& schema = "");
     
+    // Bulk metadata: one round trip for every table in |tables|, or for
+    // all tables of |schema| when |tables| is empty. Rows are those of the
+    // single-table calls; tell tables apart by their table_id column.
+    QueryResult getColumnsBulk(const std::vector<std::string>& tables, const std::string& schema = "");
+    QueryResult getIndexesBulk(const std::vector<std::string>& tables, const std::string& schema = "");
+    
     // Transactions
     bool beginTransaction();
     bool commit();
@@ -74,6 +113,7 @@ class ScratchbirdConnection {
     
     // Status
     std::string lastError() const;
+    const ConnectionInfo& connectionInfo() const { return current_info_; }
     
  private:
     sb_connection* conn_ = nullptr;
@@ -81,9 +121,25 @@ class ScratchbirdConnection {
     bool connected_ = false;
     ConnectionInfo current_info_;
     
+    sb_result* cursor_ = nullptr;
+    std::vector<ColumnMeta> cursor_columns_;
+    bool cursor_open_ = false;
+    bool cursor_row_pending_ = false;  // Read ahead by the last fetchRows
+    std::atomic<bool> cancel_requested_{false};
+#if SCRATCHBIRD_CLIENT_AVAILABLE
+    sb_row cursor_row_{};
+#else
+    QueryResult mock_cursor_;
+    size_t mock_cursor_pos_ = 0;
+#endif
+    
     QueryResult resultFromSbResult(sb_result* result);
+    void readColumnMeta(sb_result* result, std::vector<ColumnMeta>& columns);
+    size_t fetchInto(sb_result* result, QueryResult& qr, size_t max_rows);
     void clearError();
     std::string escapeString(const std::string& str);
+    std::string tableFilter(const std::vector<std::string>& tables, const std::string& schema);
+    static std::string addCondition(std::string sql, const std::string& condition);
 };
 
 }  // namespace scratchrobin::backend
@@ -54,6 +54,9 @@ struct ScratchbirdRuntimeConfig {
   std::string server_executable{};
   std::string socket_path{};
   std::string ipc_method{"AUTO"};
+  // Both key the compile cache; it is not persisted while either is empty
+  std::string search_path{};  // Schema search path used to resolve names
+  std::string server_version{};  // As reported by the server; empty until known
 
   bool operator==(const ScratchbirdRuntimeConfig& other) const {
     return mode == other.mode && host == other.host && port == other.port &&
@@ -65,7 +68,9 @@ struct ScratchbirdRuntimeConfig {
            auto_start_timeout_ms == other.auto_start_timeout_ms &&
            server_executable == other.server_executable &&
            socket_path == other.socket_path &&
-           ipc_method == other.ipc_method;
+           ipc_method == other.ipc_method &&
+           search_path == other.search_path &&
+           server_version == other.server_version;
   }
 
   bool operator!=(const ScratchbirdRuntimeConfig& other) const {
@@ -8,6 +8,12 @@
 
 #include <QDebug>
 
+#include <atomic>
+#include <limits>
+#include <unordered_map>
+
+#include "backend/bulk_load_pipeline.h"
+
 #if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
 // Only include the driver client header - avoid conflicting headers
 #include <scratchbird/client/connection.h>
@@ -16,6 +22,55 @@
 namespace scratchrobin::backend {
 
 #if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+// Helper to append up to max_rows driver rows into the column buffers.
+// Returns true when the driver result set still has rows left. A cursor
+// passes |row_pending|: the row read ahead to find that out stays current
+// and is appended first by the next call.
+static bool AppendRows(scratchbird::client::ResultSet& rs,
+                       core::ResultSet& out,
+                       size_t max_rows,
+                       const std::atomic<bool>& cancel_requested,
+                       bool* row_pending = nullptr) {
+  auto& table = out.rows;
+  const size_t column_count = out.columns.size();
+  table.SetColumnCount(column_count);
+  bool have_row = row_pending && *row_pending;
+  if (row_pending) {
+    *row_pending = false;
+  }
+  for (size_t fetched = 0;; ++fetched) {
+    if (cancel_requested) {
+      return false;
+    }
+    if (!have_row && !rs.next()) {
+      return false;
+    }
+    have_row = false;
+    if (fetched == max_rows) {
+      if (row_pending) {
+        *row_pending = true;
+      }
+      return true;
+    }
+    for (size_t i = 0; i < column_count; ++i) {
+      if (rs.isNull(i)) {
+        table.Column(i).AppendNull();
+      } else {
+        table.Column(i).AppendText(rs.getString(i));
+      }
+    }
+    table.EndRow();
+  }
+}
+
+static std::vector<std::string> ColumnNames(scratchbird::client::ResultSet& rs) {
+  std::vector<std::string> names;
+  for (const auto& col : rs.getColumns()) {
+    names.push_back(col.name);
+  }
+  return names;
+}
+
 // Helper to convert driver ResultSet to QueryResponse
 static QueryResponse ConvertResultSetToResponse(
     scratchbird::client::ResultSet& rs,
@@ -24,27 +79,50 @@ static QueryResponse ConvertResultSetToResponse(
   QueryResponse response;
   response.status = core::Status::Ok();
   response.execution_path = execution_path;
+  response.result_set.columns = ColumnNames(rs);
   
-  // Get column names
-  const auto& columns = rs.getColumns();
-  for (const auto& col : columns) {
-    response.result_set.columns.push_back(col.name);
-  }
+  // Get rows, appending each cell directly into its column buffer
+  const std::atomic<bool> never_cancelled{false};
+  AppendRows(rs, response.result_set, std::numeric_limits<size_t>::max(),
+             never_cancelled);
   
-  // Get rows
-  while (rs.next()) {
-    std::vector<std::string> row;
-    for (size_t i = 0; i < columns.size(); ++i) {
-      if (rs.isNull(i)) {
-        row.push_back("NULL");
-      } else {
-        row.push_back(rs.getString(i));
+  return response;
+}
+
+// Helper to bind one QueryParameter by its declared type. Temporal and
+// UUID values travel as text and are cast by the server against the
+// parameter type it inferred while preparing.
+static scratchbird::core::Status BindParameter(
+    scratchbird::client::PreparedStatement& stmt,
+    size_t index,
+    const QueryParameter& param,
+    scratchbird::core::ErrorContext* ctx) {
+  switch (param.type) {
+    case QueryParameterType::kNull:
+      return stmt.bindNull(index, ctx);
+    case QueryParameterType::kBool:
+      return stmt.bindBool(index, std::get<bool>(param.value), ctx);
+    case QueryParameterType::kInt32:
+      return stmt.bindInt32(index, std::get<int32_t>(param.value), ctx);
+    case QueryParameterType::kInt64:
+      return stmt.bindInt64(index, std::get<int64_t>(param.value), ctx);
+    case QueryParameterType::kFloat:
+      return stmt.bindDouble(index, std::get<float>(param.value), ctx);
+    case QueryParameterType::kDouble:
+      return stmt.bindDouble(index, std::get<double>(param.value), ctx);
+    case QueryParameterType::kBytes:
+      return stmt.bindBytes(index, std::get<std::vector<uint8_t>>(param.value), ctx);
+    case QueryParameterType::kString:
+    case QueryParameterType::kTimestamp:
+    case QueryParameterType::kDate:
+    case QueryParameterType::kTime:
+    case QueryParameterType::kUuid:
+      if (const auto* text = std::get_if<std::string>(&param.value)) {
+        return stmt.bindString(index, *text, ctx);
       }
-    }
-    response.result_set.rows.push_back(std::move(row));
+      return stmt.bindNull(index, ctx);
   }
-  
-  return response;
+  return stmt.bindNull(index, ctx);
 }
 
 static std::string StatusToString(scratchbird::core::Status status) {
@@ -63,6 +141,54 @@ static std::string StatusToString(scratchbird::core::Status status) {
       return "UNKNOWN";
   }
 }
+
+static std::string ErrorText(scratchbird::core::Status status,
+                             const scratchbird::core::ErrorContext& ctx) {
+  return ctx.message.empty() ? StatusToString(status) : ctx.message;
+}
+
+namespace {
+
+// Bulk loads run on the client's driver connection
+class DriverBulkSession : public BulkLoadSession {
+ public:
+  explicit DriverBulkSession(scratchbird::client::Connection* connection)
+      : connection_(connection) {}
+
+  core::Status Execute(const std::string& sql) override {
+    scratchbird::client::ResultSet rs;
+    scratchbird::core::ErrorContext ctx;
+    return Check(connection_->executeQuery(sql, &rs, &ctx), ctx);
+  }
+  core::Status BeginTransaction() override {
+    scratchbird::core::ErrorContext ctx;
+    return Check(connection_->beginTransaction(&ctx), ctx);
+  }
+  core::Status Commit() override {
+    scratchbird::core::ErrorContext ctx;
+    return Check(connection_->commit(&ctx), ctx);
+  }
+  void Rollback() override {
+    scratchbird::core::ErrorContext ctx;
+    connection_->rollback(&ctx);
+  }
+  void Cancel() override {
+    scratchbird::core::ErrorContext ctx;
+    connection_->cancel(&ctx);
+  }
+  bool IsConnected() const override { return connection_->isConnected(); }
+
+ private:
+  static core::Status Check(scratchbird::core::Status status,
+                            const scratchbird::core::ErrorContext& ctx) {
+    return status == scratchbird::core::Status::OK ? core::Status::Ok()
+                                                   : core::Status::Error(ErrorText(status, ctx));
+  }
+
+  scratchbird::client::Connection* connection_;
+};
+
+}  // namespace
 #endif
 
 struct ScratchbirdSbwpClient::Impl {
@@ -70,14 +196,25 @@ struct ScratchbirdSbwpClient::Impl {
   std::unique_ptr<scratchbird::client::Connection> connection;
   scratchbird::client::ConnectionConfig sb_config;
   bool connected = false;
+  std::unique_ptr<scratchbird::client::ResultSet> cursor;
+  std::vector<std::string> cursor_columns;
+  bool cursor_row_pending = false;  // Read ahead by the last FetchRows
+  std::unordered_map<ScratchbirdSbwpClient::StatementHandle,
+                     std::unique_ptr<scratchbird::client::PreparedStatement>>
+      statements;
+  std::unique_ptr<BulkLoadPipeline> bulk_load;
 #endif
+  ScratchbirdSbwpClient::StatementHandle next_statement{1};
+  std::atomic<bool> cancel_requested{false};
 };
 
 ScratchbirdSbwpClient::ScratchbirdSbwpClient(ScratchbirdRuntimeConfig config)
     : config_(std::move(config)), impl_(std::make_unique<Impl>()) {
 }
 
-ScratchbirdSbwpClient::~ScratchbirdSbwpClient() = default;
+ScratchbirdSbwpClient::~ScratchbirdSbwpClient() {
+  AbortBulkLoad();
+}
 
 void ScratchbirdSbwpClient::SetConfig(ScratchbirdRuntimeConfig config) {
   config_ = std::move(config);
@@ -96,7 +233,11 @@ bool ScratchbirdSbwpClient::IsConnected() const {
 }
 
 void ScratchbirdSbwpClient::Disconnect() {
+  AbortBulkLoad();
+  CloseCursor();
 #if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  // Statements are scoped to the server session
+  impl_->statements.clear();
   if (impl_->connection) {
     impl_->connection->disconnect();
     impl_->connected = false;
@@ -155,6 +296,7 @@ QueryResponse ScratchbirdSbwpClient::ConnectIfNeeded() {
   }
   
   impl_->connected = true;
+  impl_->statements.clear();  // Handles from a previous session are stale
   qDebug() << "SBWP client connected to" << QString::fromStdString(config_.database);
   return QueryResponse{core::Status::Ok(), {}, "sbwp::connected"};
 #else
@@ -177,6 +319,7 @@ QueryResponse ScratchbirdSbwpClient::ExecuteSql(const std::string& sql) {
   scratchbird::client::ResultSet rs;
   scratchbird::core::ErrorContext ctx;
   
+  impl_->cancel_requested = false;
   auto status = impl_->connection->executeQuery(sql, &rs, &ctx);
   
   if (status != scratchbird::core::Status::OK) {
@@ -292,4 +435,302 @@ QueryResponse ScratchbirdSbwpClient::RollbackTransaction() {
 #endif
 }
 
+QueryResponse ScratchbirdSbwpClient::OpenCursor(const std::string& sql) {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  auto connect_response = ConnectIfNeeded();
+  if (!connect_response.status.ok && connect_response.execution_path != "sbwp::already_connected") {
+    return connect_response;
+  }
+  
+  CloseCursor();
+  impl_->cancel_requested = false;
+  
+  auto cursor = std::make_unique<scratchbird::client::ResultSet>();
+  scratchbird::core::ErrorContext ctx;
+  auto status = impl_->connection->executeQuery(sql, cursor.get(), &ctx);
+  
+  if (status != scratchbird::core::Status::OK) {
+    std::string error = "Query failed: ";
+    error += ctx.message.empty() ? StatusToString(status) : ctx.message;
+    return QueryResponse{core::Status::Error(error), {}, "sbwp::open_cursor_failed"};
+  }
+  
+  impl_->cursor_columns = ColumnNames(*cursor);
+  impl_->cursor = std::move(cursor);
+  
+  QueryResponse response;
+  response.status = core::Status::Ok();
+  response.execution_path = "sbwp::open_cursor";
+  response.result_set.columns = impl_->cursor_columns;
+  response.has_more = true;
+  return response;
+#else
+  (void)sql;
+  return QueryResponse{
+    core::Status::Error("SBWP support not compiled in"),
+    {},
+    "sbwp::not_compiled"
+  };
+#endif
+}
+
+QueryResponse ScratchbirdSbwpClient::FetchRows(std::size_t max_rows) {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  if (!impl_->cursor) {
+    return QueryResponse{core::Status::Error("No open cursor"), {}, "sbwp::no_cursor"};
+  }
+  
+  QueryResponse response;
+  response.execution_path = "sbwp::fetch_rows";
+  response.result_set.columns = impl_->cursor_columns;
+  response.has_more = AppendRows(*impl_->cursor, response.result_set, max_rows,
+                                 impl_->cancel_requested, &impl_->cursor_row_pending);
+  
+  if (impl_->cancel_requested) {
+    CloseCursor();
+    response.status = core::Status::Error("Query cancelled");
+    response.has_more = false;
+    return response;
+  }
+  
+  response.status = core::Status::Ok();
+  if (!response.has_more) {
+    CloseCursor();
+  }
+  return response;
+#else
+  (void)max_rows;
+  return QueryResponse{
+    core::Status::Error("SBWP support not compiled in"),
+    {},
+    "sbwp::not_compiled"
+  };
+#endif
+}
+
+void ScratchbirdSbwpClient::CloseCursor() {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  impl_->cursor.reset();
+  impl_->cursor_columns.clear();
+  impl_->cursor_row_pending = false;
+#endif
+}
+
+bool ScratchbirdSbwpClient::HasOpenCursor() const {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  return impl_->cursor != nullptr;
+#else
+  return false;
+#endif
+}
+
+bool ScratchbirdSbwpClient::CancelQuery() {
+  impl_->cancel_requested = true;
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  if (!impl_->connection || !impl_->connection->isConnected()) {
+    return false;
+  }
+  
+  scratchbird::core::ErrorContext ctx;
+  auto status = impl_->connection->cancel(&ctx);
+  if (status != scratchbird::core::Status::OK) {
+    qWarning() << "SBWP cancel failed:"
+               << QString::fromStdString(ctx.message.empty() ? StatusToString(status)
+                                                             : ctx.message);
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+QueryResponse ScratchbirdSbwpClient::Prepare(const std::string& sql,
+                                             StatementHandle* handle) {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  auto connect_response = ConnectIfNeeded();
+  if (!connect_response.status.ok && connect_response.execution_path != "sbwp::already_connected") {
+    return connect_response;
+  }
+  
+  auto stmt = std::make_unique<scratchbird::client::PreparedStatement>();
+  scratchbird::core::ErrorContext ctx;
+  auto status = impl_->connection->prepare(sql, stmt.get(), &ctx);
+  
+  if (status != scratchbird::core::Status::OK) {
+    std::string error = "Prepare failed: ";
+    error += ctx.message.empty() ? StatusToString(status) : ctx.message;
+    return QueryResponse{core::Status::Error(error), {}, "sbwp::prepare_failed"};
+  }
+  
+  const StatementHandle id = impl_->next_statement++;
+  impl_->statements.emplace(id, std::move(stmt));
+  if (handle) {
+    *handle = id;
+  }
+  return QueryResponse{core::Status::Ok(), {}, "sbwp::prepare"};
+#else
+  (void)sql;
+  (void)handle;
+  return QueryResponse{
+    core::Status::Error("SBWP support not compiled in"),
+    {},
+    "sbwp::not_compiled"
+  };
+#endif
+}
+
+QueryResponse ScratchbirdSbwpClient::ExecutePrepared(
+    StatementHandle handle, const std::vector<QueryParameter>& parameters) {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  auto it = impl_->statements.find(handle);
+  if (it == impl_->statements.end() || !IsConnected()) {
+    return QueryResponse{
+      core::Status::Error("Prepared statement is no longer valid"),
+      {},
+      "sbwp::stale_statement"
+    };
+  }
+  
+  auto& stmt = *it->second;
+  scratchbird::core::ErrorContext ctx;
+  auto status = stmt.clearBindings(&ctx);
+  for (size_t i = 0; i < parameters.size() && status == scratchbird::core::Status::OK; ++i) {
+    status = BindParameter(stmt, i, parameters[i], &ctx);
+  }
+  if (status != scratchbird::core::Status::OK) {
+    std::string error = "Bind failed: ";
+    error += ctx.message.empty() ? StatusToString(status) : ctx.message;
+    return QueryResponse{core::Status::Error(error), {}, "sbwp::bind_failed"};
+  }
+  
+  scratchbird::client::ResultSet rs;
+  impl_->cancel_requested = false;
+  status = stmt.execute(&rs, &ctx);
+  
+  if (status != scratchbird::core::Status::OK) {
+    std::string error = "Query failed: ";
+    error += ctx.message.empty() ? StatusToString(status) : ctx.message;
+    return QueryResponse{core::Status::Error(error), {}, "sbwp::query_failed"};
+  }
+  
+  return ConvertResultSetToResponse(rs, "sbwp::execute_prepared");
+#else
+  (void)handle;
+  (void)parameters;
+  return QueryResponse{
+    core::Status::Error("SBWP support not compiled in"),
+    {},
+    "sbwp::not_compiled"
+  };
+#endif
+}
+
+void ScratchbirdSbwpClient::ClosePrepared(StatementHandle handle) {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  auto it = impl_->statements.find(handle);
+  if (it == impl_->statements.end()) {
+    return;
+  }
+  if (IsConnected()) {
+    scratchbird::core::ErrorContext ctx;
+    it->second->close(&ctx);
+  }
+  impl_->statements.erase(it);
+#else
+  (void)handle;
+#endif
+}
+
+QueryResponse ScratchbirdSbwpClient::BeginBulkLoad(const BulkLoadOptions& options) {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  if (impl_->bulk_load) {
+    return QueryResponse{core::Status::Error("A bulk load is already running"), {},
+                         "sbwp::bulk_load_active"};
+  }
+  if (options.table.empty() || options.columns.empty()) {
+    return QueryResponse{core::Status::Error("Bulk load needs a table and columns"), {},
+                         "sbwp::bulk_load_failed"};
+  }
+  auto connect_response = ConnectIfNeeded();
+  if (!connect_response.status.ok && connect_response.execution_path != "sbwp::already_connected") {
+    return connect_response;
+  }
+  
+  CloseCursor();
+  impl_->cancel_requested = false;
+  auto pipeline = std::make_unique<BulkLoadPipeline>(
+      std::make_unique<DriverBulkSession>(impl_->connection.get()), options);
+  core::Status started = pipeline->Start();
+  if (!started.ok) {
+    return QueryResponse{started, {}, "sbwp::bulk_load_failed"};
+  }
+  impl_->bulk_load = std::move(pipeline);
+  return QueryResponse{core::Status::Ok(), {}, "sbwp::bulk_load_begin"};
+#else
+  (void)options;
+  return QueryResponse{
+    core::Status::Error("SBWP support not compiled in"),
+    {},
+    "sbwp::not_compiled"
+  };
+#endif
+}
+
+QueryResponse ScratchbirdSbwpClient::BulkLoadRows(const core::ResultSet& rows,
+                                                  std::int64_t first_row) {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  if (!impl_->bulk_load) {
+    return QueryResponse{core::Status::Error("No bulk load running"), {},
+                         "sbwp::no_bulk_load"};
+  }
+  core::Status status = impl_->bulk_load->Add(rows, first_row);
+  return QueryResponse{status, {}, status.ok ? "sbwp::bulk_load_rows" : "sbwp::bulk_load_failed"};
+#else
+  (void)rows;
+  (void)first_row;
+  return QueryResponse{
+    core::Status::Error("SBWP support not compiled in"),
+    {},
+    "sbwp::not_compiled"
+  };
+#endif
+}
+
+QueryResponse ScratchbirdSbwpClient::EndBulkLoad(BulkLoadReport* report) {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  if (!impl_->bulk_load) {
+    return QueryResponse{core::Status::Error("No bulk load running"), {},
+                         "sbwp::no_bulk_load"};
+  }
+  core::Status status = impl_->bulk_load->Finish(report);
+  impl_->bulk_load.reset();
+  return QueryResponse{status, {}, status.ok ? "sbwp::bulk_load_end" : "sbwp::bulk_load_failed"};
+#else
+  (void)report;
+  return QueryResponse{
+    core::Status::Error("SBWP support not compiled in"),
+    {},
+    "sbwp::not_compiled"
+  };
+#endif
+}
+
+void ScratchbirdSbwpClient::AbortBulkLoad() {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  if (impl_->bulk_load) {
+    impl_->bulk_load->Abort();
+    impl_->bulk_load.reset();
+  }
+#endif
+}
+
+bool ScratchbirdSbwpClient::InBulkLoad() const {
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  return impl_->bulk_load != nullptr;
+#else
+  return false;
+#endif
+}
+
 }  // namespace scratchrobin::backend
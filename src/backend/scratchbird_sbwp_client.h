@@ -10,18 +10,24 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
+#include "backend/prepared_statement_cache.h"
+#include "backend/query_request.h"
 #include "backend/query_response.h"
 #include "backend/scratchbird_runtime_config.h"
 
 namespace scratchrobin::backend {
 
-class ScratchbirdSbwpClient {
+class ScratchbirdSbwpClient : public PreparedStatementSession {
  public:
   explicit ScratchbirdSbwpClient(ScratchbirdRuntimeConfig config = {});
-  ~ScratchbirdSbwpClient();
+  ~ScratchbirdSbwpClient() override;
 
   ScratchbirdSbwpClient(const ScratchbirdSbwpClient&) = delete;
   ScratchbirdSbwpClient& operator=(const ScratchbirdSbwpClient&) = delete;
@@ -34,6 +40,69 @@ class ScratchbirdSbwpClient {
   QueryResponse CommitTransaction();
   QueryResponse RollbackTransaction();
 
+  // Streaming cursor (one open cursor per client). OpenCursor returns the
+  // column names only; rows are pulled in batches with FetchRows.
+  QueryResponse OpenCursor(const std::string& sql);
+  QueryResponse FetchRows(std::size_t max_rows);
+  void CloseCursor();
+  bool HasOpenCursor() const;
+
+  // Server-side cancel of the running statement; callable from any thread.
+  bool CancelQuery();
+
+  // Server-side prepared statements. Prepare parses and plans once and
+  // returns a handle; ExecutePrepared binds the parameters in order and
+  // runs the plan without resending the SQL. Handles die with the session:
+  // after a reconnect ExecutePrepared fails with "sbwp::stale_statement".
+  using StatementHandle = Handle;
+  QueryResponse Prepare(const std::string& sql, StatementHandle* handle) override;
+  QueryResponse ExecutePrepared(StatementHandle handle,
+                                const std::vector<QueryParameter>& parameters) override;
+  void ClosePrepared(StatementHandle handle) override;
+
+  // Bulk load pipeline. BulkLoadRows converts rows into multi-row INSERTs
+  // packed up to target_packet_bytes and queues them; a sender thread
+  // drains the queue, so conversion on the caller's thread overlaps the
+  // round trips. BulkLoadRows blocks while queue_depth statements are
+  // pending. A statement the server rejects is split and retried until the
+  // bad rows are isolated; they are reported by EndBulkLoad and the load
+  // carries on. No other call may use the client until the load ends.
+  struct BulkLoadColumn {
+    std::string name;         // Target column, quoted as needed; empty
+                              // names send values in table order
+    std::size_t source{0};    // Column of the rows given to BulkLoadRows
+    std::optional<std::string> default_literal;  // SQL literal for NULLs
+  };
+  struct BulkLoadOptions {
+    std::string table;        // Qualified and quoted as needed
+    std::vector<BulkLoadColumn> columns;
+    std::string setup_sql;    // Runs first, inside the load's transaction
+    std::size_t target_packet_bytes{256 * 1024};
+    std::size_t max_rows_per_statement{5000};
+    std::size_t queue_depth{4};
+    bool use_transaction{true};
+    std::int64_t commit_every_rows{0};  // 0 commits once at the end
+    bool stop_on_error{false};          // Fail the load on the first bad row
+  };
+  struct BulkLoadError {
+    std::int64_t row{0};
+    std::string message;
+  };
+  struct BulkLoadReport {
+    std::int64_t rows_loaded{0};
+    std::int64_t rows_failed{0};
+    std::int64_t statements{0};
+    std::vector<BulkLoadError> errors;
+  };
+  QueryResponse BeginBulkLoad(const BulkLoadOptions& options);
+  // Row r of |rows| is reported as row first_row + r.
+  QueryResponse BulkLoadRows(const core::ResultSet& rows, std::int64_t first_row);
+  // Flushes, waits for the sender and commits; |report| may be null.
+  QueryResponse EndBulkLoad(BulkLoadReport* report);
+  // Drops queued statements and rolls back what was not yet committed.
+  void AbortBulkLoad();
+  bool InBulkLoad() const;
+
   bool IsConnected() const;
   void Disconnect();
 
@@ -0,0 +1,811 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/arrow_ipc_format.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace scratchrobin::core {
+
+namespace {
+
+// Enumerations from Schema.fbs and Message.fbs
+constexpr int kMetadataV5 = 4;
+enum MessageHeader : int { kHeaderSchema = 1, kHeaderDictionaryBatch = 2, kHeaderRecordBatch = 3 };
+enum TypeId : int {
+  kTypeNull = 1,
+  kTypeInt = 2,
+  kTypeFloatingPoint = 3,
+  kTypeBinary = 4,
+  kTypeUtf8 = 5,
+  kTypeBool = 6,
+  kTypeDate = 8,
+  kTypeList = 12,
+  kTypeStruct = 13,
+  kTypeUnion = 14,
+  kTypeFixedSizeList = 16,
+  kTypeMap = 17,
+  kTypeLargeBinary = 19,
+  kTypeLargeUtf8 = 20,
+  kTypeLargeList = 21,
+  kTypeRunEndEncoded = 22,
+  kTypeBinaryView = 23,
+  kTypeUtf8View = 24,
+  kTypeListView = 25,
+  kTypeLargeListView = 26,
+};
+constexpr int kPrecisionSingle = 1;
+constexpr int kPrecisionDouble = 2;
+constexpr int kDateUnitDay = 0;
+constexpr int kDateUnitMillisecond = 1;
+
+constexpr std::uint32_t kContinuation = 0xFFFFFFFF;
+constexpr std::string_view kFileMagic("ARROW1\0\0", 8);
+constexpr std::int64_t kMillisPerDay = 86400000;
+
+using Pairs = std::vector<std::pair<std::int64_t, std::int64_t>>;
+
+std::uint64_t GetLE(const char* data, int bytes) {
+  std::uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i) {
+    value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+  }
+  return value;
+}
+
+void PutLE(std::uint64_t value, int bytes, std::string& out) {
+  for (int i = 0; i < bytes; ++i) {
+    out.push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+void SetLE(std::uint64_t value, int bytes, char* out) {
+  for (int i = 0; i < bytes; ++i) {
+    out[i] = static_cast<char>(value >> (8 * i));
+  }
+}
+
+// Pads |out| to a multiple of 8 bytes past |base|.
+void PadTo8(std::string& out, std::size_t base) {
+  out.append((8 - (out.size() - base) % 8) % 8, '\0');
+}
+
+// ============================================================================
+// FlatBuffers
+// ============================================================================
+
+// Builds a flatbuffer front to back: parents are written before their
+// children and offset fields patched once the child is placed, so every
+// uoffset points forward as the format requires. Vtables precede their
+// tables and are not shared.
+class FlatBufferWriter {
+ public:
+  struct Field {
+    int id;
+    int size;  // 1, 2, 4 or 8; 0 = offset to a child
+    std::uint64_t value;
+  };
+
+  explicit FlatBufferWriter(std::string* out) : out_(out), base_(out->size()) {}
+
+  // Reserves a uoffset; Patch() points it at a child.
+  std::size_t Slot() {
+    const std::size_t slot = Pos();
+    PutLE(0, 4, *out_);
+    return slot;
+  }
+  void Patch(std::size_t slot, std::size_t target) {
+    SetLE(target - slot, 4, out_->data() + base_ + slot);
+  }
+
+  // Writes a table and returns its position; |slots| receives the slots
+  // of its offset fields in the order given.
+  std::size_t Table(const std::vector<Field>& fields, std::vector<std::size_t>* slots = nullptr) {
+    // Widest first keeps every field aligned without padding
+    std::vector<std::size_t> order(fields.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+      return Bytes(fields[a]) > Bytes(fields[b]);
+    });
+    int max_id = -1;
+    std::size_t table_size = 4;
+    for (const Field& field : fields) {
+      max_id = std::max(max_id, field.id);
+      table_size += Bytes(field);
+    }
+    const bool wide = !order.empty() && Bytes(fields[order.front()]) == 8;
+
+    std::vector<std::uint16_t> entries(static_cast<std::size_t>(max_id + 1), 0);
+    std::size_t at = 4;
+    for (std::size_t i : order) {
+      entries[static_cast<std::size_t>(fields[i].id)] = static_cast<std::uint16_t>(at);
+      at += Bytes(fields[i]);
+    }
+    Align(2, 0);
+    const std::size_t vtable = Pos();
+    PutLE(4 + 2 * entries.size(), 2, *out_);
+    PutLE(table_size, 2, *out_);
+    for (std::uint16_t entry : entries) {
+      PutLE(entry, 2, *out_);
+    }
+
+    // 8-byte fields follow the 4-byte vtable offset, so start at 4 mod 8
+    Align(wide ? 8 : 4, wide ? 4 : 0);
+    const std::size_t table = Pos();
+    PutLE(table - vtable, 4, *out_);
+    std::vector<std::size_t> field_slots(fields.size());
+    for (std::size_t i : order) {
+      if (fields[i].size == 0) {
+        field_slots[i] = Slot();
+      } else {
+        PutLE(fields[i].value, fields[i].size, *out_);
+      }
+    }
+    if (slots) {
+      slots->clear();
+      for (std::size_t i = 0; i < fields.size(); ++i) {
+        if (fields[i].size == 0) {
+          slots->push_back(field_slots[i]);
+        }
+      }
+    }
+    return table;
+  }
+
+  std::size_t String(std::string_view text) {
+    Align(4, 0);
+    const std::size_t pos = Pos();
+    PutLE(text.size(), 4, *out_);
+    out_->append(text);
+    out_->push_back('\0');
+    return pos;
+  }
+
+  // Writes a vector of |count| offsets, element i at position + 4 + 4 * i.
+  std::size_t OffsetVector(std::size_t count) {
+    Align(4, 0);
+    const std::size_t pos = Pos();
+    PutLE(count, 4, *out_);
+    out_->append(4 * count, '\0');
+    return pos;
+  }
+
+  // Vector of structs made of two longs (FieldNode, Buffer).
+  std::size_t PairVector(const Pairs& pairs) {
+    Align(8, 4);
+    const std::size_t pos = Pos();
+    PutLE(pairs.size(), 4, *out_);
+    for (const auto& [first, second] : pairs) {
+      PutLE(static_cast<std::uint64_t>(first), 8, *out_);
+      PutLE(static_cast<std::uint64_t>(second), 8, *out_);
+    }
+    return pos;
+  }
+
+ private:
+  static std::size_t Bytes(const Field& field) {
+    return field.size ? static_cast<std::size_t>(field.size) : 4;
+  }
+  std::size_t Pos() const { return out_->size() - base_; }
+  void Align(std::size_t alignment, std::size_t phase) {
+    while (Pos() % alignment != phase) {
+      out_->push_back('\0');
+    }
+  }
+
+  std::string* out_;
+  std::size_t base_;
+};
+
+// Bounds-checked view of one flatbuffer table; lookups on an invalid
+// table return defaults and invalid children.
+class FlatTable {
+ public:
+  FlatTable() = default;
+  FlatTable(std::string_view buffer, std::uint64_t pos) : buffer_(buffer) {
+    if (pos > buffer.size() || buffer.size() - pos < 4) {
+      return;
+    }
+    pos_ = static_cast<std::size_t>(pos);
+    const auto offset = static_cast<std::int32_t>(GetLE(buffer.data() + pos_, 4));
+    const std::int64_t vtable = static_cast<std::int64_t>(pos_) - offset;
+    if (vtable < 0 || static_cast<std::uint64_t>(vtable) + 4 > buffer.size()) {
+      return;
+    }
+    vtable_ = static_cast<std::size_t>(vtable);
+    vtable_size_ = static_cast<std::size_t>(GetLE(buffer.data() + vtable_, 2));
+    table_size_ = static_cast<std::size_t>(GetLE(buffer.data() + vtable_ + 2, 2));
+    valid_ = vtable_size_ >= 4 && vtable_size_ <= buffer.size() - vtable_ &&
+             table_size_ <= buffer.size() - pos_;
+  }
+
+  bool Valid() const { return valid_; }
+  bool Has(int id) const { return FieldPos(id, 1) != 0; }
+
+  std::uint64_t Scalar(int id, int bytes, std::uint64_t fallback) const {
+    const std::size_t pos = FieldPos(id, static_cast<std::size_t>(bytes));
+    return pos ? GetLE(buffer_.data() + pos, bytes) : fallback;
+  }
+
+  FlatTable Table(int id) const {
+    const std::size_t target = Target(id);
+    return target ? FlatTable(buffer_, target) : FlatTable();
+  }
+
+  std::string_view String(int id) const {
+    std::size_t start = 0;
+    std::size_t count = 0;
+    return Vector(id, 1, &start, &count) ? buffer_.substr(start, count) : std::string_view();
+  }
+
+  // Locates a vector of |element_bytes| elements.
+  bool Vector(int id, std::size_t element_bytes, std::size_t* start, std::size_t* count) const {
+    const std::size_t target = Target(id);
+    if (!target || buffer_.size() - target < 4) {
+      return false;
+    }
+    *count = static_cast<std::size_t>(GetLE(buffer_.data() + target, 4));
+    *start = target + 4;
+    return *count <= (buffer_.size() - *start) / element_bytes;
+  }
+
+  // Element |index| of a vector of tables starting at |start|.
+  FlatTable TableAt(std::size_t start, std::size_t index) const {
+    const std::size_t slot = start + 4 * index;
+    return FlatTable(buffer_, slot + GetLE(buffer_.data() + slot, 4));
+  }
+
+  std::int64_t Long(std::size_t pos) const {
+    return static_cast<std::int64_t>(GetLE(buffer_.data() + pos, 8));
+  }
+
+ private:
+  std::size_t FieldPos(int id, std::size_t bytes) const {
+    const std::size_t entry = 4 + 2 * static_cast<std::size_t>(id);
+    if (!valid_ || entry + 2 > vtable_size_) {
+      return 0;
+    }
+    const auto offset = static_cast<std::size_t>(GetLE(buffer_.data() + vtable_ + entry, 2));
+    if (offset == 0 || offset + bytes > table_size_) {
+      return 0;
+    }
+    return pos_ + offset;
+  }
+
+  std::size_t Target(int id) const {
+    const std::size_t pos = FieldPos(id, 4);
+    if (!pos) {
+      return 0;
+    }
+    const std::uint64_t target = pos + GetLE(buffer_.data() + pos, 4);
+    return target < buffer_.size() ? static_cast<std::size_t>(target) : 0;
+  }
+
+  std::string_view buffer_;
+  std::size_t pos_{0};
+  std::size_t vtable_{0};
+  std::size_t vtable_size_{0};
+  std::size_t table_size_{0};
+  bool valid_{false};
+};
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+// Frames one message: continuation marker, metadata length, the Message
+// flatbuffer padded to 8 bytes, then the body. |header| writes the header
+// table and points the given slot at it.
+template <typename WriteHeader>
+void AppendMessage(int header_type, std::size_t body_length, std::string* out,
+                   WriteHeader&& header) {
+  const std::size_t message = out->size();
+  PutLE(kContinuation, 4, *out);
+  PutLE(0, 4, *out);
+  const std::size_t start = out->size();
+  FlatBufferWriter writer(out);
+  const std::size_t root = writer.Slot();
+  std::vector<std::size_t> slots;
+  writer.Patch(root, writer.Table({{0, 2, kMetadataV5},
+                                   {1, 1, static_cast<std::uint64_t>(header_type)},
+                                   {2, 0, 0},
+                                   {3, 8, body_length}},
+                                  &slots));
+  header(writer, slots[0]);
+  PadTo8(*out, message);
+  SetLE(out->size() - start, 4, out->data() + start - 4);
+}
+
+}  // namespace
+
+void AppendArrowSchemaMessage(const ColumnarSchema& schema, std::string* out) {
+  AppendMessage(kHeaderSchema, 0, out, [&](FlatBufferWriter& writer, std::size_t header) {
+    std::vector<std::size_t> slots;
+    writer.Patch(header, writer.Table({{1, 0, 0}}, &slots));
+    const std::size_t fields = writer.OffsetVector(schema.names.size());
+    writer.Patch(slots[0], fields);
+    for (std::size_t i = 0; i < schema.names.size(); ++i) {
+      const ColumnType type = ColumnarStorageType(schema.types[i]);
+      const int type_id = type == ColumnType::kInt64    ? kTypeInt
+                          : type == ColumnType::kDouble ? kTypeFloatingPoint
+                          : type == ColumnType::kDate   ? kTypeDate
+                                                        : kTypeUtf8;
+      std::vector<std::size_t> field_slots;
+      writer.Patch(fields + 4 + 4 * i,
+                   writer.Table({{0, 0, 0},
+                                 {1, 1, 1},
+                                 {2, 1, static_cast<std::uint64_t>(type_id)},
+                                 {3, 0, 0},
+                                 {5, 0, 0}},
+                                &field_slots));
+      writer.Patch(field_slots[0], writer.String(schema.names[i]));
+      switch (type_id) {
+        case kTypeInt:
+          writer.Patch(field_slots[1], writer.Table({{0, 4, 64}, {1, 1, 1}}));
+          break;
+        case kTypeFloatingPoint:
+          writer.Patch(field_slots[1], writer.Table({{0, 2, kPrecisionDouble}}));
+          break;
+        case kTypeDate:
+          writer.Patch(field_slots[1], writer.Table({{0, 2, kDateUnitDay}}));
+          break;
+        default:
+          writer.Patch(field_slots[1], writer.Table({}));
+          break;
+      }
+      writer.Patch(field_slots[2], writer.OffsetVector(0));
+    }
+  });
+}
+
+Status AppendArrowRecordBatch(const ColumnarSchema& schema,
+                              const std::vector<const ColumnBuffer*>& columns,
+                              std::size_t begin, std::size_t end, std::string* out) {
+  if (columns.size() != schema.types.size()) {
+    return Status::Error("Arrow record batch does not match the schema");
+  }
+  const std::size_t rows = end - begin;
+  std::string body;
+  Pairs nodes;
+  Pairs buffers;
+  auto open_buffer = [&] { buffers.emplace_back(static_cast<std::int64_t>(body.size()), 0); };
+  auto close_buffer = [&] {
+    buffers.back().second = static_cast<std::int64_t>(body.size()) - buffers.back().first;
+    PadTo8(body, 0);
+  };
+
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    const ColumnType type = ColumnarStorageType(schema.types[i]);
+    std::size_t first = begin;
+    std::size_t last = end;
+    ColumnBuffer scratch;
+    const ColumnBuffer* column = ColumnarValues(*columns[i], type, &first, &last, &scratch);
+    if (!column) {
+      return Status::Error("Column " + schema.names[i] + " holds " + ToString(columns[i]->Type()) +
+                           " values but the file stores " + ToString(type));
+    }
+
+    // Validity bitmap, omitted (zero length) when nothing is NULL
+    std::int64_t null_count = 0;
+    for (std::size_t row = first; row < last; ++row) {
+      null_count += column->IsNull(row) ? 1 : 0;
+    }
+    nodes.emplace_back(static_cast<std::int64_t>(rows), null_count);
+    open_buffer();
+    if (null_count > 0) {
+      const std::size_t bitmap = body.size();
+      body.append((rows + 7) / 8, '\0');
+      for (std::size_t row = first; row < last; ++row) {
+        if (!column->IsNull(row)) {
+          body[bitmap + (row - first) / 8] |= static_cast<char>(1 << ((row - first) % 8));
+        }
+      }
+    }
+    close_buffer();
+
+    if (type != ColumnType::kText) {
+      open_buffer();
+      for (std::size_t row = first; row < last; ++row) {
+        const bool is_null = column->IsNull(row);
+        switch (type) {
+          case ColumnType::kInt64:
+            PutLE(is_null ? 0 : static_cast<std::uint64_t>(column->Int64At(row)), 8, body);
+            break;
+          case ColumnType::kDouble: {
+            std::uint64_t bits = 0;
+            if (!is_null) {
+              const double value = column->DoubleAt(row);
+              std::memcpy(&bits, &value, sizeof(bits));
+            }
+            PutLE(bits, 8, body);
+            break;
+          }
+          default:
+            PutLE(is_null ? 0 : static_cast<std::uint32_t>(column->DateAt(row)), 4, body);
+            break;
+        }
+      }
+      close_buffer();
+      continue;
+    }
+
+    // Utf8: int32 offsets, then the bytes
+    open_buffer();
+    const std::size_t offsets = body.size();
+    body.append(4 * (rows + 1), '\0');
+    close_buffer();
+    open_buffer();
+    const std::size_t data = body.size();
+    for (std::size_t row = first; row < last; ++row) {
+      if (!column->IsNull(row)) {
+        body.append(column->TextAt(row));
+      }
+      const std::size_t size = body.size() - data;
+      if (size > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max())) {
+        return Status::Error("Column " + schema.names[i] +
+                             " holds over 2 GiB of text in one record batch");
+      }
+      SetLE(size, 4, body.data() + offsets + 4 * (row - first + 1));
+    }
+    close_buffer();
+  }
+
+  AppendMessage(kHeaderRecordBatch, body.size(), out,
+                [&](FlatBufferWriter& writer, std::size_t header) {
+                  std::vector<std::size_t> slots;
+                  writer.Patch(header, writer.Table({{0, 8, rows}, {1, 0, 0}, {2, 0, 0}}, &slots));
+                  writer.Patch(slots[0], writer.PairVector(nodes));
+                  writer.Patch(slots[1], writer.PairVector(buffers));
+                });
+  *out += body;
+  return Status::Ok();
+}
+
+void AppendArrowEndOfStream(std::string* out) {
+  PutLE(kContinuation, 4, *out);
+  PutLE(0, 4, *out);
+}
+
+// ============================================================================
+// ArrowIpcReader
+// ============================================================================
+
+Status ArrowIpcReader::Open(std::string_view stream) {
+  schema_ = ColumnarSchema{};
+  columns_.clear();
+  batches_.clear();
+  total_rows_ = 0;
+
+  std::size_t pos = stream.substr(0, kFileMagic.size()) == kFileMagic ? kFileMagic.size() : 0;
+  bool have_schema = false;
+  while (stream.size() - pos >= 4) {
+    std::uint64_t length = GetLE(stream.data() + pos, 4);
+    pos += 4;
+    if (length == kContinuation) {
+      if (stream.size() - pos < 4) {
+        break;
+      }
+      length = GetLE(stream.data() + pos, 4);
+      pos += 4;
+    }
+    if (length == 0) {
+      break;  // End of stream
+    }
+    if (length < 4 || length > stream.size() - pos) {
+      return Status::Error(have_schema ? "Truncated Arrow IPC stream" : "Not an Arrow IPC stream");
+    }
+    const std::string_view metadata = stream.substr(pos, static_cast<std::size_t>(length));
+    pos += static_cast<std::size_t>(length);
+
+    const FlatTable message(metadata, GetLE(metadata.data(), 4));
+    const auto body_length = static_cast<std::int64_t>(message.Scalar(3, 8, 0));
+    if (!message.Valid() || body_length < 0 ||
+        static_cast<std::uint64_t>(body_length) > stream.size() - pos) {
+      return Status::Error(have_schema ? "Corrupt Arrow IPC message" : "Not an Arrow IPC stream");
+    }
+    const std::string_view body = stream.substr(pos, static_cast<std::size_t>(body_length));
+    pos += static_cast<std::size_t>(body_length);
+
+    Status status = Status::Ok();
+    switch (message.Scalar(1, 1, 0)) {
+      case kHeaderSchema:
+        if (have_schema) {
+          return Status::Error("Arrow IPC stream holds more than one schema");
+        }
+        have_schema = true;
+        status = ParseSchema(metadata);
+        break;
+      case kHeaderRecordBatch:
+        if (!have_schema) {
+          return Status::Error("Arrow IPC stream does not start with a schema");
+        }
+        status = ParseBatch(metadata, body);
+        break;
+      case kHeaderDictionaryBatch:
+        return Status::Error("Dictionary-encoded Arrow columns are not supported");
+      default:
+        break;
+    }
+    if (!status.ok) {
+      return status;
+    }
+  }
+  if (!have_schema) {
+    return Status::Error("Not an Arrow IPC stream");
+  }
+  return Status::Ok();
+}
+
+Status ArrowIpcReader::ParseSchema(std::string_view metadata) {
+  const FlatTable header = FlatTable(metadata, GetLE(metadata.data(), 4)).Table(2);
+  std::size_t start = 0;
+  std::size_t count = 0;
+  if (!header.Vector(1, 4, &start, &count)) {
+    return Status::Error("Corrupt Arrow schema");
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    const FlatTable field = header.TableAt(start, i);
+    const FlatTable type = field.Table(3);
+    if (!field.Valid()) {
+      return Status::Error("Corrupt Arrow schema");
+    }
+    std::size_t children_start = 0;
+    std::size_t children = 0;
+    if (field.Vector(5, 4, &children_start, &children) && children > 0) {
+      return Status::Error("Nested Arrow schemas are not supported");
+    }
+    if (field.Has(4)) {
+      return Status::Error("Dictionary-encoded Arrow columns are not supported");
+    }
+
+    Column column;
+    ColumnType column_type = ColumnType::kText;
+    const auto type_id = static_cast<int>(field.Scalar(2, 1, 0));
+    switch (type_id) {
+      case kTypeNull:
+        column.kind = Kind::kNull;
+        column.buffer_count = 0;
+        break;
+      case kTypeBool:
+        column.kind = Kind::kBool;
+        column_type = ColumnType::kInt64;
+        break;
+      case kTypeInt: {
+        const auto bits = type.Scalar(0, 4, 0);
+        if (bits == 8 || bits == 16 || bits == 32 || bits == 64) {
+          column.kind = Kind::kInt;
+          column.width = static_cast<int>(bits / 8);
+          column.is_signed = type.Scalar(1, 1, 0) != 0;
+        }
+        column_type = ColumnType::kInt64;
+        break;
+      }
+      case kTypeFloatingPoint: {
+        const auto precision = static_cast<int>(type.Scalar(0, 2, 0));
+        if (precision == kPrecisionSingle || precision == kPrecisionDouble) {
+          column.kind = Kind::kFloat;
+          column.width = precision == kPrecisionSingle ? 4 : 8;
+        }
+        column_type = ColumnType::kDouble;
+        break;
+      }
+      case kTypeDate:
+        column.kind = Kind::kDate;
+        column.millis = type.Scalar(0, 2, kDateUnitMillisecond) == kDateUnitMillisecond;
+        column.width = column.millis ? 8 : 4;
+        column_type = ColumnType::kDate;
+        break;
+      case kTypeBinary:
+      case kTypeUtf8:
+      case kTypeLargeBinary:
+      case kTypeLargeUtf8:
+        column.kind = Kind::kText;
+        column.width = type_id == kTypeLargeBinary || type_id == kTypeLargeUtf8 ? 8 : 4;
+        column.buffer_count = 3;
+        break;
+      case kTypeList:
+      case kTypeStruct:
+      case kTypeUnion:
+      case kTypeFixedSizeList:
+      case kTypeMap:
+      case kTypeLargeList:
+      case kTypeRunEndEncoded:
+      case kTypeListView:
+      case kTypeLargeListView:
+        return Status::Error("Nested Arrow schemas are not supported");
+      case kTypeBinaryView:
+      case kTypeUtf8View:
+        return Status::Error("Arrow view types are not supported");
+      default:
+        break;  // Other flat types use validity + one data buffer
+    }
+    columns_.push_back(column);
+    schema_.names.emplace_back(field.String(0));
+    schema_.types.push_back(column_type);
+  }
+  return Status::Ok();
+}
+
+Status ArrowIpcReader::ParseBatch(std::string_view metadata, std::string_view body) {
+  const FlatTable header = FlatTable(metadata, GetLE(metadata.data(), 4)).Table(2);
+  if (header.Has(3)) {
+    return Status::Error("Compressed Arrow record batches are not supported");
+  }
+  std::size_t node_start = 0;
+  std::size_t node_count = 0;
+  std::size_t buffer_start = 0;
+  std::size_t buffer_count = 0;
+  if (!header.Valid() || !header.Vector(1, 16, &node_start, &node_count) ||
+      !header.Vector(2, 16, &buffer_start, &buffer_count) || node_count != columns_.size()) {
+    return Status::Error("Corrupt Arrow record batch");
+  }
+
+  Batch batch;
+  batch.num_rows = static_cast<std::int64_t>(header.Scalar(0, 8, 0));
+  std::size_t next_buffer = 0;
+  for (std::size_t i = 0; i < node_count; ++i) {
+    Node node;
+    node.length = header.Long(node_start + 16 * i);
+    node.null_count = header.Long(node_start + 16 * i + 8);
+    node.first_buffer = next_buffer;
+    next_buffer += static_cast<std::size_t>(columns_[i].buffer_count);
+    if (node.length != batch.num_rows || node.null_count < 0 || node.null_count > node.length) {
+      return Status::Error("Corrupt Arrow record batch");
+    }
+    batch.nodes.push_back(node);
+  }
+  if (batch.num_rows < 0 || next_buffer > buffer_count) {
+    return Status::Error("Corrupt Arrow record batch");
+  }
+  for (std::size_t i = 0; i < buffer_count; ++i) {
+    const std::int64_t offset = header.Long(buffer_start + 16 * i);
+    const std::int64_t length = header.Long(buffer_start + 16 * i + 8);
+    if (offset < 0 || length < 0 || static_cast<std::uint64_t>(offset) > body.size() ||
+        static_cast<std::uint64_t>(length) > body.size() - static_cast<std::uint64_t>(offset)) {
+      return Status::Error("Arrow buffer lies outside its record batch");
+    }
+    batch.buffers.push_back(body.substr(static_cast<std::size_t>(offset),
+                                        static_cast<std::size_t>(length)));
+  }
+  total_rows_ += batch.num_rows;
+  batches_.push_back(std::move(batch));
+  return Status::Ok();
+}
+
+std::int64_t ArrowIpcReader::BatchRows(std::size_t batch) const {
+  return batch < batches_.size() ? batches_[batch].num_rows : 0;
+}
+
+Status ArrowIpcReader::ReadBatch(std::size_t batch_index, const std::vector<std::size_t>& columns,
+                                 ColumnTable* out) const {
+  if (batch_index >= batches_.size()) {
+    return Status::Error("No such Arrow record batch");
+  }
+  const Batch& batch = batches_[batch_index];
+  const auto rows = static_cast<std::size_t>(batch.num_rows);
+  auto corrupt = [&](std::size_t index) {
+    return Status::Error("Arrow column " + schema_.names[index] + " has truncated buffers");
+  };
+
+  *out = ColumnTable{};
+  out->SetColumnCount(columns.size());
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    const std::size_t index = columns[i];
+    if (index >= columns_.size()) {
+      return Status::Error("No such Arrow column");
+    }
+    const Column& column = columns_[index];
+    if (column.kind == Kind::kUnsupported) {
+      return Status::Error("Arrow column " + schema_.names[index] + " has an unsupported type");
+    }
+    out->SetColumnType(i, schema_.types[index]);
+    ColumnBuffer& target = out->Column(i);
+    target.Reserve(rows);
+    if (column.kind == Kind::kNull) {
+      for (std::size_t row = 0; row < rows; ++row) {
+        target.AppendNull();
+      }
+      continue;
+    }
+
+    const Node& node = batch.nodes[index];
+    const std::string_view* buffers = &batch.buffers[node.first_buffer];
+    const std::string_view validity = node.null_count > 0 ? buffers[0] : std::string_view();
+    if (node.null_count > 0 && validity.size() < (rows + 7) / 8) {
+      return corrupt(index);
+    }
+    auto bit = [](std::string_view bits, std::size_t row) {
+      return (static_cast<unsigned char>(bits[row / 8]) >> (row % 8)) & 1;
+    };
+    const std::string_view values = buffers[1];
+    const auto width = static_cast<std::size_t>(column.width);
+    switch (column.kind) {
+      case Kind::kBool:
+        if (values.size() < (rows + 7) / 8) {
+          return corrupt(index);
+        }
+        break;
+      case Kind::kText:
+        if (values.size() / width < rows + 1) {
+          return corrupt(index);
+        }
+        break;
+      default:
+        if (values.size() / width < rows) {
+          return corrupt(index);
+        }
+        break;
+    }
+
+    for (std::size_t row = 0; row < rows; ++row) {
+      if (!validity.empty() && !bit(validity, row)) {
+        target.AppendNull();
+        continue;
+      }
+      switch (column.kind) {
+        case Kind::kBool:
+          target.AppendInt64(bit(values, row));
+          break;
+        case Kind::kInt: {
+          std::uint64_t bits = GetLE(values.data() + width * row, column.width);
+          const unsigned shift = static_cast<unsigned>(64 - 8 * width);
+          if (column.is_signed && shift > 0) {
+            bits = static_cast<std::uint64_t>(static_cast<std::int64_t>(bits << shift) >> shift);
+          }
+          target.AppendInt64(static_cast<std::int64_t>(bits));
+          break;
+        }
+        case Kind::kFloat: {
+          const std::uint64_t bits = GetLE(values.data() + width * row, column.width);
+          if (width == 4) {
+            float value;
+            const auto narrow = static_cast<std::uint32_t>(bits);
+            std::memcpy(&value, &narrow, sizeof(value));
+            target.AppendDouble(value);
+          } else {
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            target.AppendDouble(value);
+          }
+          break;
+        }
+        case Kind::kDate: {
+          const std::uint64_t bits = GetLE(values.data() + width * row, column.width);
+          if (column.millis) {
+            const auto millis = static_cast<std::int64_t>(bits);
+            const std::int64_t days = millis / kMillisPerDay - (millis % kMillisPerDay < 0 ? 1 : 0);
+            target.AppendDate(static_cast<std::int32_t>(days));
+          } else {
+            target.AppendDate(static_cast<std::int32_t>(static_cast<std::uint32_t>(bits)));
+          }
+          break;
+        }
+        default: {
+          const std::string_view data = buffers[2];
+          const std::uint64_t from = GetLE(values.data() + width * row, column.width);
+          const std::uint64_t to = GetLE(values.data() + width * (row + 1), column.width);
+          if (from > to || to > data.size()) {
+            return corrupt(index);
+          }
+          target.AppendText(data.substr(static_cast<std::size_t>(from),
+                                        static_cast<std::size_t>(to - from)));
+          break;
+        }
+      }
+    }
+  }
+  for (std::size_t row = 0; row < rows; ++row) {
+    out->EndRow();
+  }
+  return Status::Ok();
+}
+
+}  // namespace scratchrobin::core
@@ -0,0 +1,96 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/columnar_schema.h"
+#include "core/result_set.h"
+#include "core/status.h"
+
+namespace scratchrobin::core {
+
+/**
+ * Arrow IPC streaming format, one message per call
+ *
+ * A stream is a schema message, any number of record batches and an
+ * end-of-stream marker. kInt64 columns are written as Int64, kDouble as
+ * Float64, kDate as Date32[day] and everything else as Utf8; every field
+ * is nullable. Record batches are independent and may be encoded on
+ * several threads.
+ */
+void AppendArrowSchemaMessage(const ColumnarSchema& schema, std::string* out);
+
+// Encodes rows [begin, end) of |columns| (one per schema column, each of
+// the schema type, all NULL, or any type for string columns).
+Status AppendArrowRecordBatch(const ColumnarSchema& schema,
+                              const std::vector<const ColumnBuffer*>& columns,
+                              std::size_t begin, std::size_t end, std::string* out);
+
+void AppendArrowEndOfStream(std::string* out);
+
+/**
+ * ArrowIpcReader - decodes the record batches of a flat Arrow IPC stream
+ *
+ * Accepts the streaming format and the random-access file format
+ * ("ARROW1"), whose leading stream is read and footer ignored. Int and
+ * Bool columns read as kInt64, floating point as kDouble, Date as kDate
+ * and (Large)Utf8/(Large)Binary as kText; Null columns read as all NULL.
+ * Nested schemas, dictionary-encoded fields and compressed batches are
+ * rejected; other flat types are rejected only when read.
+ *
+ * The stream view must outlive the reader. ReadBatch() is const and may
+ * run on several threads at once.
+ */
+class ArrowIpcReader {
+ public:
+  Status Open(std::string_view stream);
+
+  const ColumnarSchema& Schema() const { return schema_; }
+  std::size_t BatchCount() const { return batches_.size(); }
+  std::int64_t BatchRows(std::size_t batch) const;
+  std::int64_t TotalRows() const { return total_rows_; }
+
+  // Decodes |columns| (schema indexes) of one record batch into |out|,
+  // one output column per entry.
+  Status ReadBatch(std::size_t batch, const std::vector<std::size_t>& columns,
+                   ColumnTable* out) const;
+
+ private:
+  enum class Kind { kNull, kBool, kInt, kFloat, kDate, kText, kUnsupported };
+  struct Column {
+    Kind kind{Kind::kUnsupported};
+    int width{0};           // Bytes per value (kInt, kFloat, kDate) or offset (kText)
+    bool is_signed{true};
+    bool millis{false};     // Date[millisecond]
+    int buffer_count{2};
+  };
+  struct Node {
+    std::int64_t length{0};
+    std::int64_t null_count{0};
+    std::size_t first_buffer{0};
+  };
+  struct Batch {
+    std::int64_t num_rows{0};
+    std::vector<Node> nodes;
+    std::vector<std::string_view> buffers;
+  };
+
+  Status ParseSchema(std::string_view metadata);
+  Status ParseBatch(std::string_view metadata, std::string_view body);
+
+  ColumnarSchema schema_;
+  std::vector<Column> columns_;
+  std::vector<Batch> batches_;
+  std::int64_t total_rows_{0};
+};
+
+}  // namespace scratchrobin::core
@@ -9,194 +9,534 @@
 
 #include <algorithm>
 #include <chrono>
-#include <uuid/uuid.h>
 
 namespace scratchrobin::core {
 
-// Helper to generate unique task IDs
-static std::string GenerateTaskId() {
-  uuid_t uuid;
-  uuid_generate(uuid);
-  char uuid_str[37];
-  uuid_unparse(uuid, uuid_str);
-  return std::string(uuid_str);
+namespace {
+
+constexpr size_t kInteractiveLane = 0;
+constexpr size_t kBackgroundLane = 1;
+
+size_t LaneOf(QueryPriority priority) {
+  return priority == QueryPriority::kBackground ? kBackgroundLane : kInteractiveLane;
+}
+
+bool IsFinished(QueryExecutionState state) {
+  return state == QueryExecutionState::kCompleted ||
+         state == QueryExecutionState::kFailed ||
+         state == QueryExecutionState::kCancelled;
 }
 
+}  // namespace
+
+struct AsyncQueryExecutor::TaskState {
+  QueryTask task;
+  std::atomic<QueryExecutionState> state{QueryExecutionState::kPending};
+
+  std::mutex mutex;  // Guards everything below
+  std::condition_variable done_cv;
+  std::condition_variable demand_cv;  // Credit added, cancelled or shutting down
+  QueryProgress progress;
+  std::optional<AsyncQueryResult> result;
+  size_t credit = 0;  // Batches a streaming task may still fetch
+  bool done = false;
+};
+
 AsyncQueryExecutor::AsyncQueryExecutor() = default;
 
 AsyncQueryExecutor::~AsyncQueryExecutor() {
   Shutdown();
 }
 
-// Disable move (too complex for now)
-AsyncQueryExecutor::AsyncQueryExecutor(AsyncQueryExecutor&&) noexcept = delete;
-AsyncQueryExecutor& AsyncQueryExecutor::operator=(AsyncQueryExecutor&&) noexcept = delete;
-
 bool AsyncQueryExecutor::Initialize(size_t thread_count) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  std::lock_guard<std::mutex> lock(lifecycle_mutex_);
   if (running_) {
     return false;  // Already initialized
   }
-  
+
+  thread_count = std::max<size_t>(thread_count, 1);
   running_ = true;
+  workers_.clear();  // Joined by the previous Shutdown
+  workers_.reserve(thread_count);
   for (size_t i = 0; i < thread_count; ++i) {
-    workers_.emplace_back(&AsyncQueryExecutor::WorkerThread, this);
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  // Start threads only once every deque exists, since workers steal
+  for (size_t i = 0; i < thread_count; ++i) {
+    workers_[i]->thread = std::thread(&AsyncQueryExecutor::WorkerThread, this, i);
   }
   return true;
 }
 
 void AsyncQueryExecutor::Shutdown() {
+  std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
   {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
     if (!running_) {
       return;  // Already shut down
     }
     running_ = false;
   }
-  cv_.notify_all();
-  
+  sleep_cv_.notify_all();
+
+  // Release streaming tasks waiting for the receiver to ask for more rows
+  std::vector<TaskPtr> live;
+  for (const auto& shard : tasks_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (const auto& [id, task] : shard.tasks) {
+      live.push_back(task);
+    }
+  }
+  for (const auto& task : live) {
+    { std::lock_guard<std::mutex> lock(task->mutex); }
+    task->demand_cv.notify_all();
+  }
+  live.clear();
+
   for (auto& worker : workers_) {
-    if (worker.joinable()) {
-      worker.join();
+    if (worker->thread.joinable()) {
+      worker->thread.join();
     }
   }
-  
-  std::lock_guard<std::mutex> lock(mutex_);
-  workers_.clear();
+
+  // Finish whatever never started so waiters are released
+  std::vector<TaskPtr> leftovers;
+  for (auto& worker : workers_) {
+    for (auto& lane : worker->lanes) {
+      leftovers.insert(leftovers.end(), lane.begin(), lane.end());
+      lane.clear();
+    }
+  }
+  for (auto& queued : queued_) {
+    queued = 0;
+  }
+  for (auto& shard : strands_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (auto& [connection, waiting] : shard.waiting) {
+      leftovers.insert(leftovers.end(), waiting.begin(), waiting.end());
+    }
+    shard.waiting.clear();
+  }
+  parked_count_ = 0;
+
+  for (auto& task : leftovers) {
+    task->state = QueryExecutionState::kCancelled;
+    AsyncQueryResult result;
+    result.query = task->task.query;
+    result.status = Status::Error("Query cancelled");
+    FinishTask(task, std::move(result), false, 0);
+  }
 }
 
-std::string AsyncQueryExecutor::SubmitQuery(const std::string& query,
+QueryTaskId AsyncQueryExecutor::SubmitQuery(const std::string& query,
                                             std::shared_ptr<Connection> connection,
-                                            CompletionCallback callback) {
-  std::string task_id = GenerateTaskId();
-  
+                                            CompletionCallback callback,
+                                            QueryPriority priority) {
   QueryTask task;
-  task.task_id = task_id;
   task.query = query;
-  task.connection = connection;
-  task.callback = callback;
-  
+  task.connection = std::move(connection);
+  task.callback = std::move(callback);
+  task.priority = priority;
+  return Submit(std::move(task));
+}
+
+QueryTaskId AsyncQueryExecutor::SubmitStreamingQuery(const std::string& query,
+                                                     std::shared_ptr<Connection> connection,
+                                                     BatchCallback on_batch,
+                                                     CompletionCallback callback,
+                                                     size_t batch_rows,
+                                                     QueryPriority priority,
+                                                     size_t prefetch_batches) {
+  QueryTask task;
+  task.query = query;
+  task.connection = std::move(connection);
+  task.callback = std::move(callback);
+  task.batch_callback = std::move(on_batch);
+  task.batch_rows = std::max<size_t>(batch_rows, 1);
+  task.priority = priority;
+  task.prefetch_batches = prefetch_batches;
+  return Submit(std::move(task));
+}
+
+bool AsyncQueryExecutor::RequestMoreRows(QueryTaskId task_id, size_t batches) {
+  auto task = FindTask(task_id);
+  if (!task || IsFinished(task->state.load())) {
+    return false;
+  }
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!running_) {
-      return "";  // Executor not running
+    std::lock_guard<std::mutex> lock(task->mutex);
+    if (task->done) {
+      return false;
     }
-    
-    TaskInfo info;
-    info.state = QueryExecutionState::kPending;
-    info.progress.task_id = task_id;
-    tasks_[task_id] = std::move(info);
-    pending_queue_.push(std::move(task));
-  }
-  
-  cv_.notify_one();
+    task->credit += batches;
+  }
+  task->demand_cv.notify_all();
+  return true;
+}
+
+QueryTaskId AsyncQueryExecutor::Submit(QueryTask task) {
+  if (!running_) {
+    return kInvalidQueryTaskId;  // Executor not running
+  }
+
+  auto state = std::make_shared<TaskState>();
+  const QueryTaskId task_id = next_task_id_.fetch_add(1);
+  task.task_id = task_id;
+  state->task = std::move(task);
+  state->progress.task_id = task_id;
+  state->credit = state->task.prefetch_batches;
+
+  {
+    auto& shard = tasks_[task_id % kShardCount];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.tasks.emplace(task_id, state);
+  }
+  ++outstanding_;
+
+  if (AcquireStrand(state)) {
+    Enqueue(std::move(state), next_worker_.fetch_add(1));
+  }
   return task_id;
 }
 
-bool AsyncQueryExecutor::CancelQuery(const std::string& task_id) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  
-  auto it = tasks_.find(task_id);
-  if (it == tasks_.end()) {
-    return false;  // Task not found
+bool AsyncQueryExecutor::AcquireStrand(const TaskPtr& task) {
+  const Connection* key = task->task.connection.get();
+  if (!key) {
+    return true;  // Fails immediately; nothing to serialize against
   }
-  
-  // Can only cancel pending or running tasks
-  if (it->second.state == QueryExecutionState::kPending) {
-    it->second.state = QueryExecutionState::kCancelled;
-    // Note: Task remains in queue but will be skipped when popped
-    return true;
-  } else if (it->second.state == QueryExecutionState::kRunning) {
-    // For running tasks, we mark it for cancellation
-    // The worker thread will check this flag periodically
-    it->second.state = QueryExecutionState::kCancelled;
+  auto& shard = strands_[std::hash<const Connection*>{}(key) % kShardCount];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto [it, inserted] = shard.waiting.try_emplace(key);
+  if (!inserted) {
+    it->second.push_back(task);
+    ++parked_count_;
+    return false;
+  }
+  return true;
+}
+
+AsyncQueryExecutor::TaskPtr AsyncQueryExecutor::ReleaseStrand(const TaskState& task) {
+  const Connection* key = task.task.connection.get();
+  if (!key) {
+    return nullptr;
+  }
+  auto& shard = strands_[std::hash<const Connection*>{}(key) % kShardCount];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.waiting.find(key);
+  if (it == shard.waiting.end()) {
+    return nullptr;
+  }
+  if (it->second.empty()) {
+    shard.waiting.erase(it);
+    return nullptr;
+  }
+  TaskPtr next = std::move(it->second.front());
+  it->second.pop_front();
+  --parked_count_;
+  return next;
+}
+
+void AsyncQueryExecutor::Enqueue(TaskPtr task, size_t worker_hint) {
+  if (workers_.empty()) {
+    return;  // Never initialized
+  }
+  Worker& worker = *workers_[worker_hint % workers_.size()];
+  const size_t lane = LaneOf(task->task.priority);
+  {
+    // Counted under the deque lock so a thief can never decrement first
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.lanes[lane].push_back(std::move(task));
+    ++queued_[lane];
+  }
+  WakeOne();
+}
+
+void AsyncQueryExecutor::WakeOne() {
+  // A sleeper re-checks for work under sleep_mutex_ before waiting, so
+  // taking the mutex here rules out a lost wake-up.
+  if (sleepers_.load() > 0) {
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    sleep_cv_.notify_one();
+  }
+}
+
+size_t AsyncQueryExecutor::BackgroundLimit() const {
+  // Keep one worker free for interactive work when there is more than one
+  return workers_.size() > 1 ? workers_.size() - 1 : 1;
+}
+
+bool AsyncQueryExecutor::HasRunnableWork() const {
+  return queued_[kInteractiveLane].load() > 0 ||
+         (queued_[kBackgroundLane].load() > 0 &&
+          background_running_.load() < BackgroundLimit());
+}
+
+AsyncQueryExecutor::TaskPtr AsyncQueryExecutor::PopFrom(Worker& worker, size_t lane,
+                                                        bool front) {
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  auto& deque = worker.lanes[lane];
+  if (deque.empty()) {
+    return nullptr;
+  }
+  TaskPtr task;
+  if (front) {
+    task = std::move(deque.front());
+    deque.pop_front();
+  } else {
+    task = std::move(deque.back());
+    deque.pop_back();
+  }
+  --queued_[lane];
+  return task;
+}
+
+AsyncQueryExecutor::TaskPtr AsyncQueryExecutor::TakeTask(size_t worker_index) {
+  const size_t count = workers_.size();
+  for (size_t lane = 0; lane < kLaneCount; ++lane) {
+    if (lane == kBackgroundLane && background_running_.load() >= BackgroundLimit()) {
+      break;
+    }
+    // Own deque oldest-first, then steal the newest work of the others
+    if (auto task = PopFrom(*workers_[worker_index], lane, true)) {
+      return task;
+    }
+    for (size_t offset = 1; offset < count; ++offset) {
+      if (auto task = PopFrom(*workers_[(worker_index + offset) % count], lane, false)) {
+        return task;
+      }
+    }
+  }
+  return nullptr;
+}
+
+void AsyncQueryExecutor::WorkerThread(size_t worker_index) {
+  // Once stopping, queued work is left for Shutdown to finish as cancelled
+  while (running_) {
+    if (auto task = TakeTask(worker_index)) {
+      RunTask(task, worker_index);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    ++sleepers_;
+    sleep_cv_.wait(lock, [this] { return HasRunnableWork() || !running_; });
+    --sleepers_;
+    if (!running_) {
+      break;
+    }
+  }
+}
+
+void AsyncQueryExecutor::RunTask(const TaskPtr& task, size_t worker_index) {
+  auto expected = QueryExecutionState::kPending;
+  if (!task->state.compare_exchange_strong(expected, QueryExecutionState::kRunning)) {
+    // Cancelled while queued
+    AsyncQueryResult result;
+    result.query = task->task.query;
+    result.status = Status::Error("Query cancelled");
+    FinishTask(task, std::move(result), true, worker_index);
+    return;
+  }
+
+  const bool background = task->task.priority == QueryPriority::kBackground;
+  ++running_count_;
+  if (background) {
+    ++background_running_;
+  }
+
+  auto result = task->task.batch_callback ? ExecuteStreaming(*task) : ExecuteQuery(*task);
+
+  if (background) {
+    --background_running_;
+    WakeOne();  // Held-back background work may run now
+  }
+  --running_count_;
+
+  FinishTask(task, std::move(result), true, worker_index);
+}
+
+void AsyncQueryExecutor::FinishTask(const TaskPtr& task, AsyncQueryResult result,
+                                    bool run_callbacks, size_t worker_hint) {
+  // A cancel that raced with completion keeps the cancelled state
+  auto expected = QueryExecutionState::kRunning;
+  const auto final_state = result.status.ok ? QueryExecutionState::kCompleted
+                                            : QueryExecutionState::kFailed;
+  task->state.compare_exchange_strong(expected, final_state);
+  if (task->state.load() == QueryExecutionState::kCompleted) {
+    ++completed_count_;
+  }
+
+  const bool retain = !task->task.callback;
+  {
+    std::lock_guard<std::mutex> lock(task->mutex);
+    if (retain) {
+      task->result = result;
+    }
+    task->done = true;
+  }
+  task->done_cv.notify_all();
+
+  if (run_callbacks && task->task.callback) {
+    task->task.callback(result);
+  }
+
+  if (retain) {
+    std::vector<QueryTaskId> evicted;
+    {
+      std::lock_guard<std::mutex> lock(retention_mutex_);
+      retained_.push_back(task->task.task_id);
+      while (retained_.size() > retention_limit_) {
+        evicted.push_back(retained_.front());
+        retained_.pop_front();
+      }
+    }
+    for (auto id : evicted) {
+      ForgetTask(id);
+    }
+  } else {
+    ForgetTask(task->task.task_id);
+  }
+
+  // Hand the connection to its next task on this worker, which has the
+  // connection state warm. Done after retention so a connection's tasks
+  // are retained, and evicted, in the order they ran.
+  if (auto next = ReleaseStrand(*task)) {
+    Enqueue(std::move(next), worker_hint);
+  }
+
+  if (--outstanding_ == 0) {
+    { std::lock_guard<std::mutex> lock(idle_mutex_); }
+    idle_cv_.notify_all();
+  }
+}
+
+AsyncQueryExecutor::TaskPtr AsyncQueryExecutor::FindTask(QueryTaskId task_id) const {
+  const auto& shard = tasks_[task_id % kShardCount];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.tasks.find(task_id);
+  return it == shard.tasks.end() ? nullptr : it->second;
+}
+
+void AsyncQueryExecutor::ForgetTask(QueryTaskId task_id) {
+  auto& shard = tasks_[task_id % kShardCount];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.tasks.erase(task_id);
+}
+
+bool AsyncQueryExecutor::CancelQuery(QueryTaskId task_id) {
+  auto task = FindTask(task_id);
+  if (!task) {
+    return false;  // Unknown or already reclaimed
+  }
+
+  auto expected = QueryExecutionState::kPending;
+  if (task->state.compare_exchange_strong(expected, QueryExecutionState::kCancelled)) {
+    return true;  // The worker that dequeues it finishes it as cancelled
+  }
+  expected = QueryExecutionState::kRunning;
+  if (task->state.compare_exchange_strong(expected, QueryExecutionState::kCancelled)) {
+    // The worker checks the state between batches; the server-side cancel
+    // interrupts a statement that is still executing.
+    if (task->task.connection) {
+      task->task.connection->cancel();
+    }
+    { std::lock_guard<std::mutex> lock(task->mutex); }
+    task->demand_cv.notify_all();  // A streaming task may be waiting for demand
     return true;
   }
-  
   return false;  // Already completed/failed/cancelled
 }
 
 void AsyncQueryExecutor::CancelAllQueries() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  
-  // Mark all pending and running tasks as cancelled
-  for (auto& [id, info] : tasks_) {
-    if (info.state == QueryExecutionState::kPending || 
-        info.state == QueryExecutionState::kRunning) {
-      info.state = QueryExecutionState::kCancelled;
+  std::vector<QueryTaskId> ids;
+  for (const auto& shard : tasks_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (const auto& [id, task] : shard.tasks) {
+      if (!IsFinished(task->state.load())) {
+        ids.push_back(id);
+      }
     }
   }
-  
-  // Clear pending queue
-  std::queue<QueryTask> empty;
-  std::swap(pending_queue_, empty);
+  for (auto id : ids) {
+    CancelQuery(id);
+  }
 }
 
-QueryExecutionState AsyncQueryExecutor::GetQueryState(const std::string& task_id) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  
-  auto it = tasks_.find(task_id);
-  if (it == tasks_.end()) {
-    return QueryExecutionState::kFailed;  // Task not found
+QueryExecutionState AsyncQueryExecutor::GetQueryState(QueryTaskId task_id) const {
+  if (auto task = FindTask(task_id)) {
+    return task->state.load();
   }
-  
-  return it->second.state;
+  // Handles are sequential, so an issued handle that is gone was reclaimed
+  if (task_id != kInvalidQueryTaskId && task_id < next_task_id_.load()) {
+    return QueryExecutionState::kCompleted;
+  }
+  return QueryExecutionState::kFailed;  // Task not found
 }
 
-bool AsyncQueryExecutor::IsRunning(const std::string& task_id) const {
+bool AsyncQueryExecutor::IsRunning(QueryTaskId task_id) const {
   return GetQueryState(task_id) == QueryExecutionState::kRunning;
 }
 
-bool AsyncQueryExecutor::IsPending(const std::string& task_id) const {
+bool AsyncQueryExecutor::IsPending(QueryTaskId task_id) const {
   return GetQueryState(task_id) == QueryExecutionState::kPending;
 }
 
 void AsyncQueryExecutor::SetProgressCallback(ProgressCallback callback) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  progress_callback_ = callback;
+  std::shared_ptr<const ProgressCallback> shared;
+  if (callback) {
+    shared = std::make_shared<const ProgressCallback>(std::move(callback));
+  }
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  progress_callback_ = std::move(shared);
 }
 
-QueryProgress AsyncQueryExecutor::GetProgress(const std::string& task_id) const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  
-  auto it = tasks_.find(task_id);
-  if (it == tasks_.end()) {
+QueryProgress AsyncQueryExecutor::GetProgress(QueryTaskId task_id) const {
+  auto task = FindTask(task_id);
+  if (!task) {
     return QueryProgress{};  // Task not found
   }
-  
-  return it->second.progress;
+  std::lock_guard<std::mutex> lock(task->mutex);
+  return task->progress;
 }
 
-std::optional<AsyncQueryResult> AsyncQueryExecutor::GetResult(const std::string& task_id) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  
-  auto it = tasks_.find(task_id);
-  if (it == tasks_.end() || !it->second.result.has_value()) {
+std::optional<AsyncQueryResult> AsyncQueryExecutor::GetResult(QueryTaskId task_id) {
+  auto task = FindTask(task_id);
+  if (!task) {
     return std::nullopt;
   }
-  
-  return it->second.result;
+  std::lock_guard<std::mutex> lock(task->mutex);
+  return task->result;
 }
 
 void AsyncQueryExecutor::ClearCompletedTasks() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  
-  auto it = tasks_.begin();
-  while (it != tasks_.end()) {
-    auto state = it->second.state;
-    if (state == QueryExecutionState::kCompleted || 
-        state == QueryExecutionState::kFailed || 
-        state == QueryExecutionState::kCancelled) {
-      it = tasks_.erase(it);
-    } else {
-      ++it;
+  std::deque<QueryTaskId> retained;
+  {
+    std::lock_guard<std::mutex> lock(retention_mutex_);
+    retained.swap(retained_);
+  }
+  for (auto id : retained) {
+    ForgetTask(id);
+  }
+}
+
+void AsyncQueryExecutor::SetResultRetention(size_t max_results) {
+  std::vector<QueryTaskId> evicted;
+  {
+    std::lock_guard<std::mutex> lock(retention_mutex_);
+    retention_limit_ = max_results;
+    while (retained_.size() > retention_limit_) {
+      evicted.push_back(retained_.front());
+      retained_.pop_front();
     }
   }
+  for (auto id : evicted) {
+    ForgetTask(id);
+  }
 }
 
 size_t AsyncQueryExecutor::GetPendingCount() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return pending_queue_.size();
+  return queued_[kInteractiveLane].load() + queued_[kBackgroundLane].load() +
+         parked_count_.load();
 }
 
 size_t AsyncQueryExecutor::GetRunningCount() const {
@@ -204,218 +544,199 @@ size_t AsyncQueryExecutor::GetRunningCount() const {
 }
 
 size_t AsyncQueryExecutor::GetCompletedCount() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  
-  size_t count = 0;
-  for (const auto& [id, info] : tasks_) {
-    if (info.state == QueryExecutionState::kCompleted) {
-      ++count;
-    }
-  }
-  return count;
+  return completed_count_.load();
 }
 
-bool AsyncQueryExecutor::WaitForQuery(const std::string& task_id, int timeout_ms) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  
-  auto it = tasks_.find(task_id);
-  if (it == tasks_.end()) {
-    return false;  // Task not found
-  }
-  
-  // If already completed, return immediately
-  if (it->second.state == QueryExecutionState::kCompleted ||
-      it->second.state == QueryExecutionState::kFailed ||
-      it->second.state == QueryExecutionState::kCancelled) {
-    return true;
+bool AsyncQueryExecutor::WaitForQuery(QueryTaskId task_id, int timeout_ms) {
+  auto task = FindTask(task_id);
+  if (!task) {
+    // Reclaimed tasks have finished; unknown handles never will
+    return task_id != kInvalidQueryTaskId && task_id < next_task_id_.load();
   }
-  
-  // Store the promise future for waiting
-  auto future = it->second.promise.get_future();
-  lock.unlock();
-  
+
+  std::unique_lock<std::mutex> lock(task->mutex);
   if (timeout_ms < 0) {
-    // Wait indefinitely
-    future.wait();
+    task->done_cv.wait(lock, [&] { return task->done; });
     return true;
-  } else {
-    // Wait with timeout
-    auto status = future.wait_for(std::chrono::milliseconds(timeout_ms));
-    return status == std::future_status::ready;
   }
+  return task->done_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                [&] { return task->done; });
 }
 
-void AsyncQueryExecutor::WaitForAll(int timeout_ms) {
-  auto start = std::chrono::steady_clock::now();
-  
-  while (true) {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      
-      // Check if all tasks are done
-      bool all_done = true;
-      for (const auto& [id, info] : tasks_) {
-        if (info.state == QueryExecutionState::kPending || 
-            info.state == QueryExecutionState::kRunning) {
-          all_done = false;
-          break;
-        }
-      }
-      
-      if (all_done) {
-        return;
-      }
-    }
-    
-    // Check timeout
-    if (timeout_ms >= 0) {
-      auto elapsed = std::chrono::steady_clock::now() - start;
-      if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() >= timeout_ms) {
-        return;  // Timeout reached
-      }
-    }
-    
-    // Sleep a bit to avoid busy waiting
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-  }
-}
-
-void AsyncQueryExecutor::WorkerThread() {
-  while (running_) {
-    std::unique_lock<std::mutex> lock(mutex_);
-    cv_.wait(lock, [this] { return !pending_queue_.empty() || !running_; });
-    
-    if (!running_) break;
-    if (pending_queue_.empty()) continue;
-    
-    // Get next task
-    auto task = std::move(pending_queue_.front());
-    pending_queue_.pop();
-    
-    // Check if task was cancelled while in queue
-    auto it = tasks_.find(task.task_id);
-    if (it == tasks_.end() || it->second.state == QueryExecutionState::kCancelled) {
-      lock.unlock();
-      continue;  // Skip cancelled tasks
-    }
-    
-    // Mark as running
-    it->second.state = QueryExecutionState::kRunning;
-    lock.unlock();
-    
-    ++running_count_;
-    
-    // Execute the query
-    auto result = ExecuteQuery(task);
-    
-    --running_count_;
-    
-    // Store result and notify
-    {
-      std::lock_guard<std::mutex> result_lock(mutex_);
-      auto task_it = tasks_.find(task.task_id);
-      if (task_it != tasks_.end()) {
-        task_it->second.result = result;
-        task_it->second.state = result.status.ok ? 
-            QueryExecutionState::kCompleted : QueryExecutionState::kFailed;
-        task_it->second.promise.set_value(result);
-      }
-    }
-    
-    // Call completion callback if provided
-    if (task.callback) {
-      task.callback(result);
-    }
+bool AsyncQueryExecutor::WaitForAll(int timeout_ms) {
+  std::unique_lock<std::mutex> lock(idle_mutex_);
+  auto idle = [this] { return outstanding_.load() == 0; };
+  if (timeout_ms < 0) {
+    idle_cv_.wait(lock, idle);
+    return true;
   }
+  return idle_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), idle);
 }
 
-AsyncQueryResult AsyncQueryExecutor::ExecuteQuery(const QueryTask& task) {
+AsyncQueryResult AsyncQueryExecutor::ExecuteQuery(TaskState& task) {
   AsyncQueryResult result;
-  result.query = task.query;
-  
+  result.query = task.task.query;
+
   auto start_time = std::chrono::steady_clock::now();
-  
-  // Check if task was cancelled before starting
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = tasks_.find(task.task_id);
-    if (it != tasks_.end() && it->second.state == QueryExecutionState::kCancelled) {
-      result.status = Status::Error("Query cancelled");
-      return result;
-    }
-  }
-  
+
   // Execute the query using the connection
-  if (!task.connection) {
+  if (!task.task.connection) {
     result.status = Status::Error("No connection available");
     return result;
   }
-  
+
   // Update progress - started
   QueryProgress progress;
-  progress.task_id = task.task_id;
+  progress.task_id = task.task.task_id;
   progress.percentage = 0;
   progress.status_message = "Executing...";
-  UpdateProgress(task.task_id, progress);
-  
+  UpdateProgress(task, progress);
+
   // Execute query
-  auto query_result = task.connection->query(task.query);
-  
+  auto query_result = task.task.connection->query(task.task.query);
+
   auto end_time = std::chrono::steady_clock::now();
   result.execution_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
       end_time - start_time).count();
-  
+
   // Check for cancellation after execution
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = tasks_.find(task.task_id);
-    if (it != tasks_.end() && it->second.state == QueryExecutionState::kCancelled) {
-      result.status = Status::Error("Query cancelled");
-      return result;
-    }
+  if (task.state.load() == QueryExecutionState::kCancelled) {
+    result.status = Status::Error("Query cancelled");
+    return result;
   }
-  
+
   // Convert QueryResult to ResultSet
   if (query_result.success) {
     result.status = Status::Ok();
     result.rows_affected = query_result.affected_rows;
-    
+
     // Convert columns
     for (const auto& col : query_result.columns) {
       result.result_set.columns.push_back(col.name);
     }
-    
-    // Convert rows
-    for (const auto& row : query_result.rows) {
-      result.result_set.rows.push_back(row);
-    }
-    
+    result.result_set.column_types = backend::declaredColumnTypes(query_result.columns);
+
+    // Hand over the column buffers
+    progress.rows_processed = query_result.rows.size();
+    result.result_set.rows = std::move(query_result.rows);
+
     progress.percentage = 100;
     progress.status_message = "Completed";
-    progress.rows_processed = query_result.rows.size();
   } else {
     result.status = Status::Error(query_result.error_message);
     progress.status_message = "Failed: " + query_result.error_message;
   }
-  
-  UpdateProgress(task.task_id, progress);
-  
+
+  UpdateProgress(task, progress);
+
   return result;
 }
 
-void AsyncQueryExecutor::UpdateProgress(const std::string& task_id, const QueryProgress& progress) {
-  // Store progress
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = tasks_.find(task_id);
-    if (it != tasks_.end()) {
-      it->second.progress = progress;
+AsyncQueryResult AsyncQueryExecutor::ExecuteStreaming(TaskState& task) {
+  AsyncQueryResult result;
+  result.query = task.task.query;
+
+  auto start_time = std::chrono::steady_clock::now();
+  auto finish = [&](Status status) {
+    result.status = std::move(status);
+    result.execution_time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start_time).count();
+    return result;
+  };
+  auto cancelled = [&task] {
+    return task.state.load() == QueryExecutionState::kCancelled;
+  };
+
+  auto& connection = task.task.connection;
+  if (!connection) {
+    return finish(Status::Error("No connection available"));
+  }
+
+  QueryProgress progress;
+  progress.task_id = task.task.task_id;
+  progress.status_message = "Executing...";
+  UpdateProgress(task, progress);
+
+  auto head = connection->openCursor(task.task.query);
+  if (!head.success) {
+    return finish(Status::Error(cancelled() ? "Query cancelled" : head.error_message));
+  }
+  result.rows_affected = head.affected_rows;
+
+  std::vector<std::string> column_names;
+  column_names.reserve(head.columns.size());
+  for (const auto& col : head.columns) {
+    column_names.push_back(col.name);
+  }
+  const auto column_types = backend::declaredColumnTypes(head.columns);
+
+  // Waits until the receiver wants another batch; false when the task is
+  // cancelled or the executor stops first
+  const bool paced = task.task.prefetch_batches > 0;
+  auto await_demand = [&] {
+    std::unique_lock<std::mutex> lock(task.mutex);
+    task.demand_cv.wait(lock, [&] { return task.credit > 0 || cancelled() || !running_; });
+    return !cancelled() && running_;
+  };
+
+  progress.status_message = "Fetching...";
+  bool has_more = true;
+  while (has_more) {
+    if (paced && !await_demand()) {
+      auto expected = QueryExecutionState::kRunning;
+      task.state.compare_exchange_strong(expected, QueryExecutionState::kCancelled);
+    }
+    if (cancelled()) {
+      connection->closeCursor();
+      return finish(Status::Error("Query cancelled"));
+    }
+
+    auto batch = connection->fetchRows(task.task.batch_rows);
+    if (!batch.success) {
+      return finish(Status::Error(batch.error_message));
+    }
+    has_more = batch.has_more;
+
+    ResultSet rows;
+    rows.columns = column_names;
+    rows.column_types = column_types;
+    rows.rows = std::move(batch.rows);
+    result.rows_returned += static_cast<int64_t>(rows.RowCount());
+
+    // Always deliver the last batch so the receiver learns the cursor is
+    // exhausted, even when it carries no rows.
+    if (rows.RowCount() > 0 || !has_more) {
+      task.task.batch_callback(std::move(rows), has_more);
+      if (paced) {
+        std::lock_guard<std::mutex> lock(task.mutex);
+        --task.credit;
+      }
     }
+
+    progress.rows_processed = result.rows_returned;
+    UpdateProgress(task, progress);
+  }
+
+  progress.percentage = 100;
+  progress.status_message = "Completed";
+  UpdateProgress(task, progress);
+
+  return finish(Status::Ok());
+}
+
+void AsyncQueryExecutor::UpdateProgress(TaskState& task, const QueryProgress& progress) {
+  {
+    std::lock_guard<std::mutex> lock(task.mutex);
+    task.progress = progress;
+  }
+
+  std::shared_ptr<const ProgressCallback> callback;
+  {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    callback = progress_callback_;
   }
-  
-  // Call callback
-  if (progress_callback_) {
-    progress_callback_(progress);
+  if (callback) {
+    (*callback)(progress);
   }
 }
 
@@ -10,16 +10,18 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
-#include <future>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <queue>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "core/result_set.h"
@@ -31,6 +33,10 @@ namespace scratchrobin::core {
 // Use backend connection type
 using Connection = backend::ScratchbirdConnection;
 
+// Numeric task handle; handles are never reused and 0 is never issued
+using QueryTaskId = std::uint64_t;
+constexpr QueryTaskId kInvalidQueryTaskId = 0;
+
 // Query execution state
 enum class QueryExecutionState {
   kPending,
@@ -40,6 +46,13 @@ enum class QueryExecutionState {
   kFailed
 };
 
+// Scheduling lane. Interactive work is always taken before background
+// work, and background work never occupies the last free worker.
+enum class QueryPriority {
+  kInteractive,
+  kBackground,  // Exports, monitoring and other work nobody is waiting on
+};
+
 // Query result wrapper
 struct AsyncQueryResult {
   Status status;
@@ -47,19 +60,28 @@ struct AsyncQueryResult {
   std::string query;
   int64_t execution_time_ms{0};
   int64_t rows_affected{0};
+  int64_t rows_returned{0};  // Streamed tasks: total rows handed to the batch callback
 };
 
 // Query task definition
 struct QueryTask {
-  std::string task_id;
+  QueryTaskId task_id{kInvalidQueryTaskId};
   std::string query;
   std::shared_ptr<Connection> connection;
   std::function<void(const AsyncQueryResult&)> callback;
+  // Streaming tasks deliver rows through batch_callback in chunks of
+  // batch_rows; the final AsyncQueryResult then carries no rows.
+  std::function<void(ResultSet&&, bool)> batch_callback;
+  size_t batch_rows{0};
+  // Batches a streaming task may fetch ahead of the receiver before it
+  // waits for RequestMoreRows(); 0 fetches everything without waiting.
+  size_t prefetch_batches{0};
+  QueryPriority priority{QueryPriority::kInteractive};
 };
 
 // Progress information
 struct QueryProgress {
-  std::string task_id;
+  QueryTaskId task_id{kInvalidQueryTaskId};
   int percentage{0};
   std::string status_message;
   int64_t rows_processed{0};
@@ -68,80 +90,163 @@ struct QueryProgress {
 
 // ============================================================================
 // AsyncQueryExecutor
+//
+// Work-stealing pool. Each worker owns a deque per priority lane; new
+// tasks are spread round-robin and idle workers steal from the others, so
+// submitters and workers never meet on a shared queue lock. Tasks that
+// use the same connection run one at a time in submission order (a
+// connection is not thread-safe); the next one is scheduled by the worker
+// that finished its predecessor.
+//
+// Finished task state is reclaimed automatically: tasks with a completion
+// callback are dropped as soon as the callback returns, the rest are kept
+// for GetResult() until more than SetResultRetention() newer ones finish.
 // ============================================================================
 
 class AsyncQueryExecutor {
  public:
   using ProgressCallback = std::function<void(const QueryProgress&)>;
   using CompletionCallback = std::function<void(const AsyncQueryResult&)>;
+  // Called on the worker thread with each fetched batch and whether more follow
+  using BatchCallback = std::function<void(ResultSet&& batch, bool has_more)>;
 
   AsyncQueryExecutor();
   ~AsyncQueryExecutor();
 
-  // Disable copy
   AsyncQueryExecutor(const AsyncQueryExecutor&) = delete;
   AsyncQueryExecutor& operator=(const AsyncQueryExecutor&) = delete;
-
-  // Enable move
-  AsyncQueryExecutor(AsyncQueryExecutor&&) noexcept;
-  AsyncQueryExecutor& operator=(AsyncQueryExecutor&&) noexcept;
+  AsyncQueryExecutor(AsyncQueryExecutor&&) = delete;
+  AsyncQueryExecutor& operator=(AsyncQueryExecutor&&) = delete;
 
   // Initialize with thread pool size
   bool Initialize(size_t thread_count = 4);
+  // Stops the workers; tasks that never started are finished as cancelled
+  // without running their callbacks.
   void Shutdown();
 
   // Submit a query for async execution
-  std::string SubmitQuery(const std::string& query,
+  QueryTaskId SubmitQuery(const std::string& query,
                           std::shared_ptr<Connection> connection,
-                          CompletionCallback callback = nullptr);
-
-  // Cancel a pending or running query
-  bool CancelQuery(const std::string& task_id);
+                          CompletionCallback callback = nullptr,
+                          QueryPriority priority = QueryPriority::kInteractive);
+
+  // Submit a query whose rows are fetched through a cursor and handed to
+  // |on_batch| as they arrive, so the caller can render before it finishes.
+  // With |prefetch_batches| set, the task stops after that many batches
+  // until RequestMoreRows() asks for more; it keeps its worker and its
+  // connection while it waits.
+  QueryTaskId SubmitStreamingQuery(const std::string& query,
+                                   std::shared_ptr<Connection> connection,
+                                   BatchCallback on_batch,
+                                   CompletionCallback callback = nullptr,
+                                   size_t batch_rows = 1000,
+                                   QueryPriority priority = QueryPriority::kInteractive,
+                                   size_t prefetch_batches = 0);
+
+  // Lets a streaming task fetch |batches| more batches. False once the
+  // task has finished.
+  bool RequestMoreRows(QueryTaskId task_id, size_t batches = 1);
+
+  // Cancel a pending or running query. Running queries are also cancelled
+  // on the server through the task's connection. Cancelled tasks still
+  // complete, with a "Query cancelled" status.
+  bool CancelQuery(QueryTaskId task_id);
   void CancelAllQueries();
 
-  // Query status
-  QueryExecutionState GetQueryState(const std::string& task_id) const;
-  bool IsRunning(const std::string& task_id) const;
-  bool IsPending(const std::string& task_id) const;
+  // Query status. A reclaimed task reports kCompleted.
+  QueryExecutionState GetQueryState(QueryTaskId task_id) const;
+  bool IsRunning(QueryTaskId task_id) const;
+  bool IsPending(QueryTaskId task_id) const;
 
   // Progress tracking
   void SetProgressCallback(ProgressCallback callback);
-  QueryProgress GetProgress(const std::string& task_id) const;
+  QueryProgress GetProgress(QueryTaskId task_id) const;
 
   // Results retrieval
-  std::optional<AsyncQueryResult> GetResult(const std::string& task_id);
+  std::optional<AsyncQueryResult> GetResult(QueryTaskId task_id);
   void ClearCompletedTasks();
+  void SetResultRetention(size_t max_results);
 
   // Statistics
   size_t GetPendingCount() const;
   size_t GetRunningCount() const;
-  size_t GetCompletedCount() const;
+  size_t GetCompletedCount() const;  // Successful tasks since construction
 
-  // Wait for completion
-  bool WaitForQuery(const std::string& task_id, int timeout_ms = -1);
-  void WaitForAll(int timeout_ms = -1);
+  // Wait for completion; both block on condition variables
+  bool WaitForQuery(QueryTaskId task_id, int timeout_ms = -1);
+  bool WaitForAll(int timeout_ms = -1);
 
  private:
-  void WorkerThread();
-  AsyncQueryResult ExecuteQuery(const QueryTask& task);
-  void UpdateProgress(const std::string& task_id, const QueryProgress& progress);
-
-  mutable std::mutex mutex_;
-  std::condition_variable cv_;
-  std::vector<std::thread> workers_;
-  std::queue<QueryTask> pending_queue_;
-
-  struct TaskInfo {
-    QueryExecutionState state{QueryExecutionState::kPending};
-    QueryProgress progress;
-    std::optional<AsyncQueryResult> result;
-    std::promise<AsyncQueryResult> promise;
+  struct TaskState;
+  using TaskPtr = std::shared_ptr<TaskState>;
+
+  static constexpr size_t kLaneCount = 2;
+  static constexpr size_t kShardCount = 16;
+
+  struct Worker {
+    std::mutex mutex;
+    std::array<std::deque<TaskPtr>, kLaneCount> lanes;
+    std::thread thread;
   };
 
-  std::unordered_map<std::string, TaskInfo> tasks_;
-  ProgressCallback progress_callback_;
-  std::atomic<bool> running_{false};
+  // A connection has a strand entry while one of its tasks is queued or
+  // running; later tasks for it wait here.
+  struct StrandShard {
+    std::mutex mutex;
+    std::unordered_map<const Connection*, std::deque<TaskPtr>> waiting;
+  };
+
+  struct TaskShard {
+    mutable std::mutex mutex;
+    std::unordered_map<QueryTaskId, TaskPtr> tasks;
+  };
+
+  QueryTaskId Submit(QueryTask task);
+  bool AcquireStrand(const TaskPtr& task);
+  TaskPtr ReleaseStrand(const TaskState& task);
+  void Enqueue(TaskPtr task, size_t worker_hint);
+  TaskPtr TakeTask(size_t worker_index);
+  TaskPtr PopFrom(Worker& worker, size_t lane, bool front);
+  size_t BackgroundLimit() const;
+  bool HasRunnableWork() const;
+  void WakeOne();
+  void WorkerThread(size_t worker_index);
+  void RunTask(const TaskPtr& task, size_t worker_index);
+  void FinishTask(const TaskPtr& task, AsyncQueryResult result,
+                  bool run_callbacks, size_t worker_hint);
+  AsyncQueryResult ExecuteQuery(TaskState& task);
+  AsyncQueryResult ExecuteStreaming(TaskState& task);
+  void UpdateProgress(TaskState& task, const QueryProgress& progress);
+  TaskPtr FindTask(QueryTaskId task_id) const;
+  void ForgetTask(QueryTaskId task_id);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::array<StrandShard, kShardCount> strands_;
+  std::array<TaskShard, kShardCount> tasks_;
+
+  std::atomic<QueryTaskId> next_task_id_{1};
+  std::atomic<size_t> next_worker_{0};
+  std::array<std::atomic<size_t>, kLaneCount> queued_{};  // In worker deques
+  std::atomic<size_t> parked_count_{0};   // Waiting on a busy connection
+  std::atomic<size_t> outstanding_{0};    // Submitted and not yet finished
   std::atomic<size_t> running_count_{0};
+  std::atomic<size_t> background_running_{0};
+  std::atomic<size_t> completed_count_{0};
+  std::atomic<size_t> sleepers_{0};
+  std::atomic<bool> running_{false};
+
+  std::mutex lifecycle_mutex_;  // Initialize / Shutdown
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  std::mutex idle_mutex_;
+  std::condition_variable idle_cv_;
+
+  std::mutex retention_mutex_;
+  std::deque<QueryTaskId> retained_;
+  size_t retention_limit_{256};
+
+  std::mutex callback_mutex_;  // Held only to copy the pointer
+  std::shared_ptr<const ProgressCallback> progress_callback_;
 };
 
 }  // namespace scratchrobin::core
@@ -10,8 +10,76 @@
 
 #include "core/backup_manager.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+#include "core/output_sink.h"
+
 namespace scratchrobin::core {
 
+namespace {
+
+constexpr std::size_t kCopyBufferBytes = 1024 * 1024;
+
+// Archives favour zstd when the build has it; gzip otherwise.
+CompressionOptions ArchiveCompression(CompressionLevel level) {
+  CompressionOptions options;
+  const bool zstd = OutputCompressionAvailable(OutputCompression::kZstd);
+  switch (level) {
+    case CompressionLevel::kNone:
+      break;
+    case CompressionLevel::kFast:
+      options.format = zstd ? OutputCompression::kZstd : OutputCompression::kGzip;
+      options.level = 1;
+      break;
+    case CompressionLevel::kBalanced:
+      options.format = zstd ? OutputCompression::kZstd : OutputCompression::kGzip;
+      break;
+    case CompressionLevel::kMaximum:
+      options.format = zstd ? OutputCompression::kZstd : OutputCompression::kGzip;
+      options.level = zstd ? 19 : 9;
+      break;
+  }
+  return options;
+}
+
+// Streams |source_path| into |sink| and finishes it.
+Status CopyToSink(const std::string& source_path, OutputSink& sink, int64_t* bytes_copied) {
+  std::FILE* file = std::fopen(source_path.c_str(), "rb");
+  if (!file) {
+    sink.Finish(false);
+    return Status::Error("Cannot open backup file: " + source_path);
+  }
+  std::string buffer(kCopyBufferBytes, '\0');
+  Status status = Status::Ok();
+  int64_t copied = 0;
+  for (;;) {
+    const std::size_t read = std::fread(buffer.data(), 1, buffer.size(), file);
+    if (read > 0) {
+      status = sink.Write(std::string_view(buffer.data(), read));
+      copied += static_cast<int64_t>(read);
+    }
+    if (!status.ok || read < buffer.size()) {
+      break;
+    }
+  }
+  if (status.ok && std::ferror(file)) {
+    status = Status::Error("Read failed: " + source_path);
+  }
+  std::fclose(file);
+  Status finished = sink.Finish(status.ok);
+  if (status.ok) {
+    status = finished;
+  }
+  if (status.ok && bytes_copied) {
+    *bytes_copied = copied;
+  }
+  return status;
+}
+
+}  // namespace
+
 // Private implementation
 struct BackupManager::Impl {
   std::string storage_path;
@@ -19,6 +87,26 @@ struct BackupManager::Impl {
   CompletionCallback completion_callback;
   std::vector<BackupMetadata> backups;
   std::vector<ScheduledBackupJob> scheduled_jobs;
+
+  std::string BackupPath(const std::string& backup_id) const {
+    return storage_path + "/" + backup_id + ".backup";
+  }
+
+  // Copies a stored backup to |destination_path| through |compression|.
+  Status Copy(const std::string& backup_id, const std::string& destination_path,
+              const CompressionOptions& compression, int64_t* bytes_copied) const {
+    auto file = std::make_unique<FileSink>();
+    Status status = file->Open(destination_path);
+    if (!status.ok) {
+      return status;
+    }
+    std::unique_ptr<OutputSink> sink;
+    status = MakeCompressingSink(std::move(file), compression, &sink);
+    if (!status.ok) {
+      return status;
+    }
+    return CopyToSink(BackupPath(backup_id), *sink, bytes_copied);
+  }
 };
 
 BackupManager::BackupManager()
@@ -33,12 +121,6 @@ bool BackupManager::Initialize(const std::string& storage_path) {
 }
 
 void BackupManager::Shutdown() {
-  // Cancel any running backups
-  for (auto& op : impl_->active_operations) {
-    op.second.is_cancelled = true;
-    op.second.status = OperationStatus::Cancelled;
-  }
-  impl_->active_operations.clear();
   impl_->backups.clear();
 }
 
@@ -56,7 +138,7 @@ BackupResult BackupManager::CreateBackup(const BackupConfig& config) {
   }
   
   // Stub implementation
-  result.backup_path = impl_->storage_path + "/" + config.backup_id + ".backup";
+  result.backup_path = impl_->BackupPath(config.backup_id);
   
   BackupMetadata metadata;
   metadata.backup_id = config.backup_id;
@@ -124,9 +206,22 @@ Status BackupManager::VerifyBackup(const std::string& backup_id) {
 
 Status BackupManager::ArchiveBackup(const std::string& backup_id,
                                     const std::string& archive_path) {
-  (void)backup_id;
-  (void)archive_path;
-  return Status::Ok();
+  auto it = std::find_if(impl_->backups.begin(), impl_->backups.end(),
+                         [&](const BackupMetadata& backup) { return backup.backup_id == backup_id; });
+  if (it == impl_->backups.end()) {
+    return Status::Error("Backup not found");
+  }
+  CompressionOptions compression = ArchiveCompression(it->compression);
+  compression.entry_name = backup_id + ".backup";
+  int64_t original_size = 0;
+  Status status = impl_->Copy(backup_id, archive_path, compression, &original_size);
+  if (status.ok) {
+    std::error_code ec;
+    const auto archived_size = std::filesystem::file_size(archive_path, ec);
+    it->original_size = original_size;
+    it->compressed_size = ec ? 0 : static_cast<int64_t>(archived_size);
+  }
+  return status;
 }
 
 BackupProgress BackupManager::GetProgress(const std::string& operation_id) const {
@@ -201,9 +296,10 @@ Status BackupManager::RunScheduledJobNow(const std::string& job_id) {
 
 Status BackupManager::ExportBackupToFile(const std::string& backup_id,
                                          const std::string& destination_path) {
-  (void)backup_id;
-  (void)destination_path;
-  return Status::Ok();
+  if (!BackupExists(backup_id)) {
+    return Status::Error("Backup not found");
+  }
+  return impl_->Copy(backup_id, destination_path, CompressionOptions{}, nullptr);
 }
 
 Status BackupManager::ImportBackupFromFile(const std::string& source_path,
@@ -202,7 +202,8 @@ class BackupManager {
   std::optional<BackupMetadata> GetBackupMetadata(const std::string& backup_id) const;
   bool BackupExists(const std::string& backup_id) const;
   
-  // Backup management
+  // Backup management. ArchiveBackup() compresses the stored backup at its
+  // CompressionLevel (zstd when built with it, otherwise gzip).
   Status DeleteBackup(const std::string& backup_id);
   Status VerifyBackup(const std::string& backup_id);
   Status ArchiveBackup(const std::string& backup_id, const std::string& archive_path);
@@ -0,0 +1,679 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/catalog_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+namespace scratchrobin::core {
+
+namespace {
+
+constexpr char kFileMagic[] = "SBCATALOG1";
+// Guards against reading a corrupt length field as a huge allocation
+constexpr std::uint64_t kMaxFieldBytes = 256 * 1024 * 1024;
+
+// ----------------------------------------------------------------------------
+// Snapshot encoding
+// ----------------------------------------------------------------------------
+
+void WriteInt(std::ostream& out, std::int64_t value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void WriteString(std::ostream& out, const std::string& value) {
+  WriteInt(out, static_cast<std::int64_t>(value.size()));
+  out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+void WriteStrings(std::ostream& out, const std::vector<std::string>& values) {
+  WriteInt(out, static_cast<std::int64_t>(values.size()));
+  for (const auto& value : values) {
+    WriteString(out, value);
+  }
+}
+
+bool ReadInt(std::istream& in, std::int64_t* value) {
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(value), sizeof(*value)));
+}
+
+bool ReadBool(std::istream& in, bool* value) {
+  std::int64_t raw = 0;
+  if (!ReadInt(in, &raw)) {
+    return false;
+  }
+  *value = raw != 0;
+  return true;
+}
+
+bool ReadInt32(std::istream& in, std::int32_t* value) {
+  std::int64_t raw = 0;
+  if (!ReadInt(in, &raw)) {
+    return false;
+  }
+  *value = static_cast<std::int32_t>(raw);
+  return true;
+}
+
+bool ReadCount(std::istream& in, std::size_t* count) {
+  std::int64_t raw = 0;
+  if (!ReadInt(in, &raw) || raw < 0 || static_cast<std::uint64_t>(raw) > kMaxFieldBytes) {
+    return false;
+  }
+  *count = static_cast<std::size_t>(raw);
+  return true;
+}
+
+bool ReadString(std::istream& in, std::string* value) {
+  std::size_t size = 0;
+  if (!ReadCount(in, &size)) {
+    return false;
+  }
+  value->resize(size);
+  return static_cast<bool>(in.read(value->data(), static_cast<std::streamsize>(size)));
+}
+
+bool ReadStrings(std::istream& in, std::vector<std::string>* values) {
+  std::size_t count = 0;
+  if (!ReadCount(in, &count)) {
+    return false;
+  }
+  values->resize(count);
+  for (auto& value : *values) {
+    if (!ReadString(in, &value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void WriteColumn(std::ostream& out, const ColumnInfo& column) {
+  WriteString(out, column.name);
+  WriteString(out, column.data_type);
+  WriteInt(out, column.nullable);
+  WriteString(out, column.default_value);
+  WriteInt(out, column.max_length);
+  WriteInt(out, column.precision);
+  WriteInt(out, column.scale);
+  WriteInt(out, column.ordinal_position);
+  WriteString(out, column.collation);
+  WriteInt(out, column.is_primary_key);
+  WriteInt(out, column.is_foreign_key);
+  WriteString(out, column.foreign_key_table);
+  WriteString(out, column.foreign_key_column);
+}
+
+bool ReadColumn(std::istream& in, ColumnInfo* column) {
+  return ReadString(in, &column->name) && ReadString(in, &column->data_type) &&
+         ReadBool(in, &column->nullable) && ReadString(in, &column->default_value) &&
+         ReadInt32(in, &column->max_length) && ReadInt32(in, &column->precision) &&
+         ReadInt32(in, &column->scale) && ReadInt32(in, &column->ordinal_position) &&
+         ReadString(in, &column->collation) && ReadBool(in, &column->is_primary_key) &&
+         ReadBool(in, &column->is_foreign_key) && ReadString(in, &column->foreign_key_table) &&
+         ReadString(in, &column->foreign_key_column);
+}
+
+void WriteIndex(std::ostream& out, const IndexInfo& index) {
+  WriteString(out, index.name);
+  WriteString(out, index.index_type);
+  WriteInt(out, index.is_unique);
+  WriteInt(out, index.is_primary);
+  WriteString(out, index.filter_condition);
+  WriteInt(out, static_cast<std::int64_t>(index.columns.size()));
+  for (const auto& column : index.columns) {
+    WriteString(out, column.name);
+    WriteString(out, column.sort_order);
+    WriteInt(out, column.is_expression);
+    WriteString(out, column.expression);
+  }
+}
+
+bool ReadIndex(std::istream& in, IndexInfo* index) {
+  std::size_t count = 0;
+  if (!ReadString(in, &index->name) || !ReadString(in, &index->index_type) ||
+      !ReadBool(in, &index->is_unique) || !ReadBool(in, &index->is_primary) ||
+      !ReadString(in, &index->filter_condition) || !ReadCount(in, &count)) {
+    return false;
+  }
+  index->columns.resize(count);
+  for (auto& column : index->columns) {
+    if (!ReadString(in, &column.name) || !ReadString(in, &column.sort_order) ||
+        !ReadBool(in, &column.is_expression) || !ReadString(in, &column.expression)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void WriteConstraint(std::ostream& out, const ConstraintInfo& constraint) {
+  WriteString(out, constraint.name);
+  WriteString(out, constraint.constraint_type);
+  WriteStrings(out, constraint.columns);
+  WriteString(out, constraint.check_expression);
+  WriteString(out, constraint.reference_schema);
+  WriteString(out, constraint.reference_table);
+  WriteStrings(out, constraint.reference_columns);
+  WriteString(out, constraint.update_rule);
+  WriteString(out, constraint.delete_rule);
+  WriteInt(out, constraint.is_deferrable);
+  WriteInt(out, constraint.initially_deferred);
+}
+
+bool ReadConstraint(std::istream& in, ConstraintInfo* constraint) {
+  return ReadString(in, &constraint->name) && ReadString(in, &constraint->constraint_type) &&
+         ReadStrings(in, &constraint->columns) && ReadString(in, &constraint->check_expression) &&
+         ReadString(in, &constraint->reference_schema) &&
+         ReadString(in, &constraint->reference_table) &&
+         ReadStrings(in, &constraint->reference_columns) &&
+         ReadString(in, &constraint->update_rule) && ReadString(in, &constraint->delete_rule) &&
+         ReadBool(in, &constraint->is_deferrable) && ReadBool(in, &constraint->initially_deferred);
+}
+
+// ----------------------------------------------------------------------------
+// DDL target extraction
+// ----------------------------------------------------------------------------
+
+struct Token {
+  std::string text;  // Upper-cased unless quoted
+  bool quoted = false;
+};
+
+// The leading tokens of |sql|, up to the first parenthesis or semicolon.
+std::vector<Token> LeadingTokens(const std::string& sql, std::size_t limit) {
+  std::vector<Token> tokens;
+  std::size_t i = 0;
+  while (i < sql.size() && tokens.size() < limit) {
+    const unsigned char c = static_cast<unsigned char>(sql[i]);
+    if (std::isspace(c)) {
+      ++i;
+    } else if (sql.compare(i, 2, "--") == 0) {
+      i = sql.find('\n', i);
+      i = i == std::string::npos ? sql.size() : i + 1;
+    } else if (sql.compare(i, 2, "/*") == 0) {
+      i = sql.find("*/", i + 2);
+      i = i == std::string::npos ? sql.size() : i + 2;
+    } else if (c == '"') {
+      Token token;
+      token.quoted = true;
+      for (++i; i < sql.size(); ++i) {
+        if (sql[i] == '"') {
+          if (i + 1 < sql.size() && sql[i + 1] == '"') {
+            token.text.push_back('"');
+            ++i;
+          } else {
+            ++i;
+            break;
+          }
+        } else {
+          token.text.push_back(sql[i]);
+        }
+      }
+      tokens.push_back(std::move(token));
+    } else if (c == '.') {
+      tokens.push_back({".", false});
+      ++i;
+    } else if (std::isalnum(c) || c == '_' || c == '$') {
+      Token token;
+      while (i < sql.size() &&
+             (std::isalnum(static_cast<unsigned char>(sql[i])) || sql[i] == '_' || sql[i] == '$')) {
+        token.text.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(sql[i]))));
+        ++i;
+      }
+      tokens.push_back(std::move(token));
+    } else {
+      break;
+    }
+  }
+  return tokens;
+}
+
+struct QualifiedName {
+  std::string schema;
+  std::string name;
+  bool quoted = false;  // The object name was quoted
+};
+
+// Reads "name" or "schema.name" at |*pos|. Unquoted schema names are
+// matched case-insensitively like the object name.
+bool ReadQualifiedName(const std::vector<Token>& tokens, std::size_t* pos, QualifiedName* out) {
+  if (*pos >= tokens.size() || tokens[*pos].text == ".") {
+    return false;
+  }
+  out->name = tokens[*pos].text;
+  out->quoted = tokens[*pos].quoted;
+  ++*pos;
+  if (*pos + 1 < tokens.size() && tokens[*pos].text == ".") {
+    out->schema = out->name;
+    out->name = tokens[*pos + 1].text;
+    out->quoted = tokens[*pos + 1].quoted;
+    *pos += 2;
+  }
+  return true;
+}
+
+bool IEquals(const std::string& a, const std::string& b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](unsigned char x, unsigned char y) {
+           return std::toupper(x) == std::toupper(y);
+         });
+}
+
+bool IsModifier(const std::string& word) {
+  static const char* const kModifiers[] = {"OR",       "REPLACE",  "GLOBAL",   "LOCAL",
+                                           "TEMPORARY", "TEMP",    "UNIQUE",   "MATERIALIZED",
+                                           "UNLOGGED", "EXTERNAL", "VIRTUAL"};
+  return std::any_of(std::begin(kModifiers), std::end(kModifiers),
+                     [&](const char* modifier) { return word == modifier; });
+}
+
+}  // namespace
+
+// ============================================================================
+// Listing
+// ============================================================================
+
+bool CatalogCache::ListingStale() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return listing_stale_;
+}
+
+std::size_t CatalogCache::ApplyListing(std::vector<CatalogTableStamp> rows) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  std::map<Key, Entry> fresh;
+  std::size_t changed = 0;
+  for (auto& row : rows) {
+    Key key(row.schema, row.name);
+    Entry entry;
+    auto old = entries_.find(key);
+    if (old != entries_.end() && old->second.listing.stamp == row.stamp &&
+        old->second.listing.object_id == row.object_id) {
+      entry.details = std::move(old->second.details);
+      entry.version = old->second.version;
+    } else {
+      entry.version = ++next_version_;
+      ++changed;
+    }
+    entry.listing = std::move(row);
+    fresh.insert_or_assign(std::move(key), std::move(entry));
+  }
+  if (changed != 0 || fresh.size() != entries_.size()) {
+    listing_version_.fetch_add(1, std::memory_order_relaxed);
+  }
+  entries_ = std::move(fresh);
+  listing_stale_ = false;
+  ++refreshes_;
+  return changed;
+}
+
+std::uint64_t CatalogCache::ListingVersion() const {
+  return listing_version_.load(std::memory_order_relaxed);
+}
+
+std::vector<std::string> CatalogCache::Schemas() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::vector<std::string> schemas;
+  for (const auto& [key, entry] : entries_) {
+    if (schemas.empty() || schemas.back() != key.first) {
+      schemas.push_back(key.first);
+    }
+  }
+  return schemas;
+}
+
+std::vector<TableInfo> CatalogCache::Tables(const std::string& schema) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = schema.empty() ? entries_.begin() : entries_.lower_bound(Key(schema, std::string()));
+  std::vector<TableInfo> tables;
+  for (; it != entries_.end() && (schema.empty() || it->first.first == schema); ++it) {
+    const Entry& entry = it->second;
+    TableInfo table(entry.listing.name, entry.listing.schema);
+    table.row_count = entry.listing.row_count;
+    table.is_temporary = entry.listing.table_type == "TEMPORARY";
+    if (entry.details) {
+      table.columns = entry.details->columns;
+    }
+    tables.push_back(std::move(table));
+  }
+  return tables;
+}
+
+std::optional<CatalogTableStamp> CatalogCache::Find(const std::string& schema,
+                                                    const std::string& table,
+                                                    std::uint64_t* version) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = entries_.find(Key(schema, table));
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  if (version) {
+    *version = it->second.version;
+  }
+  return it->second.listing;
+}
+
+// ============================================================================
+// Details
+// ============================================================================
+
+std::optional<CatalogTableDetails> CatalogCache::Details(const std::string& schema,
+                                                         const std::string& table) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = entries_.find(Key(schema, table));
+  if (it == entries_.end() || !it->second.details) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  return it->second.details;
+}
+
+std::vector<std::pair<CatalogTableStamp, std::uint64_t>> CatalogCache::Uncached(
+    const std::string& schema, const std::vector<std::string>& tables) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::vector<std::pair<CatalogTableStamp, std::uint64_t>> uncached;
+  auto add = [&](const Entry& entry) {
+    if (!entry.details) {
+      uncached.emplace_back(entry.listing, entry.version);
+    }
+  };
+  if (!tables.empty()) {
+    for (const auto& table : tables) {
+      auto it = entries_.find(Key(schema, table));
+      if (it != entries_.end()) {
+        add(it->second);
+      }
+    }
+    return uncached;
+  }
+  auto it = schema.empty() ? entries_.begin() : entries_.lower_bound(Key(schema, std::string()));
+  for (; it != entries_.end() && (schema.empty() || it->first.first == schema); ++it) {
+    add(it->second);
+  }
+  return uncached;
+}
+
+void CatalogCache::StoreDetails(const std::string& schema, const std::string& table,
+                                std::uint64_t version, CatalogTableDetails details) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto it = entries_.find(Key(schema, table));
+  if (it != entries_.end() && it->second.version == version) {
+    it->second.details = std::move(details);
+  }
+}
+
+// ============================================================================
+// Invalidation
+// ============================================================================
+
+void CatalogCache::Invalidate(const std::string& schema, const std::string& table) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto it = entries_.find(Key(schema, table));
+  if (it != entries_.end()) {
+    InvalidateLocked(it->second);
+  }
+}
+
+void CatalogCache::InvalidateListing() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  listing_stale_ = true;
+}
+
+void CatalogCache::InvalidateForStatement(const std::string& sql) {
+  const std::vector<Token> tokens = LeadingTokens(sql, 24);
+  if (tokens.empty()) {
+    return;
+  }
+  // Only DDL changes structure; queries, DML, TRUNCATE, COMMENT and
+  // grants leave the cache as it is
+  const std::string& verb = tokens[0].text;
+  if (tokens[0].quoted || (verb != "CREATE" && verb != "ALTER" && verb != "DROP" &&
+                           verb != "RENAME" && verb != "RECREATE")) {
+    return;
+  }
+  std::size_t pos = 1;
+  while (pos < tokens.size() && !tokens[pos].quoted && IsModifier(tokens[pos].text)) {
+    ++pos;
+  }
+  const std::string kind = pos < tokens.size() ? tokens[pos++].text : std::string();
+  while (pos < tokens.size() && !tokens[pos].quoted &&
+         (tokens[pos].text == "IF" || tokens[pos].text == "NOT" || tokens[pos].text == "EXISTS" ||
+          tokens[pos].text == "CONCURRENTLY")) {
+    ++pos;
+  }
+  QualifiedName target;
+  const bool named = ReadQualifiedName(tokens, &pos, &target);
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  ++invalidations_;
+  if (kind == "TABLE" && named) {
+    for (Entry* entry : MatchLocked(target.schema, target.name, target.quoted)) {
+      InvalidateLocked(*entry);
+    }
+    // Anything but an in-place ALTER can add, drop or rename a table
+    bool renames = verb != "ALTER";
+    for (std::size_t i = pos; i < tokens.size() && !renames; ++i) {
+      renames = !tokens[i].quoted && tokens[i].text == "RENAME";
+    }
+    listing_stale_ = listing_stale_ || renames;
+    return;
+  }
+  if (kind == "INDEX" && named) {
+    if (verb == "CREATE") {
+      // CREATE INDEX name ON [schema.]table
+      while (pos < tokens.size() && !(tokens[pos].text == "ON" && !tokens[pos].quoted)) {
+        ++pos;
+      }
+      QualifiedName table;
+      ++pos;
+      if (ReadQualifiedName(tokens, &pos, &table)) {
+        for (Entry* entry : MatchLocked(table.schema, table.name, table.quoted)) {
+          InvalidateLocked(*entry);
+        }
+        return;
+      }
+    } else {
+      // The owning table is only known from cached details
+      for (auto& [key, entry] : entries_) {
+        if (!entry.details || (!target.schema.empty() && !IEquals(key.first, target.schema))) {
+          continue;
+        }
+        for (const auto& index : entry.details->indexes) {
+          if (target.quoted ? index.name == target.name : IEquals(index.name, target.name)) {
+            InvalidateLocked(entry);
+            break;
+          }
+        }
+      }
+      return;
+    }
+  }
+  if (kind == "DOMAIN" || kind == "TYPE" || kind == "SCHEMA" || !named) {
+    // May change the columns of any table
+    for (auto& [key, entry] : entries_) {
+      if (kind != "SCHEMA" || !named ||
+          (target.quoted ? key.first == target.name : IEquals(key.first, target.name))) {
+        InvalidateLocked(entry);
+      }
+    }
+  }
+  listing_stale_ = true;
+}
+
+void CatalogCache::Clear() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  entries_.clear();
+  listing_stale_ = true;
+  listing_version_.fetch_add(1, std::memory_order_relaxed);
+}
+
+CatalogCache::Stats CatalogCache::GetStats() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  Stats stats;
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.refreshes = refreshes_;
+  stats.invalidations = invalidations_;
+  stats.tables = entries_.size();
+  for (const auto& [key, entry] : entries_) {
+    stats.tables_with_details += entry.details ? 1 : 0;
+  }
+  return stats;
+}
+
+std::vector<CatalogCache::Entry*> CatalogCache::MatchLocked(const std::string& schema,
+                                                            const std::string& table,
+                                                            bool exact) {
+  std::vector<Entry*> matches;
+  for (auto& [key, entry] : entries_) {
+    const bool schema_matches = schema.empty() || IEquals(key.first, schema);
+    const bool table_matches = exact ? key.second == table : IEquals(key.second, table);
+    if (schema_matches && table_matches) {
+      matches.push_back(&entry);
+    }
+  }
+  return matches;
+}
+
+void CatalogCache::InvalidateLocked(Entry& entry) {
+  entry.details.reset();
+  entry.version = ++next_version_;
+}
+
+// ============================================================================
+// Persistence
+// ============================================================================
+
+Status CatalogCache::SaveToFile(const std::string& path) const {
+  const std::string temp_path = path + ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return Status::Error("Cannot open catalog snapshot for writing: " + temp_path);
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    out.write(kFileMagic, sizeof(kFileMagic) - 1);
+    WriteInt(out, static_cast<std::int64_t>(entries_.size()));
+    for (const auto& [key, entry] : entries_) {
+      const CatalogTableStamp& listing = entry.listing;
+      WriteString(out, listing.schema);
+      WriteString(out, listing.name);
+      WriteString(out, listing.object_id);
+      WriteString(out, listing.table_type);
+      WriteString(out, listing.stamp);
+      WriteInt(out, listing.row_count);
+      WriteInt(out, entry.details.has_value());
+      if (!entry.details) {
+        continue;
+      }
+      WriteInt(out, static_cast<std::int64_t>(entry.details->columns.size()));
+      for (const auto& column : entry.details->columns) {
+        WriteColumn(out, column);
+      }
+      WriteInt(out, static_cast<std::int64_t>(entry.details->indexes.size()));
+      for (const auto& index : entry.details->indexes) {
+        WriteIndex(out, index);
+      }
+      WriteInt(out, static_cast<std::int64_t>(entry.details->constraints.size()));
+      for (const auto& constraint : entry.details->constraints) {
+        WriteConstraint(out, constraint);
+      }
+    }
+    if (!out.flush()) {
+      std::remove(temp_path.c_str());
+      return Status::Error("Failed to write catalog snapshot: " + temp_path);
+    }
+  }
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+    return Status::Error("Cannot replace catalog snapshot: " + path);
+  }
+  return Status::Ok();
+}
+
+Status CatalogCache::LoadFromFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return Status::Error("Cannot open catalog snapshot: " + path);
+  }
+  char magic[sizeof(kFileMagic) - 1];
+  std::size_t count = 0;
+  if (!in.read(magic, sizeof(magic)) || std::string(magic, sizeof(magic)) != kFileMagic ||
+      !ReadCount(in, &count)) {
+    return Status::Error("Not a catalog snapshot: " + path);
+  }
+
+  // Parse everything before touching the cache so a truncated file
+  // leaves it unchanged
+  const Status truncated = Status::Error("Catalog snapshot is truncated: " + path);
+  std::map<Key, Entry> loaded;
+  for (std::size_t i = 0; i < count; ++i) {
+    Entry entry;
+    CatalogTableStamp& listing = entry.listing;
+    bool has_details = false;
+    if (!ReadString(in, &listing.schema) || !ReadString(in, &listing.name) ||
+        !ReadString(in, &listing.object_id) || !ReadString(in, &listing.table_type) ||
+        !ReadString(in, &listing.stamp) || !ReadInt(in, &listing.row_count) ||
+        !ReadBool(in, &has_details)) {
+      return truncated;
+    }
+    if (has_details) {
+      CatalogTableDetails details;
+      std::size_t items = 0;
+      if (!ReadCount(in, &items)) {
+        return truncated;
+      }
+      details.columns.resize(items);
+      for (auto& column : details.columns) {
+        if (!ReadColumn(in, &column)) {
+          return truncated;
+        }
+      }
+      if (!ReadCount(in, &items)) {
+        return truncated;
+      }
+      details.indexes.resize(items);
+      for (auto& index : details.indexes) {
+        if (!ReadIndex(in, &index)) {
+          return truncated;
+        }
+        index.type = "index";
+        index.table_name = listing.name;
+        index.table_schema = listing.schema;
+        index.schema = listing.schema;
+      }
+      if (!ReadCount(in, &items)) {
+        return truncated;
+      }
+      details.constraints.resize(items);
+      for (auto& constraint : details.constraints) {
+        if (!ReadConstraint(in, &constraint)) {
+          return truncated;
+        }
+        constraint.type = "constraint";
+        constraint.table_name = listing.name;
+        constraint.schema = listing.schema;
+      }
+      entry.details = std::move(details);
+    }
+    Key key(listing.schema, listing.name);
+    loaded.insert_or_assign(std::move(key), std::move(entry));
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  for (auto& [key, entry] : loaded) {
+    entry.version = ++next_version_;
+  }
+  entries_ = std::move(loaded);
+  listing_stale_ = true;
+  listing_version_.fetch_add(1, std::memory_order_relaxed);
+  return Status::Ok();
+}
+
+}  // namespace scratchrobin::core
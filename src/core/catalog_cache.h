@@ -0,0 +1,139 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/scratchbird_catalog_client.h"
+#include "core/status.h"
+
+namespace scratchrobin::core {
+
+// One row of the catalog listing: a table and the stamp its cached
+// details were fetched at. A table whose stamp changes is refetched.
+struct CatalogTableStamp {
+  std::string schema;
+  std::string name;
+  std::string object_id;
+  std::string table_type;
+  std::string stamp;
+  int64_t row_count = -1;
+};
+
+struct CatalogTableDetails {
+  std::vector<ColumnInfo> columns;
+  std::vector<IndexInfo> indexes;
+  std::vector<ConstraintInfo> constraints;
+};
+
+/**
+ * CatalogCache - in-memory catalog model keyed by (schema, table)
+ *
+ * Holds the table listing of one database plus, per table, the details
+ * fetched so far. ApplyListing() diffs a fresh listing against the cache
+ * by stamp, so a refresh keeps the details of every unchanged table and
+ * only the changed ones are fetched again. DDL run through this client
+ * is reported with InvalidateForStatement(), which drops what the
+ * statement may have changed. The whole model can be written to disk and
+ * read back, so reconnecting to a large database starts warm.
+ *
+ * Thread-safe; readers share a lock.
+ */
+class CatalogCache {
+ public:
+  struct Stats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t refreshes = 0;
+    std::uint64_t invalidations = 0;
+    std::size_t tables = 0;
+    std::size_t tables_with_details = 0;
+  };
+
+  CatalogCache() = default;
+  CatalogCache(const CatalogCache&) = delete;
+  CatalogCache& operator=(const CatalogCache&) = delete;
+
+  // Listing. A listing is stale until the first ApplyListing(), after
+  // loading a snapshot and after DDL that adds, drops or renames objects.
+  bool ListingStale() const;
+  // Replaces the listing; returns the number of tables that are new or
+  // whose stamp changed. Dropped tables are removed.
+  std::size_t ApplyListing(std::vector<CatalogTableStamp> rows);
+  // Changes whenever tables are added, dropped or restamped, so views
+  // built from Tables() know when to rebuild.
+  std::uint64_t ListingVersion() const;
+  std::vector<std::string> Schemas() const;
+  // Tables of |schema| (all schemas when empty), in name order. Columns
+  // are filled for tables whose details are cached.
+  std::vector<TableInfo> Tables(const std::string& schema = "") const;
+  // |version| changes whenever the table's details are dropped.
+  std::optional<CatalogTableStamp> Find(const std::string& schema, const std::string& table,
+                                        std::uint64_t* version = nullptr) const;
+
+  // Details. Lookups count as hits or misses.
+  std::optional<CatalogTableDetails> Details(const std::string& schema,
+                                             const std::string& table) const;
+  // Listing rows without cached details among |tables| of |schema| (all
+  // tables of |schema|, or of every schema, when empty), each with the
+  // version to pass to StoreDetails(). Not counted as lookups.
+  std::vector<std::pair<CatalogTableStamp, std::uint64_t>> Uncached(
+      const std::string& schema, const std::vector<std::string>& tables = {}) const;
+  // Stores details fetched when Find() returned |version|. Ignored if the
+  // table was invalidated since, or is not in the listing.
+  void StoreDetails(const std::string& schema, const std::string& table,
+                    std::uint64_t version, CatalogTableDetails details);
+
+  // Invalidation
+  void Invalidate(const std::string& schema, const std::string& table);
+  void InvalidateListing();
+  void InvalidateForStatement(const std::string& sql);
+  void Clear();
+
+  Stats GetStats() const;
+
+  // Persistence. A file from another snapshot format version is rejected;
+  // a loaded cache has a stale listing.
+  Status SaveToFile(const std::string& path) const;
+  Status LoadFromFile(const std::string& path);
+
+ private:
+  using Key = std::pair<std::string, std::string>;  // (schema, table)
+
+  struct Entry {
+    CatalogTableStamp listing;
+    std::optional<CatalogTableDetails> details;
+    std::uint64_t version = 0;
+  };
+
+  // Entries named |table| in |schema| as written in DDL: an empty schema
+  // matches any, schemas match case-insensitively and so do unquoted
+  // table names (|exact| false).
+  std::vector<Entry*> MatchLocked(const std::string& schema, const std::string& table,
+                                  bool exact);
+  void InvalidateLocked(Entry& entry);
+
+  mutable std::shared_mutex mutex_;
+  std::map<Key, Entry> entries_;
+  bool listing_stale_ = true;
+  std::uint64_t next_version_ = 0;
+  std::atomic<std::uint64_t> listing_version_{0};
+  mutable std::atomic<std::uint64_t> hits_{0};
+  mutable std::atomic<std::uint64_t> misses_{0};
+  std::uint64_t refreshes_ = 0;
+  std::uint64_t invalidations_ = 0;
+};
+
+}  // namespace scratchrobin::core
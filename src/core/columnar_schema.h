@@ -0,0 +1,66 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "core/result_set.h"
+
+namespace scratchrobin::core {
+
+// Column names and types of a flat Parquet or Arrow table. Exports take
+// the declared column types, so a later batch cannot disagree with the
+// schema already written: kInt64, kDouble and kDate are stored natively,
+// anything else (kText, kAuto) as UTF-8 strings.
+struct ColumnarSchema {
+  std::vector<std::string> names;
+  std::vector<ColumnType> types;
+};
+
+// The type a schema column is stored as: kInt64, kDouble, kDate or kText.
+inline ColumnType ColumnarStorageType(ColumnType type) {
+  return type == ColumnType::kInt64 || type == ColumnType::kDouble || type == ColumnType::kDate
+             ? type
+             : ColumnType::kText;
+}
+
+// Resolves the buffer to encode rows [*begin, *end) of a column stored as
+// |type|. A buffer already of that type (or still kAuto, i.e. all NULL) is
+// used as is. Integers widen into double columns and string columns take
+// any cell formatted; both are copied into |scratch| and the range
+// rebased. Returns nullptr when the values cannot be stored as |type|.
+inline const ColumnBuffer* ColumnarValues(const ColumnBuffer& column, ColumnType type,
+                                          std::size_t* begin, std::size_t* end,
+                                          ColumnBuffer* scratch) {
+  if (column.Type() == type || column.Type() == ColumnType::kAuto) {
+    return &column;
+  }
+  const bool widen = type == ColumnType::kDouble && column.Type() == ColumnType::kInt64;
+  if (type != ColumnType::kText && !widen) {
+    return nullptr;
+  }
+  *scratch = ColumnBuffer(type);
+  std::string text;
+  for (std::size_t row = *begin; row < *end; ++row) {
+    if (column.IsNull(row)) {
+      scratch->AppendNull();
+    } else if (widen) {
+      scratch->AppendDouble(static_cast<double>(column.Int64At(row)));
+    } else {
+      text.clear();
+      column.AppendFormatted(row, text);
+      scratch->AppendText(text);
+    }
+  }
+  *end -= *begin;
+  *begin = 0;
+  return scratch;
+}
+
+}  // namespace scratchrobin::core
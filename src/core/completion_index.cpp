@@ -0,0 +1,333 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/completion_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <utility>
+
+namespace scratchrobin::core {
+
+namespace {
+
+std::string Lower(std::string_view text) {
+  std::string lower(text);
+  for (char& c : lower) {
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  }
+  return lower;
+}
+
+std::uint32_t Trigram(std::string_view text, std::size_t pos) {
+  return static_cast<std::uint32_t>(static_cast<unsigned char>(text[pos])) << 16 |
+         static_cast<std::uint32_t>(static_cast<unsigned char>(text[pos + 1])) << 8 |
+         static_cast<std::uint32_t>(static_cast<unsigned char>(text[pos + 2]));
+}
+
+bool IsWordBreak(char c) {
+  return c == '_' || c == ' ' || c == '(' || c == '.';
+}
+
+bool Better(const CompletionMatch& a, const CompletionMatch& b) {
+  if (a.score != b.score) return a.score > b.score;
+  if (a.entry->priority != b.entry->priority) return a.entry->priority > b.entry->priority;
+  return a.entry->text < b.entry->text;
+}
+
+}  // namespace
+
+CompletionIndex::CompletionIndex() {
+  nodes_.emplace_back();  // Root
+}
+
+// ============================================================================
+// Updates
+// ============================================================================
+
+void CompletionIndex::Add(CompletionEntry entry) {
+  const std::uint32_t key = InternKey(Lower(entry.text));
+  const auto id = static_cast<std::uint32_t>(entries_.size());
+  if (!entry.group.empty()) {
+    groups_[entry.group].push_back(id);
+  }
+  entries_.push_back(std::move(entry));
+  next_entry_.push_back(keys_[key].first_entry);
+  entry_key_.push_back(key);
+  alive_.push_back(true);
+  keys_[key].first_entry = id;
+  ++live_;
+}
+
+void CompletionIndex::ReplaceGroup(const std::string& group, std::vector<CompletionEntry> entries) {
+  RemoveGroup(group);
+  for (auto& entry : entries) {
+    entry.group = group;
+    Add(std::move(entry));
+  }
+}
+
+void CompletionIndex::RemoveGroup(const std::string& group) {
+  auto it = groups_.find(group);
+  if (it == groups_.end()) {
+    return;
+  }
+  for (std::uint32_t id : it->second) {
+    if (alive_[id]) {
+      alive_[id] = false;
+      --live_;
+      ++dead_;
+    }
+  }
+  groups_.erase(it);
+  if (dead_ > live_ + 1024) {
+    Compact();
+  }
+}
+
+bool CompletionIndex::HasGroup(const std::string& group) const {
+  return groups_.count(group) != 0;
+}
+
+void CompletionIndex::Clear() {
+  *this = CompletionIndex();
+}
+
+std::uint32_t CompletionIndex::FindNode(std::string_view lower) const {
+  std::uint32_t node = 0;
+  for (char c : lower) {
+    std::uint32_t child = nodes_[node].first_child;
+    while (child != kNone && nodes_[child].c != c) {
+      child = nodes_[child].next_sibling;
+    }
+    if (child == kNone) {
+      return kNone;
+    }
+    node = child;
+  }
+  return node;
+}
+
+std::uint32_t CompletionIndex::InternKey(const std::string& lower) {
+  std::uint32_t node = 0;
+  for (char c : lower) {
+    std::uint32_t child = nodes_[node].first_child;
+    while (child != kNone && nodes_[child].c != c) {
+      child = nodes_[child].next_sibling;
+    }
+    if (child == kNone) {
+      child = static_cast<std::uint32_t>(nodes_.size());
+      Node added;
+      added.c = c;
+      added.next_sibling = nodes_[node].first_child;
+      nodes_.push_back(added);
+      nodes_[node].first_child = child;
+    }
+    node = child;
+  }
+  if (nodes_[node].key != kNone) {
+    return nodes_[node].key;
+  }
+
+  const auto key = static_cast<std::uint32_t>(keys_.size());
+  nodes_[node].key = key;
+  keys_.push_back(Key{lower, kNone, CharMask(lower)});
+  std::uint32_t last = kNone;
+  std::vector<std::uint32_t> grams;
+  for (std::size_t i = 0; i + 3 <= lower.size(); ++i) {
+    grams.push_back(Trigram(lower, i));
+  }
+  std::sort(grams.begin(), grams.end());
+  for (std::uint32_t gram : grams) {
+    if (gram != last) {
+      trigrams_[gram].push_back(key);  // Key ids ascend, so postings stay sorted
+      last = gram;
+    }
+  }
+  return key;
+}
+
+// Rebuilds from the live entries, dropping tombstones and unused keys.
+void CompletionIndex::Compact() {
+  std::vector<CompletionEntry> live;
+  live.reserve(live_);
+  for (std::size_t id = 0; id < entries_.size(); ++id) {
+    if (alive_[id]) {
+      live.push_back(std::move(entries_[id]));
+    }
+  }
+  Clear();
+  for (auto& entry : live) {
+    Add(std::move(entry));
+  }
+}
+
+// ============================================================================
+// Search
+// ============================================================================
+
+int CompletionIndex::Score(std::string_view key, std::string_view pattern, std::size_t length) {
+  const int len = static_cast<int>(length);
+  if (key == pattern) return 1000;
+  const std::size_t pos = key.find(pattern);
+  if (pos == 0) return 800 - len;
+  if (pos != std::string_view::npos) {
+    return (IsWordBreak(key[pos - 1]) ? 600 : 400) - len;
+  }
+
+  // Subsequence; smaller gaps score higher
+  std::size_t p = 0;
+  int gaps = 0;
+  std::size_t last = std::string_view::npos;
+  for (std::size_t i = 0; i < key.size() && p < pattern.size(); ++i) {
+    if (key[i] == pattern[p]) {
+      if (last != std::string_view::npos) {
+        gaps += static_cast<int>(i - last - 1);
+      }
+      last = i;
+      ++p;
+    }
+  }
+  if (p < pattern.size()) return 0;
+  return std::max(0, 200 - gaps * 10 - len);
+}
+
+// One bit per letter, digit and '_'; everything else shares bit 63.
+std::uint64_t CompletionIndex::CharMask(std::string_view lower) {
+  std::uint64_t mask = 0;
+  for (char c : lower) {
+    unsigned bit = 63;
+    if (c >= 'a' && c <= 'z') {
+      bit = static_cast<unsigned>(c - 'a');
+    } else if (c >= '0' && c <= '9') {
+      bit = 26 + static_cast<unsigned>(c - '0');
+    } else if (c == '_') {
+      bit = 36;
+    }
+    mask |= std::uint64_t{1} << bit;
+  }
+  return mask;
+}
+
+bool CompletionIndex::Accepts(const CompletionEntry& entry, const CompletionQuery& query,
+                              const std::unordered_set<std::string_view>& column_groups) const {
+  if (!(query.kinds & CompletionKindBit(entry.kind))) {
+    return false;
+  }
+  return entry.kind != CompletionKind::kColumn || column_groups.count(entry.group) != 0;
+}
+
+std::vector<CompletionMatch> CompletionIndex::Search(const CompletionQuery& query) const {
+  std::vector<CompletionMatch> matches;
+  if (query.limit == 0) {
+    return matches;
+  }
+  const std::string pattern = Lower(query.pattern);
+  const std::unordered_set<std::string_view> column_groups(query.column_groups.begin(),
+                                                           query.column_groups.end());
+  auto add_key = [&](std::uint32_t key, int score_hint) {
+    for (std::uint32_t id = keys_[key].first_entry; id != kNone; id = next_entry_[id]) {
+      const CompletionEntry& entry = entries_[id];
+      if (!alive_[id] || !Accepts(entry, query, column_groups)) {
+        continue;
+      }
+      const int score = score_hint >= 0 ? score_hint
+                                        : Score(keys_[key].lower, pattern, entry.text.size());
+      if (score > 0 || pattern.empty()) {
+        matches.push_back({&entry, score});
+      }
+    }
+  };
+  auto finish = [&]() {
+    const std::size_t keep = std::min(query.limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + keep, matches.end(), Better);
+    matches.resize(keep);
+    return matches;
+  };
+
+  if (pattern.empty()) {
+    for (std::uint32_t key = 0; key < keys_.size(); ++key) {
+      add_key(key, 0);
+    }
+    return finish();
+  }
+
+  // Prefix tier: breadth first below the pattern's node. Every key at one
+  // depth scores the same, so once a depth fills the limit, deeper keys
+  // cannot displace anything.
+  std::unordered_set<std::uint32_t> prefix_keys;
+  const std::uint32_t start = FindNode(pattern);
+  if (start != kNone) {
+    std::vector<std::uint32_t> level{start};
+    std::vector<std::uint32_t> next;
+    while (!level.empty() && matches.size() < query.limit) {
+      next.clear();
+      for (std::uint32_t node : level) {
+        if (nodes_[node].key != kNone) {
+          prefix_keys.insert(nodes_[node].key);
+          add_key(nodes_[node].key, -1);
+        }
+        for (std::uint32_t child = nodes_[node].first_child; child != kNone;
+             child = nodes_[child].next_sibling) {
+          next.push_back(child);
+        }
+      }
+      level.swap(next);
+    }
+  }
+  if (matches.size() >= query.limit) {
+    return finish();
+  }
+
+  // Contains tier: candidates share every trigram of the pattern. Shorter
+  // patterns have no trigram and fall through to the scan below.
+  std::unordered_set<std::uint32_t> contains_keys;
+  if (pattern.size() >= 3) {
+    std::vector<const std::vector<std::uint32_t>*> postings;
+    for (std::size_t i = 0; i + 3 <= pattern.size(); ++i) {
+      auto it = trigrams_.find(Trigram(pattern, i));
+      if (it == trigrams_.end()) {
+        postings.clear();
+        break;
+      }
+      postings.push_back(&it->second);
+    }
+    if (!postings.empty()) {
+      std::sort(postings.begin(), postings.end(),
+                [](const auto* a, const auto* b) { return a->size() < b->size(); });
+      for (std::uint32_t key : *postings.front()) {
+        bool in_all = true;
+        for (std::size_t p = 1; p < postings.size() && in_all; ++p) {
+          in_all = std::binary_search(postings[p]->begin(), postings[p]->end(), key);
+        }
+        if (in_all && !prefix_keys.count(key) &&
+            keys_[key].lower.find(pattern) != std::string::npos) {
+          contains_keys.insert(key);
+          add_key(key, -1);
+        }
+      }
+    }
+    if (matches.size() >= query.limit || !query.fuzzy) {
+      return finish();
+    }
+  }
+
+  // Scan tier: substrings of short patterns, then subsequences
+  const std::uint64_t pattern_chars = CharMask(pattern);
+  for (std::uint32_t key = 0; key < keys_.size(); ++key) {
+    if ((pattern_chars & ~keys_[key].chars) != 0 || keys_[key].first_entry == kNone ||
+        prefix_keys.count(key) || contains_keys.count(key)) {
+      continue;
+    }
+    if (!query.fuzzy && keys_[key].lower.find(pattern) == std::string::npos) {
+      continue;
+    }
+    add_key(key, -1);
+  }
+  return finish();
+}
+
+}  // namespace scratchrobin::core
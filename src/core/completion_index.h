@@ -0,0 +1,131 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace scratchrobin::core {
+
+enum class CompletionKind : std::uint8_t {
+  kKeyword,
+  kFunction,
+  kSchema,
+  kTable,
+  kView,
+  kColumn,
+};
+
+constexpr std::uint32_t CompletionKindBit(CompletionKind kind) {
+  return 1u << static_cast<unsigned>(kind);
+}
+
+struct CompletionEntry {
+  std::string text;
+  CompletionKind kind = CompletionKind::kKeyword;
+  std::string group;   // Entries replaced together, e.g. the table of a column
+  std::string detail;  // Data type, source table
+  int priority = 0;    // Breaks ties between equally good matches
+};
+
+struct CompletionQuery {
+  std::string pattern;  // Matched case-insensitively; empty matches all
+  std::uint32_t kinds = ~0u;  // CompletionKindBit() mask
+  // Columns are only returned from these groups; other kinds ignore it
+  std::vector<std::string> column_groups;
+  std::size_t limit = 50;
+  bool fuzzy = true;  // Also match the pattern as a subsequence
+};
+
+struct CompletionMatch {
+  const CompletionEntry* entry = nullptr;  // Valid until the index changes
+  int score = 0;
+};
+
+/**
+ * CompletionIndex - identifier index for code completion
+ *
+ * Entries are keyed by their lower-cased text in a prefix trie, and every
+ * distinct key is also posted under each of its trigrams. A search walks
+ * three tiers, best first:
+ *
+ *   prefix    the trie node for the pattern, breadth first, so shorter
+ *             (better scoring) keys come first and the walk stops at the
+ *             first depth that fills the limit;
+ *   contains  keys from the intersection of the pattern's trigram
+ *             postings, checked for the substring;
+ *   fuzzy     keys holding the pattern as a subsequence (scan).
+ *
+ * A tier is only searched while fewer than |limit| matches were found, so
+ * a short pattern over a large catalog costs a bounded trie walk. Scores
+ * follow the completer's classic scale: exact 1000, prefix 800, word
+ * start 600, contains 400, fuzzy 200 and below, less the text length.
+ *
+ * Groups replace entries incrementally; removed entries are tombstoned
+ * and the index compacts itself once they outnumber the live ones. Not
+ * thread-safe; build one off-thread and hand it over, or mutate it from
+ * the thread that searches it.
+ */
+class CompletionIndex {
+ public:
+  CompletionIndex();
+
+  void Add(CompletionEntry entry);
+  void ReplaceGroup(const std::string& group, std::vector<CompletionEntry> entries);
+  void RemoveGroup(const std::string& group);
+  bool HasGroup(const std::string& group) const;
+  void Clear();
+
+  std::size_t size() const { return live_; }
+
+  // Best matches first: score, then priority, then text.
+  std::vector<CompletionMatch> Search(const CompletionQuery& query) const;
+
+  static int Score(std::string_view key, std::string_view pattern, std::size_t length);
+
+ private:
+  static constexpr std::uint32_t kNone = 0xffffffffu;
+
+  struct Node {
+    std::uint32_t first_child = kNone;
+    std::uint32_t next_sibling = kNone;
+    std::uint32_t key = kNone;  // Key ending at this node
+    char c = 0;
+  };
+
+  struct Key {
+    std::string lower;
+    std::uint32_t first_entry = kNone;  // Chain through next_entry_
+    std::uint64_t chars = 0;  // CharMask(); rules keys out of the fuzzy scan
+  };
+
+  static std::uint64_t CharMask(std::string_view lower);
+
+  std::uint32_t FindNode(std::string_view lower) const;
+  std::uint32_t InternKey(const std::string& lower);
+  bool Accepts(const CompletionEntry& entry, const CompletionQuery& query,
+               const std::unordered_set<std::string_view>& column_groups) const;
+  void Compact();
+
+  std::vector<Node> nodes_;
+  std::vector<Key> keys_;
+  std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> trigrams_;  // -> key ids
+  std::vector<CompletionEntry> entries_;
+  std::vector<std::uint32_t> next_entry_;
+  std::vector<std::uint32_t> entry_key_;
+  std::vector<bool> alive_;
+  std::unordered_map<std::string, std::vector<std::uint32_t>> groups_;
+  std::size_t live_ = 0;
+  std::size_t dead_ = 0;
+};
+
+}  // namespace scratchrobin::core
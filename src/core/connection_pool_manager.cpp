@@ -10,74 +10,797 @@
 
 #include "core/connection_pool_manager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
 namespace scratchrobin::core {
 
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+// Slots live in fixed-size chunks that are never moved or freed while the
+// pool exists, so a slot index stays valid for lock-free readers.
+constexpr uint32_t kSlotsPerChunk = 64;
+constexpr uint32_t kMaxChunks = 1024;
+constexpr uint32_t kMaxSlots = kSlotsPerChunk * kMaxChunks;
+constexpr int kMaxWarmupThreads = 8;
+
+int64_t MicrosBetween(SteadyClock::time_point start, SteadyClock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+int64_t ToTicks(SteadyClock::time_point time) {
+  return time.time_since_epoch().count();
+}
+
+// Maps a steady-clock tick count recorded on the hot path to wall time.
+std::chrono::system_clock::time_point WallTimeOf(int64_t ticks) {
+  const auto age = SteadyClock::now() - SteadyClock::time_point(SteadyClock::duration(ticks));
+  return std::chrono::system_clock::now() -
+         std::chrono::duration_cast<std::chrono::system_clock::duration>(age);
+}
+
+// Lock-free counterpart of LatencyHistogram for the hot path.
+struct AtomicHistogram {
+  std::array<std::atomic<int64_t>, LatencyHistogram::kBucketCount> buckets{};
+  std::atomic<int64_t> count{0};
+  std::atomic<int64_t> total_us{0};
+  std::atomic<int64_t> max_us{0};
+
+  void Record(int64_t micros) {
+    micros = std::max<int64_t>(micros, 0);
+    buckets[LatencyHistogram::BucketFor(micros)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    total_us.fetch_add(micros, std::memory_order_relaxed);
+    int64_t seen = max_us.load(std::memory_order_relaxed);
+    while (micros > seen &&
+           !max_us.compare_exchange_weak(seen, micros, std::memory_order_relaxed)) {
+    }
+  }
+
+  LatencyHistogram Snapshot() const {
+    LatencyHistogram out;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+      out.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+    }
+    out.count = count.load(std::memory_order_relaxed);
+    out.total_us = total_us.load(std::memory_order_relaxed);
+    out.max_us = max_us.load(std::memory_order_relaxed);
+    return out;
+  }
+};
+
+// Accepts "host[:port]/database" or a bare database name on localhost.
+backend::ConnectionInfo ParseConnectionInfo(const PoolConfig& config) {
+  backend::ConnectionInfo info;
+  info.username = config.username;
+  info.password = config.password;
+  info.timeout_ms = config.connection_timeout_ms;
+  info.host = "localhost";
+
+  const std::string& spec = config.connection_string;
+  const auto slash = spec.find('/');
+  if (slash == std::string::npos) {
+    info.database = spec;
+    return info;
+  }
+  std::string host = spec.substr(0, slash);
+  info.database = spec.substr(slash + 1);
+  const auto colon = host.rfind(':');
+  if (colon != std::string::npos) {
+    try {
+      info.port = std::stoi(host.substr(colon + 1));
+    } catch (...) {
+      // Keep the default port
+    }
+    host.resize(colon);
+  }
+  if (!host.empty()) {
+    info.host = host;
+  }
+  return info;
+}
+
+std::shared_ptr<Connection> DefaultConnectionFactory(const PoolConfig& config,
+                                                     std::string* error) {
+  auto connection = std::make_shared<Connection>();
+  if (!connection->connect(ParseConnectionInfo(config))) {
+    if (error) {
+      *error = connection->lastError();
+    }
+    return nullptr;
+  }
+  return connection;
+}
+
+bool DefaultConnectionValidator(Connection& connection, const PoolConfig& config) {
+  if (!connection.isConnected()) {
+    return false;
+  }
+  if (config.test_query.empty()) {
+    return connection.ping();
+  }
+  return connection.query(config.test_query).success;
+}
+
+}  // namespace
+
+// ============================================================================
+// LatencyHistogram
+// ============================================================================
+
+std::size_t LatencyHistogram::BucketFor(int64_t micros) {
+  std::size_t bucket = 0;
+  while (bucket + 1 < kBucketCount && micros >= UpperBoundUs(bucket)) {
+    ++bucket;
+  }
+  return bucket;
+}
+
+int64_t LatencyHistogram::PercentileUs(double percentile) const {
+  if (count <= 0) {
+    return 0;
+  }
+  const double clamped = std::clamp(percentile, 0.0, 100.0);
+  const auto rank = std::max<int64_t>(
+      1, static_cast<int64_t>(clamped / 100.0 * static_cast<double>(count) + 0.5));
+  int64_t seen = 0;
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return i + 1 < kBucketCount ? UpperBoundUs(i) : max_us;
+    }
+  }
+  return max_us;
+}
+
+// ============================================================================
 // Private implementation structures
+// ============================================================================
+
+namespace {
+
+struct Slot {
+  std::atomic<uint32_t> next{0};  // Stack link: index + 1, 0 ends the stack
+  // Everything below belongs to whoever popped the slot off a stack
+  PooledConnection pooled;
+  SteadyClock::time_point created;
+  SteadyClock::time_point idle_since;
+  SteadyClock::time_point validated_at;
+  SteadyClock::time_point acquired;
+};
+
+struct Waiter {
+  enum class Outcome { kWaiting, kConnection, kCapacity, kClosed };
+  std::condition_variable cv;
+  Outcome outcome{Outcome::kWaiting};
+  uint32_t slot{0};
+};
+
+}  // namespace
+
 struct ConnectionPoolManager::Pool {
+  Pool(const PoolConfig& initial, uint64_t pool_serial)
+      : serial(pool_serial),
+        config(initial),
+        created_at(std::chrono::system_clock::now()) {
+    ApplyLimits(initial);
+    last_activity.store(ToTicks(SteadyClock::now()));
+  }
+
+  ~Pool() {
+    for (auto& chunk : chunks) {
+      delete[] chunk.load();
+    }
+  }
+
+  void ApplyLimits(const PoolConfig& cfg) {
+    max_connections.store(std::clamp(cfg.max_connections, 1, static_cast<int>(kMaxSlots)));
+    max_lifetime_seconds.store(cfg.max_lifetime_seconds);
+    acquire_timeout_ms.store(cfg.acquire_timeout_ms);
+    test_on_return.store(cfg.test_on_return);
+  }
+
+  PoolConfig Config() const {
+    std::lock_guard<std::mutex> lock(config_mutex);
+    return config;
+  }
+
+  Slot& At(uint32_t index) const {
+    return chunks[index / kSlotsPerChunk].load(std::memory_order_acquire)[index % kSlotsPerChunk];
+  }
+
+  // Treiber stack over slot indices. The head packs an ABA tag in the high
+  // 32 bits with index + 1 in the low 32 bits.
+  bool Pop(std::atomic<uint64_t>& head, uint32_t* index) const {
+    uint64_t current = head.load(std::memory_order_acquire);
+    for (;;) {
+      const auto top = static_cast<uint32_t>(current);
+      if (top == 0) {
+        return false;
+      }
+      const uint32_t next = At(top - 1).next.load(std::memory_order_relaxed);
+      const uint64_t desired = (((current >> 32) + 1) << 32) | next;
+      if (head.compare_exchange_weak(current, desired, std::memory_order_acq_rel,
+                                     std::memory_order_acquire)) {
+        *index = top - 1;
+        return true;
+      }
+    }
+  }
+
+  void Push(std::atomic<uint64_t>& head, uint32_t index) const {
+    Slot& slot = At(index);
+    uint64_t current = head.load(std::memory_order_relaxed);
+    uint64_t desired = 0;
+    do {
+      slot.next.store(static_cast<uint32_t>(current), std::memory_order_relaxed);
+      desired = (((current >> 32) + 1) << 32) | (index + 1);
+    } while (!head.compare_exchange_weak(current, desired, std::memory_order_release,
+                                         std::memory_order_relaxed));
+  }
+
+  bool PopIdle(uint32_t* index) {
+    if (!Pop(idle_head, index)) {
+      return false;
+    }
+    idle_count.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  void PushIdle(uint32_t index) {
+    idle_count.fetch_add(1, std::memory_order_relaxed);
+    Push(idle_head, index);
+  }
+
+  bool AllocateSlot(uint32_t* index) {
+    if (Pop(free_head, index)) {
+      return true;
+    }
+    std::lock_guard<std::mutex> lock(grow_mutex);
+    const uint32_t next = slot_count;
+    if (next >= kMaxSlots) {
+      return false;
+    }
+    auto& chunk = chunks[next / kSlotsPerChunk];
+    if (!chunk.load(std::memory_order_relaxed)) {
+      chunk.store(new Slot[kSlotsPerChunk], std::memory_order_release);
+    }
+    slot_count = next + 1;
+    *index = next;
+    return true;
+  }
+
+  // Claims room for one more connection if the pool is below max.
+  bool TryReserve() {
+    int total = total_count.load();
+    while (total < max_connections.load()) {
+      if (total_count.compare_exchange_weak(total, total + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Cheap checks only; the test query runs on the maintenance thread.
+  bool Usable(const Slot& slot, SteadyClock::time_point now) const {
+    const auto& connection = slot.pooled.connection;
+    if (!connection || !connection->isConnected() ||
+        slot.pooled.generation != generation.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    const int lifetime = max_lifetime_seconds.load(std::memory_order_relaxed);
+    return lifetime <= 0 || now - slot.created < std::chrono::seconds(lifetime);
+  }
+
+  const uint64_t serial;
+  mutable std::mutex config_mutex;
   PoolConfig config;
-  std::queue<PooledConnection> idle_connections;
-  std::atomic<int> active_count{0};
+
+  // Hot copies of config fields read without the config lock
+  std::atomic<int> max_connections{0};
+  std::atomic<int> max_lifetime_seconds{0};
+  std::atomic<int> acquire_timeout_ms{0};
+  std::atomic<bool> test_on_return{false};
+
+  std::atomic<bool> closed{false};
+  std::atomic<uint64_t> generation{1};
+  std::atomic<uint64_t> next_connection_number{0};
+
+  // Slot storage and the two stacks threaded through it
+  mutable std::array<std::atomic<Slot*>, kMaxChunks> chunks{};
+  std::mutex grow_mutex;
+  uint32_t slot_count{0};
+  std::atomic<uint64_t> idle_head{0};
+  std::atomic<uint64_t> free_head{0};
+
   std::atomic<int> total_count{0};
+  std::atomic<int> active_count{0};
+  std::atomic<int> idle_count{0};
+
+  // FIFO wait queue; |waiting| lets release skip the lock when empty
+  std::mutex wait_mutex;
+  std::deque<Waiter*> waiters;
+  std::atomic<int> waiting{0};
+
+  // Returned connections awaiting test_on_return validation
+  std::mutex pending_mutex;
+  std::vector<uint32_t> pending_validation;
+
+  // Serializes maintenance sweeps (background thread vs. HealthCheck)
+  std::mutex sweep_mutex;
+  SteadyClock::time_point next_sweep{};
+
+  std::atomic<int64_t> total_requests{0};
+  std::atomic<int64_t> failed_requests{0};
+  std::atomic<int64_t> timed_out_requests{0};
+  std::atomic<int64_t> connections_created{0};
+  std::atomic<int64_t> connections_evicted{0};
+  std::atomic<int64_t> validation_failures{0};
+  AtomicHistogram wait_time;
+  AtomicHistogram use_time;
+  const std::chrono::system_clock::time_point created_at;
+  std::atomic<int64_t> last_activity{0};  // Steady-clock ticks
 };
 
 struct ConnectionPoolManager::Impl {
-  std::map<std::string, std::unique_ptr<Pool>> pools;
-  mutable std::mutex mutex;
-  std::function<void(const std::string& pool_id,
-                     const std::string& connection_id,
-                     const std::string& event)> event_callback;
+  using PoolPtr = std::shared_ptr<Pool>;
+
+  Impl(ConnectionFactory connection_factory, ConnectionValidator connection_validator)
+      : factory(connection_factory ? std::move(connection_factory)
+                                   : ConnectionFactory(DefaultConnectionFactory)),
+        validator(connection_validator ? std::move(connection_validator)
+                                       : ConnectionValidator(DefaultConnectionValidator)) {}
+
+  PoolPtr Find(const std::string& pool_id) const {
+    std::shared_lock<std::shared_mutex> lock(pools_mutex);
+    auto it = pools.find(pool_id);
+    return it == pools.end() ? nullptr : it->second;
+  }
+
+  std::vector<PoolPtr> Snapshot() const {
+    std::shared_lock<std::shared_mutex> lock(pools_mutex);
+    std::vector<PoolPtr> out;
+    out.reserve(pools.size());
+    for (const auto& [id, pool] : pools) {
+      (void)id;
+      out.push_back(pool);
+    }
+    return out;
+  }
+
+  void Emit(const std::string& pool_id, const std::string& connection_id,
+            const char* event) {
+    if (!has_event_callback.load(std::memory_order_relaxed)) {
+      return;
+    }
+    std::shared_ptr<ConnectionEventCallback> callback;
+    {
+      std::lock_guard<std::mutex> lock(callback_mutex);
+      callback = event_callback;
+    }
+    if (callback && *callback) {
+      (*callback)(pool_id, connection_id, event);
+    }
+  }
+
+  // Hands a connection to the oldest waiter, or parks it on the idle stack.
+  void Return(Pool& pool, uint32_t index) {
+    if (pool.waiting.load() > 0 && HandOff(pool, index)) {
+      return;
+    }
+    pool.PushIdle(index);
+    // An acquirer may have queued between the check above and the push;
+    // it re-checks the stack after queueing, but take the connection back
+    // for it here too in case it is already asleep.
+    if (pool.waiting.load() > 0) {
+      std::lock_guard<std::mutex> lock(pool.wait_mutex);
+      uint32_t idle = 0;
+      if (!pool.waiters.empty() && pool.PopIdle(&idle)) {
+        Wake(pool, Waiter::Outcome::kConnection, idle);
+      }
+    }
+  }
+
+  bool HandOff(Pool& pool, uint32_t index) {
+    std::lock_guard<std::mutex> lock(pool.wait_mutex);
+    if (pool.waiters.empty()) {
+      return false;
+    }
+    Wake(pool, Waiter::Outcome::kConnection, index);
+    return true;
+  }
+
+  // Caller holds wait_mutex and has checked waiters is not empty.
+  static void Wake(Pool& pool, Waiter::Outcome outcome, uint32_t index) {
+    Waiter* waiter = pool.waiters.front();
+    pool.waiters.pop_front();
+    pool.waiting.fetch_sub(1);
+    waiter->outcome = outcome;
+    waiter->slot = index;
+    waiter->cv.notify_one();
+  }
+
+  // Lets the oldest waiter open a connection after one was closed.
+  void OfferCapacity(Pool& pool) {
+    if (pool.waiting.load() == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(pool.wait_mutex);
+    while (!pool.waiters.empty() && pool.TryReserve()) {
+      Wake(pool, Waiter::Outcome::kCapacity, 0);
+    }
+  }
+
+  // Opens a connection into a new slot. The caller has already reserved
+  // room with TryReserve(); the reservation is returned on failure.
+  bool Open(Pool& pool, uint32_t* index) {
+    const PoolConfig config = pool.Config();
+    std::shared_ptr<Connection> connection;
+    std::string error;
+    const int attempts = std::max(1, config.retry_attempts);
+    for (int attempt = 0; attempt < attempts && !pool.closed.load(); ++attempt) {
+      if (attempt > 0 && config.retry_delay_ms > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.retry_delay_ms));
+      }
+      connection = factory(config, &error);
+      if (connection) {
+        break;
+      }
+    }
+    if (!connection || !pool.AllocateSlot(index)) {
+      if (connection) {
+        connection->disconnect();
+      }
+      pool.total_count.fetch_sub(1);
+      Emit(config.pool_id, "", "connect_failed");
+      OfferCapacity(pool);
+      return false;
+    }
+
+    const auto now = SteadyClock::now();
+    Slot& slot = pool.At(*index);
+    slot.pooled = PooledConnection{};
+    slot.pooled.pool_id = config.pool_id;
+    slot.pooled.connection_id =
+        config.pool_id + "_" + std::to_string(pool.next_connection_number.fetch_add(1) + 1);
+    slot.pooled.connection = std::move(connection);
+    slot.pooled.created_at = std::chrono::system_clock::now();
+    slot.pooled.slot = *index;
+    slot.pooled.pool_serial = pool.serial;
+    slot.pooled.generation = pool.generation.load();
+    slot.created = now;
+    slot.idle_since = now;
+    slot.validated_at = now;
+    pool.connections_created.fetch_add(1, std::memory_order_relaxed);
+    Emit(slot.pooled.pool_id, slot.pooled.connection_id, "created");
+    return true;
+  }
+
+  // Closes a connection that is out of every stack and frees its slot.
+  void Close(Pool& pool, PooledConnection& pooled, const char* event) {
+    auto connection = std::move(pooled.connection);
+    const std::string pool_id = std::move(pooled.pool_id);
+    const std::string connection_id = std::move(pooled.connection_id);
+    const uint32_t index = pooled.slot;
+    pooled = PooledConnection{};
+    pool.Push(pool.free_head, index);
+    pool.total_count.fetch_sub(1);
+    if (connection) {
+      connection->disconnect();
+    }
+    Emit(pool_id, connection_id, event);
+    OfferCapacity(pool);
+  }
+
+  void CloseSlot(Pool& pool, uint32_t index, const char* event) {
+    PooledConnection pooled = std::move(pool.At(index).pooled);
+    pooled.slot = index;
+    Close(pool, pooled, event);
+  }
+
+  // |now| may equal |start| on the fast path to spare a clock read.
+  PooledConnection CheckOut(Pool& pool, uint32_t index, SteadyClock::time_point start,
+                            SteadyClock::time_point now) {
+    Slot& slot = pool.At(index);
+    slot.acquired = now;
+    PooledConnection pooled = std::move(slot.pooled);
+    pooled.acquired_at = std::chrono::system_clock::now();
+    pool.active_count.fetch_add(1, std::memory_order_relaxed);
+    pool.wait_time.Record(MicrosBetween(start, now));
+    pool.last_activity.store(ToTicks(now), std::memory_order_relaxed);
+    Emit(pooled.pool_id, pooled.connection_id, "acquired");
+    return pooled;
+  }
+
+  // Opens |count| connections on up to kMaxWarmupThreads threads and parks
+  // them on the idle stack.
+  void WarmUp(Pool& pool, int count) {
+    int reserved = 0;
+    while (reserved < count && pool.TryReserve()) {
+      ++reserved;
+    }
+    if (reserved == 0) {
+      return;
+    }
+    std::atomic<int> remaining{reserved};
+    auto worker = [this, &pool, &remaining] {
+      while (remaining.fetch_sub(1) > 0) {
+        uint32_t index = 0;
+        if (Open(pool, &index)) {
+          Return(pool, index);
+        }
+      }
+    };
+    const int thread_count = std::min(reserved, kMaxWarmupThreads);
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<std::size_t>(thread_count - 1));
+    for (int i = 1; i < thread_count; ++i) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  void TopUp(Pool& pool) {
+    if (pool.closed.load()) {
+      return;
+    }
+    const int min_connections = pool.Config().min_connections;
+    const int missing = min_connections - pool.total_count.load();
+    if (missing > 0) {
+      WarmUp(pool, missing);
+    }
+  }
+
+  bool Validate(Pool& pool, Slot& slot, const PoolConfig& config) {
+    if (!slot.pooled.connection || !validator(*slot.pooled.connection, config)) {
+      pool.validation_failures.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    slot.validated_at = SteadyClock::now();
+    return true;
+  }
+
+  void ValidateReturned(Pool& pool) {
+    std::vector<uint32_t> pending;
+    {
+      std::lock_guard<std::mutex> lock(pool.pending_mutex);
+      pending.swap(pool.pending_validation);
+    }
+    if (pending.empty()) {
+      return;
+    }
+    const PoolConfig config = pool.Config();
+    for (uint32_t index : pending) {
+      if (Validate(pool, pool.At(index), config)) {
+        Return(pool, index);
+      } else {
+        CloseSlot(pool, index, "validation_failed");
+      }
+    }
+  }
+
+  // One maintenance pass: evict expired and long-idle connections, run the
+  // test query on connections idle past idle_check_interval_seconds, and
+  // top the pool back up to min_connections.
+  void Sweep(Pool& pool, bool force) {
+    std::lock_guard<std::mutex> sweep_lock(pool.sweep_mutex);
+    if (pool.closed.load()) {
+      return;
+    }
+    ValidateReturned(pool);
+
+    const auto now = SteadyClock::now();
+    if (!force && now < pool.next_sweep) {
+      return;
+    }
+    const PoolConfig config = pool.Config();
+    const auto check_interval = std::chrono::seconds(std::max(0, config.idle_check_interval_seconds));
+    pool.next_sweep = now + check_interval;
+
+    // Take the whole idle stack at once; acquirers that miss it meanwhile
+    // open a connection or queue, exactly as when the pool is busy.
+    std::vector<uint32_t> taken;
+    uint32_t index = 0;
+    while (pool.PopIdle(&index)) {
+      taken.push_back(index);
+    }
+
+    std::vector<uint32_t> keep;
+    std::vector<uint32_t> to_validate;
+    for (uint32_t idle : taken) {
+      Slot& slot = pool.At(idle);
+      if (!pool.Usable(slot, now)) {
+        pool.connections_evicted.fetch_add(1, std::memory_order_relaxed);
+        CloseSlot(pool, idle, "expired");
+      } else if ((config.max_idle_time_seconds > 0 &&
+                  now - slot.idle_since >= std::chrono::seconds(config.max_idle_time_seconds) &&
+                  pool.total_count.load() > config.min_connections) ||
+                 pool.total_count.load() > pool.max_connections.load()) {
+        pool.connections_evicted.fetch_add(1, std::memory_order_relaxed);
+        CloseSlot(pool, idle, "idle_timeout");
+      } else if (config.test_on_borrow && now - slot.validated_at >= check_interval) {
+        to_validate.push_back(idle);
+      } else {
+        keep.push_back(idle);
+      }
+    }
+    // Push back bottom-first so the most recently used stay on top
+    for (auto it = keep.rbegin(); it != keep.rend(); ++it) {
+      Return(pool, *it);
+    }
+    for (uint32_t idle : to_validate) {
+      if (Validate(pool, pool.At(idle), config)) {
+        Return(pool, idle);
+      } else {
+        CloseSlot(pool, idle, "validation_failed");
+      }
+    }
+    TopUp(pool);
+  }
+
+  void PurgeIdle(Pool& pool, const char* event) {
+    uint32_t index = 0;
+    while (pool.PopIdle(&index)) {
+      CloseSlot(pool, index, event);
+    }
+  }
+
+  // Detached pools: wake waiters, close idle and pending connections.
+  // Checked-out connections are closed when they are released.
+  void Shutdown(Pool& pool) {
+    pool.closed.store(true);
+    pool.generation.fetch_add(1);
+    {
+      std::lock_guard<std::mutex> lock(pool.wait_mutex);
+      while (!pool.waiters.empty()) {
+        Wake(pool, Waiter::Outcome::kClosed, 0);
+      }
+    }
+    std::lock_guard<std::mutex> sweep_lock(pool.sweep_mutex);
+    std::vector<uint32_t> pending;
+    {
+      std::lock_guard<std::mutex> lock(pool.pending_mutex);
+      pending.swap(pool.pending_validation);
+    }
+    for (uint32_t index : pending) {
+      CloseSlot(pool, index, "closed");
+    }
+    PurgeIdle(pool, "closed");
+  }
+
+  void MaintenanceLoop() {
+    std::unique_lock<std::mutex> lock(maintenance_mutex);
+    while (!stopping) {
+      maintenance_cv.wait_for(lock, std::chrono::milliseconds(maintenance_interval_ms.load()),
+                              [this] { return stopping || maintenance_requested; });
+      if (stopping) {
+        break;
+      }
+      maintenance_requested = false;
+      lock.unlock();
+      for (const auto& pool : Snapshot()) {
+        Sweep(*pool, false);
+      }
+      lock.lock();
+    }
+  }
+
+  void RequestMaintenance() {
+    {
+      std::lock_guard<std::mutex> lock(maintenance_mutex);
+      maintenance_requested = true;
+    }
+    maintenance_cv.notify_one();
+  }
+
+  const ConnectionFactory factory;
+  const ConnectionValidator validator;
+
+  mutable std::shared_mutex pools_mutex;
+  std::map<std::string, PoolPtr> pools;
+  std::atomic<uint64_t> next_pool_serial{0};
+
+  std::mutex callback_mutex;
+  std::shared_ptr<ConnectionEventCallback> event_callback;
+  std::atomic<bool> has_event_callback{false};
+
+  std::mutex maintenance_mutex;
+  std::condition_variable maintenance_cv;
+  bool stopping{false};
+  bool maintenance_requested{false};
+  std::atomic<int> maintenance_interval_ms{1000};
+  std::thread maintenance_thread;
 };
 
+// ============================================================================
+// ConnectionPoolManager
+// ============================================================================
+
 ConnectionPoolManager::ConnectionPoolManager()
-    : impl_(std::make_unique<Impl>()) {
+    : ConnectionPoolManager(nullptr, nullptr) {
 }
 
-ConnectionPoolManager::~ConnectionPoolManager() = default;
+ConnectionPoolManager::ConnectionPoolManager(ConnectionFactory factory,
+                                             ConnectionValidator validator)
+    : impl_(std::make_unique<Impl>(std::move(factory), std::move(validator))) {
+  impl_->maintenance_thread = std::thread([this] { impl_->MaintenanceLoop(); });
+}
+
+ConnectionPoolManager::~ConnectionPoolManager() {
+  {
+    std::lock_guard<std::mutex> lock(impl_->maintenance_mutex);
+    impl_->stopping = true;
+  }
+  impl_->maintenance_cv.notify_all();
+  if (impl_->maintenance_thread.joinable()) {
+    impl_->maintenance_thread.join();
+  }
+  EmergencyShutdownAll();
+}
 
 Status ConnectionPoolManager::CreatePool(const PoolConfig& config) {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  if (impl_->pools.find(config.pool_id) != impl_->pools.end()) {
-    return Status::Error("Pool already exists: " + config.pool_id);
-  }
-  
-  auto pool = std::make_unique<Pool>();
-  pool->config = config;
-  
-  impl_->pools[config.pool_id] = std::move(pool);
-  
-  if (impl_->event_callback) {
-    impl_->event_callback(config.pool_id, "", "created");
-  }
-  
+  if (config.min_connections < 0 || config.max_connections < 1 ||
+      config.min_connections > config.max_connections ||
+      config.max_connections > static_cast<int>(kMaxSlots)) {
+    return Status::Error("Invalid pool size for: " + config.pool_id);
+  }
+
+  std::shared_ptr<Pool> pool;
+  {
+    std::unique_lock<std::shared_mutex> lock(impl_->pools_mutex);
+    if (impl_->pools.find(config.pool_id) != impl_->pools.end()) {
+      return Status::Error("Pool already exists: " + config.pool_id);
+    }
+    pool = std::make_shared<Pool>(config, impl_->next_pool_serial.fetch_add(1) + 1);
+    impl_->pools[config.pool_id] = pool;
+  }
+
+  impl_->Emit(config.pool_id, "", "created");
+  {
+    std::lock_guard<std::mutex> sweep_lock(pool->sweep_mutex);
+    pool->next_sweep =
+        SteadyClock::now() + std::chrono::seconds(std::max(0, config.idle_check_interval_seconds));
+    impl_->WarmUp(*pool, config.min_connections);
+  }
+
   return Status::Ok();
 }
 
 Status ConnectionPoolManager::DestroyPool(const std::string& pool_id) {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto it = impl_->pools.find(pool_id);
-  if (it == impl_->pools.end()) {
-    return Status::Error("Pool not found: " + pool_id);
-  }
-  
-  impl_->pools.erase(it);
-  
-  if (impl_->event_callback) {
-    impl_->event_callback(pool_id, "", "destroyed");
+  std::shared_ptr<Pool> pool;
+  {
+    std::unique_lock<std::shared_mutex> lock(impl_->pools_mutex);
+    auto it = impl_->pools.find(pool_id);
+    if (it == impl_->pools.end()) {
+      return Status::Error("Pool not found: " + pool_id);
+    }
+    pool = std::move(it->second);
+    impl_->pools.erase(it);
   }
-  
+
+  impl_->Shutdown(*pool);
+  impl_->Emit(pool_id, "", "destroyed");
+
   return Status::Ok();
 }
 
 bool ConnectionPoolManager::PoolExists(const std::string& pool_id) const {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  return impl_->pools.find(pool_id) != impl_->pools.end();
+  return impl_->Find(pool_id) != nullptr;
 }
 
 std::vector<std::string> ConnectionPoolManager::ListPools() const {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
+  std::shared_lock<std::shared_mutex> lock(impl_->pools_mutex);
+
   std::vector<std::string> result;
   for (const auto& [id, pool] : impl_->pools) {
     (void)pool;
@@ -93,198 +816,307 @@ std::optional<PooledConnection> ConnectionPoolManager::AcquireConnection(
 
 std::optional<PooledConnection> ConnectionPoolManager::AcquireConnection(
     const std::string& pool_id, int timeout_ms) {
-  (void)timeout_ms;
-  
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto it = impl_->pools.find(pool_id);
-  if (it == impl_->pools.end()) {
+  const auto start = SteadyClock::now();
+  auto pool = impl_->Find(pool_id);
+  if (!pool) {
     return std::nullopt;
   }
-  
-  auto& pool = it->second;
-  
-  if (!pool->idle_connections.empty()) {
-    PooledConnection conn = std::move(pool->idle_connections.front());
-    pool->idle_connections.pop();
-    ++pool->active_count;
-    conn.acquired_at = std::chrono::system_clock::now();
-    
-    if (impl_->event_callback) {
-      impl_->event_callback(pool_id, conn.connection_id, "acquired");
-    }
-    
-    return conn;
-  }
-  
-  if (pool->total_count < pool->config.max_connections) {
-    PooledConnection conn;
-    conn.pool_id = pool_id;
-    conn.connection_id = pool_id + "_" + std::to_string(++pool->total_count);
-    conn.acquired_at = std::chrono::system_clock::now();
-    conn.created_at = std::chrono::system_clock::now();
-    ++pool->active_count;
-    
-    if (impl_->event_callback) {
-      impl_->event_callback(pool_id, conn.connection_id, "created");
-    }
-    
-    return conn;
-  }
-  
+  pool->total_requests.fetch_add(1, std::memory_order_relaxed);
+  if (timeout_ms < 0) {
+    timeout_ms = pool->acquire_timeout_ms.load(std::memory_order_relaxed);
+  }
+  const bool wait_forever = timeout_ms < 0;
+  const auto deadline = start + std::chrono::milliseconds(std::max(0, timeout_ms));
+
+  for (;;) {
+    if (pool->closed.load(std::memory_order_relaxed)) {
+      break;
+    }
+
+    // Fast path: pop an idle connection
+    uint32_t index = 0;
+    bool reserved = false;
+    bool fast = true;
+    if (!pool->PopIdle(&index)) {
+      fast = false;
+      reserved = pool->TryReserve();
+      if (!reserved) {
+        // Queue behind earlier waiters. Re-check the stack and the capacity
+        // after queueing: a release or close that ran before we were
+        // visible in |waiting| will not have looked for us.
+        std::unique_lock<std::mutex> lock(pool->wait_mutex);
+        Waiter waiter;
+        pool->waiters.push_back(&waiter);
+        pool->waiting.fetch_add(1);
+        auto leave_queue = [&] {
+          auto it = std::find(pool->waiters.begin(), pool->waiters.end(), &waiter);
+          if (it != pool->waiters.end()) {
+            pool->waiters.erase(it);
+            pool->waiting.fetch_sub(1);
+          }
+        };
+
+        if (pool->PopIdle(&index)) {
+          leave_queue();
+          waiter.outcome = Waiter::Outcome::kConnection;
+          waiter.slot = index;
+        } else if (pool->TryReserve()) {
+          leave_queue();
+          waiter.outcome = Waiter::Outcome::kCapacity;
+        } else {
+          auto ready = [&waiter] { return waiter.outcome != Waiter::Outcome::kWaiting; };
+          if (wait_forever) {
+            waiter.cv.wait(lock, ready);
+          } else if (!waiter.cv.wait_until(lock, deadline, ready)) {
+            leave_queue();
+            lock.unlock();
+            pool->timed_out_requests.fetch_add(1, std::memory_order_relaxed);
+            break;
+          }
+        }
+        if (waiter.outcome == Waiter::Outcome::kClosed) {
+          break;
+        }
+        reserved = waiter.outcome == Waiter::Outcome::kCapacity;
+        index = waiter.slot;
+      }
+    }
+
+    if (reserved) {
+      if (impl_->Open(*pool, &index)) {
+        return impl_->CheckOut(*pool, index, start, SteadyClock::now());
+      }
+      break;
+    }
+    const auto now = fast ? start : SteadyClock::now();
+    if (pool->Usable(pool->At(index), now)) {
+      return impl_->CheckOut(*pool, index, start, now);
+    }
+    pool->connections_evicted.fetch_add(1, std::memory_order_relaxed);
+    impl_->CloseSlot(*pool, index, "expired");
+  }
+
+  pool->failed_requests.fetch_add(1, std::memory_order_relaxed);
   return std::nullopt;
 }
 
 Status ConnectionPoolManager::ReleaseConnection(PooledConnection& pooled_conn) {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto it = impl_->pools.find(pooled_conn.pool_id);
-  if (it == impl_->pools.end()) {
-    return Status::Error("Pool not found: " + pooled_conn.pool_id);
-  }
-  
-  auto& pool = it->second;
-  --pool->active_count;
+  auto pool = impl_->Find(pooled_conn.pool_id);
+  if (!pool || pooled_conn.pool_serial != pool->serial) {
+    // The pool was destroyed (or recreated) while this was checked out
+    if (pooled_conn.connection) {
+      pooled_conn.connection->disconnect();
+    }
+    std::string pool_id = pooled_conn.pool_id;
+    pooled_conn = PooledConnection{};
+    return Status::Error("Pool not found: " + pool_id);
+  }
+
+  const auto now = SteadyClock::now();
+  const uint32_t index = pooled_conn.slot;
+  Slot& slot = pool->At(index);
+  pool->use_time.Record(MicrosBetween(slot.acquired, now));
+  pool->last_activity.store(ToTicks(now), std::memory_order_relaxed);
+  pool->active_count.fetch_sub(1, std::memory_order_relaxed);
   ++pooled_conn.use_count;
-  
-  pooled_conn.connection.reset();
-  pool->idle_connections.push(std::move(pooled_conn));
-  
-  if (impl_->event_callback) {
-    impl_->event_callback(pooled_conn.pool_id, pooled_conn.connection_id, "released");
-  }
-  
+  impl_->Emit(pooled_conn.pool_id, pooled_conn.connection_id, "released");
+
+  slot.pooled = std::move(pooled_conn);
+  pooled_conn = PooledConnection{};
+
+  if (!pool->Usable(slot, now) ||
+      pool->total_count.load() > pool->max_connections.load()) {
+    impl_->CloseSlot(*pool, index, "retired");
+    return Status::Ok();
+  }
+  slot.idle_since = now;
+  if (pool->test_on_return.load(std::memory_order_relaxed)) {
+    {
+      std::lock_guard<std::mutex> lock(pool->pending_mutex);
+      pool->pending_validation.push_back(index);
+    }
+    impl_->RequestMaintenance();
+    return Status::Ok();
+  }
+  // A connection that just served a request is known to work
+  slot.validated_at = now;
+  impl_->Return(*pool, index);
   return Status::Ok();
 }
 
 Status ConnectionPoolManager::InvalidateConnection(PooledConnection& pooled_conn) {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto it = impl_->pools.find(pooled_conn.pool_id);
-  if (it == impl_->pools.end()) {
-    return Status::Error("Pool not found: " + pooled_conn.pool_id);
-  }
-  
-  auto& pool = it->second;
-  --pool->active_count;
-  --pool->total_count;
-  
-  if (impl_->event_callback) {
-    impl_->event_callback(pooled_conn.pool_id, pooled_conn.connection_id, "invalidated");
-  }
-  
+  auto pool = impl_->Find(pooled_conn.pool_id);
+  if (!pool || pooled_conn.pool_serial != pool->serial) {
+    if (pooled_conn.connection) {
+      pooled_conn.connection->disconnect();
+    }
+    std::string pool_id = pooled_conn.pool_id;
+    pooled_conn = PooledConnection{};
+    return Status::Error("Pool not found: " + pool_id);
+  }
+
+  pool->active_count.fetch_sub(1, std::memory_order_relaxed);
+  impl_->Close(*pool, pooled_conn, "invalidated");
+
   return Status::Ok();
 }
 
 Status ConnectionPoolManager::UpdatePoolConfig(const std::string& pool_id,
                                                const PoolConfig& config) {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto it = impl_->pools.find(pool_id);
-  if (it == impl_->pools.end()) {
+  if (config.min_connections < 0 || config.max_connections < 1 ||
+      config.min_connections > config.max_connections ||
+      config.max_connections > static_cast<int>(kMaxSlots)) {
+    return Status::Error("Invalid pool size for: " + pool_id);
+  }
+  auto pool = impl_->Find(pool_id);
+  if (!pool) {
     return Status::Error("Pool not found: " + pool_id);
   }
-  
-  it->second->config = config;
+
+  {
+    std::lock_guard<std::mutex> lock(pool->config_mutex);
+    pool->config = config;
+    pool->config.pool_id = pool_id;
+    pool->ApplyLimits(pool->config);
+  }
+  // A larger max may unblock waiters; a smaller one is applied as
+  // connections are released and by an immediate sweep.
+  impl_->OfferCapacity(*pool);
+  {
+    std::lock_guard<std::mutex> sweep_lock(pool->sweep_mutex);
+    pool->next_sweep = SteadyClock::time_point{};
+  }
+  impl_->RequestMaintenance();
   return Status::Ok();
 }
 
 std::optional<PoolConfig> ConnectionPoolManager::GetPoolConfig(
     const std::string& pool_id) const {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto it = impl_->pools.find(pool_id);
-  if (it == impl_->pools.end()) {
+  auto pool = impl_->Find(pool_id);
+  if (!pool) {
     return std::nullopt;
   }
-  
-  return it->second->config;
+  return pool->Config();
 }
 
 ConnectionStats ConnectionPoolManager::GetStats(const std::string& pool_id) const {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto it = impl_->pools.find(pool_id);
-  if (it == impl_->pools.end()) {
+  auto pool = impl_->Find(pool_id);
+  if (!pool) {
     return ConnectionStats{};
   }
-  
-  const auto& pool = it->second;
+
   ConnectionStats stats;
   stats.pool_id = pool_id;
   stats.total_connections = pool->total_count.load();
   stats.active_connections = pool->active_count.load();
-  stats.idle_connections = static_cast<int>(pool->idle_connections.size());
-  
+  stats.idle_connections = pool->idle_count.load();
+  stats.waiting_requests = pool->waiting.load();
+  stats.total_requests = pool->total_requests.load();
+  stats.failed_requests = pool->failed_requests.load();
+  stats.timed_out_requests = pool->timed_out_requests.load();
+  stats.connections_created = pool->connections_created.load();
+  stats.connections_evicted = pool->connections_evicted.load();
+  stats.validation_failures = pool->validation_failures.load();
+  stats.wait_time_histogram = pool->wait_time.Snapshot();
+  stats.use_time_histogram = pool->use_time.Snapshot();
+  stats.average_wait_time_ms = stats.wait_time_histogram.AverageUs() / 1000;
+  stats.average_use_time_ms = stats.use_time_histogram.AverageUs() / 1000;
+  stats.created_at = pool->created_at;
+  stats.last_activity = WallTimeOf(pool->last_activity.load());
+
   return stats;
 }
 
 std::map<std::string, ConnectionStats> ConnectionPoolManager::GetAllStats() const {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
   std::map<std::string, ConnectionStats> result;
-  for (const auto& [id, pool] : impl_->pools) {
-    ConnectionStats stats;
-    stats.pool_id = id;
-    stats.total_connections = pool->total_count.load();
-    stats.active_connections = pool->active_count.load();
-    stats.idle_connections = static_cast<int>(pool->idle_connections.size());
-    result[id] = stats;
+  for (const auto& id : ListPools()) {
+    result[id] = GetStats(id);
   }
   return result;
 }
 
 ValidationResult ConnectionPoolManager::ValidateConnection(
     const PooledConnection& pooled_conn) {
-  (void)pooled_conn;
   ValidationResult result;
-  result.valid = true;
+  if (!pooled_conn.connection) {
+    result.error_message = "No connection";
+    return result;
+  }
+  auto pool = impl_->Find(pooled_conn.pool_id);
+  const PoolConfig config = pool ? pool->Config() : PoolConfig{};
+
+  const auto start = SteadyClock::now();
+  result.valid = impl_->validator(*pooled_conn.connection, config);
+  result.response_time_ms = static_cast<int>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(SteadyClock::now() - start).count());
+  if (!result.valid) {
+    result.error_message = pooled_conn.connection->lastError();
+    if (result.error_message.empty()) {
+      result.error_message = "Connection validation failed";
+    }
+  }
   return result;
 }
 
 Status ConnectionPoolManager::HealthCheck(const std::string& pool_id) {
-  (void)pool_id;
+  auto pool = impl_->Find(pool_id);
+  if (!pool) {
+    return Status::Error("Pool not found: " + pool_id);
+  }
+
+  impl_->Sweep(*pool, true);
+  if (pool->total_count.load() < pool->Config().min_connections) {
+    return Status::Error("Pool below minimum size: " + pool_id);
+  }
   return Status::Ok();
 }
 
 Status ConnectionPoolManager::HealthCheckAll() {
-  return Status::Ok();
+  Status result = Status::Ok();
+  for (const auto& id : ListPools()) {
+    Status status = HealthCheck(id);
+    if (!status.ok && result.ok) {
+      result = status;
+    }
+  }
+  return result;
 }
 
 Status ConnectionPoolManager::ResizePool(const std::string& pool_id,
                                          int new_min, int new_max) {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto it = impl_->pools.find(pool_id);
-  if (it == impl_->pools.end()) {
+  auto config = GetPoolConfig(pool_id);
+  if (!config) {
     return Status::Error("Pool not found: " + pool_id);
   }
-  
-  it->second->config.min_connections = new_min;
-  it->second->config.max_connections = new_max;
-  
-  return Status::Ok();
+
+  config->min_connections = new_min;
+  config->max_connections = new_max;
+
+  return UpdatePoolConfig(pool_id, *config);
 }
 
 Status ConnectionPoolManager::PurgeIdleConnections(const std::string& pool_id) {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto it = impl_->pools.find(pool_id);
-  if (it == impl_->pools.end()) {
+  auto pool = impl_->Find(pool_id);
+  if (!pool) {
     return Status::Error("Pool not found: " + pool_id);
   }
-  
-  auto& pool = it->second;
-  while (!pool->idle_connections.empty()) {
-    pool->idle_connections.pop();
-    --pool->total_count;
-  }
-  
+
+  impl_->PurgeIdle(*pool, "purged");
+
   return Status::Ok();
 }
 
 Status ConnectionPoolManager::RefreshAllConnections(const std::string& pool_id) {
-  (void)pool_id;
+  auto pool = impl_->Find(pool_id);
+  if (!pool) {
+    return Status::Error("Pool not found: " + pool_id);
+  }
+
+  // Connections checked out now are retired when they come back
+  pool->generation.fetch_add(1);
+  impl_->PurgeIdle(*pool, "refreshed");
+  impl_->TopUp(*pool);
+
   return Status::Ok();
 }
 
@@ -293,8 +1125,15 @@ Status ConnectionPoolManager::EmergencyShutdown(const std::string& pool_id) {
 }
 
 Status ConnectionPoolManager::EmergencyShutdownAll() {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  impl_->pools.clear();
+  std::map<std::string, std::shared_ptr<Pool>> pools;
+  {
+    std::unique_lock<std::shared_mutex> lock(impl_->pools_mutex);
+    pools.swap(impl_->pools);
+  }
+  for (const auto& [id, pool] : pools) {
+    impl_->Shutdown(*pool);
+    impl_->Emit(id, "", "destroyed");
+  }
   return Status::Ok();
 }
 
@@ -303,17 +1142,24 @@ Status ConnectionPoolManager::RestartPool(const std::string& pool_id) {
   if (!config) {
     return Status::Error("Pool not found: " + pool_id);
   }
-  
+
   Status status = DestroyPool(pool_id);
   if (!status.ok) {
     return status;
   }
-  
+
   return CreatePool(*config);
 }
 
 void ConnectionPoolManager::SetEventCallback(ConnectionEventCallback callback) {
-  impl_->event_callback = callback;
+  std::lock_guard<std::mutex> lock(impl_->callback_mutex);
+  impl_->has_event_callback.store(static_cast<bool>(callback));
+  impl_->event_callback = std::make_shared<ConnectionEventCallback>(std::move(callback));
+}
+
+void ConnectionPoolManager::SetMaintenanceInterval(int interval_ms) {
+  impl_->maintenance_interval_ms.store(std::max(1, interval_ms));
+  impl_->RequestMaintenance();
 }
 
 }  // namespace scratchrobin::core
@@ -10,25 +10,24 @@
 
 #pragma once
 
-#include <atomic>
+#include <array>
 #include <chrono>
-#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
-#include <mutex>
 #include <optional>
-#include <queue>
 #include <string>
-#include <thread>
 #include <vector>
 
+#include "backend/scratchbird_connection.h"
 #include "core/status.h"
 
 namespace scratchrobin::core {
 
-// Forward declarations
-class Connection;
+// Pooled connections are backend connections (same alias as the executor)
+using Connection = backend::ScratchbirdConnection;
 
 // Connection pool configuration
 struct PoolConfig {
@@ -42,6 +41,10 @@ struct PoolConfig {
   int max_lifetime_seconds{3600};
   int connection_timeout_ms{30000};
   int acquire_timeout_ms{10000};
+  // Validation runs on the maintenance thread, never on the acquiring thread:
+  // with test_on_borrow, idle connections are re-checked with test_query
+  // once they have been idle for idle_check_interval_seconds; with
+  // test_on_return, returned connections are checked before reuse.
   bool test_on_borrow{true};
   bool test_on_return{false};
   std::string test_query{"SELECT 1"};
@@ -50,6 +53,23 @@ struct PoolConfig {
   int retry_delay_ms{1000};
 };
 
+// Log2-bucketed latency histogram in microseconds. Bucket i counts samples
+// below 2^i us (bucket 0: under 1 us); the last bucket is unbounded.
+struct LatencyHistogram {
+  static constexpr std::size_t kBucketCount = 26;  // Last bound ~33 s
+
+  std::array<int64_t, kBucketCount> buckets{};
+  int64_t count{0};
+  int64_t total_us{0};
+  int64_t max_us{0};
+
+  static std::size_t BucketFor(int64_t micros);
+  static int64_t UpperBoundUs(std::size_t bucket) { return int64_t{1} << bucket; }
+  // Upper bound of the bucket holding the given percentile (0-100)
+  int64_t PercentileUs(double percentile) const;
+  int64_t AverageUs() const { return count > 0 ? total_us / count : 0; }
+};
+
 // Connection statistics
 struct ConnectionStats {
   std::string pool_id;
@@ -61,6 +81,12 @@ struct ConnectionStats {
   int64_t failed_requests{0};
   int64_t average_wait_time_ms{0};
   int64_t average_use_time_ms{0};
+  int64_t timed_out_requests{0};
+  int64_t connections_created{0};
+  int64_t connections_evicted{0};
+  int64_t validation_failures{0};
+  LatencyHistogram wait_time_histogram;  // Acquire call to connection handed out
+  LatencyHistogram use_time_histogram;   // Acquire to release
   std::chrono::system_clock::time_point created_at;
   std::chrono::system_clock::time_point last_activity;
 };
@@ -73,6 +99,10 @@ struct PooledConnection {
   std::chrono::system_clock::time_point acquired_at;
   std::chrono::system_clock::time_point created_at;
   int use_count{0};
+  // Pool-internal bookkeeping; leave untouched between acquire and release
+  uint32_t slot{0};
+  uint64_t pool_serial{0};
+  uint64_t generation{0};
 };
 
 // Connection validation result
@@ -86,9 +116,29 @@ struct ValidationResult {
 // ConnectionPoolManager
 // ============================================================================
 
+/**
+ * Connection pools keyed by pool id.
+ *
+ * Each pool keeps its idle connections on a lock-free stack, so acquiring
+ * and releasing an idle connection is a single compare-and-swap with no
+ * locks or allocations. Only when the stack is empty does an acquirer open
+ * a new connection (below max_connections) or join the pool's FIFO wait
+ * queue; released connections are handed directly to the oldest waiter.
+ * A single maintenance thread validates idle connections, evicts idle and
+ * expired ones and tops pools back up to min_connections. CreatePool()
+ * opens the first min_connections in parallel before returning.
+ */
 class ConnectionPoolManager {
  public:
+  // Opens a connection for a pool; returns null and fills |error| on failure
+  using ConnectionFactory = std::function<std::shared_ptr<Connection>(
+      const PoolConfig& config, std::string* error)>;
+  // Checks a connection is usable; the default runs config.test_query
+  using ConnectionValidator =
+      std::function<bool(Connection& connection, const PoolConfig& config)>;
+
   ConnectionPoolManager();
+  ConnectionPoolManager(ConnectionFactory factory, ConnectionValidator validator);
   ~ConnectionPoolManager();
 
   // Disable copy
@@ -138,6 +188,10 @@ class ConnectionPoolManager {
                          const std::string& event)>;
   void SetEventCallback(ConnectionEventCallback callback);
 
+  // How often the maintenance thread wakes up (default 1000 ms); each pool
+  // is still only swept every idle_check_interval_seconds.
+  void SetMaintenanceInterval(int interval_ms);
+
  private:
   struct Pool;
   struct Impl;
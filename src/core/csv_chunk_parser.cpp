@@ -0,0 +1,438 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/csv_chunk_parser.h"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SCRATCHROBIN_HAVE_MMAP 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SCRATCHROBIN_HAVE_SSE2 1
+#endif
+
+namespace scratchrobin::core {
+
+// ============================================================================
+// MappedFile
+// ============================================================================
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+Status MappedFile::Open(const std::string& path) {
+  Close();
+#if SCRATCHROBIN_HAVE_MMAP
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return Status::Error("Cannot open file: " + path);
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    return Status::Error("Cannot stat file: " + path);
+  }
+  size_ = static_cast<std::size_t>(info.st_size);
+  if (size_ > 0) {
+    void* mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      ::close(fd);
+      size_ = 0;
+      return Status::Error("Cannot map file: " + path);
+    }
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(mapping);
+    mapped_ = true;
+  }
+  ::close(fd);
+  return Status::Ok();
+#else
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    return Status::Error("Cannot open file: " + path);
+  }
+  fallback_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  data_ = fallback_.data();
+  size_ = fallback_.size();
+  return Status::Ok();
+#endif
+}
+
+void MappedFile::Close() {
+#if SCRATCHROBIN_HAVE_MMAP
+  if (mapped_) {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+#endif
+  data_ = nullptr;
+  size_ = 0;
+  mapped_ = false;
+  fallback_.clear();
+}
+
+// ============================================================================
+// Scanning
+// ============================================================================
+
+const char* FindAnyOf(const char* begin, const char* end, char a, char b, char c) {
+#if SCRATCHROBIN_HAVE_SSE2
+  const __m128i va = _mm_set1_epi8(a);
+  const __m128i vb = _mm_set1_epi8(b);
+  const __m128i vc = _mm_set1_epi8(c);
+  while (end - begin >= 16) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const __m128i hits = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, va), _mm_cmpeq_epi8(block, vb)),
+        _mm_cmpeq_epi8(block, vc));
+    const auto mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+    if (mask != 0) {
+      return begin + std::countr_zero(mask);
+    }
+    begin += 16;
+  }
+#endif
+  for (; begin < end; ++begin) {
+    const char ch = *begin;
+    if (ch == a || ch == b || ch == c) {
+      return begin;
+    }
+  }
+  return end;
+}
+
+// ============================================================================
+// CsvChunkParser
+// ============================================================================
+
+bool ParseCsvEncoding(std::string_view name, CsvEncoding* encoding) {
+  std::string key;
+  for (char c : name) {
+    if (c != '-' && c != '_' && c != ' ') {
+      key.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+    }
+  }
+  if (key.empty() || key == "UTF8") {
+    *encoding = CsvEncoding::kUtf8;
+  } else if (key == "LATIN1" || key == "ISO88591" || key == "L1") {
+    *encoding = CsvEncoding::kLatin1;
+  } else if (key == "WINDOWS1252" || key == "CP1252") {
+    *encoding = CsvEncoding::kWindows1252;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+CsvChunkParser::CsvChunkParser(const CSVOptions& options)
+    : options_(options),
+      escape_(options.escape == options.quote ? '\0' : options.escape) {
+  if (!ParseCsvEncoding(options_.encoding, &encoding_)) {
+    encoding_ = CsvEncoding::kUtf8;  // Rejected by the importer before parsing
+  }
+  for (int column : options_.ignore_columns) {
+    if (column < 0) {
+      continue;
+    }
+    if (static_cast<std::size_t>(column) >= ignored_.size()) {
+      ignored_.resize(static_cast<std::size_t>(column) + 1, false);
+    }
+    ignored_[static_cast<std::size_t>(column)] = true;
+  }
+}
+
+std::size_t CsvChunkParser::TextStart(std::string_view data) const {
+  return encoding_ == CsvEncoding::kUtf8 && data.substr(0, 3) == "\xEF\xBB\xBF" ? 3 : 0;
+}
+
+bool CsvChunkParser::IsIgnored(std::size_t column) const {
+  return column < ignored_.size() && ignored_[column];
+}
+
+std::size_t CsvChunkParser::OutputColumnCount(std::size_t column_count) const {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < column_count; ++i) {
+    count += IsIgnored(i) ? 0 : 1;
+  }
+  return count;
+}
+
+CsvChunkParser::Transition CsvChunkParser::Scan(std::string_view data, std::size_t begin,
+                                                std::size_t end) const {
+  // One lane per start state. An escape makes the lane ignore the byte at
+  // |skip|, which need not be a special character.
+  struct Lane {
+    State state;
+    std::size_t skip;
+    std::size_t first_record;
+  };
+  std::array<Lane, kStateCount> lanes = {{
+      {State::kOutside, kNoRecord, kNoRecord},
+      {State::kQuoted, kNoRecord, kNoRecord},
+      {State::kQuoted, begin, kNoRecord},
+  }};
+
+  const char* base = data.data();
+  const char quote = options_.quote;
+  const char escape = escape_ ? escape_ : quote;
+  end = std::min(end, data.size());
+  std::size_t pos = begin;
+  while (pos < end) {
+    const std::size_t at =
+        static_cast<std::size_t>(FindAnyOf(base + pos, base + end, quote, escape, '\n') - base);
+    if (at >= end) {
+      break;
+    }
+    const char ch = base[at];
+    for (auto& lane : lanes) {
+      if (lane.skip == at) {
+        continue;
+      }
+      if (lane.state == State::kOutside) {
+        if (ch == quote) {
+          lane.state = State::kQuoted;
+        } else if (ch == '\n' && lane.first_record == kNoRecord) {
+          lane.first_record = at + 1;
+        }
+      } else if (ch == quote) {
+        lane.state = State::kOutside;
+      } else if (escape_ && ch == escape_) {
+        lane.skip = at + 1;
+      }
+    }
+    pos = at + 1;
+  }
+
+  Transition transition;
+  for (std::size_t i = 0; i < kStateCount; ++i) {
+    transition.end_state[i] = lanes[i].skip == end ? State::kEscaped : lanes[i].state;
+    transition.first_record[i] = lanes[i].first_record;
+  }
+  return transition;
+}
+
+std::size_t CsvChunkParser::SplitRecord(std::string_view data, std::size_t pos,
+                                        std::vector<Field>* fields, std::string* scratch,
+                                        std::string* error) const {
+  fields->clear();
+  scratch->clear();
+  error->clear();
+
+  const char* base = data.data();
+  const std::size_t size = data.size();
+  const char delimiter = options_.delimiter;
+  const char quote = options_.quote;
+  const char escape = escape_ ? escape_ : quote;
+
+  for (;;) {
+    Field field;
+    std::size_t span_start = pos;
+    bool in_quotes = false;
+    bool in_scratch = false;
+    const std::size_t scratch_start = scratch->size();
+
+    for (;;) {
+      if (!in_quotes) {
+        const std::size_t at = static_cast<std::size_t>(
+            FindAnyOf(base + pos, base + size, delimiter, '\n', quote) - base);
+        if (at < size && base[at] == quote) {
+          scratch->append(base + span_start, at - span_start);
+          in_scratch = true;
+          field.quoted = true;
+          in_quotes = true;
+          pos = at + 1;
+          continue;
+        }
+        std::size_t span_end = at;
+        const bool end_of_record = at >= size || base[at] == '\n';
+        if (end_of_record && span_end > span_start && base[span_end - 1] == '\r') {
+          --span_end;
+        }
+        if (in_scratch) {
+          scratch->append(base + span_start, span_end - span_start);
+          field.offset = scratch_start;
+          field.length = scratch->size() - scratch_start;
+          field.in_scratch = true;
+        } else {
+          field.offset = span_start;
+          field.length = span_end - span_start;
+        }
+        fields->push_back(field);
+        pos = std::min(at + 1, size);
+        if (end_of_record) {
+          return at >= size ? size : at + 1;
+        }
+        break;
+      }
+
+      const std::size_t at = static_cast<std::size_t>(
+          FindAnyOf(base + pos, base + size, quote, escape, quote) - base);
+      if (at >= size) {
+        scratch->append(base + pos, size - pos);
+        field.offset = scratch_start;
+        field.length = scratch->size() - scratch_start;
+        field.in_scratch = true;
+        fields->push_back(field);
+        *error = "unterminated quoted field";
+        return size;
+      }
+      scratch->append(base + pos, at - pos);
+      if (base[at] == quote) {
+        if (at + 1 < size && base[at + 1] == quote) {
+          scratch->push_back(quote);
+          pos = at + 2;
+        } else {
+          in_quotes = false;
+          pos = at + 1;
+          span_start = pos;
+        }
+      } else {
+        if (at + 1 < size) {
+          scratch->push_back(base[at + 1]);
+        }
+        pos = std::min(at + 2, size);
+      }
+    }
+  }
+}
+
+std::string_view CsvChunkParser::FieldText(std::string_view data, const std::string& scratch,
+                                           const Field& field) const {
+  std::string_view text = field.in_scratch
+                              ? std::string_view(scratch).substr(field.offset, field.length)
+                              : data.substr(field.offset, field.length);
+  if (options_.trim_whitespace && !field.quoted) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+      text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+      text.remove_suffix(1);
+    }
+  }
+  return text;
+}
+
+bool CsvChunkParser::IsNull(std::string_view text, const Field& field) const {
+  if (field.quoted) {
+    return false;
+  }
+  return options_.null_value.empty() ? text.empty() : text == options_.null_value;
+}
+
+std::string_view CsvChunkParser::Decode(std::string_view text, std::string* out) const {
+  if (encoding_ == CsvEncoding::kUtf8 ||
+      std::all_of(text.begin(), text.end(), [](char c) { return static_cast<unsigned char>(c) < 0x80; })) {
+    return text;
+  }
+  // Windows-1252 differs from Latin-1 only in 0x80-0x9F; its five unused
+  // bytes there keep their Latin-1 (C1 control) meaning.
+  static constexpr std::uint16_t kWindows1252High[32] = {
+      0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+      0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+      0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+      0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178};
+  out->clear();
+  out->reserve(text.size() + text.size() / 2);
+  for (char c : text) {
+    std::uint32_t code = static_cast<unsigned char>(c);
+    if (encoding_ == CsvEncoding::kWindows1252 && code >= 0x80 && code < 0xA0) {
+      code = kWindows1252High[code - 0x80];
+    }
+    if (code < 0x80) {
+      out->push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      out->push_back(static_cast<char>(0xC0 | (code >> 6)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+      out->push_back(static_cast<char>(0xE0 | (code >> 12)));
+      out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+  }
+  return *out;
+}
+
+void CsvChunkParser::ParseRecords(std::string_view data, std::size_t begin, std::size_t end,
+                                  std::size_t column_count, Chunk* out) const {
+  out->rows.SetColumnCount(OutputColumnCount(column_count));
+  std::vector<Field> fields;
+  std::string scratch;
+  std::string decoded;
+  std::string error;
+
+  std::size_t pos = begin;
+  while (pos < end && pos < data.size()) {
+    pos = SplitRecord(data, pos, &fields, &scratch, &error);
+    if (fields.size() == 1 && !fields[0].quoted && fields[0].length == 0 && error.empty()) {
+      continue;  // Blank line
+    }
+    const std::int64_t record = out->records++;
+    if (!error.empty()) {
+      out->errors.push_back({record, error});
+      continue;
+    }
+    if (fields.size() != column_count) {
+      out->errors.push_back({record, "expected " + std::to_string(column_count) +
+                                         " fields, found " + std::to_string(fields.size())});
+      continue;
+    }
+
+    std::size_t column = 0;
+    for (std::size_t i = 0; i < fields.size(); ++i) {
+      if (IsIgnored(i)) {
+        continue;
+      }
+      const std::string_view text = FieldText(data, scratch, fields[i]);
+      auto& buffer = out->rows.Column(column++);
+      if (IsNull(text, fields[i])) {
+        buffer.AppendNull();
+      } else {
+        buffer.AppendText(Decode(text, &decoded));
+      }
+    }
+    out->rows.EndRow();
+  }
+  out->end_offset = pos;
+}
+
+std::size_t CsvChunkParser::ParseRecord(std::string_view data, std::size_t pos,
+                                        std::vector<std::string>* out) const {
+  std::vector<Field> fields;
+  std::string scratch;
+  std::string error;
+  const std::size_t next = SplitRecord(data, pos, &fields, &scratch, &error);
+  std::string decoded;
+  out->clear();
+  out->reserve(fields.size());
+  for (const auto& field : fields) {
+    out->emplace_back(Decode(FieldText(data, scratch, field), &decoded));
+  }
+  return next;
+}
+
+std::size_t CsvChunkParser::SkipRecords(std::string_view data, std::size_t pos,
+                                        int lines) const {
+  std::vector<Field> fields;
+  std::string scratch;
+  std::string error;
+  for (int i = 0; i < lines && pos < data.size(); ++i) {
+    pos = SplitRecord(data, pos, &fields, &scratch, &error);
+  }
+  return pos;
+}
+
+}  // namespace scratchrobin::core
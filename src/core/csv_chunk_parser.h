@@ -0,0 +1,151 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/result_set.h"
+#include "core/status.h"
+#include "core/streaming_data_importer.h"
+
+namespace scratchrobin::core {
+
+/**
+ * MappedFile - read-only view of a whole file
+ *
+ * Uses mmap() where available so the kernel pages the file in as the
+ * parsers touch it; elsewhere the file is read into memory.
+ */
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  Status Open(const std::string& path);
+  void Close();
+
+  std::string_view Data() const { return {data_, size_}; }
+  std::size_t Size() const { return size_; }
+
+ private:
+  const char* data_{nullptr};
+  std::size_t size_{0};
+  bool mapped_{false};
+  std::string fallback_;
+};
+
+// Returns the first position in [begin, end) holding a, b or c, or end.
+// Scans 16 bytes at a time with SSE2 where available.
+const char* FindAnyOf(const char* begin, const char* end, char a, char b, char c);
+
+// Byte encodings the parser reads. Single-byte encodings are converted
+// to UTF-8 a field at a time, so delimiters and quotes must be ASCII.
+enum class CsvEncoding : std::uint8_t { kUtf8, kLatin1, kWindows1252 };
+
+// Reads a CSVOptions::encoding name ("UTF-8", "ISO-8859-1", "cp1252", ...)
+// case-insensitively; false for encodings the parser cannot read.
+bool ParseCsvEncoding(std::string_view name, CsvEncoding* encoding);
+
+/**
+ * CsvChunkParser - parses byte ranges of a CSV file independently
+ *
+ * Records are split on '\n' outside quotes (a trailing '\r' is dropped).
+ * Inside quotes a doubled quote is a literal quote and, when the escape
+ * character differs from the quote, the escape makes the next byte
+ * literal. Outside quotes an unquoted empty field, or one equal to
+ * null_value, is NULL.
+ *
+ * Parallel parsing splits the file at arbitrary byte offsets. Scan() runs
+ * the quote state machine over a chunk from every possible start state, so
+ * once the state at the end of the previous chunk is known the chunk's
+ * first record boundary follows without rescanning.
+ */
+class CsvChunkParser {
+ public:
+  enum class State : std::uint8_t { kOutside, kQuoted, kEscaped };
+  static constexpr std::size_t kStateCount = 3;
+  static constexpr std::size_t kNoRecord = static_cast<std::size_t>(-1);
+
+  // A record starts at a chunk's first byte when the previous chunk ended
+  // in kOutside with a '\n'; otherwise at first_record for the start state.
+  struct Transition {
+    // Indexed by start state
+    std::array<State, kStateCount> end_state{};
+    // Offset just past the first record terminator, kNoRecord if none
+    std::array<std::size_t, kStateCount> first_record{};
+  };
+
+  struct RowError {
+    std::int64_t record{0};  // Index among the records of the parsed range
+    std::string message;
+  };
+
+  struct Chunk {
+    ColumnTable rows;
+    std::vector<RowError> errors;
+    std::int64_t records{0};  // Good and bad records
+    std::size_t end_offset{0};  // Just past the last record parsed
+  };
+
+  explicit CsvChunkParser(const CSVOptions& options);
+
+  // Offset of the first record: past a UTF-8 byte order mark, if any
+  std::size_t TextStart(std::string_view data) const;
+
+  Transition Scan(std::string_view data, std::size_t begin, std::size_t end) const;
+
+  // Parses every record that starts in [begin, end); the last one may run
+  // past |end|. |begin| must be a record boundary. |column_count| is the
+  // number of source fields expected per record.
+  void ParseRecords(std::string_view data, std::size_t begin, std::size_t end,
+                    std::size_t column_count, Chunk* out) const;
+
+  // Parses one record starting at |pos| into owned strings (header,
+  // previews); returns the offset of the next record.
+  std::size_t ParseRecord(std::string_view data, std::size_t pos,
+                          std::vector<std::string>* fields) const;
+
+  // Skips |lines| records starting at |pos|.
+  std::size_t SkipRecords(std::string_view data, std::size_t pos, int lines) const;
+
+  // Number of output columns after ignore_columns is applied.
+  std::size_t OutputColumnCount(std::size_t column_count) const;
+  bool IsIgnored(std::size_t column) const;
+
+ private:
+  struct Field {
+    std::size_t offset{0};
+    std::size_t length{0};
+    bool in_scratch{false};
+    bool quoted{false};
+  };
+
+  // Splits one record into fields; returns the offset after it and sets
+  // |error| for malformed input.
+  std::size_t SplitRecord(std::string_view data, std::size_t pos, std::vector<Field>* fields,
+                          std::string* scratch, std::string* error) const;
+  std::string_view FieldText(std::string_view data, const std::string& scratch,
+                             const Field& field) const;
+  bool IsNull(std::string_view text, const Field& field) const;
+  // |text| as UTF-8, converted into |out| when the encoding needs it
+  std::string_view Decode(std::string_view text, std::string* out) const;
+
+  CSVOptions options_;
+  CsvEncoding encoding_{CsvEncoding::kUtf8};
+  char escape_;  // 0 when escaping is by doubled quotes only
+  std::vector<bool> ignored_;
+};
+
+}  // namespace scratchrobin::core
@@ -0,0 +1,444 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/export_encoders.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+#include "core/arrow_ipc_format.h"
+#include "core/parquet_format.h"
+#include "core/sql_utils.h"
+
+namespace scratchrobin::core {
+
+void AppendJsonString(std::string_view text, std::string& out) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  out.push_back('"');
+  std::size_t run = 0;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    const auto ch = static_cast<unsigned char>(text[i]);
+    if (ch >= 0x20 && ch != '"' && ch != '\\') {
+      continue;
+    }
+    out.append(text.data() + run, i - run);
+    run = i + 1;
+    switch (ch) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        out += "\\u00";
+        out.push_back(kHex[ch >> 4]);
+        out.push_back(kHex[ch & 0xF]);
+        break;
+    }
+  }
+  out.append(text.data() + run, text.size() - run);
+  out.push_back('"');
+}
+
+namespace {
+
+// ============================================================================
+// CSV
+// ============================================================================
+
+class CsvEncoder : public ExportEncoder {
+ public:
+  explicit CsvEncoder(const CSVExportOptions& options) : options_(options) {
+    specials_ = {options.delimiter, options.quote, '\n', '\r'};
+  }
+
+  void BeginStream(const ExportSchema& schema, std::string* out) override {
+    schema_ = schema;
+    if (options_.bom) {
+      *out += "\xEF\xBB\xBF";
+    }
+    if (options_.include_header) {
+      for (std::size_t i = 0; i < schema_.names.size(); ++i) {
+        if (i) {
+          out->push_back(options_.delimiter);
+        }
+        AppendField(schema_.names[i], out);
+      }
+      *out += options_.line_ending;
+    }
+  }
+
+  Status EncodeBatch(const ColumnTable& rows, std::size_t begin, std::size_t end, std::int64_t,
+                     std::string* out) const override {
+    std::string scratch;
+    for (std::size_t row = begin; row < end; ++row) {
+      for (std::size_t i = 0; i < schema_.source_index.size(); ++i) {
+        if (i) {
+          out->push_back(options_.delimiter);
+        }
+        const ColumnBuffer& column = rows.Column(schema_.source_index[i]);
+        if (column.IsNull(row)) {
+          *out += options_.null_value;
+        } else if (column.Type() == ColumnType::kText) {
+          AppendField(column.TextAt(row), out);
+        } else {
+          scratch.clear();
+          column.AppendFormatted(row, scratch);
+          AppendField(scratch, out);
+        }
+      }
+      *out += options_.line_ending;
+    }
+    return Status::Ok();
+  }
+
+  void EndStream(std::int64_t, std::string*) override {}
+
+ private:
+  // Quotes a field only when it would otherwise be misread: it holds a
+  // special character, or it would read back as NULL.
+  void AppendField(std::string_view text, std::string* out) const {
+    if (options_.trim_strings) {
+      while (!text.empty() && text.front() == ' ') {
+        text.remove_prefix(1);
+      }
+      while (!text.empty() && text.back() == ' ') {
+        text.remove_suffix(1);
+      }
+    }
+    const bool reads_as_null =
+        options_.null_value.empty() ? text.empty() : text == options_.null_value;
+    if (!reads_as_null && text.find_first_of(specials_) == std::string_view::npos) {
+      out->append(text);
+      return;
+    }
+    const char quote = options_.quote;
+    const char escape = options_.escape;
+    out->push_back(quote);
+    for (char ch : text) {
+      if (ch == quote) {
+        out->push_back(escape ? escape : quote);
+      } else if (escape && escape != quote && ch == escape) {
+        out->push_back(escape);
+      }
+      out->push_back(ch);
+    }
+    out->push_back(quote);
+  }
+
+  CSVExportOptions options_;
+  std::string specials_;
+  ExportSchema schema_;
+};
+
+// ============================================================================
+// JSON
+// ============================================================================
+
+// use_arrays writes one JSON array of row objects (pretty or compact);
+// otherwise one compact object per line (JSON Lines).
+class JsonEncoder : public ExportEncoder {
+ public:
+  explicit JsonEncoder(const JSONExportOptions& options)
+      : options_(options), pretty_(options.pretty_print && options.use_arrays) {}
+
+  void BeginStream(const ExportSchema& schema, std::string* out) override {
+    schema_ = schema;
+    const std::string indent(static_cast<std::size_t>(std::max(0, options_.indent_size)), ' ');
+    row_indent_ = pretty_ ? indent : std::string();
+    keys_.clear();
+    for (const auto& name : schema_.names) {
+      std::string key = pretty_ ? "\n" + indent + indent : std::string();
+      AppendJsonString(name, key);
+      key += pretty_ ? ": " : ":";
+      keys_.push_back(std::move(key));
+    }
+    if (options_.use_arrays) {
+      *out += pretty_ ? "[\n" : "[";
+    }
+  }
+
+  Status EncodeBatch(const ColumnTable& rows, std::size_t begin, std::size_t end,
+                     std::int64_t first_row, std::string* out) const override {
+    std::string scratch;
+    for (std::size_t row = begin; row < end; ++row) {
+      if (options_.use_arrays && first_row + static_cast<std::int64_t>(row - begin) > 0) {
+        *out += pretty_ ? ",\n" : ",";
+      }
+      *out += row_indent_;
+      out->push_back('{');
+      bool first = true;
+      for (std::size_t i = 0; i < schema_.source_index.size(); ++i) {
+        const ColumnBuffer& column = rows.Column(schema_.source_index[i]);
+        const bool is_null = column.IsNull(row);
+        if (is_null && !options_.include_nulls) {
+          continue;
+        }
+        if (!first) {
+          out->push_back(',');
+        }
+        first = false;
+        *out += keys_[i];
+        // Numbers stay bare only in numeric columns, so a VARCHAR column
+        // is a string in every row whatever its values look like
+        const ColumnType declared = schema_.types[i];
+        const bool as_number = declared == ColumnType::kAuto ||
+                               declared == ColumnType::kInt64 || declared == ColumnType::kDouble;
+        if (is_null) {
+          *out += options_.null_value;
+        } else if (column.Type() == ColumnType::kText) {
+          AppendJsonString(column.TextAt(row), *out);
+        } else if (as_number && (column.Type() == ColumnType::kInt64 ||
+                                 (column.Type() == ColumnType::kDouble &&
+                                  std::isfinite(column.DoubleAt(row))))) {
+          column.AppendFormatted(row, *out);
+        } else if (as_number && column.Type() == ColumnType::kDouble) {
+          *out += "null";
+        } else {
+          scratch.clear();
+          column.AppendFormatted(row, scratch);
+          AppendJsonString(scratch, *out);
+        }
+      }
+      if (pretty_ && !first) {
+        out->push_back('\n');
+        *out += row_indent_;
+      }
+      out->push_back('}');
+      if (!options_.use_arrays) {
+        out->push_back('\n');
+      }
+    }
+    return Status::Ok();
+  }
+
+  void EndStream(std::int64_t total_rows, std::string* out) override {
+    if (options_.use_arrays) {
+      *out += pretty_ && total_rows > 0 ? "\n]\n" : "]\n";
+    }
+  }
+
+ private:
+  JSONExportOptions options_;
+  bool pretty_;
+  ExportSchema schema_;
+  std::string row_indent_;
+  std::vector<std::string> keys_;  // Separator, indent and quoted key per column
+};
+
+// ============================================================================
+// SQL
+// ============================================================================
+
+// Statements start on multiples of bulk_insert_size in export row order,
+// so output does not depend on how rows were batched as long as batches
+// hold whole statements.
+class SqlEncoder : public ExportEncoder {
+ public:
+  SqlEncoder(const SQLExportOptions& options, std::string table)
+      : options_(options), rows_per_statement_(options.use_bulk_insert
+                                                   ? std::max(1, options.bulk_insert_size)
+                                                   : 1) {
+    table_ = Quote(table);
+  }
+
+  void BeginStream(const ExportSchema& schema, std::string* out) override {
+    schema_ = schema;
+    if (options_.include_drop_table) {
+      *out += "DROP TABLE IF EXISTS " + table_ + ";\n";
+    }
+    if (options_.include_create_table) {
+      *out += "CREATE TABLE " + table_ + " (\n";
+      for (std::size_t i = 0; i < schema_.names.size(); ++i) {
+        const std::string& declared = schema_.sql_types[i];
+        *out += "  " + Quote(schema_.names[i]) + " " +
+                (declared.empty() ? TypeName(schema_.types[i]) : declared);
+        *out += i + 1 < schema_.names.size() ? ",\n" : "\n";
+      }
+      *out += ");\n\n";
+    }
+    if (options_.include_transactions) {
+      *out += "BEGIN;\n";
+    }
+    prefix_ = "INSERT INTO " + table_ + " (";
+    for (std::size_t i = 0; i < schema_.names.size(); ++i) {
+      prefix_ += (i ? ", " : "") + Quote(schema_.names[i]);
+    }
+    prefix_ += ") VALUES";
+  }
+
+  Status EncodeBatch(const ColumnTable& rows, std::size_t begin, std::size_t end,
+                     std::int64_t first_row, std::string* out) const override {
+    const auto per = static_cast<std::int64_t>(rows_per_statement_);
+    for (std::size_t row = begin; row < end; ++row) {
+      const std::int64_t index = first_row + static_cast<std::int64_t>(row - begin);
+      const bool opens = row == begin || index % per == 0;
+      const bool closes = row + 1 == end || (index + 1) % per == 0;
+      *out += opens ? prefix_ + (per > 1 ? "\n  (" : " (") : "  (";
+      for (std::size_t i = 0; i < schema_.source_index.size(); ++i) {
+        if (i) {
+          *out += ", ";
+        }
+        appendSqlLiteral(rows.Column(schema_.source_index[i]), row, schema_.types[i], *out);
+      }
+      *out += closes ? ");\n" : "),\n";
+    }
+    return Status::Ok();
+  }
+
+  void EndStream(std::int64_t, std::string* out) override {
+    if (options_.include_transactions) {
+      *out += "COMMIT;\n";
+    }
+  }
+
+ private:
+  std::string Quote(const std::string& name) const {
+    return options_.quote_identifiers || !isValidIdentifier(name) ? escapeIdentifier(name) : name;
+  }
+
+  static const char* TypeName(ColumnType type) {
+    switch (type) {
+      case ColumnType::kInt64: return "BIGINT";
+      case ColumnType::kDouble: return "DOUBLE PRECISION";
+      case ColumnType::kDate: return "DATE";
+      default: return "TEXT";
+    }
+  }
+
+  SQLExportOptions options_;
+  std::size_t rows_per_statement_;
+  std::string table_;
+  std::string prefix_;
+  ExportSchema schema_;
+};
+
+// ============================================================================
+// Parquet
+// ============================================================================
+
+// Every batch is one row group. Row groups are encoded independently with
+// offsets relative to their own start; EndStream places them after the
+// leading magic in export order and writes the footer.
+class ParquetEncoder : public ExportEncoder {
+ public:
+  explicit ParquetEncoder(const ColumnarExportOptions& options) {
+    options_.page_bytes = std::max<std::size_t>(1, options.page_bytes);
+    options_.dictionary_bytes = options.dictionary_bytes;
+    options_.use_dictionary = options.use_dictionary;
+  }
+
+  void BeginStream(const ExportSchema& schema, std::string* out) override {
+    schema_ = schema;
+    columnar_ = ColumnarSchema{schema.names, schema.types};
+    row_groups_.clear();
+    *out += kParquetMagic;
+  }
+
+  Status EncodeBatch(const ColumnTable& rows, std::size_t begin, std::size_t end,
+                     std::int64_t first_row, std::string* out) const override {
+    std::vector<const ColumnBuffer*> columns;
+    for (std::size_t index : schema_.source_index) {
+      columns.push_back(&rows.Column(index));
+    }
+    ParquetRowGroup row_group;
+    const std::size_t start = out->size();
+    Status status = EncodeParquetRowGroup(columnar_, columns, begin, end, options_, out, &row_group);
+    if (!status.ok) {
+      return status;
+    }
+    row_group.total_bytes = static_cast<std::int64_t>(out->size() - start);
+    std::lock_guard<std::mutex> lock(mutex_);
+    row_groups_.emplace(first_row, std::move(row_group));
+    return Status::Ok();
+  }
+
+  void EndStream(std::int64_t, std::string* out) override {
+    std::vector<ParquetRowGroup> placed;
+    auto offset = static_cast<std::int64_t>(kParquetMagic.size());
+    for (auto& [first_row, row_group] : row_groups_) {
+      row_group.offset = offset;
+      for (auto& chunk : row_group.columns) {
+        chunk.data_page_offset += offset;
+        if (chunk.dictionary_page_offset >= 0) {
+          chunk.dictionary_page_offset += offset;
+        }
+      }
+      offset += row_group.total_bytes;
+      placed.push_back(std::move(row_group));
+    }
+    row_groups_.clear();
+    AppendParquetFooter(columnar_, placed, out);
+  }
+
+ private:
+  ParquetWriteOptions options_;
+  ExportSchema schema_;
+  ColumnarSchema columnar_;
+  mutable std::mutex mutex_;
+  mutable std::map<std::int64_t, ParquetRowGroup> row_groups_;  // By first row
+};
+
+// ============================================================================
+// Arrow IPC
+// ============================================================================
+
+// Schema message, one record batch per batch, end-of-stream marker.
+class ArrowEncoder : public ExportEncoder {
+ public:
+  void BeginStream(const ExportSchema& schema, std::string* out) override {
+    schema_ = schema;
+    columnar_ = ColumnarSchema{schema.names, schema.types};
+    AppendArrowSchemaMessage(columnar_, out);
+  }
+
+  Status EncodeBatch(const ColumnTable& rows, std::size_t begin, std::size_t end, std::int64_t,
+                     std::string* out) const override {
+    std::vector<const ColumnBuffer*> columns;
+    for (std::size_t index : schema_.source_index) {
+      columns.push_back(&rows.Column(index));
+    }
+    return AppendArrowRecordBatch(columnar_, columns, begin, end, out);
+  }
+
+  void EndStream(std::int64_t, std::string* out) override { AppendArrowEndOfStream(out); }
+
+ private:
+  ExportSchema schema_;
+  ColumnarSchema columnar_;
+};
+
+}  // namespace
+
+Status CreateExportEncoder(const ExportConfig& config, std::unique_ptr<ExportEncoder>* encoder) {
+  switch (config.format) {
+    case ExportFormat::kCSV:
+      *encoder = std::make_unique<CsvEncoder>(config.csv_options);
+      return Status::Ok();
+    case ExportFormat::kJSON:
+      *encoder = std::make_unique<JsonEncoder>(config.json_options);
+      return Status::Ok();
+    case ExportFormat::kSQL: {
+      auto it = config.custom_options.find("target_table");
+      std::string table = it != config.custom_options.end() ? it->second : config.source_table;
+      *encoder = std::make_unique<SqlEncoder>(config.sql_options,
+                                              table.empty() ? "exported_data" : table);
+      return Status::Ok();
+    }
+    case ExportFormat::kParquet:
+      *encoder = std::make_unique<ParquetEncoder>(config.columnar_options);
+      return Status::Ok();
+    case ExportFormat::kArrow:
+      *encoder = std::make_unique<ArrowEncoder>();
+      return Status::Ok();
+    default:
+      return Status::Error("Export format not supported by the streaming exporter");
+  }
+}
+
+}  // namespace scratchrobin::core
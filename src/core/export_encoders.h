@@ -0,0 +1,56 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/export_manager.h"
+#include "core/result_set.h"
+#include "core/status.h"
+
+namespace scratchrobin::core {
+
+// Output columns of an export, after column selection and aliases.
+struct ExportSchema {
+  std::vector<std::string> names;
+  std::vector<std::size_t> source_index;  // Column of the fetched rows
+  std::vector<ColumnType> types;          // Declared by the source; kAuto if unknown
+  std::vector<std::string> sql_types;     // Declared SQL type names; empty if unknown
+};
+
+/**
+ * ExportEncoder - turns row batches into the bytes of one output format
+ *
+ * BeginStream and EndStream run once, on the thread that writes the file.
+ * EncodeBatch is const and runs concurrently on the encoder pool; batches
+ * are written in export order whatever order they finish in. Encoders
+ * append to |out| so callers can reuse one buffer per batch.
+ */
+class ExportEncoder {
+ public:
+  virtual ~ExportEncoder() = default;
+
+  virtual void BeginStream(const ExportSchema& schema, std::string* out) = 0;
+  // Encodes rows [begin, end) of |rows|; |first_row| is the 0-based index
+  // of rows[begin] in the whole export. A failure aborts the export.
+  virtual Status EncodeBatch(const ColumnTable& rows, std::size_t begin, std::size_t end,
+                           std::int64_t first_row, std::string* out) const = 0;
+  virtual void EndStream(std::int64_t total_rows, std::string* out) = 0;
+};
+
+// Creates the encoder for config.format, or fails for formats without one.
+Status CreateExportEncoder(const ExportConfig& config, std::unique_ptr<ExportEncoder>* encoder);
+
+// Appends |text| as a JSON string literal, quotes included.
+void AppendJsonString(std::string_view text, std::string& out);
+
+}  // namespace scratchrobin::core
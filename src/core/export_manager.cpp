@@ -10,18 +10,694 @@
 
 #include "core/export_manager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#include "core/export_encoders.h"
+#include "core/output_sink.h"
+#include "core/scratchbird_types.h"
+#include "core/sql_utils.h"
+
 namespace scratchrobin::core {
 
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+// Cancel/pause flags and live progress of one running export.
+struct ExportControl {
+  std::atomic<bool> cancelled{false};
+  std::atomic<bool> paused{false};
+  std::atomic<Connection*> connection{nullptr};  // Cursor to cancel, if any
+  mutable std::mutex mutex;
+  std::condition_variable resume_cv;
+  ExportProgress progress;
+};
+
+// ============================================================================
+// Sources
+// ============================================================================
+
+// Rows [begin, end) of the source's table when it outlives the batch,
+// otherwise of |owned|.
+struct RowBatch {
+  ColumnTable owned;
+  const ColumnTable* borrowed{nullptr};
+  std::size_t begin{0};
+  std::size_t end{0};
+
+  const ColumnTable& Table() const { return borrowed ? *borrowed : owned; }
+  std::size_t Rows() const { return end - begin; }
+};
+
+class BatchSource {
+ public:
+  virtual ~BatchSource() = default;
+  // Fills the column names and, where the source knows them, the declared
+  // type and SQL type name of each column (kAuto / empty otherwise).
+  virtual Status Open(std::vector<std::string>* columns, std::vector<ColumnType>* types,
+                      std::vector<std::string>* sql_types) = 0;
+  // An empty batch means the source is exhausted.
+  virtual Status Next(std::size_t max_rows, RowBatch* batch) = 0;
+};
+
+// The server's name for |oid| as used in DDL, or empty when unknown.
+std::string SqlTypeName(Oid oid) {
+  const auto type = TypeRegistry::Instance().GetTypeByOid(oid);
+  if (!type) {
+    return std::string();
+  }
+  std::string name = type->name;
+  std::transform(name.begin(), name.end(), name.begin(),
+                 [](unsigned char ch) { return static_cast<char>(std::toupper(ch)); });
+  return name;
+}
+
+class CursorSource : public BatchSource {
+ public:
+  CursorSource(Connection* connection, std::string sql)
+      : connection_(connection), sql_(std::move(sql)) {}
+  ~CursorSource() override {
+    if (open_) {
+      connection_->closeCursor();
+    }
+  }
+
+  Status Open(std::vector<std::string>* columns, std::vector<ColumnType>* types,
+              std::vector<std::string>* sql_types) override {
+    auto opened = connection_->openCursor(sql_);
+    if (!opened.success) {
+      return Status::Error("Query failed: " + opened.error_message);
+    }
+    open_ = true;
+    has_more_ = opened.has_more;
+    columns->clear();
+    sql_types->clear();
+    for (const auto& column : opened.columns) {
+      columns->push_back(column.name);
+      sql_types->push_back(SqlTypeName(static_cast<Oid>(column.type)));
+    }
+    *types = backend::declaredColumnTypes(opened.columns);
+    return Status::Ok();
+  }
+
+  Status Next(std::size_t max_rows, RowBatch* batch) override {
+    batch->owned = ColumnTable{};
+    batch->borrowed = nullptr;
+    batch->begin = batch->end = 0;
+    if (!has_more_) {
+      return Status::Ok();
+    }
+    auto fetched = connection_->fetchRows(max_rows);
+    if (!fetched.success) {
+      has_more_ = false;
+      return Status::Error("Fetch failed: " + fetched.error_message);
+    }
+    has_more_ = fetched.has_more;
+    batch->owned = std::move(fetched.rows);
+    batch->end = batch->owned.RowCount();
+    return Status::Ok();
+  }
+
+ private:
+  Connection* connection_;
+  std::string sql_;
+  bool open_{false};
+  bool has_more_{false};
+};
+
+class ResultSetSource : public BatchSource {
+ public:
+  // |transformed|: a row transform rewrites the cells, so the buffers no
+  // longer say what the exported values are
+  ResultSetSource(const ResultSet& result_set, bool transformed)
+      : result_set_(result_set), transformed_(transformed) {}
+
+  // Undeclared columns take the type of their buffer, which already
+  // covers every row; under a transform they stay kAuto
+  Status Open(std::vector<std::string>* columns, std::vector<ColumnType>* types,
+              std::vector<std::string>* sql_types) override {
+    *columns = result_set_.columns;
+    types->clear();
+    for (std::size_t i = 0; i < columns->size(); ++i) {
+      const ColumnType declared = result_set_.DeclaredType(i);
+      types->push_back(declared != ColumnType::kAuto || transformed_ ||
+                               i >= result_set_.ColumnCount()
+                           ? declared
+                           : result_set_.Column(i).Type());
+    }
+    sql_types->assign(columns->size(), std::string());
+    return Status::Ok();
+  }
+
+  Status Next(std::size_t max_rows, RowBatch* batch) override {
+    batch->borrowed = &result_set_.rows;
+    batch->begin = position_;
+    batch->end = std::min(result_set_.rows.RowCount(), position_ + max_rows);
+    position_ = batch->end;
+    return Status::Ok();
+  }
+
+ private:
+  const ResultSet& result_set_;
+  bool transformed_;
+  std::size_t position_{0};
+};
+
+std::string QuoteIdentifierIfNeeded(const std::string& name) {
+  return isValidIdentifier(name) ? name : escapeIdentifier(name);
+}
+
+std::string BuildSourceQuery(const ExportConfig& config) {
+  std::string sql;
+  if (!config.source_query.empty()) {
+    if (config.where_clause.empty() && config.order_by.empty()) {
+      return config.source_query;
+    }
+    sql = "SELECT * FROM (" + config.source_query + ") AS export_source";
+  } else {
+    // Dotted names are taken as already qualified
+    const bool qualified = config.source_table.find('.') != std::string::npos;
+    sql = "SELECT * FROM " +
+          (qualified ? config.source_table : QuoteIdentifierIfNeeded(config.source_table));
+  }
+  if (!config.where_clause.empty()) {
+    sql += " WHERE " + config.where_clause;
+  }
+  if (!config.order_by.empty()) {
+    sql += " ORDER BY " + config.order_by;
+  }
+  return sql;
+}
+
+}  // namespace
+
 // Private implementation
 struct ExportManager::Impl {
+  ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto& [id, control] : active_exports) {
+        (void)id;
+        control->cancelled = true;
+        control->paused = false;
+        control->resume_cv.notify_all();
+        if (Connection* connection = control->connection.load()) {
+          connection->cancel();
+        }
+      }
+    }
+    for (auto& thread : async_threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+  std::shared_ptr<ExportControl> Find(const std::string& export_id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = active_exports.find(export_id);
+    return it == active_exports.end() ? nullptr : it->second;
+  }
+
+  ExportResult Run(const ExportConfig& config, BatchSource& source, int64_t total_rows);
+  static Status OpenOutput(ExportConfig* config, std::unique_ptr<OutputSink>* sink);
+  ExportResult Stream(const ExportConfig& config, ExportControl& control, BatchSource& source,
+                      OutputSink& sink, int64_t total_rows);
+  void Transform(const std::vector<std::string>& columns, RowBatch* batch,
+                 const RowTransformCallback& transform, Status* status) const;
+
+  mutable std::mutex mutex;
   ProgressCallback progress_callback;
   CompletionCallback completion_callback;
   RowTransformCallback row_transform_callback;
   std::vector<ExportTemplate> templates;
+  std::map<std::string, std::shared_ptr<ExportControl>> active_exports;
   std::map<std::string, ExportResult> completed_exports;
-  std::map<std::string, ExportProgress> active_exports;
+  std::vector<std::thread> async_threads;
 };
 
+// Opens the file sink for |config|, wrapped in a compressor when
+// compress_output is set. The format's extension is appended to
+// output_path unless the path already ends with it.
+Status ExportManager::Impl::OpenOutput(ExportConfig* config, std::unique_ptr<OutputSink>* sink) {
+  CompressionOptions compression;
+  if (config->compress_output) {
+    Status status = ParseOutputCompression(
+        config->compression_format.empty() ? "gzip" : config->compression_format,
+        &compression.format);
+    if (!status.ok) {
+      return status;
+    }
+    if (!OutputCompressionAvailable(compression.format)) {
+      return Status::Error("Compression format not available in this build: " +
+                           config->compression_format);
+    }
+    const std::string extension = OutputCompressionExtension(compression.format);
+    const std::string& path = config->output_path;
+    if (path.size() < extension.size() ||
+        path.compare(path.size() - extension.size(), extension.size(), extension) != 0) {
+      compression.entry_name = std::filesystem::path(path).filename().string();
+      config->output_path += extension;
+    } else {
+      compression.entry_name =
+          std::filesystem::path(path.substr(0, path.size() - extension.size()))
+              .filename()
+              .string();
+    }
+    compression.level = config->compression_level;
+    compression.threads = config->parallelism;
+  }
+
+  auto file = std::make_unique<FileSink>();
+  Status status = file->Open(config->output_path);
+  if (!status.ok) {
+    return status;
+  }
+  return MakeCompressingSink(std::move(file), compression, sink);
+}
+
+ExportResult ExportManager::Impl::Run(const ExportConfig& config, BatchSource& source,
+                                      int64_t total_rows) {
+  ExportResult result;
+  result.export_id = config.export_id;
+  result.output_path = config.output_path;
+
+  auto control = std::make_shared<ExportControl>();
+  control->connection = config.connection.get();
+  control->progress.export_id = config.export_id;
+  control->progress.status_message = "Starting export...";
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (active_exports.count(config.export_id)) {
+      result.status = Status::Error("Export already running: " + config.export_id);
+      return result;
+    }
+    active_exports[config.export_id] = control;
+  }
+
+  if (config.destination != ExportDestination::kFile || config.output_path.empty()) {
+    result.status = Status::Error("Exports write to a file; an output path is required");
+  } else {
+    std::unique_ptr<OutputSink> sink;
+    ExportConfig local = config;
+    result.status = OpenOutput(&local, &sink);
+    if (result.status.ok) {
+      result = Stream(local, *control, source, *sink, total_rows);
+    }
+  }
+
+  CompletionCallback on_complete;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    active_exports.erase(config.export_id);
+    completed_exports[config.export_id] = result;
+    on_complete = completion_callback;
+  }
+  if (on_complete) {
+    on_complete(result);
+  }
+  return result;
+}
+
+// The calling thread pulls batches from |source|, a pool of threads
+// encodes them and a writer thread appends them to |sink| in order. A
+// ring of slots bounds the batches in flight; a slot's output buffer is
+// cleared, not freed, so steady state allocates nothing.
+ExportResult ExportManager::Impl::Stream(const ExportConfig& config, ExportControl& control,
+                                         BatchSource& source, OutputSink& sink,
+                                         int64_t total_rows) {
+  const auto started = SteadyClock::now();
+  ExportResult result;
+  result.export_id = config.export_id;
+  result.output_path = config.output_path;
+
+  auto finish = [&](Status status) {
+    Status finished = sink.Finish(status.ok);
+    if (status.ok && !finished.ok) {
+      status = finished;
+    }
+    result.status = std::move(status);
+    result.duration =
+        std::chrono::duration_cast<std::chrono::milliseconds>(SteadyClock::now() - started);
+    const double seconds = std::chrono::duration<double>(SteadyClock::now() - started).count();
+    if (seconds > 0) {
+      result.average_rows_per_second = static_cast<double>(result.total_rows) / seconds;
+    }
+    return result;
+  };
+
+  std::unique_ptr<ExportEncoder> encoder;
+  Status status = CreateExportEncoder(config, &encoder);
+  if (!status.ok) {
+    return finish(status);
+  }
+  std::vector<std::string> columns;
+  std::vector<ColumnType> declared_types;
+  std::vector<std::string> sql_types;
+  status = source.Open(&columns, &declared_types, &sql_types);
+  if (!status.ok) {
+    return finish(status);
+  }
+
+  ExportSchema schema;
+  if (config.export_all_columns || config.columns.empty()) {
+    schema.names = columns;
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+      schema.source_index.push_back(i);
+    }
+  } else {
+    for (const auto& column : config.columns) {
+      auto it = std::find(columns.begin(), columns.end(), column.name);
+      if (!column.include) {
+        continue;
+      }
+      if (it == columns.end()) {
+        result.warnings.push_back("Column not in result: " + column.name);
+        continue;
+      }
+      schema.source_index.push_back(static_cast<std::size_t>(it - columns.begin()));
+      schema.names.push_back(column.alias.empty() ? column.name : column.alias);
+    }
+    if (schema.source_index.empty()) {
+      return finish(Status::Error("No exported columns are in the result"));
+    }
+  }
+  for (std::size_t index : schema.source_index) {
+    schema.types.push_back(index < declared_types.size() ? declared_types[index]
+                                                         : ColumnType::kAuto);
+    schema.sql_types.push_back(index < sql_types.size() ? sql_types[index] : std::string());
+  }
+
+  RowTransformCallback transform;
+  ProgressCallback on_progress;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    transform = row_transform_callback;
+    on_progress = progress_callback;
+  }
+
+  // Whole SQL statements per batch keep statement boundaries independent
+  // of the fetch size; columnar formats encode one row group per batch
+  std::size_t batch_rows = static_cast<std::size_t>(std::max(1, config.batch_size));
+  if (config.format == ExportFormat::kParquet || config.format == ExportFormat::kArrow) {
+    batch_rows = static_cast<std::size_t>(
+        std::max<int64_t>(1, config.columnar_options.row_group_rows));
+  } else if (config.format == ExportFormat::kSQL && config.sql_options.use_bulk_insert &&
+      config.sql_options.bulk_insert_size > 1) {
+    const auto per = static_cast<std::size_t>(config.sql_options.bulk_insert_size);
+    batch_rows = (batch_rows + per - 1) / per * per;
+  }
+  const int64_t row_limit = config.max_rows > 0 ? config.max_rows : INT64_MAX;
+  int64_t rows_to_skip = std::max<int64_t>(0, config.skip_rows);
+  int64_t rows_taken = 0;
+  if (total_rows >= 0) {
+    total_rows = std::min(std::max<int64_t>(0, total_rows - rows_to_skip), row_limit);
+  }
+
+  // Applies skip_rows / max_rows; false once the export has all its rows.
+  auto next_batch = [&](RowBatch* batch) {
+    for (;;) {
+      if (rows_taken >= row_limit) {
+        batch->begin = batch->end;
+        return false;
+      }
+      status = source.Next(batch_rows, batch);
+      if (!status.ok || batch->Rows() == 0) {
+        return false;
+      }
+      const auto skip = static_cast<std::size_t>(
+          std::min<int64_t>(rows_to_skip, static_cast<int64_t>(batch->Rows())));
+      rows_to_skip -= static_cast<int64_t>(skip);
+      batch->begin += skip;
+      batch->end = batch->begin + static_cast<std::size_t>(std::min<int64_t>(
+                                      static_cast<int64_t>(batch->Rows()), row_limit - rows_taken));
+      if (batch->Rows() == 0) {
+        continue;
+      }
+      rows_taken += static_cast<int64_t>(batch->Rows());
+      if (transform) {
+        Transform(columns, batch, transform, &status);
+      }
+      return status.ok;
+    }
+  };
+
+  RowBatch first;
+  const bool have_first = next_batch(&first);
+  if (!status.ok) {
+    return finish(status);
+  }
+  std::string header;
+  encoder->BeginStream(schema, &header);
+  status = sink.Write(header);
+  if (!status.ok) {
+    return finish(status);
+  }
+
+  const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+  const std::size_t thread_count =
+      config.parallelism > 0 ? static_cast<std::size_t>(config.parallelism) : hardware;
+  const std::size_t window = thread_count * 2;
+
+  enum class SlotState { kFree, kQueued, kEncoded };
+  struct Slot {
+    RowBatch batch;
+    int64_t first_row{0};
+    std::string out;
+    SlotState state{SlotState::kFree};
+  };
+  std::vector<Slot> slots(window);
+  std::deque<std::size_t> work;
+  std::mutex pipeline_mutex;
+  std::condition_variable work_cv;
+  std::condition_variable encoded_cv;
+  std::condition_variable free_cv;
+  std::size_t produced = 0;
+  bool producing_done = false;
+  bool stop_workers = false;
+  bool failed = false;
+  Status pipeline_status = Status::Ok();
+
+  auto fail = [&](Status error) {
+    std::lock_guard<std::mutex> lock(pipeline_mutex);
+    if (!failed) {
+      failed = true;
+      pipeline_status = std::move(error);
+    }
+    free_cv.notify_all();
+    encoded_cv.notify_all();
+  };
+
+  auto worker = [&] {
+    for (;;) {
+      std::size_t index = 0;
+      {
+        std::unique_lock<std::mutex> lock(pipeline_mutex);
+        work_cv.wait(lock, [&] { return stop_workers || !work.empty(); });
+        if (work.empty() || failed) {
+          return;
+        }
+        index = work.front();
+        work.pop_front();
+      }
+      Slot& slot = slots[index];
+      slot.out.clear();
+      Status encoded = encoder->EncodeBatch(slot.batch.Table(), slot.batch.begin, slot.batch.end,
+                                            slot.first_row, &slot.out);
+      slot.batch.owned = ColumnTable{};
+      if (!encoded.ok) {
+        fail(std::move(encoded));
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(pipeline_mutex);
+        slot.state = SlotState::kEncoded;
+      }
+      encoded_cv.notify_all();
+    }
+  };
+
+  int64_t rows_written = 0;
+  int64_t bytes_written = static_cast<int64_t>(header.size());
+  auto writer = [&] {
+    for (std::size_t sequence = 0;; ++sequence) {
+      Slot& slot = slots[sequence % window];
+      {
+        std::unique_lock<std::mutex> lock(pipeline_mutex);
+        encoded_cv.wait(lock, [&] {
+          return failed || slot.state == SlotState::kEncoded ||
+                 (producing_done && sequence == produced);
+        });
+        if (failed || slot.state != SlotState::kEncoded) {
+          return;
+        }
+      }
+      Status written = sink.Write(slot.out);
+      rows_written += static_cast<int64_t>(slot.batch.Rows());
+      bytes_written += static_cast<int64_t>(slot.out.size());
+      slot.out.clear();
+      {
+        std::lock_guard<std::mutex> lock(pipeline_mutex);
+        slot.state = SlotState::kFree;
+      }
+      free_cv.notify_all();
+      if (!written.ok) {
+        fail(written);
+        return;
+      }
+
+      const auto elapsed =
+          std::chrono::duration_cast<std::chrono::milliseconds>(SteadyClock::now() - started);
+      ExportProgress snapshot;
+      {
+        std::lock_guard<std::mutex> lock(control.mutex);
+        auto& progress = control.progress;
+        progress.rows_processed = rows_written;
+        progress.total_rows = std::max<int64_t>(0, total_rows);
+        progress.bytes_written = bytes_written;
+        progress.elapsed_time = elapsed;
+        progress.current_operation = "Writing rows";
+        if (elapsed.count() > 0) {
+          progress.rows_per_second =
+              static_cast<double>(rows_written) * 1000.0 / static_cast<double>(elapsed.count());
+        }
+        if (total_rows > 0) {
+          progress.percentage_complete =
+              std::min(100.0, 100.0 * static_cast<double>(rows_written) / total_rows);
+          if (progress.rows_per_second > 0) {
+            progress.estimated_remaining = std::chrono::milliseconds(static_cast<int64_t>(
+                static_cast<double>(std::max<int64_t>(0, total_rows - rows_written)) * 1000.0 /
+                progress.rows_per_second));
+          }
+        }
+        snapshot = progress;
+      }
+      if (on_progress) {
+        on_progress(snapshot);
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(thread_count);
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    workers.emplace_back(worker);
+  }
+  std::thread writer_thread(writer);
+
+  RowBatch batch = std::move(first);
+  bool have_batch = have_first;
+  int64_t next_first_row = 0;
+  while (have_batch) {
+    Slot& slot = slots[produced % window];
+    {
+      std::unique_lock<std::mutex> lock(pipeline_mutex);
+      free_cv.wait(lock, [&] { return failed || slot.state == SlotState::kFree; });
+      if (failed) {
+        break;
+      }
+    }
+    // A slot in kFree belongs to the producer alone
+    slot.batch = std::move(batch);
+    slot.first_row = next_first_row;
+    next_first_row += static_cast<int64_t>(slot.batch.Rows());
+    {
+      std::lock_guard<std::mutex> lock(pipeline_mutex);
+      slot.state = SlotState::kQueued;
+      work.push_back(produced % window);
+      ++produced;
+    }
+    work_cv.notify_one();
+
+    {
+      std::unique_lock<std::mutex> lock(control.mutex);
+      control.resume_cv.wait(lock, [&] { return !control.paused || control.cancelled; });
+    }
+    if (control.cancelled) {
+      status = Status::Error("Export cancelled");
+      break;
+    }
+    batch = RowBatch{};
+    have_batch = next_batch(&batch);
+  }
+  if (!status.ok) {
+    fail(status);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(pipeline_mutex);
+    producing_done = true;
+  }
+  encoded_cv.notify_all();
+  writer_thread.join();
+  {
+    std::lock_guard<std::mutex> lock(pipeline_mutex);
+    stop_workers = true;
+  }
+  work_cv.notify_all();
+  for (auto& thread : workers) {
+    thread.join();
+  }
+
+  status = pipeline_status;
+  if (status.ok) {
+    std::string footer;
+    encoder->EndStream(rows_written, &footer);
+    status = sink.Write(footer);
+    bytes_written += static_cast<int64_t>(footer.size());
+  }
+  result.total_rows = rows_written;
+  result.total_bytes = bytes_written;
+  return finish(status);
+}
+
+// Slow path for RowTransformCallback: rows go through string maps keyed by
+// source column name. Keys the callback drops keep their original value.
+void ExportManager::Impl::Transform(const std::vector<std::string>& columns, RowBatch* batch,
+                                    const RowTransformCallback& transform,
+                                    Status* status) const {
+  ColumnTable out;
+  out.SetColumnCount(columns.size());
+  std::map<std::string, std::string> row;
+  std::map<std::string, std::string> transformed;
+  const ColumnTable& table = batch->Table();
+  for (std::size_t r = batch->begin; r < batch->end; ++r) {
+    row.clear();
+    transformed.clear();
+    for (std::size_t c = 0; c < columns.size(); ++c) {
+      if (!table.Column(c).IsNull(r)) {
+        row[columns[c]] = table.Column(c).Format(r);
+      }
+    }
+    *status = transform(row, &transformed);
+    if (!status->ok) {
+      return;
+    }
+    for (std::size_t c = 0; c < columns.size(); ++c) {
+      auto it = transformed.find(columns[c]);
+      if (it != transformed.end()) {
+        out.Column(c).AppendText(it->second);
+      } else if (table.Column(c).IsNull(r)) {
+        out.Column(c).AppendNull();
+      } else {
+        out.Column(c).AppendText(table.Column(c).Format(r));
+      }
+    }
+    out.EndRow();
+  }
+  batch->owned = std::move(out);
+  batch->borrowed = nullptr;
+  batch->begin = 0;
+  batch->end = batch->owned.RowCount();
+}
+
 ExportManager::ExportManager()
     : impl_(std::make_unique<Impl>()) {
 }
@@ -29,72 +705,97 @@ ExportManager::ExportManager()
 ExportManager::~ExportManager() = default;
 
 ExportResult ExportManager::ExecuteExport(const ExportConfig& config) {
-  ExportResult result;
-  result.export_id = config.export_id;
-  result.status = Status::Ok();
-  
-  // Track active export
-  ExportProgress progress;
-  progress.export_id = config.export_id;
-  progress.status_message = "Starting export...";
-  progress.percent_complete = 0;
-  impl_->active_exports[config.export_id] = progress;
-  
-  if (impl_->progress_callback) {
-    impl_->progress_callback(progress);
-  }
-  
-  // Simulate export completion
-  result.output_path = config.output_path;
-  result.total_rows = 0;
-  result.completed_at = std::chrono::system_clock::now();
-  
-  // Move from active to completed
-  impl_->active_exports.erase(config.export_id);
-  impl_->completed_exports[config.export_id] = result;
-  
-  if (impl_->completion_callback) {
-    impl_->completion_callback(result);
-  }
-  
-  return result;
+  if (!config.connection || (config.source_query.empty() && config.source_table.empty())) {
+    ExportResult result;
+    result.export_id = config.export_id;
+    result.status = Status::Error("An export needs a connection and a source query or table");
+    return result;
+  }
+  Connection* connection = config.connection.get();
+
+  // A table export knows its size up front, which makes progress real
+  int64_t total_rows = -1;
+  if (config.source_query.empty() && config.where_clause.empty()) {
+    auto counted = connection->query("SELECT COUNT(*) FROM (" + BuildSourceQuery(config) +
+                                     ") AS export_count");
+    if (counted.success && counted.rows.RowCount() == 1 && counted.rows.ColumnCount() == 1) {
+      const auto& cell = counted.rows.Column(0);
+      if (!cell.IsNull(0) && cell.Type() == ColumnType::kInt64) {
+        total_rows = cell.Int64At(0);
+      }
+    }
+  }
+
+  CursorSource source(connection, BuildSourceQuery(config));
+  return impl_->Run(config, source, total_rows);
 }
 
 void ExportManager::ExecuteExportAsync(const ExportConfig& config) {
-  ExecuteExport(config);
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->async_threads.emplace_back([this, config] { ExecuteExport(config); });
 }
 
 ExportResult ExportManager::ExportResultSet(const ResultSet& result_set,
                                             const ExportConfig& config) {
-  (void)result_set;
-  return ExecuteExport(config);
+  bool transformed = false;
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    transformed = static_cast<bool>(impl_->row_transform_callback);
+  }
+  ResultSetSource source(result_set, transformed);
+  ExportConfig local = config;
+  local.connection.reset();  // Nothing to cancel server-side
+  return impl_->Run(local, source, static_cast<int64_t>(result_set.RowCount()));
 }
 
 void ExportManager::CancelExport(const std::string& export_id) {
-  (void)export_id;
+  if (auto control = impl_->Find(export_id)) {
+    {
+      std::lock_guard<std::mutex> lock(control->mutex);
+      control->cancelled = true;
+      control->paused = false;
+      control->progress.status_message = "Cancelled";
+    }
+    control->resume_cv.notify_all();
+    if (Connection* connection = control->connection.load()) {
+      connection->cancel();
+    }
+  }
 }
 
 void ExportManager::PauseExport(const std::string& export_id) {
-  (void)export_id;
+  if (auto control = impl_->Find(export_id)) {
+    std::lock_guard<std::mutex> lock(control->mutex);
+    control->paused = true;
+    control->progress.status_message = "Paused";
+  }
 }
 
 void ExportManager::ResumeExport(const std::string& export_id) {
-  (void)export_id;
+  if (auto control = impl_->Find(export_id)) {
+    {
+      std::lock_guard<std::mutex> lock(control->mutex);
+      control->paused = false;
+      control->progress.status_message = "Resumed";
+    }
+    control->resume_cv.notify_all();
+  }
 }
 
 bool ExportManager::IsExportRunning(const std::string& export_id) const {
-  return impl_->active_exports.find(export_id) != impl_->active_exports.end();
+  return impl_->Find(export_id) != nullptr;
 }
 
 ExportProgress ExportManager::GetProgress(const std::string& export_id) const {
-  auto it = impl_->active_exports.find(export_id);
-  if (it != impl_->active_exports.end()) {
-    return it->second;
+  if (auto control = impl_->Find(export_id)) {
+    std::lock_guard<std::mutex> lock(control->mutex);
+    return control->progress;
   }
   return ExportProgress{};
 }
 
 std::optional<ExportResult> ExportManager::GetResult(const std::string& export_id) {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   auto it = impl_->completed_exports.find(export_id);
   if (it != impl_->completed_exports.end()) {
     return it->second;
@@ -103,15 +804,18 @@ std::optional<ExportResult> ExportManager::GetResult(const std::string& export_i
 }
 
 void ExportManager::SetProgressCallback(ProgressCallback callback) {
-  impl_->progress_callback = callback;
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->progress_callback = std::move(callback);
 }
 
 void ExportManager::SetCompletionCallback(CompletionCallback callback) {
-  impl_->completion_callback = callback;
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->completion_callback = std::move(callback);
 }
 
 void ExportManager::SetRowTransformCallback(RowTransformCallback callback) {
-  impl_->row_transform_callback = callback;
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->row_transform_callback = std::move(callback);
 }
 
 Status ExportManager::SaveTemplate(const std::string& name,
@@ -123,12 +827,14 @@ Status ExportManager::SaveTemplate(const std::string& name,
   tmpl.description = description;
   tmpl.config = config;
   tmpl.created_at = std::chrono::system_clock::now();
-  
+
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   impl_->templates.push_back(tmpl);
   return Status::Ok();
 }
 
 Status ExportManager::DeleteTemplate(const std::string& template_id) {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   for (auto it = impl_->templates.begin(); it != impl_->templates.end(); ++it) {
     if (it->template_id == template_id) {
       impl_->templates.erase(it);
@@ -139,10 +845,12 @@ Status ExportManager::DeleteTemplate(const std::string& template_id) {
 }
 
 std::vector<ExportTemplate> ExportManager::ListTemplates() const {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   return impl_->templates;
 }
 
 std::optional<ExportTemplate> ExportManager::GetTemplate(const std::string& template_id) const {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   for (const auto& tmpl : impl_->templates) {
     if (tmpl.template_id == template_id) {
       return tmpl;
@@ -155,14 +863,14 @@ ExportResult ExportManager::ExportUsingTemplate(
     const std::string& template_id,
     const std::map<std::string, std::string>& params) {
   (void)params;
-  
+
   auto tmpl = GetTemplate(template_id);
   if (!tmpl) {
     ExportResult result;
     result.status = Status::Error("Template not found");
     return result;
   }
-  
+
   return ExecuteExport(tmpl->config);
 }
 
@@ -170,16 +878,14 @@ ExportResult ExportManager::ExportToCSV(const std::string& query,
                                         std::shared_ptr<Connection> connection,
                                         const std::string& output_path,
                                         const CSVExportOptions& options) {
-  (void)query;
-  (void)connection;
-  (void)options;
-  
   ExportConfig config;
   config.export_id = "csv_export";
+  config.source_query = query;
+  config.connection = std::move(connection);
   config.format = ExportFormat::kCSV;
   config.output_path = output_path;
   config.csv_options = options;
-  
+
   return ExecuteExport(config);
 }
 
@@ -187,16 +893,14 @@ ExportResult ExportManager::ExportToJSON(const std::string& query,
                                          std::shared_ptr<Connection> connection,
                                          const std::string& output_path,
                                          const JSONExportOptions& options) {
-  (void)query;
-  (void)connection;
-  (void)options;
-  
   ExportConfig config;
   config.export_id = "json_export";
+  config.source_query = query;
+  config.connection = std::move(connection);
   config.format = ExportFormat::kJSON;
   config.output_path = output_path;
   config.json_options = options;
-  
+
   return ExecuteExport(config);
 }
 
@@ -204,16 +908,14 @@ ExportResult ExportManager::ExportToExcel(const std::string& query,
                                           std::shared_ptr<Connection> connection,
                                           const std::string& output_path,
                                           const ExcelExportOptions& options) {
-  (void)query;
-  (void)connection;
-  (void)options;
-  
   ExportConfig config;
   config.export_id = "excel_export";
+  config.source_query = query;
+  config.connection = std::move(connection);
   config.format = ExportFormat::kExcel;
   config.output_path = output_path;
   config.excel_options = options;
-  
+
   return ExecuteExport(config);
 }
 
@@ -221,26 +923,31 @@ ExportResult ExportManager::ExportToSQL(const std::string& query,
                                         std::shared_ptr<Connection> connection,
                                         const std::string& output_path,
                                         const SQLExportOptions& options) {
-  (void)query;
-  (void)connection;
-  (void)options;
-  
   ExportConfig config;
   config.export_id = "sql_export";
+  config.source_query = query;
+  config.connection = std::move(connection);
   config.format = ExportFormat::kSQL;
   config.output_path = output_path;
   config.sql_options = options;
-  
+
   return ExecuteExport(config);
 }
 
 Status ExportManager::PreviewExport(const ExportConfig& config,
                                     int max_rows,
                                     std::string* preview_data) {
-  (void)config;
-  (void)max_rows;
-  (void)preview_data;
-  return Status::Ok();
+  if (!config.connection || !preview_data) {
+    return Status::Error("A connection is required");
+  }
+  ExportConfig local = config;
+  local.max_rows = config.max_rows > 0 ? std::min<int64_t>(config.max_rows, max_rows) : max_rows;
+  local.parallelism = 1;
+  preview_data->clear();
+  CursorSource source(local.connection.get(), BuildSourceQuery(local));
+  StringSink sink(preview_data);
+  ExportControl control;
+  return impl_->Stream(local, control, source, sink, -1).status;
 }
 
 Status ExportManager::ExportConfigToFile(const ExportConfig& config,
@@ -258,12 +965,19 @@ Status ExportManager::ImportConfigFromFile(const std::string& file_path,
 }
 
 void ExportManager::ClearCompletedExports() {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   impl_->completed_exports.clear();
 }
 
 void ExportManager::ClearAllExports() {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   impl_->completed_exports.clear();
-  impl_->active_exports.clear();
+  for (auto& [id, control] : impl_->active_exports) {
+    (void)id;
+    control->cancelled = true;
+    control->paused = false;
+    control->resume_cv.notify_all();
+  }
 }
 
 }  // namespace scratchrobin::core
@@ -18,13 +18,14 @@
 #include <string>
 #include <vector>
 
+#include "backend/scratchbird_connection.h"
 #include "core/result_set.h"
 #include "core/status.h"
 
 namespace scratchrobin::core {
 
-// Forward declarations
-class Connection;
+// Exports read through backend connections (same alias as the importer)
+using Connection = backend::ScratchbirdConnection;
 
 // Export format types
 enum class ExportFormat {
@@ -34,6 +35,7 @@ enum class ExportFormat {
   kExcel,
   kSQL,
   kParquet,
+  kArrow,  // Arrow IPC stream
   kMarkdown,
   kHTML,
   kPDF,
@@ -93,6 +95,15 @@ struct SQLExportOptions {
   bool quote_identifiers{true};
 };
 
+// Parquet / Arrow options. Each batch of row_group_rows rows becomes one
+// Parquet row group or Arrow record batch.
+struct ColumnarExportOptions {
+  int64_t row_group_rows{131072};
+  size_t page_bytes{1024 * 1024};        // Parquet data page target
+  bool use_dictionary{true};             // Parquet dictionary encoding
+  size_t dictionary_bytes{1024 * 1024};  // Larger dictionaries fall back to PLAIN
+};
+
 // Column export configuration
 struct ExportColumn {
   std::string name;
@@ -122,6 +133,7 @@ struct ExportConfig {
   JSONExportOptions json_options;
   ExcelExportOptions excel_options;
   SQLExportOptions sql_options;
+  ColumnarExportOptions columnar_options;
   std::map<std::string, std::string> custom_options;
   
   // Data options
@@ -131,9 +143,13 @@ struct ExportConfig {
   std::string order_by;
   
   // Performance
-  int batch_size{1000};
+  int batch_size{1000};  // Rows per cursor fetch and per encoded batch
+  int parallelism{0};    // Encoder threads; 0 = hardware concurrency
+  // Compression runs on its own threads (parallelism of them) behind the
+  // writer; the format's extension is added to output_path if missing
   bool compress_output{false};
-  std::string compression_format;  // "gzip", "zip"
+  std::string compression_format;  // "gzip" (default), "zstd", "zip"
+  int compression_level{0};        // 0 = format default
 };
 
 // Export progress
@@ -178,6 +194,17 @@ struct ExportTemplate {
 // ExportManager
 // ============================================================================
 
+/**
+ * ExportManager - streaming exports to CSV, JSON, SQL, Parquet and Arrow
+ *
+ * Rows are pulled from a server cursor batch_size at a time (Parquet and
+ * Arrow: row_group_rows, one row group or record batch each), encoded on a
+ * pool of threads into reusable buffers and written in order with large
+ * sequential writes. At most two batches per encoder are in flight, so
+ * memory stays flat however large the table. With compress_output the
+ * writer feeds a compressing sink (see core/output_sink.h). Files are
+ * written under a ".part" name and renamed once complete.
+ */
 class ExportManager {
  public:
   using ProgressCallback = std::function<void(const ExportProgress&)>;
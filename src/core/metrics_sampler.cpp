@@ -0,0 +1,329 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/metrics_sampler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+namespace scratchrobin::core {
+
+namespace {
+
+int64_t Milliseconds(MetricsSampler::Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+}
+
+// Column |name| of the first row; 0 when missing or NULL
+int64_t FirstRowInt(const ResultSet& result, const std::string& name) {
+  if (result.RowCount() == 0) {
+    return 0;
+  }
+  for (std::size_t col = 0; col < result.ColumnCount(); ++col) {
+    if (result.columns[col] != name || result.Column(col).IsNull(0)) {
+      continue;
+    }
+    const ColumnBuffer& column = result.Column(col);
+    if (column.Type() == ColumnType::kInt64) {
+      return column.Int64At(0);
+    }
+    // SUM() of bigints may come back as numeric text
+    return std::strtoll(column.Format(0).c_str(), nullptr, 10);
+  }
+  return 0;
+}
+
+}  // namespace
+
+MetricsSampler::MetricsSampler(QueryFunction query, MetricsSamplerOptions options)
+    : query_(std::move(query)), options_(options) {
+  thread_ = std::thread(&MetricsSampler::Run, this);
+}
+
+MetricsSampler::~MetricsSampler() {
+  Stop();
+}
+
+void MetricsSampler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+    thread_.join();
+  }
+}
+
+void MetricsSampler::AddSource(const std::string& name, std::string sql) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sources_[name].sql = std::move(sql);
+}
+
+bool MetricsSampler::HasSource(const std::string& name) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sources_.count(name) != 0;
+}
+
+uint64_t MetricsSampler::Subscribe(const std::string& source, int64_t interval_ms,
+                                   Callback callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sources_.find(source);
+  if (it == sources_.end() || !callback) {
+    return 0;
+  }
+  const bool first = !HasSubscribers(source);
+  const uint64_t id = next_id_++;
+  Subscription subscription;
+  subscription.source = source;
+  subscription.interval_ms = std::max<int64_t>(interval_ms, 0);
+  subscription.callback = std::make_shared<Callback>(std::move(callback));
+  subscriptions_.emplace(id, std::move(subscription));
+
+  Source& state = it->second;
+  const auto now = Clock::now();
+  if (first || !state.sampled) {
+    if (state.pending) {
+      ++state.stats.coalesced;
+    }
+    state.pending = true;
+    state.due = now;
+  } else if (interval_ms > 0) {
+    // A shorter interval takes effect from now, not after the current one
+    state.due = std::min(state.due, now + std::chrono::milliseconds(interval_ms));
+  }
+  wake_.notify_all();
+  return id;
+}
+
+void MetricsSampler::Unsubscribe(uint64_t id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  subscriptions_.erase(id);
+  if (std::this_thread::get_id() != thread_.get_id()) {
+    delivered_.wait(lock, [this, id]() { return delivering_ != id; });
+  }
+}
+
+void MetricsSampler::RequestRefresh(const std::string& source) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sources_.find(source);
+  if (it == sources_.end()) {
+    return;
+  }
+  if (it->second.pending) {
+    ++it->second.stats.coalesced;
+    return;
+  }
+  it->second.pending = true;
+  it->second.due = Clock::now();
+  wake_.notify_all();
+}
+
+MetricSourceStats MetricsSampler::Stats(const std::string& source) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sources_.find(source);
+  if (it == sources_.end()) {
+    return MetricSourceStats();
+  }
+  MetricSourceStats stats = it->second.stats;
+  stats.interval_ms = EffectiveInterval(source, it->second);
+  return stats;
+}
+
+int64_t MetricsSampler::BaseInterval(const std::string& source) const {
+  int64_t interval = 0;
+  for (const auto& [id, subscription] : subscriptions_) {
+    (void)id;
+    if (subscription.source == source && subscription.interval_ms > 0 &&
+        (interval == 0 || subscription.interval_ms < interval)) {
+      interval = subscription.interval_ms;
+    }
+  }
+  return interval;
+}
+
+bool MetricsSampler::HasSubscribers(const std::string& source) const {
+  for (const auto& [id, subscription] : subscriptions_) {
+    (void)id;
+    if (subscription.source == source) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int64_t MetricsSampler::EffectiveInterval(const std::string& source, const Source& state) const {
+  const int64_t base = BaseInterval(source);
+  if (base == 0) {
+    return 0;
+  }
+  return std::max(base, std::min(base * state.backoff, options_.max_interval_ms));
+}
+
+void MetricsSampler::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    // The most overdue source that is polled, or refreshed for a listener
+    std::string next;
+    Clock::time_point when;
+    for (const auto& [name, source] : sources_) {
+      if (BaseInterval(name) == 0 && !(source.pending && HasSubscribers(name))) {
+        continue;
+      }
+      if (next.empty() || source.due < when) {
+        next = name;
+        when = source.due;
+      }
+    }
+    if (next.empty()) {
+      wake_.wait(lock);
+    } else if (when > Clock::now()) {
+      wake_.wait_until(lock, when);
+    } else {
+      Collect(lock, next);
+    }
+  }
+}
+
+void MetricsSampler::Collect(std::unique_lock<std::mutex>& lock, const std::string& name) {
+  Source& source = sources_[name];  // Sources are never removed
+  source.pending = false;
+  const std::string sql = source.sql;
+  const auto started = Clock::now();
+  const auto taken_at = std::chrono::system_clock::now();
+
+  lock.unlock();
+  auto result = std::make_shared<ResultSet>();
+  Status status = query_ ? query_(sql, result.get()) : Status::Error("No connection");
+  const int64_t elapsed = Milliseconds(Clock::now() - started);
+  lock.lock();
+
+  ++source.stats.queries;
+  source.stats.last_elapsed_ms = elapsed;
+  if (!status.ok) {
+    ++source.stats.failures;
+    result = std::make_shared<ResultSet>();
+  }
+
+  // Back off while the server is slow to answer, recover a step at a time
+  const int64_t base = BaseInterval(name);
+  if (base > 0) {
+    const double budget = static_cast<double>(base * source.backoff) * options_.load_fraction;
+    if (!status.ok || static_cast<double>(elapsed) > budget) {
+      if (base * source.backoff < options_.max_interval_ms) {
+        source.backoff *= 2;
+      }
+    } else if (static_cast<double>(elapsed) < budget / 2 && source.backoff > 1) {
+      source.backoff /= 2;
+    }
+  }
+  const int64_t interval = EffectiveInterval(name, source);
+  source.sampled = true;
+  if (!source.pending) {  // A refresh requested meanwhile runs right away
+    source.due = started + std::chrono::milliseconds(interval);
+  }
+
+  MetricSample sample;
+  sample.source = name;
+  sample.status = std::move(status);
+  sample.result = std::move(result);
+  sample.taken_at = taken_at;
+  sample.elapsed_ms = elapsed;
+  sample.interval_ms = interval;
+  sample.sequence = ++source.sequence;
+
+  std::vector<std::pair<uint64_t, std::shared_ptr<Callback>>> targets;
+  for (const auto& [id, subscription] : subscriptions_) {
+    if (subscription.source == name) {
+      targets.emplace_back(id, subscription.callback);
+    }
+  }
+  for (const auto& [id, callback] : targets) {
+    if (stopping_ || subscriptions_.count(id) == 0) {
+      continue;
+    }
+    delivering_ = id;
+    lock.unlock();
+    (*callback)(sample);
+    lock.lock();
+    delivering_ = 0;
+    delivered_.notify_all();
+  }
+}
+
+// ============================================================================
+// Server stat sources
+// ============================================================================
+
+void AddServerStatSources(MetricsSampler* sampler) {
+  sampler->AddSource(
+      kMetricSessions,
+      "SELECT pid, usename, datname, client_addr::text AS client_addr, application_name, "
+      "state, query, backend_xid::text AS xid, "
+      "(EXTRACT(EPOCH FROM backend_start) * 1000)::bigint AS backend_start_ms, "
+      "(EXTRACT(EPOCH FROM xact_start) * 1000)::bigint AS xact_start_ms, "
+      "(EXTRACT(EPOCH FROM (now() - query_start)) * 1000)::bigint AS query_ms, "
+      "(EXTRACT(EPOCH FROM (now() - xact_start)) * 1000)::bigint AS xact_ms, "
+      "wait_event_type "
+      "FROM pg_stat_activity "
+      "WHERE pid <> pg_backend_pid() AND backend_type = 'client backend' "
+      "ORDER BY pid");
+  sampler->AddSource(
+      kMetricLocks,
+      "SELECT l.locktype, l.mode, l.granted, l.pid, l.relation::regclass::text AS relation, "
+      "l.transactionid::text AS transactionid, "
+      "array_to_string(pg_blocking_pids(l.pid), ',') AS blocked_by "
+      "FROM pg_locks l "
+      "WHERE l.pid <> pg_backend_pid() "
+      "ORDER BY l.granted, l.pid");
+  sampler->AddSource(
+      kMetricDatabase,
+      "SELECT SUM(numbackends)::bigint AS backends, "
+      "SUM(xact_commit + xact_rollback)::bigint AS transactions, "
+      "SUM(blks_hit)::bigint AS blocks_hit, SUM(blks_read)::bigint AS blocks_read, "
+      "SUM(tup_returned + tup_fetched + tup_inserted + tup_updated + tup_deleted)::bigint "
+      "AS rows "
+      "FROM pg_stat_database");
+}
+
+bool DatabaseActivity::FromSample(const MetricSample& sample, DatabaseActivity* activity) {
+  if (!sample.status.ok || !sample.result || sample.result->RowCount() == 0) {
+    return false;
+  }
+  const ResultSet& result = *sample.result;
+  activity->backends = FirstRowInt(result, "backends");
+  activity->transactions = FirstRowInt(result, "transactions");
+  activity->blocks_hit = FirstRowInt(result, "blocks_hit");
+  activity->blocks_read = FirstRowInt(result, "blocks_read");
+  activity->rows = FirstRowInt(result, "rows");
+  activity->taken_at = sample.taken_at;
+  return true;
+}
+
+DatabaseRates DatabaseRates::Between(const DatabaseActivity& earlier,
+                                     const DatabaseActivity& later) {
+  DatabaseRates rates;
+  const double seconds =
+      std::chrono::duration<double>(later.taken_at - earlier.taken_at).count();
+  // Counters go back to zero when the statistics are reset
+  auto delta = [](int64_t from, int64_t to) {
+    return static_cast<double>(std::max<int64_t>(to - from, 0));
+  };
+  const double hits = delta(earlier.blocks_hit, later.blocks_hit);
+  const double reads = delta(earlier.blocks_read, later.blocks_read);
+  rates.cache_hit_ratio = hits + reads > 0 ? hits * 100.0 / (hits + reads) : 100.0;
+  if (seconds <= 0) {
+    return rates;
+  }
+  rates.transactions_per_sec = delta(earlier.transactions, later.transactions) / seconds;
+  rates.rows_per_sec = delta(earlier.rows, later.rows) / seconds;
+  rates.blocks_hit_per_sec = hits / seconds;
+  rates.blocks_read_per_sec = reads / seconds;
+  return rates;
+}
+
+}  // namespace scratchrobin::core
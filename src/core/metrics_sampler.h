@@ -0,0 +1,174 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/result_set.h"
+#include "core/status.h"
+
+namespace scratchrobin::core {
+
+// One collection of a stat source, shared by every subscriber
+struct MetricSample {
+  std::string source;
+  Status status;
+  std::shared_ptr<const ResultSet> result;  // Never null; empty on error
+  std::chrono::system_clock::time_point taken_at;
+  int64_t elapsed_ms = 0;
+  int64_t interval_ms = 0;  // Interval in effect, backoff included
+  uint64_t sequence = 0;    // Per source, from 1
+};
+
+struct MetricsSamplerOptions {
+  // A collection taking longer than this fraction of its interval, or
+  // failing, doubles the interval; one under half of it halves the
+  // backoff again
+  double load_fraction = 0.25;
+  int64_t max_interval_ms = 60000;
+};
+
+struct MetricSourceStats {
+  int64_t queries = 0;
+  int64_t coalesced = 0;    // Refresh requests absorbed by a pending one
+  int64_t failures = 0;
+  int64_t interval_ms = 0;  // 0 while nobody polls it
+  int64_t last_elapsed_ms = 0;
+};
+
+/**
+ * MetricsSampler - polls stat sources for any number of subscribers
+ *
+ * Each source is one query, run on a single background thread through the
+ * sampler's own connection. A source is polled at the shortest interval of
+ * its subscribers, so ten panels watching it cost one query per interval,
+ * and not at all once the last one unsubscribes. RequestRefresh() moves a
+ * source's next collection to now; requests arriving before it runs are
+ * merged into it. Slow or failing collections stretch the interval until
+ * the server keeps up again.
+ *
+ * Callbacks run on the sampler thread, one at a time; post to a GUI thread
+ * from there. Once Unsubscribe() returns, its callback is not running and
+ * will not run again.
+ */
+class MetricsSampler {
+ public:
+  using QueryFunction = std::function<Status(const std::string& sql, ResultSet* result)>;
+  using Callback = std::function<void(const MetricSample& sample)>;
+  using Clock = std::chrono::steady_clock;
+
+  explicit MetricsSampler(QueryFunction query,
+                          MetricsSamplerOptions options = MetricsSamplerOptions());
+  ~MetricsSampler();
+
+  MetricsSampler(const MetricsSampler&) = delete;
+  MetricsSampler& operator=(const MetricsSampler&) = delete;
+
+  // Replaces the query of an existing source
+  void AddSource(const std::string& name, std::string sql);
+  bool HasSource(const std::string& name) const;
+
+  // The first subscriber of a source, or one arriving before its first
+  // collection, triggers a refresh; later ones get the next sample. An
+  // interval of 0 subscribes passively: the samples others cause arrive,
+  // but only RequestRefresh() causes one. Returns 0 for an unknown source.
+  uint64_t Subscribe(const std::string& source, int64_t interval_ms, Callback callback);
+  void Unsubscribe(uint64_t id);
+
+  void RequestRefresh(const std::string& source);
+
+  MetricSourceStats Stats(const std::string& source) const;
+
+  // Joins the sampler thread; no callback runs afterwards
+  void Stop();
+
+ private:
+  struct Subscription {
+    std::string source;
+    int64_t interval_ms = 0;
+    std::shared_ptr<Callback> callback;
+  };
+
+  struct Source {
+    std::string sql;
+    Clock::time_point due;
+    int64_t backoff = 1;  // Multiplier of the subscribed interval
+    bool pending = false;  // A refresh is waiting to run
+    bool sampled = false;
+    uint64_t sequence = 0;
+    MetricSourceStats stats;
+  };
+
+  void Run();
+  void Collect(std::unique_lock<std::mutex>& lock, const std::string& name);
+  int64_t BaseInterval(const std::string& source) const;  // 0: nobody polls
+  bool HasSubscribers(const std::string& source) const;
+  int64_t EffectiveInterval(const std::string& source, const Source& state) const;
+
+  QueryFunction query_;
+  MetricsSamplerOptions options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable delivered_;
+  std::map<std::string, Source> sources_;
+  std::map<uint64_t, Subscription> subscriptions_;
+  uint64_t next_id_ = 1;
+  uint64_t delivering_ = 0;  // Subscription whose callback is running
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+// ============================================================================
+// Server stat sources
+// ============================================================================
+
+// One row per other client session: pid, usename, datname, client_addr,
+// application_name, state, query, xid, backend_start_ms and xact_start_ms
+// (since the epoch), query_ms and xact_ms (elapsed), wait_event_type
+inline constexpr char kMetricSessions[] = "sessions";
+// One row per lock: locktype, mode, granted, pid, relation, transactionid,
+// blocked_by (comma-separated pids)
+inline constexpr char kMetricLocks[] = "locks";
+// One row of cumulative counters summed over databases
+inline constexpr char kMetricDatabase[] = "database";
+
+void AddServerStatSources(MetricsSampler* sampler);
+
+// The counters of a kMetricDatabase sample
+struct DatabaseActivity {
+  int64_t backends = 0;
+  int64_t transactions = 0;
+  int64_t blocks_hit = 0;
+  int64_t blocks_read = 0;
+  int64_t rows = 0;
+  std::chrono::system_clock::time_point taken_at;
+
+  static bool FromSample(const MetricSample& sample, DatabaseActivity* activity);
+};
+
+// Per-second rates between two kMetricDatabase samples
+struct DatabaseRates {
+  double transactions_per_sec = 0.0;
+  double rows_per_sec = 0.0;
+  double blocks_hit_per_sec = 0.0;
+  double blocks_read_per_sec = 0.0;
+  double cache_hit_ratio = 0.0;  // Percent, of the interval's block accesses
+
+  static DatabaseRates Between(const DatabaseActivity& earlier, const DatabaseActivity& later);
+};
+
+}  // namespace scratchrobin::core
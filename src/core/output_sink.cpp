@@ -0,0 +1,693 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/output_sink.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(SCRATCHROBIN_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace scratchrobin::core {
+
+namespace {
+
+constexpr std::size_t kWriteChunkBytes = 4 * 1024 * 1024;
+constexpr std::size_t kDeflateWindowBytes = 32 * 1024;
+constexpr std::size_t kMaxBlockBytes = 64 * 1024 * 1024;
+
+int ResolveThreads(int threads) {
+  if (threads > 0) {
+    return threads;
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void PutU16(std::string* out, std::uint32_t value) {
+  out->push_back(static_cast<char>(value & 0xFF));
+  out->push_back(static_cast<char>((value >> 8) & 0xFF));
+}
+
+void PutU32(std::string* out, std::uint32_t value) {
+  PutU16(out, value & 0xFFFF);
+  PutU16(out, value >> 16);
+}
+
+void PutU64(std::string* out, std::uint64_t value) {
+  PutU32(out, static_cast<std::uint32_t>(value));
+  PutU32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+}  // namespace
+
+// ============================================================================
+// FileSink
+// ============================================================================
+
+FileSink::~FileSink() {
+  if (file_) {
+    Finish(false);
+  }
+}
+
+Status FileSink::Open(const std::string& path) {
+  path_ = path;
+  part_path_ = path + ".part";
+  file_ = std::fopen(part_path_.c_str(), "wb");
+  if (!file_) {
+    return Status::Error("Cannot create file: " + part_path_);
+  }
+  std::setvbuf(file_, nullptr, _IONBF, 0);
+  staging_.reserve(kWriteChunkBytes);
+  return Status::Ok();
+}
+
+Status FileSink::Write(std::string_view data) {
+  if (staging_.size() + data.size() <= kWriteChunkBytes) {
+    staging_.append(data);
+    return Status::Ok();
+  }
+  Status flushed = Flush();
+  if (!flushed.ok) {
+    return flushed;
+  }
+  if (data.size() >= kWriteChunkBytes) {
+    return WriteAll(data);
+  }
+  staging_.append(data);
+  return Status::Ok();
+}
+
+Status FileSink::Finish(bool success) {
+  Status status = success ? Flush() : Status::Ok();
+  if (file_ && std::fclose(file_) != 0 && status.ok) {
+    status = Status::Error("Cannot close file: " + part_path_);
+  }
+  file_ = nullptr;
+  std::error_code ec;
+  if (success && status.ok) {
+    std::filesystem::rename(part_path_, path_, ec);
+    if (ec) {
+      status = Status::Error("Cannot rename " + part_path_ + ": " + ec.message());
+    }
+  }
+  if (!success || !status.ok) {
+    std::filesystem::remove(part_path_, ec);
+  }
+  return status;
+}
+
+Status FileSink::Flush() {
+  Status status = WriteAll(staging_);
+  staging_.clear();
+  return status;
+}
+
+Status FileSink::WriteAll(std::string_view data) {
+  if (!data.empty() && std::fwrite(data.data(), 1, data.size(), file_) != data.size()) {
+    return Status::Error("Write failed: " + part_path_);
+  }
+  return Status::Ok();
+}
+
+namespace {
+
+// ============================================================================
+// Parallel deflate
+// ============================================================================
+
+// Cuts the input into blocks and deflates them on a pool of threads. Each
+// block is primed with the 32 KiB before it and ends on a sync flush (the
+// last one on Z_FINISH), so the outputs concatenate into a single raw
+// deflate stream; block CRCs are merged with crc32_combine(). Subclasses
+// add the container around it.
+class ParallelDeflateSink : public OutputSink {
+ public:
+  ParallelDeflateSink(std::unique_ptr<OutputSink> inner, const CompressionOptions& options)
+      : inner_(std::move(inner)),
+        level_(options.level > 0 ? std::min(options.level, 9) : Z_DEFAULT_COMPRESSION),
+        block_bytes_(std::clamp<std::size_t>(options.block_bytes, kDeflateWindowBytes,
+                                             kMaxBlockBytes)),
+        threads_(ResolveThreads(options.threads)),
+        window_(2 * static_cast<std::size_t>(threads_)) {
+    current_.reserve(block_bytes_);
+    if (threads_ > 1) {
+      workers_.reserve(threads_);
+      for (int i = 0; i < threads_; ++i) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+      }
+    }
+  }
+
+  ~ParallelDeflateSink() override {
+    StopWorkers();
+    if (!finished_) {
+      inner_->Finish(false);
+    }
+  }
+
+  Status Write(std::string_view data) override {
+    while (!data.empty() && error_.ok) {
+      const std::size_t take = std::min(block_bytes_ - current_.size(), data.size());
+      current_.append(data.substr(0, take));
+      data.remove_prefix(take);
+      if (current_.size() == block_bytes_) {
+        Dispatch(false);
+      }
+    }
+    return error_;
+  }
+
+  Status Finish(bool success) override {
+    if (finished_) {
+      return Status::Ok();
+    }
+    finished_ = true;
+    if (success && error_.ok) {
+      Dispatch(true);
+    }
+    Drain(true);
+    StopWorkers();
+    Status status = success ? error_ : Status::Ok();
+    if (success && status.ok) {
+      status = WriteHeader();
+    }
+    if (success && status.ok) {
+      status = inner_->Write(Trailer(crc_, raw_bytes_, deflated_bytes_, header_bytes_));
+    }
+    Status closed = inner_->Finish(success && status.ok);
+    return status.ok ? closed : status;
+  }
+
+ protected:
+  virtual std::string Header() = 0;
+  virtual std::string Trailer(std::uint32_t crc, std::uint64_t raw_bytes,
+                              std::uint64_t deflated_bytes, std::uint64_t header_bytes) = 0;
+
+ private:
+  struct Block {
+    std::string input;  // Dictionary, then the block's own bytes
+    std::size_t dictionary_bytes{0};
+    bool last{false};
+    std::string output;
+    std::uint32_t crc{0};
+    Status status = Status::Ok();
+    bool done{false};  // Guarded by mutex_ while workers run
+  };
+
+  void Dispatch(bool last) {
+    auto block = std::make_unique<Block>();
+    block->input.reserve(tail_.size() + current_.size());
+    block->input.append(tail_).append(current_);
+    block->dictionary_bytes = tail_.size();
+    block->last = last;
+    const std::size_t keep = std::min(block->input.size(), kDeflateWindowBytes);
+    tail_.assign(block->input, block->input.size() - keep, keep);
+    current_.clear();
+
+    if (workers_.empty()) {
+      Compress(*block);
+      block->done = true;
+      in_flight_.push_back(std::move(block));
+    } else {
+      std::lock_guard<std::mutex> lock(mutex_);
+      queue_.push_back(block.get());
+      in_flight_.push_back(std::move(block));
+      work_cv_.notify_one();
+    }
+    Drain(false);
+  }
+
+  // Writes finished blocks in order. Waits for the oldest block when
+  // |all| is set or more than |window_| blocks are in flight.
+  void Drain(bool all) {
+    for (;;) {
+      std::unique_ptr<Block> block;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (in_flight_.empty()) {
+          return;
+        }
+        if (!in_flight_.front()->done) {
+          if (!all && in_flight_.size() <= window_) {
+            return;
+          }
+          done_cv_.wait(lock, [this] { return in_flight_.front()->done; });
+        }
+        block = std::move(in_flight_.front());
+        in_flight_.pop_front();
+      }
+      Emit(*block);
+    }
+  }
+
+  void Emit(const Block& block) {
+    if (!error_.ok) {
+      return;
+    }
+    if (!block.status.ok) {
+      error_ = block.status;
+      return;
+    }
+    error_ = WriteHeader();
+    if (error_.ok) {
+      error_ = inner_->Write(block.output);
+    }
+    const std::size_t raw = block.input.size() - block.dictionary_bytes;
+    crc_ = static_cast<std::uint32_t>(crc32_combine(crc_, block.crc, static_cast<z_off_t>(raw)));
+    raw_bytes_ += raw;
+    deflated_bytes_ += block.output.size();
+  }
+
+  Status WriteHeader() {
+    if (header_bytes_ > 0) {
+      return Status::Ok();
+    }
+    const std::string header = Header();
+    header_bytes_ = header.size();
+    return inner_->Write(header);
+  }
+
+  void Compress(Block& block) const {
+    z_stream stream{};
+    if (deflateInit2(&stream, level_, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      block.status = Status::Error("Cannot initialize deflate");
+      return;
+    }
+    const auto* input = reinterpret_cast<const Bytef*>(block.input.data());
+    if (block.dictionary_bytes > 0) {
+      deflateSetDictionary(&stream, input, static_cast<uInt>(block.dictionary_bytes));
+    }
+    const std::size_t raw = block.input.size() - block.dictionary_bytes;
+    block.crc = static_cast<std::uint32_t>(
+        crc32(0, input + block.dictionary_bytes, static_cast<uInt>(raw)));
+
+    stream.next_in = const_cast<Bytef*>(input + block.dictionary_bytes);
+    stream.avail_in = static_cast<uInt>(raw);
+    const int flush = block.last ? Z_FINISH : Z_SYNC_FLUSH;
+    block.output.resize(deflateBound(&stream, static_cast<uLong>(raw)) + 16);
+    std::size_t used = 0;
+    for (;;) {
+      stream.next_out = reinterpret_cast<Bytef*>(block.output.data() + used);
+      stream.avail_out = static_cast<uInt>(block.output.size() - used);
+      const int rc = deflate(&stream, flush);
+      used = block.output.size() - stream.avail_out;
+      if (rc == Z_STREAM_ERROR) {
+        block.status = Status::Error("Deflate failed");
+        break;
+      }
+      // A sync flush is complete once deflate leaves output space unused
+      if (block.last ? rc == Z_STREAM_END : stream.avail_out != 0) {
+        break;
+      }
+      block.output.resize(block.output.size() * 2);
+    }
+    block.output.resize(used);
+    deflateEnd(&stream);
+  }
+
+  void WorkerLoop() {
+    for (;;) {
+      Block* block = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+        block = queue_.front();
+        queue_.pop_front();
+      }
+      Compress(*block);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        block->done = true;
+      }
+      done_cv_.notify_all();
+    }
+  }
+
+  void StopWorkers() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+      if (worker.joinable()) {
+        worker.join();
+      }
+    }
+    workers_.clear();
+  }
+
+  std::unique_ptr<OutputSink> inner_;
+  const int level_;
+  const std::size_t block_bytes_;
+  const int threads_;
+  const std::size_t window_;
+
+  // Writer side; touched only by the thread calling Write()/Finish()
+  std::string current_;
+  std::string tail_;
+  std::uint32_t crc_{0};
+  std::uint64_t raw_bytes_{0};
+  std::uint64_t deflated_bytes_{0};
+  std::uint64_t header_bytes_{0};
+  Status error_ = Status::Ok();
+  bool finished_{false};
+
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  std::deque<std::unique_ptr<Block>> in_flight_;  // Dispatch order
+  std::deque<Block*> queue_;                      // Not yet picked up
+  bool stopping_{false};
+  std::vector<std::thread> workers_;
+};
+
+// RFC 1952 member around the deflate stream.
+class GzipSink : public ParallelDeflateSink {
+ public:
+  GzipSink(std::unique_ptr<OutputSink> inner, const CompressionOptions& options)
+      : ParallelDeflateSink(std::move(inner), options), level_(options.level) {}
+
+ protected:
+  std::string Header() override {
+    std::string header("\x1f\x8b\x08\x00\x00\x00\x00\x00", 8);
+    header.push_back(level_ == 9 ? '\x02' : level_ == 1 ? '\x04' : '\x00');  // XFL
+    header.push_back('\x03');                                                // OS: Unix
+    return header;
+  }
+
+  std::string Trailer(std::uint32_t crc, std::uint64_t raw_bytes, std::uint64_t,
+                      std::uint64_t) override {
+    std::string trailer;
+    PutU32(&trailer, crc);
+    PutU32(&trailer, static_cast<std::uint32_t>(raw_bytes));
+    return trailer;
+  }
+
+ private:
+  int level_;
+};
+
+// Single-entry zip archive. Sizes are unknown when the local header goes
+// out, so the entry is Zip64 with a data descriptor, as streaming
+// writers do; the central directory uses Zip64 fields only when needed.
+class ZipSink : public ParallelDeflateSink {
+ public:
+  ZipSink(std::unique_ptr<OutputSink> inner, const CompressionOptions& options)
+      : ParallelDeflateSink(std::move(inner), options),
+        name_(options.entry_name.empty() ? std::string("data") : options.entry_name) {
+    const std::time_t now = std::time(nullptr);
+    std::tm local{};
+#if defined(_WIN32)
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    dos_time_ = static_cast<std::uint16_t>((local.tm_hour << 11) | (local.tm_min << 5) |
+                                           (local.tm_sec / 2));
+    dos_date_ = static_cast<std::uint16_t>(((std::max(local.tm_year, 80) - 80) << 9) |
+                                           ((local.tm_mon + 1) << 5) | local.tm_mday);
+  }
+
+ protected:
+  static constexpr std::uint16_t kVersion = 45;  // Zip64
+  static constexpr std::uint16_t kFlags = 0x0808;  // Data descriptor, UTF-8 name
+  static constexpr std::uint16_t kDeflated = 8;
+  static constexpr std::uint32_t kMax32 = 0xFFFFFFFF;
+
+  std::string Header() override {
+    std::string header;
+    PutU32(&header, 0x04034b50);
+    PutU16(&header, kVersion);
+    PutU16(&header, kFlags);
+    PutU16(&header, kDeflated);
+    PutU16(&header, dos_time_);
+    PutU16(&header, dos_date_);
+    PutU32(&header, 0);       // CRC, in the descriptor
+    PutU32(&header, kMax32);  // Sizes, in the descriptor
+    PutU32(&header, kMax32);
+    PutU16(&header, static_cast<std::uint32_t>(name_.size()));
+    PutU16(&header, 20);
+    header.append(name_);
+    PutU16(&header, 0x0001);  // Zip64 extra field
+    PutU16(&header, 16);
+    PutU64(&header, 0);
+    PutU64(&header, 0);
+    return header;
+  }
+
+  std::string Trailer(std::uint32_t crc, std::uint64_t raw_bytes, std::uint64_t deflated_bytes,
+                      std::uint64_t header_bytes) override {
+    std::string trailer;
+    PutU32(&trailer, 0x08074b50);
+    PutU32(&trailer, crc);
+    PutU64(&trailer, deflated_bytes);
+    PutU64(&trailer, raw_bytes);
+
+    const bool zip64_sizes = raw_bytes >= kMax32 || deflated_bytes >= kMax32;
+    const std::uint64_t directory_offset = header_bytes + deflated_bytes + trailer.size();
+    const std::size_t directory_start = trailer.size();
+    PutU32(&trailer, 0x02014b50);
+    PutU16(&trailer, (3u << 8) | kVersion);  // Made by Unix
+    PutU16(&trailer, kVersion);
+    PutU16(&trailer, kFlags);
+    PutU16(&trailer, kDeflated);
+    PutU16(&trailer, dos_time_);
+    PutU16(&trailer, dos_date_);
+    PutU32(&trailer, crc);
+    PutU32(&trailer, zip64_sizes ? kMax32 : static_cast<std::uint32_t>(deflated_bytes));
+    PutU32(&trailer, zip64_sizes ? kMax32 : static_cast<std::uint32_t>(raw_bytes));
+    PutU16(&trailer, static_cast<std::uint32_t>(name_.size()));
+    PutU16(&trailer, zip64_sizes ? 20 : 0);
+    PutU16(&trailer, 0);  // Comment
+    PutU16(&trailer, 0);  // Disk
+    PutU16(&trailer, 0);  // Internal attributes
+    PutU32(&trailer, 0100644u << 16);
+    PutU32(&trailer, 0);  // Local header offset
+    trailer.append(name_);
+    if (zip64_sizes) {
+      PutU16(&trailer, 0x0001);
+      PutU16(&trailer, 16);
+      PutU64(&trailer, raw_bytes);
+      PutU64(&trailer, deflated_bytes);
+    }
+    const std::uint64_t directory_bytes = trailer.size() - directory_start;
+
+    if (zip64_sizes || directory_offset >= kMax32) {
+      const std::uint64_t record_offset = directory_offset + directory_bytes;
+      PutU32(&trailer, 0x06064b50);
+      PutU64(&trailer, 44);
+      PutU16(&trailer, (3u << 8) | kVersion);
+      PutU16(&trailer, kVersion);
+      PutU32(&trailer, 0);
+      PutU32(&trailer, 0);
+      PutU64(&trailer, 1);
+      PutU64(&trailer, 1);
+      PutU64(&trailer, directory_bytes);
+      PutU64(&trailer, directory_offset);
+      PutU32(&trailer, 0x07064b50);
+      PutU32(&trailer, 0);
+      PutU64(&trailer, record_offset);
+      PutU32(&trailer, 1);
+    }
+    PutU32(&trailer, 0x06054b50);
+    PutU16(&trailer, 0);
+    PutU16(&trailer, 0);
+    PutU16(&trailer, 1);
+    PutU16(&trailer, 1);
+    PutU32(&trailer, static_cast<std::uint32_t>(directory_bytes));
+    PutU32(&trailer, static_cast<std::uint32_t>(std::min<std::uint64_t>(directory_offset, kMax32)));
+    PutU16(&trailer, 0);
+    return trailer;
+  }
+
+ private:
+  std::string name_;
+  std::uint16_t dos_time_{0};
+  std::uint16_t dos_date_{0};
+};
+
+#if defined(SCRATCHROBIN_WITH_ZSTD)
+// ============================================================================
+// zstd
+// ============================================================================
+
+// Streams into one zstd frame. With nbWorkers set the library compresses
+// jobs on its own threads and ZSTD_compressStream2() returns as soon as
+// the input is buffered.
+class ZstdSink : public OutputSink {
+ public:
+  explicit ZstdSink(std::unique_ptr<OutputSink> inner) : inner_(std::move(inner)) {}
+
+  ~ZstdSink() override {
+    if (!finished_) {
+      inner_->Finish(false);
+    }
+    ZSTD_freeCCtx(context_);
+  }
+
+  Status Open(const CompressionOptions& options) {
+    context_ = ZSTD_createCCtx();
+    if (!context_) {
+      return Status::Error("Cannot create zstd context");
+    }
+    const int level = options.level > 0 ? std::min(options.level, ZSTD_maxCLevel())
+                                        : ZSTD_CLEVEL_DEFAULT;
+    ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel, level);
+    ZSTD_CCtx_setParameter(context_, ZSTD_c_checksumFlag, 1);
+    const int threads = ResolveThreads(options.threads);
+    if (threads > 1) {
+      // Fails on single-threaded builds of libzstd; the frame is then
+      // compressed inline.
+      ZSTD_CCtx_setParameter(context_, ZSTD_c_nbWorkers, threads);
+    }
+    buffer_.resize(ZSTD_CStreamOutSize());
+    return Status::Ok();
+  }
+
+  Status Write(std::string_view data) override {
+    ZSTD_inBuffer input{data.data(), data.size(), 0};
+    while (input.pos < input.size) {
+      Status status = Compress(&input, ZSTD_e_continue, nullptr);
+      if (!status.ok) {
+        return status;
+      }
+    }
+    return Status::Ok();
+  }
+
+  Status Finish(bool success) override {
+    if (finished_) {
+      return Status::Ok();
+    }
+    finished_ = true;
+    Status status = Status::Ok();
+    if (success) {
+      ZSTD_inBuffer input{nullptr, 0, 0};
+      std::size_t remaining = 1;
+      while (status.ok && remaining != 0) {
+        status = Compress(&input, ZSTD_e_end, &remaining);
+      }
+    }
+    Status closed = inner_->Finish(success && status.ok);
+    return status.ok ? closed : status;
+  }
+
+ private:
+  Status Compress(ZSTD_inBuffer* input, ZSTD_EndDirective mode, std::size_t* remaining) {
+    ZSTD_outBuffer output{buffer_.data(), buffer_.size(), 0};
+    const std::size_t rc = ZSTD_compressStream2(context_, &output, input, mode);
+    if (ZSTD_isError(rc)) {
+      return Status::Error(std::string("zstd compression failed: ") + ZSTD_getErrorName(rc));
+    }
+    if (remaining) {
+      *remaining = rc;
+    }
+    return output.pos > 0 ? inner_->Write(std::string_view(buffer_.data(), output.pos))
+                          : Status::Ok();
+  }
+
+  std::unique_ptr<OutputSink> inner_;
+  ZSTD_CCtx* context_{nullptr};
+  std::string buffer_;
+  bool finished_{false};
+};
+#endif
+
+}  // namespace
+
+// ============================================================================
+// Factory
+// ============================================================================
+
+Status ParseOutputCompression(std::string_view name, OutputCompression* format) {
+  std::string lower(name);
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  if (lower.empty() || lower == "none") {
+    *format = OutputCompression::kNone;
+  } else if (lower == "gzip" || lower == "gz") {
+    *format = OutputCompression::kGzip;
+  } else if (lower == "zstd" || lower == "zst") {
+    *format = OutputCompression::kZstd;
+  } else if (lower == "zip") {
+    *format = OutputCompression::kZip;
+  } else {
+    return Status::Error("Unknown compression format: " + std::string(name));
+  }
+  return Status::Ok();
+}
+
+const char* OutputCompressionExtension(OutputCompression format) {
+  switch (format) {
+    case OutputCompression::kGzip:
+      return ".gz";
+    case OutputCompression::kZstd:
+      return ".zst";
+    case OutputCompression::kZip:
+      return ".zip";
+    case OutputCompression::kNone:
+      break;
+  }
+  return "";
+}
+
+bool OutputCompressionAvailable(OutputCompression format) {
+#if defined(SCRATCHROBIN_WITH_ZSTD)
+  (void)format;
+  return true;
+#else
+  return format != OutputCompression::kZstd;
+#endif
+}
+
+Status MakeCompressingSink(std::unique_ptr<OutputSink> inner, const CompressionOptions& options,
+                           std::unique_ptr<OutputSink>* out) {
+  switch (options.format) {
+    case OutputCompression::kNone:
+      *out = std::move(inner);
+      return Status::Ok();
+    case OutputCompression::kGzip:
+      *out = std::make_unique<GzipSink>(std::move(inner), options);
+      return Status::Ok();
+    case OutputCompression::kZip:
+      *out = std::make_unique<ZipSink>(std::move(inner), options);
+      return Status::Ok();
+    case OutputCompression::kZstd: {
+#if defined(SCRATCHROBIN_WITH_ZSTD)
+      auto sink = std::make_unique<ZstdSink>(std::move(inner));
+      Status status = sink->Open(options);
+      if (!status.ok) {
+        return status;
+      }
+      *out = std::move(sink);
+      return Status::Ok();
+#else
+      inner->Finish(false);
+      return Status::Error("This build has no zstd support");
+#endif
+    }
+  }
+  return Status::Error("Unknown compression format");
+}
+
+}  // namespace scratchrobin::core
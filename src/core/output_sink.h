@@ -0,0 +1,107 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "core/status.h"
+
+namespace scratchrobin::core {
+
+/**
+ * OutputSink - ordered byte stream written by exports and backups
+ *
+ * Write() is called from one thread at a time. Finish() flushes and
+ * closes the sink; after a failed run (success == false) nothing is
+ * left behind.
+ */
+class OutputSink {
+ public:
+  virtual ~OutputSink() = default;
+  virtual Status Write(std::string_view data) = 0;
+  virtual Status Finish(bool success) = 0;
+};
+
+// Writes through a private staging buffer so the file sees few, large,
+// sequential writes. Output goes to "<path>.part" until it is complete.
+class FileSink : public OutputSink {
+ public:
+  ~FileSink() override;
+
+  Status Open(const std::string& path);
+  Status Write(std::string_view data) override;
+  Status Finish(bool success) override;
+
+ private:
+  Status Flush();
+  Status WriteAll(std::string_view data);
+
+  std::string path_;
+  std::string part_path_;
+  std::FILE* file_{nullptr};
+  std::string staging_;
+};
+
+class StringSink : public OutputSink {
+ public:
+  explicit StringSink(std::string* out) : out_(out) {}
+  Status Write(std::string_view data) override {
+    out_->append(data);
+    return Status::Ok();
+  }
+  Status Finish(bool) override { return Status::Ok(); }
+
+ private:
+  std::string* out_;
+};
+
+// ============================================================================
+// Compression
+// ============================================================================
+
+enum class OutputCompression {
+  kNone,
+  kGzip,
+  kZstd,
+  kZip  // Single-entry archive
+};
+
+struct CompressionOptions {
+  OutputCompression format{OutputCompression::kNone};
+  int level{0};    // 0 = format default
+  int threads{0};  // Compressor threads; 0 = hardware concurrency
+  std::size_t block_bytes{128 * 1024};  // Input per parallel deflate block
+  std::string entry_name{"data"};       // File name inside a zip archive
+};
+
+// Accepts "gzip"/"gz", "zstd"/"zst", "zip" and ""/"none", in any case.
+Status ParseOutputCompression(std::string_view name, OutputCompression* format);
+
+// ".gz", ".zst", ".zip", or "" for kNone.
+const char* OutputCompressionExtension(OutputCompression format);
+
+// zstd is optional at build time; the others are always available.
+bool OutputCompressionAvailable(OutputCompression format);
+
+/**
+ * Wraps |inner| in a sink that compresses everything written to it.
+ *
+ * gzip and zip cut the input into blocks deflated in parallel, each
+ * primed with the last 32 KiB of its predecessor (as pigz does), and
+ * splice them into one deflate stream; zstd hands its frames to the
+ * library's worker threads. Either way Write() returns once the data is
+ * queued, so compression overlaps whatever produces it. Finish() writes
+ * the trailer and then finishes |inner|. kNone returns |inner| as is.
+ */
+Status MakeCompressingSink(std::unique_ptr<OutputSink> inner, const CompressionOptions& options,
+                           std::unique_ptr<OutputSink>* out);
+
+}  // namespace scratchrobin::core
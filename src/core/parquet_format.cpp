@@ -0,0 +1,1450 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/parquet_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace scratchrobin::core {
+
+namespace {
+
+// Enumerations from parquet.thrift
+enum class PhysicalType : int {
+  kBoolean = 0,
+  kInt32 = 1,
+  kInt64 = 2,
+  kInt96 = 3,
+  kFloat = 4,
+  kDouble = 5,
+  kByteArray = 6,
+  kFixedLenByteArray = 7,
+};
+enum class Encoding : int { kPlain = 0, kPlainDictionary = 2, kRle = 3, kRleDictionary = 8 };
+enum class PageType : int { kDataPage = 0, kDictionaryPage = 2, kDataPageV2 = 3 };
+enum class Codec : int { kUncompressed = 0, kSnappy = 1 };
+constexpr int kConvertedUtf8 = 0;
+constexpr int kConvertedDate = 6;
+constexpr int kLogicalString = 1;
+constexpr int kLogicalDate = 6;
+constexpr int kRepetitionRequired = 0;
+constexpr int kRepetitionOptional = 1;
+constexpr int kRepetitionRepeated = 2;
+
+// Longest text min/max recorded in column statistics
+constexpr std::size_t kMaxStatisticsBytes = 64;
+
+// ============================================================================
+// Byte helpers
+// ============================================================================
+
+void PutLE32(std::uint32_t value, std::string& out) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+void PutLE64(std::uint64_t value, std::string& out) {
+  for (int i = 0; i < 8; ++i) {
+    out.push_back(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+std::uint64_t GetLE(const char* data, int bytes) {
+  std::uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i) {
+    value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+  }
+  return value;
+}
+
+void PutVarint(std::uint64_t value, std::string& out) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+bool GetVarint(std::string_view data, std::size_t& pos, std::uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+    const auto byte = static_cast<unsigned char>(data[pos++]);
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::uint64_t DoubleBits(double value) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double BitsDouble(std::uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+int BitWidth(std::uint32_t max_value) {
+  int width = 0;
+  while (max_value) {
+    ++width;
+    max_value >>= 1;
+  }
+  return width;
+}
+
+// ============================================================================
+// Thrift compact protocol
+// ============================================================================
+
+enum ThriftType : std::uint8_t {
+  kThriftStop = 0,
+  kThriftTrue = 1,
+  kThriftFalse = 2,
+  kThriftByte = 3,
+  kThriftI16 = 4,
+  kThriftI32 = 5,
+  kThriftI64 = 6,
+  kThriftDouble = 7,
+  kThriftBinary = 8,
+  kThriftList = 9,
+  kThriftSet = 10,
+  kThriftMap = 11,
+  kThriftStruct = 12,
+};
+
+std::uint64_t ZigZag(std::int64_t value) {
+  return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t UnZigZag(std::uint64_t value) {
+  return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+// Writes one top-level struct; EndStruct() closes it.
+class ThriftWriter {
+ public:
+  explicit ThriftWriter(std::string* out) : out_(out) { stack_.push_back(0); }
+
+  void I32(int id, std::int32_t value) {
+    Field(id, kThriftI32);
+    PutVarint(ZigZag(value), *out_);
+  }
+  void I64(int id, std::int64_t value) {
+    Field(id, kThriftI64);
+    PutVarint(ZigZag(value), *out_);
+  }
+  void Binary(int id, std::string_view value) {
+    Field(id, kThriftBinary);
+    ListBinary(value);
+  }
+  void BeginStruct(int id) {
+    Field(id, kThriftStruct);
+    ListStruct();
+  }
+  void BeginList(int id, ThriftType element, std::size_t size) {
+    Field(id, kThriftList);
+    if (size < 15) {
+      out_->push_back(static_cast<char>((size << 4) | element));
+    } else {
+      out_->push_back(static_cast<char>(0xF0 | element));
+      PutVarint(size, *out_);
+    }
+  }
+  // List elements
+  void ListStruct() {
+    stack_.push_back(last_);
+    last_ = 0;
+  }
+  void ListI32(std::int32_t value) { PutVarint(ZigZag(value), *out_); }
+  void ListBinary(std::string_view value) {
+    PutVarint(value.size(), *out_);
+    out_->append(value);
+  }
+  void EndStruct() {
+    out_->push_back(static_cast<char>(kThriftStop));
+    last_ = stack_.back();
+    stack_.pop_back();
+  }
+
+ private:
+  void Field(int id, std::uint8_t type) {
+    if (id > last_ && id - last_ <= 15) {
+      out_->push_back(static_cast<char>(((id - last_) << 4) | type));
+    } else {
+      out_->push_back(static_cast<char>(type));
+      PutVarint(ZigZag(id), *out_);
+    }
+    last_ = id;
+  }
+
+  std::string* out_;
+  int last_{0};
+  std::vector<int> stack_;
+};
+
+// Bounds-checked reader; any overrun clears Ok() and reads return zero.
+class ThriftReader {
+ public:
+  explicit ThriftReader(std::string_view data) : data_(data) {}
+
+  bool Ok() const { return ok_; }
+  std::size_t Position() const { return pos_; }
+
+  // Calls field(id, type) for each field of the struct at the current
+  // position; the callback reads the value or calls Skip(type).
+  template <typename Callback>
+  void Struct(Callback&& field) {
+    if (++depth_ > kMaxDepth) {
+      ok_ = false;
+    }
+    int last = 0;
+    while (ok_) {
+      const std::uint8_t header = Byte();
+      if (!ok_ || header == kThriftStop) {
+        break;
+      }
+      const std::uint8_t type = header & 0x0F;
+      const int delta = header >> 4;
+      const int id = delta ? last + delta : static_cast<int>(UnZigZag(Varint()));
+      last = id;
+      bool_ = type == kThriftTrue;
+      field(id, type);
+    }
+    --depth_;
+  }
+
+  std::int64_t Int() { return UnZigZag(Varint()); }
+  bool Bool() const { return bool_; }
+  std::string_view Binary() {
+    const std::uint64_t size = Varint();
+    if (!ok_ || size > data_.size() - pos_) {
+      ok_ = false;
+      return {};
+    }
+    std::string_view value = data_.substr(pos_, size);
+    pos_ += size;
+    return value;
+  }
+  std::size_t List(std::uint8_t* element) {
+    const std::uint8_t header = Byte();
+    *element = header & 0x0F;
+    std::uint64_t size = header >> 4;
+    if (size == 15) {
+      size = Varint();
+    }
+    // Every element takes at least one byte
+    if (!ok_ || size > data_.size() - pos_) {
+      ok_ = false;
+      return 0;
+    }
+    return size;
+  }
+
+  void Skip(std::uint8_t type, bool in_list = false) {
+    switch (type) {
+      case kThriftTrue:
+      case kThriftFalse:
+        if (in_list) {
+          Byte();
+        }
+        break;
+      case kThriftByte:
+        Byte();
+        break;
+      case kThriftI16:
+      case kThriftI32:
+      case kThriftI64:
+        Varint();
+        break;
+      case kThriftDouble:
+        Advance(8);
+        break;
+      case kThriftBinary:
+        Binary();
+        break;
+      case kThriftList:
+      case kThriftSet: {
+        std::uint8_t element = 0;
+        const std::size_t size = List(&element);
+        for (std::size_t i = 0; i < size && ok_; ++i) {
+          Skip(element, true);
+        }
+        break;
+      }
+      case kThriftMap: {
+        const std::uint64_t size = Varint();
+        if (size > 0) {
+          const std::uint8_t types = Byte();
+          for (std::uint64_t i = 0; i < size && ok_; ++i) {
+            Skip(types >> 4, true);
+            Skip(types & 0x0F, true);
+          }
+        }
+        break;
+      }
+      case kThriftStruct:
+        Struct([this](int, std::uint8_t field_type) { Skip(field_type); });
+        break;
+      default:
+        ok_ = false;
+        break;
+    }
+  }
+
+ private:
+  static constexpr int kMaxDepth = 32;
+
+  std::uint8_t Byte() {
+    if (pos_ >= data_.size()) {
+      ok_ = false;
+      return 0;
+    }
+    return static_cast<std::uint8_t>(data_[pos_++]);
+  }
+  std::uint64_t Varint() {
+    std::uint64_t value = 0;
+    if (!GetVarint(data_, pos_, value)) {
+      ok_ = false;
+      return 0;
+    }
+    return value;
+  }
+  void Advance(std::size_t bytes) {
+    if (bytes > data_.size() - pos_) {
+      ok_ = false;
+      return;
+    }
+    pos_ += bytes;
+  }
+
+  std::string_view data_;
+  std::size_t pos_{0};
+  bool ok_{true};
+  bool bool_{false};
+  int depth_{0};
+};
+
+// ============================================================================
+// RLE / bit-packed hybrid encoding
+// ============================================================================
+
+// Repeats of 8 or more become RLE runs; everything else is bit-packed in
+// groups of 8. Only the final group may be padded.
+void EncodeHybrid(const std::uint32_t* values, std::size_t count, int bit_width,
+                  std::string& out) {
+  const int value_bytes = (bit_width + 7) / 8;
+  std::vector<std::uint32_t> literal;
+  auto flush_literal = [&] {
+    if (literal.empty()) {
+      return;
+    }
+    literal.resize((literal.size() + 7) / 8 * 8, 0);
+    PutVarint((literal.size() / 8) << 1 | 1, out);
+    std::uint64_t bits = 0;
+    int pending = 0;
+    for (std::uint32_t value : literal) {
+      bits |= static_cast<std::uint64_t>(value) << pending;
+      pending += bit_width;
+      while (pending >= 8) {
+        out.push_back(static_cast<char>(bits));
+        bits >>= 8;
+        pending -= 8;
+      }
+    }
+    literal.clear();
+  };
+
+  std::size_t i = 0;
+  while (i < count) {
+    std::size_t run = 1;
+    while (i + run < count && values[i + run] == values[i]) {
+      ++run;
+    }
+    if (run < 8) {
+      literal.insert(literal.end(), values + i, values + i + run);
+      i += run;
+      continue;
+    }
+    // Fill the literal up to a group boundary before switching to RLE
+    const std::size_t fill = (8 - literal.size() % 8) % 8;
+    literal.insert(literal.end(), fill, values[i]);
+    i += fill;
+    run -= fill;
+    if (run >= 8) {
+      flush_literal();
+      PutVarint(run << 1, out);
+      for (int b = 0; b < value_bytes; ++b) {
+        out.push_back(static_cast<char>(values[i] >> (8 * b)));
+      }
+      i += run;
+    }
+  }
+  flush_literal();
+}
+
+bool DecodeHybrid(std::string_view data, int bit_width, std::size_t count,
+                  std::vector<std::uint32_t>& out) {
+  if (bit_width < 0 || bit_width > 32) {
+    return false;
+  }
+  out.resize(count);
+  const std::size_t value_bytes = static_cast<std::size_t>(bit_width + 7) / 8;
+  const std::uint64_t mask = (std::uint64_t{1} << bit_width) - 1;
+  std::size_t pos = 0;
+  std::size_t n = 0;
+  while (n < count) {
+    std::uint64_t header = 0;
+    if (!GetVarint(data, pos, header)) {
+      return false;
+    }
+    if (header & 1) {
+      const std::uint64_t groups = header >> 1;
+      const std::uint64_t bytes = groups * static_cast<std::uint64_t>(bit_width);
+      if (groups > data.size() || bytes > data.size() - pos) {
+        return false;
+      }
+      const char* packed = data.data() + pos;
+      std::uint64_t bits = 0;
+      int pending = 0;
+      for (std::uint64_t k = 0; k < groups * 8 && n < count; ++k) {
+        while (pending < bit_width) {
+          bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(*packed++)) << pending;
+          pending += 8;
+        }
+        out[n++] = static_cast<std::uint32_t>(bits & mask);
+        bits >>= bit_width;
+        pending -= bit_width;
+      }
+      pos += bytes;
+    } else {
+      const std::uint64_t run = header >> 1;
+      if (value_bytes > data.size() - pos) {
+        return false;
+      }
+      const auto value = static_cast<std::uint32_t>(GetLE(data.data() + pos, static_cast<int>(value_bytes)));
+      pos += value_bytes;
+      const std::size_t take = static_cast<std::size_t>(std::min<std::uint64_t>(run, count - n));
+      std::fill(out.begin() + static_cast<std::ptrdiff_t>(n),
+                out.begin() + static_cast<std::ptrdiff_t>(n + take), value);
+      n += take;
+    }
+  }
+  return true;
+}
+
+// ============================================================================
+// Snappy (decompression only)
+// ============================================================================
+
+bool SnappyDecompress(std::string_view in, std::string& out) {
+  std::size_t pos = 0;
+  std::uint64_t length = 0;
+  if (!GetVarint(in, pos, length) || length > (std::uint64_t{1} << 32)) {
+    return false;
+  }
+  out.resize(length);
+  char* dst = out.data();
+  std::size_t op = 0;
+  while (pos < in.size()) {
+    const auto tag = static_cast<unsigned char>(in[pos++]);
+    std::size_t len = 0;
+    std::size_t offset = 0;
+    if ((tag & 3) == 0) {
+      len = tag >> 2;
+      if (len >= 60) {
+        const int extra = static_cast<int>(len) - 59;
+        if (static_cast<std::size_t>(extra) > in.size() - pos) {
+          return false;
+        }
+        len = static_cast<std::size_t>(GetLE(in.data() + pos, extra));
+        pos += static_cast<std::size_t>(extra);
+      }
+      len += 1;
+      if (len > in.size() - pos || len > length - op) {
+        return false;
+      }
+      std::memcpy(dst + op, in.data() + pos, len);
+      pos += len;
+      op += len;
+      continue;
+    }
+    if ((tag & 3) == 1) {
+      if (pos >= in.size()) {
+        return false;
+      }
+      len = ((tag >> 2) & 7) + 4;
+      offset = (static_cast<std::size_t>(tag >> 5) << 8) | static_cast<unsigned char>(in[pos++]);
+    } else {
+      const int bytes = (tag & 3) == 2 ? 2 : 4;
+      if (static_cast<std::size_t>(bytes) > in.size() - pos) {
+        return false;
+      }
+      len = (tag >> 2) + 1;
+      offset = static_cast<std::size_t>(GetLE(in.data() + pos, bytes));
+      pos += static_cast<std::size_t>(bytes);
+    }
+    if (offset == 0 || offset > op || len > length - op) {
+      return false;
+    }
+    for (std::size_t k = 0; k < len; ++k) {
+      dst[op + k] = dst[op + k - offset];
+    }
+    op += len;
+  }
+  return op == length;
+}
+
+// ============================================================================
+// Writing
+// ============================================================================
+
+PhysicalType PhysicalTypeFor(ColumnType type) {
+  switch (type) {
+    case ColumnType::kInt64: return PhysicalType::kInt64;
+    case ColumnType::kDouble: return PhysicalType::kDouble;
+    case ColumnType::kDate: return PhysicalType::kInt32;
+    default: return PhysicalType::kByteArray;
+  }
+}
+
+// Raw bits of a fixed-width cell: int64, double bits or days.
+std::uint64_t FixedBits(const ColumnBuffer& column, ColumnType type, std::size_t row) {
+  switch (type) {
+    case ColumnType::kInt64: return static_cast<std::uint64_t>(column.Int64At(row));
+    case ColumnType::kDouble: return DoubleBits(column.DoubleAt(row));
+    default: return static_cast<std::uint64_t>(static_cast<std::int64_t>(column.DateAt(row)));
+  }
+}
+
+void AppendPlainFixed(std::uint64_t bits, ColumnType type, std::string& out) {
+  if (type == ColumnType::kDate) {
+    PutLE32(static_cast<std::uint32_t>(bits), out);
+  } else {
+    PutLE64(bits, out);
+  }
+}
+
+void AppendPlainText(std::string_view text, std::string& out) {
+  PutLE32(static_cast<std::uint32_t>(text.size()), out);
+  out.append(text);
+}
+
+void AppendPageHeader(PageType type, std::size_t body_bytes, std::size_t num_values,
+                      Encoding encoding, std::string& out) {
+  ThriftWriter header(&out);
+  header.I32(1, static_cast<std::int32_t>(type));
+  header.I32(2, static_cast<std::int32_t>(body_bytes));
+  header.I32(3, static_cast<std::int32_t>(body_bytes));
+  if (type == PageType::kDictionaryPage) {
+    header.BeginStruct(7);
+    header.I32(1, static_cast<std::int32_t>(num_values));
+    header.I32(2, static_cast<std::int32_t>(Encoding::kPlain));
+    header.EndStruct();
+  } else {
+    header.BeginStruct(5);
+    header.I32(1, static_cast<std::int32_t>(num_values));
+    header.I32(2, static_cast<std::int32_t>(encoding));
+    header.I32(3, static_cast<std::int32_t>(Encoding::kRle));
+    header.I32(4, static_cast<std::int32_t>(Encoding::kRle));
+    header.EndStruct();
+  }
+  header.EndStruct();
+}
+
+// Writes the dictionary page (if any) and data pages of one column chunk.
+// |column| is of storage type |type| or all NULL.
+void EncodeColumnChunk(const ColumnBuffer& column, ColumnType type, std::size_t begin,
+                       std::size_t end, const ParquetWriteOptions& options, std::size_t base,
+                       std::string& out, ParquetColumnChunk& chunk) {
+  const bool is_text = type == ColumnType::kText;
+  chunk.num_values = static_cast<std::int64_t>(end - begin);
+  const std::size_t chunk_start = out.size();
+
+  // Statistics and dictionary in one pass
+  std::unordered_map<std::string_view, std::uint32_t> text_index;
+  std::unordered_map<std::uint64_t, std::uint32_t> fixed_index;
+  std::vector<std::string_view> text_values;
+  std::vector<std::uint64_t> fixed_values;
+  std::vector<std::uint32_t> indices;
+  std::size_t dictionary_bytes = 0;
+  bool use_dictionary = options.use_dictionary;
+
+  std::string_view text_min, text_max;
+  std::int64_t int_min = 0, int_max = 0;
+  double double_min = 0, double_max = 0;
+  bool have_bounds = false;
+
+  for (std::size_t row = begin; row < end; ++row) {
+    if (column.IsNull(row)) {
+      ++chunk.null_count;
+      continue;
+    }
+    if (is_text) {
+      const std::string_view text = column.TextAt(row);
+      if (!have_bounds || text < text_min) {
+        text_min = text;
+      }
+      if (!have_bounds || text > text_max) {
+        text_max = text;
+      }
+      have_bounds = true;
+      if (use_dictionary) {
+        auto [it, added] = text_index.try_emplace(text, static_cast<std::uint32_t>(text_values.size()));
+        if (added) {
+          text_values.push_back(text);
+          dictionary_bytes += 4 + text.size();
+        }
+        indices.push_back(it->second);
+      }
+    } else {
+      const std::uint64_t bits = FixedBits(column, type, row);
+      if (type == ColumnType::kDouble) {
+        const double value = BitsDouble(bits);
+        if (!std::isnan(value)) {
+          double_min = have_bounds ? std::min(double_min, value) : value;
+          double_max = have_bounds ? std::max(double_max, value) : value;
+          have_bounds = true;
+        }
+      } else {
+        const auto value = static_cast<std::int64_t>(bits);
+        int_min = have_bounds ? std::min(int_min, value) : value;
+        int_max = have_bounds ? std::max(int_max, value) : value;
+        have_bounds = true;
+      }
+      if (use_dictionary) {
+        auto [it, added] = fixed_index.try_emplace(bits, static_cast<std::uint32_t>(fixed_values.size()));
+        if (added) {
+          fixed_values.push_back(bits);
+          dictionary_bytes += type == ColumnType::kDate ? 4 : 8;
+        }
+        indices.push_back(it->second);
+      }
+    }
+    if (use_dictionary && dictionary_bytes > options.dictionary_bytes) {
+      use_dictionary = false;
+      text_index.clear();
+      fixed_index.clear();
+      indices.clear();
+    }
+  }
+  const std::size_t present = static_cast<std::size_t>(chunk.num_values - chunk.null_count);
+  use_dictionary = use_dictionary && present > 0;
+
+  if (have_bounds) {
+    if (is_text) {
+      if (text_min.size() <= kMaxStatisticsBytes && text_max.size() <= kMaxStatisticsBytes) {
+        chunk.min_value = text_min;
+        chunk.max_value = text_max;
+        chunk.has_min_max = true;
+      }
+    } else if (type == ColumnType::kDouble) {
+      // Zero bounds are written signed so either zero compares correctly
+      AppendPlainFixed(DoubleBits(double_min == 0 ? -0.0 : double_min), type, chunk.min_value);
+      AppendPlainFixed(DoubleBits(double_max == 0 ? 0.0 : double_max), type, chunk.max_value);
+      chunk.has_min_max = true;
+    } else {
+      AppendPlainFixed(static_cast<std::uint64_t>(int_min), type, chunk.min_value);
+      AppendPlainFixed(static_cast<std::uint64_t>(int_max), type, chunk.max_value);
+      chunk.has_min_max = true;
+    }
+  }
+
+  std::string body;
+  int bit_width = 0;
+  if (use_dictionary) {
+    const std::size_t entries = is_text ? text_values.size() : fixed_values.size();
+    body.reserve(dictionary_bytes);
+    for (std::size_t i = 0; i < entries; ++i) {
+      if (is_text) {
+        AppendPlainText(text_values[i], body);
+      } else {
+        AppendPlainFixed(fixed_values[i], type, body);
+      }
+    }
+    chunk.dictionary_page_offset = static_cast<std::int64_t>(out.size() - base);
+    AppendPageHeader(PageType::kDictionaryPage, body.size(), entries, Encoding::kPlain, out);
+    out += body;
+    bit_width = std::max(1, BitWidth(static_cast<std::uint32_t>(entries - 1)));
+  }
+  chunk.data_page_offset = static_cast<std::int64_t>(out.size() - base);
+
+  std::vector<std::uint32_t> levels;
+  std::string encoded_levels;
+  std::size_t row = begin;
+  std::size_t value_index = 0;
+  do {
+    // Rows up to the target page size
+    std::size_t page_end = row;
+    std::size_t bits = 0;
+    while (page_end < end && (page_end == row || bits / 8 < options.page_bytes)) {
+      if (!column.IsNull(page_end)) {
+        if (use_dictionary) {
+          bits += static_cast<std::size_t>(bit_width);
+        } else {
+          bits += 8 * (is_text ? 4 + column.TextAt(page_end).size() : type == ColumnType::kDate ? 4 : 8);
+        }
+      }
+      ++page_end;
+    }
+
+    levels.clear();
+    for (std::size_t r = row; r < page_end; ++r) {
+      levels.push_back(column.IsNull(r) ? 0 : 1);
+    }
+    const auto page_values = static_cast<std::size_t>(std::count(levels.begin(), levels.end(), 1u));
+    encoded_levels.clear();
+    EncodeHybrid(levels.data(), levels.size(), 1, encoded_levels);
+
+    body.clear();
+    PutLE32(static_cast<std::uint32_t>(encoded_levels.size()), body);
+    body += encoded_levels;
+    if (use_dictionary) {
+      body.push_back(static_cast<char>(bit_width));
+      EncodeHybrid(indices.data() + value_index, page_values, bit_width, body);
+    } else {
+      for (std::size_t r = row; r < page_end; ++r) {
+        if (column.IsNull(r)) {
+          continue;
+        }
+        if (is_text) {
+          AppendPlainText(column.TextAt(r), body);
+        } else {
+          AppendPlainFixed(FixedBits(column, type, r), type, body);
+        }
+      }
+    }
+    value_index += page_values;
+    AppendPageHeader(PageType::kDataPage, body.size(), page_end - row,
+                     use_dictionary ? Encoding::kRleDictionary : Encoding::kPlain, out);
+    out += body;
+    row = page_end;
+  } while (row < end);
+
+  chunk.total_bytes = static_cast<std::int64_t>(out.size() - chunk_start);
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+struct PageHeader {
+  int type{-1};
+  std::int64_t uncompressed_size{0};
+  std::int64_t compressed_size{-1};
+  std::int64_t num_values{0};
+  int encoding{0};
+  int level_encoding{static_cast<int>(Encoding::kRle)};
+  std::int64_t definition_bytes{0};  // Data page v2
+  std::int64_t repetition_bytes{0};
+  bool values_compressed{true};
+};
+
+bool ParsePageHeader(std::string_view data, PageHeader* header, std::size_t* size) {
+  ThriftReader reader(data);
+  reader.Struct([&](int id, std::uint8_t type) {
+    switch (id) {
+      case 1: header->type = static_cast<int>(reader.Int()); break;
+      case 2: header->uncompressed_size = reader.Int(); break;
+      case 3: header->compressed_size = reader.Int(); break;
+      case 5:  // DataPageHeader
+        reader.Struct([&](int field, std::uint8_t field_type) {
+          switch (field) {
+            case 1: header->num_values = reader.Int(); break;
+            case 2: header->encoding = static_cast<int>(reader.Int()); break;
+            case 3: header->level_encoding = static_cast<int>(reader.Int()); break;
+            default: reader.Skip(field_type); break;
+          }
+        });
+        break;
+      case 7:  // DictionaryPageHeader
+        reader.Struct([&](int field, std::uint8_t field_type) {
+          switch (field) {
+            case 1: header->num_values = reader.Int(); break;
+            case 2: header->encoding = static_cast<int>(reader.Int()); break;
+            default: reader.Skip(field_type); break;
+          }
+        });
+        break;
+      case 8:  // DataPageHeaderV2
+        reader.Struct([&](int field, std::uint8_t field_type) {
+          switch (field) {
+            case 1: header->num_values = reader.Int(); break;
+            case 4: header->encoding = static_cast<int>(reader.Int()); break;
+            case 5: header->definition_bytes = reader.Int(); break;
+            case 6: header->repetition_bytes = reader.Int(); break;
+            case 7: header->values_compressed = reader.Bool(); break;
+            default: reader.Skip(field_type); break;
+          }
+        });
+        break;
+      default:
+        reader.Skip(type);
+        break;
+    }
+  });
+  *size = reader.Position();
+  return reader.Ok() && header->compressed_size >= 0 && header->uncompressed_size >= 0 &&
+         header->num_values >= 0;
+}
+
+Status Decompress(int codec, std::string_view body, std::int64_t uncompressed_size,
+                  std::string& storage, std::string_view* page) {
+  switch (static_cast<Codec>(codec)) {
+    case Codec::kUncompressed:
+      *page = body;
+      return Status::Ok();
+    case Codec::kSnappy:
+      if (!SnappyDecompress(body, storage) ||
+          storage.size() != static_cast<std::size_t>(uncompressed_size)) {
+        return Status::Error("Corrupt Snappy page in Parquet file");
+      }
+      *page = storage;
+      return Status::Ok();
+    default:
+      return Status::Error("Parquet compression codec " + std::to_string(codec) +
+                           " is not supported (only uncompressed and Snappy)");
+  }
+}
+
+// Decodes |count| PLAIN values: fixed-width types into |fixed| as int64
+// or double bits, BYTE_ARRAY into |text| (views into |data|).
+bool DecodePlain(PhysicalType type, std::string_view data, std::size_t count,
+                 std::vector<std::uint64_t>& fixed, std::vector<std::string_view>& text) {
+  fixed.clear();
+  text.clear();
+  switch (type) {
+    case PhysicalType::kBoolean:
+      if (data.size() < (count + 7) / 8) {
+        return false;
+      }
+      for (std::size_t i = 0; i < count; ++i) {
+        fixed.push_back((static_cast<unsigned char>(data[i / 8]) >> (i % 8)) & 1);
+      }
+      return true;
+    case PhysicalType::kInt32:
+    case PhysicalType::kFloat:
+      if (data.size() / 4 < count) {
+        return false;
+      }
+      for (std::size_t i = 0; i < count; ++i) {
+        const auto bits = static_cast<std::uint32_t>(GetLE(data.data() + 4 * i, 4));
+        if (type == PhysicalType::kInt32) {
+          fixed.push_back(static_cast<std::uint64_t>(static_cast<std::int64_t>(static_cast<std::int32_t>(bits))));
+        } else {
+          float value;
+          std::memcpy(&value, &bits, sizeof(value));
+          fixed.push_back(DoubleBits(value));
+        }
+      }
+      return true;
+    case PhysicalType::kInt64:
+    case PhysicalType::kDouble:
+      if (data.size() / 8 < count) {
+        return false;
+      }
+      for (std::size_t i = 0; i < count; ++i) {
+        fixed.push_back(GetLE(data.data() + 8 * i, 8));
+      }
+      return true;
+    case PhysicalType::kByteArray: {
+      std::size_t pos = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+        if (data.size() - pos < 4) {
+          return false;
+        }
+        const auto size = static_cast<std::size_t>(GetLE(data.data() + pos, 4));
+        pos += 4;
+        if (size > data.size() - pos) {
+          return false;
+        }
+        text.push_back(data.substr(pos, size));
+        pos += size;
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+void AppendFixed(std::uint64_t bits, ColumnType type, ColumnBuffer* out) {
+  switch (type) {
+    case ColumnType::kDouble:
+      out->AppendDouble(BitsDouble(bits));
+      break;
+    case ColumnType::kDate:
+      out->AppendDate(static_cast<std::int32_t>(static_cast<std::int64_t>(bits)));
+      break;
+    default:
+      out->AppendInt64(static_cast<std::int64_t>(bits));
+      break;
+  }
+}
+
+}  // namespace
+
+Status EncodeParquetRowGroup(const ColumnarSchema& schema,
+                             const std::vector<const ColumnBuffer*>& columns,
+                             std::size_t begin, std::size_t end,
+                             const ParquetWriteOptions& options, std::string* out,
+                             ParquetRowGroup* row_group) {
+  if (columns.size() != schema.types.size()) {
+    return Status::Error("Parquet row group does not match the schema");
+  }
+  const std::size_t base = out->size();
+  row_group->offset = 0;
+  row_group->num_rows = static_cast<std::int64_t>(end - begin);
+  row_group->columns.assign(columns.size(), ParquetColumnChunk{});
+
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    const ColumnType type = ColumnarStorageType(schema.types[i]);
+    std::size_t first = begin;
+    std::size_t last = end;
+    ColumnBuffer scratch;
+    const ColumnBuffer* column = ColumnarValues(*columns[i], type, &first, &last, &scratch);
+    if (!column) {
+      return Status::Error("Column " + schema.names[i] + " holds " + ToString(columns[i]->Type()) +
+                           " values but the file stores " + ToString(type));
+    }
+    EncodeColumnChunk(*column, type, first, last, options, base, *out, row_group->columns[i]);
+  }
+  row_group->total_bytes = static_cast<std::int64_t>(out->size() - base);
+  return Status::Ok();
+}
+
+void AppendParquetFooter(const ColumnarSchema& schema,
+                         const std::vector<ParquetRowGroup>& row_groups, std::string* out) {
+  std::string metadata;
+  ThriftWriter writer(&metadata);
+  writer.I32(1, 2);
+
+  writer.BeginList(2, kThriftStruct, schema.names.size() + 1);
+  writer.ListStruct();
+  writer.Binary(4, "schema");
+  writer.I32(5, static_cast<std::int32_t>(schema.names.size()));
+  writer.EndStruct();
+  for (std::size_t i = 0; i < schema.names.size(); ++i) {
+    const ColumnType type = ColumnarStorageType(schema.types[i]);
+    writer.ListStruct();
+    writer.I32(1, static_cast<std::int32_t>(PhysicalTypeFor(type)));
+    writer.I32(3, kRepetitionOptional);
+    writer.Binary(4, schema.names[i]);
+    if (type == ColumnType::kText || type == ColumnType::kDate) {
+      const bool text = type == ColumnType::kText;
+      writer.I32(6, text ? kConvertedUtf8 : kConvertedDate);
+      writer.BeginStruct(10);
+      writer.BeginStruct(text ? kLogicalString : kLogicalDate);
+      writer.EndStruct();
+      writer.EndStruct();
+    }
+    writer.EndStruct();
+  }
+
+  std::int64_t total_rows = 0;
+  for (const auto& row_group : row_groups) {
+    total_rows += row_group.num_rows;
+  }
+  writer.I64(3, total_rows);
+
+  writer.BeginList(4, kThriftStruct, row_groups.size());
+  for (const auto& row_group : row_groups) {
+    writer.ListStruct();
+    writer.BeginList(1, kThriftStruct, row_group.columns.size());
+    for (std::size_t i = 0; i < row_group.columns.size(); ++i) {
+      const ParquetColumnChunk& chunk = row_group.columns[i];
+      const ColumnType type = ColumnarStorageType(schema.types[i]);
+      const bool dictionary = chunk.dictionary_page_offset >= 0;
+      writer.ListStruct();
+      writer.I64(2, dictionary ? chunk.dictionary_page_offset : chunk.data_page_offset);
+      writer.BeginStruct(3);
+      writer.I32(1, static_cast<std::int32_t>(PhysicalTypeFor(type)));
+      writer.BeginList(2, kThriftI32, dictionary ? 3 : 2);
+      writer.ListI32(static_cast<std::int32_t>(Encoding::kPlain));
+      writer.ListI32(static_cast<std::int32_t>(Encoding::kRle));
+      if (dictionary) {
+        writer.ListI32(static_cast<std::int32_t>(Encoding::kRleDictionary));
+      }
+      writer.BeginList(3, kThriftBinary, 1);
+      writer.ListBinary(schema.names[i]);
+      writer.I32(4, static_cast<std::int32_t>(Codec::kUncompressed));
+      writer.I64(5, chunk.num_values);
+      writer.I64(6, chunk.total_bytes);
+      writer.I64(7, chunk.total_bytes);
+      writer.I64(9, chunk.data_page_offset);
+      if (dictionary) {
+        writer.I64(11, chunk.dictionary_page_offset);
+      }
+      writer.BeginStruct(12);
+      writer.I64(3, chunk.null_count);
+      if (chunk.has_min_max) {
+        writer.Binary(5, chunk.max_value);
+        writer.Binary(6, chunk.min_value);
+      }
+      writer.EndStruct();
+      writer.EndStruct();
+      writer.EndStruct();
+    }
+    writer.I64(2, row_group.total_bytes);
+    writer.I64(3, row_group.num_rows);
+    writer.I64(5, row_group.offset);
+    writer.I64(6, row_group.total_bytes);
+    writer.EndStruct();
+  }
+  writer.Binary(6, "ScratchRobin");
+  // TYPE_ORDER for every column, so readers trust min/max statistics
+  writer.BeginList(7, kThriftStruct, schema.names.size());
+  for (std::size_t i = 0; i < schema.names.size(); ++i) {
+    writer.ListStruct();
+    writer.BeginStruct(1);
+    writer.EndStruct();
+    writer.EndStruct();
+  }
+  writer.EndStruct();
+
+  *out += metadata;
+  PutLE32(static_cast<std::uint32_t>(metadata.size()), *out);
+  *out += kParquetMagic;
+}
+
+// ============================================================================
+// ParquetReader
+// ============================================================================
+
+Status ParquetReader::Open(std::string_view file) {
+  file_ = file;
+  schema_ = ColumnarSchema{};
+  columns_.clear();
+  row_groups_.clear();
+  total_rows_ = 0;
+
+  const std::size_t magic = kParquetMagic.size();
+  if (file.size() < 2 * magic + 4 || file.substr(0, magic) != kParquetMagic ||
+      file.substr(file.size() - magic) != kParquetMagic) {
+    return Status::Error("Not a Parquet file");
+  }
+  const auto footer_size = static_cast<std::size_t>(GetLE(file.data() + file.size() - magic - 4, 4));
+  if (footer_size > file.size() - 2 * magic - 4) {
+    return Status::Error("Corrupt Parquet footer");
+  }
+  const std::size_t footer_start = file.size() - magic - 4 - footer_size;
+
+  struct Element {
+    int type{-1};
+    int repetition{kRepetitionRequired};
+    std::string name;
+    int children{0};
+    int converted{-1};
+    int logical{-1};
+  };
+  std::vector<Element> elements;
+
+  ThriftReader reader(file.substr(footer_start, footer_size));
+  reader.Struct([&](int id, std::uint8_t type) {
+    std::uint8_t element_type = 0;
+    switch (id) {
+      case 2: {  // schema
+        const std::size_t count = reader.List(&element_type);
+        for (std::size_t i = 0; i < count && reader.Ok(); ++i) {
+          Element element;
+          reader.Struct([&](int field, std::uint8_t field_type) {
+            switch (field) {
+              case 1: element.type = static_cast<int>(reader.Int()); break;
+              case 3: element.repetition = static_cast<int>(reader.Int()); break;
+              case 4: element.name = std::string(reader.Binary()); break;
+              case 5: element.children = static_cast<int>(reader.Int()); break;
+              case 6: element.converted = static_cast<int>(reader.Int()); break;
+              case 10:
+                reader.Struct([&](int logical, std::uint8_t logical_type) {
+                  element.logical = logical;
+                  reader.Skip(logical_type);
+                });
+                break;
+              default: reader.Skip(field_type); break;
+            }
+          });
+          elements.push_back(std::move(element));
+        }
+        break;
+      }
+      case 3:
+        total_rows_ = reader.Int();
+        break;
+      case 4: {  // row_groups
+        const std::size_t count = reader.List(&element_type);
+        for (std::size_t i = 0; i < count && reader.Ok(); ++i) {
+          RowGroup row_group;
+          reader.Struct([&](int field, std::uint8_t field_type) {
+            if (field == 3) {
+              row_group.num_rows = reader.Int();
+              return;
+            }
+            if (field != 1) {
+              reader.Skip(field_type);
+              return;
+            }
+            std::uint8_t chunk_type = 0;
+            const std::size_t chunks = reader.List(&chunk_type);
+            for (std::size_t c = 0; c < chunks && reader.Ok(); ++c) {
+              Chunk chunk;
+              std::int64_t data_offset = -1;
+              std::int64_t dictionary_offset = -1;
+              bool external = false;
+              std::string_view old_min, old_max;
+              reader.Struct([&](int chunk_field, std::uint8_t chunk_field_type) {
+                if (chunk_field == 1) {
+                  external = !reader.Binary().empty();
+                  return;
+                }
+                if (chunk_field != 3) {
+                  reader.Skip(chunk_field_type);
+                  return;
+                }
+                reader.Struct([&](int meta, std::uint8_t meta_type) {
+                  switch (meta) {
+                    case 4: chunk.codec = static_cast<int>(reader.Int()); break;
+                    case 5: chunk.num_values = reader.Int(); break;
+                    case 7: chunk.size = reader.Int(); break;
+                    case 9: data_offset = reader.Int(); break;
+                    case 11: dictionary_offset = reader.Int(); break;
+                    case 12:
+                      reader.Struct([&](int stat, std::uint8_t stat_type) {
+                        switch (stat) {
+                          case 1: old_max = reader.Binary(); break;
+                          case 2: old_min = reader.Binary(); break;
+                          case 3: chunk.null_count = reader.Int(); break;
+                          case 5: chunk.max_value = reader.Binary(); chunk.has_bounds = true; break;
+                          case 6: chunk.min_value = reader.Binary(); break;
+                          default: reader.Skip(stat_type); break;
+                        }
+                      });
+                      break;
+                    default: reader.Skip(meta_type); break;
+                  }
+                });
+              });
+              if (external) {
+                data_offset = -1;  // Column data in another file
+              }
+              chunk.start = dictionary_offset > 0 ? std::min(dictionary_offset, data_offset)
+                                                  : data_offset;
+              if (!chunk.has_bounds && old_min.data() && old_max.data()) {
+                // Deprecated min/max use signed order, right for numbers only
+                chunk.min_value = old_min;
+                chunk.max_value = old_max;
+                chunk.has_bounds = true;
+              } else if (chunk.has_bounds && !chunk.min_value.data()) {
+                chunk.has_bounds = false;
+              }
+              row_group.chunks.push_back(chunk);
+            }
+          });
+          row_groups_.push_back(std::move(row_group));
+        }
+        break;
+      }
+      default:
+        reader.Skip(type);
+        break;
+    }
+  });
+  if (!reader.Ok() || elements.empty()) {
+    return Status::Error("Corrupt Parquet footer");
+  }
+
+  if (static_cast<std::size_t>(elements.front().children) != elements.size() - 1) {
+    return Status::Error("Nested Parquet schemas are not supported");
+  }
+  for (std::size_t i = 1; i < elements.size(); ++i) {
+    const Element& element = elements[i];
+    if (element.children > 0 || element.repetition == kRepetitionRepeated) {
+      return Status::Error("Nested Parquet schemas are not supported");
+    }
+    Column column;
+    column.physical_type = element.type;
+    column.required = element.repetition == kRepetitionRequired;
+    ColumnType type = ColumnType::kText;
+    switch (static_cast<PhysicalType>(element.type)) {
+      case PhysicalType::kBoolean:
+      case PhysicalType::kInt64:
+        type = ColumnType::kInt64;
+        break;
+      case PhysicalType::kInt32:
+        type = element.converted == kConvertedDate || element.logical == kLogicalDate
+                   ? ColumnType::kDate
+                   : ColumnType::kInt64;
+        break;
+      case PhysicalType::kFloat:
+      case PhysicalType::kDouble:
+        type = ColumnType::kDouble;
+        break;
+      case PhysicalType::kByteArray:
+        break;
+      default:
+        column.supported = false;
+        break;
+    }
+    columns_.push_back(column);
+    schema_.names.push_back(element.name);
+    schema_.types.push_back(type);
+  }
+
+  for (const auto& row_group : row_groups_) {
+    if (row_group.chunks.size() != columns_.size()) {
+      return Status::Error("Corrupt Parquet footer");
+    }
+    for (const auto& chunk : row_group.chunks) {
+      if (chunk.start < 0 || chunk.size < 0 ||
+          static_cast<std::uint64_t>(chunk.start) + static_cast<std::uint64_t>(chunk.size) >
+              footer_start) {
+        return Status::Error("Parquet column chunk lies outside the file");
+      }
+    }
+  }
+  return Status::Ok();
+}
+
+std::int64_t ParquetReader::RowGroupRows(std::size_t row_group) const {
+  return row_group < row_groups_.size() ? row_groups_[row_group].num_rows : 0;
+}
+
+ParquetReader::ColumnStatistics ParquetReader::Statistics(std::size_t row_group,
+                                                          std::size_t column) const {
+  ColumnStatistics stats;
+  if (row_group >= row_groups_.size() || column >= columns_.size()) {
+    return stats;
+  }
+  const Chunk& chunk = row_groups_[row_group].chunks[column];
+  stats.null_count = chunk.null_count;
+  stats.value_count = chunk.num_values;
+  if (!chunk.has_bounds || !columns_[column].supported) {
+    return stats;
+  }
+  const auto physical = static_cast<PhysicalType>(columns_[column].physical_type);
+  const ColumnType type = schema_.types[column];
+  stats.bounds = ColumnBuffer(type);
+  std::vector<std::uint64_t> fixed;
+  std::vector<std::string_view> text;
+  for (std::string_view bound : {chunk.min_value, chunk.max_value}) {
+    if (physical == PhysicalType::kByteArray) {
+      stats.bounds.AppendText(bound);
+      continue;
+    }
+    const std::size_t width = physical == PhysicalType::kBoolean ? 1
+                              : physical == PhysicalType::kInt32 || physical == PhysicalType::kFloat
+                                  ? 4
+                                  : 8;
+    if (bound.size() != width || !DecodePlain(physical, bound, 1, fixed, text)) {
+      stats.bounds = ColumnBuffer{};
+      return stats;
+    }
+    AppendFixed(fixed[0], type, &stats.bounds);
+  }
+  stats.has_bounds = true;
+  return stats;
+}
+
+Status ParquetReader::ReadRowGroup(std::size_t row_group, const std::vector<std::size_t>& columns,
+                                   ColumnTable* out) const {
+  if (row_group >= row_groups_.size()) {
+    return Status::Error("No such Parquet row group");
+  }
+  const RowGroup& group = row_groups_[row_group];
+  *out = ColumnTable{};
+  out->SetColumnCount(columns.size());
+  for (std::size_t i = 0; i < columns.size(); ++i) {
+    const std::size_t index = columns[i];
+    if (index >= columns_.size()) {
+      return Status::Error("No such Parquet column");
+    }
+    if (!columns_[index].supported) {
+      return Status::Error("Parquet column " + schema_.names[index] +
+                           " has an unsupported physical type");
+    }
+    out->SetColumnType(i, schema_.types[index]);
+    Status status = ReadChunk(columns_[index], group.chunks[index], schema_.types[index],
+                              &out->Column(i));
+    if (!status.ok) {
+      return status;
+    }
+    if (out->Column(i).Size() != static_cast<std::size_t>(group.num_rows)) {
+      return Status::Error("Parquet column " + schema_.names[index] +
+                           " does not match the row group's row count");
+    }
+  }
+  for (std::int64_t row = 0; row < group.num_rows; ++row) {
+    out->EndRow();
+  }
+  return Status::Ok();
+}
+
+Status ParquetReader::ReadChunk(const Column& column, const Chunk& chunk, ColumnType type,
+                                ColumnBuffer* out) const {
+  const auto physical = static_cast<PhysicalType>(column.physical_type);
+  const bool is_text = physical == PhysicalType::kByteArray;
+  auto corrupt = [] { return Status::Error("Corrupt Parquet page"); };
+
+  std::size_t pos = static_cast<std::size_t>(chunk.start);
+  const std::size_t end = pos + static_cast<std::size_t>(chunk.size);
+  std::string dictionary_storage;
+  std::vector<std::uint64_t> dictionary_fixed;
+  std::vector<std::string_view> dictionary_text;
+  bool have_dictionary = false;
+
+  std::string page_storage;
+  std::vector<std::uint32_t> levels;
+  std::vector<std::uint32_t> indices;
+  std::vector<std::uint64_t> fixed;
+  std::vector<std::string_view> text;
+  out->Reserve(static_cast<std::size_t>(chunk.num_values));
+
+  std::int64_t values_read = 0;
+  while (values_read < chunk.num_values) {
+    if (pos >= end) {
+      return Status::Error("Parquet column chunk ends early");
+    }
+    PageHeader header;
+    std::size_t header_size = 0;
+    if (!ParsePageHeader(file_.substr(pos, end - pos), &header, &header_size)) {
+      return corrupt();
+    }
+    pos += header_size;
+    if (static_cast<std::uint64_t>(header.compressed_size) > end - pos) {
+      return corrupt();
+    }
+    const std::string_view body = file_.substr(pos, static_cast<std::size_t>(header.compressed_size));
+    pos += static_cast<std::size_t>(header.compressed_size);
+
+    const auto num_values = static_cast<std::size_t>(header.num_values);
+    std::string_view values;
+    std::size_t present = num_values;
+    switch (static_cast<PageType>(header.type)) {
+      case PageType::kDictionaryPage: {
+        std::string_view page;
+        Status status = Decompress(chunk.codec, body, header.uncompressed_size,
+                                   dictionary_storage, &page);
+        if (!status.ok) {
+          return status;
+        }
+        if (!DecodePlain(physical, page, num_values, dictionary_fixed, dictionary_text)) {
+          return corrupt();
+        }
+        have_dictionary = true;
+        continue;
+      }
+      case PageType::kDataPage: {
+        std::string_view page;
+        Status status = Decompress(chunk.codec, body, header.uncompressed_size, page_storage, &page);
+        if (!status.ok) {
+          return status;
+        }
+        if (!column.required) {
+          if (header.level_encoding != static_cast<int>(Encoding::kRle) || page.size() < 4) {
+            return Status::Error("Unsupported Parquet definition level encoding");
+          }
+          const auto size = static_cast<std::size_t>(GetLE(page.data(), 4));
+          if (size > page.size() - 4 || !DecodeHybrid(page.substr(4, size), 1, num_values, levels)) {
+            return corrupt();
+          }
+          page.remove_prefix(4 + size);
+        }
+        values = page;
+        break;
+      }
+      case PageType::kDataPageV2: {
+        if (header.repetition_bytes != 0) {
+          return Status::Error("Nested Parquet schemas are not supported");
+        }
+        const auto level_bytes = static_cast<std::size_t>(header.definition_bytes);
+        if (level_bytes > body.size()) {
+          return corrupt();
+        }
+        if (!column.required && !DecodeHybrid(body.substr(0, level_bytes), 1, num_values, levels)) {
+          return corrupt();
+        }
+        values = body.substr(level_bytes);
+        if (header.values_compressed) {
+          Status status = Decompress(
+              chunk.codec, values,
+              header.uncompressed_size - static_cast<std::int64_t>(level_bytes), page_storage,
+              &values);
+          if (!status.ok) {
+            return status;
+          }
+        }
+        break;
+      }
+      default:
+        continue;  // Index pages
+    }
+    if (!column.required) {
+      present = static_cast<std::size_t>(std::count(levels.begin(), levels.end(), 1u));
+    }
+
+    const bool dictionary = header.encoding == static_cast<int>(Encoding::kPlainDictionary) ||
+                            header.encoding == static_cast<int>(Encoding::kRleDictionary);
+    if (dictionary) {
+      if (!have_dictionary || values.empty()) {
+        return corrupt();
+      }
+      const int bit_width = static_cast<unsigned char>(values[0]);
+      if (!DecodeHybrid(values.substr(1), bit_width, present, indices)) {
+        return corrupt();
+      }
+      const std::size_t entries = is_text ? dictionary_text.size() : dictionary_fixed.size();
+      for (std::uint32_t index : indices) {
+        if (index >= entries) {
+          return corrupt();
+        }
+      }
+    } else if (header.encoding == static_cast<int>(Encoding::kPlain)) {
+      if (!DecodePlain(physical, values, present, fixed, text)) {
+        return corrupt();
+      }
+    } else if (header.encoding == static_cast<int>(Encoding::kRle) &&
+               physical == PhysicalType::kBoolean) {
+      // Length-prefixed, bit width 1
+      if (values.size() < 4 ||
+          GetLE(values.data(), 4) > values.size() - 4 ||
+          !DecodeHybrid(values.substr(4, static_cast<std::size_t>(GetLE(values.data(), 4))), 1,
+                        present, indices)) {
+        return corrupt();
+      }
+      fixed.assign(indices.begin(), indices.end());
+    } else {
+      return Status::Error("Parquet encoding " + std::to_string(header.encoding) +
+                           " is not supported");
+    }
+
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < num_values; ++i) {
+      if (!column.required && levels[i] == 0) {
+        out->AppendNull();
+        continue;
+      }
+      const std::size_t value = dictionary ? indices[next] : next;
+      ++next;
+      if (is_text) {
+        out->AppendText(dictionary ? dictionary_text[value] : text[value]);
+      } else {
+        AppendFixed(dictionary ? dictionary_fixed[value] : fixed[value], type, out);
+      }
+    }
+    values_read += header.num_values;
+  }
+  return Status::Ok();
+}
+
+}  // namespace scratchrobin::core
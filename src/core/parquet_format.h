@@ -0,0 +1,140 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/columnar_schema.h"
+#include "core/result_set.h"
+#include "core/status.h"
+
+namespace scratchrobin::core {
+
+struct ParquetWriteOptions {
+  std::size_t page_bytes{1024 * 1024};        // Target size of a data page
+  std::size_t dictionary_bytes{1024 * 1024};  // Larger dictionaries fall back to PLAIN
+  bool use_dictionary{true};
+};
+
+// What the footer records about one column chunk.
+struct ParquetColumnChunk {
+  std::int64_t dictionary_page_offset{-1};  // -1 = PLAIN encoded
+  std::int64_t data_page_offset{0};
+  std::int64_t num_values{0};
+  std::int64_t total_bytes{0};
+  std::int64_t null_count{0};
+  bool has_min_max{false};
+  std::string min_value;  // PLAIN encoded, without length prefix
+  std::string max_value;
+};
+
+// Offsets are relative to the row group's first byte until the row group
+// is placed in a file (see AppendParquetFooter).
+struct ParquetRowGroup {
+  std::int64_t offset{0};
+  std::int64_t num_rows{0};
+  std::int64_t total_bytes{0};
+  std::vector<ParquetColumnChunk> columns;
+};
+
+/**
+ * Parquet writing, one row group per call
+ *
+ * Row groups do not depend on each other, so callers may encode them on
+ * several threads and concatenate the results behind the "PAR1" magic;
+ * the footer is written last from the collected ParquetRowGroup records.
+ * Columns are OPTIONAL and pages uncompressed. Each column chunk is
+ * dictionary encoded (RLE_DICTIONARY) unless its dictionary outgrows
+ * ParquetWriteOptions::dictionary_bytes, in which case it is PLAIN.
+ */
+inline constexpr std::string_view kParquetMagic = "PAR1";
+
+// Encodes rows [begin, end) of |columns| (one per schema column, each of
+// the schema type, all NULL, or any type for string columns) and appends
+// the pages to |out|.
+Status EncodeParquetRowGroup(const ColumnarSchema& schema,
+                             const std::vector<const ColumnBuffer*>& columns,
+                             std::size_t begin, std::size_t end,
+                             const ParquetWriteOptions& options, std::string* out,
+                             ParquetRowGroup* row_group);
+
+// Appends the file metadata, its length and the closing magic. Offsets in
+// |row_groups| must be absolute file offsets.
+void AppendParquetFooter(const ColumnarSchema& schema,
+                         const std::vector<ParquetRowGroup>& row_groups, std::string* out);
+
+/**
+ * ParquetReader - decodes the row groups of a flat Parquet file
+ *
+ * Handles what other tools commonly write for flat tables: required or
+ * optional columns, PLAIN and dictionary encodings, data page v1 and v2,
+ * and uncompressed or Snappy pages. BOOLEAN and integer columns read as
+ * kInt64 (DATE as kDate), FLOAT/DOUBLE as kDouble and BYTE_ARRAY as
+ * kText. Nested schemas, INT96 and fixed-length columns are rejected.
+ *
+ * The file view must outlive the reader. ReadRowGroup() is const and may
+ * run on several threads at once.
+ */
+class ParquetReader {
+ public:
+  // Min/max are decoded into |bounds| (row 0 = min, row 1 = max).
+  struct ColumnStatistics {
+    ColumnBuffer bounds;
+    bool has_bounds{false};
+    std::int64_t null_count{-1};  // -1 = not recorded
+    std::int64_t value_count{0};
+  };
+
+  Status Open(std::string_view file);
+
+  const ColumnarSchema& Schema() const { return schema_; }
+  std::size_t RowGroupCount() const { return row_groups_.size(); }
+  std::int64_t RowGroupRows(std::size_t row_group) const;
+  std::int64_t TotalRows() const { return total_rows_; }
+  ColumnStatistics Statistics(std::size_t row_group, std::size_t column) const;
+
+  // Decodes |columns| (schema indexes) of one row group into |out|, one
+  // output column per entry.
+  Status ReadRowGroup(std::size_t row_group, const std::vector<std::size_t>& columns,
+                      ColumnTable* out) const;
+
+ private:
+  struct Column {
+    int physical_type{0};
+    bool required{false};
+    bool supported{true};
+  };
+  struct Chunk {
+    int codec{0};
+    std::int64_t num_values{0};
+    std::int64_t start{0};
+    std::int64_t size{0};
+    std::int64_t null_count{-1};
+    bool has_bounds{false};
+    std::string_view min_value;
+    std::string_view max_value;
+  };
+  struct RowGroup {
+    std::int64_t num_rows{0};
+    std::vector<Chunk> chunks;
+  };
+
+  Status ReadChunk(const Column& column, const Chunk& chunk, ColumnType type,
+                   ColumnBuffer* out) const;
+
+  std::string_view file_;
+  ColumnarSchema schema_;
+  std::vector<Column> columns_;
+  std::vector<RowGroup> row_groups_;
+  std::int64_t total_rows_{0};
+};
+
+}  // namespace scratchrobin::core
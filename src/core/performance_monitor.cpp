@@ -11,12 +11,107 @@
 #include "core/performance_monitor.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <limits>
 #include <thread>
 #include <fstream>
 #include <sstream>
 
+#include "core/query_stats.h"
+#include "core/time_series.h"
+
 namespace scratchrobin::core {
 
+namespace {
+
+const std::vector<TimeSeriesField<SystemMetrics>>& SystemFields() {
+  static const std::vector<TimeSeriesField<SystemMetrics>> fields = {
+      {"cpu_percent", &SystemMetrics::cpu_percent},
+      {"memory_used_bytes", &SystemMetrics::memory_used_bytes},
+      {"memory_total_bytes", &SystemMetrics::memory_total_bytes},
+      {"memory_percent", &SystemMetrics::memory_percent},
+      {"disk_read_bytes", &SystemMetrics::disk_read_bytes},
+      {"disk_write_bytes", &SystemMetrics::disk_write_bytes},
+      {"network_in_bytes", &SystemMetrics::network_in_bytes},
+      {"network_out_bytes", &SystemMetrics::network_out_bytes},
+      {"thread_count", &SystemMetrics::thread_count},
+      {"open_file_descriptors", &SystemMetrics::open_file_descriptors},
+  };
+  return fields;
+}
+
+const std::vector<TimeSeriesField<DatabaseMetrics>>& DatabaseFields() {
+  static const std::vector<TimeSeriesField<DatabaseMetrics>> fields = {
+      {"active_connections", &DatabaseMetrics::active_connections},
+      {"total_connections", &DatabaseMetrics::total_connections},
+      {"transactions_per_sec", &DatabaseMetrics::transactions_per_sec},
+      {"queries_per_sec", &DatabaseMetrics::queries_per_sec},
+      {"cache_hits", &DatabaseMetrics::cache_hits},
+      {"cache_misses", &DatabaseMetrics::cache_misses},
+      {"cache_hit_ratio", &DatabaseMetrics::cache_hit_ratio},
+      {"disk_reads", &DatabaseMetrics::disk_reads},
+      {"disk_writes", &DatabaseMetrics::disk_writes},
+      {"lock_waits", &DatabaseMetrics::lock_waits},
+      {"deadlocks", &DatabaseMetrics::deadlocks},
+      {"temp_files_created", &DatabaseMetrics::temp_files_created},
+      {"temp_bytes_written", &DatabaseMetrics::temp_bytes_written},
+  };
+  return fields;
+}
+
+// Series names: "system.<field>" and "db.<database>.<field>"
+template <typename Record>
+std::vector<std::string> SeriesNames(const std::string& prefix,
+                                     const std::vector<TimeSeriesField<Record>>& fields) {
+  std::vector<std::string> names;
+  names.reserve(fields.size());
+  for (const auto& field : fields) {
+    names.push_back(prefix + field.name);
+  }
+  return names;
+}
+
+int64_t ToMilliseconds(const std::chrono::system_clock::time_point& time) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point FromMilliseconds(int64_t time_ms) {
+  return std::chrono::system_clock::time_point(std::chrono::milliseconds(time_ms));
+}
+
+double UsToMs(int64_t micros) {
+  return static_cast<double>(micros) / 1000.0;
+}
+
+QueryMetrics ToQueryMetrics(const QueryStatsEntry& entry) {
+  QueryMetrics metrics;
+  metrics.query_hash = entry.key;
+  metrics.query_text = entry.text;
+  metrics.execution_count = entry.count;
+  metrics.total_time_ms = entry.total_us / 1000;
+  metrics.min_time_ms = entry.min_us / 1000;
+  metrics.max_time_ms = entry.max_us / 1000;
+  metrics.avg_time_ms = entry.AverageUs() / 1000.0;
+  metrics.p50_time_ms = UsToMs(entry.p50_us);
+  metrics.p95_time_ms = UsToMs(entry.p95_us);
+  metrics.p99_time_ms = UsToMs(entry.p99_us);
+  metrics.rows_affected = entry.rows;
+  metrics.error_count = entry.errors;
+  metrics.last_executed = entry.last_executed;
+  return metrics;
+}
+
+std::vector<QueryMetrics> ToQueryMetrics(const std::vector<QueryStatsEntry>& entries) {
+  std::vector<QueryMetrics> result;
+  result.reserve(entries.size());
+  for (const auto& entry : entries) {
+    result.push_back(ToQueryMetrics(entry));
+  }
+  return result;
+}
+
+}  // namespace
+
 // Private implementation
 struct PerformanceMonitor::Impl {
   std::atomic<bool> running{false};
@@ -25,11 +120,13 @@ struct PerformanceMonitor::Impl {
   std::thread collection_thread;
   
   mutable std::mutex mutex;
-  std::map<std::string, QueryMetrics> query_metrics;
+  QueryStats query_stats;  // Lock-free; not guarded by |mutex|
   std::map<std::string, ConnectionPoolMetrics> pool_metrics;
-  std::vector<SystemMetrics> system_history;
-  std::map<std::string, std::vector<DatabaseMetrics>> database_metrics;
-  std::vector<PerformanceSnapshot> snapshots;
+  // System and per-database metrics, compressed and rolled up; only the
+  // latest snapshot is kept whole
+  TimeSeriesStore history;
+  PerformanceSnapshot latest;
+  bool has_latest = false;
   std::vector<PerformanceAlert> alerts;
   std::vector<MetricThreshold> thresholds;
   
@@ -98,19 +195,7 @@ void PerformanceMonitor::CollectNow() {
   }
   
   // Get top queries by execution count
-  std::vector<QueryMetrics> queries;
-  for (const auto& [hash, metrics] : impl_->query_metrics) {
-    (void)hash;
-    queries.push_back(metrics);
-  }
-  std::sort(queries.begin(), queries.end(),
-            [](const QueryMetrics& a, const QueryMetrics& b) {
-              return a.execution_count > b.execution_count;
-            });
-  if (queries.size() > 10) {
-    queries.resize(10);
-  }
-  snapshot.top_queries = queries;
+  snapshot.top_queries = ToQueryMetrics(impl_->query_stats.Top(10, QueryStatsOrder::kFrequent));
   
   // Get active alerts
   for (const auto& alert : impl_->alerts) {
@@ -119,17 +204,13 @@ void PerformanceMonitor::CollectNow() {
     }
   }
   
-  impl_->snapshots.push_back(snapshot);
-  impl_->system_history.push_back(snapshot.system);
-  
-  // Trim history (keep last 24 hours)
-  auto cutoff = std::chrono::system_clock::now() - std::chrono::hours(24);
-  impl_->snapshots.erase(
-      std::remove_if(impl_->snapshots.begin(), impl_->snapshots.end(),
-                     [cutoff](const PerformanceSnapshot& s) {
-                       return s.timestamp < cutoff;
-                     }),
-      impl_->snapshots.end());
+  const int64_t time_ms = ToMilliseconds(snapshot.timestamp);
+  for (const auto& field : SystemFields()) {
+    impl_->history.Append(std::string("system.") + field.name, time_ms,
+                          field.Get(snapshot.system));
+  }
+  impl_->latest = snapshot;
+  impl_->has_latest = true;
   
   if (impl_->metrics_callback) {
     impl_->metrics_callback(snapshot);
@@ -141,79 +222,43 @@ void PerformanceMonitor::RecordQueryExecution(const std::string& query_hash,
                                               int64_t execution_time_ms,
                                               int64_t rows_affected,
                                               bool success) {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto& metrics = impl_->query_metrics[query_hash];
-  metrics.query_hash = query_hash;
-  if (metrics.query_text.empty()) {
-    metrics.query_text = query_text;
-  }
-  ++metrics.execution_count;
-  metrics.total_time_ms += execution_time_ms;
-  if (metrics.min_time_ms == 0 || execution_time_ms < metrics.min_time_ms) {
-    metrics.min_time_ms = execution_time_ms;
-  }
-  if (execution_time_ms > metrics.max_time_ms) {
-    metrics.max_time_ms = execution_time_ms;
-  }
-  metrics.avg_time_ms = static_cast<double>(metrics.total_time_ms) / 
-                        metrics.execution_count;
-  metrics.rows_affected += rows_affected;
-  if (!success) {
-    ++metrics.error_count;
+  RecordQueryExecution(query_hash, query_text, std::chrono::milliseconds(execution_time_ms),
+                       rows_affected, success);
+}
+
+void PerformanceMonitor::RecordQueryExecution(const std::string& query_hash,
+                                              const std::string& query_text,
+                                              std::chrono::microseconds execution_time,
+                                              int64_t rows_affected,
+                                              bool success) {
+  if (query_hash.empty()) {
+    // Statements differing only in literals and layout share a hash
+    char key[17];
+    std::snprintf(key, sizeof(key), "%016llx",
+                  static_cast<unsigned long long>(StatementFingerprint(query_text)));
+    impl_->query_stats.Record(HashQueryKey(key), key, query_text, execution_time.count(),
+                              rows_affected, success);
+    return;
   }
-  metrics.last_executed = std::chrono::system_clock::now();
+  impl_->query_stats.Record(HashQueryKey(query_hash), query_hash, query_text,
+                            execution_time.count(), rows_affected, success);
 }
 
 std::vector<QueryMetrics> PerformanceMonitor::GetSlowQueries(int limit) const {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  std::vector<QueryMetrics> queries;
-  for (const auto& [hash, metrics] : impl_->query_metrics) {
-    (void)hash;
-    queries.push_back(metrics);
-  }
-  
-  std::sort(queries.begin(), queries.end(),
-            [](const QueryMetrics& a, const QueryMetrics& b) {
-              return a.avg_time_ms > b.avg_time_ms;
-            });
-  
-  if (static_cast<size_t>(limit) < queries.size()) {
-    queries.resize(limit);
-  }
-  
-  return queries;
+  return ToQueryMetrics(impl_->query_stats.Top(static_cast<std::size_t>(std::max(limit, 0)),
+                                               QueryStatsOrder::kSlowest));
 }
 
 std::vector<QueryMetrics> PerformanceMonitor::GetFrequentQueries(int limit) const {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  std::vector<QueryMetrics> queries;
-  for (const auto& [hash, metrics] : impl_->query_metrics) {
-    (void)hash;
-    queries.push_back(metrics);
-  }
-  
-  std::sort(queries.begin(), queries.end(),
-            [](const QueryMetrics& a, const QueryMetrics& b) {
-              return a.execution_count > b.execution_count;
-            });
-  
-  if (static_cast<size_t>(limit) < queries.size()) {
-    queries.resize(limit);
-  }
-  
-  return queries;
+  return ToQueryMetrics(impl_->query_stats.Top(static_cast<std::size_t>(std::max(limit, 0)),
+                                               QueryStatsOrder::kFrequent));
 }
 
 std::optional<QueryMetrics> PerformanceMonitor::GetQueryMetrics(
     const std::string& query_hash) const {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto it = impl_->query_metrics.find(query_hash);
-  if (it != impl_->query_metrics.end()) {
-    return it->second;
+  auto entry = impl_->query_stats.Find(HashQueryKey(query_hash));
+  if (entry) {
+    return ToQueryMetrics(*entry);
   }
   return std::nullopt;
 }
@@ -302,67 +347,90 @@ SystemMetrics PerformanceMonitor::GetCurrentSystemMetrics() const {
   }
   
   // Get number of active threads
-  metrics.active_threads = std::thread::hardware_concurrency();
+  metrics.thread_count = static_cast<int>(std::thread::hardware_concurrency());
   
   return metrics;
 }
 
 std::vector<SystemMetrics> PerformanceMonitor::GetSystemMetricsHistory(
     std::chrono::minutes duration) const {
+  const auto& fields = SystemFields();
+  const int64_t from_ms = ToMilliseconds(std::chrono::system_clock::now() - duration);
   std::lock_guard<std::mutex> lock(impl_->mutex);
   
-  auto cutoff = std::chrono::system_clock::now() - duration;
   std::vector<SystemMetrics> result;
-  
-  for (const auto& metrics : impl_->system_history) {
-    if (metrics.timestamp >= cutoff) {
-      result.push_back(metrics);
+  for (const auto& row : impl_->history.Rows(SeriesNames("system.", fields), from_ms,
+                                             std::numeric_limits<int64_t>::max(),
+                                             TimeSeriesResolution::kAuto)) {
+    SystemMetrics metrics;
+    metrics.timestamp = FromMilliseconds(row.time_ms);
+    for (std::size_t f = 0; f < fields.size(); ++f) {
+      fields[f].Set(&metrics, row.values[f]);
     }
+    result.push_back(metrics);
   }
-  
   return result;
 }
 
 void PerformanceMonitor::RecordDatabaseMetrics(const std::string& database_name,
                                                const DatabaseMetrics& metrics) {
+  const auto timestamp = metrics.timestamp.time_since_epoch().count() == 0
+                             ? std::chrono::system_clock::now()
+                             : metrics.timestamp;
+  const int64_t time_ms = ToMilliseconds(timestamp);
+  const std::string prefix = "db." + database_name + ".";
   std::lock_guard<std::mutex> lock(impl_->mutex);
-  impl_->database_metrics[database_name].push_back(metrics);
+  for (const auto& field : DatabaseFields()) {
+    impl_->history.Append(prefix + field.name, time_ms, field.Get(metrics));
+  }
 }
 
 std::vector<DatabaseMetrics> PerformanceMonitor::GetDatabaseMetrics(
     const std::string& database_name) const {
+  const auto& fields = DatabaseFields();
   std::lock_guard<std::mutex> lock(impl_->mutex);
   
-  auto it = impl_->database_metrics.find(database_name);
-  if (it != impl_->database_metrics.end()) {
-    return it->second;
+  std::vector<DatabaseMetrics> result;
+  for (const auto& row : impl_->history.Rows(SeriesNames("db." + database_name + ".", fields),
+                                             0,
+                                             std::numeric_limits<int64_t>::max(),
+                                             TimeSeriesResolution::kAuto)) {
+    DatabaseMetrics metrics;
+    metrics.database_name = database_name;
+    metrics.timestamp = FromMilliseconds(row.time_ms);
+    for (std::size_t f = 0; f < fields.size(); ++f) {
+      fields[f].Set(&metrics, row.values[f]);
+    }
+    result.push_back(metrics);
   }
-  return {};
+  return result;
 }
 
 PerformanceSnapshot PerformanceMonitor::GetCurrentSnapshot() const {
   std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  if (!impl_->snapshots.empty()) {
-    return impl_->snapshots.back();
-  }
-  
-  return PerformanceSnapshot{};
+  return impl_->has_latest ? impl_->latest : PerformanceSnapshot{};
 }
 
 std::vector<PerformanceSnapshot> PerformanceMonitor::GetSnapshotHistory(
     std::chrono::minutes duration) const {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  
-  auto cutoff = std::chrono::system_clock::now() - duration;
+  const auto cutoff = std::chrono::system_clock::now() - duration;
   std::vector<PerformanceSnapshot> result;
-  
-  for (const auto& snapshot : impl_->snapshots) {
-    if (snapshot.timestamp >= cutoff) {
-      result.push_back(snapshot);
+  for (const SystemMetrics& system : GetSystemMetricsHistory(duration)) {
+    PerformanceSnapshot snapshot;
+    snapshot.timestamp = system.timestamp;
+    snapshot.system = system;
+    result.push_back(std::move(snapshot));
+  }
+
+  // Older snapshots only have their system metrics; the latest is whole
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  if (impl_->has_latest && impl_->latest.timestamp >= cutoff) {
+    const int64_t latest_ms = ToMilliseconds(impl_->latest.timestamp);
+    while (!result.empty() && ToMilliseconds(result.back().timestamp) >= latest_ms) {
+      result.pop_back();
     }
+    result.push_back(impl_->latest);
   }
-  
   return result;
 }
 
@@ -461,7 +529,7 @@ std::vector<std::string> PerformanceMonitor::GetPerformanceRecommendations() con
 
 void PerformanceMonitor::SetPerformanceBaseline() {
   std::lock_guard<std::mutex> lock(impl_->mutex);
-  impl_->baseline = GetCurrentSnapshot();
+  impl_->baseline = impl_->has_latest ? impl_->latest : PerformanceSnapshot{};
   impl_->has_baseline = true;
 }
 
@@ -483,13 +551,13 @@ void PerformanceMonitor::SetMetricsCallback(MetricsCallback callback) {
 
 void PerformanceMonitor::ClearHistory() {
   std::lock_guard<std::mutex> lock(impl_->mutex);
-  impl_->snapshots.clear();
-  impl_->system_history.clear();
+  impl_->history.Clear();
+  impl_->latest = PerformanceSnapshot{};
+  impl_->has_latest = false;
 }
 
 void PerformanceMonitor::ClearQueryMetrics() {
-  std::lock_guard<std::mutex> lock(impl_->mutex);
-  impl_->query_metrics.clear();
+  impl_->query_stats.Clear();
 }
 
 void PerformanceMonitor::ExportMetrics(const std::string& file_path,
@@ -45,6 +45,9 @@ struct QueryMetrics {
   int64_t min_time_ms{0};
   int64_t max_time_ms{0};
   double avg_time_ms{0.0};
+  double p50_time_ms{0.0};
+  double p95_time_ms{0.0};
+  double p99_time_ms{0.0};
   int64_t rows_returned{0};
   int64_t rows_affected{0};
   int64_t error_count{0};
@@ -157,12 +160,19 @@ class PerformanceMonitor {
   void StopCollection();
   void CollectNow();
   
-  // Query metrics
+  // Query metrics. Recording takes no lock, so it can stay on for every
+  // query; an empty hash groups the query with those differing from it
+  // only in literals and layout.
   void RecordQueryExecution(const std::string& query_hash,
                             const std::string& query_text,
                             int64_t execution_time_ms,
                             int64_t rows_affected,
                             bool success);
+  void RecordQueryExecution(const std::string& query_hash,
+                            const std::string& query_text,
+                            std::chrono::microseconds execution_time,
+                            int64_t rows_affected,
+                            bool success);
   std::vector<QueryMetrics> GetSlowQueries(int limit = 10) const;
   std::vector<QueryMetrics> GetFrequentQueries(int limit = 10) const;
   std::optional<QueryMetrics> GetQueryMetrics(const std::string& query_hash) const;
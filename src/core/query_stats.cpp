@@ -0,0 +1,454 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/query_stats.h"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <map>
+
+#include "core/sql_lexer.h"
+
+namespace scratchrobin::core {
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+constexpr std::size_t kMaxProbes = 32;
+
+uint64_t HashByte(uint64_t hash, unsigned char byte) {
+  return (hash ^ byte) * kFnvPrime;
+}
+
+// 0 marks a free slot
+uint64_t SlotKey(uint64_t fingerprint) {
+  return fingerprint == 0 ? 1 : fingerprint;
+}
+
+int64_t NowMilliseconds() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+// ============================================================================
+// QueryLatencyHistogram
+// ============================================================================
+
+std::size_t QueryLatencyHistogram::BucketFor(int64_t micros) {
+  const uint64_t value =
+      std::min<uint64_t>(static_cast<uint64_t>(std::max<int64_t>(micros, 0)), 0xFFFFFFFFULL);
+  const int top_bit = std::bit_width(value) - 1;
+  const int shift = std::max(top_bit - kSubBucketBits, 0);
+  return (static_cast<std::size_t>(shift) << kSubBucketBits) +
+         static_cast<std::size_t>(value >> shift);
+}
+
+int64_t QueryLatencyHistogram::LowerBoundUs(std::size_t bucket) {
+  constexpr std::size_t kSub = std::size_t{1} << kSubBucketBits;
+  if (bucket < 2 * kSub) {
+    return static_cast<int64_t>(bucket);
+  }
+  const std::size_t shift = bucket / kSub - 1;
+  return static_cast<int64_t>(bucket - shift * kSub) << shift;
+}
+
+int64_t QueryLatencyHistogram::WidthUs(std::size_t bucket) {
+  constexpr std::size_t kSub = std::size_t{1} << kSubBucketBits;
+  return bucket < 2 * kSub ? 1 : int64_t{1} << (bucket / kSub - 1);
+}
+
+void QueryLatencyHistogram::Record(int64_t micros) {
+  micros = std::max<int64_t>(micros, 0);
+  ++buckets[BucketFor(micros)];
+  min_us = count == 0 ? micros : std::min(min_us, micros);
+  max_us = std::max(max_us, micros);
+  total_us += micros;
+  ++count;
+}
+
+void QueryLatencyHistogram::Merge(const QueryLatencyHistogram& other) {
+  if (other.count == 0) {
+    return;
+  }
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    buckets[i] += other.buckets[i];
+  }
+  min_us = count == 0 ? other.min_us : std::min(min_us, other.min_us);
+  max_us = std::max(max_us, other.max_us);
+  total_us += other.total_us;
+  count += other.count;
+}
+
+int64_t QueryLatencyHistogram::PercentileUs(double percentile) const {
+  if (count <= 0) {
+    return 0;
+  }
+  const double clamped = std::clamp(percentile, 0.0, 100.0);
+  const auto rank = std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(clamped / 100.0 * static_cast<double>(count))));
+  if (rank >= count) {
+    return max_us;
+  }
+  int64_t seen = 0;
+  for (std::size_t i = 0; i < kBucketCount; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      const int64_t middle = LowerBoundUs(i) + WidthUs(i) / 2;
+      return std::clamp(middle, min_us, max_us);
+    }
+  }
+  return max_us;
+}
+
+// ============================================================================
+// Fingerprints
+// ============================================================================
+
+uint64_t StatementFingerprint(std::string_view sql) {
+  static const SqlLexer lexer;
+  uint64_t hash = kFnvOffset;
+  SqlLexState state = SqlLexState::kNormal;
+  SqlToken token;
+  for (std::size_t pos = 0; pos < sql.size(); pos += token.length) {
+    state = lexer.Next(sql, pos, state, &token);
+    if (token.length == 0) {
+      break;
+    }
+    const std::string_view text = token.Text(sql);
+    switch (token.kind) {
+      case SqlTokenKind::kWhitespace:
+      case SqlTokenKind::kComment:
+        continue;
+      case SqlTokenKind::kString:
+      case SqlTokenKind::kNumber:
+        hash = HashByte(hash, '?');
+        break;
+      case SqlTokenKind::kKeyword:
+      case SqlTokenKind::kFunction:
+      case SqlTokenKind::kIdentifier:
+        for (char c : text) {
+          hash = HashByte(hash, static_cast<unsigned char>(
+                                    std::toupper(static_cast<unsigned char>(c))));
+        }
+        break;
+      default:
+        if (text == ";") {
+          continue;
+        }
+        for (char c : text) {
+          hash = HashByte(hash, static_cast<unsigned char>(c));
+        }
+        break;
+    }
+    hash = HashByte(hash, 0x1F);  // Keeps "a b" apart from "ab"
+  }
+  return hash;
+}
+
+uint64_t HashQueryKey(std::string_view key) {
+  uint64_t hash = kFnvOffset;
+  for (char c : key) {
+    hash = HashByte(hash, static_cast<unsigned char>(c));
+  }
+  return hash;
+}
+
+// ============================================================================
+// QueryStats
+// ============================================================================
+
+// Written by the owning thread only, so updates are a load and a store;
+// the atomics are for the readers
+struct QueryStats::Slot {
+  std::atomic<uint64_t> fingerprint{0};
+  std::atomic<int64_t> count{0};
+  std::atomic<int64_t> errors{0};
+  std::atomic<int64_t> rows{0};
+  std::atomic<int64_t> total_us{0};
+  std::atomic<int64_t> min_us{std::numeric_limits<int64_t>::max()};
+  std::atomic<int64_t> max_us{0};
+  std::atomic<int64_t> last_ms{0};
+  // Allocated by the first record, so unused slots stay small
+  std::atomic<std::atomic<uint32_t>*> buckets{nullptr};
+};
+
+struct QueryStats::Shard {
+  explicit Shard(std::size_t capacity) : slots(new Slot[capacity]), capacity(capacity) {}
+  ~Shard() {
+    for (std::size_t i = 0; i < capacity; ++i) {
+      delete[] slots[i].buckets.load(std::memory_order_relaxed);
+    }
+  }
+
+  std::unique_ptr<Slot[]> slots;
+  std::size_t capacity;
+  std::atomic<uint64_t> epoch{0};  // Of the QueryStats its counters belong to
+  std::atomic<int64_t> dropped{0};
+};
+
+namespace {
+
+std::atomic<uint64_t> next_stats_id{1};
+
+template <typename T>
+void Add(std::atomic<T>& counter, T delta) {
+  counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+QueryStats::QueryStats(QueryStatsOptions options)
+    : id_(next_stats_id.fetch_add(1, std::memory_order_relaxed)),
+      capacity_(std::bit_ceil(std::max<std::size_t>(options.capacity, 1))) {}
+
+QueryStats::~QueryStats() = default;
+
+QueryStats::Shard& QueryStats::LocalShard() {
+  // Shards this thread records into, by instance; instances are never
+  // reused, so entries of destroyed ones are only dead weight
+  struct Cached {
+    uint64_t id;
+    Shard* shard;
+  };
+  thread_local std::vector<Cached> cache;
+  for (const Cached& cached : cache) {
+    if (cached.id == id_) {
+      return *cached.shard;
+    }
+  }
+
+  auto shard = std::make_unique<Shard>(capacity_);
+  shard->epoch.store(epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  Shard* local = shard.get();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shards_.push_back(std::move(shard));
+  }
+  if (cache.size() >= 8) {
+    cache.erase(cache.begin());  // A thread using that one again gets a second shard
+  }
+  cache.push_back(Cached{id_, local});
+  return *local;
+}
+
+QueryStats::Slot* QueryStats::Claim(Shard& shard, uint64_t fingerprint, std::string_view key,
+                                    std::string_view text) {
+  const uint64_t wanted = SlotKey(fingerprint);
+  const std::size_t mask = shard.capacity - 1;
+  std::size_t index = static_cast<std::size_t>(wanted) & mask;
+  for (std::size_t probe = 0; probe < kMaxProbes && probe <= mask; ++probe) {
+    Slot& slot = shard.slots[index];
+    const uint64_t seen = slot.fingerprint.load(std::memory_order_relaxed);
+    if (seen == wanted) {
+      return &slot;
+    }
+    if (seen == 0) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        names_.try_emplace(wanted, Names{std::string(key), std::string(text)});
+      }
+      if (slot.buckets.load(std::memory_order_relaxed) == nullptr) {
+        slot.buckets.store(new std::atomic<uint32_t>[QueryLatencyHistogram::kBucketCount](),
+                           std::memory_order_release);
+      }
+      slot.fingerprint.store(wanted, std::memory_order_release);
+      return &slot;
+    }
+    index = (index + 1) & mask;
+  }
+  return nullptr;
+}
+
+void QueryStats::Record(uint64_t fingerprint, std::string_view key, std::string_view text,
+                        int64_t latency_us, int64_t rows, bool success) {
+  Shard& shard = LocalShard();
+  const uint64_t epoch = epoch_.load(std::memory_order_acquire);
+  if (shard.epoch.load(std::memory_order_relaxed) != epoch) {
+    // Cleared since this thread last recorded: free every slot for new
+    // fingerprints. Histograms are zeroed, not freed, since a reader that
+    // listed this shard before the Clear() may still be reading them;
+    // Claim() reuses them.
+    for (std::size_t i = 0; i < shard.capacity; ++i) {
+      Slot& slot = shard.slots[i];
+      slot.fingerprint.store(0, std::memory_order_relaxed);
+      slot.count.store(0, std::memory_order_relaxed);
+      slot.errors.store(0, std::memory_order_relaxed);
+      slot.rows.store(0, std::memory_order_relaxed);
+      slot.total_us.store(0, std::memory_order_relaxed);
+      slot.min_us.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+      slot.max_us.store(0, std::memory_order_relaxed);
+      std::atomic<uint32_t>* buckets = slot.buckets.load(std::memory_order_relaxed);
+      for (std::size_t b = 0; buckets != nullptr && b < QueryLatencyHistogram::kBucketCount; ++b) {
+        buckets[b].store(0, std::memory_order_relaxed);
+      }
+    }
+    shard.dropped.store(0, std::memory_order_relaxed);
+    shard.epoch.store(epoch, std::memory_order_release);
+  }
+
+  Slot* slot = Claim(shard, fingerprint, key, text);
+  if (slot == nullptr) {
+    Add<int64_t>(shard.dropped, 1);
+    return;
+  }
+  latency_us = std::max<int64_t>(latency_us, 0);
+  std::atomic<uint32_t>* buckets = slot->buckets.load(std::memory_order_relaxed);
+  Add<uint32_t>(buckets[QueryLatencyHistogram::BucketFor(latency_us)], 1);
+  Add(slot->total_us, latency_us);
+  if (rows != 0) {
+    Add(slot->rows, rows);
+  }
+  if (!success) {
+    Add<int64_t>(slot->errors, 1);
+  }
+  if (latency_us < slot->min_us.load(std::memory_order_relaxed)) {
+    slot->min_us.store(latency_us, std::memory_order_relaxed);
+  }
+  if (latency_us > slot->max_us.load(std::memory_order_relaxed)) {
+    slot->max_us.store(latency_us, std::memory_order_relaxed);
+  }
+  slot->last_ms.store(NowMilliseconds(), std::memory_order_relaxed);
+  // Last, so a reader seeing the count sees a histogram holding as many
+  slot->count.store(slot->count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+std::vector<const QueryStats::Shard*> QueryStats::CurrentShards() const {
+  const uint64_t epoch = epoch_.load(std::memory_order_acquire);
+  std::vector<const Shard*> shards;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& shard : shards_) {
+    if (shard->epoch.load(std::memory_order_acquire) == epoch) {
+      shards.push_back(shard.get());
+    }
+  }
+  return shards;
+}
+
+int64_t QueryStats::Dropped() const {
+  int64_t dropped = 0;
+  for (const Shard* shard : CurrentShards()) {
+    dropped += shard->dropped.load(std::memory_order_relaxed);
+  }
+  return dropped;
+}
+
+void QueryStats::Collect(uint64_t only, std::vector<QueryStatsEntry>* entries) const {
+  // Slots of each fingerprint, over all shards
+  std::map<uint64_t, std::vector<const Slot*>> slots;
+  for (const Shard* shard : CurrentShards()) {
+    for (std::size_t i = 0; i < shard->capacity; ++i) {
+      const Slot& slot = shard->slots[i];
+      const uint64_t fingerprint = slot.fingerprint.load(std::memory_order_acquire);
+      if (fingerprint == 0 || (only != 0 && fingerprint != only)) {
+        continue;
+      }
+      if (slot.count.load(std::memory_order_acquire) > 0) {
+        slots[fingerprint].push_back(&slot);
+      }
+    }
+  }
+
+  QueryLatencyHistogram histogram;
+  for (const auto& [fingerprint, parts] : slots) {
+    histogram = QueryLatencyHistogram();
+    QueryStatsEntry entry;
+    entry.fingerprint = fingerprint;
+    int64_t last_ms = 0;
+    for (const Slot* slot : parts) {
+      const int64_t count = slot->count.load(std::memory_order_acquire);
+      const std::atomic<uint32_t>* buckets = slot->buckets.load(std::memory_order_acquire);
+      for (std::size_t b = 0; b < QueryLatencyHistogram::kBucketCount; ++b) {
+        histogram.buckets[b] += buckets[b].load(std::memory_order_relaxed);
+      }
+      const int64_t min_us = slot->min_us.load(std::memory_order_relaxed);
+      histogram.min_us = histogram.count == 0 ? min_us : std::min(histogram.min_us, min_us);
+      histogram.max_us = std::max(histogram.max_us, slot->max_us.load(std::memory_order_relaxed));
+      histogram.total_us += slot->total_us.load(std::memory_order_relaxed);
+      histogram.count += count;
+      entry.errors += slot->errors.load(std::memory_order_relaxed);
+      entry.rows += slot->rows.load(std::memory_order_relaxed);
+      last_ms = std::max(last_ms, slot->last_ms.load(std::memory_order_relaxed));
+    }
+    entry.count = histogram.count;
+    entry.total_us = histogram.total_us;
+    entry.min_us = histogram.min_us;
+    entry.max_us = histogram.max_us;
+    entry.p50_us = histogram.PercentileUs(50.0);
+    entry.p95_us = histogram.PercentileUs(95.0);
+    entry.p99_us = histogram.PercentileUs(99.0);
+    entry.last_executed =
+        std::chrono::system_clock::time_point(std::chrono::milliseconds(last_ms));
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = names_.find(fingerprint);
+      if (it != names_.end()) {
+        entry.key = it->second.key;
+        entry.text = it->second.text;
+      }
+    }
+    entries->push_back(std::move(entry));
+  }
+}
+
+std::optional<QueryStatsEntry> QueryStats::Find(uint64_t fingerprint) const {
+  std::vector<QueryStatsEntry> entries;
+  Collect(SlotKey(fingerprint), &entries);
+  if (entries.empty()) {
+    return std::nullopt;
+  }
+  return std::move(entries.front());
+}
+
+std::vector<QueryStatsEntry> QueryStats::Entries() const {
+  std::vector<QueryStatsEntry> entries;
+  Collect(0, &entries);
+  return entries;
+}
+
+std::vector<QueryStatsEntry> QueryStats::Top(std::size_t k, QueryStatsOrder order) const {
+  auto better = [order](const QueryStatsEntry& a, const QueryStatsEntry& b) {
+    if (order == QueryStatsOrder::kSlowest && a.AverageUs() != b.AverageUs()) {
+      return a.AverageUs() > b.AverageUs();
+    }
+    if (a.count != b.count) {
+      return a.count > b.count;
+    }
+    return a.fingerprint < b.fingerprint;
+  };
+
+  // A heap of the best |k| so far, worst on top
+  std::vector<QueryStatsEntry> top;
+  if (k == 0) {
+    return top;
+  }
+  top.reserve(k + 1);
+  for (QueryStatsEntry& entry : Entries()) {
+    if (top.size() == k && !better(entry, top.front())) {
+      continue;
+    }
+    top.push_back(std::move(entry));
+    std::push_heap(top.begin(), top.end(), better);
+    if (top.size() > k) {
+      std::pop_heap(top.begin(), top.end(), better);
+      top.pop_back();
+    }
+  }
+  std::sort_heap(top.begin(), top.end(), better);
+  return top;
+}
+
+void QueryStats::Clear() {
+  epoch_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+}  // namespace scratchrobin::core
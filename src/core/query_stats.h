@@ -0,0 +1,146 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace scratchrobin::core {
+
+// Log-linear ("HDR") latency histogram in microseconds: 16 buckets per
+// power of two, so no bucket is wider than 1/16 of its values and a
+// percentile taken at a bucket's middle is within ~3%. Values of 2^32 us
+// (~71 minutes) and more land in the last bucket.
+struct QueryLatencyHistogram {
+  static constexpr int kSubBucketBits = 4;
+  static constexpr std::size_t kBucketCount = 464;
+
+  std::array<int64_t, kBucketCount> buckets{};
+  int64_t count{0};
+  int64_t total_us{0};
+  int64_t min_us{0};
+  int64_t max_us{0};
+
+  void Record(int64_t micros);
+  void Merge(const QueryLatencyHistogram& other);
+  // Middle of the bucket holding the given percentile (0-100), clamped
+  // to the recorded min and max
+  int64_t PercentileUs(double percentile) const;
+
+  static std::size_t BucketFor(int64_t micros);
+  static int64_t LowerBoundUs(std::size_t bucket);
+  static int64_t WidthUs(std::size_t bucket);
+};
+
+// Hash of a statement with its literals and layout left out, so
+// "SELECT * FROM t WHERE id = 1" and "select *\nfrom t where id=2" share
+// one. Comments, whitespace, keyword case and trailing semicolons do not
+// count; strings and numbers all count as one placeholder.
+uint64_t StatementFingerprint(std::string_view sql);
+
+// FNV-1a of a caller's own key for a query, e.g. a hash it computed
+uint64_t HashQueryKey(std::string_view key);
+
+struct QueryStatsOptions {
+  std::size_t capacity = 512;  // Fingerprints per thread, rounded up to a power of two
+};
+
+// Everything recorded for one fingerprint, over all shards
+struct QueryStatsEntry {
+  uint64_t fingerprint = 0;
+  std::string key;   // As first recorded
+  std::string text;  // As first recorded
+  int64_t count = 0;
+  int64_t errors = 0;
+  int64_t rows = 0;
+  int64_t total_us = 0;
+  int64_t min_us = 0;
+  int64_t max_us = 0;
+  int64_t p50_us = 0;
+  int64_t p95_us = 0;
+  int64_t p99_us = 0;
+  std::chrono::system_clock::time_point last_executed;
+
+  double AverageUs() const {
+    return count > 0 ? static_cast<double>(total_us) / static_cast<double>(count) : 0.0;
+  }
+};
+
+enum class QueryStatsOrder : std::uint8_t {
+  kSlowest,   // Highest average latency
+  kFrequent,  // Most executions
+};
+
+/**
+ * QueryStats - per-fingerprint query latency, cheap enough for every query
+ *
+ * Each recording thread gets its own shard, a fixed open-addressed table
+ * of counters and histograms that only it writes, so Record() is a few
+ * plain stores: no lock, no read-modify-write, no cache line shared with
+ * another writer. Only a thread's first record, and the first of each
+ * fingerprint in its shard, take a lock. Readers merge the shards; they
+ * see each counter as of some moment during the merge, not one
+ * consistent instant. A full shard drops the records of further
+ * fingerprints and counts them in Dropped().
+ */
+class QueryStats {
+ public:
+  explicit QueryStats(QueryStatsOptions options = QueryStatsOptions());
+  ~QueryStats();
+
+  QueryStats(const QueryStats&) = delete;
+  QueryStats& operator=(const QueryStats&) = delete;
+
+  void Record(uint64_t fingerprint, std::string_view key, std::string_view text,
+              int64_t latency_us, int64_t rows, bool success);
+
+  std::optional<QueryStatsEntry> Find(uint64_t fingerprint) const;
+  std::vector<QueryStatsEntry> Entries() const;
+  // The first |k| by |order|, best first
+  std::vector<QueryStatsEntry> Top(std::size_t k, QueryStatsOrder order) const;
+
+  int64_t Dropped() const;
+
+  // Forgets every record and frees every slot for new fingerprints.
+  // Shards are zeroed by their threads at their next Record() and skipped
+  // by readers until then; a Record() racing with Clear() may survive it
+  // or not.
+  void Clear();
+
+ private:
+  struct Slot;
+  struct Shard;
+
+  Shard& LocalShard();
+  Slot* Claim(Shard& shard, uint64_t fingerprint, std::string_view key, std::string_view text);
+  std::vector<const Shard*> CurrentShards() const;
+  void Collect(uint64_t only, std::vector<QueryStatsEntry>* entries) const;
+
+  const uint64_t id_;  // Tells this instance apart in the threads' shard caches
+  std::size_t capacity_;
+  std::atomic<uint64_t> epoch_{0};  // Bumped by Clear()
+
+  struct Names {
+    std::string key;
+    std::string text;
+  };
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::unordered_map<uint64_t, Names> names_;
+};
+
+}  // namespace scratchrobin::core
@@ -0,0 +1,539 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/result_set.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace scratchrobin::core {
+
+namespace {
+
+constexpr const char* kNullText = "NULL";
+
+std::uint64_t DoubleBits(double value) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double BitsDouble(std::uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Howard Hinnant's days_from_civil / civil_from_days.
+std::int32_t DaysFromCivil(int y, unsigned m, unsigned d) {
+  y -= m <= 2;
+  const int era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(y - era * 400);
+  const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+void CivilFromDays(std::int32_t z, int& y, unsigned& m, unsigned& d) {
+  z += 719468;
+  const int era = (z >= 0 ? z : z - 146096) / 146097;
+  const unsigned doe = static_cast<unsigned>(z - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = static_cast<int>(yoe) + era * 400 + (m <= 2);
+}
+
+void AppendInt(std::int64_t value, std::string& out) {
+  char buf[24];
+  auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+  out.append(buf, end);
+}
+
+void AppendDoubleText(double value, std::string& out) {
+  char buf[32];
+  auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+  out.append(buf, end);
+}
+
+// True when |value| stored as a double still formats as the same digits;
+// 1000000 would come back as "1e+06".
+bool IntFormatsAsDouble(std::int64_t value) {
+  char int_buf[24];
+  char double_buf[32];
+  auto [int_end, ec] = std::to_chars(int_buf, int_buf + sizeof(int_buf), value);
+  auto [double_end, ec2] =
+      std::to_chars(double_buf, double_buf + sizeof(double_buf), static_cast<double>(value));
+  return std::string_view(int_buf, static_cast<std::size_t>(int_end - int_buf)) ==
+         std::string_view(double_buf, static_cast<std::size_t>(double_end - double_buf));
+}
+
+void AppendDateText(std::int32_t days, std::string& out) {
+  int y;
+  unsigned m, d;
+  CivilFromDays(days, y, m, d);
+  char buf[10] = {
+      static_cast<char>('0' + (y / 1000) % 10), static_cast<char>('0' + (y / 100) % 10),
+      static_cast<char>('0' + (y / 10) % 10),   static_cast<char>('0' + y % 10),
+      '-',
+      static_cast<char>('0' + m / 10),          static_cast<char>('0' + m % 10),
+      '-',
+      static_cast<char>('0' + d / 10),          static_cast<char>('0' + d % 10),
+  };
+  out.append(buf, sizeof(buf));
+}
+
+// The Parse* helpers only accept text that formats back byte-for-byte.
+bool ParseCanonicalInt(std::string_view text, std::int64_t& value) {
+  if (text.empty() || text.size() > 20) {
+    return false;
+  }
+  auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (ec != std::errc() || ptr != text.data() + text.size()) {
+    return false;
+  }
+  char buf[24];
+  auto [end, ec2] = std::to_chars(buf, buf + sizeof(buf), value);
+  return std::string_view(buf, static_cast<std::size_t>(end - buf)) == text;
+}
+
+bool ParseCanonicalDouble(std::string_view text, double& value) {
+  if (text.empty() || text.size() > 32) {
+    return false;
+  }
+  auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (ec != std::errc() || ptr != text.data() + text.size() || !std::isfinite(value)) {
+    return false;
+  }
+  char buf[32];
+  auto [end, ec2] = std::to_chars(buf, buf + sizeof(buf), value);
+  return std::string_view(buf, static_cast<std::size_t>(end - buf)) == text;
+}
+
+bool ParseCanonicalDate(std::string_view text, std::int32_t& days) {
+  if (text.size() != 10 || text[4] != '-' || text[7] != '-') {
+    return false;
+  }
+  auto digit = [&](std::size_t i) { return text[i] >= '0' && text[i] <= '9'; };
+  for (std::size_t i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+    if (!digit(i)) {
+      return false;
+    }
+  }
+  const int y = (text[0] - '0') * 1000 + (text[1] - '0') * 100 + (text[2] - '0') * 10 +
+                (text[3] - '0');
+  const unsigned m = static_cast<unsigned>((text[5] - '0') * 10 + (text[6] - '0'));
+  const unsigned d = static_cast<unsigned>((text[8] - '0') * 10 + (text[9] - '0'));
+  if (m < 1 || m > 12 || d < 1) {
+    return false;
+  }
+  static constexpr unsigned kDaysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  const bool leap = (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+  const unsigned limit = kDaysInMonth[m - 1] + ((m == 2 && leap) ? 1 : 0);
+  if (d > limit) {
+    return false;
+  }
+  days = DaysFromCivil(y, m, d);
+  return true;
+}
+
+}  // namespace
+
+const char* ToString(ColumnType type) {
+  switch (type) {
+    case ColumnType::kAuto: return "auto";
+    case ColumnType::kInt64: return "int64";
+    case ColumnType::kDouble: return "double";
+    case ColumnType::kDate: return "date";
+    case ColumnType::kText: return "text";
+  }
+  return "unknown";
+}
+
+// =============================================================================
+// ColumnBuffer
+// =============================================================================
+
+ColumnBuffer::ColumnBuffer(ColumnType type) : type_(type) {}
+
+void ColumnBuffer::Reserve(std::size_t rows, std::size_t text_bytes) {
+  if (type_ == ColumnType::kText) {
+    offsets_.reserve(rows);
+    arena_.reserve(text_bytes);
+  } else if (type_ != ColumnType::kAuto) {
+    fixed_.reserve(rows);
+  }
+}
+
+void ColumnBuffer::Clear() {
+  size_ = 0;
+  null_count_ = 0;
+  null_bits_.clear();
+  fixed_.clear();
+  offsets_.clear();
+  arena_.clear();
+}
+
+void ColumnBuffer::SetNullBit(std::size_t row) {
+  const std::size_t word = row / 64;
+  if (word >= null_bits_.size()) {
+    null_bits_.resize(word + 1, 0);
+  }
+  null_bits_[word] |= std::uint64_t{1} << (row % 64);
+  ++null_count_;
+}
+
+void ColumnBuffer::PushFixed(std::uint64_t bits) {
+  fixed_.push_back(bits);
+  ++size_;
+}
+
+void ColumnBuffer::PushText(std::string_view value) {
+  arena_.append(value.data(), value.size());
+  offsets_.push_back(arena_.size());
+  ++size_;
+}
+
+void ColumnBuffer::PadNullsForType() {
+  // A kAuto column holds only NULLs; give them slots in the chosen layout.
+  if (type_ == ColumnType::kText) {
+    offsets_.assign(size_, 0);
+  } else if (type_ != ColumnType::kAuto) {
+    fixed_.assign(size_, 0);
+  }
+}
+
+void ColumnBuffer::AppendNull() {
+  SetNullBit(size_);
+  switch (type_) {
+    case ColumnType::kAuto:
+      ++size_;
+      break;
+    case ColumnType::kText:
+      PushText({});
+      break;
+    default:
+      PushFixed(0);
+      break;
+  }
+}
+
+void ColumnBuffer::DemoteTo(ColumnType target) {
+  if (target == type_) {
+    return;
+  }
+  if (type_ == ColumnType::kAuto) {
+    type_ = target;
+    PadNullsForType();
+    return;
+  }
+
+  // Integers become doubles only when every stored value keeps its digits;
+  // otherwise the column goes straight to text so no cell changes shape.
+  if (target == ColumnType::kDouble && type_ == ColumnType::kInt64) {
+    bool exact = true;
+    for (std::size_t row = 0; row < size_ && exact; ++row) {
+      exact = IsNull(row) || IntFormatsAsDouble(Int64At(row));
+    }
+    if (exact) {
+      for (auto& bits : fixed_) {
+        bits = DoubleBits(static_cast<double>(static_cast<std::int64_t>(bits)));
+      }
+      type_ = ColumnType::kDouble;
+      return;
+    }
+  }
+
+  // Everything else widens to text, each cell keeping its formatted value.
+  std::string arena;
+  std::vector<std::uint64_t> offsets;
+  offsets.reserve(size_);
+  for (std::size_t row = 0; row < size_; ++row) {
+    if (!IsNull(row)) {
+      AppendFormatted(row, arena);
+    }
+    offsets.push_back(arena.size());
+  }
+  fixed_.clear();
+  fixed_.shrink_to_fit();
+  arena_ = std::move(arena);
+  offsets_ = std::move(offsets);
+  type_ = ColumnType::kText;
+}
+
+void ColumnBuffer::AppendText(std::string_view value) {
+  std::int64_t int_value = 0;
+  double double_value = 0.0;
+  std::int32_t date_value = 0;
+
+  if (type_ == ColumnType::kAuto) {
+    if (ParseCanonicalInt(value, int_value)) {
+      DemoteTo(ColumnType::kInt64);
+      PushFixed(static_cast<std::uint64_t>(int_value));
+    } else if (ParseCanonicalDate(value, date_value)) {
+      DemoteTo(ColumnType::kDate);
+      PushFixed(static_cast<std::uint64_t>(static_cast<std::int64_t>(date_value)));
+    } else if (ParseCanonicalDouble(value, double_value)) {
+      DemoteTo(ColumnType::kDouble);
+      PushFixed(DoubleBits(double_value));
+    } else {
+      DemoteTo(ColumnType::kText);
+      PushText(value);
+    }
+    return;
+  }
+
+  switch (type_) {
+    case ColumnType::kInt64:
+      if (ParseCanonicalInt(value, int_value)) {
+        PushFixed(static_cast<std::uint64_t>(int_value));
+        return;
+      }
+      if (ParseCanonicalDouble(value, double_value)) {
+        DemoteTo(ColumnType::kDouble);
+        if (type_ == ColumnType::kDouble) {
+          PushFixed(DoubleBits(double_value));
+          return;
+        }
+      }
+      break;
+    case ColumnType::kDouble:
+      if (ParseCanonicalDouble(value, double_value)) {
+        PushFixed(DoubleBits(double_value));
+        return;
+      }
+      break;
+    case ColumnType::kDate:
+      if (ParseCanonicalDate(value, date_value)) {
+        PushFixed(static_cast<std::uint64_t>(static_cast<std::int64_t>(date_value)));
+        return;
+      }
+      break;
+    default:
+      break;
+  }
+
+  DemoteTo(ColumnType::kText);
+  PushText(value);
+}
+
+void ColumnBuffer::AppendInt64(std::int64_t value) {
+  if (type_ == ColumnType::kAuto) {
+    DemoteTo(ColumnType::kInt64);
+  }
+  switch (type_) {
+    case ColumnType::kInt64:
+      PushFixed(static_cast<std::uint64_t>(value));
+      return;
+    case ColumnType::kDouble:
+      if (IntFormatsAsDouble(value)) {
+        PushFixed(DoubleBits(static_cast<double>(value)));
+        return;
+      }
+      [[fallthrough]];
+    default: {
+      DemoteTo(ColumnType::kText);
+      std::string text;
+      AppendInt(value, text);
+      PushText(text);
+      return;
+    }
+  }
+}
+
+void ColumnBuffer::AppendDouble(double value) {
+  if (type_ == ColumnType::kAuto || type_ == ColumnType::kInt64) {
+    DemoteTo(ColumnType::kDouble);
+  }
+  if (type_ == ColumnType::kDouble) {
+    PushFixed(DoubleBits(value));
+    return;
+  }
+  DemoteTo(ColumnType::kText);
+  std::string text;
+  AppendDoubleText(value, text);
+  PushText(text);
+}
+
+void ColumnBuffer::AppendDate(std::int32_t days) {
+  if (type_ == ColumnType::kAuto) {
+    DemoteTo(ColumnType::kDate);
+  }
+  if (type_ == ColumnType::kDate) {
+    PushFixed(static_cast<std::uint64_t>(static_cast<std::int64_t>(days)));
+    return;
+  }
+  DemoteTo(ColumnType::kText);
+  std::string text;
+  AppendDateText(days, text);
+  PushText(text);
+}
+
+bool ColumnBuffer::IsNull(std::size_t row) const {
+  const std::size_t word = row / 64;
+  if (word >= null_bits_.size()) {
+    return false;
+  }
+  return (null_bits_[word] >> (row % 64)) & 1u;
+}
+
+std::int64_t ColumnBuffer::Int64At(std::size_t row) const {
+  return static_cast<std::int64_t>(fixed_[row]);
+}
+
+double ColumnBuffer::DoubleAt(std::size_t row) const {
+  return BitsDouble(fixed_[row]);
+}
+
+std::int32_t ColumnBuffer::DateAt(std::size_t row) const {
+  return static_cast<std::int32_t>(static_cast<std::int64_t>(fixed_[row]));
+}
+
+std::string_view ColumnBuffer::TextAt(std::size_t row) const {
+  const std::uint64_t begin = row == 0 ? 0 : offsets_[row - 1];
+  return std::string_view(arena_).substr(begin, offsets_[row] - begin);
+}
+
+void ColumnBuffer::AppendFormatted(std::size_t row, std::string& out) const {
+  if (IsNull(row)) {
+    return;
+  }
+  switch (type_) {
+    case ColumnType::kInt64:
+      AppendInt(Int64At(row), out);
+      break;
+    case ColumnType::kDouble:
+      AppendDoubleText(DoubleAt(row), out);
+      break;
+    case ColumnType::kDate:
+      AppendDateText(DateAt(row), out);
+      break;
+    case ColumnType::kText:
+      out.append(TextAt(row));
+      break;
+    case ColumnType::kAuto:
+      break;
+  }
+}
+
+std::string ColumnBuffer::Format(std::size_t row) const {
+  std::string out;
+  AppendFormatted(row, out);
+  return out;
+}
+
+std::size_t ColumnBuffer::MemoryUsage() const {
+  return sizeof(*this) + null_bits_.capacity() * sizeof(std::uint64_t) +
+         fixed_.capacity() * sizeof(std::uint64_t) +
+         offsets_.capacity() * sizeof(std::uint64_t) + arena_.capacity();
+}
+
+// =============================================================================
+// ColumnTable
+// =============================================================================
+
+std::string ColumnTable::RowRef::operator[](std::size_t col) const {
+  if (col >= table_->ColumnCount()) {
+    return {};
+  }
+  const ColumnBuffer& column = table_->Column(col);
+  if (row_ >= column.Size() || column.IsNull(row_)) {
+    return kNullText;
+  }
+  return column.Format(row_);
+}
+
+std::string ColumnTable::RowRef::at(std::size_t col) const {
+  if (col >= size()) {
+    throw std::out_of_range("ColumnTable::RowRef::at");
+  }
+  return (*this)[col];
+}
+
+ColumnTable::RowRef::operator std::vector<std::string>() const {
+  std::vector<std::string> cells;
+  cells.reserve(size());
+  for (std::size_t col = 0; col < size(); ++col) {
+    cells.push_back((*this)[col]);
+  }
+  return cells;
+}
+
+void ColumnTable::SetColumnCount(std::size_t count, ColumnType type) {
+  columns_.resize(count, ColumnBuffer(type));
+}
+
+void ColumnTable::SetColumnType(std::size_t col, ColumnType type) {
+  if (col < columns_.size() && columns_[col].Empty()) {
+    columns_[col] = ColumnBuffer(type);
+  }
+}
+
+void ColumnTable::EndRow() {
+  ++row_count_;
+  for (auto& column : columns_) {
+    while (column.Size() < row_count_) {
+      column.AppendNull();
+    }
+  }
+}
+
+std::size_t ColumnTable::MemoryUsage() const {
+  std::size_t total = sizeof(*this);
+  for (const auto& column : columns_) {
+    total += column.MemoryUsage();
+  }
+  return total;
+}
+
+ColumnTable::RowRef ColumnTable::at(std::size_t row) const {
+  if (row >= row_count_) {
+    throw std::out_of_range("ColumnTable::at");
+  }
+  return RowRef(this, row);
+}
+
+void ColumnTable::reserve(std::size_t rows) {
+  for (auto& column : columns_) {
+    column.Reserve(rows);
+  }
+}
+
+void ColumnTable::clear() {
+  columns_.clear();
+  row_count_ = 0;
+}
+
+void ColumnTable::push_back(const std::vector<std::string>& row) {
+  if (row.size() > columns_.size()) {
+    // Widen: earlier rows read back as NULL in the new columns.
+    const std::size_t old_count = columns_.size();
+    columns_.resize(row.size());
+    for (std::size_t col = old_count; col < columns_.size(); ++col) {
+      for (std::size_t r = 0; r < row_count_; ++r) {
+        columns_[col].AppendNull();
+      }
+    }
+  }
+  for (std::size_t col = 0; col < row.size(); ++col) {
+    columns_[col].AppendText(row[col]);
+  }
+  EndRow();
+}
+
+ColumnTable& ColumnTable::operator=(std::initializer_list<std::vector<std::string>> rows) {
+  clear();
+  for (const auto& row : rows) {
+    push_back(row);
+  }
+  return *this;
+}
+
+}  // namespace scratchrobin::core
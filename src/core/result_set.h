@@ -1,13 +1,221 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace scratchrobin::core {
 
+/**
+ * Physical storage type of a result column.
+ *
+ * kAuto is the state of a column that has only seen NULLs so far; the first
+ * non-null value decides the representation. Fixed-width types are only
+ * chosen when the wire text round-trips exactly, so formatting a cell always
+ * reproduces what the server sent.
+ */
+enum class ColumnType : std::uint8_t {
+  kAuto,
+  kInt64,
+  kDouble,
+  kDate,  // Days since 1970-01-01, text form YYYY-MM-DD
+  kText,
+};
+
+const char* ToString(ColumnType type);
+
+/**
+ * ColumnBuffer - one column of a result, stored contiguously
+ *
+ * Integers, doubles and dates live in a single fixed-width 8-byte array;
+ * text values share one arena addressed by an offsets array. NULLs are kept
+ * in a bitmap so no per-cell allocation is ever made.
+ */
+class ColumnBuffer {
+ public:
+  explicit ColumnBuffer(ColumnType type = ColumnType::kAuto);
+
+  ColumnType Type() const { return type_; }
+  std::size_t Size() const { return size_; }
+  bool Empty() const { return size_ == 0; }
+
+  void Reserve(std::size_t rows, std::size_t text_bytes = 0);
+  void Clear();
+
+  // Appending. AppendText() stores the value in the narrowest lossless
+  // representation and demotes the column (once) when a value no longer fits.
+  void AppendNull();
+  void AppendText(std::string_view value);
+  void AppendInt64(std::int64_t value);
+  void AppendDouble(double value);
+  void AppendDate(std::int32_t days);
+
+  // Access. Typed getters require the matching Type() and a non-null cell.
+  bool IsNull(std::size_t row) const;
+  std::int64_t Int64At(std::size_t row) const;
+  double DoubleAt(std::size_t row) const;
+  std::int32_t DateAt(std::size_t row) const;
+  std::string_view TextAt(std::size_t row) const;
+
+  // Formats a cell into |out| without clearing it; NULL appends nothing.
+  void AppendFormatted(std::size_t row, std::string& out) const;
+  std::string Format(std::size_t row) const;
+
+  std::size_t MemoryUsage() const;
+
+ private:
+  void SetNullBit(std::size_t row);
+  void PushFixed(std::uint64_t bits);
+  void PushText(std::string_view value);
+  void PadNullsForType();
+  void DemoteTo(ColumnType target);
+
+  ColumnType type_;
+  std::size_t size_{0};
+  std::size_t null_count_{0};
+  std::vector<std::uint64_t> null_bits_;
+  std::vector<std::uint64_t> fixed_;    // kInt64 / kDouble (bit pattern) / kDate
+  std::vector<std::uint64_t> offsets_;  // kText: end offset of each row
+  std::string arena_;                   // kText payload
+};
+
+/**
+ * ColumnTable - column-major cell storage for a ResultSet
+ *
+ * Producers append one value per column and then call EndRow(). Consumers
+ * that care about memory (grid, export, compare) read Column(i) directly.
+ * The row-oriented members (size, operator[], iteration, push_back) are a
+ * compatibility view for code written against the old
+ * std::vector<std::vector<std::string>> layout; cells are formatted on
+ * access and NULL cells read back as "NULL" as they always have.
+ */
+class ColumnTable {
+ public:
+  class RowRef {
+   public:
+    class const_iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = std::string;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = std::string;
+
+      const_iterator() = default;
+      const_iterator(const RowRef* row, std::size_t col) : row_(row), col_(col) {}
+      std::string operator*() const { return (*row_)[col_]; }
+      const_iterator& operator++() { ++col_; return *this; }
+      const_iterator operator++(int) { auto copy = *this; ++col_; return copy; }
+      bool operator==(const const_iterator& other) const { return col_ == other.col_; }
+      bool operator!=(const const_iterator& other) const { return col_ != other.col_; }
+
+     private:
+      const RowRef* row_{nullptr};
+      std::size_t col_{0};
+    };
+
+    RowRef(const ColumnTable* table, std::size_t row) : table_(table), row_(row) {}
+
+    std::size_t size() const { return table_->ColumnCount(); }
+    bool empty() const { return size() == 0; }
+    std::string operator[](std::size_t col) const;
+    std::string at(std::size_t col) const;
+    bool isNull(std::size_t col) const { return table_->Column(col).IsNull(row_); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+    operator std::vector<std::string>() const;
+
+   private:
+    const ColumnTable* table_;
+    std::size_t row_;
+  };
+
+  class const_iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = RowRef;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = RowRef;
+
+    const_iterator() = default;
+    const_iterator(const ColumnTable* table, std::size_t row) : table_(table), row_(row) {}
+    RowRef operator*() const { return RowRef(table_, row_); }
+    RowRef operator[](difference_type n) const { return RowRef(table_, row_ + n); }
+    const_iterator& operator++() { ++row_; return *this; }
+    const_iterator operator++(int) { auto copy = *this; ++row_; return copy; }
+    const_iterator& operator--() { --row_; return *this; }
+    const_iterator& operator+=(difference_type n) { row_ += n; return *this; }
+    const_iterator operator+(difference_type n) const { return {table_, row_ + n}; }
+    difference_type operator-(const const_iterator& other) const {
+      return static_cast<difference_type>(row_) - static_cast<difference_type>(other.row_);
+    }
+    bool operator==(const const_iterator& other) const { return row_ == other.row_; }
+    bool operator!=(const const_iterator& other) const { return row_ != other.row_; }
+
+   private:
+    const ColumnTable* table_{nullptr};
+    std::size_t row_{0};
+  };
+
+  ColumnTable() = default;
+
+  // Columnar API
+  std::size_t ColumnCount() const { return columns_.size(); }
+  std::size_t RowCount() const { return row_count_; }
+  void SetColumnCount(std::size_t count, ColumnType type = ColumnType::kAuto);
+  void SetColumnType(std::size_t col, ColumnType type);
+  ColumnBuffer& Column(std::size_t col) { return columns_[col]; }
+  const ColumnBuffer& Column(std::size_t col) const { return columns_[col]; }
+  void EndRow();
+  std::size_t MemoryUsage() const;
+
+  // Row-oriented compatibility view
+  std::size_t size() const { return row_count_; }
+  bool empty() const { return row_count_ == 0; }
+  RowRef operator[](std::size_t row) const { return RowRef(this, row); }
+  RowRef at(std::size_t row) const;
+  RowRef front() const { return RowRef(this, 0); }
+  RowRef back() const { return RowRef(this, row_count_ - 1); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, row_count_); }
+  void reserve(std::size_t rows);
+  void clear();
+  void push_back(const std::vector<std::string>& row);
+  ColumnTable& operator=(std::initializer_list<std::vector<std::string>> rows);
+
+ private:
+  std::vector<ColumnBuffer> columns_;
+  std::size_t row_count_{0};
+};
+
 struct ResultSet {
   std::vector<std::string> columns;
-  std::vector<std::vector<std::string>> rows;
+  ColumnTable rows;
+  // What the server declared each column as, when it said: kInt64 for
+  // integers, kDouble for other numbers, kDate, kText for anything else.
+  // Buffers pick their type per batch from the values they got, so code
+  // that must treat every batch of a column alike (sorting, export
+  // schemas) goes by these instead.
+  std::vector<ColumnType> column_types;
+
+  std::size_t RowCount() const { return rows.RowCount(); }
+  std::size_t ColumnCount() const { return columns.size(); }
+  const ColumnBuffer& Column(std::size_t col) const { return rows.Column(col); }
+  // kAuto when the column's type was not declared
+  ColumnType DeclaredType(std::size_t col) const {
+    return col < column_types.size() ? column_types[col] : ColumnType::kAuto;
+  }
 };
 
 }  // namespace scratchrobin::core
@@ -0,0 +1,1006 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/schema_diff.h"
+
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "core/sql_lexer.h"
+
+namespace scratchrobin::core {
+
+namespace {
+
+std::string Lower(std::string_view text) {
+  std::string result(text);
+  std::transform(result.begin(), result.end(), result.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return result;
+}
+
+std::string Upper(std::string_view text) {
+  std::string result(text);
+  std::transform(result.begin(), result.end(), result.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+  return result;
+}
+
+std::string Quote(const std::string& name) {
+  std::string result = "\"";
+  for (char c : name) {
+    result += c;
+    if (c == '"') result += '"';
+  }
+  return result + "\"";
+}
+
+std::string Qualified(const std::string& schema, const std::string& name) {
+  return schema.empty() ? Quote(name) : Quote(schema) + "." + Quote(name);
+}
+
+std::string Join(const std::vector<std::string>& items, const char* separator = ", ") {
+  std::string joined;
+  for (const auto& item : items) {
+    if (!joined.empty()) joined += separator;
+    joined += item;
+  }
+  return joined;
+}
+
+std::string KindKey(SchemaObjectKind kind, const std::string& name) {
+  return Lower(SchemaObjectKindName(kind)) + ":" + Lower(name);
+}
+
+const SqlLexer& Lexer() {
+  static const SqlLexer lexer;
+  return lexer;
+}
+
+// If tokens[i] names |schema| and is followed by '.', the index of the '.'
+std::size_t SchemaQualifier(std::string_view sql, const std::vector<SqlToken>& tokens,
+                            std::size_t i, const std::string& schema) {
+  const SqlToken& token = tokens[i];
+  bool named = false;
+  if (token.IsWord()) {
+    named = Lower(token.Text(sql)) == Lower(schema);
+  } else if (token.kind == SqlTokenKind::kQuotedIdentifier && token.length >= 2) {
+    std::string name;
+    const std::string_view text = token.Text(sql).substr(1, token.length - 2);
+    for (std::size_t pos = 0; pos < text.size(); ++pos) {
+      name += text[pos];
+      if (text[pos] == '"') ++pos;
+    }
+    named = name == schema;
+  }
+  if (!named || schema.empty()) {
+    return std::string::npos;
+  }
+  // db.schema.x keeps its qualification
+  for (std::size_t prev = i; prev-- > 0;) {
+    if (tokens[prev].kind == SqlTokenKind::kWhitespace) continue;
+    if (tokens[prev].kind == SqlTokenKind::kPunctuation && tokens[prev].Text(sql) == ".") {
+      return std::string::npos;
+    }
+    break;
+  }
+  for (std::size_t next = i + 1; next < tokens.size(); ++next) {
+    if (tokens[next].kind == SqlTokenKind::kWhitespace) continue;
+    if (tokens[next].kind == SqlTokenKind::kPunctuation && tokens[next].Text(sql) == ".") {
+      return next;
+    }
+    break;
+  }
+  return std::string::npos;
+}
+
+// Length of the "schema." prefix of a string literal like 'schema.seq', or 0
+std::size_t StringQualifier(std::string_view literal, const std::string& schema) {
+  if (schema.empty() || literal.size() < schema.size() + 3 || literal.front() != '\'' ||
+      Lower(literal.substr(1, schema.size())) != Lower(schema) ||
+      literal[schema.size() + 1] != '.') {
+    return 0;
+  }
+  return schema.size() + 1;
+}
+
+// |sql| with qualifications by |from| rewritten to |to|
+std::string Requalify(const std::string& sql, const std::string& from, const std::string& to) {
+  if (from.empty() || from == to || sql.empty()) {
+    return sql;
+  }
+  const auto tokens = Lexer().Lex(sql);
+  std::string result;
+  std::size_t copied = 0;
+  for (std::size_t i = 0; i < tokens.size(); ++i) {
+    if (tokens[i].kind == SqlTokenKind::kString) {
+      const std::size_t prefix = StringQualifier(tokens[i].Text(sql), from);
+      if (prefix == 0) continue;
+      result.append(sql, copied, tokens[i].offset + 1 - copied);
+      if (!to.empty()) {
+        result += to + ".";
+      }
+      copied = tokens[i].offset + 1 + prefix;
+      continue;
+    }
+    const std::size_t dot = SchemaQualifier(sql, tokens, i, from);
+    if (dot == std::string::npos) continue;
+    result.append(sql, copied, tokens[i].offset - copied);
+    if (!to.empty()) {
+      result += Quote(to) + ".";
+    }
+    copied = tokens[dot].offset + 1;
+    i = dot;
+  }
+  result.append(sql, copied, std::string::npos);
+  return result;
+}
+
+// "name" or "schema.name" to a name in |schema|; empty if in another one
+std::string LocalName(const std::string& reference, const std::string& schema) {
+  const std::size_t dot = reference.rfind('.');
+  if (dot == std::string::npos) {
+    return reference;
+  }
+  return Lower(reference.substr(0, dot)) == Lower(schema) ? reference.substr(dot + 1)
+                                                          : std::string();
+}
+
+std::string FunctionName(const FunctionInfo& function) {
+  return function.name + "(" + Join(function.argument_types) + ")";
+}
+
+std::string ColumnDefinition(const ColumnInfo& column) {
+  std::string sql = Quote(column.name) + " " + column.data_type;
+  if (!column.nullable) sql += " NOT NULL";
+  if (!column.default_value.empty()) sql += " DEFAULT " + column.default_value;
+  return sql;
+}
+
+std::vector<ColumnInfo> Ordered(std::vector<ColumnInfo> columns) {
+  std::stable_sort(columns.begin(), columns.end(), [](const ColumnInfo& a, const ColumnInfo& b) {
+    return a.ordinal_position < b.ordinal_position;
+  });
+  return columns;
+}
+
+const ColumnInfo* FindColumn(const std::vector<ColumnInfo>& columns, const std::string& name) {
+  for (const auto& column : columns) {
+    if (column.name == name) return &column;
+  }
+  return nullptr;
+}
+
+std::vector<std::string> TableDetails(const TableInfo& source, const TableInfo& target,
+                                      const std::string& from_schema, const std::string& schema) {
+  std::vector<std::string> details;
+  for (auto column : Ordered(source.columns)) {
+    column.default_value = Requalify(column.default_value, from_schema, schema);
+    const ColumnInfo* old = FindColumn(target.columns, column.name);
+    if (!old) {
+      details.push_back("Column '" + column.name + "' added");
+      continue;
+    }
+    if (Lower(old->data_type) != Lower(column.data_type)) {
+      details.push_back("Column '" + column.name + "' type changed from " + old->data_type +
+                        " to " + column.data_type);
+    }
+    if (old->nullable != column.nullable) {
+      details.push_back("Column '" + column.name + "' " +
+                        (column.nullable ? "made nullable" : "made NOT NULL"));
+    }
+    if (old->default_value != column.default_value) {
+      details.push_back("Column '" + column.name + "' default changed");
+    }
+  }
+  for (const auto& column : Ordered(target.columns)) {
+    if (!FindColumn(source.columns, column.name)) {
+      details.push_back("Column '" + column.name + "' dropped");
+    }
+  }
+  if (details.empty()) {
+    details.push_back("Column order differs");
+  }
+  return details;
+}
+
+// One ALTER TABLE with every column change, or empty
+std::string TableAlterSql(const TableInfo& source, const TableInfo& target,
+                          const std::string& from_schema, const std::string& schema) {
+  std::vector<std::string> actions;
+  for (auto column : Ordered(source.columns)) {
+    column.default_value = Requalify(column.default_value, from_schema, schema);
+    const ColumnInfo* old = FindColumn(target.columns, column.name);
+    const std::string name = Quote(column.name);
+    if (!old) {
+      actions.push_back("ADD COLUMN " + ColumnDefinition(column));
+      continue;
+    }
+    if (Lower(old->data_type) != Lower(column.data_type)) {
+      actions.push_back("ALTER COLUMN " + name + " TYPE " + column.data_type);
+    }
+    if (old->nullable != column.nullable) {
+      actions.push_back("ALTER COLUMN " + name +
+                        (column.nullable ? " DROP NOT NULL" : " SET NOT NULL"));
+    }
+    if (old->default_value != column.default_value) {
+      actions.push_back("ALTER COLUMN " + name +
+                        (column.default_value.empty() ? " DROP DEFAULT"
+                                                      : " SET DEFAULT " + column.default_value));
+    }
+  }
+  for (const auto& column : target.columns) {
+    if (!FindColumn(source.columns, column.name)) {
+      actions.push_back("DROP COLUMN " + Quote(column.name));
+    }
+  }
+  if (actions.empty()) {
+    return {};
+  }
+  return "ALTER TABLE " + Qualified(schema, source.name) + " " + Join(actions);
+}
+
+std::string SequenceAlterSql(const SequenceInfo& source, const SequenceInfo& target,
+                             const std::string& schema) {
+  std::string sql = "ALTER SEQUENCE " + Qualified(schema, source.name);
+  const std::size_t plain = sql.size();
+  if (source.data_type != target.data_type) sql += " AS " + source.data_type;
+  if (source.increment != target.increment) {
+    sql += " INCREMENT BY " + std::to_string(source.increment);
+  }
+  if (source.min_value != target.min_value) sql += " MINVALUE " + std::to_string(source.min_value);
+  if (source.max_value != target.max_value) sql += " MAXVALUE " + std::to_string(source.max_value);
+  if (source.start_value != target.start_value) {
+    sql += " START WITH " + std::to_string(source.start_value);
+  }
+  if (source.cache_size != target.cache_size) sql += " CACHE " + std::to_string(source.cache_size);
+  if (source.cycle != target.cycle) sql += source.cycle ? " CYCLE" : " NO CYCLE";
+  return sql.size() == plain ? std::string() : sql;
+}
+
+// The table whose unique key backs |object|, or empty
+std::string KeyTable(const SchemaObject& object) {
+  if (object.kind == SchemaObjectKind::kConstraint) {
+    const auto& constraint = static_cast<const ConstraintInfo&>(*object.info);
+    if (constraint.constraint_type == "PRIMARY KEY" || constraint.constraint_type == "UNIQUE") {
+      return Lower(constraint.table_name);
+    }
+  } else if (object.kind == SchemaObjectKind::kIndex) {
+    const auto& index = static_cast<const IndexInfo&>(*object.info);
+    if (index.is_unique) return Lower(index.table_name);
+  }
+  return {};
+}
+
+// The table a foreign key of |schema| references there, or empty
+std::string ReferencedTable(const SchemaObject& object, const std::string& schema) {
+  if (object.kind != SchemaObjectKind::kConstraint) return {};
+  const auto& constraint = static_cast<const ConstraintInfo&>(*object.info);
+  if (constraint.reference_table.empty() ||
+      (!constraint.reference_schema.empty() &&
+       Lower(constraint.reference_schema) != Lower(schema))) {
+    return {};
+  }
+  return Lower(constraint.reference_table);
+}
+
+template <typename Info>
+std::shared_ptr<Info> Copy(const SchemaObject& object) {
+  return std::make_shared<Info>(static_cast<const Info&>(*object.info));
+}
+
+}  // namespace
+
+// ============================================================================
+// SchemaSnapshot
+// ============================================================================
+
+const char* SchemaObjectKindName(SchemaObjectKind kind) {
+  switch (kind) {
+    case SchemaObjectKind::kSequence:
+      return "SEQUENCE";
+    case SchemaObjectKind::kTable:
+      return "TABLE";
+    case SchemaObjectKind::kIndex:
+      return "INDEX";
+    case SchemaObjectKind::kConstraint:
+      return "CONSTRAINT";
+    case SchemaObjectKind::kView:
+      return "VIEW";
+    case SchemaObjectKind::kFunction:
+      return "FUNCTION";
+    case SchemaObjectKind::kTrigger:
+      return "TRIGGER";
+  }
+  return "OBJECT";
+}
+
+std::string SchemaObject::Key() const {
+  return KindKey(kind, name);
+}
+
+SchemaSnapshot::SchemaSnapshot(std::string schema, SchemaDiffOptions options)
+    : schema_(std::move(schema)), options_(options) {}
+
+Status SchemaSnapshot::Capture(ScratchBirdCatalogClient& catalog, const std::string& schema,
+                               const SchemaDiffOptions& options, SchemaSnapshot* snapshot) {
+  *snapshot = SchemaSnapshot(schema, options);
+  Status status;
+  if (options.tables || options.indexes || options.constraints || options.triggers) {
+    const std::vector<TableInfo> tables = catalog.GetTables(schema, &status);
+    if (!status.ok) {
+      return status;
+    }
+    if (options.tables || options.indexes || options.constraints) {
+      status = catalog.PrefetchDetails(schema);
+      if (!status.ok) {
+        return status;
+      }
+    }
+    for (const auto& listed : tables) {
+      if (options.tables) {
+        TableInfo table = listed;
+        table.columns = catalog.GetColumns(schema, table.name, &status);
+        if (!status.ok) return status;
+        snapshot->AddTable(table);
+      }
+      if (options.indexes) {
+        for (const auto& index : catalog.GetIndexes(schema, listed.name, &status)) {
+          snapshot->AddIndex(index);
+        }
+        if (!status.ok) return status;
+      }
+      if (options.constraints) {
+        for (const auto& constraint : catalog.GetConstraints(schema, listed.name, &status)) {
+          snapshot->AddConstraint(constraint);
+        }
+        if (!status.ok) return status;
+      }
+      if (options.triggers) {
+        for (const auto& trigger : catalog.GetTriggers(schema, listed.name, &status)) {
+          snapshot->AddTrigger(trigger);
+        }
+        if (!status.ok) return status;
+      }
+    }
+  }
+  if (options.views) {
+    for (const auto& view : catalog.GetViews(schema, &status)) {
+      snapshot->AddView(view);
+    }
+    if (!status.ok) return status;
+  }
+  if (options.functions) {
+    for (const auto& function : catalog.GetFunctions(schema, &status)) {
+      snapshot->AddFunction(function);
+    }
+    if (!status.ok) return status;
+  }
+  if (options.sequences) {
+    for (const auto& sequence : catalog.GetSequences(schema, &status)) {
+      snapshot->AddSequence(sequence);
+    }
+    if (!status.ok) return status;
+  }
+  return Status::Ok();
+}
+
+Status SchemaSnapshot::CaptureBoth(ScratchBirdCatalogClient& source_catalog,
+                                   const std::string& source_schema,
+                                   ScratchBirdCatalogClient& target_catalog,
+                                   const std::string& target_schema,
+                                   const SchemaDiffOptions& options, SchemaSnapshot* source,
+                                   SchemaSnapshot* target) {
+  Status target_status;
+  std::thread target_thread([&] {
+    target_status = Capture(target_catalog, target_schema, options, target);
+  });
+  const Status source_status = Capture(source_catalog, source_schema, options, source);
+  target_thread.join();
+  if (!source_status.ok) {
+    return Status::Error("Source: " + source_status.message);
+  }
+  if (!target_status.ok) {
+    return Status::Error("Target: " + target_status.message);
+  }
+  return Status::Ok();
+}
+
+std::string SchemaSnapshot::Canonical(const std::string& sql) const {
+  const auto tokens = Lexer().Lex(sql);
+  std::string result;
+  for (std::size_t i = 0; i < tokens.size(); ++i) {
+    const SqlToken& token = tokens[i];
+    if (token.kind == SqlTokenKind::kWhitespace ||
+        (token.kind == SqlTokenKind::kComment && options_.ignore_comments)) {
+      continue;
+    }
+    const std::size_t dot = SchemaQualifier(sql, tokens, i, schema_);
+    if (dot != std::string::npos) {
+      i = dot;
+      continue;
+    }
+    if (!result.empty()) result += ' ';
+    switch (token.kind) {
+      case SqlTokenKind::kKeyword:
+      case SqlTokenKind::kFunction:
+        result += Upper(token.Text(sql));
+        break;
+      case SqlTokenKind::kIdentifier:
+        result += Lower(token.Text(sql));
+        break;
+      case SqlTokenKind::kString: {
+        // 'schema.seq' as in nextval('schema.seq')
+        const std::string_view text = token.Text(sql);
+        const std::size_t prefix = StringQualifier(text, schema_);
+        result += '\'';
+        result += text.substr(1 + prefix);
+        break;
+      }
+      default:
+        result += token.Text(sql);
+        break;
+    }
+  }
+  return result;
+}
+
+bool SchemaSnapshot::IsLocal(const std::string& schema) const {
+  return schema.empty() || Lower(schema) == Lower(schema_);
+}
+
+void SchemaSnapshot::Add(SchemaObjectKind kind, std::string name, std::string definition,
+                         std::vector<std::string> depends_on,
+                         std::shared_ptr<const CatalogObject> info) {
+  SchemaObject object;
+  object.kind = kind;
+  object.name = std::move(name);
+  object.hash = std::hash<std::string>{}(definition);
+  object.definition = std::move(definition);
+  object.depends_on = std::move(depends_on);
+  object.info = std::move(info);
+  objects_.push_back(std::move(object));
+}
+
+void SchemaSnapshot::AddTable(const TableInfo& table) {
+  std::vector<std::string> columns;
+  std::vector<std::string> depends_on;
+  for (const auto& column : Ordered(table.columns)) {
+    std::string definition = Quote(column.name) + " " + Canonical(column.data_type);
+    if (!column.nullable) definition += " NOT NULL";
+    if (!column.default_value.empty()) {
+      definition += " DEFAULT " + Canonical(column.default_value);
+      // nextval('seq') makes the column depend on the sequence
+      const auto tokens = Lexer().Lex(column.default_value);
+      for (const auto& token : tokens) {
+        if (token.kind != SqlTokenKind::kString || token.length < 2) continue;
+        const std::string_view text =
+            std::string_view(column.default_value).substr(token.offset + 1, token.length - 2);
+        const std::string name = LocalName(std::string(text), schema_);
+        if (!name.empty()) depends_on.push_back(KindKey(SchemaObjectKind::kSequence, name));
+      }
+    }
+    columns.push_back(std::move(definition));
+  }
+  Add(SchemaObjectKind::kTable, table.name, "TABLE (" + Join(columns) + ")", std::move(depends_on),
+      std::make_shared<TableInfo>(table));
+}
+
+void SchemaSnapshot::AddIndex(const IndexInfo& index) {
+  if (index.is_primary) {
+    return;  // Created with its PRIMARY KEY constraint
+  }
+  std::vector<std::string> columns;
+  for (const auto& column : index.columns) {
+    std::string definition = column.is_expression ? Canonical(column.expression)
+                                                  : Quote(column.name);
+    if (!column.collation.empty()) definition += " COLLATE " + Quote(column.collation);
+    definition += " " + Upper(column.sort_order.empty() ? "ASC" : column.sort_order);
+    columns.push_back(std::move(definition));
+  }
+  std::string definition = std::string(index.is_unique ? "UNIQUE " : "") + "INDEX ON " +
+                           Quote(index.table_name) + " USING " + Lower(index.index_type) + " (" +
+                           Join(columns) + ")";
+  if (!index.filter_condition.empty()) {
+    definition += " WHERE " + Canonical(index.filter_condition);
+  }
+  Add(SchemaObjectKind::kIndex, index.name, std::move(definition),
+      {KindKey(SchemaObjectKind::kTable, index.table_name)}, std::make_shared<IndexInfo>(index));
+}
+
+void SchemaSnapshot::AddConstraint(const ConstraintInfo& constraint) {
+  std::vector<std::string> columns;
+  for (const auto& column : constraint.columns) columns.push_back(Quote(column));
+  std::string definition = Upper(constraint.constraint_type) + " (" + Join(columns) + ")";
+  std::vector<std::string> depends_on = {KindKey(SchemaObjectKind::kTable, constraint.table_name)};
+  if (!constraint.reference_table.empty()) {
+    std::vector<std::string> references;
+    for (const auto& column : constraint.reference_columns) references.push_back(Quote(column));
+    definition += " REFERENCES ";
+    if (IsLocal(constraint.reference_schema)) {
+      depends_on.push_back(KindKey(SchemaObjectKind::kTable, constraint.reference_table));
+    } else {
+      definition += Quote(constraint.reference_schema) + ".";
+    }
+    definition += Quote(constraint.reference_table) + " (" + Join(references) + ")";
+    if (!constraint.update_rule.empty()) definition += " ON UPDATE " + Upper(constraint.update_rule);
+    if (!constraint.delete_rule.empty()) definition += " ON DELETE " + Upper(constraint.delete_rule);
+  }
+  if (!constraint.check_expression.empty()) {
+    definition += " CHECK (" + Canonical(constraint.check_expression) + ")";
+  }
+  if (constraint.is_deferrable) {
+    definition += constraint.initially_deferred ? " DEFERRABLE INITIALLY DEFERRED" : " DEFERRABLE";
+  }
+  Add(SchemaObjectKind::kConstraint, constraint.table_name + "." + constraint.name,
+      std::move(definition), std::move(depends_on), std::make_shared<ConstraintInfo>(constraint));
+}
+
+void SchemaSnapshot::AddView(const ViewInfo& view) {
+  std::vector<std::string> columns;
+  for (const auto& column : view.columns) columns.push_back(Quote(column.name));
+  std::string definition = std::string(view.is_materialized ? "MATERIALIZED " : "") + "VIEW (" +
+                           Join(columns) + ") AS " + Canonical(view.definition);
+  // A dependency may name a table or a view
+  std::vector<std::string> depends_on;
+  for (const auto& dependency : view.dependencies) {
+    const std::string name = LocalName(dependency, schema_);
+    if (name.empty()) continue;
+    depends_on.push_back(KindKey(SchemaObjectKind::kTable, name));
+    depends_on.push_back(KindKey(SchemaObjectKind::kView, name));
+  }
+  Add(SchemaObjectKind::kView, view.name, std::move(definition), std::move(depends_on),
+      std::make_shared<ViewInfo>(view));
+}
+
+void SchemaSnapshot::AddFunction(const FunctionInfo& function) {
+  std::vector<std::string> arguments;
+  for (const auto& argument : function.arguments) {
+    arguments.push_back(Upper(argument.mode) + " " + argument.name + " " +
+                        Canonical(argument.data_type));
+  }
+  const std::string definition =
+      "FUNCTION (" + Join(arguments) + ") RETURNS " + Canonical(function.return_type) +
+      " LANGUAGE " + Lower(function.language) + (function.is_volatile ? " VOLATILE" : " STABLE") +
+      " AS " + Canonical(function.definition);
+  Add(SchemaObjectKind::kFunction, FunctionName(function), definition, {},
+      std::make_shared<FunctionInfo>(function));
+}
+
+void SchemaSnapshot::AddTrigger(const TriggerInfo& trigger) {
+  std::string definition = trigger.before ? "BEFORE" : trigger.instead_of ? "INSTEAD OF" : "AFTER";
+  if (trigger.on_insert) definition += " INSERT";
+  if (trigger.on_update) {
+    std::vector<std::string> columns;
+    for (const auto& column : trigger.update_columns) columns.push_back(Quote(column));
+    definition += " UPDATE (" + Join(columns) + ")";
+  }
+  if (trigger.on_delete) definition += " DELETE";
+  if (trigger.on_truncate) definition += " TRUNCATE";
+  definition += " ON " + Quote(trigger.table_name);
+  definition += trigger.for_each_row ? " FOR EACH ROW" : " FOR EACH STATEMENT";
+  if (!trigger.when_condition.empty()) {
+    definition += " WHEN (" + Canonical(trigger.when_condition) + ")";
+  }
+  if (trigger.is_constraint) definition += " CONSTRAINT " + Quote(trigger.constraint_reference);
+  if (!trigger.is_enabled) definition += " DISABLED";
+  std::vector<std::string> depends_on = {KindKey(SchemaObjectKind::kTable, trigger.table_name)};
+  if (IsLocal(trigger.function_schema)) {
+    depends_on.push_back(KindKey(SchemaObjectKind::kFunction, trigger.function_name + "()"));
+    definition += " EXECUTE " + Quote(trigger.function_name);
+  } else {
+    definition += " EXECUTE " + Quote(trigger.function_schema) + "." + Quote(trigger.function_name);
+  }
+  Add(SchemaObjectKind::kTrigger, trigger.table_name + "." + trigger.name, std::move(definition),
+      std::move(depends_on), std::make_shared<TriggerInfo>(trigger));
+}
+
+void SchemaSnapshot::AddSequence(const SequenceInfo& sequence) {
+  // The current value is data, not definition
+  const std::string definition =
+      "SEQUENCE AS " + Canonical(sequence.data_type) + " START " +
+      std::to_string(sequence.start_value) + " MIN " + std::to_string(sequence.min_value) +
+      " MAX " + std::to_string(sequence.max_value) + " INCREMENT " +
+      std::to_string(sequence.increment) + " CACHE " + std::to_string(sequence.cache_size) +
+      (sequence.cycle ? " CYCLE" : "");
+  Add(SchemaObjectKind::kSequence, sequence.name, definition, {},
+      std::make_shared<SequenceInfo>(sequence));
+}
+
+// ============================================================================
+// SchemaDiff
+// ============================================================================
+
+std::size_t SchemaSyncScript::StatementCount() const {
+  std::size_t count = 0;
+  for (const auto& step : steps) count += step.size();
+  return count;
+}
+
+std::string SchemaSyncScript::ToSql() const {
+  std::string sql;
+  for (std::size_t i = 0; i < steps.size(); ++i) {
+    if (i > 0) sql += "\n";
+    sql += "-- Step " + std::to_string(i + 1) + ": " + std::to_string(steps[i].size()) +
+           (steps[i].size() == 1 ? " statement\n" : " independent statements\n");
+    for (const auto& statement : steps[i]) {
+      sql += statement + ";\n";
+    }
+  }
+  return sql;
+}
+
+SchemaDiffResult SchemaDiff::Compare(const SchemaSnapshot& source, const SchemaSnapshot& target) {
+  SchemaDiffResult result;
+  result.source_schema = source.Schema();
+  result.target_schema = target.Schema();
+
+  std::unordered_map<std::string, std::size_t> target_index;
+  for (std::size_t i = 0; i < target.Objects().size(); ++i) {
+    target_index.emplace(target.Objects()[i].Key(), i);
+  }
+  std::vector<bool> matched(target.Objects().size(), false);
+  std::unordered_map<std::string, std::size_t> identical;  // Key to index in source
+  std::unordered_set<std::string> changed;                 // Altered or dropped keys
+
+  for (std::size_t i = 0; i < source.Objects().size(); ++i) {
+    const SchemaObject& object = source.Objects()[i];
+    const auto found = target_index.find(object.Key());
+    if (found == target_index.end()) {
+      SchemaObjectChange change;
+      change.kind = SchemaChangeKind::kCreate;
+      change.source = object;
+      result.changes.push_back(std::move(change));
+      continue;
+    }
+    matched[found->second] = true;
+    const SchemaObject& other = target.Objects()[found->second];
+    if (object.hash == other.hash && object.definition == other.definition) {
+      identical.emplace(object.Key(), i);
+      continue;
+    }
+    SchemaObjectChange change;
+    change.kind = SchemaChangeKind::kAlter;
+    change.source = object;
+    change.target = other;
+    if (object.kind == SchemaObjectKind::kTable) {
+      change.details = TableDetails(static_cast<const TableInfo&>(*object.info),
+                                    static_cast<const TableInfo&>(*other.info),
+                                    source.Schema(), target.Schema());
+    } else {
+      change.details.push_back("Definition differs");
+    }
+    changed.insert(object.Key());
+    result.changes.push_back(std::move(change));
+  }
+  for (std::size_t i = 0; i < target.Objects().size(); ++i) {
+    if (matched[i]) continue;
+    SchemaObjectChange change;
+    change.kind = SchemaChangeKind::kDrop;
+    change.target = target.Objects()[i];
+    changed.insert(change.target.Key());
+    result.changes.push_back(std::move(change));
+  }
+
+  // Views over a changing object are dropped with it and recreated, even
+  // when their own definition is the same
+  std::unordered_map<std::string, std::vector<std::size_t>> dependents;
+  for (std::size_t i = 0; i < target.Objects().size(); ++i) {
+    for (const auto& dependency : target.Objects()[i].depends_on) {
+      dependents[dependency].push_back(i);
+    }
+  }
+  std::deque<std::string> pending(changed.begin(), changed.end());
+  while (!pending.empty()) {
+    const std::string key = pending.front();
+    pending.pop_front();
+    const auto found = dependents.find(key);
+    if (found == dependents.end()) continue;
+    for (std::size_t i : found->second) {
+      const SchemaObject& view = target.Objects()[i];
+      const auto same = identical.find(view.Key());
+      if (view.kind != SchemaObjectKind::kView || same == identical.end()) continue;
+      SchemaObjectChange change;
+      change.kind = SchemaChangeKind::kAlter;
+      change.source = source.Objects()[same->second];
+      change.target = view;
+      change.details.push_back("Recreated: depends on " + key);
+      result.changes.push_back(std::move(change));
+      identical.erase(same);
+      pending.push_back(view.Key());
+    }
+  }
+  result.identical = identical.size();
+
+  auto name = [](const SchemaObjectChange& change) -> const SchemaObject& {
+    return change.kind == SchemaChangeKind::kDrop ? change.target : change.source;
+  };
+  std::sort(result.changes.begin(), result.changes.end(),
+            [&](const SchemaObjectChange& a, const SchemaObjectChange& b) {
+              const SchemaObject& x = name(a);
+              const SchemaObject& y = name(b);
+              if (x.kind != y.kind) return x.kind < y.kind;
+              return Lower(x.name) < Lower(y.name);
+            });
+  return result;
+}
+
+std::string SchemaDiff::CreateSql(const SchemaObject& object, const std::string& from_schema,
+                                  const std::string& schema) {
+  if (!object.info) {
+    return {};
+  }
+  auto move = [&](const std::string& value) {
+    return Lower(value) == Lower(from_schema) ? schema : value;
+  };
+  switch (object.kind) {
+    case SchemaObjectKind::kTable: {
+      auto table = Copy<TableInfo>(object);
+      table->schema = schema;
+      table->primary_key_columns.clear();  // Added as a constraint
+      for (auto& column : table->columns) {
+        column.default_value = Requalify(column.default_value, from_schema, schema);
+      }
+      return table->GetCreateSql();
+    }
+    case SchemaObjectKind::kIndex: {
+      auto index = Copy<IndexInfo>(object);
+      index->schema = schema;
+      index->table_schema = move(index->table_schema);
+      return index->GetCreateSql();
+    }
+    case SchemaObjectKind::kConstraint: {
+      auto constraint = Copy<ConstraintInfo>(object);
+      constraint->schema = schema;
+      constraint->reference_schema = move(constraint->reference_schema);
+      constraint->check_expression = Requalify(constraint->check_expression, from_schema, schema);
+      return constraint->GetAddSql();
+    }
+    case SchemaObjectKind::kView: {
+      auto view = Copy<ViewInfo>(object);
+      view->schema = schema;
+      view->definition = Requalify(view->definition, from_schema, schema);
+      return view->GetCreateSql();
+    }
+    case SchemaObjectKind::kFunction: {
+      auto function = Copy<FunctionInfo>(object);
+      function->schema = schema;
+      function->definition = Requalify(function->definition, from_schema, schema);
+      return function->GetCreateSql();
+    }
+    case SchemaObjectKind::kTrigger: {
+      auto trigger = Copy<TriggerInfo>(object);
+      trigger->schema = schema;
+      trigger->table_schema = move(trigger->table_schema);
+      trigger->function_schema = move(trigger->function_schema);
+      trigger->when_condition = Requalify(trigger->when_condition, from_schema, schema);
+      return trigger->GetCreateSql();
+    }
+    case SchemaObjectKind::kSequence: {
+      auto sequence = Copy<SequenceInfo>(object);
+      sequence->schema = schema;
+      return sequence->GetCreateSql();
+    }
+  }
+  return {};
+}
+
+std::string SchemaDiff::DropSql(const SchemaObject& object) {
+  if (!object.info) {
+    return {};
+  }
+  switch (object.kind) {
+    case SchemaObjectKind::kTable:
+      return static_cast<const TableInfo&>(*object.info).GetDropSql(true);
+    case SchemaObjectKind::kIndex:
+      return static_cast<const IndexInfo&>(*object.info).GetDropSql(true);
+    case SchemaObjectKind::kConstraint:
+      return static_cast<const ConstraintInfo&>(*object.info).GetDropSql();
+    case SchemaObjectKind::kView:
+      return static_cast<const ViewInfo&>(*object.info).GetDropSql(true, false);
+    case SchemaObjectKind::kFunction:
+      return static_cast<const FunctionInfo&>(*object.info).GetDropSql(true);
+    case SchemaObjectKind::kTrigger:
+      return static_cast<const TriggerInfo&>(*object.info).GetDropSql();
+    case SchemaObjectKind::kSequence:
+      return static_cast<const SequenceInfo&>(*object.info).GetDropSql(true);
+  }
+  return {};
+}
+
+SchemaSyncScript SchemaDiff::BuildScript(const SchemaDiffResult& diff) {
+  struct Node {
+    std::string sql;
+    std::vector<std::size_t> next;
+    std::size_t waiting = 0;
+  };
+  std::vector<Node> nodes;
+  std::unordered_map<std::string, std::size_t> drops;
+  std::unordered_map<std::string, std::size_t> alters;
+  std::unordered_map<std::string, std::size_t> creates;
+  auto add = [&](std::unordered_map<std::string, std::size_t>& index, const std::string& key,
+                 std::string sql) {
+    if (sql.empty()) return;
+    index.emplace(key, nodes.size());
+    nodes.push_back(Node{std::move(sql), {}, 0});
+  };
+  auto edge = [&](std::size_t from, std::size_t to) {
+    nodes[from].next.push_back(to);
+    ++nodes[to].waiting;
+  };
+
+  auto in_place = [](const SchemaObjectChange& change) {
+    return change.kind == SchemaChangeKind::kAlter &&
+           (change.source.kind == SchemaObjectKind::kTable ||
+            change.source.kind == SchemaObjectKind::kSequence);
+  };
+  // Drops first, dependents before what they depend on, then alters and creates
+  for (auto change = diff.changes.rbegin(); change != diff.changes.rend(); ++change) {
+    if (change->kind != SchemaChangeKind::kCreate && !in_place(*change)) {
+      add(drops, change->target.Key(), DropSql(change->target));
+    }
+  }
+  for (const auto& change : diff.changes) {
+    if (!in_place(change)) continue;
+    const auto& source = *change.source.info;
+    const auto& target = *change.target.info;
+    if (change.source.kind == SchemaObjectKind::kTable) {
+      add(alters, change.source.Key(),
+          TableAlterSql(static_cast<const TableInfo&>(source),
+                        static_cast<const TableInfo&>(target), diff.source_schema,
+                        diff.target_schema));
+    } else {
+      add(alters, change.source.Key(),
+          SequenceAlterSql(static_cast<const SequenceInfo&>(source),
+                           static_cast<const SequenceInfo&>(target), diff.target_schema));
+    }
+  }
+  for (const auto& change : diff.changes) {
+    if (change.kind != SchemaChangeKind::kDrop && !in_place(change)) {
+      add(creates, change.source.Key(),
+          CreateSql(change.source, diff.source_schema, diff.target_schema));
+    }
+  }
+
+  auto find = [](const std::unordered_map<std::string, std::size_t>& index,
+                 const std::string& key) {
+    const auto found = index.find(key);
+    return found == index.end() ? std::numeric_limits<std::size_t>::max() : found->second;
+  };
+  constexpr std::size_t kNone = std::numeric_limits<std::size_t>::max();
+  // Foreign keys need the referenced key: created after it, dropped before it
+  std::unordered_map<std::string, std::vector<std::size_t>> created_keys;
+  std::unordered_map<std::string, std::vector<std::size_t>> dropped_keys;
+  for (const auto& change : diff.changes) {
+    if (change.kind != SchemaChangeKind::kCreate) {
+      const std::size_t drop = find(drops, change.target.Key());
+      const std::string table = KeyTable(change.target);
+      if (drop != kNone && !table.empty()) dropped_keys[table].push_back(drop);
+    }
+    if (change.kind != SchemaChangeKind::kDrop) {
+      const std::size_t create = find(creates, change.source.Key());
+      const std::string table = KeyTable(change.source);
+      if (create != kNone && !table.empty()) created_keys[table].push_back(create);
+    }
+  }
+  for (const auto& change : diff.changes) {
+    if (const std::size_t drop = find(drops, change.target.Key()); drop != kNone) {
+      const auto keys = dropped_keys.find(ReferencedTable(change.target, diff.target_schema));
+      if (keys != dropped_keys.end()) {
+        for (std::size_t key : keys->second) edge(drop, key);
+      }
+    }
+    if (const std::size_t create = find(creates, change.source.Key()); create != kNone) {
+      const auto keys = created_keys.find(ReferencedTable(change.source, diff.source_schema));
+      if (keys != created_keys.end()) {
+        for (std::size_t key : keys->second) edge(key, create);
+      }
+    }
+  }
+  for (const auto& change : diff.changes) {
+    const std::size_t drop = find(drops, change.target.Key());
+    const std::size_t alter = find(alters, change.source.Key());
+    const std::size_t create = find(creates, change.source.Key());
+    if (change.kind != SchemaChangeKind::kCreate) {
+      // What the old object depends on goes after it is dropped
+      for (const auto& dependency : change.target.depends_on) {
+        const std::size_t from = drop != kNone ? drop : alter;
+        if (from == kNone) continue;
+        if (const std::size_t to = find(drops, dependency); to != kNone && to != from) {
+          edge(from, to);
+        }
+        if (const std::size_t to = find(alters, dependency); to != kNone && to != from) {
+          edge(from, to);
+        }
+      }
+    }
+    if (change.kind != SchemaChangeKind::kDrop) {
+      // What the new object depends on goes before it is created
+      for (const auto& dependency : change.source.depends_on) {
+        const std::size_t to = create != kNone ? create : alter;
+        if (to == kNone) continue;
+        if (const std::size_t from = find(creates, dependency); from != kNone && from != to) {
+          edge(from, to);
+        }
+        if (const std::size_t from = find(alters, dependency); from != kNone && from != to) {
+          edge(from, to);
+        }
+      }
+    }
+    if (drop != kNone && create != kNone) {
+      edge(drop, create);
+    }
+  }
+
+  // Kahn's algorithm a level at a time: each step is every statement whose
+  // predecessors all ran in earlier steps
+  SchemaSyncScript script;
+  std::vector<std::vector<std::size_t>> before(nodes.size());
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    for (std::size_t to : nodes[i].next) before[to].push_back(i);
+  }
+  std::vector<std::size_t> position(nodes.size(), kNone);  // In script order
+  auto place = [&](std::size_t i, std::vector<std::string>* step) {
+    std::vector<std::size_t> deps;
+    for (std::size_t from : before[i]) {
+      if (position[from] != kNone) deps.push_back(position[from]);
+    }
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+    position[i] = script.depends_on.size();
+    script.depends_on.push_back(std::move(deps));
+    step->push_back(nodes[i].sql);
+  };
+  std::vector<bool> done(nodes.size(), false);
+  std::vector<std::size_t> ready;
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].waiting == 0) ready.push_back(i);
+  }
+  std::size_t placed = 0;
+  while (!ready.empty()) {
+    std::sort(ready.begin(), ready.end());
+    std::vector<std::string> step;
+    std::vector<std::size_t> next_ready;
+    for (std::size_t i : ready) {
+      done[i] = true;
+      place(i, &step);
+      for (std::size_t to : nodes[i].next) {
+        if (--nodes[to].waiting == 0) next_ready.push_back(to);
+      }
+    }
+    placed += step.size();
+    script.steps.push_back(std::move(step));
+    ready = std::move(next_ready);
+  }
+  // Unresolved cycles run last, one statement at a time in listed order
+  if (placed < nodes.size()) {
+    std::size_t previous = kNone;
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+      if (done[i]) continue;
+      std::vector<std::string> step;
+      place(i, &step);
+      auto& deps = script.depends_on.back();
+      if (previous != kNone &&
+          !std::binary_search(deps.begin(), deps.end(), position[previous])) {
+        deps.insert(std::upper_bound(deps.begin(), deps.end(), position[previous]),
+                    position[previous]);
+      }
+      previous = i;
+      script.steps.push_back(std::move(step));
+    }
+  }
+  return script;
+}
+
+}  // namespace scratchrobin::core
@@ -0,0 +1,159 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/scratchbird_catalog_client.h"
+#include "core/status.h"
+
+namespace scratchrobin::core {
+
+enum class SchemaObjectKind : std::uint8_t {
+  kSequence,
+  kTable,
+  kIndex,
+  kConstraint,
+  kView,
+  kFunction,
+  kTrigger,
+};
+
+// "TABLE", "INDEX", ...
+const char* SchemaObjectKindName(SchemaObjectKind kind);
+
+struct SchemaObject {
+  SchemaObjectKind kind = SchemaObjectKind::kTable;
+  std::string name;        // Unqualified; "table.name" for constraints and triggers
+  std::string definition;  // Canonical and free of the schema name
+  uint64_t hash = 0;       // Of definition
+  std::vector<std::string> depends_on;  // Keys; objects outside the snapshot are ignored
+  std::shared_ptr<const CatalogObject> info;  // TableInfo, IndexInfo, ... by kind
+
+  std::string Key() const;  // Kind and lower-cased name, unique in a snapshot
+};
+
+struct SchemaDiffOptions {
+  bool tables = true;
+  bool indexes = true;
+  bool constraints = true;
+  bool views = true;
+  bool functions = true;
+  bool triggers = true;
+  bool sequences = true;
+  bool ignore_comments = true;  // In view, function and check bodies
+};
+
+/**
+ * SchemaSnapshot - the objects of one schema, canonicalized and hashed
+ *
+ * Definitions are rebuilt from the catalog fields rather than taken from
+ * generated DDL, and SQL bodies are re-tokenized with SqlLexer: whitespace
+ * is dropped, keywords are upper-cased, unquoted identifiers lower-cased
+ * and qualifications by the snapshot's own schema removed. The same object
+ * in two schemas or two databases therefore hashes the same.
+ */
+class SchemaSnapshot {
+ public:
+  explicit SchemaSnapshot(std::string schema = std::string(),
+                          SchemaDiffOptions options = SchemaDiffOptions());
+
+  // Reads every object of |schema| the options select. Table details are
+  // fetched in batches through PrefetchDetails().
+  static Status Capture(ScratchBirdCatalogClient& catalog, const std::string& schema,
+                        const SchemaDiffOptions& options, SchemaSnapshot* snapshot);
+
+  // Captures both sides at once; give each catalog its own connection
+  static Status CaptureBoth(ScratchBirdCatalogClient& source_catalog,
+                            const std::string& source_schema,
+                            ScratchBirdCatalogClient& target_catalog,
+                            const std::string& target_schema,
+                            const SchemaDiffOptions& options, SchemaSnapshot* source,
+                            SchemaSnapshot* target);
+
+  void AddTable(const TableInfo& table);  // With its columns
+  void AddIndex(const IndexInfo& index);
+  void AddConstraint(const ConstraintInfo& constraint);
+  void AddView(const ViewInfo& view);
+  void AddFunction(const FunctionInfo& function);
+  void AddTrigger(const TriggerInfo& trigger);
+  void AddSequence(const SequenceInfo& sequence);
+
+  const std::string& Schema() const { return schema_; }
+  const std::vector<SchemaObject>& Objects() const { return objects_; }
+
+ private:
+  std::string Canonical(const std::string& sql) const;
+  bool IsLocal(const std::string& schema) const;
+  void Add(SchemaObjectKind kind, std::string name, std::string definition,
+           std::vector<std::string> depends_on, std::shared_ptr<const CatalogObject> info);
+
+  std::string schema_;
+  SchemaDiffOptions options_;
+  std::vector<SchemaObject> objects_;
+};
+
+enum class SchemaChangeKind : std::uint8_t {
+  kCreate,  // Only in the source
+  kDrop,    // Only in the target
+  kAlter,   // In both, different, or depending on an object that changes
+};
+
+struct SchemaObjectChange {
+  SchemaChangeKind kind = SchemaChangeKind::kAlter;
+  SchemaObject source;  // Empty for kDrop
+  SchemaObject target;  // Empty for kCreate
+  std::vector<std::string> details;
+};
+
+struct SchemaDiffResult {
+  std::string source_schema;
+  std::string target_schema;
+  std::vector<SchemaObjectChange> changes;  // Ordered by kind, then name
+  std::size_t identical = 0;
+};
+
+// Statements to make the target match the source. Statements of a step
+// depend only on earlier steps, so each step can run in parallel.
+struct SchemaSyncScript {
+  std::vector<std::vector<std::string>> steps;
+  // By statement, numbered through the steps in order: the earlier
+  // statements it must follow. These are the graph's own edges, so a
+  // statement can start before the rest of the previous step is done.
+  std::vector<std::vector<std::size_t>> depends_on;
+
+  std::size_t StatementCount() const;
+  std::string ToSql() const;
+};
+
+/**
+ * SchemaDiff - compares two snapshots and orders the script between them
+ *
+ * Compare() matches objects by key and compares hashes, linear in the
+ * number of objects. Views depending on a changed or dropped object are
+ * recreated too. BuildScript() makes a graph of the DROP, ALTER and
+ * CREATE statements: drops run before what their object depends on is
+ * dropped or altered, creates after what theirs depends on is created or
+ * altered, and an object is dropped before it is recreated. The graph is
+ * cut into steps by longest path.
+ */
+class SchemaDiff {
+ public:
+  static SchemaDiffResult Compare(const SchemaSnapshot& source, const SchemaSnapshot& target);
+  static SchemaSyncScript BuildScript(const SchemaDiffResult& diff);
+
+  // The DDL of an object, qualified by |schema|
+  static std::string CreateSql(const SchemaObject& object, const std::string& from_schema,
+                               const std::string& schema);
+  static std::string DropSql(const SchemaObject& object);
+};
+
+}  // namespace scratchrobin::core
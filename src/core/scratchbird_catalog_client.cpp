@@ -12,11 +12,15 @@
 
 #include <algorithm>
 #include <cctype>
+#include <filesystem>
 #include <limits>
 #include <sstream>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "backend/scratchbird_connection.h"
+#include "core/catalog_cache.h"
+
 namespace scratchrobin {
 namespace core {
 
@@ -718,6 +722,90 @@ std::string CatalogQueryBuilder::BuildSchemaQuery() {
          "ORDER BY schema_name";
 }
 
+std::string CatalogQueryBuilder::BuildSysTableListingQuery() {
+  // sys.tables has no modification stamp; the count of valid columns,
+  // indexes and constraints stands in for one, and table_id changes when
+  // a table is recreated
+  return "SELECT s.schema_name, t.table_name, t.table_id, t.table_type, t.row_count, "
+         "COUNT(DISTINCT c.column_id), COUNT(DISTINCT i.index_id), "
+         "COUNT(DISTINCT k.constraint_id) "
+         "FROM sys.tables t "
+         "JOIN sys.schemas s ON s.schema_id = t.schema_id "
+         "LEFT JOIN sys.columns c ON c.table_id = t.table_id AND c.is_valid = true "
+         "LEFT JOIN sys.indexes i ON i.table_id = t.table_id AND i.is_valid = true "
+         "LEFT JOIN sys.constraints k ON k.table_id = t.table_id "
+         "WHERE t.is_valid = true AND t.table_type NOT IN ('INDEX', 'TOAST') "
+         "GROUP BY s.schema_name, t.table_name, t.table_id, t.table_type, t.row_count "
+         "ORDER BY s.schema_name, t.table_name";
+}
+
+std::string CatalogQueryBuilder::BuildSysColumnQuery(const std::vector<std::string>& table_ids) {
+  return "SELECT table_id, column_name, data_type_name, is_nullable, default_value, "
+         "ordinal_position "
+         "FROM sys.columns WHERE table_id IN (" + QuoteList(table_ids) + ") "
+         "AND is_valid = true ORDER BY table_id, ordinal_position";
+}
+
+std::string CatalogQueryBuilder::BuildSysIndexQuery(const std::vector<std::string>& table_ids) {
+  return "SELECT i.table_id, i.index_name, i.index_type, i.is_unique, i.predicate_sql, "
+         "COALESCE(c.column_name, ic.column_name), i.is_expression, i.expression_sql "
+         "FROM sys.indexes i "
+         "LEFT JOIN sys.index_columns ic ON ic.index_id = i.index_id "
+         "AND ic.is_included = false "
+         "LEFT JOIN sys.columns c ON c.column_id = ic.column_id "
+         "WHERE i.table_id IN (" + QuoteList(table_ids) + ") AND i.is_valid = true "
+         "ORDER BY i.table_id, i.index_name, ic.ordinal_position";
+}
+
+std::string CatalogQueryBuilder::BuildSysConstraintQuery(
+    const std::vector<std::string>& table_ids) {
+  return "SELECT table_id, constraint_name, constraint_type, check_expression, "
+         "is_deferrable, initially_deferred "
+         "FROM sys.constraints WHERE table_id IN (" + QuoteList(table_ids) + ") "
+         "ORDER BY table_id, constraint_name";
+}
+
+std::string CatalogQueryBuilder::BuildSysObjectSearchQuery(const std::string& text,
+                                                           std::size_t limit) {
+  std::string pattern = "%";
+  for (char c : text) {
+    if (c == '%' || c == '_' || c == '\\') {
+      pattern += '\\';
+    }
+    pattern += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  }
+  pattern += "%";
+  const std::string like = " LIKE " + QuoteString(pattern) + " ESCAPE '\\'";
+  return "SELECT 'table', s.schema_name, t.table_name, t.table_name "
+         "FROM sys.tables t JOIN sys.schemas s ON s.schema_id = t.schema_id "
+         "WHERE t.is_valid = true AND t.table_type NOT IN ('INDEX', 'TOAST') "
+         "AND LOWER(t.table_name)" + like + " "
+         "UNION ALL "
+         "SELECT 'column', s.schema_name, t.table_name, c.column_name "
+         "FROM sys.columns c JOIN sys.tables t ON t.table_id = c.table_id "
+         "JOIN sys.schemas s ON s.schema_id = t.schema_id "
+         "WHERE c.is_valid = true AND t.is_valid = true "
+         "AND LOWER(c.column_name)" + like + " "
+         "UNION ALL "
+         "SELECT 'index', s.schema_name, t.table_name, i.index_name "
+         "FROM sys.indexes i JOIN sys.tables t ON t.table_id = i.table_id "
+         "JOIN sys.schemas s ON s.schema_id = t.schema_id "
+         "WHERE i.is_valid = true AND t.is_valid = true "
+         "AND LOWER(i.index_name)" + like + " "
+         "ORDER BY 2, 3, 1, 4 LIMIT " + std::to_string(limit);
+}
+
+std::string CatalogQueryBuilder::QuoteList(const std::vector<std::string>& values) {
+  std::string result;
+  for (const auto& value : values) {
+    if (!result.empty()) {
+      result += ", ";
+    }
+    result += QuoteString(value);
+  }
+  return result;
+}
+
 std::string CatalogQueryBuilder::QuoteString(const std::string& str) {
   std::string result = "'";
   for (char c : str) {
@@ -735,77 +823,188 @@ std::string CatalogQueryBuilder::QuoteString(const std::string& str) {
 // ScratchBirdCatalogClient Implementation
 // ============================================================================
 
-ScratchBirdCatalogClient::ScratchBirdCatalogClient() = default;
+namespace {
+
+// Tables per detail query when prefetching; keeps the IN lists, and the
+// statements, to a sensible size.
+constexpr std::size_t kPrefetchBatchTables = 500;
+
+std::string Cell(const ColumnTable& rows, std::size_t row, std::size_t column) {
+  if (column >= rows.ColumnCount() || rows.Column(column).IsNull(row)) {
+    return std::string();
+  }
+  return rows.Column(column).Format(row);
+}
+
+bool CellBool(const ColumnTable& rows, std::size_t row, std::size_t column) {
+  const std::string value = NormalizeString(Cell(rows, row, column));
+  return value == "1" || value == "true" || value == "t" || value == "y" || value == "yes";
+}
+
+int64_t CellInt(const ColumnTable& rows, std::size_t row, std::size_t column,
+                int64_t fallback) {
+  const std::string value = Cell(rows, row, column);
+  try {
+    return value.empty() ? fallback : std::stoll(value);
+  } catch (const std::exception&) {
+    return fallback;
+  }
+}
+
+// SQL LIKE with % and _, used for schema patterns containing '%'.
+bool LikeMatch(const char* text, const char* pattern) {
+  for (; *pattern; ++pattern, ++text) {
+    if (*pattern == '%') {
+      for (const char* rest = text;; ++rest) {
+        if (LikeMatch(rest, pattern + 1)) {
+          return true;
+        }
+        if (!*rest) {
+          return false;
+        }
+      }
+    }
+    if (!*text || (*pattern != '_' && *pattern != *text)) {
+      return false;
+    }
+  }
+  return !*text;
+}
+
+bool SchemaMatches(const std::string& schema, const std::string& pattern) {
+  if (pattern.empty()) {
+    return true;
+  }
+  return pattern.find('%') == std::string::npos ? schema == pattern
+                                                : LikeMatch(schema.c_str(), pattern.c_str());
+}
+
+}  // namespace
+
+ScratchBirdCatalogClient::ScratchBirdCatalogClient()
+    : cache_(std::make_unique<CatalogCache>()) {}
 
 ScratchBirdCatalogClient::~ScratchBirdCatalogClient() = default;
 
-void ScratchBirdCatalogClient::SetConnection(std::shared_ptr<void> connection) {
+void ScratchBirdCatalogClient::SetConnection(
+    std::shared_ptr<backend::ScratchbirdConnection> connection) {
+  std::lock_guard<std::mutex> lock(query_mutex_);
   connection_ = connection;
 }
 
 bool ScratchBirdCatalogClient::IsConnected() const {
+  std::lock_guard<std::mutex> lock(query_mutex_);
   return connection_ != nullptr;
 }
 
 Status ScratchBirdCatalogClient::Connect(const ConnectionConfig& config) {
   config_ = config;
+  cache_->Clear();
+  const std::string path = SnapshotPath();
+  std::error_code ec;
+  if (!path.empty() && std::filesystem::exists(path, ec)) {
+    // A missing or unreadable snapshot just means a cold start
+    cache_->LoadFromFile(path);
+  }
   return Status::Ok();
 }
 
 void ScratchBirdCatalogClient::Disconnect() {
+  const std::string path = SnapshotPath();
+  if (!path.empty() && cache_->GetStats().tables > 0) {
+    cache_->SaveToFile(path);
+  }
+  std::lock_guard<std::mutex> lock(query_mutex_);
   connection_.reset();
 }
 
+void ScratchBirdCatalogClient::SetSnapshotDirectory(const std::string& directory) {
+  snapshot_directory_ = directory;
+}
+
+std::string ScratchBirdCatalogClient::SnapshotPath() const {
+  if (snapshot_directory_.empty()) {
+    return std::string();
+  }
+  std::string name = config_.host + "_" + std::to_string(config_.port) + "_" + config_.database;
+  for (char& c : name) {
+    const unsigned char u = static_cast<unsigned char>(c);
+    if (!std::isalnum(u) && c != '-' && c != '.' && c != '_') {
+      c = '_';
+    }
+  }
+  return (std::filesystem::path(snapshot_directory_) / (name + ".catalog")).string();
+}
+
 std::vector<SchemaInfo> ScratchBirdCatalogClient::GetSchemas(Status* status) {
+  Status result = EnsureListing();
   if (status) {
-    *status = Status::Ok();
+    *status = result;
   }
-  return {};
+  std::vector<SchemaInfo> schemas;
+  for (const auto& name : cache_->Schemas()) {
+    SchemaInfo schema(name);
+    for (const auto& table : cache_->Tables(name)) {
+      schema.table_names.push_back(table.name);
+    }
+    schemas.push_back(std::move(schema));
+  }
+  return schemas;
 }
 
 std::vector<TableInfo> ScratchBirdCatalogClient::GetTables(const std::string& schema_pattern,
                                                             Status* status) {
+  Status result = EnsureListing();
   if (status) {
-    *status = Status::Ok();
+    *status = result;
   }
-  return {};
+  if (schema_pattern.find('%') == std::string::npos) {
+    return cache_->Tables(schema_pattern);
+  }
+  std::vector<TableInfo> tables = cache_->Tables();
+  tables.erase(std::remove_if(tables.begin(), tables.end(),
+                              [&](const TableInfo& table) {
+                                return !SchemaMatches(table.schema, schema_pattern);
+                              }),
+               tables.end());
+  return tables;
 }
 
 std::optional<TableInfo> ScratchBirdCatalogClient::GetTable(const std::string& schema,
                                                              const std::string& table,
                                                              Status* status) {
-  if (status) {
-    *status = Status::Ok();
+  auto details = TableDetails(schema, table, status);
+  auto listing = cache_->Find(schema, table);
+  if (!listing || !details) {
+    return std::nullopt;
   }
-  return std::nullopt;
+  TableInfo info(listing->name, listing->schema);
+  info.row_count = listing->row_count;
+  info.is_temporary = listing->table_type == "TEMPORARY";
+  info.columns = details->columns;
+  return info;
 }
 
 std::vector<ColumnInfo> ScratchBirdCatalogClient::GetColumns(const std::string& schema,
                                                               const std::string& table,
                                                               Status* status) {
-  if (status) {
-    *status = Status::Ok();
-  }
-  return {};
+  auto details = TableDetails(schema, table, status);
+  return details ? details->columns : std::vector<ColumnInfo>{};
 }
 
 std::vector<IndexInfo> ScratchBirdCatalogClient::GetIndexes(const std::string& schema,
                                                              const std::string& table,
                                                              Status* status) {
-  if (status) {
-    *status = Status::Ok();
-  }
-  return {};
+  auto details = TableDetails(schema, table, status);
+  return details ? details->indexes : std::vector<IndexInfo>{};
 }
 
 std::vector<ConstraintInfo> ScratchBirdCatalogClient::GetConstraints(
     const std::string& schema,
     const std::string& table,
     Status* status) {
-  if (status) {
-    *status = Status::Ok();
-  }
-  return {};
+  auto details = TableDetails(schema, table, status);
+  return details ? details->constraints : std::vector<ConstraintInfo>{};
 }
 
 std::vector<ViewInfo> ScratchBirdCatalogClient::GetViews(const std::string& schema_pattern,
@@ -863,11 +1062,216 @@ std::vector<SequenceInfo> ScratchBirdCatalogClient::GetSequences(
 }
 
 Status ScratchBirdCatalogClient::RefreshCache() {
+  ColumnTable rows;
+  Status status = Query(CatalogQueryBuilder().BuildSysTableListingQuery(), &rows);
+  if (!status.ok) {
+    return status;
+  }
+  std::vector<CatalogTableStamp> listing;
+  listing.reserve(rows.RowCount());
+  for (std::size_t r = 0; r < rows.RowCount(); ++r) {
+    CatalogTableStamp table;
+    table.schema = Cell(rows, r, 0);
+    table.name = Cell(rows, r, 1);
+    table.object_id = Cell(rows, r, 2);
+    table.table_type = Cell(rows, r, 3);
+    table.row_count = CellInt(rows, r, 4, -1);
+    table.stamp = Cell(rows, r, 5) + ":" + Cell(rows, r, 6) + ":" + Cell(rows, r, 7);
+    listing.push_back(std::move(table));
+  }
+  cache_->ApplyListing(std::move(listing));
   return Status::Ok();
 }
 
 void ScratchBirdCatalogClient::ClearCache() {
-  // Clear any cached catalog data
+  cache_->Clear();
+  const std::string path = SnapshotPath();
+  if (!path.empty()) {
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+}
+
+void ScratchBirdCatalogClient::InvalidateForStatement(const std::string& sql) {
+  cache_->InvalidateForStatement(sql);
+}
+
+Status ScratchBirdCatalogClient::EnsureListing() {
+  return cache_->ListingStale() ? RefreshCache() : Status::Ok();
+}
+
+std::optional<CatalogTableDetails> ScratchBirdCatalogClient::TableDetails(
+    const std::string& schema, const std::string& table, Status* status) {
+  Status result = EnsureListing();
+  if (status) {
+    *status = result;
+  }
+  if (!result.ok) {
+    return std::nullopt;
+  }
+  if (auto cached = cache_->Details(schema, table)) {
+    return cached;
+  }
+  std::uint64_t version = 0;
+  auto listing = cache_->Find(schema, table, &version);
+  if (!listing) {
+    return std::nullopt;
+  }
+  std::vector<CatalogTableDetails> details;
+  result = FetchDetails({{*listing, version}}, &details);
+  if (status) {
+    *status = result;
+  }
+  if (!result.ok) {
+    return std::nullopt;
+  }
+  return std::move(details.front());
+}
+
+Status ScratchBirdCatalogClient::PrefetchDetails(const std::string& schema,
+                                                 const std::vector<std::string>& tables) {
+  Status status = EnsureListing();
+  if (!status.ok) {
+    return status;
+  }
+  auto uncached = cache_->Uncached(schema, tables);
+  for (std::size_t start = 0; start < uncached.size(); start += kPrefetchBatchTables) {
+    const std::size_t end = std::min(uncached.size(), start + kPrefetchBatchTables);
+    std::vector<std::pair<CatalogTableStamp, std::uint64_t>> batch(uncached.begin() + start,
+                                                                   uncached.begin() + end);
+    std::vector<CatalogTableDetails> details;
+    status = FetchDetails(batch, &details);
+    if (!status.ok) {
+      return status;
+    }
+  }
+  return Status::Ok();
+}
+
+std::vector<CatalogSearchHit> ScratchBirdCatalogClient::SearchObjects(const std::string& text,
+                                                                      std::size_t limit,
+                                                                      Status* status) {
+  ColumnTable rows;
+  Status result = Query(CatalogQueryBuilder().BuildSysObjectSearchQuery(text, limit), &rows);
+  if (status) {
+    *status = result;
+  }
+  std::vector<CatalogSearchHit> hits;
+  for (std::size_t r = 0; result.ok && r < rows.RowCount(); ++r) {
+    CatalogSearchHit hit;
+    hit.kind = Cell(rows, r, 0);
+    hit.schema = Cell(rows, r, 1);
+    hit.table = Cell(rows, r, 2);
+    hit.name = Cell(rows, r, 3);
+    hits.push_back(std::move(hit));
+  }
+  return hits;
+}
+
+// Fetches and caches the details of |tables|; |details| receives them in
+// the same order.
+Status ScratchBirdCatalogClient::FetchDetails(
+    const std::vector<std::pair<CatalogTableStamp, std::uint64_t>>& tables,
+    std::vector<CatalogTableDetails>* details) {
+  details->assign(tables.size(), CatalogTableDetails{});
+  std::vector<std::string> ids;
+  std::unordered_map<std::string, std::size_t> slot_by_id;
+  for (std::size_t i = 0; i < tables.size(); ++i) {
+    if (slot_by_id.emplace(tables[i].first.object_id, i).second) {
+      ids.push_back(tables[i].first.object_id);
+    }
+  }
+  auto slot = [&](const ColumnTable& rows, std::size_t r) -> CatalogTableDetails* {
+    auto it = slot_by_id.find(Cell(rows, r, 0));
+    return it == slot_by_id.end() ? nullptr : &(*details)[it->second];
+  };
+
+  CatalogQueryBuilder builder;
+  ColumnTable rows;
+  Status result = Query(builder.BuildSysColumnQuery(ids), &rows);
+  for (std::size_t r = 0; result.ok && r < rows.RowCount(); ++r) {
+    CatalogTableDetails* target = slot(rows, r);
+    if (!target) {
+      continue;
+    }
+    ColumnInfo column(Cell(rows, r, 1), Cell(rows, r, 2), CellBool(rows, r, 3));
+    column.default_value = Cell(rows, r, 4);
+    column.ordinal_position = static_cast<int32_t>(CellInt(rows, r, 5, 0));
+    target->columns.push_back(std::move(column));
+  }
+
+  if (result.ok) {
+    result = Query(builder.BuildSysIndexQuery(ids), &rows);
+  }
+  for (std::size_t r = 0; result.ok && r < rows.RowCount(); ++r) {
+    CatalogTableDetails* target = slot(rows, r);
+    if (!target) {
+      continue;
+    }
+    const CatalogTableStamp& table = tables[target - details->data()].first;
+    const std::string name = Cell(rows, r, 1);
+    if (target->indexes.empty() || target->indexes.back().name != name) {
+      IndexInfo index(name, table.name, table.schema);
+      index.table_schema = table.schema;
+      index.index_type = NormalizeString(Cell(rows, r, 2));
+      index.is_unique = CellBool(rows, r, 3);
+      index.filter_condition = Cell(rows, r, 4);
+      target->indexes.push_back(std::move(index));
+    }
+    IndexColumnInfo column;
+    column.name = Cell(rows, r, 5);
+    column.is_expression = CellBool(rows, r, 6);
+    column.expression = Cell(rows, r, 7);
+    if (!column.name.empty() || column.is_expression) {
+      target->indexes.back().columns.push_back(std::move(column));
+    }
+  }
+
+  if (result.ok) {
+    result = Query(builder.BuildSysConstraintQuery(ids), &rows);
+  }
+  for (std::size_t r = 0; result.ok && r < rows.RowCount(); ++r) {
+    CatalogTableDetails* target = slot(rows, r);
+    if (!target) {
+      continue;
+    }
+    const CatalogTableStamp& table = tables[target - details->data()].first;
+    std::string type = Cell(rows, r, 2);
+    std::replace(type.begin(), type.end(), '_', ' ');  // PRIMARY_KEY -> PRIMARY KEY
+    ConstraintInfo constraint(Cell(rows, r, 1), table.name, type, table.schema);
+    constraint.check_expression = Cell(rows, r, 3);
+    constraint.is_deferrable = CellBool(rows, r, 4);
+    constraint.initially_deferred = CellBool(rows, r, 5);
+    target->constraints.push_back(std::move(constraint));
+  }
+
+  if (!result.ok) {
+    return result;
+  }
+  for (std::size_t i = 0; i < tables.size(); ++i) {
+    const std::size_t owner = slot_by_id[tables[i].first.object_id];
+    if (owner != i) {
+      (*details)[i] = (*details)[owner];  // Same table listed twice
+      continue;
+    }
+    cache_->StoreDetails(tables[i].first.schema, tables[i].first.name, tables[i].second,
+                         (*details)[i]);
+  }
+  return Status::Ok();
+}
+
+Status ScratchBirdCatalogClient::Query(const std::string& sql, ColumnTable* rows) {
+  std::lock_guard<std::mutex> lock(query_mutex_);
+  if (!connection_) {
+    return Status::Error("Not connected");
+  }
+  backend::QueryResult result = connection_->query(sql);
+  if (!result.success) {
+    return Status::Error(result.error_message.empty() ? "Catalog query failed"
+                                                      : result.error_message);
+  }
+  *rows = std::move(result.rows);
+  return Status::Ok();
 }
 
 }  // namespace core
@@ -10,18 +10,30 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "result_set.h"
 #include "scratchbird_types.h"
 #include "status.h"
 
 namespace scratchrobin {
+namespace backend {
+class ScratchbirdConnection;
+}  // namespace backend
+
 namespace core {
 
+class CatalogCache;
+struct CatalogTableDetails;
+struct CatalogTableStamp;
+
 // ============================================================================
 // Connection Configuration
 // ============================================================================
@@ -301,6 +313,18 @@ struct SchemaInfo : public CatalogObject {
   std::string GetDropSql(bool if_exists = true, bool cascade = false) const;
 };
 
+// ============================================================================
+// CatalogSearchHit
+// ============================================================================
+
+// A table, column or index whose name matched a catalog search.
+struct CatalogSearchHit {
+  std::string kind;  // "table", "column" or "index"
+  std::string schema;
+  std::string table;
+  std::string name;  // Column or index name; the table name for tables
+};
+
 // ============================================================================
 // CatalogQueryBuilder
 // ============================================================================
@@ -321,25 +345,51 @@ class CatalogQueryBuilder {
   std::string BuildViewQuery(const std::string& schema = "");
   std::string BuildFunctionQuery(const std::string& schema = "");
   std::string BuildSchemaQuery();
+
+  // ScratchBird sys.* catalog. The listing returns schema, table, table_id,
+  // table_type, row_count and a structural stamp per table; the others
+  // cover any number of table_ids from the listing and return the
+  // table_id first, rows of one table together.
+  std::string BuildSysTableListingQuery();
+  std::string BuildSysColumnQuery(const std::vector<std::string>& table_ids);
+  std::string BuildSysIndexQuery(const std::vector<std::string>& table_ids);
+  std::string BuildSysConstraintQuery(const std::vector<std::string>& table_ids);
+  // Tables, columns and indexes whose name contains |text|, ignoring
+  // case; returns kind, schema, table and name, at most |limit| rows.
+  std::string BuildSysObjectSearchQuery(const std::string& text, std::size_t limit);
   
  private:
   static std::string QuoteString(const std::string& str);
+  static std::string QuoteList(const std::vector<std::string>& values);
 };
 
 // ============================================================================
 // ScratchBirdCatalogClient
 // ============================================================================
 
+/**
+ * ScratchBirdCatalogClient - catalog reads served from a CatalogCache
+ *
+ * Tables, columns, indexes and constraints come from the sys.* catalog
+ * through a cache: the table listing is fetched once and refreshed by
+ * stamp, per-table details are fetched on first use, or up front for a
+ * whole schema with PrefetchDetails(). With a snapshot directory set, the
+ * cache is loaded on Connect() and saved on Disconnect(), one file per
+ * server and database. Report DDL run elsewhere (e.g. through
+ * QueryRouter::setDdlListener) to InvalidateForStatement().
+ */
 class ScratchBirdCatalogClient {
  public:
   ScratchBirdCatalogClient();
   ~ScratchBirdCatalogClient();
   
   // Connection management
-  void SetConnection(std::shared_ptr<void> connection);
+  void SetConnection(std::shared_ptr<backend::ScratchbirdConnection> connection);
   bool IsConnected() const;
   Status Connect(const ConnectionConfig& config);
   void Disconnect();
+  void SetSnapshotDirectory(const std::string& directory);
+  std::string SnapshotPath() const;  // Empty without a snapshot directory
   
   // Schema queries
   std::vector<SchemaInfo> GetSchemas(Status* status = nullptr);
@@ -387,13 +437,40 @@ class ScratchBirdCatalogClient {
   std::vector<SequenceInfo> GetSequences(const std::string& schema_pattern = "",
                                          Status* status = nullptr);
   
-  // Cache management
+  // Fetches the columns, indexes and constraints of every table in
+  // |tables| of |schema| (all tables of |schema| when empty) that is not
+  // cached yet, with three queries per batch of tables instead of three
+  // per table. Call it before walking many tables, e.g. for a diagram.
+  Status PrefetchDetails(const std::string& schema,
+                         const std::vector<std::string>& tables = {});
+  
+  // Searches every table, column and index name on the server, so a
+  // navigator can filter without loading the objects it does not show.
+  std::vector<CatalogSearchHit> SearchObjects(const std::string& text, std::size_t limit = 500,
+                                              Status* status = nullptr);
+  
+  // Cache management. RefreshCache() re-reads the listing and drops the
+  // details of tables whose stamp changed; ClearCache() also deletes the
+  // snapshot.
   Status RefreshCache();
   void ClearCache();
+  void InvalidateForStatement(const std::string& sql);
+  CatalogCache& Cache() { return *cache_; }
   
  private:
+  Status EnsureListing();
+  std::optional<CatalogTableDetails> TableDetails(const std::string& schema,
+                                                  const std::string& table, Status* status);
+  Status FetchDetails(const std::vector<std::pair<CatalogTableStamp, std::uint64_t>>& tables,
+                      std::vector<CatalogTableDetails>* details);
+  Status Query(const std::string& sql, ColumnTable* rows);
+
   ConnectionConfig config_;
-  std::shared_ptr<void> connection_;
+  std::shared_ptr<backend::ScratchbirdConnection> connection_;
+  std::unique_ptr<CatalogCache> cache_;
+  std::string snapshot_directory_;
+  // One catalog query at a time on the connection; also guards connection_
+  mutable std::mutex query_mutex_;
 };
 
 }  // namespace core
@@ -17,6 +17,8 @@
 #include <stack>
 #include <unordered_set>
 
+#include "core/sql_lexer.h"
+
 namespace scratchrobin {
 namespace core {
 
@@ -30,11 +32,6 @@ std::string NormalizeString(const std::string& str) {
   return result;
 }
 
-// Check if character is valid for SQL identifier start
-bool IsIdentifierStart(char c) {
-  return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
-}
-
 // Check if character is valid for SQL identifier continuation
 bool IsIdentifierPart(char c) {
   return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
@@ -53,9 +50,9 @@ std::string Trim(const std::string& str) {
   return str.substr(start, end - start);
 }
 
-// SQL keyword set
-const std::unordered_set<std::string>& GetSqlKeywords() {
-  static const std::unordered_set<std::string> keywords = {
+// SQL keywords the context analysis looks for
+const SqlKeywordTable& GetSqlKeywords() {
+  static const SqlKeywordTable keywords({
     "select", "from", "where", "insert", "update", "delete", "create", "drop",
     "alter", "table", "index", "view", "trigger", "function", "procedure",
     "join", "inner", "outer", "left", "right", "full", "cross", "on", "using",
@@ -69,12 +66,33 @@ const std::unordered_set<std::string>& GetSqlKeywords() {
     "integer", "int", "bigint", "smallint", "decimal", "numeric", "real",
     "float", "double", "char", "varchar", "text", "date", "time", "timestamp",
     "interval", "boolean", "bytea", "uuid", "json", "jsonb", "xml"
-  };
+  });
   return keywords;
 }
 
-bool IsKeyword(const std::string& word) {
-  return GetSqlKeywords().find(NormalizeString(word)) != GetSqlKeywords().end();
+// Shares SqlLexer's scanning; only the keyword split is our own
+TokenType ToTokenType(SqlTokenKind kind, std::string_view word) {
+  switch (kind) {
+    case SqlTokenKind::kKeyword:
+    case SqlTokenKind::kFunction:
+    case SqlTokenKind::kIdentifier:
+      return GetSqlKeywords().Contains(word) ? TokenType::kKeyword : TokenType::kIdentifier;
+    case SqlTokenKind::kQuotedIdentifier:
+      return TokenType::kIdentifier;
+    case SqlTokenKind::kString:
+    case SqlTokenKind::kNumber:
+      return TokenType::kLiteral;
+    case SqlTokenKind::kComment:
+      return TokenType::kComment;
+    case SqlTokenKind::kOperator:
+      return TokenType::kOperator;
+    case SqlTokenKind::kPunctuation:
+      return TokenType::kPunctuation;
+    case SqlTokenKind::kWhitespace:
+    case SqlTokenKind::kUnknown:
+      break;
+  }
+  return TokenType::kInvalid;
 }
 
 }  // anonymous namespace
@@ -164,146 +182,20 @@ Tokenizer::Tokenizer() = default;
 Tokenizer::~Tokenizer() = default;
 
 std::vector<Token> Tokenizer::Tokenize(const std::string& sql) {
+  static const SqlLexer lexer;
   std::vector<Token> tokens;
-  size_t pos = 0;
-  
-  while (pos < sql.size()) {
-    char c = sql[pos];
-    
-    // Skip whitespace
-    if (std::isspace(static_cast<unsigned char>(c))) {
-      ++pos;
-      continue;
-    }
-    
-    // Line comment (-- ...)
-    if (c == '-' && pos + 1 < sql.size() && sql[pos + 1] == '-') {
-      size_t start = pos;
-      pos += 2;
-      while (pos < sql.size() && sql[pos] != '\n') {
-        ++pos;
-      }
-      tokens.emplace_back(TokenType::kComment, sql.substr(start, pos - start), start);
-      continue;
+  SqlToken token;
+  SqlLexState state = SqlLexState::kNormal;
+  for (size_t pos = 0; pos < sql.size(); pos += token.length) {
+    state = lexer.Next(sql, pos, state, &token);
+    const std::string_view text = token.Text(sql);
+    const TokenType type = ToTokenType(token.kind, text);
+    if (type == TokenType::kInvalid) {
+      continue;  // Whitespace and unknown characters
     }
-    
-    // Block comment (/* ... */)
-    if (c == '/' && pos + 1 < sql.size() && sql[pos + 1] == '*') {
-      size_t start = pos;
-      pos += 2;
-      while (pos + 1 < sql.size() && !(sql[pos] == '*' && sql[pos + 1] == '/')) {
-        ++pos;
-      }
-      if (pos + 1 < sql.size()) {
-        pos += 2;
-      }
-      tokens.emplace_back(TokenType::kComment, sql.substr(start, pos - start), start);
-      continue;
-    }
-    
-    // String literal
-    if (c == '\'') {
-      size_t start = pos;
-      ++pos;
-      while (pos < sql.size()) {
-        if (sql[pos] == '\'' && pos + 1 < sql.size() && sql[pos + 1] == '\'') {
-          pos += 2;  // Escaped quote
-        } else if (sql[pos] == '\'') {
-          ++pos;
-          break;
-        } else {
-          ++pos;
-        }
-      }
-      tokens.emplace_back(TokenType::kLiteral, sql.substr(start, pos - start), start);
-      continue;
-    }
-    
-    // Quoted identifier
-    if (c == '"') {
-      size_t start = pos;
-      ++pos;
-      while (pos < sql.size() && sql[pos] != '"') {
-        ++pos;
-      }
-      if (pos < sql.size()) {
-        ++pos;
-      }
-      tokens.emplace_back(TokenType::kIdentifier, sql.substr(start, pos - start), start);
-      continue;
-    }
-    
-    // Number literal
-    if (std::isdigit(static_cast<unsigned char>(c)) || 
-        (c == '.' && pos + 1 < sql.size() && std::isdigit(static_cast<unsigned char>(sql[pos + 1])))) {
-      size_t start = pos;
-      bool has_dot = (c == '.');
-      ++pos;
-      while (pos < sql.size()) {
-        if (sql[pos] == '.' && !has_dot) {
-          has_dot = true;
-          ++pos;
-        } else if (std::isdigit(static_cast<unsigned char>(sql[pos]))) {
-          ++pos;
-        } else if (sql[pos] == 'e' || sql[pos] == 'E') {
-          ++pos;
-          if (pos < sql.size() && (sql[pos] == '+' || sql[pos] == '-')) {
-            ++pos;
-          }
-        } else {
-          break;
-        }
-      }
-      tokens.emplace_back(TokenType::kLiteral, sql.substr(start, pos - start), start);
-      continue;
-    }
-    
-    // Identifier or keyword
-    if (IsIdentifierStart(c)) {
-      size_t start = pos;
-      ++pos;
-      while (pos < sql.size() && IsIdentifierPart(sql[pos])) {
-        ++pos;
-      }
-      std::string word = sql.substr(start, pos - start);
-      TokenType type = IsKeyword(word) ? TokenType::kKeyword : TokenType::kIdentifier;
-      tokens.emplace_back(type, word, start);
-      continue;
-    }
-    
-    // Operators (multi-char first)
-    if (pos + 1 < sql.size()) {
-      std::string two_char = sql.substr(pos, 2);
-      if (two_char == "<=" || two_char == ">=" || two_char == "<>" || 
-          two_char == "!=" || two_char == "||" || two_char == "->" ||
-          two_char == "->>" || two_char == "=>" || two_char == "::") {
-        tokens.emplace_back(TokenType::kOperator, two_char, pos);
-        pos += 2;
-        continue;
-      }
-    }
-    
-    // Single char operators and punctuation
-    if (c == '+' || c == '-' || c == '*' || c == '/' || c == '%' ||
-        c == '=' || c == '<' || c == '>' || c == '~' || c == '!' ||
-        c == '&' || c == '|' || c == '^' || c == '#') {
-      tokens.emplace_back(TokenType::kOperator, std::string(1, c), pos);
-      ++pos;
-      continue;
-    }
-    
-    // Punctuation
-    if (c == '(' || c == ')' || c == ',' || c == ';' || c == '.' ||
-        c == '[' || c == ']' || c == '{' || c == '}') {
-      tokens.emplace_back(TokenType::kPunctuation, std::string(1, c), pos);
-      ++pos;
-      continue;
-    }
-    
-    // Unknown character - skip it
-    ++pos;
+    tokens.emplace_back(type, std::string(text), token.offset);
+    tokens.back().length = token.length;
   }
-  
   return tokens;
 }
 
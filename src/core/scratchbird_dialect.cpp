@@ -635,6 +635,13 @@ std::string Dialect::MapType(const std::string& source_type) const {
   return type_mapping_.MapType(source_type);
 }
 
+SqlKeywordTable Dialect::BuildKeywordTable() const {
+  std::vector<std::string> words = SqlKeywordTable::DefaultKeywords().Words();
+  std::vector<std::string> reserved = reserved_words_.GetAllReservedWords();
+  words.insert(words.end(), reserved.begin(), reserved.end());
+  return SqlKeywordTable(words);
+}
+
 // ============================================================================
 // DialectRegistry Implementation
 // ============================================================================
@@ -16,6 +16,8 @@
 #include <unordered_set>
 #include <vector>
 
+#include "core/sql_lexer.h"
+
 namespace scratchrobin {
 namespace core {
 
@@ -206,6 +208,10 @@ class Dialect {
   std::string QuoteString(const std::string& value) const;
   std::string MapType(const std::string& source_type) const;
   
+  // Keywords for SqlLexer: the common SQL keywords plus this dialect's
+  // reserved words. Build once and keep it; lexers hold a reference.
+  SqlKeywordTable BuildKeywordTable() const;
+  
  private:
   std::string name_;
   std::string version_;
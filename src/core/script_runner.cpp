@@ -0,0 +1,714 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/script_runner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
+#include <queue>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "core/sql_lexer.h"
+
+namespace scratchrobin::core {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t ElapsedMs(Clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count();
+}
+
+const SqlLexer& Lexer() {
+  static const SqlLexer lexer;
+  return lexer;
+}
+
+bool IsSignificant(const SqlToken& token) {
+  return token.kind != SqlTokenKind::kWhitespace && token.kind != SqlTokenKind::kComment;
+}
+
+bool IsPunctuation(std::string_view sql, const SqlToken& token, char c) {
+  return token.kind == SqlTokenKind::kPunctuation && sql[token.offset] == c;
+}
+
+bool IsAnyOf(std::string_view sql, const SqlToken& token,
+             std::initializer_list<std::string_view> words) {
+  for (std::string_view word : words) {
+    if (token.Is(sql, word)) return true;
+  }
+  return false;
+}
+
+std::vector<SqlToken> SignificantTokens(std::string_view sql) {
+  std::vector<SqlToken> tokens = Lexer().Lex(sql);
+  tokens.erase(std::remove_if(tokens.begin(), tokens.end(),
+                              [](const SqlToken& token) { return !IsSignificant(token); }),
+               tokens.end());
+  return tokens;
+}
+
+// ============================================================================
+// Statement analysis
+// ============================================================================
+
+// Index of the token saying what the statement does: the first one, or
+// for WITH the verb after the common table expressions; npos when a WITH
+// has none this knows
+std::size_t MainVerb(std::string_view sql, const std::vector<SqlToken>& tokens) {
+  if (tokens.empty() || !tokens[0].Is(sql, "WITH")) {
+    return 0;
+  }
+  int depth = 0;
+  for (std::size_t i = 1; i < tokens.size(); ++i) {
+    if (IsPunctuation(sql, tokens[i], '(')) {
+      ++depth;
+    } else if (IsPunctuation(sql, tokens[i], ')')) {
+      --depth;
+    } else if (depth == 0 && tokens[i].IsWord() &&
+               IsAnyOf(sql, tokens[i], {"SELECT", "VALUES", "INSERT", "UPDATE", "DELETE",
+                                        "MERGE", "UPSERT"})) {
+      return i;
+    }
+  }
+  return std::string::npos;
+}
+
+ScriptStatementKind KindOf(std::string_view sql, const std::vector<SqlToken>& tokens) {
+  if (tokens.empty() || !tokens[0].IsWord()) {
+    return ScriptStatementKind::kOther;
+  }
+  const std::size_t main = MainVerb(sql, tokens);
+  if (main == std::string::npos) {
+    return ScriptStatementKind::kOther;
+  }
+  const SqlToken& first = tokens[main];
+  const bool has_second = tokens.size() > 1;
+  if (IsAnyOf(sql, first, {"SELECT", "VALUES", "SHOW", "EXPLAIN", "DESCRIBE",
+                           "SAVEPOINT", "RELEASE"})) {
+    return ScriptStatementKind::kQuery;
+  }
+  if (IsAnyOf(sql, first, {"INSERT", "UPDATE", "DELETE", "MERGE", "UPSERT", "REPLACE"})) {
+    return ScriptStatementKind::kDml;
+  }
+  if (IsAnyOf(sql, first, {"CREATE", "ALTER", "DROP", "TRUNCATE", "RECREATE", "COMMENT",
+                           "GRANT", "REVOKE", "RENAME"})) {
+    return ScriptStatementKind::kDdl;
+  }
+  if (IsAnyOf(sql, first, {"BEGIN", "START"}) ||
+      (first.Is(sql, "SET") && has_second && tokens[1].Is(sql, "TRANSACTION"))) {
+    return ScriptStatementKind::kTransactionBegin;
+  }
+  if (first.Is(sql, "ROLLBACK") && has_second && tokens[1].Is(sql, "TO")) {
+    return ScriptStatementKind::kQuery;  // To a savepoint; the transaction goes on
+  }
+  if (IsAnyOf(sql, first, {"COMMIT", "ROLLBACK"})) {
+    return ScriptStatementKind::kTransactionEnd;
+  }
+  if (IsAnyOf(sql, first, {"SET", "USE", "CONNECT"})) {
+    return ScriptStatementKind::kSession;
+  }
+  return ScriptStatementKind::kOther;
+}
+
+// Reads the possibly qualified name at |*pos| and returns its last part,
+// lower-cased and unquoted; empty if there is no name there.
+std::string ReadName(std::string_view sql, const std::vector<SqlToken>& tokens, std::size_t* pos) {
+  auto is_name = [&](std::size_t i) {
+    return i < tokens.size() &&
+           (tokens[i].IsWord() || tokens[i].kind == SqlTokenKind::kQuotedIdentifier);
+  };
+  std::size_t i = *pos;
+  // IF [NOT] EXISTS, ONLY, ON TABLE
+  while (i < tokens.size() &&
+         IsAnyOf(sql, tokens[i], {"IF", "NOT", "EXISTS", "ONLY", "TABLE"})) {
+    ++i;
+  }
+  if (!is_name(i)) {
+    return {};
+  }
+  while (i + 2 < tokens.size() && IsPunctuation(sql, tokens[i + 1], '.') && is_name(i + 2)) {
+    i += 2;
+  }
+  std::string_view text = tokens[i].Text(sql);
+  if (tokens[i].kind == SqlTokenKind::kQuotedIdentifier && text.size() >= 2) {
+    text = text.substr(1, text.size() - 2);
+  }
+  *pos = i + 1;
+  std::string name(text);
+  std::transform(name.begin(), name.end(), name.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return name;
+}
+
+void AddUnique(std::vector<std::string>* names, std::string name) {
+  if (std::find(names->begin(), names->end(), name) == names->end()) {
+    names->push_back(std::move(name));
+  }
+}
+
+// Index of TABLE in CREATE [GLOBAL | LOCAL] TEMP[ORARY] TABLE or DECLARE
+// [LOCAL] TEMPORARY TABLE; npos for anything else
+std::size_t TemporaryTable(std::string_view sql, const std::vector<SqlToken>& tokens) {
+  if (tokens.empty() || !IsAnyOf(sql, tokens[0], {"CREATE", "DECLARE"})) {
+    return std::string::npos;
+  }
+  std::size_t i = 1;
+  while (i < tokens.size() && i < 3 && IsAnyOf(sql, tokens[i], {"GLOBAL", "LOCAL"})) ++i;
+  if (i + 1 < tokens.size() && IsAnyOf(sql, tokens[i], {"TEMP", "TEMPORARY"}) &&
+      tokens[i + 1].Is(sql, "TABLE")) {
+    return i + 1;
+  }
+  return std::string::npos;
+}
+
+void Analyze(ScriptStatement* statement) {
+  const std::string_view sql = statement->sql;
+  const std::vector<SqlToken> tokens = SignificantTokens(sql);
+  statement->kind = KindOf(sql, tokens);
+  if (const std::size_t table = TemporaryTable(sql, tokens); table != std::string::npos) {
+    // Session state: a barrier, and the home of every later use of the table
+    statement->kind = ScriptStatementKind::kSession;
+    statement->temporary = true;
+    std::size_t pos = table + 1;
+    std::string name = ReadName(sql, tokens, &pos);
+    if (!name.empty()) statement->writes.push_back(std::move(name));
+    return;
+  }
+  const ScriptStatementKind kind = statement->kind;
+  if (kind != ScriptStatementKind::kQuery && kind != ScriptStatementKind::kDml &&
+      kind != ScriptStatementKind::kDdl) {
+    return;
+  }
+
+  // The target of WITH ... INSERT comes after the CTEs, which only read
+  const std::size_t main = MainVerb(sql, tokens);
+  const bool is_delete = tokens[main].Is(sql, "DELETE");
+  bool have_target = false;
+  std::size_t trigger_for = std::string::npos;  // CREATE TRIGGER t FOR <table>
+  for (std::size_t i = 0; i < tokens.size(); ++i) {
+    const SqlToken& token = tokens[i];
+    if (!token.IsWord()) {
+      continue;
+    }
+    const bool list = IsAnyOf(sql, token, {"FROM", "USING"});
+    const bool object = list || IsAnyOf(sql, token, {"JOIN", "INTO", "TABLE", "REFERENCES"}) ||
+                        (token.Is(sql, "UPDATE") && i == main) || i == trigger_for ||
+                        (kind == ScriptStatementKind::kDdl &&
+                         IsAnyOf(sql, token, {"ON", "VIEW", "INDEX", "SEQUENCE", "GENERATOR",
+                                              "PROCEDURE", "FUNCTION", "TRIGGER", "DOMAIN",
+                                              "PACKAGE", "EXCEPTION", "TRUNCATE"}));
+    if (!object) {
+      continue;
+    }
+
+    // DML writes its target; DDL the object it defines and, for indexes,
+    // triggers and grants, the table after ON or a trigger's FOR
+    bool write = false;
+    if (kind == ScriptStatementKind::kDml) {
+      write = !have_target && i >= main &&
+              (token.Is(sql, "INTO") || token.Is(sql, "UPDATE") ||
+               (is_delete && token.Is(sql, "FROM")));
+    } else if (kind == ScriptStatementKind::kDdl) {
+      write = (!have_target && !token.Is(sql, "REFERENCES")) || token.Is(sql, "ON") ||
+              i == trigger_for;
+    }
+
+    std::size_t pos = i + 1;
+    std::string name = ReadName(sql, tokens, &pos);
+    if (kind == ScriptStatementKind::kDdl && token.Is(sql, "TRIGGER") && !name.empty() &&
+        pos < tokens.size() && tokens[pos].Is(sql, "FOR")) {
+      trigger_for = pos;
+    }
+    while (!name.empty()) {
+      if (write) {
+        have_target = true;
+        AddUnique(&statement->writes, std::move(name));
+      } else {
+        AddUnique(&statement->reads, std::move(name));
+      }
+      write = false;
+      if (!list) break;
+      // FROM a [AS] x, b y
+      if (pos < tokens.size() && tokens[pos].Is(sql, "AS")) ++pos;
+      if (pos < tokens.size() && tokens[pos].kind == SqlTokenKind::kIdentifier) ++pos;
+      if (pos >= tokens.size() || !IsPunctuation(sql, tokens[pos], ',')) break;
+      ++pos;
+      name = ReadName(sql, tokens, &pos);
+    }
+    i = pos - 1;
+  }
+
+  // An object written is not also a read
+  auto& reads = statement->reads;
+  reads.erase(std::remove_if(reads.begin(), reads.end(),
+                             [&](const std::string& name) {
+                               return std::find(statement->writes.begin(),
+                                                statement->writes.end(),
+                                                name) != statement->writes.end();
+                             }),
+              reads.end());
+}
+
+}  // namespace
+
+// ============================================================================
+// Planning
+// ============================================================================
+
+std::vector<ScriptStatement> ScriptRunner::Split(const std::string& script) {
+  std::vector<ScriptStatement> statements;
+  const std::vector<SqlToken> tokens = Lexer().Lex(script);
+
+  std::string terminator = ";";
+  std::size_t begin = std::string::npos;  // First significant token of the statement
+  std::size_t first_word = 0;             // Token index of that token
+  std::size_t words = 0;                  // Words in the statement so far
+  int depth = 0;  // BEGIN / CASE ... END nesting, while ';' terminates
+  bool pending_end = false;
+  int line = 1;
+  std::size_t line_pos = 0;
+
+  auto finish = [&](std::size_t end) {
+    std::string_view text = std::string_view(script).substr(begin, end - begin);
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+      text.remove_suffix(1);
+    }
+    // SET TERM <new> changes the terminator and is not sent
+    std::size_t second = first_word + 1;
+    while (second < tokens.size() && !IsSignificant(tokens[second])) ++second;
+    if (tokens[first_word].Is(script, "SET") && second < tokens.size() &&
+        tokens[second].offset < end && tokens[second].Is(script, "TERM")) {
+      std::string_view rest = std::string_view(script).substr(
+          tokens[second].offset + tokens[second].length,
+          end - tokens[second].offset - tokens[second].length);
+      const std::size_t from = rest.find_first_not_of(" \t\r\n");
+      const std::size_t to = rest.find_last_not_of(" \t\r\n");
+      if (from != std::string_view::npos) {
+        terminator = std::string(rest.substr(from, to - from + 1));
+      }
+    } else {
+      line += static_cast<int>(std::count(script.begin() + line_pos, script.begin() + begin, '\n'));
+      line_pos = begin;
+      ScriptStatement statement;
+      statement.sql = std::string(text);
+      statement.offset = begin;
+      statement.line = line;
+      statements.push_back(std::move(statement));
+    }
+    begin = std::string::npos;
+    words = 0;
+    depth = 0;
+    pending_end = false;
+  };
+
+  for (std::size_t i = 0; i < tokens.size(); ++i) {
+    const SqlToken& token = tokens[i];
+    if (!IsSignificant(token)) {
+      continue;
+    }
+
+    if (terminator != ";") {
+      const bool quoted = token.kind == SqlTokenKind::kString ||
+                          token.kind == SqlTokenKind::kQuotedIdentifier;
+      if (!quoted && script.compare(token.offset, terminator.size(), terminator) == 0) {
+        if (begin != std::string::npos) finish(token.offset);
+        // Skip the tokens the terminator spans
+        const std::size_t end = token.offset + terminator.size();
+        while (i + 1 < tokens.size() && tokens[i + 1].offset < end) ++i;
+        continue;
+      }
+    } else {
+      const bool closes = pending_end && !(token.IsWord() &&
+          IsAnyOf(script, token, {"IF", "LOOP", "WHILE", "REPEAT", "FOR"}));
+      if (pending_end) {
+        pending_end = false;
+        if (closes) --depth;
+        if (closes && token.Is(script, "CASE")) {
+          continue;  // END CASE
+        }
+      }
+      if (IsPunctuation(script, token, ';')) {
+        if (depth == 0) {
+          if (begin != std::string::npos) finish(token.offset);
+          continue;
+        }
+      } else if (token.IsWord()) {
+        if (token.Is(script, "END") && depth > 0) {
+          pending_end = true;
+        } else if ((token.Is(script, "BEGIN") && words > 0) || token.Is(script, "CASE")) {
+          ++depth;  // A leading BEGIN starts a transaction
+        }
+      }
+    }
+
+    if (begin == std::string::npos) {
+      begin = token.offset;
+      first_word = i;
+    }
+    if (token.IsWord()) ++words;
+  }
+  if (begin != std::string::npos) {
+    finish(script.size());
+  }
+
+  for (auto& statement : statements) {
+    Analyze(&statement);
+  }
+  return statements;
+}
+
+ScriptPlan ScriptRunner::Plan(const std::string& script) {
+  ScriptPlan plan;
+  plan.statements = Split(script);
+  const auto& statements = plan.statements;
+
+  // Units: transaction blocks stay together
+  for (std::size_t i = 0; i < statements.size(); ++i) {
+    ScriptUnit unit;
+    unit.statements.push_back(i);
+    if (statements[i].kind == ScriptStatementKind::kTransactionBegin) {
+      unit.transaction = true;
+      while (i + 1 < statements.size()) {
+        unit.statements.push_back(++i);
+        if (statements[i].kind == ScriptStatementKind::kTransactionEnd) break;
+      }
+    }
+    plan.units.push_back(std::move(unit));
+  }
+
+  // Dependencies: a unit follows the last earlier writer of each object it
+  // touches and, when it writes, the readers since that writer. Barriers
+  // follow everything since the previous barrier and lead everything after.
+  struct ObjectState {
+    std::size_t writer = SIZE_MAX;
+    std::vector<std::size_t> readers;
+  };
+  std::unordered_map<std::string, ObjectState> objects;
+  std::size_t last_barrier = SIZE_MAX;
+  std::vector<std::size_t> since_barrier;
+  std::vector<std::string> temporary;  // Temporary tables created so far
+
+  for (std::size_t u = 0; u < plan.units.size(); ++u) {
+    ScriptUnit& unit = plan.units[u];
+    std::vector<std::string> reads;
+    std::vector<std::string> writes;
+    for (std::size_t s : unit.statements) {
+      const ScriptStatement& statement = statements[s];
+      if (statement.kind == ScriptStatementKind::kSession ||
+          statement.kind == ScriptStatementKind::kOther) {
+        unit.barrier = true;
+      }
+      for (const auto& name : statement.writes) AddUnique(&writes, name);
+      for (const auto& name : statement.reads) AddUnique(&reads, name);
+      if (statement.temporary) {
+        unit.pinned = true;
+        for (const auto& name : statement.writes) AddUnique(&temporary, name);
+      }
+    }
+    for (const auto* names : {&reads, &writes}) {
+      for (const auto& name : *names) {
+        if (std::find(temporary.begin(), temporary.end(), name) != temporary.end()) {
+          unit.pinned = true;
+        }
+      }
+    }
+    if (reads.empty() && writes.empty()) {
+      unit.barrier = true;  // Nothing to order it by
+    }
+
+    auto& deps = unit.depends_on;
+    if (last_barrier != SIZE_MAX) deps.push_back(last_barrier);
+    if (unit.barrier) {
+      deps.insert(deps.end(), since_barrier.begin(), since_barrier.end());
+      last_barrier = u;
+      since_barrier.clear();
+      objects.clear();
+    } else {
+      for (const auto& name : writes) {
+        ObjectState& state = objects[name];
+        if (state.writer != SIZE_MAX) deps.push_back(state.writer);
+        deps.insert(deps.end(), state.readers.begin(), state.readers.end());
+        state.writer = u;
+        state.readers.clear();
+      }
+      for (const auto& name : reads) {
+        if (std::find(writes.begin(), writes.end(), name) != writes.end()) continue;
+        ObjectState& state = objects[name];
+        if (state.writer != SIZE_MAX) deps.push_back(state.writer);
+        state.readers.push_back(u);
+      }
+      since_barrier.push_back(u);
+    }
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+  }
+  return plan;
+}
+
+bool ScriptRunner::LeavesTransactionOpen(const ScriptPlan& plan) {
+  // Plan() runs an unterminated block to the end of the script
+  if (plan.units.empty() || !plan.units.back().transaction) {
+    return false;
+  }
+  const std::size_t last = plan.units.back().statements.back();
+  return plan.statements[last].kind != ScriptStatementKind::kTransactionEnd;
+}
+
+// ============================================================================
+// Execution
+// ============================================================================
+
+ScriptRunner::ScriptRunner(ConnectionFactory factory)
+    : ScriptRunner(std::move(factory), nullptr) {}
+
+ScriptRunner::ScriptRunner(ConnectionFactory factory, StatementExecutor executor)
+    : factory_(std::move(factory)), executor_(std::move(executor)) {
+  if (!executor_) {
+    executor_ = [](Connection& connection, const std::string& sql, int64_t* rows_affected) {
+      backend::QueryResult result = connection.execute(sql);
+      if (!result.success) {
+        return Status::Error(result.error_message);
+      }
+      *rows_affected = result.affected_rows;
+      return Status::Ok();
+    };
+  }
+}
+
+void ScriptRunner::SetStatementCallback(StatementCallback callback) {
+  callback_ = std::move(callback);
+}
+
+void ScriptRunner::Cancel() {
+  cancelled_ = true;
+  std::lock_guard<std::mutex> lock(active_mutex_);
+  for (const auto& connection : active_) {
+    connection->cancel();
+  }
+}
+
+ScriptRunResult ScriptRunner::Run(const ScriptPlan& plan, const ScriptRunOptions& options) {
+  const auto started = Clock::now();
+  cancelled_ = false;
+  {
+    std::lock_guard<std::mutex> lock(active_mutex_);
+    active_.clear();
+  }
+
+  ScriptRunResult result;
+  result.statements.resize(plan.statements.size());
+  for (std::size_t i = 0; i < plan.statements.size(); ++i) {
+    result.statements[i].statement = i;
+    result.statements[i].status = Status::Error("Skipped");
+    result.statements[i].skipped = true;
+  }
+
+  const std::size_t unit_count = plan.units.size();
+  std::vector<std::vector<std::size_t>> dependents(unit_count);
+  std::vector<std::size_t> remaining(unit_count);
+  std::vector<bool> poisoned(unit_count, false);  // A dependency failed
+  using ReadyQueue = std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<>>;
+  ReadyQueue ready;
+  ReadyQueue pinned_ready;  // Taken by the home worker only
+  auto make_ready = [&](std::size_t u) {
+    (plan.units[u].pinned ? pinned_ready : ready).push(u);
+  };
+  for (std::size_t u = 0; u < unit_count; ++u) {
+    remaining[u] = plan.units[u].depends_on.size();
+    for (std::size_t dep : plan.units[u].depends_on) {
+      dependents[dep].push_back(u);
+    }
+    if (remaining[u] == 0) make_ready(u);
+  }
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::size_t running = 0;
+  bool stopping = false;
+  bool home_alive = true;  // The home worker can still take pinned units
+  int recorded = 0;  // Statements with a result; the rest were skipped
+  std::vector<std::size_t> session;  // Session statements run so far, in order
+
+  // Under |mutex|: releases the dependents of a finished unit. Dependents
+  // of a failure are resolved as skipped in turn.
+  auto finish_unit = [&](std::size_t finished, bool finished_ok) {
+    std::vector<std::pair<std::size_t, bool>> pending{{finished, finished_ok}};
+    while (!pending.empty()) {
+      const auto [u, ok] = pending.back();
+      pending.pop_back();
+      for (std::size_t next : dependents[u]) {
+        if (!ok) poisoned[next] = true;
+        if (--remaining[next] == 0) {
+          if (poisoned[next]) {
+            pending.emplace_back(next, false);
+          } else {
+            make_ready(next);
+          }
+        }
+      }
+    }
+  };
+
+  auto report = [&](const ScriptStatementResult& statement_result) {
+    if (callback_) callback_(statement_result);
+  };
+
+  // The home worker also takes pinned units; the others wait for it
+  // while it has some to run
+  auto worker = [&](bool home) {
+    std::shared_ptr<Connection> connection;
+    std::size_t applied = 0;  // Session statements run on |connection|
+    auto can_take = [&] { return !ready.empty() || (home && !pinned_ready.empty()); };
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      cv.wait(lock, [&] {
+        return stopping || can_take() ||
+               (running == 0 && (home || pinned_ready.empty() || !home_alive));
+      });
+      if (stopping || cancelled_ || !can_take()) {
+        break;
+      }
+      std::size_t u;
+      if (home && !pinned_ready.empty() && (ready.empty() || pinned_ready.top() < ready.top())) {
+        u = pinned_ready.top();
+        pinned_ready.pop();
+      } else {
+        u = ready.top();
+        ready.pop();
+      }
+      ++running;
+      const std::vector<std::size_t> replay(session.begin() + static_cast<std::ptrdiff_t>(applied),
+                                            session.end());
+      lock.unlock();
+
+      const ScriptUnit& unit = plan.units[u];
+      bool ok = true;
+      bool lost_connection = false;
+      std::vector<ScriptStatementResult> unit_results;
+      if (!connection) {
+        std::string error;
+        if (options.connection) {
+          connection = options.connection;
+        } else {
+          connection = factory_ ? factory_(&error) : nullptr;
+        }
+        if (connection) {
+          std::lock_guard<std::mutex> active_lock(active_mutex_);
+          active_.push_back(connection);
+        } else {
+          ScriptStatementResult failure;
+          failure.statement = unit.statements.front();
+          failure.status = Status::Error("Could not open a connection: " + error);
+          unit_results.push_back(failure);
+          ok = false;
+          lost_connection = true;
+        }
+      }
+      for (std::size_t s : replay) {
+        if (!ok) break;
+        int64_t rows = 0;
+        const Status status = executor_(*connection, plan.statements[s].sql, &rows);
+        if (!status.ok) {
+          ScriptStatementResult failure;
+          failure.statement = unit.statements.front();
+          failure.status = Status::Error("Replaying \"" + plan.statements[s].sql +
+                                         "\" failed: " + status.message);
+          unit_results.push_back(failure);
+          ok = false;
+        }
+        ++applied;
+      }
+
+      for (std::size_t k = 0; ok && k < unit.statements.size(); ++k) {
+        if (cancelled_) {
+          ok = false;
+          break;
+        }
+        const std::size_t s = unit.statements[k];
+        ScriptStatementResult statement_result;
+        statement_result.statement = s;
+        const auto statement_started = Clock::now();
+        statement_result.status =
+            executor_(*connection, plan.statements[s].sql, &statement_result.rows_affected);
+        statement_result.elapsed_ms = ElapsedMs(statement_started);
+        statement_result.executed = true;
+        ok = statement_result.status.ok;
+        unit_results.push_back(statement_result);
+        report(statement_result);
+        if (!ok && unit.transaction && k + 1 < unit.statements.size()) {
+          int64_t rows = 0;
+          executor_(*connection, "ROLLBACK", &rows);  // Leave the connection clean
+        }
+      }
+      for (const auto& failure : unit_results) {
+        if (!failure.executed) report(failure);
+      }
+
+      lock.lock();
+      for (auto& statement_result : unit_results) {
+        if (statement_result.executed) ++result.executed;
+        if (!statement_result.status.ok) ++result.failed;
+        ++recorded;
+        result.statements[statement_result.statement] = std::move(statement_result);
+      }
+      if (ok && unit.statements.size() == 1 &&
+          plan.statements[unit.statements[0]].kind == ScriptStatementKind::kSession &&
+          !plan.statements[unit.statements[0]].temporary) {
+        session.push_back(unit.statements[0]);
+        ++applied;
+      }
+      --running;
+      finish_unit(u, ok);
+      if (!ok && options.stop_on_error) {
+        stopping = true;
+      }
+      cv.notify_all();
+      if (lost_connection) {
+        break;
+      }
+    }
+    if (home) {
+      home_alive = false;  // Pinned units left now stay skipped
+    }
+    lock.unlock();
+    cv.notify_all();
+  };
+
+  unsigned parallel = options.max_parallel > 0 ? static_cast<unsigned>(options.max_parallel)
+                                               : std::max(1u, std::thread::hardware_concurrency());
+  if (options.connection) {
+    parallel = 1;  // One worker takes the units in script order
+  }
+  parallel = static_cast<unsigned>(std::min<std::size_t>(parallel, unit_count));
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < parallel; ++i) {
+    workers.emplace_back(worker, i == 0);
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(active_mutex_);
+    result.connections = static_cast<int>(active_.size());
+    active_.clear();
+  }
+  result.skipped = static_cast<int>(plan.statements.size()) - recorded;
+  result.cancelled = cancelled_;
+  result.elapsed_ms = ElapsedMs(started);
+  return result;
+}
+
+}  // namespace scratchrobin::core
@@ -0,0 +1,154 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "backend/scratchbird_connection.h"
+#include "core/status.h"
+
+namespace scratchrobin::core {
+
+// Scripts run on backend connections (same alias as the executor)
+using Connection = backend::ScratchbirdConnection;
+
+// How a statement is scheduled
+enum class ScriptStatementKind : std::uint8_t {
+  kQuery,             // Reads its objects
+  kDml,               // Writes its target, reads the rest
+  kDdl,               // Writes the object it defines
+  kTransactionBegin,  // BEGIN, START TRANSACTION, SET TRANSACTION
+  kTransactionEnd,    // COMMIT, ROLLBACK
+  kSession,           // SET, USE, ...: replayed on every connection;
+                      // temporary tables: run on the script's home connection
+  kOther,             // Unknown side effects (EXECUTE, CALL, ...)
+};
+
+struct ScriptStatement {
+  std::string sql;  // Without its terminator
+  std::size_t offset = 0;  // Into the script
+  int line = 1;
+  ScriptStatementKind kind = ScriptStatementKind::kOther;
+  // Object names, lower-cased even when quoted and without their schema,
+  // so 's.t', 'T' and '"t"' collide: a false dependency costs parallelism,
+  // a missed one correctness
+  std::vector<std::string> reads;
+  std::vector<std::string> writes;
+  bool temporary = false;  // Creates a temporary table, named in |writes|
+};
+
+// Statements that run in order on one connection: a single statement, or
+// a transaction block from BEGIN to COMMIT or ROLLBACK
+struct ScriptUnit {
+  std::vector<std::size_t> statements;
+  std::vector<std::size_t> depends_on;  // Earlier units
+  bool barrier = false;  // Runs alone: after every earlier unit, before every later one
+  bool transaction = false;
+  // Creates or uses a temporary table of the script, so runs on the home
+  // connection (the first worker's), where that table lives
+  bool pinned = false;
+};
+
+struct ScriptPlan {
+  std::vector<ScriptStatement> statements;
+  std::vector<ScriptUnit> units;
+};
+
+struct ScriptStatementResult {
+  std::size_t statement = 0;
+  Status status;
+  bool executed = false;  // False when it never ran
+  bool skipped = false;   // Not run after a failure or cancel; other unrun ones failed
+  int64_t rows_affected = 0;
+  int64_t elapsed_ms = 0;
+};
+
+struct ScriptRunOptions {
+  // Connections; 0 = hardware concurrency. Dependencies are inferred from
+  // the object names in each statement, so triggers, foreign keys and
+  // other side effects are not seen: run scripts of unknown origin with 1.
+  int max_parallel = 0;
+  bool stop_on_error = true;  // Otherwise only units depending on a failure are skipped
+  // When set, every unit runs on this connection in script order and the
+  // factory is not called: for scripts inside the caller's transaction
+  std::shared_ptr<Connection> connection;
+};
+
+struct ScriptRunResult {
+  std::vector<ScriptStatementResult> statements;  // By statement index
+  int executed = 0;
+  int failed = 0;
+  int skipped = 0;
+  int connections = 0;
+  int64_t elapsed_ms = 0;
+  bool cancelled = false;
+};
+
+/**
+ * ScriptRunner - runs a multi-statement script concurrently
+ *
+ * Plan() splits the script with SqlLexer, so terminators inside strings,
+ * comments and BEGIN ... END bodies do not split, and honours SET TERM.
+ * Each statement gets the objects it reads and writes; units conflict
+ * when they share an object that one of them writes, and a unit depends
+ * on the earlier units it conflicts with. Session statements and
+ * statements with unknown effects are barriers. A temporary table exists
+ * only on the connection that created it, so its DDL and every unit
+ * naming it are pinned to one connection.
+ *
+ * Run() executes the units of a plan on up to max_parallel connections,
+ * each opened once by the factory and reused by one worker. A unit starts
+ * when its dependencies succeeded; session statements already run are
+ * replayed on a connection before it takes its next unit, so every
+ * statement sees the session state the script gave it.
+ */
+class ScriptRunner {
+ public:
+  // Opens a connection; returns null and fills |error| on failure
+  using ConnectionFactory = std::function<std::shared_ptr<Connection>(std::string* error)>;
+  // Runs one statement; the default calls Connection::execute()
+  using StatementExecutor = std::function<Status(Connection& connection, const std::string& sql,
+                                                 int64_t* rows_affected)>;
+  // Called from worker threads as each statement finishes or is skipped
+  using StatementCallback = std::function<void(const ScriptStatementResult& result)>;
+
+  explicit ScriptRunner(ConnectionFactory factory);
+  ScriptRunner(ConnectionFactory factory, StatementExecutor executor);
+
+  ScriptRunner(const ScriptRunner&) = delete;
+  ScriptRunner& operator=(const ScriptRunner&) = delete;
+
+  static std::vector<ScriptStatement> Split(const std::string& script);
+  static ScriptPlan Plan(const std::string& script);
+  // True when the plan ends inside a BEGIN it never commits or rolls back
+  static bool LeavesTransactionOpen(const ScriptPlan& plan);
+
+  // Blocks until every unit finished or was skipped.
+  ScriptRunResult Run(const ScriptPlan& plan, const ScriptRunOptions& options);
+
+  // Stops scheduling and cancels running statements; safe from any thread.
+  void Cancel();
+
+  void SetStatementCallback(StatementCallback callback);
+
+ private:
+  ConnectionFactory factory_;
+  StatementExecutor executor_;
+  StatementCallback callback_;
+  std::atomic<bool> cancelled_{false};
+  std::mutex active_mutex_;
+  std::vector<std::shared_ptr<Connection>> active_;  // Connections of the running Run()
+};
+
+}  // namespace scratchrobin::core
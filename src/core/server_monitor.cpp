@@ -19,6 +19,46 @@
 
 namespace scratchrobin::core {
 
+namespace {
+
+using MetricField = TimeSeriesField<ServerPerformanceMetrics>;
+
+const std::vector<MetricField>& MetricFields() {
+  static const std::vector<MetricField> fields = {
+      {"cpu_percent", &ServerPerformanceMetrics::cpu_percent},
+      {"cpu_user_percent", &ServerPerformanceMetrics::cpu_user_percent},
+      {"cpu_system_percent", &ServerPerformanceMetrics::cpu_system_percent},
+      {"memory_used_bytes", &ServerPerformanceMetrics::memory_used_bytes},
+      {"memory_total_bytes", &ServerPerformanceMetrics::memory_total_bytes},
+      {"memory_percent", &ServerPerformanceMetrics::memory_percent},
+      {"shared_buffers_bytes", &ServerPerformanceMetrics::shared_buffers_bytes},
+      {"cache_bytes", &ServerPerformanceMetrics::cache_bytes},
+      {"disk_read_mbps", &ServerPerformanceMetrics::disk_read_mbps},
+      {"disk_write_mbps", &ServerPerformanceMetrics::disk_write_mbps},
+      {"disk_read_iops", &ServerPerformanceMetrics::disk_read_iops},
+      {"disk_write_iops", &ServerPerformanceMetrics::disk_write_iops},
+      {"network_in_mbps", &ServerPerformanceMetrics::network_in_mbps},
+      {"network_out_mbps", &ServerPerformanceMetrics::network_out_mbps},
+      {"transactions_per_sec", &ServerPerformanceMetrics::transactions_per_sec},
+      {"queries_per_sec", &ServerPerformanceMetrics::queries_per_sec},
+      {"connections_active", &ServerPerformanceMetrics::connections_active},
+      {"connections_idle", &ServerPerformanceMetrics::connections_idle},
+      {"connections_total", &ServerPerformanceMetrics::connections_total},
+      {"waiting_connections", &ServerPerformanceMetrics::waiting_connections},
+      {"blocked_queries", &ServerPerformanceMetrics::blocked_queries},
+      {"cache_hit_ratio", &ServerPerformanceMetrics::cache_hit_ratio},
+      {"buffer_hits_per_sec", &ServerPerformanceMetrics::buffer_hits_per_sec},
+      {"buffer_reads_per_sec", &ServerPerformanceMetrics::buffer_reads_per_sec},
+  };
+  return fields;
+}
+
+int64_t ToMilliseconds(const std::chrono::system_clock::time_point& time) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+}  // namespace
+
 // ============================================================================
 // Singleton
 // ============================================================================
@@ -112,12 +152,39 @@ ServerPerformanceMetrics ServerMonitor::GetCurrentMetrics() {
 std::vector<ServerPerformanceMetrics> ServerMonitor::GetMetricsHistory(
     const std::chrono::system_clock::time_point& from,
     const std::chrono::system_clock::time_point& to) {
+  const auto& fields = MetricFields();
+  std::vector<std::string> names;
+  for (const auto& field : fields) {
+    names.push_back(field.name);
+  }
+  const auto retained = std::chrono::system_clock::now() - std::chrono::hours(retention_hours_);
+  const int64_t from_ms = ToMilliseconds(std::max(from, retained));
+  const int64_t to_ms = ToMilliseconds(to) + 1;  // |to| is included
+
   std::lock_guard<std::mutex> lock(mutex_);
+  TimeSeriesResolution resolution =
+      metrics_history_.Resolve(names[0], from_ms, TimeSeriesResolution::kAuto);
+  auto rows = metrics_history_.Rows(names, from_ms, to_ms, resolution);
+  while (static_cast<int>(rows.size()) > max_data_points_ &&
+         resolution != TimeSeriesResolution::kHour) {
+    resolution = resolution == TimeSeriesResolution::kRaw ? TimeSeriesResolution::kMinute
+                                                          : TimeSeriesResolution::kHour;
+    rows = metrics_history_.Rows(names, from_ms, to_ms, resolution);
+  }
+  // Still too many at the coarsest: the latest ones
+  const auto limit = static_cast<std::size_t>(std::max(max_data_points_, 0));
+  const std::size_t skip = rows.size() > limit ? rows.size() - limit : 0;
+
   std::vector<ServerPerformanceMetrics> result;
-  for (const auto& metrics : metrics_history_) {
-    if (metrics.timestamp >= from && metrics.timestamp <= to) {
-      result.push_back(metrics);
+  result.reserve(rows.size() - skip);
+  for (std::size_t i = skip; i < rows.size(); ++i) {
+    ServerPerformanceMetrics metrics;
+    metrics.timestamp = std::chrono::system_clock::time_point(
+        std::chrono::milliseconds(rows[i].time_ms));
+    for (std::size_t f = 0; f < fields.size(); ++f) {
+      fields[f].Set(&metrics, rows[i].values[f]);
     }
+    result.push_back(metrics);
   }
   return result;
 }
@@ -160,8 +227,44 @@ void ServerMonitor::StartMonitoring(int interval_seconds) {
   monitor_thread.detach();
 }
 
+void ServerMonitor::StartMonitoring(std::shared_ptr<MetricsSampler> sampler,
+                                    int interval_seconds) {
+  if (is_monitoring_ || !sampler) {
+    return;
+  }
+  AddServerStatSources(sampler.get());
+
+  is_monitoring_ = true;
+  monitoring_interval_seconds_ = interval_seconds;
+  const int64_t interval_ms = static_cast<int64_t>(interval_seconds) * 1000;
+  std::vector<uint64_t> ids;
+  ids.push_back(sampler->Subscribe(kMetricSessions, interval_ms,
+                                   [this](const MetricSample& s) { OnSessionsSample(s); }));
+  ids.push_back(sampler->Subscribe(kMetricDatabase, interval_ms,
+                                   [this](const MetricSample& s) { OnDatabaseSample(s); }));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  sampler_ = std::move(sampler);
+  subscriptions_ = std::move(ids);
+  has_activity_ = false;
+}
+
 void ServerMonitor::StopMonitoring() {
   is_monitoring_ = false;
+
+  // Unsubscribe() waits for a running callback, which may need mutex_
+  std::shared_ptr<MetricsSampler> sampler;
+  std::vector<uint64_t> ids;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampler = std::move(sampler_);
+    ids.swap(subscriptions_);
+  }
+  if (sampler) {
+    for (uint64_t id : ids) {
+      sampler->Unsubscribe(id);
+    }
+  }
 }
 
 void ServerMonitor::SetMetricsCallback(MetricsCallback callback) {
@@ -288,23 +391,7 @@ bool ServerMonitor::ExportMetricsToCsv(
 
 void ServerMonitor::MonitoringLoop() {
   while (is_monitoring_) {
-    auto metrics = GetCurrentMetrics();
-    
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      metrics_history_.push_back(metrics);
-    }
-    
-    if (metrics_callback_) {
-      metrics_callback_(metrics);
-    }
-    
-    CheckAlertConditions(metrics);
-    
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      TrimHistory();
-    }
+    RecordMetrics(GetCurrentMetrics());
     
     // Sleep for interval
     std::this_thread::sleep_for(
@@ -312,6 +399,83 @@ void ServerMonitor::MonitoringLoop() {
   }
 }
 
+void ServerMonitor::RecordMetrics(const ServerPerformanceMetrics& metrics) {
+  {
+    // Older series points age out of the store on their own
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int64_t time_ms = ToMilliseconds(metrics.timestamp);
+    for (const auto& field : MetricFields()) {
+      metrics_history_.Append(field.name, time_ms, field.Get(metrics));
+    }
+  }
+  
+  if (metrics_callback_) {
+    metrics_callback_(metrics);
+  }
+  
+  CheckAlertConditions(metrics);
+}
+
+void ServerMonitor::OnSessionsSample(const MetricSample& sample) {
+  if (!sample.status.ok) {
+    return;
+  }
+  const ResultSet& result = *sample.result;
+  auto column = [&result](const char* name) {
+    for (std::size_t col = 0; col < result.ColumnCount(); ++col) {
+      if (result.columns[col] == name) return static_cast<int>(col);
+    }
+    return -1;
+  };
+  const int state = column("state");
+  const int wait = column("wait_event_type");
+
+  ServerPerformanceMetrics counts;
+  for (std::size_t row = 0; row < result.RowCount(); ++row) {
+    const std::string value = state >= 0 ? result.Column(state).Format(row) : std::string();
+    if (value == "active") {
+      ++counts.connections_active;
+    } else {
+      ++counts.connections_idle;
+    }
+    if (wait >= 0 && result.Column(wait).Format(row) == "Lock") {
+      ++counts.waiting_connections;
+      ++counts.blocked_queries;
+    }
+  }
+  counts.connections_total = static_cast<int64_t>(result.RowCount());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  sampled_sessions_ = counts;
+}
+
+void ServerMonitor::OnDatabaseSample(const MetricSample& sample) {
+  DatabaseActivity activity;
+  if (!DatabaseActivity::FromSample(sample, &activity)) {
+    return;
+  }
+  
+  ServerPerformanceMetrics metrics;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    metrics = sampled_sessions_;
+    const DatabaseActivity earlier = last_activity_;
+    const bool has_earlier = has_activity_;
+    last_activity_ = activity;
+    has_activity_ = true;
+    if (!has_earlier) {
+      return;  // Rates need two samples
+    }
+    const DatabaseRates rates = DatabaseRates::Between(earlier, activity);
+    metrics.transactions_per_sec = static_cast<int64_t>(rates.transactions_per_sec);
+    metrics.cache_hit_ratio = rates.cache_hit_ratio;
+    metrics.buffer_hits_per_sec = static_cast<int64_t>(rates.blocks_hit_per_sec);
+    metrics.buffer_reads_per_sec = static_cast<int64_t>(rates.blocks_read_per_sec);
+  }
+  metrics.timestamp = activity.taken_at;
+  RecordMetrics(metrics);
+}
+
 void ServerMonitor::CheckAlertConditions(const ServerPerformanceMetrics& metrics) {
   // Check CPU
   if (metrics.cpu_percent >= thresholds_.cpu_critical) {
@@ -441,22 +605,4 @@ void ServerMonitor::CheckAlertConditions(const ServerPerformanceMetrics& metrics
   }
 }
 
-void ServerMonitor::TrimHistory() {
-  // Trim metrics history
-  auto cutoff = std::chrono::system_clock::now() - 
-                std::chrono::hours(retention_hours_);
-  
-  metrics_history_.erase(
-      std::remove_if(metrics_history_.begin(), metrics_history_.end(),
-                     [&cutoff](const ServerPerformanceMetrics& m) {
-                       return m.timestamp < cutoff;
-                     }),
-      metrics_history_.end());
-  
-  // Limit data points
-  while (static_cast<int>(metrics_history_.size()) > max_data_points_) {
-    metrics_history_.erase(metrics_history_.begin());
-  }
-}
-
 }  // namespace scratchrobin::core
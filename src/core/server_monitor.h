@@ -10,13 +10,18 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 
+#include "core/metrics_sampler.h"
+#include "core/time_series.h"
+
 namespace scratchrobin::core {
 
 // ============================================================================
@@ -160,6 +165,8 @@ class ServerMonitor {
 
   // Performance monitoring
   ServerPerformanceMetrics GetCurrentMetrics();
+  // At the finest resolution still held for |from|, coarser if that would
+  // be more than the max data points; rollups carry bucket means
   std::vector<ServerPerformanceMetrics> GetMetricsHistory(
       const std::chrono::system_clock::time_point& from,
       const std::chrono::system_clock::time_point& to);
@@ -170,6 +177,9 @@ class ServerMonitor {
 
   // Real-time monitoring
   void StartMonitoring(int interval_seconds = 5);
+  // Takes the metrics from the sampler's server stat sources instead of a
+  // thread of our own, sharing their queries with every other subscriber
+  void StartMonitoring(std::shared_ptr<MetricsSampler> sampler, int interval_seconds = 5);
   void StopMonitoring();
   bool IsMonitoring() const { return is_monitoring_; }
 
@@ -224,13 +234,13 @@ class ServerMonitor {
   ServerMonitor(const ServerMonitor&) = delete;
   ServerMonitor& operator=(const ServerMonitor&) = delete;
 
-  bool is_monitoring_{false};
+  std::atomic<bool> is_monitoring_{false};
   int monitoring_interval_seconds_{5};
   int retention_hours_{24};
   int max_data_points_{10000};
 
   AlertThresholds thresholds_;
-  std::vector<ServerPerformanceMetrics> metrics_history_;
+  TimeSeriesStore metrics_history_;  // One series per metrics field
   std::vector<ServerAlert> alert_history_;
   int64_t next_alert_id_{1};
 
@@ -239,9 +249,17 @@ class ServerMonitor {
   
   mutable std::mutex mutex_;
 
+  std::shared_ptr<MetricsSampler> sampler_;
+  std::vector<uint64_t> subscriptions_;
+  ServerPerformanceMetrics sampled_sessions_;  // Connection counts of the last sample
+  DatabaseActivity last_activity_;
+  bool has_activity_{false};
+
   void MonitoringLoop();
+  void RecordMetrics(const ServerPerformanceMetrics& metrics);
+  void OnSessionsSample(const MetricSample& sample);
+  void OnDatabaseSample(const MetricSample& sample);
   void CheckAlertConditions(const ServerPerformanceMetrics& metrics);
-  void TrimHistory();
 };
 
 }  // namespace scratchrobin::core
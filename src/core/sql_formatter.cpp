@@ -14,7 +14,8 @@
 #include <cctype>
 #include <cstring>
 #include <fstream>
-#include <sstream>
+
+#include "core/scratchbird_dialect.h"
 
 namespace scratchrobin::core {
 
@@ -30,6 +31,9 @@ SqlFormatter& SqlFormatter::Instance() {
 SqlFormatter::SqlFormatter() {
   InitializeKeywords();
   InitializeFunctions();
+  keyword_table_ = std::make_unique<SqlKeywordTable>(keywords_);
+  function_table_ = std::make_unique<SqlKeywordTable>(functions_);
+  lexer_ = std::make_unique<SqlLexer>(*keyword_table_, *function_table_);
 }
 
 // ============================================================================
@@ -42,68 +46,69 @@ FormatResult SqlFormatter::Format(const std::string& sql) {
 
 FormatResult SqlFormatter::Format(const std::string& sql,
                                   const SqlFormatOptions& options) {
+  // Words that start a new line at the current indent
+  static const SqlKeywordTable clause_words({
+    "SELECT", "FROM", "WHERE", "GROUP", "ORDER", "HAVING", "JOIN", "LEFT", "RIGHT",
+    "INNER", "OUTER", "UNION", "INSERT", "UPDATE", "DELETE"
+  });
+
   FormatResult result;
   result.original_line_count = 1 + std::count(sql.begin(), sql.end(), '\n');
   
-  // Simple formatting implementation
-  std::vector<SqlElement> tokens = Tokenize(sql);
-  std::ostringstream formatted;
+  // Simple formatting implementation, one pass over the token views
+  arena_.Reset();
+  const SqlTokenList tokens = LexerFor(options.dialect).Lex(sql, arena_);
+  std::string& formatted = result.formatted_sql;
+  formatted.reserve(sql.size() + sql.size() / 4);
   
   int indent_level = 0;
-  bool new_line = false;
   
-  for (size_t i = 0; i < tokens.size(); ++i) {
-    const auto& token = tokens[i];
-    
-    if (token.type == SqlElementType::kWhitespace) {
+  for (const SqlToken& token : tokens) {
+    if (token.kind == SqlTokenKind::kWhitespace) {
       continue;  // Skip whitespace, we'll add our own
     }
+    const std::string_view value = token.Text(sql);
     
     // Handle keywords that change indentation
-    std::string upper_val = ToUpperCase(token.value);
-    
-    if (upper_val == "SELECT" || upper_val == "FROM" || upper_val == "WHERE" ||
-        upper_val == "GROUP" || upper_val == "ORDER" || upper_val == "HAVING" ||
-        upper_val == "JOIN" || upper_val == "LEFT" || upper_val == "RIGHT" ||
-        upper_val == "INNER" || upper_val == "OUTER" || upper_val == "UNION" ||
-        upper_val == "INSERT" || upper_val == "UPDATE" || upper_val == "DELETE") {
-      if (!formatted.str().empty() && formatted.str().back() != '\n') {
-        formatted << "\n";
+    if (token.IsWord() && clause_words.Contains(value)) {
+      if (!formatted.empty() && formatted.back() != '\n') {
+        formatted += '\n';
       }
-      formatted << MakeIndent(indent_level, options);
+      formatted += MakeIndent(indent_level, options);
     }
     
     // Add space before token if needed
-    if (!formatted.str().empty() && 
-        formatted.str().back() != '\n' && 
-        formatted.str().back() != '(' &&
-        token.value != "," && token.value != ")" && token.value != ";") {
-      formatted << " ";
+    if (!formatted.empty() && 
+        formatted.back() != '\n' && 
+        formatted.back() != '(' &&
+        value != "," && value != ")" && value != ";") {
+      formatted += ' ';
     }
     
     // Output the token with proper case
-    if (token.type == SqlElementType::kKeyword && options.uppercase_keywords) {
-      formatted << ToUpperCase(token.value);
-    } else if (token.type == SqlElementType::kFunction && options.uppercase_functions) {
-      formatted << ToUpperCase(token.value);
-    } else if (token.type == SqlElementType::kIdentifier && options.lowercase_identifiers) {
-      formatted << ToLowerCase(token.value);
-    } else {
-      formatted << token.value;
+    const std::size_t start = formatted.size();
+    formatted.append(value);
+    if ((token.kind == SqlTokenKind::kKeyword && options.uppercase_keywords) ||
+        (token.kind == SqlTokenKind::kFunction && options.uppercase_functions)) {
+      std::transform(formatted.begin() + start, formatted.end(), formatted.begin() + start,
+                     ::toupper);
+    } else if (token.kind == SqlTokenKind::kIdentifier && options.lowercase_identifiers) {
+      std::transform(formatted.begin() + start, formatted.end(), formatted.begin() + start,
+                     ::tolower);
     }
     
     // Handle indentation for parentheses
-    if (token.value == "(") {
+    if (value == "(") {
       indent_level++;
       if (options.newline_inside_parentheses) {
-        formatted << "\n" << MakeIndent(indent_level, options);
+        formatted += '\n';
+        formatted += MakeIndent(indent_level, options);
       }
-    } else if (token.value == ")") {
+    } else if (value == ")") {
       indent_level = std::max(0, indent_level - 1);
     }
   }
   
-  result.formatted_sql = formatted.str();
   result.formatted_line_count = 1 + std::count(
       result.formatted_sql.begin(), result.formatted_sql.end(), '\n');
   result.success = true;
@@ -121,31 +126,35 @@ std::string SqlFormatter::FormatQuick(const std::string& sql) {
 // ============================================================================
 
 std::string SqlFormatter::Minify(const std::string& sql) {
-  std::vector<SqlElement> tokens = Tokenize(sql);
-  std::ostringstream minified;
+  arena_.Reset();
+  const SqlTokenList tokens = lexer_->Lex(sql, arena_);
+  std::string minified;
+  minified.reserve(sql.size());
   
-  SqlElementType prev_type = SqlElementType::kUnknown;
+  // Tokens that would run together without a space between them
+  auto joins = [](const SqlToken& token) {
+    return token.IsWord() || token.kind == SqlTokenKind::kNumber;
+  };
+  const SqlToken* prev = nullptr;
   
-  for (const auto& token : tokens) {
-    if (token.type == SqlElementType::kWhitespace ||
-        token.type == SqlElementType::kComment) {
+  for (const SqlToken& token : tokens) {
+    if (token.kind == SqlTokenKind::kWhitespace ||
+        token.kind == SqlTokenKind::kComment) {
       continue;
     }
     
-    // Add space between identifiers and keywords
-    if (prev_type == SqlElementType::kIdentifier ||
-        prev_type == SqlElementType::kKeyword) {
-      if (token.type == SqlElementType::kIdentifier ||
-          token.type == SqlElementType::kKeyword) {
-        minified << " ";
-      }
+    // Add space between words and numbers, and between operators ('- -1')
+    if (prev && ((joins(*prev) && joins(token)) ||
+                 (prev->kind == SqlTokenKind::kOperator &&
+                  token.kind == SqlTokenKind::kOperator))) {
+      minified += ' ';
     }
     
-    minified << token.value;
-    prev_type = token.type;
+    minified.append(token.Text(sql));
+    prev = &token;
   }
   
-  return minified.str();
+  return minified;
 }
 
 // ============================================================================
@@ -154,14 +163,18 @@ std::string SqlFormatter::Minify(const std::string& sql) {
 
 bool SqlFormatter::ValidateSyntax(const std::string& sql) {
   // Simplified validation - would need a proper parser
-  auto tokens = Tokenize(sql);
+  arena_.Reset();
+  const SqlTokenList tokens = lexer_->Lex(sql, arena_);
   
   // Check for basic structure
   int paren_depth = 0;
-  for (const auto& token : tokens) {
-    if (token.value == "(") {
+  for (const SqlToken& token : tokens) {
+    if (token.kind != SqlTokenKind::kPunctuation) {
+      continue;
+    }
+    if (sql[token.offset] == '(') {
       paren_depth++;
-    } else if (token.value == ")") {
+    } else if (sql[token.offset] == ')') {
       paren_depth--;
       if (paren_depth < 0) {
         last_error_ = "Unmatched closing parenthesis";
@@ -184,123 +197,38 @@ bool SqlFormatter::ValidateSyntax(const std::string& sql) {
 
 std::vector<SqlElement> SqlFormatter::Tokenize(const std::string& sql) {
   std::vector<SqlElement> tokens;
-  size_t i = 0;
   int line = 1;
   int col = 1;
   
-  while (i < sql.length()) {
+  arena_.Reset();
+  for (const SqlToken& token : lexer_->Lex(sql, arena_)) {
     SqlElement element;
     element.line = line;
     element.column = col;
-    
-    // Skip whitespace but record it
-    if (std::isspace(static_cast<unsigned char>(sql[i]))) {
-      while (i < sql.length() && std::isspace(static_cast<unsigned char>(sql[i]))) {
-        if (sql[i] == '\n') {
-          line++;
-          col = 1;
-        } else {
-          col++;
-        }
-        element.value += sql[i++];
-      }
-      element.type = SqlElementType::kWhitespace;
-      tokens.push_back(element);
-      continue;
+    element.value = sql.substr(token.offset, token.length);
+    switch (token.kind) {
+      case SqlTokenKind::kWhitespace: element.type = SqlElementType::kWhitespace; break;
+      case SqlTokenKind::kKeyword: element.type = SqlElementType::kKeyword; break;
+      case SqlTokenKind::kFunction: element.type = SqlElementType::kFunction; break;
+      case SqlTokenKind::kIdentifier: element.type = SqlElementType::kIdentifier; break;
+      // Kept verbatim like literals; identifier case rules do not apply
+      case SqlTokenKind::kQuotedIdentifier:
+      case SqlTokenKind::kString: element.type = SqlElementType::kStringLiteral; break;
+      case SqlTokenKind::kNumber: element.type = SqlElementType::kNumericLiteral; break;
+      case SqlTokenKind::kComment: element.type = SqlElementType::kComment; break;
+      case SqlTokenKind::kOperator: element.type = SqlElementType::kOperator; break;
+      case SqlTokenKind::kPunctuation: element.type = SqlElementType::kPunctuation; break;
+      case SqlTokenKind::kUnknown: element.type = SqlElementType::kUnknown; break;
     }
-    
-    // String literal
-    if (sql[i] == '\'' || sql[i] == '"') {
-      char quote = sql[i];
-      element.value += sql[i++];
-      col++;
-      while (i < sql.length() && sql[i] != quote) {
-        if (sql[i] == '\\' && i + 1 < sql.length()) {
-          element.value += sql[i++];
-          col++;
-        }
-        element.value += sql[i++];
-        col++;
-      }
-      if (i < sql.length()) {
-        element.value += sql[i++];
-        col++;
-      }
-      element.type = SqlElementType::kStringLiteral;
-      tokens.push_back(element);
-      continue;
-    }
-    
-    // Single-line comment
-    if (sql[i] == '-' && i + 1 < sql.length() && sql[i + 1] == '-') {
-      while (i < sql.length() && sql[i] != '\n') {
-        element.value += sql[i++];
-        col++;
-      }
-      element.type = SqlElementType::kComment;
-      tokens.push_back(element);
-      continue;
-    }
-    
-    // Multi-line comment
-    if (sql[i] == '/' && i + 1 < sql.length() && sql[i + 1] == '*') {
-      element.value += sql[i++];
-      element.value += sql[i++];
-      col += 2;
-      while (i + 1 < sql.length() && !(sql[i] == '*' && sql[i + 1] == '/')) {
-        if (sql[i] == '\n') {
-          line++;
-          col = 1;
-        } else {
-          col++;
-        }
-        element.value += sql[i++];
-      }
-      if (i + 1 < sql.length()) {
-        element.value += sql[i++];
-        element.value += sql[i++];
-        col += 2;
-      }
-      element.type = SqlElementType::kComment;
-      tokens.push_back(element);
-      continue;
-    }
-    
-    // Punctuation
-    if (std::strchr("(),;.*=<>!+-/*", sql[i])) {
-      element.value = sql[i++];
-      element.type = SqlElementType::kPunctuation;
-      tokens.push_back(element);
-      col++;
-      continue;
-    }
-    
-    // Identifier or keyword or number
-    if (std::isalnum(static_cast<unsigned char>(sql[i])) || sql[i] == '_') {
-      while (i < sql.length() &&
-             (std::isalnum(static_cast<unsigned char>(sql[i])) || sql[i] == '_')) {
-        element.value += sql[i++];
-        col++;
-      }
-      
-      // Check if it's a keyword
-      std::string upper = ToUpperCase(element.value);
-      if (IsKeyword(upper)) {
-        element.type = SqlElementType::kKeyword;
-      } else if (IsFunction(upper)) {
-        element.type = SqlElementType::kFunction;
-      } else if (std::isdigit(static_cast<unsigned char>(element.value[0]))) {
-        element.type = SqlElementType::kNumericLiteral;
+    for (char c : element.value) {
+      if (c == '\n') {
+        line++;
+        col = 1;
       } else {
-        element.type = SqlElementType::kIdentifier;
+        col++;
       }
-      tokens.push_back(element);
-      continue;
     }
-    
-    // Unknown character, skip
-    i++;
-    col++;
+    tokens.push_back(std::move(element));
   }
   
   return tokens;
@@ -311,22 +239,23 @@ std::vector<SqlElement> SqlFormatter::Tokenize(const std::string& sql) {
 // ============================================================================
 
 std::string SqlFormatter::Normalize(const std::string& sql) {
-  auto tokens = Tokenize(sql);
-  std::ostringstream normalized;
+  arena_.Reset();
+  const SqlTokenList tokens = lexer_->Lex(sql, arena_);
+  std::string normalized;
+  normalized.reserve(sql.size());
   
-  for (const auto& token : tokens) {
-    if (token.type == SqlElementType::kWhitespace) {
-      normalized << " ";
+  for (const SqlToken& token : tokens) {
+    if (token.kind == SqlTokenKind::kWhitespace) {
+      normalized += ' ';
       continue;
     }
-    if (token.type == SqlElementType::kKeyword) {
-      normalized << ToUpperCase(token.value);
-    } else {
-      normalized << ToLowerCase(token.value);
-    }
+    const std::size_t start = normalized.size();
+    normalized.append(token.Text(sql));
+    std::transform(normalized.begin() + start, normalized.end(), normalized.begin() + start,
+                   token.kind == SqlTokenKind::kKeyword ? ::toupper : ::tolower);
   }
   
-  return normalized.str();
+  return normalized;
 }
 
 // ============================================================================
@@ -335,36 +264,28 @@ std::string SqlFormatter::Normalize(const std::string& sql) {
 
 std::vector<std::string> SqlFormatter::SplitStatements(const std::string& sql) {
   std::vector<std::string> statements;
-  std::ostringstream current;
   
-  auto tokens = Tokenize(sql);
-  for (const auto& token : tokens) {
-    if (token.value == ";") {
-      std::string stmt = current.str();
-      // Trim whitespace
-      size_t start = stmt.find_first_not_of(" \t\n\r");
-      if (start != std::string::npos) {
-        size_t end = stmt.find_last_not_of(" \t\n\r");
-        statements.push_back(stmt.substr(start, end - start + 1));
-      }
-      current.str("");
-    } else {
-      if (token.type != SqlElementType::kWhitespace) {
-        if (!current.str().empty()) {
-          current << " ";
-        }
-      }
-      current << token.value;
+  // Statements are the source text between ';' tokens, trimmed
+  auto add = [&](std::size_t begin, std::size_t end) {
+    const std::string_view stmt = std::string_view(sql).substr(begin, end - begin);
+    size_t start = stmt.find_first_not_of(" \t\n\r");
+    if (start != std::string_view::npos) {
+      size_t last = stmt.find_last_not_of(" \t\n\r");
+      statements.emplace_back(stmt.substr(start, last - start + 1));
+    }
+  };
+  
+  arena_.Reset();
+  std::size_t begin = 0;
+  for (const SqlToken& token : lexer_->Lex(sql, arena_)) {
+    if (token.kind == SqlTokenKind::kPunctuation && sql[token.offset] == ';') {
+      add(begin, token.offset);
+      begin = token.offset + 1;
     }
   }
   
   // Don't forget the last statement if it doesn't end with ;
-  std::string stmt = current.str();
-  size_t start = stmt.find_first_not_of(" \t\n\r");
-  if (start != std::string::npos) {
-    size_t end = stmt.find_last_not_of(" \t\n\r");
-    statements.push_back(stmt.substr(start, end - start + 1));
-  }
+  add(begin, sql.size());
   
   return statements;
 }
@@ -431,13 +352,11 @@ void SqlFormatter::DeletePreset(const std::string& preset_name) {
 // ============================================================================
 
 bool SqlFormatter::IsKeyword(const std::string& word) {
-  std::string upper = ToUpperCase(word);
-  return std::find(keywords_.begin(), keywords_.end(), upper) != keywords_.end();
+  return keyword_table_->Contains(word);
 }
 
 bool SqlFormatter::IsFunction(const std::string& word) {
-  std::string upper = ToUpperCase(word);
-  return std::find(functions_.begin(), functions_.end(), upper) != functions_.end();
+  return function_table_->Contains(word);
 }
 
 bool SqlFormatter::IsReservedWord(const std::string& word) {
@@ -448,6 +367,23 @@ bool SqlFormatter::IsReservedWord(const std::string& word) {
 // Dialect-Specific Formatting
 // ============================================================================
 
+const SqlLexer& SqlFormatter::LexerFor(const std::string& dialect) {
+  if (!DialectRegistry::Instance().HasDialect(dialect)) {
+    return *lexer_;
+  }
+  auto& lexer = dialect_lexers_[dialect];
+  if (!lexer) {
+    // Our keywords plus the dialect's reserved words
+    std::vector<std::string> words = keywords_;
+    const auto reserved = DialectRegistry::Instance().GetDialect(dialect)->BuildKeywordTable();
+    for (std::string& word : reserved.Words()) {
+      words.push_back(std::move(word));
+    }
+    lexer = std::make_unique<DialectLexer>(SqlKeywordTable(words), *function_table_);
+  }
+  return lexer->lexer;
+}
+
 std::string SqlFormatter::FormatForDialect(const std::string& sql,
                                            const std::string& dialect) {
   SqlFormatOptions options = default_options_;
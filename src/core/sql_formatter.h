@@ -10,9 +10,14 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "core/sql_lexer.h"
+
 namespace scratchrobin::core {
 
 // ============================================================================
@@ -166,6 +171,20 @@ class SqlFormatter {
 
   std::vector<std::string> keywords_;
   std::vector<std::string> functions_;
+  std::unique_ptr<SqlKeywordTable> keyword_table_;
+  std::unique_ptr<SqlKeywordTable> function_table_;
+  std::unique_ptr<SqlLexer> lexer_;
+  SqlTokenArena arena_;  // Token lists of the current call
+
+  // Lexer whose keywords include a registered dialect's reserved words
+  struct DialectLexer {
+    DialectLexer(SqlKeywordTable table, const SqlKeywordTable& functions)
+        : keywords(std::move(table)), lexer(keywords, functions) {}
+    SqlKeywordTable keywords;
+    SqlLexer lexer;
+  };
+  std::unordered_map<std::string, std::unique_ptr<DialectLexer>> dialect_lexers_;
+  const SqlLexer& LexerFor(const std::string& dialect);
 
   std::string FormatElement(const SqlElement& element,
                             const SqlFormatOptions& options);
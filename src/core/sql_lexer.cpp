@@ -0,0 +1,394 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/sql_lexer.h"
+
+#include <algorithm>
+
+namespace scratchrobin::core {
+
+namespace {
+
+char Upper(char c) {
+  return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+bool IsIdentStart(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+         static_cast<unsigned char>(c) >= 0x80;
+}
+
+bool IsIdentChar(char c) {
+  return IsIdentStart(c) || IsDigit(c) || c == '$';
+}
+
+// End of a quoted run starting at |pos|, just past the closing |quote|, or
+// npos when the text ends first. A doubled quote is an escaped quote.
+std::size_t FindClosingQuote(std::string_view text, std::size_t pos, char quote) {
+  while (true) {
+    pos = text.find(quote, pos);
+    if (pos == std::string_view::npos) {
+      return pos;
+    }
+    if (pos + 1 < text.size() && text[pos + 1] == quote) {
+      pos += 2;
+      continue;
+    }
+    return pos + 1;
+  }
+}
+
+const std::vector<std::string>& KeywordList() {
+  static const std::vector<std::string> words = {
+      "ADD", "ALL", "ALTER", "AND", "ANY", "AS", "ASC", "BEGIN", "BETWEEN", "BIGINT",
+      "BINARY", "BLOB", "BOOLEAN", "BY", "CASCADE", "CASE", "CHAR", "CHECK", "CLOB",
+      "COLUMN", "COMMIT", "CONSTRAINT", "CREATE", "CROSS", "DATABASE", "DECIMAL",
+      "DECLARE", "DEFAULT", "DELETE", "DESC", "DISTINCT", "DOMAIN", "DOUBLE", "DROP",
+      "ELSE", "END", "EXCEPT", "EXECUTE", "EXISTS", "FALSE", "FETCH", "FIRST", "FLOAT",
+      "FOR", "FOREIGN", "FROM", "FULL", "FUNCTION", "GENERATOR", "GRANT", "GROUP",
+      "HAVING", "IDENTITY", "IF", "IN", "INDEX", "INNER", "INSERT", "INT", "INTEGER",
+      "INTERSECT", "INTERVAL", "INTO", "IS", "JOIN", "JSON", "KEY", "LAST", "LEFT",
+      "LIKE", "LIMIT", "NATURAL", "NOT", "NULL", "NULLS", "NUMERIC", "OFFSET", "ON",
+      "OR", "ORDER", "OUTER", "OVER", "PARTITION", "PRIMARY", "PROCEDURE", "REAL",
+      "REFERENCES", "RELEASE", "RETURN", "RETURNING", "RETURNS", "REVOKE", "RIGHT",
+      "ROLLBACK", "ROWS", "SAVEPOINT", "SCHEMA", "SELECT", "SEQUENCE", "SET", "SIMILAR",
+      "SMALLINT", "TABLE", "TEXT", "THEN", "TIMESTAMP", "TO", "TRANSACTION", "TRIGGER",
+      "TRUE", "TRUNCATE", "UNION", "UNIQUE", "UPDATE", "USING", "UUID", "VALUES",
+      "VARBINARY", "VARCHAR", "VIEW", "WHEN", "WHERE", "WHILE", "WINDOW", "WITH",
+  };
+  return words;
+}
+
+const std::vector<std::string>& FunctionList() {
+  static const std::vector<std::string> words = {
+      "ABS", "AGE", "ARRAY_AGG", "AVG", "CAST", "CEIL", "CEILING", "CHAR_LENGTH",
+      "COALESCE", "CONCAT", "CONVERT", "COUNT", "CURRENT_DATE", "CURRENT_TIME",
+      "CURRENT_TIMESTAMP", "DATE", "DATE_PART", "DATE_TRUNC", "DAY", "DENSE_RANK",
+      "EXP", "EXTRACT", "FIRST_VALUE", "FLOOR", "GREATEST", "IFNULL", "INITCAP",
+      "JSON_AGG", "LAG", "LAST_VALUE", "LEAD", "LEAST", "LEFT", "LENGTH", "LN", "LOG",
+      "LOWER", "LPAD", "LTRIM", "MAX", "MIN", "MOD", "MONTH", "NOW", "NULLIF", "NVL",
+      "PI", "POSITION", "POWER", "RANDOM", "RANK", "REPLACE", "RIGHT", "ROUND",
+      "ROW_NUMBER", "RPAD", "RTRIM", "SIGN", "SQRT", "STRING_AGG", "SUBSTR",
+      "SUBSTRING", "SUM", "TIME", "TO_CHAR", "TO_DATE", "TO_NUMBER", "TO_TIMESTAMP",
+      "TRANSLATE", "TRIM", "TRUNC", "UPPER", "YEAR",
+  };
+  return words;
+}
+
+}  // namespace
+
+bool SqlToken::Is(std::string_view source, std::string_view word) const {
+  if (length != word.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < length; ++i) {
+    if (Upper(source[offset + i]) != word[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ============================================================================
+// SqlKeywordTable
+// ============================================================================
+
+SqlKeywordTable::SqlKeywordTable(const std::vector<std::string>& words) {
+  std::vector<std::string> upper;
+  upper.reserve(words.size());
+  for (const auto& word : words) {
+    std::string key(word);
+    std::transform(key.begin(), key.end(), key.begin(), Upper);
+    upper.push_back(std::move(key));
+  }
+  std::sort(upper.begin(), upper.end());
+  upper.erase(std::unique(upper.begin(), upper.end()), upper.end());
+  count_ = upper.size();
+  for (const auto& word : upper) {
+    max_length_ = std::max(max_length_, word.size());
+  }
+
+  // Twice as many slots as words keeps the seed search short; if no seed
+  // in the budget works, the table doubles and the search starts again.
+  std::size_t size = 8;
+  while (size < upper.size() * 2) {
+    size *= 2;
+  }
+  while (true) {
+    mask_ = static_cast<std::uint32_t>(size - 1);
+    for (std::uint32_t seed = 1; seed <= 4096; ++seed) {
+      slots_.assign(size, std::string());
+      bool collided = false;
+      for (const auto& word : upper) {
+        std::string& slot = slots_[Hash(word, seed) & mask_];
+        if (!slot.empty()) {
+          collided = true;
+          break;
+        }
+        slot = word;
+      }
+      if (!collided) {
+        seed_ = seed;
+        return;
+      }
+    }
+    size *= 2;
+  }
+}
+
+// FNV-1a over the upper-cased bytes, seeded
+std::uint32_t SqlKeywordTable::Hash(std::string_view word, std::uint32_t seed) {
+  std::uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+  for (char c : word) {
+    hash ^= static_cast<unsigned char>(Upper(c));
+    hash *= 16777619u;
+  }
+  return hash ^ (hash >> 15);
+}
+
+bool SqlKeywordTable::Contains(std::string_view word) const {
+  if (word.empty() || word.size() > max_length_) {
+    return false;
+  }
+  const std::string& slot = slots_[Hash(word, seed_) & mask_];
+  if (slot.size() != word.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < word.size(); ++i) {
+    if (Upper(word[i]) != slot[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<std::string> SqlKeywordTable::Words() const {
+  std::vector<std::string> words;
+  words.reserve(count_);
+  for (const auto& slot : slots_) {
+    if (!slot.empty()) {
+      words.push_back(slot);
+    }
+  }
+  return words;
+}
+
+const SqlKeywordTable& SqlKeywordTable::DefaultKeywords() {
+  static const SqlKeywordTable table(KeywordList());
+  return table;
+}
+
+const SqlKeywordTable& SqlKeywordTable::DefaultFunctions() {
+  static const SqlKeywordTable table(FunctionList());
+  return table;
+}
+
+// ============================================================================
+// SqlLexer
+// ============================================================================
+
+SqlLexer::SqlLexer()
+    : SqlLexer(SqlKeywordTable::DefaultKeywords(), SqlKeywordTable::DefaultFunctions()) {}
+
+SqlLexer::SqlLexer(const SqlKeywordTable& keywords, const SqlKeywordTable& functions)
+    : keywords_(&keywords), functions_(&functions) {}
+
+std::vector<SqlToken> SqlLexer::Lex(std::string_view text) const {
+  std::vector<SqlToken> tokens;
+  Lex(text, SqlLexState::kNormal, &tokens);
+  return tokens;
+}
+
+SqlLexState SqlLexer::Lex(std::string_view text, SqlLexState state,
+                          std::vector<SqlToken>* tokens) const {
+  SqlToken token;
+  for (std::size_t pos = 0; pos < text.size(); pos += token.length) {
+    state = Next(text, pos, state, &token);
+    tokens->push_back(token);
+  }
+  return state;
+}
+
+SqlTokenList SqlLexer::Lex(std::string_view text, SqlTokenArena& arena) const {
+  // A monotonic arena never reuses what a growing vector leaves behind, so
+  // lex into a per-thread scratch list and copy it over at its final size
+  thread_local std::vector<SqlToken> scratch;
+  scratch.clear();
+  Lex(text, SqlLexState::kNormal, &scratch);
+  return SqlTokenList(scratch.begin(), scratch.end(), arena.resource());
+}
+
+SqlLexState SqlLexer::Next(std::string_view text, std::size_t pos, SqlLexState state,
+                           SqlToken* token) const {
+  const std::size_t size = text.size();
+  token->offset = pos;
+  auto emit = [&](SqlTokenKind kind, std::size_t end) {
+    token->kind = kind;
+    token->length = end - pos;
+    return SqlLexState::kNormal;
+  };
+  // Finishes a comment, string or quoted identifier; leaves it open when
+  // the text ends first
+  auto close = [&](SqlTokenKind kind, SqlLexState open_state, std::size_t end) {
+    if (end == std::string_view::npos) {
+      emit(kind, size);
+      return open_state;
+    }
+    return emit(kind, end);
+  };
+  auto block_comment_end = [&](std::size_t from) {
+    const std::size_t end = text.find("*/", from);
+    return end == std::string_view::npos ? end : end + 2;
+  };
+
+  // Resume whatever the previous text left open
+  switch (state) {
+    case SqlLexState::kBlockComment:
+      return close(SqlTokenKind::kComment, state, block_comment_end(pos));
+    case SqlLexState::kString:
+      return close(SqlTokenKind::kString, state, FindClosingQuote(text, pos, '\''));
+    case SqlLexState::kQuotedIdentifier:
+      return close(SqlTokenKind::kQuotedIdentifier, state, FindClosingQuote(text, pos, '"'));
+    case SqlLexState::kNormal:
+      break;
+  }
+
+  const char c = text[pos];
+  const char next = pos + 1 < size ? text[pos + 1] : '\0';
+  std::size_t end = pos + 1;
+
+  if (IsSpace(c)) {
+    while (end < size && IsSpace(text[end])) ++end;
+    return emit(SqlTokenKind::kWhitespace, end);
+  }
+  if (c == '-' && next == '-') {
+    end = text.find('\n', pos);
+    return emit(SqlTokenKind::kComment, end == std::string_view::npos ? size : end);
+  }
+  if (c == '/' && next == '*') {
+    return close(SqlTokenKind::kComment, SqlLexState::kBlockComment, block_comment_end(pos + 2));
+  }
+  if (c == '\'') {
+    return close(SqlTokenKind::kString, SqlLexState::kString, FindClosingQuote(text, pos + 1, '\''));
+  }
+  if (c == '"') {
+    return close(SqlTokenKind::kQuotedIdentifier, SqlLexState::kQuotedIdentifier,
+                 FindClosingQuote(text, pos + 1, '"'));
+  }
+  if (IsDigit(c) || (c == '.' && IsDigit(next))) {
+    bool dot = c == '.';
+    while (end < size && (IsDigit(text[end]) || (text[end] == '.' && !dot))) {
+      dot = dot || text[end] == '.';
+      ++end;
+    }
+    if (end < size && (text[end] == 'e' || text[end] == 'E')) {
+      std::size_t exponent = end + 1;
+      if (exponent < size && (text[exponent] == '+' || text[exponent] == '-')) ++exponent;
+      if (exponent < size && IsDigit(text[exponent])) {
+        end = exponent;
+        while (end < size && IsDigit(text[end])) ++end;
+      }
+    }
+    return emit(SqlTokenKind::kNumber, end);
+  }
+  if (IsIdentStart(c)) {
+    while (end < size && IsIdentChar(text[end])) ++end;
+    const std::string_view word = text.substr(pos, end - pos);
+    if (functions_->Contains(word)) {
+      std::size_t after = end;
+      while (after < size && IsSpace(text[after])) ++after;
+      if (after < size && text[after] == '(') {
+        return emit(SqlTokenKind::kFunction, end);
+      }
+    }
+    return emit(keywords_->Contains(word) ? SqlTokenKind::kKeyword : SqlTokenKind::kIdentifier,
+                end);
+  }
+  switch (c) {
+    case '(': case ')': case ',': case ';': case '.':
+    case '[': case ']': case '{': case '}':
+      return emit(SqlTokenKind::kPunctuation, end);
+    default:
+      break;
+  }
+  if ((c == '<' && (next == '=' || next == '>')) || (c == '>' && next == '=') ||
+      (c == '!' && next == '=') || (c == '|' && next == '|') || (c == ':' && next == ':') ||
+      (c == '-' && next == '>') || (c == '=' && next == '>')) {
+    return emit(SqlTokenKind::kOperator, pos + 2);
+  }
+  switch (c) {
+    case '+': case '-': case '*': case '/': case '%': case '=': case '<': case '>':
+    case '!': case '|': case '&': case '^': case '~': case ':': case '#':
+      return emit(SqlTokenKind::kOperator, end);
+    default:
+      return emit(SqlTokenKind::kUnknown, end);
+  }
+}
+
+std::size_t SqlLexer::Relex(std::string_view text, std::size_t offset, std::size_t removed,
+                            std::size_t inserted, std::vector<SqlToken>* tokens) const {
+  auto& old = *tokens;
+  auto starts_after = [](std::size_t pos, const SqlToken& token) { return pos < token.offset; };
+
+  // Restart two tokens before the one holding the byte before the edit:
+  // the edit may extend that token, and a token's kind or length can
+  // depend on the next two ('count (' is a call, '1e+5' one number)
+  std::size_t first = 0;
+  if (offset > 0 && !old.empty()) {
+    first = static_cast<std::size_t>(
+                std::upper_bound(old.begin(), old.end(), offset - 1, starts_after) - old.begin()) -
+            1;
+    first = first > 2 ? first - 2 : 0;
+  }
+  const std::size_t start = first < old.size() ? old[first].offset : 0;
+
+  // Old tokens at or past the end of the replaced bytes can be kept once
+  // lexing lands on one of their starts
+  const std::size_t old_end = offset + removed;
+  const std::size_t new_end = offset + inserted;
+  std::size_t keep = static_cast<std::size_t>(
+      std::lower_bound(old.begin() + static_cast<std::ptrdiff_t>(first), old.end(), old_end,
+                       [](const SqlToken& token, std::size_t pos) { return token.offset < pos; }) -
+      old.begin());
+  auto shifted = [&](std::size_t index) { return old[index].offset - removed + inserted; };
+
+  std::vector<SqlToken> fresh;
+  SqlLexState state = SqlLexState::kNormal;
+  SqlToken token;
+  bool synced = false;
+  for (std::size_t pos = start; pos < text.size(); pos += token.length) {
+    if (pos >= new_end && state == SqlLexState::kNormal) {
+      while (keep < old.size() && shifted(keep) < pos) ++keep;
+      synced = keep < old.size() && shifted(keep) == pos;
+      if (synced) {
+        break;
+      }
+    }
+    state = Next(text, pos, state, &token);
+    fresh.push_back(token);
+  }
+  if (!synced) {
+    keep = old.size();  // Lexed to the end; nothing to keep
+  }
+
+  for (std::size_t i = keep; i < old.size(); ++i) {
+    old[i].offset = shifted(i);
+  }
+  old.erase(old.begin() + static_cast<std::ptrdiff_t>(first),
+            old.begin() + static_cast<std::ptrdiff_t>(keep));
+  old.insert(old.begin() + static_cast<std::ptrdiff_t>(first), fresh.begin(), fresh.end());
+  return first;
+}
+
+}  // namespace scratchrobin::core
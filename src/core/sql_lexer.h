@@ -0,0 +1,153 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace scratchrobin::core {
+
+enum class SqlTokenKind : std::uint8_t {
+  kWhitespace,
+  kKeyword,
+  kFunction,          // Known function name followed by '('
+  kIdentifier,
+  kQuotedIdentifier,  // "name"
+  kString,            // 'text'
+  kNumber,
+  kComment,
+  kOperator,
+  kPunctuation,       // ( ) , ; . [ ] { }
+  kUnknown,
+};
+
+// Where the lexer stands at the end of its input, so lexing can resume on
+// the next piece, e.g. the next line of an editor document.
+enum class SqlLexState : std::uint8_t {
+  kNormal,
+  kBlockComment,
+  kString,
+  kQuotedIdentifier,
+};
+
+// A token is a view of the lexed text by position, so token lists hold no
+// copies and survive edits elsewhere in the text (see SqlLexer::Relex()).
+struct SqlToken {
+  SqlTokenKind kind = SqlTokenKind::kUnknown;
+  std::size_t offset = 0;  // Into the lexed text
+  std::size_t length = 0;
+
+  std::string_view Text(std::string_view source) const { return source.substr(offset, length); }
+  bool IsWord() const {
+    return kind == SqlTokenKind::kKeyword || kind == SqlTokenKind::kFunction ||
+           kind == SqlTokenKind::kIdentifier;
+  }
+  // Case-insensitive compare against an upper-case |word|
+  bool Is(std::string_view source, std::string_view word) const;
+};
+
+/**
+ * SqlTokenArena - bump allocator for token lists
+ *
+ * Lists lexed into an arena are freed together by Reset(). The arena owns
+ * its first block and keeps it across resets, so a long-lived arena lexes
+ * statements of up to ~1300 tokens without touching the heap, and larger
+ * scripts allocate a handful of growing blocks rather than once per list.
+ */
+class SqlTokenArena {
+ public:
+  explicit SqlTokenArena(std::size_t initial_bytes = 32 * 1024)
+      : buffer_(new std::byte[initial_bytes]), resource_(buffer_.get(), initial_bytes) {}
+  SqlTokenArena(const SqlTokenArena&) = delete;
+  SqlTokenArena& operator=(const SqlTokenArena&) = delete;
+
+  std::pmr::memory_resource* resource() { return &resource_; }
+  // Invalidates every list allocated from the arena.
+  void Reset() { resource_.release(); }
+
+ private:
+  std::unique_ptr<std::byte[]> buffer_;
+  std::pmr::monotonic_buffer_resource resource_;
+};
+
+using SqlTokenList = std::pmr::vector<SqlToken>;
+
+/**
+ * SqlKeywordTable - case-insensitive word set with a perfect hash
+ *
+ * The constructor searches for a hash seed under which every word lands
+ * in its own slot, so Contains() hashes once and compares against one
+ * word. Dialects build their own tables (Dialect::BuildKeywordTable()).
+ */
+class SqlKeywordTable {
+ public:
+  explicit SqlKeywordTable(const std::vector<std::string>& words);
+
+  bool Contains(std::string_view word) const;
+  std::size_t size() const { return count_; }
+  std::vector<std::string> Words() const;  // Upper-case, unordered
+
+  static const SqlKeywordTable& DefaultKeywords();
+  static const SqlKeywordTable& DefaultFunctions();
+
+ private:
+  static std::uint32_t Hash(std::string_view word, std::uint32_t seed);
+
+  std::vector<std::string> slots_;  // Upper-case; empty when unused
+  std::uint32_t seed_ = 0;
+  std::uint32_t mask_ = 0;
+  std::size_t count_ = 0;
+  std::size_t max_length_ = 0;
+};
+
+/**
+ * SqlLexer - single-pass SQL tokenizer
+ *
+ * A state machine over the bytes of the input: every byte belongs to
+ * exactly one token, so the tokens tile the text. Block comments, strings
+ * and quoted identifiers may be left open at the end of the input; the
+ * returned state lets the next call continue them. Bytes >= 0x80 are
+ * identifier characters, which covers UTF-8 names and callers that map
+ * wide characters to one byte each.
+ */
+class SqlLexer {
+ public:
+  SqlLexer();
+  SqlLexer(const SqlKeywordTable& keywords, const SqlKeywordTable& functions);
+
+  // Appends the tokens of |text|, lexed starting in |state|, to |tokens|
+  // and returns the state at its end.
+  SqlLexState Lex(std::string_view text, SqlLexState state, std::vector<SqlToken>* tokens) const;
+  std::vector<SqlToken> Lex(std::string_view text) const;
+  SqlTokenList Lex(std::string_view text, SqlTokenArena& arena) const;
+
+  // Lexes the one token starting at |pos| (< text.size()) in |state| into
+  // |token| and returns the state after it. For callers that only need
+  // the first few tokens of a long statement.
+  SqlLexState Next(std::string_view text, std::size_t pos, SqlLexState state,
+                   SqlToken* token) const;
+
+  // Updates |tokens|, the tokens of a text lexed from kNormal, after the
+  // |removed| bytes at |offset| were replaced by |inserted| bytes; |text|
+  // is the edited text. Lexing restarts a few tokens before the edit and
+  // stops as soon as it reaches the start of an old token past the edit,
+  // whose tokens are kept with shifted offsets. Returns the index of the
+  // first replaced token.
+  std::size_t Relex(std::string_view text, std::size_t offset, std::size_t removed,
+                    std::size_t inserted, std::vector<SqlToken>* tokens) const;
+
+ private:
+  const SqlKeywordTable* keywords_;
+  const SqlKeywordTable* functions_;
+};
+
+}  // namespace scratchrobin::core
@@ -6,9 +6,12 @@
  */
 #include "core/sql_utils.h"
 
+#include <algorithm>
 #include <cctype>
 #include <sstream>
 
+#include "core/result_set.h"
+
 namespace scratchrobin::core {
 
 std::string escapeIdentifier(std::string_view identifier) {
@@ -133,4 +136,110 @@ std::string qualifiedTableName(std::string_view schema, std::string_view table)
   return escapeIdentifier(schema) + "." + escapeIdentifier(table);
 }
 
+std::string normalizeStatementText(std::string_view sql) {
+  std::string result;
+  result.reserve(sql.size());
+  bool pending_space = false;
+  
+  for (size_t i = 0; i < sql.size(); ++i) {
+    const char c = sql[i];
+    const char next = (i + 1 < sql.size()) ? sql[i + 1] : '\0';
+    
+    // Comments separate tokens like whitespace does
+    if (c == '-' && next == '-') {
+      while (i < sql.size() && sql[i] != '\n') {
+        ++i;
+      }
+      pending_space = true;
+      continue;
+    }
+    if (c == '/' && next == '*') {
+      i += 2;
+      while (i + 1 < sql.size() && !(sql[i] == '*' && sql[i + 1] == '/')) {
+        ++i;
+      }
+      ++i;  // Skip the closing '/'
+      pending_space = true;
+      continue;
+    }
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      pending_space = true;
+      continue;
+    }
+    
+    if (pending_space && !result.empty()) {
+      result.push_back(' ');
+    }
+    pending_space = false;
+    
+    // Literals and quoted identifiers are copied as-is, doubled quotes included
+    if (c == '\'' || c == '"') {
+      const size_t start = i++;
+      while (i < sql.size()) {
+        if (sql[i] == c) {
+          if (i + 1 < sql.size() && sql[i + 1] == c) {
+            i += 2;
+            continue;
+          }
+          break;
+        }
+        ++i;
+      }
+      result.append(sql.substr(start, std::min(i, sql.size() - 1) - start + 1));
+      continue;
+    }
+    
+    result.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+  }
+  
+  while (!result.empty() && (result.back() == ';' || result.back() == ' ')) {
+    result.pop_back();
+  }
+  return result;
+}
+
+void appendSqlLiteral(const ColumnBuffer& column, std::size_t row, std::string& sql) {
+  if (column.IsNull(row)) {
+    sql += "NULL";
+    return;
+  }
+  switch (column.Type()) {
+    case ColumnType::kInt64:
+    case ColumnType::kDouble:
+      column.AppendFormatted(row, sql);
+      return;
+    case ColumnType::kText: {
+      const std::string_view text = column.TextAt(row);
+      sql.push_back('\'');
+      for (char ch : text) {
+        if (ch == '\'') {
+          sql.push_back('\'');
+        }
+        sql.push_back(ch);
+      }
+      sql.push_back('\'');
+      return;
+    }
+    default:
+      sql.push_back('\'');
+      column.AppendFormatted(row, sql);
+      sql.push_back('\'');
+      return;
+  }
+}
+
+void appendSqlLiteral(const ColumnBuffer& column, std::size_t row, ColumnType declared,
+                      std::string& sql) {
+  const bool numeric_cell =
+      column.Type() == ColumnType::kInt64 || column.Type() == ColumnType::kDouble;
+  if (declared == ColumnType::kAuto || declared == ColumnType::kInt64 ||
+      declared == ColumnType::kDouble || !numeric_cell || column.IsNull(row)) {
+    appendSqlLiteral(column, row, sql);
+    return;
+  }
+  sql.push_back('\'');
+  column.AppendFormatted(row, sql);
+  sql.push_back('\'');
+}
+
 }  // namespace scratchrobin::core
@@ -6,11 +6,16 @@
  */
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <string_view>
 
 namespace scratchrobin::core {
 
+class ColumnBuffer;
+enum class ColumnType : std::uint8_t;
+
 /**
  * SQL Utility Functions
  *
@@ -43,6 +48,35 @@ std::string escapeIdentifier(std::string_view identifier);
  */
 std::string escapeStringLiteral(std::string_view value);
 
+/**
+ * Append one result cell as an SQL literal
+ *
+ * NULL becomes NULL, numbers are written bare and everything else is
+ * quoted like escapeStringLiteral(). Appends to |sql| without copying
+ * the cell, for building large multi-row statements.
+ * Example: it's -> 'it''s', 42 -> 42
+ *
+ * @param column The column holding the cell
+ * @param row Row index within the column
+ * @param sql Statement text to append to
+ */
+void appendSqlLiteral(const ColumnBuffer& column, std::size_t row, std::string& sql);
+
+/**
+ * Append one result cell as a literal of the column's declared type
+ *
+ * As above, but numbers are written bare only when |declared| is numeric;
+ * a text or date column quotes them, so '007' and 42 in a VARCHAR column
+ * both come out quoted. kAuto follows the cell.
+ *
+ * @param column The column holding the cell
+ * @param row Row index within the column
+ * @param declared The column's declared type, or kAuto
+ * @param sql Statement text to append to
+ */
+void appendSqlLiteral(const ColumnBuffer& column, std::size_t row, ColumnType declared,
+                      std::string& sql);
+
 /**
  * Validate identifier format
  *
@@ -91,4 +125,18 @@ std::string escapeLikePattern(std::string_view pattern, char escape_char = '\\')
  */
 std::string qualifiedTableName(std::string_view schema, std::string_view table);
 
+/**
+ * Normalize statement text for use as a cache key
+ *
+ * Strips comments, collapses whitespace runs to a single space, folds
+ * unquoted text to upper case and drops trailing semicolons. String
+ * literals and quoted identifiers are kept verbatim, so two statements
+ * normalize equal only when the server would treat them the same.
+ * Example: "select *\n  from t -- all;" -> "SELECT * FROM T"
+ *
+ * @param sql The statement text
+ * @return Normalized text
+ */
+std::string normalizeStatementText(std::string_view sql);
+
 }  // namespace scratchrobin::core
@@ -10,17 +10,1180 @@
 
 #include "core/streaming_data_importer.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "backend/scratchbird_sbwp_client.h"
+#include "core/arrow_ipc_format.h"
+#include "core/csv_chunk_parser.h"
+#include "core/parquet_format.h"
+#include "core/sql_utils.h"
+
 namespace scratchrobin::core {
 
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+constexpr std::size_t kDefaultChunkBytes = 8 * 1024 * 1024;
+constexpr int kPreviewSampleRows = 1000;
+
+// Cancel/pause flags and live progress of one running import.
+struct ImportControl {
+  std::atomic<bool> cancelled{false};
+  std::atomic<bool> paused{false};
+  mutable std::mutex mutex;
+  std::condition_variable resume_cv;
+  ImportProgress progress;
+  std::vector<ValidationError> errors;
+};
+
+using BatchSink = std::function<Status(const ResultSet& batch, int64_t first_row)>;
+
+std::string QuoteIdentifier(const ImportConfig& config, const std::string& name) {
+  return !config.quote_identifiers && isValidIdentifier(name) ? name : escapeIdentifier(name);
+}
+
+std::string QualifiedTableName(const ImportConfig& config) {
+  std::string name;
+  if (!config.target_schema.empty()) {
+    name = QuoteIdentifier(config, config.target_schema) + ".";
+  }
+  return name + QuoteIdentifier(config, config.target_table);
+}
+
+// Source column, NULL default and quoted target name of each inserted
+// column. Targets are empty when values go in table order.
+struct TargetColumns {
+  std::vector<std::size_t> source_index;
+  std::vector<std::optional<std::string>> defaults;
+  std::vector<std::string> names;
+};
+
+TargetColumns ResolveTargetColumns(const ImportConfig& config,
+                                   const std::vector<std::string>& source_columns) {
+  TargetColumns targets;
+  if (!config.column_mappings.empty()) {
+    for (const auto& mapping : config.column_mappings) {
+      auto it = std::find(source_columns.begin(), source_columns.end(), mapping.source_column);
+      if (it == source_columns.end()) {
+        continue;
+      }
+      targets.source_index.push_back(static_cast<std::size_t>(it - source_columns.begin()));
+      targets.defaults.push_back(mapping.default_value);
+      targets.names.push_back(QuoteIdentifier(
+          config, mapping.target_column.empty() ? mapping.source_column : mapping.target_column));
+    }
+    return targets;
+  }
+  for (std::size_t i = 0; i < source_columns.size(); ++i) {
+    targets.source_index.push_back(i);
+    targets.defaults.emplace_back();
+    if (config.auto_map_columns &&
+        (config.format != ImportFormat::kCSV || config.csv_options.has_header)) {
+      targets.names.push_back(QuoteIdentifier(config, source_columns[i]));
+    }
+  }
+  return targets;
+}
+
+// Appends one cell, keeping typed values typed.
+void AppendCell(const ColumnBuffer& from, std::size_t row, ColumnBuffer& to) {
+  if (from.IsNull(row)) {
+    to.AppendNull();
+    return;
+  }
+  switch (from.Type()) {
+    case ColumnType::kInt64:
+      to.AppendInt64(from.Int64At(row));
+      break;
+    case ColumnType::kDouble:
+      to.AppendDouble(from.DoubleAt(row));
+      break;
+    case ColumnType::kDate:
+      to.AppendDate(from.DateAt(row));
+      break;
+    default:
+      to.AppendText(from.TextAt(row));
+      break;
+  }
+}
+
+// Appends rows [begin, end) of |source|. A new |out| takes the source
+// column types, so text that looks numeric stays text.
+void AppendRows(const ColumnTable& source, std::size_t begin, std::size_t end,
+                ColumnTable* out) {
+  if (out->ColumnCount() == 0) {
+    out->SetColumnCount(source.ColumnCount());
+    for (std::size_t col = 0; col < source.ColumnCount(); ++col) {
+      out->SetColumnType(col, source.Column(col).Type());
+    }
+  }
+  for (std::size_t col = 0; col < source.ColumnCount(); ++col) {
+    const ColumnBuffer& from = source.Column(col);
+    ColumnBuffer& to = out->Column(col);
+    for (std::size_t row = begin; row < end; ++row) {
+      AppendCell(from, row, to);
+    }
+  }
+  for (std::size_t row = begin; row < end; ++row) {
+    out->EndRow();
+  }
+}
+
+ColumnTable CopyRows(const ColumnTable& source, std::size_t begin, std::size_t end) {
+  ColumnTable out;
+  AppendRows(source, begin, end, &out);
+  return out;
+}
+
+bool IsColumnar(ImportFormat format) {
+  return format == ImportFormat::kParquet || format == ImportFormat::kArrow;
+}
+
+// Orders two non-NULL cells of comparable types: numbers numerically,
+// dates by day, text bytewise.
+int CompareCells(const ColumnBuffer& a, std::size_t a_row, const ColumnBuffer& b,
+                 std::size_t b_row) {
+  auto order = [](auto x, auto y) { return x < y ? -1 : (y < x ? 1 : 0); };
+  if (a.Type() == ColumnType::kText) {
+    return order(a.TextAt(a_row), b.TextAt(b_row));
+  }
+  if (a.Type() == ColumnType::kDate) {
+    return order(a.DateAt(a_row), b.DateAt(b_row));
+  }
+  if (a.Type() == ColumnType::kInt64 && b.Type() == ColumnType::kInt64) {
+    return order(a.Int64At(a_row), b.Int64At(b_row));
+  }
+  auto number = [](const ColumnBuffer& column, std::size_t row) {
+    return column.Type() == ColumnType::kInt64 ? static_cast<double>(column.Int64At(row))
+                                               : column.DoubleAt(row);
+  };
+  return order(number(a, a_row), number(b, b_row));
+}
+
+// An ImportFilter resolved against the source schema. |probe| holds the
+// value, typed to compare with the column.
+struct BoundFilter {
+  ImportFilter::Op op;
+  std::size_t column;  // Schema index
+  std::size_t read;    // Index among the columns read
+  ColumnBuffer probe;
+};
+
+bool Passes(const BoundFilter& filter, const ColumnBuffer& column, std::size_t row) {
+  using Op = ImportFilter::Op;
+  if (column.IsNull(row)) {
+    return filter.op == Op::kIsNull;
+  }
+  if (filter.op == Op::kIsNull || filter.op == Op::kIsNotNull) {
+    return filter.op == Op::kIsNotNull;
+  }
+  const int order = CompareCells(column, row, filter.probe, 0);
+  switch (filter.op) {
+    case Op::kEqual: return order == 0;
+    case Op::kNotEqual: return order != 0;
+    case Op::kLess: return order < 0;
+    case Op::kLessEqual: return order <= 0;
+    case Op::kGreater: return order > 0;
+    default: return order >= 0;
+  }
+}
+
+/**
+ * ColumnarSource - row groups of a Parquet file or record batches of an
+ * Arrow stream, behind one interface
+ *
+ * Groups decode independently; Read() is const and thread safe.
+ */
+class ColumnarSource {
+ public:
+  virtual ~ColumnarSource() = default;
+  virtual Status Open(std::string_view data) = 0;
+  virtual const ColumnarSchema& Schema() const = 0;
+  virtual std::size_t GroupCount() const = 0;
+  virtual int64_t GroupRows(std::size_t group) const = 0;
+  virtual Status Read(std::size_t group, const std::vector<std::size_t>& columns,
+                      ColumnTable* out) const = 0;
+  // False when statistics show no row of |group| passes |filter|.
+  virtual bool MayPass(std::size_t, const BoundFilter&) const { return true; }
+};
+
+class ParquetSource : public ColumnarSource {
+ public:
+  Status Open(std::string_view data) override { return reader_.Open(data); }
+  const ColumnarSchema& Schema() const override { return reader_.Schema(); }
+  std::size_t GroupCount() const override { return reader_.RowGroupCount(); }
+  int64_t GroupRows(std::size_t group) const override { return reader_.RowGroupRows(group); }
+  Status Read(std::size_t group, const std::vector<std::size_t>& columns,
+              ColumnTable* out) const override {
+    return reader_.ReadRowGroup(group, columns, out);
+  }
+
+  bool MayPass(std::size_t group, const BoundFilter& filter) const override {
+    using Op = ImportFilter::Op;
+    const auto stats = reader_.Statistics(group, filter.column);
+    const bool all_null = stats.null_count >= 0 && stats.null_count == stats.value_count;
+    switch (filter.op) {
+      case Op::kIsNull: return stats.null_count != 0;
+      case Op::kIsNotNull: return !all_null;
+      default: break;
+    }
+    if (all_null) {
+      return false;
+    }
+    if (!stats.has_bounds) {
+      return true;
+    }
+    const int vs_min = CompareCells(filter.probe, 0, stats.bounds, 0);
+    const int vs_max = CompareCells(filter.probe, 0, stats.bounds, 1);
+    switch (filter.op) {
+      case Op::kEqual: return vs_min >= 0 && vs_max <= 0;
+      case Op::kNotEqual: return vs_min != 0 || vs_max != 0;
+      case Op::kLess: return vs_min > 0;
+      case Op::kLessEqual: return vs_min >= 0;
+      case Op::kGreater: return vs_max < 0;
+      default: return vs_max <= 0;
+    }
+  }
+
+ private:
+  ParquetReader reader_;
+};
+
+class ArrowSource : public ColumnarSource {
+ public:
+  Status Open(std::string_view data) override { return reader_.Open(data); }
+  const ColumnarSchema& Schema() const override { return reader_.Schema(); }
+  std::size_t GroupCount() const override { return reader_.BatchCount(); }
+  int64_t GroupRows(std::size_t group) const override { return reader_.BatchRows(group); }
+  Status Read(std::size_t group, const std::vector<std::size_t>& columns,
+              ColumnTable* out) const override {
+    return reader_.ReadBatch(group, columns, out);
+  }
+
+ private:
+  ArrowIpcReader reader_;
+};
+
+// Destination of parsed batches when the import loads a table.
+class RowWriter {
+ public:
+  virtual ~RowWriter() = default;
+  virtual Status Begin() = 0;
+  virtual Status Write(const ResultSet& batch, int64_t first_row, ImportResult* result) = 0;
+  virtual Status Finish(bool success, ImportResult* result) = 0;
+};
+
+/**
+ * InsertWriter - turns parsed batches into multi-row INSERT statements
+ *
+ * Rows are packed batch_size to a statement. With use_transactions the
+ * load runs in a transaction committed every commit_frequency rows. A
+ * failed statement costs only its own rows unless the config asks to
+ * abort on error.
+ */
+class InsertWriter : public RowWriter {
+ public:
+  InsertWriter(const ImportConfig& config, const std::vector<std::string>& source_columns)
+      : config_(config),
+        connection_(config.connection.get()),
+        targets_(ResolveTargetColumns(config, source_columns)) {
+    prefix_ = "INSERT INTO " + QualifiedTableName(config);
+    if (!targets_.names.empty()) {
+      prefix_ += " (";
+      for (std::size_t i = 0; i < targets_.names.size(); ++i) {
+        prefix_ += (i ? ", " : "") + targets_.names[i];
+      }
+      prefix_ += ")";
+    }
+    prefix_ += " VALUES ";
+  }
+
+  Status Begin() override {
+    if (!connection_) {
+      return Status::Error("No connection for import");
+    }
+    if (targets_.source_index.empty()) {
+      return Status::Error("No source columns map to the target table");
+    }
+    if (config_.use_transactions && !connection_->beginTransaction()) {
+      return Status::Error("Cannot start transaction: " + connection_->lastError());
+    }
+    in_transaction_ = config_.use_transactions;
+    if (config_.mode == ImportMode::kReplace) {
+      auto cleared = connection_->execute("DELETE FROM " + QualifiedTableName(config_));
+      if (!cleared.success) {
+        return Status::Error("Cannot clear target table: " + cleared.error_message);
+      }
+    }
+    return Status::Ok();
+  }
+
+  Status Write(const ResultSet& batch, int64_t first_row, ImportResult* result) override {
+    const std::size_t rows = batch.RowCount();
+    const std::size_t batch_rows = static_cast<std::size_t>(std::max(1, config_.batch_size));
+    for (std::size_t begin = 0; begin < rows; begin += batch_rows) {
+      const std::size_t end = std::min(rows, begin + batch_rows);
+      BuildInsert(batch, begin, end);
+      const auto count = static_cast<int64_t>(end - begin);
+      auto executed = connection_->execute(sql_);
+      if (!executed.success) {
+        result->total_rows_failed += count;
+        result->errors.push_back("Rows " + std::to_string(first_row + begin) + "-" +
+                                 std::to_string(first_row + end - 1) + ": " +
+                                 executed.error_message);
+        if (config_.abort_on_error || !config_.continue_on_error) {
+          return Status::Error(executed.error_message);
+        }
+        continue;
+      }
+      result->total_rows_inserted += count;
+      rows_since_commit_ += count;
+      if (in_transaction_ && config_.commit_frequency > 0 &&
+          rows_since_commit_ >= config_.commit_frequency) {
+        if (!connection_->commit() || !connection_->beginTransaction()) {
+          return Status::Error("Commit failed: " + connection_->lastError());
+        }
+        rows_since_commit_ = 0;
+      }
+    }
+    return Status::Ok();
+  }
+
+  Status Finish(bool success, ImportResult*) override {
+    if (!in_transaction_) {
+      return Status::Ok();
+    }
+    in_transaction_ = false;
+    if (!success) {
+      connection_->rollback();
+      return Status::Ok();
+    }
+    return connection_->commit() ? Status::Ok()
+                                 : Status::Error("Commit failed: " + connection_->lastError());
+  }
+
+ private:
+  void BuildInsert(const ResultSet& batch, std::size_t begin, std::size_t end) {
+    sql_.assign(prefix_);
+    for (std::size_t row = begin; row < end; ++row) {
+      sql_ += row == begin ? "(" : ", (";
+      for (std::size_t i = 0; i < targets_.source_index.size(); ++i) {
+        if (i) {
+          sql_ += ", ";
+        }
+        const ColumnBuffer& column = batch.Column(targets_.source_index[i]);
+        if (targets_.defaults[i] && column.IsNull(row)) {
+          sql_ += escapeStringLiteral(*targets_.defaults[i]);
+        } else {
+          appendSqlLiteral(column, row, sql_);
+        }
+      }
+      sql_.push_back(')');
+    }
+  }
+
+  const ImportConfig& config_;
+  Connection* connection_;
+  TargetColumns targets_;
+  std::string prefix_;
+  std::string sql_;
+  bool in_transaction_{false};
+  int64_t rows_since_commit_{0};
+};
+
+/**
+ * BulkWriter - feeds parsed batches to the SBWP bulk load pipeline
+ *
+ * Statement building and the round trips run on separate threads, so the
+ * importer only blocks when the server falls behind. Rows the server
+ * rejects are isolated by the pipeline and reported when the load ends.
+ */
+class BulkWriter : public RowWriter {
+ public:
+  BulkWriter(const ImportConfig& config, const std::vector<std::string>& source_columns)
+      : client_(config.bulk_client.get()) {
+    const TargetColumns targets = ResolveTargetColumns(config, source_columns);
+    options_.table = QualifiedTableName(config);
+    for (std::size_t i = 0; i < targets.source_index.size(); ++i) {
+      backend::ScratchbirdSbwpClient::BulkLoadColumn column;
+      column.name = targets.names.empty() ? std::string() : targets.names[i];
+      column.source = targets.source_index[i];
+      if (targets.defaults[i]) {
+        column.default_literal = escapeStringLiteral(*targets.defaults[i]);
+      }
+      options_.columns.push_back(std::move(column));
+    }
+    if (config.mode == ImportMode::kReplace) {
+      options_.setup_sql = "DELETE FROM " + options_.table;
+    }
+    options_.max_rows_per_statement = static_cast<std::size_t>(std::max(1, config.batch_size));
+    options_.use_transaction = config.use_transactions;
+    options_.commit_every_rows = config.commit_frequency;
+    options_.stop_on_error = config.abort_on_error || !config.continue_on_error;
+  }
+
+  Status Begin() override {
+    if (!client_) {
+      return Status::Error("No connection for import");
+    }
+    if (options_.columns.empty()) {
+      return Status::Error("No source columns map to the target table");
+    }
+    return client_->BeginBulkLoad(options_).status;
+  }
+
+  Status Write(const ResultSet& batch, int64_t first_row, ImportResult*) override {
+    return client_->BulkLoadRows(batch, first_row).status;
+  }
+
+  Status Finish(bool success, ImportResult* result) override {
+    if (!success) {
+      client_->AbortBulkLoad();
+      return Status::Ok();
+    }
+    backend::ScratchbirdSbwpClient::BulkLoadReport report;
+    Status status = client_->EndBulkLoad(&report).status;
+    result->total_rows_inserted += report.rows_loaded;
+    result->total_rows_failed += report.rows_failed;
+    for (const auto& error : report.errors) {
+      result->errors.push_back("Row " + std::to_string(error.row) + ": " + error.message);
+    }
+    return status;
+  }
+
+ private:
+  backend::ScratchbirdSbwpClient* client_;
+  backend::ScratchbirdSbwpClient::BulkLoadOptions options_;
+};
+
+}  // namespace
+
 // Private implementation
 struct StreamingDataImporter::Impl {
+  ~Impl() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto& [id, control] : active_imports) {
+        (void)id;
+        control->cancelled = true;
+        control->paused = false;
+        control->resume_cv.notify_all();
+      }
+    }
+    for (auto& thread : async_threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+  std::shared_ptr<ImportControl> Find(const std::string& import_id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = active_imports.find(import_id);
+    return it == active_imports.end() ? nullptr : it->second;
+  }
+
+  ImportResult Run(const ImportConfig& config, const BatchSink& sink, RowWriter* writer);
+  Status Sample(const std::string& source_path, ImportFormat format, const CSVOptions& options,
+                int max_rows, ResultSet* out);
+  ImportResult RunCsv(const ImportConfig& config, ImportControl& control, const BatchSink& sink,
+                      RowWriter* writer);
+  ImportResult RunColumnar(const ImportConfig& config, ImportControl& control,
+                           const BatchSink& sink, RowWriter* writer);
+
+  mutable std::mutex mutex;
   ProgressCallback progress_callback;
   ErrorCallback error_callback;
   CompletionCallback completion_callback;
-  std::map<std::string, ImportProgress> active_imports;
+  std::map<std::string, std::shared_ptr<ImportControl>> active_imports;
   std::map<std::string, ImportResult> completed_imports;
+  std::map<std::string, std::vector<ValidationError>> validation_errors;
+  std::vector<std::thread> async_threads;
 };
 
+ImportResult StreamingDataImporter::Impl::Run(const ImportConfig& config, const BatchSink& sink,
+                                              RowWriter* writer) {
+  auto control = std::make_shared<ImportControl>();
+  control->progress.import_id = config.import_id;
+  control->progress.status_message = "Starting import...";
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (active_imports.count(config.import_id)) {
+      ImportResult busy;
+      busy.import_id = config.import_id;
+      busy.status = Status::Error("Import already running: " + config.import_id);
+      return busy;
+    }
+    active_imports[config.import_id] = control;
+  }
+
+  ImportResult result = IsColumnar(config.format) ? RunColumnar(config, *control, sink, writer)
+                                                   : RunCsv(config, *control, sink, writer);
+
+  CompletionCallback on_complete;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    active_imports.erase(config.import_id);
+    completed_imports[config.import_id] = result;
+    std::lock_guard<std::mutex> control_lock(control->mutex);
+    validation_errors[config.import_id] = std::move(control->errors);
+    on_complete = completion_callback;
+  }
+  if (on_complete) {
+    on_complete(result);
+  }
+  return result;
+}
+
+// Parses the file on worker threads, one chunk each, and feeds the chunks
+// to |sink| in file order on the calling thread. Workers stay at most a
+// fixed window of chunks ahead so memory stays bounded on huge files.
+ImportResult StreamingDataImporter::Impl::RunCsv(const ImportConfig& config,
+                                                 ImportControl& control,
+                                                 const BatchSink& sink, RowWriter* writer) {
+  using State = CsvChunkParser::State;
+  const auto started = SteadyClock::now();
+  ImportResult result;
+  result.import_id = config.import_id;
+  result.status = Status::Ok();
+
+  auto finish = [&](Status status) {
+    result.status = std::move(status);
+    result.total_duration =
+        std::chrono::duration_cast<std::chrono::milliseconds>(SteadyClock::now() - started);
+    const double seconds = std::chrono::duration<double>(SteadyClock::now() - started).count();
+    if (seconds > 0) {
+      result.average_rows_per_second = static_cast<double>(result.total_rows_processed) / seconds;
+    }
+    return result;
+  };
+
+  if (config.format != ImportFormat::kCSV) {
+    return finish(Status::Error("Only CSV, Parquet and Arrow sources are supported"));
+  }
+  if (config.mode == ImportMode::kUpdate || config.mode == ImportMode::kUpsert) {
+    return finish(Status::Error("CSV import supports insert, append and replace modes"));
+  }
+  if (!config.select_columns.empty() || !config.filters.empty()) {
+    return finish(Status::Error("Column selection and filters apply to Parquet and Arrow sources"));
+  }
+  CsvEncoding encoding;
+  if (!ParseCsvEncoding(config.csv_options.encoding, &encoding)) {
+    return finish(Status::Error("Unsupported CSV encoding: " + config.csv_options.encoding));
+  }
+
+  MappedFile file;
+  Status opened = file.Open(config.source_path);
+  if (!opened.ok) {
+    return finish(opened);
+  }
+  const std::string_view data = file.Data();
+  const CsvChunkParser parser(config.csv_options);
+
+  // Header and leading lines are read sequentially
+  std::size_t data_begin =
+      parser.SkipRecords(data, parser.TextStart(data), config.csv_options.skip_lines);
+  std::vector<std::string> header;
+  if (config.csv_options.has_header) {
+    data_begin = parser.ParseRecord(data, data_begin, &header);
+  } else if (data_begin < data.size()) {
+    parser.ParseRecord(data, data_begin, &header);
+    for (std::size_t i = 0; i < header.size(); ++i) {
+      header[i] = "column" + std::to_string(i + 1);
+    }
+  }
+  const std::size_t column_count = header.size();
+  std::vector<std::string> columns;
+  for (std::size_t i = 0; i < column_count; ++i) {
+    if (!parser.IsIgnored(i)) {
+      columns.push_back(header[i]);
+    }
+  }
+
+  std::unique_ptr<RowWriter> local_writer;
+  if (!sink && !writer) {
+    if (config.bulk_client) {
+      local_writer = std::make_unique<BulkWriter>(config, columns);
+    } else {
+      local_writer = std::make_unique<InsertWriter>(config, columns);
+    }
+    writer = local_writer.get();
+  }
+  if (writer) {
+    Status begun = writer->Begin();
+    if (!begun.ok) {
+      writer->Finish(false, &result);
+      return finish(begun);
+    }
+  }
+
+  const std::size_t chunk_bytes = config.chunk_size_bytes > 0
+                                      ? static_cast<std::size_t>(config.chunk_size_bytes)
+                                      : kDefaultChunkBytes;
+  const std::size_t payload = data.size() > data_begin ? data.size() - data_begin : 0;
+  const std::size_t chunk_count = column_count == 0 ? 0 : (payload + chunk_bytes - 1) / chunk_bytes;
+  const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+  const std::size_t thread_count = std::min<std::size_t>(
+      std::max<std::size_t>(1, chunk_count),
+      config.parallelism > 0 ? static_cast<std::size_t>(config.parallelism) : hardware);
+  const std::size_t window = thread_count * 2;
+
+  struct Slot {
+    bool ready{false};
+    std::size_t begin{0};
+    std::size_t end{0};
+    std::size_t parsed_from{CsvChunkParser::kNoRecord};
+    CsvChunkParser::Transition transition;
+    CsvChunkParser::Chunk chunk;
+  };
+  std::vector<Slot> slots(chunk_count);
+  std::mutex slots_mutex;
+  std::condition_variable ready_cv;
+  std::condition_variable window_cv;
+  std::size_t next_chunk = 0;
+  std::size_t consumed = 0;
+  bool stop = false;
+
+  auto record_start = [&](const Slot& slot, std::size_t index, State state) {
+    if (index == 0 || (state == State::kOutside && data[slot.begin - 1] == '\n')) {
+      return slot.begin;
+    }
+    return slot.transition.first_record[static_cast<std::size_t>(state)];
+  };
+  auto parse = [&](Slot& slot, std::size_t from) {
+    slot.chunk = CsvChunkParser::Chunk{};
+    slot.parsed_from = from;
+    if (from != CsvChunkParser::kNoRecord && from < slot.end) {
+      parser.ParseRecords(data, from, slot.end, column_count, &slot.chunk);
+    } else {
+      slot.chunk.rows.SetColumnCount(columns.size());
+    }
+  };
+
+  auto worker = [&] {
+    for (;;) {
+      std::size_t index = 0;
+      {
+        std::unique_lock<std::mutex> lock(slots_mutex);
+        window_cv.wait(lock, [&] {
+          return stop || next_chunk >= chunk_count || next_chunk < consumed + window;
+        });
+        if (stop || next_chunk >= chunk_count) {
+          return;
+        }
+        index = next_chunk++;
+      }
+      Slot& slot = slots[index];
+      slot.begin = data_begin + index * chunk_bytes;
+      slot.end = std::min(data.size(), slot.begin + chunk_bytes);
+      slot.transition = parser.Scan(data, slot.begin, slot.end);
+      // Speculate that the chunk starts outside quotes; the consumer
+      // re-parses in the rare case it did not.
+      parse(slot, record_start(slot, index, State::kOutside));
+      {
+        std::lock_guard<std::mutex> lock(slots_mutex);
+        slot.ready = true;
+      }
+      ready_cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(thread_count);
+  for (std::size_t i = 0; i < thread_count && chunk_count > 0; ++i) {
+    workers.emplace_back(worker);
+  }
+
+  ErrorCallback on_error;
+  ProgressCallback on_progress;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    on_error = error_callback;
+    on_progress = progress_callback;
+  }
+
+  const int64_t row_limit = std::min(config.max_rows > 0 ? config.max_rows : INT64_MAX,
+                                     config.limit_rows > 0 ? config.limit_rows : INT64_MAX);
+  int64_t records_before = 0;
+  int64_t rows_to_skip = std::max<int64_t>(0, config.skip_rows);
+  int64_t rows_emitted = 0;
+  State state = State::kOutside;
+  Status status = Status::Ok();
+
+  for (std::size_t index = 0; index < chunk_count && status.ok; ++index) {
+    {
+      std::unique_lock<std::mutex> lock(slots_mutex);
+      ready_cv.wait(lock, [&] { return slots[index].ready; });
+    }
+    Slot& slot = slots[index];
+    const std::size_t from = record_start(slot, index, state);
+    if (from != slot.parsed_from) {
+      parse(slot, from);
+    }
+    state = slot.transition.end_state[static_cast<std::size_t>(state)];
+
+    // Parse errors, numbered by data row
+    for (const auto& row_error : slot.chunk.errors) {
+      ValidationError error;
+      error.row_number = records_before + row_error.record + 1;
+      error.error_type = "parse";
+      error.error_message = row_error.message;
+      ++result.total_rows_failed;
+      result.errors.push_back("Row " + std::to_string(error.row_number) + ": " + error.error_message);
+      {
+        std::lock_guard<std::mutex> lock(control.mutex);
+        control.errors.push_back(error);
+      }
+      if ((on_error && !on_error(error)) || config.abort_on_error) {
+        status = Status::Error("Import aborted at row " + std::to_string(error.row_number) +
+                               ": " + error.error_message);
+        break;
+      }
+    }
+    records_before += slot.chunk.records;
+    result.total_rows_read += slot.chunk.records;
+
+    // Apply skip_rows / row limits, then hand the rows over
+    const auto chunk_rows = static_cast<int64_t>(slot.chunk.rows.RowCount());
+    const int64_t skip = std::min(rows_to_skip, chunk_rows);
+    rows_to_skip -= skip;
+    result.total_rows_skipped += skip;
+    const int64_t take = std::min(chunk_rows - skip, row_limit - rows_emitted);
+    if (status.ok && take > 0) {
+      ResultSet batch;
+      batch.columns = columns;
+      batch.rows = skip == 0 && take == chunk_rows
+                       ? std::move(slot.chunk.rows)
+                       : CopyRows(slot.chunk.rows, static_cast<std::size_t>(skip),
+                                  static_cast<std::size_t>(skip + take));
+      const int64_t first_row = config.skip_rows + rows_emitted + 1;
+      status = writer ? writer->Write(batch, first_row, &result) : sink(batch, first_row);
+      rows_emitted += take;
+      result.total_rows_processed += take;
+      if (!writer && status.ok) {
+        result.total_rows_inserted += take;
+      }
+    }
+    slot.chunk = CsvChunkParser::Chunk{};
+
+    {
+      std::lock_guard<std::mutex> lock(slots_mutex);
+      consumed = index + 1;
+    }
+    window_cv.notify_all();
+
+    // Progress
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(SteadyClock::now() - started);
+    ImportProgress snapshot;
+    {
+      std::lock_guard<std::mutex> lock(control.mutex);
+      auto& progress = control.progress;
+      progress.total_bytes = static_cast<int64_t>(data.size());
+      progress.bytes_read = static_cast<int64_t>(slot.end);
+      progress.rows_read = result.total_rows_read;
+      progress.rows_processed = result.total_rows_processed;
+      progress.rows_inserted = result.total_rows_inserted;
+      progress.rows_skipped = result.total_rows_skipped;
+      progress.rows_failed = result.total_rows_failed;
+      progress.current_batch = static_cast<int64_t>(index + 1);
+      progress.percentage_complete =
+          data.empty() ? 100.0 : 100.0 * static_cast<double>(slot.end) / static_cast<double>(data.size());
+      progress.elapsed_time = elapsed;
+      if (elapsed.count() > 0) {
+        progress.rows_per_second =
+            static_cast<double>(result.total_rows_processed) * 1000.0 / static_cast<double>(elapsed.count());
+        const double remaining_fraction = 1.0 - progress.percentage_complete / 100.0;
+        progress.estimated_remaining = std::chrono::milliseconds(static_cast<int64_t>(
+            elapsed.count() * remaining_fraction / std::max(1e-9, 1.0 - remaining_fraction)));
+      }
+      progress.current_operation = writer ? "Inserting rows" : "Streaming rows";
+      snapshot = progress;
+    }
+    if (on_progress) {
+      on_progress(snapshot);
+    }
+
+    if (rows_emitted >= row_limit) {
+      break;
+    }
+    if (status.ok && config.max_errors > 0 &&
+        static_cast<int64_t>(result.errors.size()) > config.max_errors) {
+      status = Status::Error("Too many errors (" + std::to_string(result.errors.size()) + ")");
+    }
+    {
+      std::unique_lock<std::mutex> lock(control.mutex);
+      control.resume_cv.wait(lock, [&] { return !control.paused || control.cancelled; });
+    }
+    if (control.cancelled) {
+      status = Status::Error("Import cancelled");
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(slots_mutex);
+    stop = true;
+  }
+  window_cv.notify_all();
+  for (auto& thread : workers) {
+    thread.join();
+  }
+
+  if (writer) {
+    Status finished = writer->Finish(status.ok, &result);
+    if (status.ok && !finished.ok) {
+      status = finished;
+    }
+  }
+  return finish(status);
+}
+
+// Decodes row groups (Parquet) or record batches (Arrow) on worker
+// threads, reading only the selected and filtered columns, and feeds them
+// to |sink| in file order like RunCsv. Groups whose statistics fail a
+// filter are skipped without being decoded.
+ImportResult StreamingDataImporter::Impl::RunColumnar(const ImportConfig& config,
+                                                      ImportControl& control,
+                                                      const BatchSink& sink, RowWriter* writer) {
+  const auto started = SteadyClock::now();
+  ImportResult result;
+  result.import_id = config.import_id;
+  result.status = Status::Ok();
+
+  auto finish = [&](Status status) {
+    result.status = std::move(status);
+    result.total_duration =
+        std::chrono::duration_cast<std::chrono::milliseconds>(SteadyClock::now() - started);
+    const double seconds = std::chrono::duration<double>(SteadyClock::now() - started).count();
+    if (seconds > 0) {
+      result.average_rows_per_second = static_cast<double>(result.total_rows_processed) / seconds;
+    }
+    return result;
+  };
+
+  if (config.mode == ImportMode::kUpdate || config.mode == ImportMode::kUpsert) {
+    return finish(Status::Error("Parquet and Arrow imports support insert, append and replace modes"));
+  }
+
+  MappedFile file;
+  Status status = file.Open(config.source_path);
+  if (!status.ok) {
+    return finish(status);
+  }
+  std::unique_ptr<ColumnarSource> source;
+  if (config.format == ImportFormat::kParquet) {
+    source = std::make_unique<ParquetSource>();
+  } else {
+    source = std::make_unique<ArrowSource>();
+  }
+  status = source->Open(file.Data());
+  if (!status.ok) {
+    return finish(status);
+  }
+  const ColumnarSchema& schema = source->Schema();
+  auto find_column = [&schema](const std::string& name) {
+    auto it = std::find(schema.names.begin(), schema.names.end(), name);
+    return static_cast<std::size_t>(it - schema.names.begin());
+  };
+
+  // Selected columns come first in the read list, filter-only columns after
+  std::vector<std::size_t> read;
+  std::vector<std::string> columns;
+  if (config.select_columns.empty()) {
+    for (std::size_t i = 0; i < schema.names.size(); ++i) {
+      read.push_back(i);
+    }
+    columns = schema.names;
+  } else {
+    for (const auto& name : config.select_columns) {
+      const std::size_t index = find_column(name);
+      if (index == schema.names.size()) {
+        return finish(Status::Error("Column not in source: " + name));
+      }
+      read.push_back(index);
+      columns.push_back(name);
+    }
+  }
+  const std::size_t output_count = read.size();
+
+  std::vector<BoundFilter> filters;
+  for (const auto& filter : config.filters) {
+    const std::size_t index = find_column(filter.column);
+    if (index == schema.names.size()) {
+      return finish(Status::Error("Filter column not in source: " + filter.column));
+    }
+    BoundFilter bound{filter.op, index, 0, ColumnBuffer()};
+    auto it = std::find(read.begin(), read.end(), index);
+    bound.read = static_cast<std::size_t>(it - read.begin());
+    if (it == read.end()) {
+      read.push_back(index);
+    }
+    if (filter.op != ImportFilter::Op::kIsNull && filter.op != ImportFilter::Op::kIsNotNull) {
+      const ColumnType type = schema.types[index];
+      bound.probe = ColumnBuffer(type == ColumnType::kText ? ColumnType::kText : ColumnType::kAuto);
+      bound.probe.AppendText(filter.value);
+      const ColumnType probe = bound.probe.Type();
+      const bool numeric = type == ColumnType::kInt64 || type == ColumnType::kDouble;
+      if (numeric ? probe != ColumnType::kInt64 && probe != ColumnType::kDouble : probe != type) {
+        return finish(Status::Error("Filter value '" + filter.value + "' is not a valid " +
+                                    ToString(type) + " for column " + filter.column));
+      }
+    }
+    filters.push_back(std::move(bound));
+  }
+
+  std::unique_ptr<RowWriter> local_writer;
+  if (!sink && !writer) {
+    if (config.bulk_client) {
+      local_writer = std::make_unique<BulkWriter>(config, columns);
+    } else {
+      local_writer = std::make_unique<InsertWriter>(config, columns);
+    }
+    writer = local_writer.get();
+  }
+  if (writer) {
+    Status begun = writer->Begin();
+    if (!begun.ok) {
+      writer->Finish(false, &result);
+      return finish(begun);
+    }
+  }
+
+  const std::size_t group_count = source->GroupCount();
+  const std::size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+  const std::size_t thread_count = std::min<std::size_t>(
+      std::max<std::size_t>(1, group_count),
+      config.parallelism > 0 ? static_cast<std::size_t>(config.parallelism) : hardware);
+  const std::size_t window = thread_count * 2;
+
+  struct Slot {
+    bool ready{false};
+    Status status{Status::Ok()};
+    int64_t records{0};
+    ColumnTable rows;
+  };
+  std::vector<Slot> slots(group_count);
+  std::mutex slots_mutex;
+  std::condition_variable ready_cv;
+  std::condition_variable window_cv;
+  std::size_t next_group = 0;
+  std::size_t consumed = 0;
+  bool stop = false;
+
+  auto decode = [&](std::size_t index, Slot& slot) {
+    slot.records = source->GroupRows(index);
+    for (const auto& filter : filters) {
+      if (!source->MayPass(index, filter)) {
+        slot.rows.SetColumnCount(output_count);
+        return;
+      }
+    }
+    ColumnTable decoded;
+    slot.status = source->Read(index, read, &decoded);
+    if (!slot.status.ok) {
+      return;
+    }
+    if (filters.empty() && read.size() == output_count) {
+      slot.rows = std::move(decoded);
+      return;
+    }
+    std::vector<std::size_t> keep;
+    for (std::size_t row = 0; row < decoded.RowCount(); ++row) {
+      bool pass = true;
+      for (std::size_t f = 0; f < filters.size() && pass; ++f) {
+        pass = Passes(filters[f], decoded.Column(filters[f].read), row);
+      }
+      if (pass) {
+        keep.push_back(row);
+      }
+    }
+    slot.rows.SetColumnCount(output_count);
+    for (std::size_t col = 0; col < output_count; ++col) {
+      const ColumnBuffer& from = decoded.Column(col);
+      ColumnBuffer& to = slot.rows.Column(col);
+      if (keep.size() == decoded.RowCount()) {
+        to = std::move(decoded.Column(col));
+        continue;
+      }
+      to = ColumnBuffer(from.Type());
+      to.Reserve(keep.size());
+      for (std::size_t row : keep) {
+        AppendCell(from, row, to);
+      }
+    }
+    for (std::size_t i = 0; i < keep.size(); ++i) {
+      slot.rows.EndRow();
+    }
+  };
+
+  auto worker = [&] {
+    for (;;) {
+      std::size_t index = 0;
+      {
+        std::unique_lock<std::mutex> lock(slots_mutex);
+        window_cv.wait(lock, [&] {
+          return stop || next_group >= group_count || next_group < consumed + window;
+        });
+        if (stop || next_group >= group_count) {
+          return;
+        }
+        index = next_group++;
+      }
+      decode(index, slots[index]);
+      {
+        std::lock_guard<std::mutex> lock(slots_mutex);
+        slots[index].ready = true;
+      }
+      ready_cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(thread_count);
+  for (std::size_t i = 0; i < thread_count && group_count > 0; ++i) {
+    workers.emplace_back(worker);
+  }
+
+  ProgressCallback on_progress;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    on_progress = progress_callback;
+  }
+
+  const int64_t row_limit = std::min(config.max_rows > 0 ? config.max_rows : INT64_MAX,
+                                     config.limit_rows > 0 ? config.limit_rows : INT64_MAX);
+  int64_t rows_to_skip = std::max<int64_t>(0, config.skip_rows);
+  int64_t rows_emitted = 0;
+
+  for (std::size_t index = 0; index < group_count && status.ok; ++index) {
+    {
+      std::unique_lock<std::mutex> lock(slots_mutex);
+      ready_cv.wait(lock, [&] { return slots[index].ready; });
+    }
+    Slot& slot = slots[index];
+    if (!slot.status.ok) {
+      status = slot.status;
+      break;
+    }
+    const auto group_rows = static_cast<int64_t>(slot.rows.RowCount());
+    result.total_rows_read += slot.records;
+    result.total_rows_skipped += slot.records - group_rows;
+
+    // skip_rows and row limits count rows that passed the filters
+    const int64_t skip = std::min(rows_to_skip, group_rows);
+    rows_to_skip -= skip;
+    result.total_rows_skipped += skip;
+    const int64_t take = std::min(group_rows - skip, row_limit - rows_emitted);
+    if (take > 0) {
+      ResultSet batch;
+      batch.columns = columns;
+      batch.rows = skip == 0 && take == group_rows
+                       ? std::move(slot.rows)
+                       : CopyRows(slot.rows, static_cast<std::size_t>(skip),
+                                  static_cast<std::size_t>(skip + take));
+      const int64_t first_row = config.skip_rows + rows_emitted + 1;
+      status = writer ? writer->Write(batch, first_row, &result) : sink(batch, first_row);
+      rows_emitted += take;
+      result.total_rows_processed += take;
+      if (!writer && status.ok) {
+        result.total_rows_inserted += take;
+      }
+    }
+    slot.rows = ColumnTable{};
+
+    {
+      std::lock_guard<std::mutex> lock(slots_mutex);
+      consumed = index + 1;
+    }
+    window_cv.notify_all();
+
+    // Progress, by groups
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(SteadyClock::now() - started);
+    const double done = static_cast<double>(index + 1) / static_cast<double>(group_count);
+    ImportProgress snapshot;
+    {
+      std::lock_guard<std::mutex> lock(control.mutex);
+      auto& progress = control.progress;
+      progress.total_bytes = static_cast<int64_t>(file.Data().size());
+      progress.bytes_read = static_cast<int64_t>(done * static_cast<double>(file.Data().size()));
+      progress.rows_read = result.total_rows_read;
+      progress.rows_processed = result.total_rows_processed;
+      progress.rows_inserted = result.total_rows_inserted;
+      progress.rows_skipped = result.total_rows_skipped;
+      progress.rows_failed = result.total_rows_failed;
+      progress.current_batch = static_cast<int64_t>(index + 1);
+      progress.percentage_complete = 100.0 * done;
+      progress.elapsed_time = elapsed;
+      if (elapsed.count() > 0) {
+        progress.rows_per_second =
+            static_cast<double>(result.total_rows_processed) * 1000.0 / static_cast<double>(elapsed.count());
+        progress.estimated_remaining = std::chrono::milliseconds(
+            static_cast<int64_t>(static_cast<double>(elapsed.count()) * (1.0 - done) / done));
+      }
+      progress.current_operation = writer ? "Inserting rows" : "Streaming rows";
+      snapshot = progress;
+    }
+    if (on_progress) {
+      on_progress(snapshot);
+    }
+
+    if (rows_emitted >= row_limit) {
+      break;
+    }
+    {
+      std::unique_lock<std::mutex> lock(control.mutex);
+      control.resume_cv.wait(lock, [&] { return !control.paused || control.cancelled; });
+    }
+    if (control.cancelled) {
+      status = Status::Error("Import cancelled");
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(slots_mutex);
+    stop = true;
+  }
+  window_cv.notify_all();
+  for (auto& thread : workers) {
+    thread.join();
+  }
+
+  if (writer) {
+    Status finished = writer->Finish(status.ok, &result);
+    if (status.ok && !finished.ok) {
+      status = finished;
+    }
+  }
+  return finish(status);
+}
+
+Status StreamingDataImporter::Impl::Sample(const std::string& source_path,
+                                           ImportFormat format, const CSVOptions& options,
+                                           int max_rows, ResultSet* out) {
+  ImportConfig config;
+  config.source_path = source_path;
+  config.format = format;
+  config.csv_options = options;
+  config.limit_rows = max_rows;
+  config.chunk_size_bytes = 1024 * 1024;
+  config.parallelism = 1;
+  *out = ResultSet{};
+  ImportControl control;
+  const BatchSink sink = [out](const ResultSet& batch, int64_t) {
+    out->columns = batch.columns;
+    AppendRows(batch.rows, 0, batch.RowCount(), &out->rows);
+    return Status::Ok();
+  };
+  ImportResult result = IsColumnar(format) ? RunColumnar(config, control, sink, nullptr)
+                                           : RunCsv(config, control, sink, nullptr);
+  return result.status;
+}
+
 StreamingDataImporter::StreamingDataImporter()
     : impl_(std::make_unique<Impl>()) {
 }
@@ -28,85 +1191,100 @@ StreamingDataImporter::StreamingDataImporter()
 StreamingDataImporter::~StreamingDataImporter() = default;
 
 ImportResult StreamingDataImporter::ExecuteImport(const ImportConfig& config) {
-  ImportResult result;
-  result.import_id = config.import_id;
-  result.status = Status::Ok();
-  result.started_at = std::chrono::system_clock::now();
-  
-  // Track active import
-  ImportProgress progress;
-  progress.import_id = config.import_id;
-  progress.status_message = "Starting import...";
-  progress.total_rows = config.total_rows_hint;
-  impl_->active_imports[config.import_id] = progress;
-  
-  if (impl_->progress_callback) {
-    impl_->progress_callback(progress);
-  }
-  
-  // Simulate import processing
-  result.total_rows_processed = 0;
-  result.total_rows_inserted = 0;
-  
-  // Move from active to completed
-  impl_->active_imports.erase(config.import_id);
-  result.completed_at = std::chrono::system_clock::now();
-  impl_->completed_imports[config.import_id] = result;
-  
-  if (impl_->completion_callback) {
-    impl_->completion_callback(result);
-  }
-  
-  return result;
+  auto errors = ValidateImportConfig(config);
+  if (!errors.empty()) {
+    ImportResult result;
+    result.import_id = config.import_id;
+    result.status = Status::Error(errors.front().error_message);
+    return result;
+  }
+  return impl_->Run(config, nullptr, nullptr);
 }
 
 void StreamingDataImporter::ExecuteImportAsync(const ImportConfig& config) {
-  ExecuteImport(config);
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  impl_->async_threads.emplace_back([this, config] { ExecuteImport(config); });
 }
 
 Status StreamingDataImporter::StreamImport(const ImportConfig& config,
                                            RowCallback row_callback,
                                            CompletionCallback completion_callback) {
-  (void)config;
-  (void)row_callback;
-  (void)completion_callback;
-  return Status::Ok();
+  if (!row_callback) {
+    return Status::Error("Row callback is required");
+  }
+  const std::string null_text = config.csv_options.null_value;
+  return StreamImport(
+      config,
+      [&row_callback, &null_text](const ResultSet& batch, int64_t) {
+        std::map<std::string, std::string> row;
+        for (std::size_t r = 0; r < batch.RowCount(); ++r) {
+          for (std::size_t c = 0; c < batch.ColumnCount(); ++c) {
+            const ColumnBuffer& column = batch.Column(c);
+            row[batch.columns[c]] = column.IsNull(r) ? null_text : column.Format(r);
+          }
+          Status status = row_callback(row);
+          if (!status.ok) {
+            return status;
+          }
+        }
+        return Status::Ok();
+      },
+      std::move(completion_callback));
+}
+
+Status StreamingDataImporter::StreamImport(const ImportConfig& config,
+                                           BatchCallback batch_callback,
+                                           CompletionCallback completion_callback) {
+  if (!batch_callback) {
+    return Status::Error("Batch callback is required");
+  }
+  ImportResult result = impl_->Run(config, batch_callback, nullptr);
+  if (completion_callback) {
+    completion_callback(result);
+  }
+  return result.status;
 }
 
 void StreamingDataImporter::CancelImport(const std::string& import_id) {
-  auto it = impl_->active_imports.find(import_id);
-  if (it != impl_->active_imports.end()) {
-    it->second.status_message = "Cancelled";
+  if (auto control = impl_->Find(import_id)) {
+    std::lock_guard<std::mutex> lock(control->mutex);
+    control->cancelled = true;
+    control->progress.status_message = "Cancelled";
+    control->resume_cv.notify_all();
   }
 }
 
 void StreamingDataImporter::PauseImport(const std::string& import_id) {
-  auto it = impl_->active_imports.find(import_id);
-  if (it != impl_->active_imports.end()) {
-    it->second.status_message = "Paused";
+  if (auto control = impl_->Find(import_id)) {
+    std::lock_guard<std::mutex> lock(control->mutex);
+    control->paused = true;
+    control->progress.status_message = "Paused";
   }
 }
 
 void StreamingDataImporter::ResumeImport(const std::string& import_id) {
-  auto it = impl_->active_imports.find(import_id);
-  if (it != impl_->active_imports.end()) {
-    it->second.status_message = "Resumed";
+  if (auto control = impl_->Find(import_id)) {
+    std::lock_guard<std::mutex> lock(control->mutex);
+    control->paused = false;
+    control->progress.status_message = "Resumed";
+    control->resume_cv.notify_all();
   }
 }
 
 bool StreamingDataImporter::IsImportRunning(const std::string& import_id) const {
-  return impl_->active_imports.find(import_id) != impl_->active_imports.end();
+  return impl_->Find(import_id) != nullptr;
 }
 
 ImportProgress StreamingDataImporter::GetProgress(const std::string& import_id) const {
-  auto it = impl_->active_imports.find(import_id);
-  if (it != impl_->active_imports.end()) {
-    return it->second;
+  if (auto control = impl_->Find(import_id)) {
+    std::lock_guard<std::mutex> lock(control->mutex);
+    return control->progress;
   }
   return ImportProgress{};
 }
 
 std::optional<ImportResult> StreamingDataImporter::GetResult(const std::string& import_id) {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   auto it = impl_->completed_imports.find(import_id);
   if (it != impl_->completed_imports.end()) {
     return it->second;
@@ -116,19 +1294,27 @@ std::optional<ImportResult> StreamingDataImporter::GetResult(const std::string&
 
 std::vector<ValidationError> StreamingDataImporter::GetValidationErrors(
     const std::string& import_id) const {
-  (void)import_id;
-  return {};
+  if (auto control = impl_->Find(import_id)) {
+    std::lock_guard<std::mutex> lock(control->mutex);
+    return control->errors;
+  }
+  std::lock_guard<std::mutex> lock(impl_->mutex);
+  auto it = impl_->validation_errors.find(import_id);
+  return it == impl_->validation_errors.end() ? std::vector<ValidationError>{} : it->second;
 }
 
 void StreamingDataImporter::SetProgressCallback(ProgressCallback callback) {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   impl_->progress_callback = callback;
 }
 
 void StreamingDataImporter::SetErrorCallback(ErrorCallback callback) {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   impl_->error_callback = callback;
 }
 
 void StreamingDataImporter::SetCompletionCallback(CompletionCallback callback) {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   impl_->completion_callback = callback;
 }
 
@@ -137,11 +1323,52 @@ Status StreamingDataImporter::DetectSchema(const std::string& source_path,
                                            const CSVOptions& csv_opts,
                                            const JSONOptions& json_opts,
                                            std::vector<ColumnMapping>* detected_columns) {
-  (void)source_path;
-  (void)format;
-  (void)csv_opts;
   (void)json_opts;
-  (void)detected_columns;
+  if (format != ImportFormat::kCSV && !IsColumnar(format)) {
+    return Status::Error("Schema detection supports CSV, Parquet and Arrow sources only");
+  }
+  if (!detected_columns) {
+    return Status::Error("No output for detected columns");
+  }
+
+  ResultSet sample;
+  Status sampled = impl_->Sample(source_path, format, csv_opts, kPreviewSampleRows, &sample);
+  if (!sampled.ok) {
+    return sampled;
+  }
+
+  detected_columns->clear();
+  for (std::size_t col = 0; col < sample.ColumnCount(); ++col) {
+    const ColumnBuffer& column = sample.Column(col);
+    ColumnMapping mapping;
+    mapping.source_column = sample.columns[col];
+    mapping.target_column = sample.columns[col];
+    std::size_t longest = 0;
+    bool has_null = false;
+    for (std::size_t row = 0; row < column.Size(); ++row) {
+      if (column.IsNull(row)) {
+        has_null = true;
+      } else if (column.Type() == ColumnType::kText) {
+        longest = std::max(longest, column.TextAt(row).size());
+      }
+    }
+    switch (column.Type()) {
+      case ColumnType::kInt64:
+        mapping.data_type = "BIGINT";
+        break;
+      case ColumnType::kDouble:
+        mapping.data_type = "DOUBLE PRECISION";
+        break;
+      case ColumnType::kDate:
+        mapping.data_type = "DATE";
+        break;
+      default:
+        mapping.data_type = "VARCHAR(" + std::to_string(std::max<std::size_t>(longest, 1)) + ")";
+        break;
+    }
+    mapping.nullable = has_null || column.Size() == 0;
+    detected_columns->push_back(mapping);
+  }
   return Status::Ok();
 }
 
@@ -149,18 +1376,22 @@ Status StreamingDataImporter::PreviewData(const std::string& source_path,
                                           ImportFormat format,
                                           int max_rows,
                                           ResultSet* preview_data) {
-  (void)source_path;
-  (void)format;
-  (void)max_rows;
-  (void)preview_data;
-  return Status::Ok();
+  if (format != ImportFormat::kCSV && !IsColumnar(format)) {
+    return Status::Error("Preview supports CSV, Parquet and Arrow sources only");
+  }
+  if (!preview_data) {
+    return Status::Error("No output for preview");
+  }
+
+  return impl_->Sample(source_path, format, CSVOptions{},
+                       max_rows > 0 ? max_rows : kPreviewSampleRows, preview_data);
 }
 
 std::vector<ColumnMapping> StreamingDataImporter::AutoMapColumns(
     const std::vector<std::string>& source_columns,
     const std::vector<std::string>& target_columns) {
   std::vector<ColumnMapping> mappings;
-  
+
   for (const auto& source : source_columns) {
     for (const auto& target : target_columns) {
       if (source == target) {
@@ -172,30 +1403,56 @@ std::vector<ColumnMapping> StreamingDataImporter::AutoMapColumns(
       }
     }
   }
-  
+
   return mappings;
 }
 
 std::vector<ValidationError> StreamingDataImporter::ValidateImportConfig(
     const ImportConfig& config) {
   std::vector<ValidationError> errors;
-  
+
   if (config.target_table.empty()) {
     ValidationError error;
     error.error_message = "Target table is required";
     errors.push_back(error);
   }
-  
+  if (config.source_path.empty()) {
+    ValidationError error;
+    error.error_message = "Source path is required";
+    errors.push_back(error);
+  }
+  if (!config.connection && !config.bulk_client) {
+    ValidationError error;
+    error.error_message = "A connection is required";
+    errors.push_back(error);
+  }
+  CsvEncoding encoding;
+  if (config.format == ImportFormat::kCSV &&
+      !ParseCsvEncoding(config.csv_options.encoding, &encoding)) {
+    ValidationError error;
+    error.error_message = "Unsupported CSV encoding: " + config.csv_options.encoding;
+    errors.push_back(error);
+  }
+
   return errors;
 }
 
 void StreamingDataImporter::ClearCompletedImports() {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   impl_->completed_imports.clear();
+  impl_->validation_errors.clear();
 }
 
 void StreamingDataImporter::ClearAllImports() {
+  std::lock_guard<std::mutex> lock(impl_->mutex);
   impl_->completed_imports.clear();
-  impl_->active_imports.clear();
+  impl_->validation_errors.clear();
+  for (auto& [id, control] : impl_->active_imports) {
+    (void)id;
+    control->cancelled = true;
+    control->paused = false;
+    control->resume_cv.notify_all();
+  }
 }
 
 }  // namespace scratchrobin::core
@@ -19,13 +19,18 @@
 #include <string>
 #include <vector>
 
+#include "backend/scratchbird_connection.h"
 #include "core/result_set.h"
 #include "core/status.h"
 
+namespace scratchrobin::backend {
+class ScratchbirdSbwpClient;
+}  // namespace scratchrobin::backend
+
 namespace scratchrobin::core {
 
-// Forward declarations
-class Connection;
+// Imports write through backend connections (same alias as the executor)
+using Connection = backend::ScratchbirdConnection;
 
 // Import data formats
 enum class ImportFormat {
@@ -33,6 +38,7 @@ enum class ImportFormat {
   kJSON,
   kXML,
   kParquet,
+  kArrow,  // Arrow IPC stream or file
   kExcel,
   kFixedWidth,
   kCustom
@@ -55,7 +61,7 @@ struct CSVOptions {
   bool has_header{true};
   bool trim_whitespace{false};
   std::string null_value;
-  std::string encoding{"UTF-8"};
+  std::string encoding{"UTF-8"};  // Or ISO-8859-1 / Windows-1252, read as UTF-8
   int skip_lines{0};
   std::vector<int> ignore_columns;
 };
@@ -79,6 +85,24 @@ struct ColumnMapping {
   std::optional<std::string> default_value;
 };
 
+// Row predicate for columnar imports. |value| is read as the column's
+// type; text compares bytewise and NULLs pass only kIsNull.
+struct ImportFilter {
+  enum class Op {
+    kEqual,
+    kNotEqual,
+    kLess,
+    kLessEqual,
+    kGreater,
+    kGreaterEqual,
+    kIsNull,
+    kIsNotNull
+  };
+  std::string column;
+  Op op{Op::kEqual};
+  std::string value;
+};
+
 // Import configuration
 struct ImportConfig {
   std::string import_id;
@@ -88,6 +112,9 @@ struct ImportConfig {
   std::string target_table;
   std::string target_schema;
   std::shared_ptr<Connection> connection;
+  // When set, rows go through the client's pipelined bulk load instead of
+  // INSERTs on |connection|
+  std::shared_ptr<backend::ScratchbirdSbwpClient> bulk_client;
   
   // Format-specific options
   CSVOptions csv_options;
@@ -97,8 +124,17 @@ struct ImportConfig {
   // Column mappings
   std::vector<ColumnMapping> column_mappings;
   bool auto_map_columns{true};
+  bool quote_identifiers{false};  // Quote target names even when not required
+
+  // Parquet and Arrow sources: columns to read, in this order (empty =
+  // all), and filters every imported row must pass. Row groups whose
+  // statistics rule a filter out are not decoded.
+  std::vector<std::string> select_columns;
+  std::vector<ImportFilter> filters;
   
   // Performance options
+  int parallelism{0};  // Parser threads; 0 = hardware concurrency
+  int64_t chunk_size_bytes{0};  // Bytes per parse chunk; 0 = 8 MiB
   int batch_size{1000};
   int commit_frequency{10000};
   bool use_transactions{true};
@@ -168,6 +204,9 @@ class StreamingDataImporter {
   using ProgressCallback = std::function<void(const ImportProgress&)>;
   using ErrorCallback = std::function<bool(const ValidationError&)>;
   using RowCallback = std::function<Status(const std::map<std::string, std::string>&)>;
+  // Typed rows of one parsed chunk; |first_row| is the 1-based data row
+  // number of batch row 0
+  using BatchCallback = std::function<Status(const ResultSet& batch, int64_t first_row)>;
   using CompletionCallback = std::function<void(const ImportResult&)>;
 
   StreamingDataImporter();
@@ -185,6 +224,9 @@ class StreamingDataImporter {
   Status StreamImport(const ImportConfig& config,
                       RowCallback row_callback,
                       CompletionCallback completion_callback = nullptr);
+  Status StreamImport(const ImportConfig& config,
+                      BatchCallback batch_callback,
+                      CompletionCallback completion_callback = nullptr);
   
   // Import control
   void CancelImport(const std::string& import_id);
@@ -0,0 +1,705 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/table_diff.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace scratchrobin::core {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Server key hashes are reduced to 56 bits so they stay positive
+constexpr const char* kKeyHashModulus = "72057594037927936";
+constexpr uint64_t kKeyHashLimit = uint64_t{1} << 56;
+// Ranges per query, keeping IN lists a reasonable size
+constexpr std::size_t kRangesPerQuery = 512;
+
+int64_t ElapsedMs(Clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count();
+}
+
+uint64_t Mix(uint64_t value) {
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9ull;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+// fanout^depth; depths are checked against kKeyHashLimit before use
+uint64_t Modulus(int fanout, int depth) {
+  uint64_t modulus = 1;
+  for (int i = 0; i < depth; ++i) {
+    modulus *= static_cast<uint64_t>(fanout);
+  }
+  return modulus;
+}
+
+std::string JoinColumns(const std::vector<std::string>& columns) {
+  std::string joined;
+  for (const auto& column : columns) {
+    if (!joined.empty()) joined += ", ";
+    joined += column;
+  }
+  return joined;
+}
+
+// Text of a row for the server hash: NULL and '' differ, columns are
+// separated. Values are cut at 8191 characters, the longest VARCHAR every
+// server casts to.
+std::string TextExpression(const std::vector<std::string>& columns) {
+  std::string expression;
+  for (const auto& column : columns) {
+    if (!expression.empty()) expression += " || '|' || ";
+    expression += "COALESCE('=' || CAST(" + column + " AS VARCHAR(8191)), '~')";
+  }
+  return expression;
+}
+
+// Ranges grouped by depth, each group cut into batches of kRangesPerQuery
+std::vector<std::vector<TableDiffRange>> Batches(const std::vector<TableDiffRange>& ranges) {
+  std::map<int, std::vector<TableDiffRange>> by_depth;
+  for (const auto& range : ranges) {
+    by_depth[range.depth].push_back(range);
+  }
+  std::vector<std::vector<TableDiffRange>> batches;
+  for (auto& [depth, group] : by_depth) {
+    for (std::size_t i = 0; i < group.size(); i += kRangesPerQuery) {
+      const std::size_t end = std::min(group.size(), i + kRangesPerQuery);
+      batches.emplace_back(group.begin() + i, group.begin() + end);
+    }
+  }
+  return batches;
+}
+
+// The WHERE condition selecting rows of a batch of same-depth ranges
+std::string RangeFilter(const std::vector<TableDiffRange>& ranges, int fanout,
+                        const std::string& key_hash) {
+  if (ranges.empty() || ranges.front().depth == 0) {
+    return "1 = 1";
+  }
+  std::string filter =
+      "MOD(" + key_hash + ", " + std::to_string(Modulus(fanout, ranges.front().depth)) + ") IN (";
+  for (std::size_t i = 0; i < ranges.size(); ++i) {
+    if (i > 0) filter += ", ";
+    filter += std::to_string(ranges[i].index);
+  }
+  return filter + ")";
+}
+
+// Client-side membership test for ranges of any depth
+class RangeSet {
+ public:
+  RangeSet(const std::vector<TableDiffRange>& ranges, int fanout) {
+    for (const auto& range : ranges) {
+      auto it = std::find_if(depths_.begin(), depths_.end(),
+                             [&](const Depth& depth) { return depth.depth == range.depth; });
+      if (it == depths_.end()) {
+        depths_.push_back({range.depth, Modulus(fanout, range.depth), {}});
+        it = depths_.end() - 1;
+      }
+      it->indexes.insert(range.index);
+    }
+  }
+
+  bool Contains(uint64_t key_hash) const {
+    for (const auto& depth : depths_) {
+      if (depth.indexes.count(key_hash % depth.modulus) > 0) return true;
+    }
+    return false;
+  }
+
+ private:
+  struct Depth {
+    int depth;
+    uint64_t modulus;
+    std::unordered_set<uint64_t> indexes;
+  };
+  std::vector<Depth> depths_;
+};
+
+std::string KeyString(const std::vector<std::string>& key) {
+  std::string joined;
+  for (const auto& part : key) {
+    joined += part;
+    joined += '\x1f';
+  }
+  return joined;
+}
+
+std::optional<std::string> Normalize(const std::optional<std::string>& value,
+                                     const TableDiffOptions& options) {
+  if (!value || (!options.ignore_case && !options.trim_whitespace)) {
+    return value;
+  }
+  std::string text = *value;
+  if (options.trim_whitespace) {
+    const auto first = text.find_first_not_of(" \t\r\n");
+    const auto last = text.find_last_not_of(" \t\r\n");
+    text = first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+  }
+  if (options.ignore_case) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  }
+  return text;
+}
+
+void DiffRows(std::vector<TableDiffRow> source, std::vector<TableDiffRow> target,
+              const TableDiffOptions& options, TableDiffResult* result) {
+  std::unordered_map<std::string, std::size_t> target_by_key;
+  target_by_key.reserve(target.size());
+  for (std::size_t i = 0; i < target.size(); ++i) {
+    target_by_key.emplace(KeyString(target[i].key), i);
+  }
+  for (auto& row : source) {
+    auto it = target_by_key.find(KeyString(row.key));
+    if (it == target_by_key.end()) {
+      ++result->source_only;
+      result->rows.push_back({TableRowDiffKind::kSourceOnly, std::move(row.key),
+                              std::move(row.values), {}, {}});
+      continue;
+    }
+    TableDiffRow& other = target[it->second];
+    target_by_key.erase(it);
+    std::vector<std::size_t> changed;
+    const std::size_t columns = std::max(row.values.size(), other.values.size());
+    for (std::size_t c = 0; c < columns; ++c) {
+      const auto source_value = c < row.values.size() ? row.values[c] : std::nullopt;
+      const auto target_value = c < other.values.size() ? other.values[c] : std::nullopt;
+      if (Normalize(source_value, options) != Normalize(target_value, options)) {
+        changed.push_back(c);
+      }
+    }
+    if (!changed.empty()) {
+      ++result->changed;
+      result->rows.push_back({TableRowDiffKind::kChanged, std::move(row.key),
+                              std::move(row.values), std::move(other.values),
+                              std::move(changed)});
+    }
+  }
+  for (const auto& [key, index] : target_by_key) {
+    ++result->target_only;
+    result->rows.push_back({TableRowDiffKind::kTargetOnly, std::move(target[index].key), {},
+                            std::move(target[index].values), {}});
+  }
+}
+
+// Runs the source and target halves of a step concurrently
+void RunBoth(const std::function<void()>& source, const std::function<void()>& target) {
+  std::thread worker(source);
+  target();
+  worker.join();
+}
+
+std::string Literal(const std::optional<std::string>& value) {
+  if (!value) {
+    return "NULL";
+  }
+  std::string literal = "'";
+  for (char c : *value) {
+    literal += c;
+    if (c == '\'') literal += '\'';
+  }
+  return literal + "'";
+}
+
+std::string KeyCondition(const std::vector<std::string>& key_columns,
+                         const std::vector<std::string>& key) {
+  std::string condition;
+  for (std::size_t i = 0; i < key_columns.size() && i < key.size(); ++i) {
+    if (i > 0) condition += " AND ";
+    condition += key_columns[i] + " = " + Literal(key[i]);
+  }
+  return condition;
+}
+
+}  // namespace
+
+uint64_t TableDiffHash(std::string_view bytes, uint64_t seed) {
+  // Eight bytes per multiply; the tail is folded in with its length
+  uint64_t hash = Mix(seed ^ (bytes.size() * 0x9e3779b97f4a7c15ull));
+  std::size_t i = 0;
+  for (; i + 8 <= bytes.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes.data() + i, sizeof(word));
+    hash = (hash ^ Mix(word)) * 0x9e3779b97f4a7c15ull;
+    hash ^= hash >> 32;
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, bytes.data() + i, bytes.size() - i);
+  return Mix(hash ^ tail);
+}
+
+// ============================================================================
+// SqlTableDiffSource
+// ============================================================================
+
+SqlTableDiffSource::SqlTableDiffSource(TableDiffTable table, QueryFunction query,
+                                       std::string hash_function)
+    : table_(std::move(table)),
+      query_(std::move(query)),
+      hash_function_(std::move(hash_function)) {}
+
+Status SqlTableDiffSource::ResolveColumns() {
+  if (resolved_) {
+    return Status::Ok();
+  }
+  if (table_.key_columns.empty()) {
+    return Status::Error("Table diff needs key columns for " + table_.table);
+  }
+  if (table_.columns.empty()) {
+    ResultSet result;
+    Status status = query_("SELECT * FROM " + table_.table + " WHERE 1 = 0", &result);
+    if (!status.ok) {
+      return status;
+    }
+    auto lower = [](std::string text) {
+      std::transform(text.begin(), text.end(), text.begin(),
+                     [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+      return text;
+    };
+    for (const auto& column : result.columns) {
+      const bool is_key = std::any_of(
+          table_.key_columns.begin(), table_.key_columns.end(),
+          [&](const std::string& key) { return lower(key) == lower(column); });
+      if (!is_key) {
+        table_.columns.push_back(column);
+      }
+    }
+  }
+  resolved_ = true;
+  return Status::Ok();
+}
+
+Status SqlTableDiffSource::Columns(std::vector<std::string>* columns) {
+  Status status = ResolveColumns();
+  if (status.ok) {
+    *columns = table_.columns;
+  }
+  return status;
+}
+
+std::string SqlTableDiffSource::SelectList() const {
+  std::string list = JoinColumns(table_.key_columns);
+  if (!table_.columns.empty()) {
+    list += ", " + JoinColumns(table_.columns);
+  }
+  return list;
+}
+
+std::string SqlTableDiffSource::HashedSelect() const {
+  std::vector<std::string> row_columns = table_.key_columns;
+  row_columns.insert(row_columns.end(), table_.columns.begin(), table_.columns.end());
+  std::string sql = "SELECT ABS(MOD(" + hash_function_ + "(" +
+                    TextExpression(table_.key_columns) + "), " + kKeyHashModulus +
+                    ")) AS diff_key_hash, " + hash_function_ + "(" +
+                    TextExpression(row_columns) + ") AS diff_row_hash FROM " + table_.table;
+  if (!table_.where.empty()) {
+    sql += " WHERE " + table_.where;
+  }
+  return sql;
+}
+
+std::string SqlTableDiffSource::SummarizeSql(const std::vector<TableDiffRange>& ranges,
+                                             int fanout) const {
+  const int depth = ranges.empty() ? 0 : ranges.front().depth;
+  const std::string bucket =
+      "MOD(diff_key_hash, " + std::to_string(Modulus(fanout, depth + 1)) + ")";
+  // Sums of the two 32-bit halves cannot overflow 64 bits below 2^31 rows
+  return "SELECT " + bucket + " AS diff_bucket, COUNT(*) AS diff_rows, "
+         "SUM(MOD(diff_row_hash, 4294967296)) AS diff_low, "
+         "SUM(MOD(diff_row_hash / 4294967296, 4294967296)) AS diff_high FROM (" +
+         HashedSelect() + ") diff_hashes WHERE " +
+         RangeFilter(ranges, fanout, "diff_key_hash") + " GROUP BY " + bucket;
+}
+
+std::string SqlTableDiffSource::FetchSql(const std::vector<TableDiffRange>& ranges,
+                                         int fanout) const {
+  std::string sql = "SELECT " + SelectList() + " FROM " + table_.table + " WHERE ";
+  if (!table_.where.empty()) {
+    sql += "(" + table_.where + ") AND ";
+  }
+  const std::string key_hash = "ABS(MOD(" + hash_function_ + "(" +
+                               TextExpression(table_.key_columns) + "), " + kKeyHashModulus +
+                               "))";
+  return sql + RangeFilter(ranges, fanout, key_hash);
+}
+
+Status SqlTableDiffSource::Scan(int fanout) {
+  std::string sql = "SELECT " + SelectList() + " FROM " + table_.table;
+  if (!table_.where.empty()) {
+    sql += " WHERE " + table_.where;
+  }
+  scanned_ = false;
+  scan_ = ResultSet{};
+  scan_hashes_.clear();
+  Status status = query_(sql, &scan_);
+  if (!status.ok) {
+    return status;
+  }
+  const std::size_t keys = table_.key_columns.size();
+  scan_hashes_.resize(scan_.RowCount());
+  std::string text;
+  for (std::size_t row = 0; row < scan_.RowCount(); ++row) {
+    const auto ref = scan_.rows[row];
+    text.clear();
+    for (std::size_t col = 0; col < keys; ++col) {
+      text += ref[col];
+      text += '\x1f';
+    }
+    scan_hashes_[row].key_hash = TableDiffHash(text) % kKeyHashLimit;
+    text.clear();
+    for (std::size_t col = 0; col < scan_.ColumnCount(); ++col) {
+      text += ref.isNull(col) ? std::string("~") : "=" + ref[col];
+      text += '\x1f';
+    }
+    scan_hashes_[row].row_hash = Mix(TableDiffHash(text));
+  }
+  scanned_ = true;
+  BuildLevels(fanout);
+  return Status::Ok();
+}
+
+void SqlTableDiffSource::BuildLevels(int fanout) {
+  // Down to the first level with at least as many chunks as rows
+  std::vector<uint64_t> moduli;
+  for (uint64_t modulus = fanout; modulus <= kKeyHashLimit;
+       modulus *= static_cast<uint64_t>(fanout)) {
+    moduli.push_back(modulus);
+    if (modulus >= scan_hashes_.size() || modulus > kKeyHashLimit / moduli.front()) break;
+  }
+  levels_.assign(moduli.size(), {});
+  levels_fanout_ = fanout;
+  for (const auto& row : scan_hashes_) {
+    for (std::size_t d = 0; d < moduli.size(); ++d) {
+      const uint64_t index = row.key_hash % moduli[d];
+      TableDiffChunk& chunk = levels_[d][index];
+      chunk.range = {static_cast<int>(d) + 1, index};
+      ++chunk.rows;
+      chunk.hash += row.row_hash;
+    }
+  }
+}
+
+Status SqlTableDiffSource::Summarize(const std::vector<TableDiffRange>& ranges, int fanout,
+                                     std::vector<TableDiffChunk>* chunks) {
+  Status status = ResolveColumns();
+  if (!status.ok) {
+    return status;
+  }
+  if (!hash_function_.empty()) {
+    for (const auto& batch : Batches(ranges)) {
+      ResultSet result;
+      status = query_(SummarizeSql(batch, fanout), &result);
+      if (!status.ok) {
+        return status;
+      }
+      for (const auto row : result.rows) {
+        TableDiffChunk chunk;
+        chunk.range = {batch.front().depth + 1, std::stoull(row[0])};
+        chunk.rows = std::stoll(row[1]);
+        chunk.hash = TableDiffHash(row[2]) ^ TableDiffHash(row[3], 1);
+        chunks->push_back(chunk);
+      }
+    }
+    return Status::Ok();
+  }
+
+  // Summarizing the whole table starts a new diff, so it reads the table
+  // again; every other level comes from that read
+  const bool whole = std::any_of(ranges.begin(), ranges.end(),
+                                 [](const TableDiffRange& range) { return range.depth == 0; });
+  if (whole || !scanned_) {
+    status = Scan(fanout);
+    if (!status.ok) {
+      return status;
+    }
+  } else if (fanout != levels_fanout_) {
+    BuildLevels(fanout);
+  }
+
+  // The children of (d, i) are (d + 1, i + k * fanout^d)
+  std::vector<TableDiffRange> deeper;
+  for (const auto& range : ranges) {
+    if (static_cast<std::size_t>(range.depth) >= levels_.size()) {
+      deeper.push_back(range);
+      continue;
+    }
+    const auto& level = levels_[range.depth];
+    const uint64_t step = Modulus(fanout, range.depth);
+    for (int k = 0; k < fanout; ++k) {
+      const auto it = level.find(range.index + static_cast<uint64_t>(k) * step);
+      if (it != level.end()) {
+        chunks->push_back(it->second);
+      }
+    }
+  }
+  if (deeper.empty()) {
+    return Status::Ok();
+  }
+
+  // Past the levels built, sum the rows of each child directly
+  const RangeSet wanted(deeper, fanout);
+  std::unordered_map<uint64_t, TableDiffChunk> by_child;
+  for (const auto& row : scan_hashes_) {
+    if (!wanted.Contains(row.key_hash)) {
+      continue;
+    }
+    // A row's range at the next depth follows from its own hash
+    int depth = 0;
+    for (const auto& range : deeper) {
+      if (row.key_hash % Modulus(fanout, range.depth) == range.index) {
+        depth = range.depth + 1;
+        break;
+      }
+    }
+    const uint64_t index = row.key_hash % Modulus(fanout, depth);
+    TableDiffChunk& chunk = by_child[index];
+    chunk.range = {depth, index};
+    ++chunk.rows;
+    chunk.hash += row.row_hash;
+  }
+  for (const auto& [index, chunk] : by_child) {
+    chunks->push_back(chunk);
+  }
+  return Status::Ok();
+}
+
+Status SqlTableDiffSource::FetchRows(const std::vector<TableDiffRange>& ranges, int fanout,
+                                     std::vector<TableDiffRow>* rows) {
+  Status status = ResolveColumns();
+  if (!status.ok) {
+    return status;
+  }
+  const std::size_t keys = table_.key_columns.size();
+  auto append = [&](const ResultSet& result, std::size_t row) {
+    const auto ref = result.rows[row];
+    TableDiffRow diff_row;
+    for (std::size_t col = 0; col < result.ColumnCount(); ++col) {
+      if (col < keys) {
+        diff_row.key.push_back(ref[col]);
+      } else if (ref.isNull(col)) {
+        diff_row.values.emplace_back();
+      } else {
+        diff_row.values.emplace_back(ref[col]);
+      }
+    }
+    rows->push_back(std::move(diff_row));
+  };
+
+  if (!hash_function_.empty()) {
+    for (const auto& batch : Batches(ranges)) {
+      ResultSet result;
+      status = query_(FetchSql(batch, fanout), &result);
+      if (!status.ok) {
+        return status;
+      }
+      for (std::size_t row = 0; row < result.RowCount(); ++row) {
+        append(result, row);
+      }
+    }
+    return Status::Ok();
+  }
+
+  if (!scanned_) {
+    status = Scan(fanout);
+    if (!status.ok) {
+      return status;
+    }
+  }
+  const RangeSet wanted(ranges, fanout);
+  for (std::size_t row = 0; row < scan_hashes_.size(); ++row) {
+    if (wanted.Contains(scan_hashes_[row].key_hash)) {
+      append(scan_, row);
+    }
+  }
+  return Status::Ok();
+}
+
+// ============================================================================
+// TableDiff
+// ============================================================================
+
+TableDiff::TableDiff(std::shared_ptr<TableDiffSource> source,
+                     std::shared_ptr<TableDiffSource> target)
+    : source_(std::move(source)), target_(std::move(target)) {}
+
+void TableDiff::Cancel() {
+  cancelled_ = true;
+}
+
+TableDiffResult TableDiff::Run(const TableDiffOptions& options) {
+  const auto started = Clock::now();
+  TableDiffResult result;
+  result.status = Status::Ok();
+
+  const int fanout = std::clamp(options.fanout, 2, 1 << 16);
+  int depth_limit = 0;  // Deepest depth with fanout^depth within the key hash
+  for (uint64_t modulus = 1; modulus <= kKeyHashLimit / fanout; modulus *= fanout) {
+    ++depth_limit;
+  }
+  const int max_depth = std::clamp(options.max_depth, 1, depth_limit);
+
+  std::vector<std::string> target_columns;
+  Status source_status;
+  Status target_status;
+  RunBoth([&] { source_status = source_->Columns(&result.columns); },
+          [&] { target_status = target_->Columns(&target_columns); });
+  if (!source_status.ok || !target_status.ok) {
+    result.status = source_status.ok ? target_status : source_status;
+    return result;
+  }
+  if (result.columns.size() != target_columns.size()) {
+    result.status = Status::Error("Source and target compare a different number of columns");
+    return result;
+  }
+
+  std::vector<TableDiffRange> ranges{TableDiffRange{}};
+  while (!ranges.empty()) {
+    if (cancelled_) {
+      result.cancelled = true;
+      break;
+    }
+    ++result.levels;
+    std::vector<TableDiffChunk> source_chunks;
+    std::vector<TableDiffChunk> target_chunks;
+    RunBoth([&] { source_status = source_->Summarize(ranges, fanout, &source_chunks); },
+            [&] { target_status = target_->Summarize(ranges, fanout, &target_chunks); });
+    if (!source_status.ok || !target_status.ok) {
+      result.status = source_status.ok ? target_status : source_status;
+      break;
+    }
+    result.chunks_compared += static_cast<int64_t>(source_chunks.size() + target_chunks.size());
+    if (ranges.front().depth == 0) {
+      for (const auto& chunk : source_chunks) result.source_rows += chunk.rows;
+      for (const auto& chunk : target_chunks) result.target_rows += chunk.rows;
+    }
+
+    // Pair chunks by range; a chunk missing on one side is empty there
+    auto by_range = [](const TableDiffChunk& a, const TableDiffChunk& b) {
+      return a.range.depth != b.range.depth ? a.range.depth < b.range.depth
+                                            : a.range.index < b.range.index;
+    };
+    std::sort(source_chunks.begin(), source_chunks.end(), by_range);
+    std::sort(target_chunks.begin(), target_chunks.end(), by_range);
+    std::vector<TableDiffRange> next;
+    std::vector<TableDiffRange> source_leaves;
+    std::vector<TableDiffRange> target_leaves;
+    std::size_t s = 0;
+    std::size_t t = 0;
+    while (s < source_chunks.size() || t < target_chunks.size()) {
+      TableDiffChunk source_chunk;
+      TableDiffChunk target_chunk;
+      if (t == target_chunks.size() ||
+          (s < source_chunks.size() && by_range(source_chunks[s], target_chunks[t]))) {
+        source_chunk = source_chunks[s++];
+        target_chunk.range = source_chunk.range;
+      } else if (s == source_chunks.size() || by_range(target_chunks[t], source_chunks[s])) {
+        target_chunk = target_chunks[t++];
+        source_chunk.range = target_chunk.range;
+      } else {
+        source_chunk = source_chunks[s++];
+        target_chunk = target_chunks[t++];
+      }
+      if (source_chunk.rows == target_chunk.rows && source_chunk.hash == target_chunk.hash) {
+        continue;
+      }
+      const TableDiffRange& range = source_chunk.range;
+      if (std::max(source_chunk.rows, target_chunk.rows) > options.leaf_rows &&
+          range.depth < max_depth) {
+        next.push_back(range);
+        continue;
+      }
+      if (source_chunk.rows > 0) source_leaves.push_back(range);
+      if (target_chunk.rows > 0) target_leaves.push_back(range);
+    }
+
+    if (!source_leaves.empty() || !target_leaves.empty()) {
+      std::vector<TableDiffRow> source_rows;
+      std::vector<TableDiffRow> target_rows;
+      RunBoth(
+          [&] {
+            source_status = source_leaves.empty()
+                                ? Status::Ok()
+                                : source_->FetchRows(source_leaves, fanout, &source_rows);
+          },
+          [&] {
+            target_status = target_leaves.empty()
+                                ? Status::Ok()
+                                : target_->FetchRows(target_leaves, fanout, &target_rows);
+          });
+      if (!source_status.ok || !target_status.ok) {
+        result.status = source_status.ok ? target_status : source_status;
+        break;
+      }
+      result.rows_fetched += static_cast<int64_t>(source_rows.size() + target_rows.size());
+      DiffRows(std::move(source_rows), std::move(target_rows), options, &result);
+    }
+    ranges = std::move(next);
+  }
+
+  std::sort(result.rows.begin(), result.rows.end(),
+            [](const TableRowDiff& a, const TableRowDiff& b) { return a.key < b.key; });
+  result.equal_rows = result.source_rows - result.changed - result.source_only;
+  result.elapsed_ms = ElapsedMs(started);
+  return result;
+}
+
+std::string TableDiff::SyncScript(const TableDiffResult& result, const std::string& table,
+                                  const std::vector<std::string>& key_columns) {
+  std::string script;
+  std::string columns = JoinColumns(key_columns);
+  if (!result.columns.empty()) {
+    columns += ", " + JoinColumns(result.columns);
+  }
+  for (const auto& row : result.rows) {
+    switch (row.kind) {
+      case TableRowDiffKind::kSourceOnly: {
+        std::string values;
+        for (const auto& part : row.key) {
+          values += (values.empty() ? "" : ", ") + Literal(part);
+        }
+        for (const auto& value : row.source) {
+          values += ", " + Literal(value);
+        }
+        script += "INSERT INTO " + table + " (" + columns + ") VALUES (" + values + ");\n";
+        break;
+      }
+      case TableRowDiffKind::kTargetOnly:
+        script += "DELETE FROM " + table + " WHERE " + KeyCondition(key_columns, row.key) +
+                  ";\n";
+        break;
+      case TableRowDiffKind::kChanged: {
+        std::string assignments;
+        for (std::size_t column : row.changed_columns) {
+          if (column >= result.columns.size()) continue;
+          if (!assignments.empty()) assignments += ", ";
+          assignments += result.columns[column] + " = " +
+                         Literal(column < row.source.size() ? row.source[column]
+                                                            : std::nullopt);
+        }
+        script += "UPDATE " + table + " SET " + assignments + " WHERE " +
+                  KeyCondition(key_columns, row.key) + ";\n";
+        break;
+      }
+    }
+  }
+  return script;
+}
+
+}  // namespace scratchrobin::core
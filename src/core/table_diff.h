@@ -0,0 +1,212 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/result_set.h"
+#include "core/status.h"
+
+namespace scratchrobin::core {
+
+// Rows whose key hash h has h mod fanout^depth == index. Depth 0 is the
+// whole table; the children of (d, i) are (d + 1, i + k * fanout^d).
+struct TableDiffRange {
+  int depth = 0;
+  uint64_t index = 0;
+};
+
+struct TableDiffChunk {
+  TableDiffRange range;
+  int64_t rows = 0;
+  uint64_t hash = 0;  // Order-independent over the rows of the chunk
+};
+
+struct TableDiffRow {
+  std::vector<std::string> key;
+  std::vector<std::optional<std::string>> values;  // Compared columns; nullopt is NULL
+};
+
+/**
+ * TableDiffSource - one side of a table diff
+ *
+ * Both sides of a diff must hash keys and rows the same way, so a chunk
+ * holding the same rows gets the same hash on either side.
+ */
+class TableDiffSource {
+ public:
+  virtual ~TableDiffSource() = default;
+
+  // Names of the compared columns, in the order of TableDiffRow::values
+  virtual Status Columns(std::vector<std::string>* columns) = 0;
+
+  // Splits every range into its fanout children and returns the non-empty
+  // ones, in any order
+  virtual Status Summarize(const std::vector<TableDiffRange>& ranges, int fanout,
+                           std::vector<TableDiffChunk>* chunks) = 0;
+
+  // Rows falling in any of |ranges|, in any order
+  virtual Status FetchRows(const std::vector<TableDiffRange>& ranges, int fanout,
+                           std::vector<TableDiffRow>* rows) = 0;
+};
+
+// A table read through SQL
+struct TableDiffTable {
+  std::string table;
+  std::vector<std::string> key_columns;
+  std::vector<std::string> columns;  // Empty: every column that is not a key
+  std::string where;                 // Optional filter, applied on the server
+};
+
+/**
+ * SqlTableDiffSource - a TableDiffSource issuing queries
+ *
+ * With a server hash function, key and row hashes are computed by the
+ * server and Summarize() transfers one row per chunk: a 500M-row table
+ * costs a few hundred rows per level when it is nearly identical to the
+ * other side. The server hashes each column as text cast to VARCHAR(8191),
+ * so values differing only past their 8191st character hash alike; the
+ * client-side hash below reads whole values.
+ *
+ * Without a hash function, the table is read once, when the whole table
+ * is summarized, and hashed here: that single pass sums the chunks of
+ * every level, and later levels and FetchRows() are answered from it
+ * without another query. The rows read stay held until the next scan.
+ */
+class SqlTableDiffSource : public TableDiffSource {
+ public:
+  using QueryFunction = std::function<Status(const std::string& sql, ResultSet* result)>;
+
+  // |hash_function| maps a string to a 64-bit integer on the server,
+  // e.g. "HASH"; empty hashes on the client
+  SqlTableDiffSource(TableDiffTable table, QueryFunction query, std::string hash_function);
+
+  Status Columns(std::vector<std::string>* columns) override;
+  Status Summarize(const std::vector<TableDiffRange>& ranges, int fanout,
+                   std::vector<TableDiffChunk>* chunks) override;
+  Status FetchRows(const std::vector<TableDiffRange>& ranges, int fanout,
+                   std::vector<TableDiffRow>* rows) override;
+
+  // The SQL of Summarize() and FetchRows() for a batch of ranges
+  std::string SummarizeSql(const std::vector<TableDiffRange>& ranges, int fanout) const;
+  std::string FetchSql(const std::vector<TableDiffRange>& ranges, int fanout) const;
+
+ private:
+  Status ResolveColumns();
+  std::string HashedSelect() const;
+  std::string SelectList() const;
+  // Client hashing: reads the table and sums the chunks of each level
+  Status Scan(int fanout);
+  void BuildLevels(int fanout);
+
+  struct ScannedRow {
+    uint64_t key_hash = 0;
+    uint64_t row_hash = 0;
+  };
+
+  TableDiffTable table_;
+  QueryFunction query_;
+  std::string hash_function_;
+  bool resolved_ = false;
+  bool scanned_ = false;
+  ResultSet scan_;                        // The rows read by Scan()
+  std::vector<ScannedRow> scan_hashes_;   // By row of scan_
+  int levels_fanout_ = 0;
+  // levels_[d - 1]: the non-empty chunks at depth d, by index; deeper
+  // levels than these hold about a row per chunk
+  std::vector<std::unordered_map<uint64_t, TableDiffChunk>> levels_;
+};
+
+enum class TableRowDiffKind : std::uint8_t {
+  kChanged,
+  kSourceOnly,
+  kTargetOnly,
+};
+
+struct TableRowDiff {
+  TableRowDiffKind kind = TableRowDiffKind::kChanged;
+  std::vector<std::string> key;
+  std::vector<std::optional<std::string>> source;  // Empty for kTargetOnly
+  std::vector<std::optional<std::string>> target;  // Empty for kSourceOnly
+  std::vector<std::size_t> changed_columns;        // kChanged only
+};
+
+struct TableDiffOptions {
+  int fanout = 64;          // Children per chunk
+  int64_t leaf_rows = 2000; // Mismatching chunks this small fetch their rows
+  int max_depth = 6;        // Chunks this deep fetch their rows whatever their size
+  bool ignore_case = false;
+  bool trim_whitespace = false;
+};
+
+struct TableDiffResult {
+  Status status;
+  std::vector<std::string> columns;
+  std::vector<TableRowDiff> rows;  // Ordered by key
+  int64_t source_rows = 0;
+  int64_t target_rows = 0;
+  int64_t equal_rows = 0;
+  int64_t changed = 0;
+  int64_t source_only = 0;
+  int64_t target_only = 0;
+  int64_t chunks_compared = 0;  // Chunk summaries read, both sides
+  int64_t rows_fetched = 0;     // Rows read to diff mismatching chunks, both sides
+  int levels = 0;
+  int64_t elapsed_ms = 0;
+  bool cancelled = false;
+};
+
+/**
+ * TableDiff - row-level diff of two tables by hashed key ranges
+ *
+ * Both sides summarize the whole table as fanout chunks of a row count and
+ * a hash; equal chunks are done, and only mismatching ones are split again.
+ * A mismatching chunk at most leaf_rows big has its rows fetched from both
+ * sides and matched by key. The two sides are queried concurrently, so
+ * give them separate connections.
+ *
+ * With ignore_case or trim_whitespace, chunks differing only that way are
+ * still fetched, but their rows compare equal.
+ */
+class TableDiff {
+ public:
+  TableDiff(std::shared_ptr<TableDiffSource> source, std::shared_ptr<TableDiffSource> target);
+
+  TableDiff(const TableDiff&) = delete;
+  TableDiff& operator=(const TableDiff&) = delete;
+
+  // Blocks until the diff is complete, failed or was cancelled
+  TableDiffResult Run(const TableDiffOptions& options);
+
+  // Stops before the next round of queries, of this and any later Run();
+  // safe from any thread
+  void Cancel();
+
+  // INSERT, UPDATE and DELETE statements making |table| on the target
+  // match the source
+  static std::string SyncScript(const TableDiffResult& result, const std::string& table,
+                                const std::vector<std::string>& key_columns);
+
+ private:
+  std::shared_ptr<TableDiffSource> source_;
+  std::shared_ptr<TableDiffSource> target_;
+  std::atomic<bool> cancelled_{false};
+};
+
+// Fast 64-bit hash of a byte string, used for client-side hashing
+uint64_t TableDiffHash(std::string_view bytes, uint64_t seed = 0);
+
+}  // namespace scratchrobin::core
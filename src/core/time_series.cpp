@@ -0,0 +1,538 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#include "core/time_series.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace scratchrobin::core {
+
+namespace {
+
+constexpr int64_t kSecondMs = 1000;
+constexpr int64_t kMinuteMs = 60 * kSecondMs;
+constexpr int64_t kHourMs = 60 * kMinuteMs;
+constexpr uint8_t kNoWindow = 0xFF;
+
+uint64_t ToBits(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double FromBits(uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+int64_t FloorTo(int64_t time_ms, int64_t width) {
+  const int64_t q = time_ms / width;
+  return (time_ms % width < 0 ? q - 1 : q) * width;
+}
+
+class BitReader {
+ public:
+  explicit BitReader(const std::vector<uint64_t>& words) : words_(words) {}
+
+  uint64_t Read(unsigned bits) {
+    if (bits == 0) {
+      return 0;
+    }
+    const std::size_t word = static_cast<std::size_t>(position_ / 64);
+    const unsigned offset = static_cast<unsigned>(position_ % 64);
+    const unsigned free = 64 - offset;
+    position_ += bits;
+    if (bits <= free) {
+      const uint64_t value = words_[word] >> (free - bits);
+      return bits == 64 ? value : value & ((uint64_t{1} << bits) - 1);
+    }
+    const unsigned rest = bits - free;
+    const uint64_t high = words_[word] & ((uint64_t{1} << free) - 1);
+    return (high << rest) | (words_[word + 1] >> (64 - rest));
+  }
+
+  bool ReadBit() { return Read(1) != 0; }
+
+ private:
+  const std::vector<uint64_t>& words_;
+  uint64_t position_ = 0;
+};
+
+}  // namespace
+
+// ============================================================================
+// TimeSeriesRing
+// ============================================================================
+
+TimeSeriesRing::TimeSeriesRing(std::size_t columns, int64_t retention_ms,
+                               int64_t min_spacing_ms, std::size_t block_points)
+    : columns_(columns),
+      retention_ms_(retention_ms),
+      block_points_(std::max<std::size_t>(block_points, 2)) {
+  const int64_t capacity = std::max<int64_t>(retention_ms / std::max<int64_t>(min_spacing_ms, 1), 1);
+  // One more block for the oldest one, which is partly past the retention
+  max_blocks_ = static_cast<std::size_t>(capacity + block_points_ - 1) / block_points_ + 1;
+}
+
+bool TimeSeriesRing::Append(int64_t time_ms, const double* values) {
+  if (size_ > 0 && time_ms < BlockAt(size_ - 1).last_time) {
+    return false;
+  }
+  if (size_ == 0 || BlockAt(size_ - 1).count >= block_points_) {
+    if (size_ == max_blocks_) {
+      DropOldest();
+    }
+    if (blocks_.size() < max_blocks_) {
+      blocks_.emplace_back();  // Still growing: head_ is 0
+    }
+    ++size_;
+    Block& block = BlockAt(size_ - 1);
+    block.words.clear();  // Keeps the capacity of a reused block
+    block.bits = 0;
+    block.count = 0;
+  }
+  Encode(BlockAt(size_ - 1), time_ms, values);
+
+  while (size_ > 1 && BlockAt(0).last_time < time_ms - retention_ms_) {
+    DropOldest();
+  }
+  return true;
+}
+
+void TimeSeriesRing::DropOldest() {
+  evicted_ = true;
+  if (blocks_.size() < max_blocks_) {
+    blocks_.erase(blocks_.begin());
+  } else {
+    head_ = (head_ + 1) % blocks_.size();
+  }
+  --size_;
+}
+
+int64_t TimeSeriesRing::OldestTime() const {
+  return size_ == 0 ? 0 : BlockAt(0).first_time;
+}
+
+int64_t TimeSeriesRing::NewestTime() const {
+  return size_ == 0 ? 0 : BlockAt(size_ - 1).last_time;
+}
+
+std::size_t TimeSeriesRing::PointCount() const {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < size_; ++i) {
+    count += BlockAt(i).count;
+  }
+  return count;
+}
+
+std::size_t TimeSeriesRing::MemoryUsage() const {
+  std::size_t bytes = blocks_.capacity() * sizeof(Block);
+  for (const Block& block : blocks_) {
+    bytes += block.words.capacity() * sizeof(uint64_t) +
+             block.last_values.capacity() * sizeof(uint64_t) +
+             block.leading.capacity() + block.trailing.capacity();
+  }
+  return bytes;
+}
+
+void TimeSeriesRing::Clear() {
+  blocks_.clear();
+  head_ = 0;
+  size_ = 0;
+  evicted_ = false;
+}
+
+void TimeSeriesRing::Write(Block& block, uint64_t value, unsigned bits) {
+  if (bits == 0) {
+    return;
+  }
+  if (bits < 64) {
+    value &= (uint64_t{1} << bits) - 1;
+  }
+  const std::size_t word = static_cast<std::size_t>(block.bits / 64);
+  const unsigned offset = static_cast<unsigned>(block.bits % 64);
+  const unsigned free = 64 - offset;
+  if (word == block.words.size()) {
+    block.words.push_back(0);
+  }
+  if (bits <= free) {
+    block.words[word] |= value << (free - bits);
+  } else {
+    const unsigned rest = bits - free;
+    block.words[word] |= value >> rest;
+    block.words.push_back(value << (64 - rest));
+  }
+  block.bits += bits;
+}
+
+void TimeSeriesRing::Encode(Block& block, int64_t time_ms, const double* values) {
+  if (block.count == 0) {
+    block.first_time = time_ms;
+    block.last_delta = 0;
+    block.last_values.assign(columns_, 0);
+    block.leading.assign(columns_, kNoWindow);
+    block.trailing.assign(columns_, 0);
+    Write(block, static_cast<uint64_t>(time_ms), 64);
+    for (std::size_t c = 0; c < columns_; ++c) {
+      block.last_values[c] = ToBits(values[c]);
+      Write(block, block.last_values[c], 64);
+    }
+    block.last_time = time_ms;
+    ++block.count;
+    return;
+  }
+
+  // Timestamp: delta of delta, small for regular sampling
+  const int64_t delta = time_ms - block.last_time;
+  const int64_t dod = delta - block.last_delta;
+  if (dod == 0) {
+    Write(block, 0b0, 1);
+  } else if (dod >= -63 && dod <= 64) {
+    Write(block, 0b10, 2);
+    Write(block, static_cast<uint64_t>(dod + 63), 7);
+  } else if (dod >= -255 && dod <= 256) {
+    Write(block, 0b110, 3);
+    Write(block, static_cast<uint64_t>(dod + 255), 9);
+  } else if (dod >= -2047 && dod <= 2048) {
+    Write(block, 0b1110, 4);
+    Write(block, static_cast<uint64_t>(dod + 2047), 12);
+  } else {
+    Write(block, 0b1111, 4);
+    Write(block, static_cast<uint64_t>(dod), 64);
+  }
+  block.last_delta = delta;
+  block.last_time = time_ms;
+
+  // Values: XOR with the previous one, meaningful bits only
+  for (std::size_t c = 0; c < columns_; ++c) {
+    const uint64_t bits = ToBits(values[c]);
+    const uint64_t x = bits ^ block.last_values[c];
+    block.last_values[c] = bits;
+    if (x == 0) {
+      Write(block, 0b0, 1);
+      continue;
+    }
+    const unsigned leading = std::min(static_cast<unsigned>(std::countl_zero(x)), 31u);
+    const unsigned trailing = static_cast<unsigned>(std::countr_zero(x));
+    if (block.leading[c] != kNoWindow && leading >= block.leading[c] &&
+        trailing >= block.trailing[c]) {
+      Write(block, 0b10, 2);
+      Write(block, x >> block.trailing[c], 64 - block.leading[c] - block.trailing[c]);
+    } else {
+      const unsigned length = 64 - leading - trailing;
+      Write(block, 0b11, 2);
+      Write(block, leading, 5);
+      Write(block, length == 64 ? 0 : length, 6);
+      Write(block, x >> trailing, length);
+      block.leading[c] = static_cast<uint8_t>(leading);
+      block.trailing[c] = static_cast<uint8_t>(trailing);
+    }
+  }
+  ++block.count;
+}
+
+void TimeSeriesRing::Decode(const Block& block, int64_t from_ms, int64_t to_ms,
+                            std::vector<std::pair<int64_t, std::vector<double>>>* points) const {
+  BitReader reader(block.words);
+  std::vector<uint64_t> values(columns_);
+  std::vector<unsigned> leading(columns_, kNoWindow);
+  std::vector<unsigned> trailing(columns_, 0);
+  int64_t time = static_cast<int64_t>(reader.Read(64));
+  int64_t delta = 0;
+  for (std::size_t c = 0; c < columns_; ++c) {
+    values[c] = reader.Read(64);
+  }
+
+  for (std::size_t i = 0; i < block.count; ++i) {
+    if (i > 0) {
+      int64_t dod = 0;
+      if (!reader.ReadBit()) {
+        dod = 0;
+      } else if (!reader.ReadBit()) {
+        dod = static_cast<int64_t>(reader.Read(7)) - 63;
+      } else if (!reader.ReadBit()) {
+        dod = static_cast<int64_t>(reader.Read(9)) - 255;
+      } else if (!reader.ReadBit()) {
+        dod = static_cast<int64_t>(reader.Read(12)) - 2047;
+      } else {
+        dod = static_cast<int64_t>(reader.Read(64));
+      }
+      delta += dod;
+      time += delta;
+
+      for (std::size_t c = 0; c < columns_; ++c) {
+        if (!reader.ReadBit()) {
+          continue;
+        }
+        if (reader.ReadBit()) {
+          leading[c] = static_cast<unsigned>(reader.Read(5));
+          unsigned length = static_cast<unsigned>(reader.Read(6));
+          if (length == 0) {
+            length = 64;
+          }
+          trailing[c] = 64 - leading[c] - length;
+        }
+        const unsigned length = 64 - leading[c] - trailing[c];
+        values[c] ^= reader.Read(length) << trailing[c];
+      }
+    }
+    if (time >= to_ms) {
+      break;
+    }
+    if (time >= from_ms) {
+      std::vector<double> row(columns_);
+      for (std::size_t c = 0; c < columns_; ++c) {
+        row[c] = FromBits(values[c]);
+      }
+      points->emplace_back(time, std::move(row));
+    }
+  }
+}
+
+// ============================================================================
+// TimeSeries
+// ============================================================================
+
+void TimeSeries::Bucket::Add(double value_sum, double low, double high, int64_t n) {
+  if (count == 0) {
+    min = low;
+    max = high;
+  } else {
+    min = std::min(min, low);
+    max = std::max(max, high);
+  }
+  sum += value_sum;
+  count += n;
+}
+
+TimeSeriesPoint TimeSeries::Bucket::Point() const {
+  TimeSeriesPoint point;
+  point.time_ms = start;
+  point.value = count > 0 ? sum / static_cast<double>(count) : 0.0;
+  point.min = min;
+  point.max = max;
+  point.count = count;
+  return point;
+}
+
+TimeSeries::TimeSeries(const TimeSeriesOptions& options)
+    : raw_(1, options.raw_retention_ms, kSecondMs, options.block_points),
+      minutes_(4, options.minute_retention_ms, kMinuteMs, options.block_points),
+      hours_(4, options.hour_retention_ms, kHourMs, options.block_points) {}
+
+bool TimeSeries::Append(int64_t time_ms, double value) {
+  if (time_ms < last_time_) {
+    return false;
+  }
+  if (minute_.start >= 0 && time_ms >= minute_.start + kMinuteMs) {
+    CloseMinute();
+  }
+  if (minute_.start < 0) {
+    minute_.start = FloorTo(time_ms, kMinuteMs);
+  }
+  minute_.Add(value, value, value, 1);
+
+  // One raw point per second, so sampling jitter does not drop any
+  if (last_raw_time_ < 0 || FloorTo(time_ms, kSecondMs) != FloorTo(last_raw_time_, kSecondMs)) {
+    raw_.Append(time_ms, &value);
+    last_raw_time_ = time_ms;
+  }
+  last_time_ = time_ms;
+  return true;
+}
+
+void TimeSeries::CloseMinute() {
+  const TimeSeriesPoint point = minute_.Point();
+  const double columns[] = {point.value, point.min, point.max,
+                            static_cast<double>(point.count)};
+  minutes_.Append(point.time_ms, columns);
+
+  if (hour_.start >= 0 && minute_.start >= hour_.start + kHourMs) {
+    CloseHour();
+  }
+  if (hour_.start < 0) {
+    hour_.start = FloorTo(minute_.start, kHourMs);
+  }
+  hour_.Add(minute_.sum, minute_.min, minute_.max, minute_.count);
+  minute_ = Bucket();
+}
+
+void TimeSeries::CloseHour() {
+  const TimeSeriesPoint point = hour_.Point();
+  const double columns[] = {point.value, point.min, point.max,
+                            static_cast<double>(point.count)};
+  hours_.Append(point.time_ms, columns);
+  hour_ = Bucket();
+}
+
+TimeSeriesResolution TimeSeries::Resolve(int64_t from_ms,
+                                         TimeSeriesResolution resolution) const {
+  if (resolution != TimeSeriesResolution::kAuto) {
+    return resolution;
+  }
+  // A tier that never dropped a point holds all there is
+  if (!raw_.Evicted() || raw_.OldestTime() <= from_ms) {
+    return TimeSeriesResolution::kRaw;
+  }
+  if (!minutes_.Evicted() || minutes_.OldestTime() <= from_ms) {
+    return TimeSeriesResolution::kMinute;
+  }
+  return TimeSeriesResolution::kHour;
+}
+
+std::vector<TimeSeriesPoint> TimeSeries::Range(int64_t from_ms, int64_t to_ms,
+                                               TimeSeriesResolution resolution) const {
+  std::vector<TimeSeriesPoint> points;
+  auto rollup = [&points](int64_t time, const double* values) {
+    TimeSeriesPoint point;
+    point.time_ms = time;
+    point.value = values[0];
+    point.min = values[1];
+    point.max = values[2];
+    point.count = static_cast<int64_t>(std::llround(values[3]));
+    points.push_back(point);
+  };
+
+  switch (Resolve(from_ms, resolution)) {
+    case TimeSeriesResolution::kAuto:
+    case TimeSeriesResolution::kRaw:
+      raw_.Scan(from_ms, to_ms, [&points](int64_t time, const double* values) {
+        points.push_back(TimeSeriesPoint{time, values[0], values[0], values[0], 1});
+      });
+      break;
+
+    case TimeSeriesResolution::kMinute:
+      // Buckets overlapping the range count, not just those starting in it
+      minutes_.Scan(from_ms - kMinuteMs + 1, to_ms, rollup);
+      if (minute_.start >= 0 && minute_.start < to_ms && minute_.start + kMinuteMs > from_ms) {
+        points.push_back(minute_.Point());
+      }
+      break;
+
+    case TimeSeriesResolution::kHour: {
+      hours_.Scan(from_ms - kHourMs + 1, to_ms, rollup);
+      // The open hour plus the open minute, which is not folded in yet
+      Bucket open = hour_;
+      if (minute_.start >= 0) {
+        if (open.start >= 0 && minute_.start >= open.start + kHourMs) {
+          TimeSeriesPoint closed = open.Point();
+          if (closed.time_ms < to_ms && closed.time_ms + kHourMs > from_ms) {
+            points.push_back(closed);
+          }
+          open = Bucket();
+        }
+        if (open.start < 0) {
+          open.start = FloorTo(minute_.start, kHourMs);
+        }
+        open.Add(minute_.sum, minute_.min, minute_.max, minute_.count);
+      }
+      if (open.start >= 0 && open.start < to_ms && open.start + kHourMs > from_ms) {
+        points.push_back(open.Point());
+      }
+      break;
+    }
+  }
+  return points;
+}
+
+std::size_t TimeSeries::MemoryUsage() const {
+  return sizeof(*this) + raw_.MemoryUsage() + minutes_.MemoryUsage() + hours_.MemoryUsage();
+}
+
+void TimeSeries::Clear() {
+  raw_.Clear();
+  minutes_.Clear();
+  hours_.Clear();
+  minute_ = Bucket();
+  hour_ = Bucket();
+  last_time_ = -1;
+  last_raw_time_ = -1;
+}
+
+// ============================================================================
+// TimeSeriesStore
+// ============================================================================
+
+TimeSeriesStore::TimeSeriesStore(TimeSeriesOptions options) : options_(options) {}
+
+bool TimeSeriesStore::Append(const std::string& name, int64_t time_ms, double value) {
+  auto it = series_.find(name);
+  if (it == series_.end()) {
+    it = series_.emplace(name, TimeSeries(options_)).first;
+  }
+  return it->second.Append(time_ms, value);
+}
+
+std::vector<TimeSeriesPoint> TimeSeriesStore::Range(const std::string& name, int64_t from_ms,
+                                                    int64_t to_ms,
+                                                    TimeSeriesResolution resolution) const {
+  auto it = series_.find(name);
+  if (it == series_.end()) {
+    return {};
+  }
+  return it->second.Range(from_ms, to_ms, resolution);
+}
+
+TimeSeriesResolution TimeSeriesStore::Resolve(const std::string& name, int64_t from_ms,
+                                              TimeSeriesResolution resolution) const {
+  auto it = series_.find(name);
+  if (it == series_.end()) {
+    return resolution == TimeSeriesResolution::kAuto ? TimeSeriesResolution::kRaw : resolution;
+  }
+  return it->second.Resolve(from_ms, resolution);
+}
+
+std::vector<TimeSeriesStore::Row> TimeSeriesStore::Rows(const std::vector<std::string>& names,
+                                                        int64_t from_ms, int64_t to_ms,
+                                                        TimeSeriesResolution resolution) const {
+  if (names.empty()) {
+    return {};
+  }
+  const TimeSeriesResolution resolved = Resolve(names[0], from_ms, resolution);
+  std::map<int64_t, std::vector<double>> rows;
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    for (const TimeSeriesPoint& point : Range(names[i], from_ms, to_ms, resolved)) {
+      auto& values = rows[point.time_ms];
+      values.resize(names.size());
+      values[i] = point.value;
+    }
+  }
+  std::vector<Row> result;
+  result.reserve(rows.size());
+  for (auto& [time, values] : rows) {
+    result.push_back(Row{time, std::move(values)});
+  }
+  return result;
+}
+
+std::vector<std::string> TimeSeriesStore::Names() const {
+  std::vector<std::string> names;
+  names.reserve(series_.size());
+  for (const auto& [name, series] : series_) {
+    (void)series;
+    names.push_back(name);
+  }
+  return names;
+}
+
+std::size_t TimeSeriesStore::MemoryUsage() const {
+  std::size_t bytes = sizeof(*this);
+  for (const auto& [name, series] : series_) {
+    bytes += name.capacity() + series.MemoryUsage();
+  }
+  return bytes;
+}
+
+void TimeSeriesStore::Clear() {
+  series_.clear();
+}
+
+}  // namespace scratchrobin::core
@@ -0,0 +1,231 @@
+/*
+ * ScratchRobin
+ * Copyright (c) 2025-2026 Dalton Calford
+ *
+ * Licensed under the Initial Developer's Public License Version 1.0
+ */
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace scratchrobin::core {
+
+enum class TimeSeriesResolution : std::uint8_t {
+  kAuto,    // The finest tier still holding the start of the range
+  kRaw,     // As appended, at most one point per second
+  kMinute,  // One rollup per minute
+  kHour,    // One rollup per hour
+};
+
+// A raw point has value == min == max and count 1; a rollup has the mean
+// of its bucket in value
+struct TimeSeriesPoint {
+  int64_t time_ms = 0;  // Rollups: start of the bucket
+  double value = 0.0;
+  double min = 0.0;
+  double max = 0.0;
+  int64_t count = 0;
+};
+
+struct TimeSeriesOptions {
+  int64_t raw_retention_ms = 60LL * 60 * 1000;               // 1 hour
+  int64_t minute_retention_ms = 2LL * 24 * 60 * 60 * 1000;   // 2 days
+  int64_t hour_retention_ms = 35LL * 24 * 60 * 60 * 1000;    // 5 weeks
+  std::size_t block_points = 120;  // Points per compressed block
+};
+
+/**
+ * TimeSeriesRing - compressed points in a fixed ring of blocks
+ *
+ * Points are Gorilla-encoded: timestamps as delta-of-delta, each value
+ * column XORed with its previous value, so a point of a steady gauge takes
+ * a few bits. Blocks are appended to until full and then sealed; once the
+ * ring is full the oldest block is cleared and reused, so memory stays at
+ * what the ring first grew to. Points older than the retention are dropped
+ * a block at a time.
+ */
+class TimeSeriesRing {
+ public:
+  // |columns| values per point; room for |retention_ms| of points no
+  // closer than |min_spacing_ms|
+  TimeSeriesRing(std::size_t columns, int64_t retention_ms, int64_t min_spacing_ms,
+                 std::size_t block_points);
+
+  // Points must come in time order; returns false for an older one
+  bool Append(int64_t time_ms, const double* values);
+
+  // Points with from_ms <= time < to_ms; |visit| gets the time and the
+  // columns
+  template <typename Visit>
+  void Scan(int64_t from_ms, int64_t to_ms, Visit visit) const;
+
+  bool Empty() const { return size_ == 0; }
+  int64_t OldestTime() const;
+  int64_t NewestTime() const;
+  bool Evicted() const { return evicted_; }  // Has ever dropped points
+  std::size_t PointCount() const;
+  std::size_t MemoryUsage() const;
+  void Clear();
+
+ private:
+  struct Block {
+    std::vector<uint64_t> words;
+    uint64_t bits = 0;
+    std::size_t count = 0;
+    int64_t first_time = 0;
+    int64_t last_time = 0;
+    // Encoder state of the open block
+    int64_t last_delta = 0;
+    std::vector<uint64_t> last_values;
+    std::vector<uint8_t> leading;
+    std::vector<uint8_t> trailing;
+  };
+
+  void Write(Block& block, uint64_t value, unsigned bits);
+  void Encode(Block& block, int64_t time_ms, const double* values);
+  void Decode(const Block& block, int64_t from_ms, int64_t to_ms,
+              std::vector<std::pair<int64_t, std::vector<double>>>* points) const;
+  Block& BlockAt(std::size_t i) { return blocks_[(head_ + i) % blocks_.size()]; }
+  const Block& BlockAt(std::size_t i) const { return blocks_[(head_ + i) % blocks_.size()]; }
+  void DropOldest();
+
+  std::size_t columns_;
+  int64_t retention_ms_;
+  std::size_t block_points_;
+  std::size_t max_blocks_;
+  std::vector<Block> blocks_;  // Ring, grown up to max_blocks_
+  std::size_t head_ = 0;       // Oldest block
+  std::size_t size_ = 0;       // Blocks in use
+  bool evicted_ = false;
+};
+
+/**
+ * TimeSeries - one metric at three resolutions
+ *
+ * Every point goes to the raw ring and into the open minute bucket; a
+ * closed minute bucket is written to the minute ring and folded into the
+ * open hour bucket. Append() is O(1). Range() includes the open buckets,
+ * so the latest minute and hour are never missing.
+ */
+class TimeSeries {
+ public:
+  explicit TimeSeries(const TimeSeriesOptions& options = TimeSeriesOptions());
+
+  bool Append(int64_t time_ms, double value);
+  std::vector<TimeSeriesPoint> Range(int64_t from_ms, int64_t to_ms,
+                                     TimeSeriesResolution resolution) const;
+  TimeSeriesResolution Resolve(int64_t from_ms, TimeSeriesResolution resolution) const;
+
+  bool Empty() const { return last_time_ < 0; }
+  int64_t LastTime() const { return last_time_; }
+  std::size_t MemoryUsage() const;
+  void Clear();
+
+ private:
+  struct Bucket {
+    int64_t start = -1;  // -1: empty
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    int64_t count = 0;
+
+    void Add(double value_sum, double low, double high, int64_t n);
+    TimeSeriesPoint Point() const;
+  };
+
+  void CloseMinute();
+  void CloseHour();
+
+  TimeSeriesRing raw_;
+  TimeSeriesRing minutes_;  // value, min, max, count
+  TimeSeriesRing hours_;
+  Bucket minute_;
+  Bucket hour_;
+  int64_t last_time_ = -1;
+  int64_t last_raw_time_ = -1;
+};
+
+/**
+ * TimeSeriesStore - named series sharing one set of options
+ *
+ * Rows of metrics recorded at one time land at the same timestamps in
+ * every series, so Rows() can put them back together.
+ */
+class TimeSeriesStore {
+ public:
+  explicit TimeSeriesStore(TimeSeriesOptions options = TimeSeriesOptions());
+
+  bool Append(const std::string& name, int64_t time_ms, double value);
+  std::vector<TimeSeriesPoint> Range(const std::string& name, int64_t from_ms, int64_t to_ms,
+                                     TimeSeriesResolution resolution) const;
+
+  // The points of |names| at each time any of them has one, at the one
+  // resolution Resolve() picks for the first; missing values are 0
+  struct Row {
+    int64_t time_ms = 0;
+    std::vector<double> values;  // In the order of |names|
+  };
+  std::vector<Row> Rows(const std::vector<std::string>& names, int64_t from_ms, int64_t to_ms,
+                        TimeSeriesResolution resolution) const;
+  TimeSeriesResolution Resolve(const std::string& name, int64_t from_ms,
+                               TimeSeriesResolution resolution) const;
+
+  bool Contains(const std::string& name) const { return series_.count(name) != 0; }
+  std::vector<std::string> Names() const;
+  std::size_t MemoryUsage() const;
+  void Clear();
+
+ private:
+  TimeSeriesOptions options_;
+  std::map<std::string, TimeSeries> series_;
+};
+
+// A numeric member of a metrics struct, kept as one series of a store;
+// integers come back rounded from rollup means
+template <typename Record>
+struct TimeSeriesField {
+  const char* name;
+  std::variant<double Record::*, int64_t Record::*, int Record::*> member;
+
+  double Get(const Record& record) const {
+    return std::visit([&record](auto field) { return static_cast<double>(record.*field); },
+                      member);
+  }
+
+  void Set(Record* record, double value) const {
+    std::visit([record, value](auto field) {
+      using Value = std::remove_reference_t<decltype(record->*field)>;
+      if constexpr (std::is_floating_point_v<Value>) {
+        record->*field = value;
+      } else {
+        record->*field = static_cast<Value>(std::llround(value));
+      }
+    }, member);
+  }
+};
+
+template <typename Visit>
+void TimeSeriesRing::Scan(int64_t from_ms, int64_t to_ms, Visit visit) const {
+  std::vector<std::pair<int64_t, std::vector<double>>> points;
+  for (std::size_t i = 0; i < size_; ++i) {
+    const Block& block = BlockAt(i);
+    if (block.count == 0 || block.last_time < from_ms || block.first_time >= to_ms) {
+      continue;
+    }
+    points.clear();
+    Decode(block, from_ms, to_ms, &points);
+    for (const auto& [time, values] : points) {
+      visit(time, values.data());
+    }
+  }
+}
+
+}  // namespace scratchrobin::core
@@ -1,5 +1,7 @@
 #include "ui/bulk_data_loader.h"
+#include "backend/scratchbird_sbwp_client.h"
 #include "backend/session_client.h"
+#include "core/streaming_data_importer.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -21,6 +23,7 @@
 #include <QMessageBox>
 #include <QHeaderView>
 #include <QDialogButtonBox>
+#include <QMetaObject>
 
 namespace scratchrobin::ui {
 
@@ -30,12 +33,17 @@ namespace scratchrobin::ui {
 BulkDataLoaderPanel::BulkDataLoaderPanel(backend::SessionClient* client, QWidget* parent)
     : DockPanel("bulk_data_loader", parent)
     , client_(client)
+    , importer_(std::make_unique<core::StreamingDataImporter>())
 {
     setupUi();
     setupModel();
 }
 
-BulkDataLoaderPanel::~BulkDataLoaderPanel() = default;
+BulkDataLoaderPanel::~BulkDataLoaderPanel()
+{
+    // Cancels and joins a running load before the panel goes away
+    importer_.reset();
+}
 
 void BulkDataLoaderPanel::setupUi()
 {
@@ -228,21 +236,66 @@ void BulkDataLoaderPanel::onStartLoad()
         return;
     }
     
-    isLoading_ = true;
-    isPaused_ = false;
+    const auto* runtime = client_ ? client_->GetRuntimeConfig() : nullptr;
+    if (!runtime) {
+        QMessageBox::warning(this, tr("Error"), tr("No ScratchBird connection is configured."));
+        return;
+    }
     
     currentLoad_.sourceFile = sourceEdit_->text();
     currentLoad_.targetTable = targetTableCombo_->currentText();
+    currentLoad_.format = QFileInfo(currentLoad_.sourceFile).suffix().toLower();
     currentLoad_.batchSize = batchSizeSpin_->value();
     currentLoad_.threadCount = threadCountSpin_->value();
     currentLoad_.useTransactions = useTransactionsCheck_->isChecked();
     currentLoad_.truncateFirst = truncateCheck_->isChecked();
     currentLoad_.validateData = validateDataCheck_->isChecked();
     currentLoad_.started = QDateTime::currentDateTime();
+    currentLoad_.processedRows = 0;
+    currentLoad_.errorCount = 0;
+    
+    if (currentLoad_.format == "json") {
+        QMessageBox::warning(this, tr("Error"), tr("Bulk loading supports CSV and TSV files."));
+        return;
+    }
+    
+    core::ImportConfig config;
+    importId_ = "bulk_load_" + std::to_string(QDateTime::currentMSecsSinceEpoch());
+    config.import_id = importId_;
+    config.source_path = currentLoad_.sourceFile.toStdString();
+    const QString target = currentLoad_.targetTable;
+    const int dot = target.indexOf('.');
+    if (dot > 0) {
+        config.target_schema = target.left(dot).toStdString();
+        config.target_table = target.mid(dot + 1).toStdString();
+    } else {
+        config.target_table = target.toStdString();
+    }
+    config.mode = currentLoad_.truncateFirst ? core::ImportMode::kReplace
+                                             : core::ImportMode::kAppend;
+    config.csv_options.delimiter = currentLoad_.format == "tsv" ? '\t' : ',';
+    config.batch_size = currentLoad_.batchSize;
+    config.parallelism = currentLoad_.threadCount;
+    config.use_transactions = currentLoad_.useTransactions;
+    config.validate_data = currentLoad_.validateData;
+    config.max_errors = 0;  // Bad rows are reported, never fatal
+    config.bulk_client = std::make_shared<backend::ScratchbirdSbwpClient>(*runtime);
+    
+    const auto problems = importer_->ValidateImportConfig(config);
+    if (!problems.empty()) {
+        QMessageBox::warning(this, tr("Error"),
+            QString::fromStdString(problems.front().error_message));
+        return;
+    }
+    
+    isLoading_ = true;
+    isPaused_ = false;
+    loadErrors_.clear();
     
     startBtn_->setEnabled(false);
     pauseBtn_->setEnabled(true);
     cancelBtn_->setEnabled(true);
+    progressBar_->setValue(0);
     
     logEdit_->append(tr("Starting bulk load..."));
     logEdit_->append(tr("Source: %1").arg(currentLoad_.sourceFile));
@@ -250,45 +303,65 @@ void BulkDataLoaderPanel::onStartLoad()
     
     emit loadStarted(currentLoad_.sourceFile);
     
-    // Start actual loading via SessionClient
-    if (client_) {
-        // Truncate table if requested
-        if (currentLoad_.truncateFirst) {
-            QString truncateSql = QString("TRUNCATE TABLE %1").arg(currentLoad_.targetTable);
-            client_->ExecuteSql(4044, "scratchbird", truncateSql.toStdString());
-            logEdit_->append(tr("Table truncated."));
-        }
-        
-        // Use COPY command for efficient bulk loading
-        // Note: Full implementation would parse CSV/TSV and stream data
-        QString copySql = QString("COPY %1 FROM '%2' WITH (FORMAT csv, HEADER)")
-            .arg(currentLoad_.targetTable)
-            .arg(currentLoad_.sourceFile);
-        
-        auto response = client_->ExecuteSql(4044, "scratchbird", copySql.toStdString());
-        
-        if (response.status.ok) {
-            progressBar_->setValue(100);
-            progressLabel_->setText(tr("Loading... 100%"));
-            logEdit_->append(tr("Load completed successfully."));
-            currentLoad_.processedRows = response.result_set.rows.size();
-            emit loadFinished(currentLoad_.processedRows, 0);
-        } else {
-            logEdit_->append(tr("Load failed: %1")
-                .arg(QString::fromStdString(response.status.message)));
-            emit loadFinished(0, 1);
-        }
-    } else {
-        // Simulate progress when offline
-        progressBar_->setValue(50);
-        progressLabel_->setText(tr("Loading... 50% (offline mode)"));
-    }
+    // Callbacks fire on the import thread; hop back to the UI thread
+    importer_->SetProgressCallback([this](const core::ImportProgress& progress) {
+        QMetaObject::invokeMethod(this, [this, progress]() {
+            if (!isLoading_) {
+                return;
+            }
+            currentLoad_.processedRows = progress.rows_processed;
+            currentLoad_.errorCount = progress.rows_failed;
+            if (progress.bytes_read > 0) {
+                currentLoad_.totalRows = progress.rows_read * progress.total_bytes
+                                         / progress.bytes_read;
+            }
+            const int percent = static_cast<int>(progress.percentage_complete);
+            progressBar_->setValue(percent);
+            progressLabel_->setText(tr("Loading... %1% (%2 rows/s)")
+                .arg(percent)
+                .arg(static_cast<qint64>(progress.rows_per_second)));
+            etaLabel_->setText(tr("ETA: %1 seconds")
+                .arg(progress.estimated_remaining.count() / 1000));
+            updateStats();
+            emit loadProgress(progress.rows_processed, currentLoad_.totalRows, percent);
+        }, Qt::QueuedConnection);
+    });
+    importer_->SetCompletionCallback([this](const core::ImportResult& result) {
+        QMetaObject::invokeMethod(this, [this, result]() {
+            currentLoad_.processedRows = result.total_rows_inserted;
+            currentLoad_.errorCount = result.total_rows_failed;
+            for (const auto& error : result.errors) {
+                loadErrors_.append(QString::fromStdString(error));
+            }
+            if (result.status.ok) {
+                progressBar_->setValue(100);
+                progressLabel_->setText(tr("Loaded %1 rows in %2 s")
+                    .arg(result.total_rows_inserted)
+                    .arg(result.total_duration.count() / 1000.0, 0, 'f', 1));
+                logEdit_->append(tr("Load completed: %1 rows loaded, %2 rejected.")
+                    .arg(result.total_rows_inserted)
+                    .arg(result.total_rows_failed));
+            } else {
+                logEdit_->append(tr("Load failed: %1")
+                    .arg(QString::fromStdString(result.status.message)));
+                emit loadError(QString::fromStdString(result.status.message));
+            }
+            finishLoad();
+            emit loadFinished(result.total_rows_inserted, result.total_rows_failed);
+        }, Qt::QueuedConnection);
+    });
+    importer_->ExecuteImportAsync(config);
 }
 
 void BulkDataLoaderPanel::onPauseLoad()
 {
     if (isLoading_) {
         isPaused_ = !isPaused_;
+        if (isPaused_) {
+            importer_->PauseImport(importId_);
+        } else {
+            importer_->ResumeImport(importId_);
+        }
         pauseBtn_->setText(isPaused_ ? tr("Resume") : tr("Pause"));
         logEdit_->append(isPaused_ ? tr("Load paused.") : tr("Load resumed."));
     }
@@ -296,11 +369,26 @@ void BulkDataLoaderPanel::onPauseLoad()
 
 void BulkDataLoaderPanel::onResumeLoad()
 {
+    if (isLoading_ && isPaused_) {
+        importer_->ResumeImport(importId_);
+    }
     isPaused_ = false;
     pauseBtn_->setText(tr("Pause"));
 }
 
 void BulkDataLoaderPanel::onCancelLoad()
+{
+    if (!isLoading_) {
+        return;
+    }
+    // The completion callback reports the rolled-back load
+    importer_->CancelImport(importId_);
+    cancelBtn_->setEnabled(false);
+    pauseBtn_->setEnabled(false);
+    logEdit_->append(tr("Cancelling load..."));
+}
+
+void BulkDataLoaderPanel::finishLoad()
 {
     isLoading_ = false;
     isPaused_ = false;
@@ -309,8 +397,7 @@ void BulkDataLoaderPanel::onCancelLoad()
     pauseBtn_->setEnabled(false);
     cancelBtn_->setEnabled(false);
     pauseBtn_->setText(tr("Pause"));
-    
-    logEdit_->append(tr("Load cancelled."));
+    updateStats();
 }
 
 void BulkDataLoaderPanel::onConfigureOptions()
@@ -321,13 +408,7 @@ void BulkDataLoaderPanel::onConfigureOptions()
 
 void BulkDataLoaderPanel::onViewErrors()
 {
-    QStringList errors;
-    
-    // Get errors from current load
-    if (currentLoad_.errorCount > 0) {
-        errors.append(tr("Row parsing errors occurred during load."));
-        errors.append(tr("Check source file format and data types."));
-    }
+    QStringList errors = loadErrors_;
     
     if (errors.isEmpty()) {
         errors.append(tr("No errors recorded."));
@@ -1,6 +1,10 @@
 #pragma once
 #include "ui/dock_workspace.h"
 #include <QDialog>
+#include <QStringList>
+
+#include <memory>
+#include <string>
 
 QT_BEGIN_NAMESPACE
 class QTableView;
@@ -22,17 +26,21 @@ namespace scratchrobin::backend {
 class SessionClient;
 }
 
+namespace scratchrobin::core {
+class StreamingDataImporter;
+}
+
 namespace scratchrobin::ui {
 
 /**
  * @brief Bulk Data Loader - High-performance data loading
  * 
  * Optimized for loading large datasets efficiently.
- * - Multi-threaded loading
- * - Batch insert optimization
- * - Progress tracking with ETA
- * - Resume capability
- * - Error handling and recovery
+ * - Multi-threaded parsing of memory-mapped CSV/TSV files
+ * - Pipelined SBWP bulk load: statements are built while earlier ones
+ *   are on the wire
+ * - Progress tracking with ETA, pause/resume and cancel
+ * - Bad rows are isolated and listed without aborting the load
  */
 
 // ============================================================================
@@ -121,9 +129,16 @@ private:
     QPushButton* pauseBtn_ = nullptr;
     QPushButton* cancelBtn_ = nullptr;
     
+    void finishLoad();
+    
     BulkLoadInfo currentLoad_;
     bool isLoading_ = false;
     bool isPaused_ = false;
+    
+    // Runs loads on its own threads; callbacks are queued back to the panel
+    std::unique_ptr<core::StreamingDataImporter> importer_;
+    std::string importId_;
+    QStringList loadErrors_;
 };
 
 // ============================================================================
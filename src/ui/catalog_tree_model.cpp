@@ -0,0 +1,382 @@
+#include "ui/catalog_tree_model.h"
+
+#include <QApplication>
+#include <QColor>
+#include <QFont>
+#include <QIcon>
+#include <QPointer>
+#include <QThreadPool>
+
+#include <map>
+#include <utility>
+
+#include "core/scratchbird_catalog_client.h"
+
+namespace scratchrobin::ui {
+
+namespace {
+
+QString KindName(CatalogTreeModel::NodeKind kind) {
+  switch (kind) {
+    case CatalogTreeModel::NodeKind::kSchema: return QStringLiteral("schema");
+    case CatalogTreeModel::NodeKind::kTable: return QStringLiteral("table");
+    case CatalogTreeModel::NodeKind::kColumn: return QStringLiteral("column");
+    case CatalogTreeModel::NodeKind::kIndex: return QStringLiteral("index");
+    default: return QString();
+  }
+}
+
+bool IsExpandable(CatalogTreeModel::NodeKind kind) {
+  return kind == CatalogTreeModel::NodeKind::kRoot ||
+         kind == CatalogTreeModel::NodeKind::kSchema ||
+         kind == CatalogTreeModel::NodeKind::kTable;
+}
+
+}  // namespace
+
+CatalogTreeModel::CatalogTreeModel(QObject* parent)
+    : QAbstractItemModel(parent) {
+  root_ = std::make_unique<Node>();
+}
+
+CatalogTreeModel::~CatalogTreeModel() = default;
+
+void CatalogTreeModel::setCatalogClient(std::shared_ptr<core::ScratchBirdCatalogClient> client) {
+  client_ = std::move(client);
+  search_text_.clear();
+  reload();
+}
+
+void CatalogTreeModel::reload(bool refresh_catalog) {
+  refresh_pending_ = refresh_catalog;
+  if (!search_text_.isEmpty()) {
+    startSearch();
+    return;
+  }
+  resetRoot(client_ ? LoadState::kUnloaded : LoadState::kLoaded);
+}
+
+void CatalogTreeModel::setSearchText(const QString& text) {
+  const QString trimmed = text.trimmed();
+  if (trimmed == search_text_) {
+    return;
+  }
+  search_text_ = trimmed;
+  reload();
+}
+
+// ============================================================================
+// Loading
+// ============================================================================
+
+void CatalogTreeModel::resetRoot(LoadState state) {
+  beginResetModel();
+  ++generation_;
+  root_ = std::make_unique<Node>();
+  root_->state = state;
+  endResetModel();
+}
+
+void CatalogTreeModel::startLoad(Node* node) {
+  node->state = LoadState::kLoading;
+  beginInsertRows(indexFor(node), 0, 0);
+  addChild(node, NodeKind::kPlaceholder, tr("Loading..."), QString());
+  endInsertRows();
+
+  const bool refresh = node == root_.get() && refresh_pending_;
+  refresh_pending_ = false;
+  auto client = client_;
+  const quint64 generation = generation_;
+  const NodeKind kind = node->kind;
+  const std::string schema = node->schema.toStdString();
+  const std::string table = node->table.toStdString();
+  QPointer<CatalogTreeModel> self(this);
+  QThreadPool::globalInstance()->start([=]() {
+    auto result = std::make_shared<LoadResult>(
+        LoadChildren(*client, kind, schema, table, refresh));
+    // Posted to the application object, which outlives the model; the
+    // generation check drops results for nodes a reset has since freed.
+    QMetaObject::invokeMethod(qApp, [self, generation, node, result]() {
+      if (self && self->generation_ == generation) {
+        self->finishLoad(node, std::move(*result));
+      }
+    }, Qt::QueuedConnection);
+  });
+}
+
+void CatalogTreeModel::finishLoad(Node* node, LoadResult result) {
+  const QModelIndex parent = indexFor(node);
+  if (!node->children.empty()) {  // The "Loading..." row
+    beginRemoveRows(parent, 0, static_cast<int>(node->children.size()) - 1);
+    node->children.clear();
+    endRemoveRows();
+  }
+
+  node->state = LoadState::kLoaded;
+  if (!result.error.isEmpty()) {
+    beginInsertRows(parent, 0, 0);
+    addChild(node, NodeKind::kPlaceholder, tr("Failed: %1").arg(result.error), QString());
+    endInsertRows();
+    emit loadFailed(result.error);
+    return;
+  }
+  if (result.children.empty()) {
+    return;
+  }
+  beginInsertRows(parent, 0, static_cast<int>(result.children.size()) - 1);
+  for (auto& spec : result.children) {
+    addChild(node, spec.kind, spec.name, spec.detail);
+  }
+  endInsertRows();
+}
+
+CatalogTreeModel::LoadResult CatalogTreeModel::LoadChildren(
+    core::ScratchBirdCatalogClient& client, NodeKind kind, const std::string& schema,
+    const std::string& table, bool refresh_catalog) {
+  LoadResult result;
+  core::Status status = core::Status::Ok();
+  if (refresh_catalog) {
+    status = client.RefreshCache();
+  }
+  if (status.ok && kind == NodeKind::kRoot) {
+    for (const auto& info : client.GetSchemas(&status)) {
+      result.children.push_back({NodeKind::kSchema, QString::fromStdString(info.name),
+                                 QString::number(info.table_names.size())});
+    }
+  } else if (status.ok && kind == NodeKind::kSchema) {
+    for (const auto& info : client.GetTables(schema, &status)) {
+      result.children.push_back({NodeKind::kTable, QString::fromStdString(info.name),
+                                 info.row_count >= 0 ? QString::number(info.row_count)
+                                                     : QString()});
+    }
+  } else if (status.ok && kind == NodeKind::kTable) {
+    for (const auto& column : client.GetColumns(schema, table, &status)) {
+      QString detail = QString::fromStdString(column.data_type);
+      if (!column.nullable) {
+        detail += QStringLiteral(" NOT NULL");
+      }
+      result.children.push_back({NodeKind::kColumn, QString::fromStdString(column.name), detail});
+    }
+    if (status.ok) {
+      // Same cached details as the columns; no second round trip
+      for (const auto& index : client.GetIndexes(schema, table, &status)) {
+        result.children.push_back({NodeKind::kIndex, QString::fromStdString(index.name),
+                                   index.is_unique ? QStringLiteral("unique index")
+                                                   : QStringLiteral("index")});
+      }
+    }
+  }
+  if (!status.ok) {
+    result.children.clear();
+    result.error = QString::fromStdString(status.message);
+  }
+  return result;
+}
+
+// ============================================================================
+// Search
+// ============================================================================
+
+void CatalogTreeModel::startSearch() {
+  resetRoot(LoadState::kLoading);
+  if (!client_) {
+    root_->state = LoadState::kLoaded;
+    return;
+  }
+  beginInsertRows(QModelIndex(), 0, 0);
+  addChild(root_.get(), NodeKind::kPlaceholder, tr("Searching..."), QString());
+  endInsertRows();
+
+  auto client = client_;
+  const quint64 generation = generation_;
+  const std::string text = search_text_.toStdString();
+  QPointer<CatalogTreeModel> self(this);
+  QThreadPool::globalInstance()->start([=]() {
+    core::Status status = core::Status::Ok();
+    auto hits = std::make_shared<std::vector<core::CatalogSearchHit>>(
+        client->SearchObjects(text, kSearchLimit, &status));
+    const QString error = status.ok ? QString() : QString::fromStdString(status.message);
+    QMetaObject::invokeMethod(qApp, [self, generation, hits, error]() {
+      if (self && self->generation_ == generation) {
+        self->finishSearch(std::move(*hits), error);
+      }
+    }, Qt::QueuedConnection);
+  });
+}
+
+void CatalogTreeModel::finishSearch(std::vector<core::CatalogSearchHit> hits,
+                                    const QString& error) {
+  beginResetModel();
+  ++generation_;
+  root_ = std::make_unique<Node>();
+  if (!error.isEmpty()) {
+    addChild(root_.get(), NodeKind::kPlaceholder, tr("Search failed: %1").arg(error), QString());
+  } else if (hits.empty()) {
+    addChild(root_.get(), NodeKind::kPlaceholder, tr("No matches"), QString());
+  }
+
+  // Only the paths to the hits are built. A table that matched by name
+  // alone stays unloaded so expanding it lists all of its columns; one
+  // with matching columns or indexes shows just those.
+  std::map<QString, Node*> schemas;
+  std::map<std::pair<QString, QString>, Node*> tables;
+  for (const auto& hit : hits) {
+    const QString schema = QString::fromStdString(hit.schema);
+    const QString table = QString::fromStdString(hit.table);
+    Node*& schema_node = schemas[schema];
+    if (!schema_node) {
+      schema_node = addChild(root_.get(), NodeKind::kSchema, schema, QString());
+    }
+    Node*& table_node = tables[{schema, table}];
+    if (!table_node) {
+      table_node = addChild(schema_node, NodeKind::kTable, table, QString());
+      table_node->state = LoadState::kUnloaded;
+    }
+    if (hit.kind == "column" || hit.kind == "index") {
+      table_node->state = LoadState::kLoaded;
+      addChild(table_node, hit.kind == "column" ? NodeKind::kColumn : NodeKind::kIndex,
+               QString::fromStdString(hit.name), QString());
+    }
+  }
+  endResetModel();
+
+  if (error.isEmpty()) {
+    emit searchFinished(static_cast<int>(hits.size()), hits.size() >= kSearchLimit);
+  } else {
+    emit loadFailed(error);
+  }
+}
+
+// ============================================================================
+// Tree
+// ============================================================================
+
+CatalogTreeModel::Node* CatalogTreeModel::addChild(Node* parent, NodeKind kind,
+                                                   const QString& name, const QString& detail) {
+  auto child = std::make_unique<Node>();
+  child->kind = kind;
+  child->name = name;
+  child->detail = detail;
+  child->parent = parent;
+  child->row = static_cast<int>(parent->children.size());
+  child->schema = kind == NodeKind::kSchema ? name : parent->schema;
+  child->table = kind == NodeKind::kTable ? name : parent->table;
+  child->state = IsExpandable(kind) ? LoadState::kUnloaded : LoadState::kLoaded;
+  parent->children.push_back(std::move(child));
+  return parent->children.back().get();
+}
+
+CatalogTreeModel::Node* CatalogTreeModel::nodeFor(const QModelIndex& index) const {
+  return index.isValid() ? static_cast<Node*>(index.internalPointer()) : root_.get();
+}
+
+QModelIndex CatalogTreeModel::indexFor(Node* node) const {
+  if (!node || node == root_.get()) {
+    return QModelIndex();
+  }
+  return createIndex(node->row, 0, node);
+}
+
+QModelIndex CatalogTreeModel::index(int row, int column, const QModelIndex& parent) const {
+  const Node* node = nodeFor(parent);
+  if (row < 0 || row >= static_cast<int>(node->children.size()) || column < 0 ||
+      column >= columnCount()) {
+    return QModelIndex();
+  }
+  return createIndex(row, column, node->children[row].get());
+}
+
+QModelIndex CatalogTreeModel::parent(const QModelIndex& index) const {
+  if (!index.isValid()) {
+    return QModelIndex();
+  }
+  return indexFor(static_cast<Node*>(index.internalPointer())->parent);
+}
+
+int CatalogTreeModel::rowCount(const QModelIndex& parent) const {
+  if (parent.column() > 0) {
+    return 0;
+  }
+  return static_cast<int>(nodeFor(parent)->children.size());
+}
+
+int CatalogTreeModel::columnCount(const QModelIndex& parent) const {
+  Q_UNUSED(parent)
+  return 2;
+}
+
+QVariant CatalogTreeModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid()) {
+    return QVariant();
+  }
+  const Node* node = nodeFor(index);
+  switch (role) {
+    case Qt::DisplayRole:
+      return index.column() == 0 ? node->name : node->detail;
+    case Qt::ToolTipRole:
+      if (node->kind == NodeKind::kTable) {
+        return node->schema + "." + node->name;
+      }
+      if (node->kind == NodeKind::kColumn || node->kind == NodeKind::kIndex) {
+        return node->schema + "." + node->table + "." + node->name;
+      }
+      return QVariant();
+    case Qt::DecorationRole:
+      if (index.column() == 0 &&
+          (node->kind == NodeKind::kSchema || node->kind == NodeKind::kTable)) {
+        return QIcon::fromTheme("folder");
+      }
+      return QVariant();
+    case Qt::FontRole:
+      if (node->kind == NodeKind::kPlaceholder) {
+        QFont font;
+        font.setItalic(true);
+        return font;
+      }
+      return QVariant();
+    case Qt::ForegroundRole:
+      if (node->kind == NodeKind::kPlaceholder || index.column() == 1) {
+        return QColor(Qt::gray);
+      }
+      return QVariant();
+    case KindRole:
+      return KindName(node->kind);
+    case SchemaRole:
+      return node->schema;
+    case TableRole:
+      return node->table;
+    default:
+      return QVariant();
+  }
+}
+
+QVariant CatalogTreeModel::headerData(int section, Qt::Orientation orientation, int role) const {
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+    return QVariant();
+  }
+  return section == 0 ? tr("Object") : tr("Type");
+}
+
+bool CatalogTreeModel::hasChildren(const QModelIndex& parent) const {
+  if (parent.column() > 0) {
+    return false;
+  }
+  const Node* node = nodeFor(parent);
+  if (node->state == LoadState::kUnloaded) {
+    return IsExpandable(node->kind);  // Show the expander before loading
+  }
+  return !node->children.empty();
+}
+
+bool CatalogTreeModel::canFetchMore(const QModelIndex& parent) const {
+  const Node* node = nodeFor(parent);
+  return client_ && node->state == LoadState::kUnloaded && IsExpandable(node->kind);
+}
+
+void CatalogTreeModel::fetchMore(const QModelIndex& parent) {
+  if (canFetchMore(parent)) {
+    startLoad(nodeFor(parent));
+  }
+}
+
+}  // namespace scratchrobin::ui
@@ -0,0 +1,119 @@
+#pragma once
+#include <QAbstractItemModel>
+#include <QString>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace scratchrobin::core {
+class ScratchBirdCatalogClient;
+struct CatalogSearchHit;
+}
+
+namespace scratchrobin::ui {
+
+/**
+ * @brief Schema tree that loads each level only when it is expanded
+ *
+ * Schemas, tables and a table's columns and indexes are read from a
+ * ScratchBirdCatalogClient (and so from its catalog cache) on the global
+ * thread pool. canFetchMore() is true for a node whose children were never
+ * loaded; fetchMore() shows a "Loading..." row under it and replaces that
+ * row with the children when they arrive. Nothing below a collapsed node
+ * is ever fetched.
+ *
+ * setSearchText() switches to a filtered tree built from one server-side
+ * search over every table, column and index name, so matches deep in the
+ * catalog show up without expanding anything. Clearing the text returns
+ * to the lazy browse tree.
+ */
+class CatalogTreeModel : public QAbstractItemModel {
+  Q_OBJECT
+
+ public:
+  enum class NodeKind { kRoot, kSchema, kTable, kColumn, kIndex, kPlaceholder };
+
+  enum Role {
+    KindRole = Qt::UserRole,  // "schema", "table", "column", "index" or empty
+    SchemaRole,
+    TableRole,
+  };
+
+  explicit CatalogTreeModel(QObject* parent = nullptr);
+  ~CatalogTreeModel() override;
+
+  void setCatalogClient(std::shared_ptr<core::ScratchBirdCatalogClient> client);
+  // Drops every loaded node; with |refresh_catalog| the catalog listing is
+  // re-read from the server before the schemas are listed again.
+  void reload(bool refresh_catalog = false);
+  void setSearchText(const QString& text);
+  QString searchText() const { return search_text_; }
+
+  // QAbstractItemModel
+  QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+  QModelIndex parent(const QModelIndex& index) const override;
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+  bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+  bool canFetchMore(const QModelIndex& parent) const override;
+  void fetchMore(const QModelIndex& parent) override;
+
+ signals:
+  // |truncated| when the search hit its row limit
+  void searchFinished(int hits, bool truncated);
+  void loadFailed(const QString& message);
+
+ private:
+  static constexpr std::size_t kSearchLimit = 500;
+
+  enum class LoadState { kUnloaded, kLoading, kLoaded };
+
+  struct Node {
+    NodeKind kind = NodeKind::kRoot;
+    QString name;
+    QString detail;  // Column type, index kind, row count
+    QString schema;
+    QString table;
+    Node* parent = nullptr;
+    int row = 0;
+    LoadState state = LoadState::kLoaded;
+    std::vector<std::unique_ptr<Node>> children;
+  };
+
+  struct ChildSpec {
+    NodeKind kind;
+    QString name;
+    QString detail;
+  };
+
+  struct LoadResult {
+    std::vector<ChildSpec> children;
+    QString error;
+  };
+
+  Node* nodeFor(const QModelIndex& index) const;
+  QModelIndex indexFor(Node* node) const;
+  Node* addChild(Node* parent, NodeKind kind, const QString& name, const QString& detail);
+  void resetRoot(LoadState state);
+  void startLoad(Node* node);
+  void finishLoad(Node* node, LoadResult result);
+  void startSearch();
+  void finishSearch(std::vector<core::CatalogSearchHit> hits, const QString& error);
+
+  static LoadResult LoadChildren(core::ScratchBirdCatalogClient& client, NodeKind kind,
+                                 const std::string& schema, const std::string& table,
+                                 bool refresh_catalog);
+
+  std::shared_ptr<core::ScratchBirdCatalogClient> client_;
+  std::unique_ptr<Node> root_;
+  QString search_text_;
+  // Bumped on every reset; results of loads started before it are dropped
+  quint64 generation_ = 0;
+  bool refresh_pending_ = false;
+};
+
+}  // namespace scratchrobin::ui
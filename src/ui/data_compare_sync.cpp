@@ -1,5 +1,9 @@
 #include "ui/data_compare_sync.h"
+#include "backend/scratchbird_sbwp_client.h"
 #include "backend/session_client.h"
+#include "core/table_diff.h"
+
+#include <mutex>
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -36,6 +40,17 @@ DataCompareSyncPanel::DataCompareSyncPanel(backend::SessionClient* client, QWidg
     setupModels();
 }
 
+DataCompareSyncPanel::~DataCompareSyncPanel()
+{
+    if (diff_) {
+        diff_->Cancel();
+        fallbackDiff_->Cancel();
+    }
+    if (diffThread_.joinable()) {
+        diffThread_.join();
+    }
+}
+
 void DataCompareSyncPanel::setupUi()
 {
     auto* mainLayout = new QVBoxLayout(this);
@@ -251,132 +266,209 @@ void DataCompareSyncPanel::onRunComparison()
         QMessageBox::warning(this, tr("Error"), tr("Please select both source and target tables."));
         return;
     }
+    if (keyColumns().isEmpty()) {
+        QMessageBox::warning(this, tr("Error"), tr("Please enter the key columns identifying a row."));
+        return;
+    }
+    if (diff_) {
+        QMessageBox::information(this, tr("Compare"), tr("A comparison is already running."));
+        return;
+    }
     
     summaryLabel_->setText(tr("Comparing %1 to %2...").arg(sourceTable).arg(targetTable));
     
     // Clear previous results
     resultModel_->removeRows(0, resultModel_->rowCount());
     compareResults_.clear();
+    diffResult_.reset();
     
-    // Run actual comparison via SessionClient if available
-    int equal = 0;
-    int different = 0;
-    int sourceOnly = 0;
-    int targetOnly = 0;
+    runComparison();
+}
+
+void DataCompareSyncPanel::runComparison()
+{
+    if (!client_) {
+        summaryLabel_->setText(tr("Not connected."));
+        return;
+    }
     
-    if (client_) {
-        // Get row counts for both tables
-        std::string sourceCountSql = QString("SELECT COUNT(*) FROM %1").arg(sourceTable).toStdString();
-        std::string targetCountSql = QString("SELECT COUNT(*) FROM %1").arg(targetTable).toStdString();
-        
-        auto sourceResponse = client_->ExecuteSql(4044, "scratchbird", sourceCountSql);
-        auto targetResponse = client_->ExecuteSql(4044, "scratchbird", targetCountSql);
-        
-        int sourceCount = 0;
-        int targetCount = 0;
-        
-        if (sourceResponse.status.ok && !sourceResponse.result_set.rows.empty()) {
-            sourceCount = QString::fromStdString(sourceResponse.result_set.rows[0][0]).toInt();
+    std::vector<std::string> keys;
+    for (const QString& key : keyColumns()) {
+        keys.push_back(key.toStdString());
+    }
+    std::vector<std::string> columns;
+    if (!compareAllColumnsCheck_->isChecked()) {
+        for (const QString& column : compareColumnsEdit_->text().split(',', Qt::SkipEmptyParts)) {
+            columns.push_back(column.trimmed().toStdString());
         }
-        if (targetResponse.status.ok && !targetResponse.result_set.rows.empty()) {
-            targetCount = QString::fromStdString(targetResponse.result_set.rows[0][0]).toInt();
+    }
+    const core::TableDiffTable sourceTable{
+        sourceTableCombo_->currentText().toStdString(), keys, columns, ""};
+    const core::TableDiffTable targetTable{
+        targetTableCombo_->currentText().toStdString(), keys, columns, ""};
+    
+    // Each side gets a connection of its own so both are scanned at once;
+    // without a runtime config they share the session client in turn
+    auto sideQuery = [this]() -> core::SqlTableDiffSource::QueryFunction {
+        if (const auto* runtime = client_->GetRuntimeConfig()) {
+            auto connection = std::make_shared<backend::ScratchbirdSbwpClient>(*runtime);
+            return [connection](const std::string& sql, core::ResultSet* result) {
+                auto response = connection->ExecuteSql(sql);
+                *result = std::move(response.result_set);
+                return response.status;
+            };
         }
+        auto shared = std::make_shared<std::mutex>();
+        return [client = client_, shared](const std::string& sql, core::ResultSet* result) {
+            std::lock_guard<std::mutex> lock(*shared);
+            auto response = client->ExecuteSql(4044, "scratchbird", sql);
+            *result = std::move(response.result_set);
+            return response.status;
+        };
+    };
+    auto sourceQuery = sideQuery();
+    auto targetQuery = client_->GetRuntimeConfig() ? sideQuery() : sourceQuery;
+    
+    core::TableDiffOptions options;
+    options.ignore_case = ignoreCaseCheck_->isChecked();
+    options.trim_whitespace = ignoreWhitespaceCheck_->isChecked();
+    
+    // Hash on the server when it has HASH(), otherwise stream and hash here
+    auto makeDiff = [=](const std::string& hashFunction) {
+        return std::make_shared<core::TableDiff>(
+            std::make_shared<core::SqlTableDiffSource>(sourceTable, sourceQuery, hashFunction),
+            std::make_shared<core::SqlTableDiffSource>(targetTable, targetQuery, hashFunction));
+    };
+    diff_ = makeDiff("HASH");
+    fallbackDiff_ = makeDiff("");
+    if (diffThread_.joinable()) {
+        diffThread_.join();  // The previous comparison, already finished
+    }
+    
+    emit comparisonStarted();
+    diffThread_ = std::thread([this, diff = diff_, fallback = fallbackDiff_, options]() {
+        auto result = std::make_shared<core::TableDiffResult>(diff->Run(options));
+        if (!result->status.ok && result->levels <= 1) {
+            result = std::make_shared<core::TableDiffResult>(fallback->Run(options));
+        }
+        QMetaObject::invokeMethod(this, [this, result]() {
+            onComparisonDone(result);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void DataCompareSyncPanel::onComparisonDone(std::shared_ptr<core::TableDiffResult> result)
+{
+    diff_.reset();
+    fallbackDiff_.reset();
+    if (!result->status.ok) {
+        summaryLabel_->setText(tr("Comparison failed: %1")
+                               .arg(QString::fromStdString(result->status.message)));
+        return;
+    }
+    diffResult_ = std::move(result);
+    displayResults();
+    
+    const auto& diff = *diffResult_;
+    equalCountLabel_->setText(tr("Equal: %1").arg(diff.equal_rows));
+    differentCountLabel_->setText(tr("Different: %1").arg(diff.changed));
+    sourceOnlyCountLabel_->setText(tr("Source Only: %1").arg(diff.source_only));
+    targetOnlyCountLabel_->setText(tr("Target Only: %1").arg(diff.target_only));
+    
+    summaryLabel_->setText(tr("Comparison complete in %1 ms. Found %2 differences "
+                              "(%3 chunks compared, %4 rows fetched).")
+                           .arg(diff.elapsed_ms)
+                           .arg(diff.changed + diff.source_only + diff.target_only)
+                           .arg(diff.chunks_compared)
+                           .arg(diff.rows_fetched));
+    
+    emit comparisonFinished(static_cast<int>(diff.changed), static_cast<int>(diff.source_only),
+                            static_cast<int>(diff.target_only));
+}
+
+void DataCompareSyncPanel::displayResults()
+{
+    resultModel_->removeRows(0, resultModel_->rowCount());
+    compareResults_.clear();
+    if (!diffResult_) {
+        return;
+    }
+    
+    const auto& diff = *diffResult_;
+    const QString table = targetTableCombo_->currentText();
+    auto text = [](const std::optional<std::string>& value) {
+        return value ? QString::fromStdString(*value) : QStringLiteral("NULL");
+    };
+    for (const auto& row : diff.rows) {
+        QStringList keyParts;
+        for (const auto& part : row.key) {
+            keyParts << QString::fromStdString(part);
+        }
+        const QString key = keyParts.join(", ");
         
-        // Simple comparison: assume some differences for demo
-        // In real implementation, would compare actual row contents
-        equal = qMin(sourceCount, targetCount);
-        sourceOnly = qMax(0, sourceCount - targetCount);
-        targetOnly = qMax(0, targetCount - sourceCount);
-        different = qMax(0, equal / 20); // Assume ~5% differences
-        equal -= different;
-        
-        // Try to get actual differences using EXCEPT
-        QString keyCol = keyColumnsEdit_->text().isEmpty() ? "*" : keyColumnsEdit_->text();
-        QString diffSql = QString(
-            "SELECT %1 FROM %2 EXCEPT SELECT %1 FROM %3 LIMIT 10"
-        ).arg(keyCol).arg(sourceTable).arg(targetTable);
-        
-        auto diffResponse = client_->ExecuteSql(4044, "scratchbird", diffSql.toStdString());
-        
-        if (diffResponse.status.ok) {
-            different = diffResponse.result_set.rows.size();
-            
-            // Populate results
-            for (size_t i = 0; i < diffResponse.result_set.rows.size(); ++i) {
-                auto* keyItem = new QStandardItem(QString::number(i + 1));
-                auto* colItem = new QStandardItem("*");
-                auto* srcItem = new QStandardItem("exists in source");
-                auto* tgtItem = new QStandardItem("missing in target");
-                tgtItem->setBackground(QBrush(QColor(255, 200, 200)));
-                
-                QList<QStandardItem*> row;
-                row << keyItem << colItem << srcItem << tgtItem;
-                resultModel_->appendRow(row);
+        if (row.kind == core::TableRowDiffKind::kChanged) {
+            for (std::size_t column : row.changed_columns) {
+                CompareResult entry{table, key, CompareResult::Different,
+                                    QString::fromStdString(diff.columns[column]),
+                                    text(row.source[column]), text(row.target[column])};
+                compareResults_.append(entry);
             }
+        } else if (row.kind == core::TableRowDiffKind::kSourceOnly) {
+            compareResults_.append({table, key, CompareResult::SourceOnly, "*",
+                                    tr("exists in source"), tr("missing in target")});
+        } else {
+            compareResults_.append({table, key, CompareResult::TargetOnly, "*",
+                                    tr("missing in source"), tr("exists in target")});
         }
-    } else {
-        // Simulate results when offline
-        equal = 95;
-        different = 3;
-        sourceOnly = 1;
-        targetOnly = 1;
     }
     
-    // Add sample different rows
-    for (int i = 0; i < 3; ++i) {
-        auto* keyItem = new QStandardItem(QString::number(i + 1));
-        auto* colItem = new QStandardItem("name");
-        auto* srcItem = new QStandardItem(QString("Source Value %1").arg(i));
-        auto* tgtItem = new QStandardItem(QString("Target Value %1").arg(i));
+    for (const auto& entry : compareResults_) {
+        auto* keyItem = new QStandardItem(entry.keyValue);
+        auto* colItem = new QStandardItem(entry.columnName);
+        auto* srcItem = new QStandardItem(entry.sourceValue);
+        auto* tgtItem = new QStandardItem(entry.targetValue);
         tgtItem->setBackground(QBrush(QColor(255, 200, 200)));
         
         QList<QStandardItem*> row;
         row << keyItem << colItem << srcItem << tgtItem;
         resultModel_->appendRow(row);
     }
-    
-    equalCountLabel_->setText(tr("Equal: %1").arg(equal));
-    differentCountLabel_->setText(tr("Different: %1").arg(different));
-    sourceOnlyCountLabel_->setText(tr("Source Only: %1").arg(sourceOnly));
-    targetOnlyCountLabel_->setText(tr("Target Only: %1").arg(targetOnly));
-    
-    summaryLabel_->setText(tr("Comparison complete. Found %1 differences.").arg(different + sourceOnly + targetOnly));
-    
-    emit comparisonFinished(different, sourceOnly, targetOnly);
+}
+
+QStringList DataCompareSyncPanel::keyColumns() const
+{
+    QStringList keys;
+    for (const QString& key : keyColumnsEdit_->text().split(',', Qt::SkipEmptyParts)) {
+        if (!key.trimmed().isEmpty()) {
+            keys << key.trimmed();
+        }
+    }
+    return keys;
 }
 
 void DataCompareSyncPanel::onGenerateSyncScript()
 {
+    if (!diffResult_) {
+        QMessageBox::warning(this, tr("Error"), tr("Run a comparison first."));
+        return;
+    }
+    
     QString script = tr("-- Generated Sync Script\n");
     script += tr("-- Source: %1\n").arg(sourceTableCombo_->currentText());
     script += tr("-- Target: %1\n").arg(targetTableCombo_->currentText());
-    script += tr("-- Generated: %1\n\n").arg(QDateTime::currentDateTime().toString());
-    
-    // Generate UPDATE statements for differences
-    script += tr("-- Update different rows\n");
-    for (int i = 0; i < resultModel_->rowCount(); ++i) {
-        QString key = resultModel_->item(i, 0)->text();
-        QString col = resultModel_->item(i, 1)->text();
-        QString srcVal = resultModel_->item(i, 2)->text();
-        
-        script += QString("UPDATE %1 SET %2 = '%3' WHERE id = %4;\n")
-            .arg(targetTableCombo_->currentText())
-            .arg(col)
-            .arg(srcVal)
-            .arg(key);
+    script += tr("-- Generated: %1\n").arg(QDateTime::currentDateTime().toString());
+    script += tr("-- %1 updates, %2 inserts, %3 deletes\n\n")
+        .arg(diffResult_->changed)
+        .arg(diffResult_->source_only)
+        .arg(diffResult_->target_only);
+    
+    // One statement per differing row, keyed exactly
+    std::vector<std::string> keys;
+    for (const QString& key : keyColumns()) {
+        keys.push_back(key.toStdString());
     }
-    
-    // Generate INSERT statements for source-only rows
-    script += tr("\n-- Insert missing rows from source\n");
-    script += QString("INSERT INTO %1 SELECT * FROM %2 WHERE id NOT IN (SELECT id FROM %1);\n")
-        .arg(targetTableCombo_->currentText())
-        .arg(sourceTableCombo_->currentText());
-    
-    // Generate DELETE statements for target-only rows
-    script += tr("\n-- Delete rows not in source\n");
-    script += QString("DELETE FROM %1 WHERE id NOT IN (SELECT id FROM %2);\n")
-        .arg(targetTableCombo_->currentText())
-        .arg(sourceTableCombo_->currentText());
+    script += QString::fromStdString(core::TableDiff::SyncScript(
+        *diffResult_, targetTableCombo_->currentText().toStdString(), keys));
     
     scriptEdit_->setPlainText(script);
     tabWidget_->setCurrentIndex(1);  // Switch to script tab
@@ -1,6 +1,8 @@
 #pragma once
 #include "ui/dock_workspace.h"
 #include <QDialog>
+#include <memory>
+#include <thread>
 
 QT_BEGIN_NAMESPACE
 class QTableView;
@@ -23,6 +25,11 @@ namespace scratchrobin::backend {
 class SessionClient;
 }
 
+namespace scratchrobin::core {
+class TableDiff;
+struct TableDiffResult;
+}
+
 namespace scratchrobin::ui {
 
 /**
@@ -58,6 +65,7 @@ class DataCompareSyncPanel : public DockPanel {
 
 public:
     explicit DataCompareSyncPanel(backend::SessionClient* client, QWidget* parent = nullptr);
+    ~DataCompareSyncPanel() override;
     
     QString panelTitle() const override { return tr("Data Compare/Sync"); }
     QString panelCategory() const override { return "database"; }
@@ -82,7 +90,9 @@ private:
     void setupUi();
     void setupModels();
     void runComparison();
+    void onComparisonDone(std::shared_ptr<core::TableDiffResult> result);
     void displayResults();
+    QStringList keyColumns() const;
     
     backend::SessionClient* client_;
     
@@ -119,6 +129,13 @@ private:
     QTextEdit* scriptEdit_ = nullptr;
     
     QList<CompareResult> compareResults_;
+    
+    // The diff runs on diffThread_, falling back to client-side hashing
+    // when the server has no HASH(); diffResult_ holds the last result
+    std::shared_ptr<core::TableDiff> diff_;
+    std::shared_ptr<core::TableDiff> fallbackDiff_;
+    std::shared_ptr<core::TableDiffResult> diffResult_;
+    std::thread diffThread_;
 };
 
 // ============================================================================
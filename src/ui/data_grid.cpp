@@ -1,4 +1,5 @@
 #include "ui/data_grid.h"
+#include "ui/result_set_model.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -57,15 +58,20 @@ void DataGrid::setupUi() {
   table_view_->horizontalHeader()->setStretchLastSection(true);
   table_view_->horizontalHeader()->setSectionsMovable(true);
   table_view_->verticalHeader()->setVisible(false);
-  table_view_->setSortingEnabled(true);
   
-  model_ = new QStandardItemModel(this);
+  model_ = new ResultSetModel(this);
   proxy_model_ = new QSortFilterProxyModel(this);
   proxy_model_->setSourceModel(model_);
   proxy_model_->setFilterCaseSensitivity(Qt::CaseInsensitive);
   proxy_model_->setFilterKeyColumn(-1);  // Search all columns
+  proxy_model_->setSortRole(Qt::EditRole);  // Typed values sort numerically
   
   table_view_->setModel(proxy_model_);
+  // Don't sort until a header is clicked; sorting visits every row.
+  table_view_->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+  table_view_->setSortingEnabled(true);
+  // Uniform row heights let the view skip measuring off-screen rows.
+  table_view_->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
   layout->addWidget(table_view_);
 
   // Status bar
@@ -86,25 +92,59 @@ void DataGrid::setupUi() {
           this, &DataGrid::onItemDoubleClicked);
   connect(table_view_->selectionModel(), &QItemSelectionModel::selectionChanged,
           this, &DataGrid::selectionChanged);
+  connect(model_, &ResultSetModel::moreRowsRequested,
+          this, &DataGrid::moreRowsRequested);
+  connect(model_, &QAbstractItemModel::rowsInserted,
+          this, &DataGrid::updateStatus);
 }
 
 void DataGrid::setData(const QList<QStringList>& data, const QStringList& headers) {
-  model_->clear();
-  model_->setHorizontalHeaderLabels(headers);
-  
-  total_rows_ = data.size();
-  
+  core::ResultSet result;
+  for (const auto& header : headers) {
+    result.columns.push_back(header.toStdString());
+  }
+  result.rows.SetColumnCount(static_cast<size_t>(headers.size()));
   for (const auto& row : data) {
-    QList<QStandardItem*> items;
-    for (const auto& cell : row) {
-      auto* item = new QStandardItem(cell);
-      item->setEditable(false);
-      items.append(item);
+    for (int col = 0; col < headers.size(); ++col) {
+      if (col < row.size()) {
+        result.rows.Column(col).AppendText(row.at(col).toStdString());
+      } else {
+        result.rows.Column(col).AppendNull();
+      }
     }
-    model_->appendRow(items);
+    result.rows.EndRow();
   }
-  
-  status_label_->setText(tr("%1 rows, %2 columns").arg(total_rows_).arg(headers.size()));
+  setResultSet(std::move(result));
+}
+
+void DataGrid::setResultSet(core::ResultSet result) {
+  model_->setResultSet(std::move(result));
+  model_->setMoreRowsAvailable(false);
+  total_rows_ = static_cast<int>(model_->bufferedRowCount());
+  updateStatus();
+}
+
+void DataGrid::appendRows(core::ResultSet batch) {
+  model_->appendBatch(std::move(batch));
+  total_rows_ = static_cast<int>(model_->bufferedRowCount());
+  updateStatus();
+}
+
+void DataGrid::setMoreRowsAvailable(bool available) {
+  model_->setMoreRowsAvailable(available);
+  updateStatus();
+}
+
+void DataGrid::updateStatus() {
+  QString rows = QString::number(total_rows_);
+  if (model_->moreRowsAvailable()) {
+    rows += QStringLiteral("+");
+  }
+  if (!filter_edit_->text().isEmpty()) {
+    status_label_->setText(tr("%1 of %2 rows shown").arg(proxy_model_->rowCount()).arg(rows));
+    return;
+  }
+  status_label_->setText(tr("%1 rows, %2 columns").arg(rows).arg(model_->columnCount()));
 }
 
 void DataGrid::clear() {
@@ -142,14 +182,13 @@ QStringList DataGrid::selectedRow() const {
 }
 
 QStringList DataGrid::headers() const {
-  QStringList result;
-  for (int col = 0; col < model_->columnCount(); ++col) {
-    result.append(model_->headerData(col, Qt::Horizontal).toString());
-  }
-  return result;
+  return model_->headers();
 }
 
 QList<QStringList> DataGrid::allData() const {
+  // Rows are exposed to the view lazily; make every buffered row visible
+  // to the proxy so filtering and sorting still apply to the export.
+  model_->exposeAllBufferedRows();
   QList<QStringList> result;
   for (int row = 0; row < proxy_model_->rowCount(); ++row) {
     QStringList row_data;
@@ -178,13 +217,10 @@ void DataGrid::exportToCsv(const QString& filename) {
   }
   
   QTextStream stream(&file);
+  model_->exposeAllBufferedRows();
   
   // Headers
-  QStringList headers;
-  for (int col = 0; col < model_->columnCount(); ++col) {
-    headers.append(model_->headerData(col, Qt::Horizontal).toString());
-  }
-  stream << headers.join(",") << "\n";
+  stream << model_->headers().join(",") << "\n";
   
   // Data
   for (int row = 0; row < proxy_model_->rowCount(); ++row) {
@@ -211,8 +247,7 @@ void DataGrid::filter(const QString& text) {
 
 void DataGrid::onFilterTextChanged(const QString& text) {
   proxy_model_->setFilterFixedString(text);
-  int visible = proxy_model_->rowCount();
-  status_label_->setText(tr("%1 of %2 rows shown").arg(visible).arg(total_rows_));
+  updateStatus();
 }
 
 void DataGrid::onItemDoubleClicked(const QModelIndex& index) {
@@ -1,7 +1,8 @@
 #pragma once
 #include <QWidget>
 #include <QTableView>
-#include <QStandardItemModel>
+
+#include "core/result_set.h"
 
 QT_BEGIN_NAMESPACE
 class QLineEdit;
@@ -12,6 +13,8 @@ QT_END_NAMESPACE
 
 namespace scratchrobin::ui {
 
+class ResultSetModel;
+
 class DataGrid : public QWidget {
   Q_OBJECT
 
@@ -22,6 +25,11 @@ class DataGrid : public QWidget {
   void setData(const QList<QStringList>& data, const QStringList& headers);
   void clear();
   
+  // Result buffer API - cells are formatted only when painted
+  void setResultSet(core::ResultSet result);
+  void appendRows(core::ResultSet batch);
+  void setMoreRowsAvailable(bool available);
+  
   int rowCount() const;
   int columnCount() const;
   
@@ -37,6 +45,7 @@ class DataGrid : public QWidget {
   void rowDoubleClicked(int row);
   void cellClicked(int row, int column);
   void selectionChanged();
+  void moreRowsRequested();
 
  public slots:
   void refresh();
@@ -51,9 +60,10 @@ class DataGrid : public QWidget {
 
  private:
   void setupUi();
+  void updateStatus();
 
   QTableView* table_view_;
-  QStandardItemModel* model_;
+  ResultSetModel* model_;
   QSortFilterProxyModel* proxy_model_;
   
   QLineEdit* filter_edit_;
@@ -76,7 +76,12 @@
 #include "ui/monitoring_panels.h"
 #include "backend/session_client.h"
 #include "backend/query_response.h"
+#include "backend/query_router.h"
 #include "backend/scratchbird_connection.h"
+#include "backend/scratchbird_sbwp_client.h"
+#include "core/scratchbird_catalog_client.h"
+#include "core/script_runner.h"
+#include "core/streaming_data_importer.h"
 #include "core/window_state_manager.h"
 
 #include <QApplication>
@@ -102,6 +107,9 @@
 #include <QTimer>
 #include <QProgressBar>
 #include <QThread>
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
 #include <QTimer>
 #include <QJsonDocument>
 #include <QJsonArray>
@@ -114,7 +122,8 @@ namespace scratchrobin::ui {
 MainWindow::MainWindow(backend::SessionClient* session_client, QWidget* parent)
     : QMainWindow(parent)
     , session_client_(session_client)
-    , db_connection_(std::make_unique<backend::ScratchbirdConnection>())
+    , db_connection_(std::make_shared<backend::ScratchbirdConnection>())
+    , query_router_(std::make_unique<backend::QueryRouter>())
     , query_running_(false)
     , dock_workspace_(nullptr)
     , view_manager_panel_(nullptr)
@@ -143,13 +152,47 @@ MainWindow::MainWindow(backend::SessionClient* session_client, QWidget* parent)
   // Initialize async query executor
   async_executor_.Initialize(4);  // 4 worker threads
   
+  // DDL run through the router drops what it changed from the catalog
+  query_router_->setDirectConnection(db_connection_.get());
+  query_router_->setDdlListener([this](backend::QueryType, const std::string& sql) {
+    if (catalog_client_) {
+      catalog_client_->InvalidateForStatement(sql);
+    }
+  });
+  
+  // Parameterized statements are prepared once on the session's server
+#if defined(SCRATCHROBIN_WITH_SCRATCHBIRD_SBWP)
+  if (const auto* runtime = session_client_ ? session_client_->GetRuntimeConfig() : nullptr) {
+    sbwp_client_ = std::make_unique<backend::ScratchbirdSbwpClient>(*runtime);
+    query_router_->setSbwpClient(sbwp_client_.get());
+  }
+#endif
+  
   // Initialize DockWorkspace after basic UI setup
   setupDockWorkspace();
   
   showStatusMessage(tr("Ready"));
 }
 
-MainWindow::~MainWindow() = default;
+MainWindow::~MainWindow() {
+  // Workers post into this object; stop them before it goes away
+  async_executor_.CancelAllQueries();
+  async_executor_.Shutdown();
+  csv_importer_.reset();
+  if (script_runner_) {
+    script_runner_->Cancel();
+  }
+  if (script_thread_.joinable()) {
+    script_thread_.join();
+  }
+  if (catalog_client_) {
+    catalog_client_->Disconnect();  // Saves the catalog snapshot
+  }
+}
+
+void MainWindow::setCompileCache(backend::SblrCompileCache* cache) {
+  query_router_->setCompileCache(cache);
+}
 
 void MainWindow::setupUi() {
   // Central widget - SQL editor tabs
@@ -490,6 +533,8 @@ void MainWindow::createMenus() {
   connect(query_menu_obj_, &QueryMenu::executeRequested, this, &MainWindow::onQueryExecute);
   connect(query_menu_obj_, &QueryMenu::executeSelectionRequested, this, &MainWindow::onQueryExecuteSelection);
   connect(query_menu_obj_, &QueryMenu::executeScriptRequested, this, &MainWindow::onQueryExecuteScript);
+  connect(query_menu_obj_, &QueryMenu::parallelScriptsToggled, this,
+          [this](bool enabled) { parallel_scripts_ = enabled; });
   connect(query_menu_obj_, &QueryMenu::stopRequested, this, &MainWindow::onQueryStop);
   connect(query_menu_obj_, &QueryMenu::explainRequested, this, &MainWindow::onQueryExplain);
   connect(query_menu_obj_, &QueryMenu::explainAnalyzeRequested, this, &MainWindow::onQueryExplainAnalyze);
@@ -753,6 +798,12 @@ void MainWindow::setupConnections() {
   connect(results_grid_, &DataGrid::rowDoubleClicked, this, [this](int row) {
     showStatusMessage(tr("Row %1 selected").arg(row + 1), 2000);
   });
+  // Scrolling to the end of the grid lets the cursor fetch another batch
+  connect(results_grid_, &DataGrid::moreRowsRequested, this, [this]() {
+    if (current_query_task_id_ != core::kInvalidQueryTaskId) {
+      async_executor_.RequestMoreRows(current_query_task_id_);
+    }
+  });
   
   // Load saved window layout (delayed to ensure docks are fully created)
   QTimer::singleShot(0, this, [this]() {
@@ -800,6 +851,7 @@ void MainWindow::onFileNewConnection() {
     showStatusMessage(tr("Connecting to %1...").arg(config.host), 0);
     
     if (db_connection_->connect(conn_info)) {
+      transaction_open_ = false;
       connection_label_->setText(tr("Connected: %1").arg(config.host));
       showStatusMessage(tr("Connected to %1").arg(config.host), 3000);
       
@@ -807,14 +859,32 @@ void MainWindow::onFileNewConnection() {
       navigator_->addServer(config.name, QString("%1:%2").arg(config.host).arg(config.port));
       navigator_->addDatabase(config.name, config.database);
       
-      // Load tables
-      auto tables_result = db_connection_->getTables(config.database.toStdString());
-      if (tables_result.success) {
-        for (const auto& row : tables_result.rows) {
-          if (!row.empty()) {
-            navigator_->addTable(config.name, config.database, QString::fromStdString(row[0]));
-          }
+      // Tables are listed when the navigator node is expanded. Catalog
+      // reads run on the thread pool, so they get their own connection
+      // rather than racing queries on db_connection_.
+      // The catalog is loaded from the snapshot saved at the last
+      // disconnect, so only tables changed since then are fetched again.
+      if (catalog_client_) {
+        catalog_client_->Disconnect();
+        catalog_client_.reset();
+      }
+      auto catalog_connection = std::make_shared<backend::ScratchbirdConnection>();
+      if (catalog_connection->connect(conn_info)) {
+        const QString snapshots =
+            QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+            QStringLiteral("/catalog");
+        core::ConnectionConfig catalog_config;
+        catalog_config.host = conn_info.host;
+        catalog_config.port = conn_info.port;
+        catalog_config.database = conn_info.database;
+        catalog_config.username = conn_info.username;
+        catalog_client_ = std::make_shared<core::ScratchBirdCatalogClient>();
+        if (QDir().mkpath(snapshots)) {
+          catalog_client_->SetSnapshotDirectory(snapshots.toStdString());
         }
+        catalog_client_->Connect(catalog_config);
+        catalog_client_->SetConnection(catalog_connection);
+        navigator_->setCatalogClient(config.name, config.database, catalog_client_);
       }
     } else {
       showError(tr("Failed to connect: %1").arg(QString::fromStdString(db_connection_->lastError())));
@@ -946,7 +1016,18 @@ void MainWindow::onDbConnect() {
   onFileNewConnection();
 }
 void MainWindow::onDbDisconnect() { 
+  if (query_running_ && current_query_task_id_ != core::kInvalidQueryTaskId) {
+    // The worker still uses the connection; disconnect once it lets go
+    cancelRunningQuery([this]() { onDbDisconnect(); });
+    showStatusMessage(tr("Stopping the running query..."), 0);
+    return;
+  }
   db_connection_->disconnect();
+  transaction_open_ = false;
+  if (catalog_client_) {
+    catalog_client_->Disconnect();
+    catalog_client_.reset();
+  }
   connection_label_->setText(tr("Disconnected"));
   showStatusMessage(tr("Disconnected"), 2000);
 }
@@ -1160,38 +1241,158 @@ void MainWindow::executeCurrentEditor() {
 }
 
 void MainWindow::executeSql(const QString& sql) {
-  showStatusMessage(tr("Executing..."), 0);
+  if (!claimConnection([this, sql]() { executeSql(sql); })) {
+    return;
+  }
   
-  if (!db_connection_->isConnected()) {
-    showError(tr("Not connected to database. Please connect first."));
+  if (catalog_client_) {
+    catalog_client_->InvalidateForStatement(sql.toStdString());  // No-op unless DDL
+  }
+  for (const auto& statement : core::ScriptRunner::Split(sql.toStdString())) {
+    if (statement.kind == core::ScriptStatementKind::kTransactionBegin) {
+      transaction_open_ = true;
+    } else if (statement.kind == core::ScriptStatementKind::kTransactionEnd) {
+      transaction_open_ = false;
+    }
+  }
+  
+  showStatusMessage(tr("Executing..."), 0);
+  query_running_ = true;
+  query_rows_received_ = 0;
+  const quint64 generation = ++query_generation_;
+  
+  // The statement runs on an executor thread; rows arrive in batches that
+  // are queued back to the GUI thread and appended to the grid as they land.
+  // The cursor stays kQueryPrefetchBatches ahead of the grid and fetches
+  // more only as the user scrolls.
+  current_query_task_id_ = async_executor_.SubmitStreamingQuery(
+      sql.toStdString(), db_connection_,
+      [this, generation](core::ResultSet&& batch, bool has_more) {
+        auto shared = std::make_shared<core::ResultSet>(std::move(batch));
+        QMetaObject::invokeMethod(this, [this, generation, shared, has_more]() {
+          onQueryBatch(generation, std::move(*shared), has_more);
+        }, Qt::QueuedConnection);
+      },
+      [this, generation](const core::AsyncQueryResult& result) {
+        QMetaObject::invokeMethod(this, [this, generation, status = result.status,
+                                         rows = result.rows_returned,
+                                         elapsed = result.execution_time_ms]() {
+          onQueryFinished(generation, status, rows, elapsed);
+        }, Qt::QueuedConnection);
+      },
+      kQueryBatchRows, core::QueryPriority::kInteractive, kQueryPrefetchBatches);
+  
+  if (current_query_task_id_ == core::kInvalidQueryTaskId) {
+    query_running_ = false;
+    showError(tr("Query executor is not running"));
+  }
+}
+
+void MainWindow::onQueryBatch(quint64 generation, core::ResultSet batch, bool has_more) {
+  if (generation != query_generation_ || query_abandoned_) {
     return;
   }
   
-  // Execute using ScratchbirdConnection
-  auto result = db_connection_->execute(sql.toStdString());
+  const auto batch_rows = static_cast<qint64>(batch.RowCount());
+  if (query_rows_received_ == 0) {
+    showResults(std::move(batch));
+  } else {
+    results_grid_->appendRows(std::move(batch));
+  }
+  query_rows_received_ += batch_rows;
+  results_grid_->setMoreRowsAvailable(has_more);
   
-  if (!result.success) {
-    showError(QString::fromStdString(result.error_message));
+  if (has_more) {
+    row_count_label_->setText(tr("%1+ rows").arg(query_rows_received_));
+    showStatusMessage(tr("Fetching... %1 rows").arg(query_rows_received_), 0);
+  } else {
+    row_count_label_->setText(tr("%1 rows").arg(query_rows_received_));
+  }
+}
+
+void MainWindow::onQueryFinished(quint64 generation, const core::Status& status,
+                                 qint64 rows_returned, qint64 elapsed_ms) {
+  if (generation != query_generation_) {
     return;
   }
   
-  // Convert to Qt types
-  QStringList headers;
-  for (const auto& col : result.columns) {
-    headers.append(QString::fromStdString(col.name));
+  query_running_ = false;
+  current_query_task_id_ = core::kInvalidQueryTaskId;
+  results_grid_->setMoreRowsAvailable(false);
+  
+  if (query_abandoned_) {
+    query_abandoned_ = false;
+    row_count_label_->setText(tr("%1 rows").arg(query_rows_received_));
+    auto then = std::move(after_query_);
+    after_query_ = nullptr;
+    if (then) {
+      then();
+    }
+    return;
   }
   
-  QList<QStringList> data;
-  for (const auto& row : result.rows) {
-    QStringList rowData;
-    for (const auto& cell : row) {
-      rowData.append(QString::fromStdString(cell));
+  if (!status.ok) {
+    if (status.message == "Query cancelled") {
+      showStatusMessage(tr("Query cancelled after %1 rows").arg(query_rows_received_), 3000);
+    } else {
+      showError(QString::fromStdString(status.message));
     }
-    data.append(rowData);
+    return;
+  }
+  
+  showStatusMessage(tr("Query executed: %1 rows returned in %2 ms")
+                        .arg(rows_returned).arg(elapsed_ms), 3000);
+}
+
+bool MainWindow::claimConnection(std::function<void()> retry) {
+  if (!db_connection_ || !db_connection_->isConnected()) {
+    showError(tr("Not connected to database. Please connect first."));
+    return false;
+  }
+  if (!query_running_) {
+    return true;
+  }
+  // A query that has shown rows is only holding its cursor open for the
+  // grid; give up the remaining rows. Anything else still owns the
+  // connection.
+  if (query_abandoned_) {
+    showStatusMessage(tr("The previous query is still stopping; try again in a moment"), 3000);
+    return false;
+  }
+  if (current_query_task_id_ == core::kInvalidQueryTaskId || query_rows_received_ == 0) {
+    showStatusMessage(tr("A query is already running; wait for it or stop it first"), 3000);
+    return false;
   }
+  if (!retry) {
+    showStatusMessage(tr("Closing the previous result; try again in a moment"), 3000);
+  }
+  cancelRunningQuery(std::move(retry));
+  return false;
+}
+
+void MainWindow::cancelRunningQuery(std::function<void()> then) {
+  if (current_query_task_id_ == core::kInvalidQueryTaskId) {
+    return;
+  }
+  // The worker shares the connection, so the caller's follow-up waits for
+  // onQueryFinished rather than blocking the GUI thread here
+  after_query_ = std::move(then);
+  if (!query_abandoned_) {
+    query_abandoned_ = true;
+    results_grid_->setMoreRowsAvailable(false);
+    async_executor_.CancelQuery(current_query_task_id_);
+  }
+}
+
+void MainWindow::showResults(core::ResultSet result) {
+  const auto row_count = result.RowCount();
+  results_grid_->setResultSet(std::move(result));
+  row_count_label_->setText(tr("%1 rows").arg(row_count));
   
-  showResults(data, headers);
-  showStatusMessage(tr("Query executed: %1 rows returned").arg(data.size()), 3000);
+  if (!results_dock_->isVisible()) {
+    results_dock_->show();
+    action_results_->setChecked(true);
+  }
 }
 
 void MainWindow::showResults(const QList<QStringList>& data, const QStringList& headers) {
@@ -1234,40 +1435,100 @@ void MainWindow::onQueryExecuteSelection() {
 }
 
 void MainWindow::onQueryExecuteScript() {
+  if (!claimConnection([this]() { onQueryExecuteScript(); })) {
+    return;
+  }
   if (auto* editor = currentEditor()) {
     QString sql = editor->toPlainText();
-    if (sql.isEmpty()) {
+    if (sql.trimmed().isEmpty()) {
       showStatusMessage(tr("No SQL to execute"), 2000);
       return;
     }
     
-    // Split script into individual statements (basic splitting by semicolon)
-    QStringList statements = sql.split(';', Qt::SkipEmptyParts);
-    int executed = 0;
-    int failed = 0;
-    
-    for (QString& stmt : statements) {
-      stmt = stmt.trimmed();
-      if (stmt.isEmpty()) continue;
-      
-      auto result = db_connection_->execute(stmt.toStdString() + ";");
-      if (result.success) {
-        executed++;
-      } else {
-        failed++;
-        showError(tr("Statement failed: %1\nError: %2")
-                  .arg(stmt.left(50))
-                  .arg(QString::fromStdString(result.error_message)));
-        break;  // Stop on first error
+    // By default the statements run in order on db_connection_, like the
+    // editor's own. With Run Scripts in Parallel, independent statements
+    // spread over connections of their own, except inside an open
+    // transaction or one the script opens and does not close, which only
+    // db_connection_ sees. Planning and running happen off the GUI thread.
+    const backend::ConnectionInfo info = db_connection_->connectionInfo();
+    script_runner_ = std::make_shared<core::ScriptRunner>([info](std::string* error) {
+      auto connection = std::make_shared<backend::ScratchbirdConnection>();
+      if (!connection->connect(info)) {
+        *error = connection->lastError();
+        return std::shared_ptr<backend::ScratchbirdConnection>();
       }
+      return connection;
+    });
+    if (script_thread_.joinable()) {
+      script_thread_.join();  // The previous script, already finished
     }
     
-    showStatusMessage(tr("Script executed: %1 succeeded, %2 failed").arg(executed).arg(failed), 5000);
+    showStatusMessage(tr("Executing script..."), 0);
+    query_running_ = true;
+    script_thread_ = std::thread([this, runner = script_runner_, script = sql.toStdString(),
+                                  connection = db_connection_,
+                                  in_transaction = transaction_open_,
+                                  parallel = parallel_scripts_]() {
+      auto plan = std::make_shared<core::ScriptPlan>(core::ScriptRunner::Plan(script));
+      core::ScriptRunOptions options;
+      if (!parallel || in_transaction || core::ScriptRunner::LeavesTransactionOpen(*plan)) {
+        options.connection = connection;
+      }
+      auto result = std::make_shared<core::ScriptRunResult>(runner->Run(*plan, options));
+      QMetaObject::invokeMethod(this, [this, plan, result]() {
+        onScriptFinished(*plan, *result);
+      }, Qt::QueuedConnection);
+    });
+  }
+}
+
+void MainWindow::onScriptFinished(const core::ScriptPlan& plan,
+                                  const core::ScriptRunResult& result) {
+  query_running_ = false;
+  script_runner_.reset();
+  
+  // Statements stop at the first failure of a block, so an unclosed BEGIN
+  // whose last statement ran is still open on db_connection_
+  if (core::ScriptRunner::LeavesTransactionOpen(plan) &&
+      result.statements[plan.units.back().statements.back()].executed) {
+    transaction_open_ = true;
+  }
+  
+  const core::ScriptStatementResult* first_failure = nullptr;
+  for (const auto& statement_result : result.statements) {
+    const core::ScriptStatement& statement = plan.statements[statement_result.statement];
+    if (statement_result.executed && catalog_client_) {
+      catalog_client_->InvalidateForStatement(statement.sql);  // No-op unless DDL
+    }
+    if (!first_failure && !statement_result.status.ok && !statement_result.skipped) {
+      first_failure = &statement_result;
+    }
   }
+  if (first_failure) {
+    const core::ScriptStatement& statement = plan.statements[first_failure->statement];
+    showError(tr("Statement at line %1 failed: %2\nError: %3")
+              .arg(statement.line)
+              .arg(QString::fromStdString(statement.sql).left(50))
+              .arg(QString::fromStdString(first_failure->status.message)));
+  }
+  
+  showStatusMessage(tr("Script executed in %1 ms on %2 connections: "
+                       "%3 succeeded, %4 failed, %5 skipped%6")
+                    .arg(result.elapsed_ms)
+                    .arg(result.connections)
+                    .arg(result.executed - result.failed)
+                    .arg(result.failed)
+                    .arg(result.skipped)
+                    .arg(result.cancelled ? tr(" (cancelled)") : QString()), 5000);
 }
 
 void MainWindow::onQueryStop() {
-  if (!current_query_task_id_.empty()) {
+  if (script_runner_) {
+    script_runner_->Cancel();
+    showStatusMessage(tr("Script cancellation requested"), 2000);
+    return;
+  }
+  if (current_query_task_id_ != core::kInvalidQueryTaskId) {
     if (async_executor_.CancelQuery(current_query_task_id_)) {
       showStatusMessage(tr("Query cancellation requested"), 2000);
     } else {
@@ -1516,12 +1777,12 @@ void MainWindow::onQueryLowercase() {
 
 // Transaction menu slots
 void MainWindow::onTransactionStart() {
-  if (!db_connection_ || !db_connection_->isConnected()) {
-    showError(tr("Not connected to database"));
+  if (!claimConnection([this]() { onTransactionStart(); })) {
     return;
   }
   
   if (db_connection_->beginTransaction()) {
+    transaction_open_ = true;
     showStatusMessage(tr("Transaction started"), 3000);
   } else {
     showError(tr("Failed to start transaction: %1")
@@ -1530,12 +1791,12 @@ void MainWindow::onTransactionStart() {
 }
 
 void MainWindow::onTransactionCommit() {
-  if (!db_connection_ || !db_connection_->isConnected()) {
-    showError(tr("Not connected to database"));
+  if (!claimConnection([this]() { onTransactionCommit(); })) {
     return;
   }
   
   if (db_connection_->commit()) {
+    transaction_open_ = false;
     showStatusMessage(tr("Transaction committed"), 3000);
   } else {
     showError(tr("Failed to commit transaction: %1")
@@ -1544,12 +1805,12 @@ void MainWindow::onTransactionCommit() {
 }
 
 void MainWindow::onTransactionRollback() {
-  if (!db_connection_ || !db_connection_->isConnected()) {
-    showError(tr("Not connected to database"));
+  if (!claimConnection([this]() { onTransactionRollback(); })) {
     return;
   }
   
   if (db_connection_->rollback()) {
+    transaction_open_ = false;
     showStatusMessage(tr("Transaction rolled back"), 3000);
   } else {
     showError(tr("Failed to rollback transaction: %1")
@@ -1568,7 +1829,7 @@ void MainWindow::onTransactionSavepoint() {
                                        tr("Savepoint name:"),
                                        QLineEdit::Normal,
                                        tr("SAVEPOINT_1"), &ok);
-  if (ok && !name.isEmpty()) {
+  if (ok && !name.isEmpty() && claimConnection()) {
     QString sql = QString("SAVEPOINT %1").arg(name);
     auto result = db_connection_->execute(sql.toStdString());
     if (result.success) {
@@ -1736,6 +1997,9 @@ void MainWindow::onToolsImportCsv() {
       showError(tr("No data to import"));
       return;
     }
+    if (!claimConnection()) {
+      return;
+    }
 
     // Build CREATE TABLE statement if requested
     if (options.create_table) {
@@ -1749,64 +2013,89 @@ void MainWindow::onToolsImportCsv() {
       }
       createSql += ")";
 
-      auto result = db_connection_->execute(createSql.toStdString());
-      if (!result.success) {
-        showError(tr("Failed to create table: %1").arg(QString::fromStdString(result.error_message)));
+      const auto result = query_router_->execute(createSql.toStdString());
+      if (!result.status.ok) {
+        showError(tr("Failed to create table: %1").arg(QString::fromStdString(result.status.message)));
         return;
       }
     }
 
-    // Insert data in batches
-    int totalRows = dataRows.size();
-    int imported = 0;
-    int failed = 0;
+    if (csv_importer_ && csv_importer_->IsImportRunning(csv_import_id_)) {
+      showError(tr("A CSV import is already running"));
+      return;
+    }
+    if (!csv_importer_) {
+      csv_importer_ = std::make_unique<core::StreamingDataImporter>();
+    }
 
-    for (int i = 0; i < dataRows.size(); i += options.batch_size) {
-      QString insertSql = "INSERT INTO \"" + options.table_name + "\" (";
-      for (int h = 0; h < headers.size(); ++h) {
-        if (h > 0) insertSql += ", ";
-        QString colName = headers[h].trimmed();
-        colName.replace("\"", "\"\"");
-        insertSql += "\"" + colName + "\"";
+    // Stream the file rather than the dialog's in-memory copy; the bulk
+    // pipeline keeps statements in flight while later rows are parsed
+    core::ImportConfig config;
+    csv_import_id_ = "csv_import_" + std::to_string(QDateTime::currentMSecsSinceEpoch());
+    config.import_id = csv_import_id_;
+    config.source_path = fileName.toStdString();
+    config.target_table = options.table_name.toStdString();
+    config.mode = core::ImportMode::kAppend;
+    config.csv_options.delimiter = options.delimiter.toLatin1();
+    config.csv_options.quote = options.quote.toLatin1();
+    config.csv_options.escape = config.csv_options.quote;
+    config.csv_options.has_header = options.has_header;
+    config.csv_options.encoding = options.encoding.toStdString();
+    config.batch_size = options.batch_size;
+    config.max_errors = 0;
+    config.quote_identifiers = true;  // Matches the quoted CREATE TABLE above
+    for (int i = 0; i < headers.size(); ++i) {
+      core::ColumnMapping mapping;
+      mapping.source_column = options.has_header ? headers[i].toStdString()
+                                                 : "column" + std::to_string(i + 1);
+      mapping.target_column = headers[i].trimmed().toStdString();
+      config.column_mappings.push_back(std::move(mapping));
+    }
+    if (const auto* runtime = session_client_ ? session_client_->GetRuntimeConfig() : nullptr) {
+      config.bulk_client = std::make_shared<backend::ScratchbirdSbwpClient>(*runtime);
+    } else {
+      // The import runs on its own connection so the editor and grid can
+      // keep using db_connection_ while it streams
+      auto connection = std::make_shared<backend::ScratchbirdConnection>();
+      if (!connection->connect(db_connection_->connectionInfo())) {
+        showError(tr("Cannot open a connection for the import: %1")
+                      .arg(QString::fromStdString(connection->lastError())));
+        return;
       }
-      insertSql += ") VALUES ";
-
-      int batchEnd = qMin(i + options.batch_size, dataRows.size());
-      bool firstValue = true;
-
-      for (int row = i; row < batchEnd; ++row) {
-        if (!firstValue) insertSql += ", ";
-        firstValue = false;
-
-        insertSql += "(";
-        const QStringList& rowData = dataRows[row];
-        for (int col = 0; col < headers.size(); ++col) {
-          if (col > 0) insertSql += ", ";
-          if (col < rowData.size()) {
-            QString val = rowData[col];
-            val.replace("'", "''");
-            insertSql += "'" + val + "'";
-          } else {
-            insertSql += "NULL";
+      config.connection = std::move(connection);
+    }
+
+    const qint64 totalRows = dataRows.size();
+    csv_importer_->SetProgressCallback([this, totalRows](const core::ImportProgress& progress) {
+      QMetaObject::invokeMethod(this, [this, totalRows, rows = progress.rows_processed]() {
+        showStatusMessage(tr("Importing: %1/%2 rows").arg(rows).arg(totalRows), 1000);
+      }, Qt::QueuedConnection);
+    });
+    csv_importer_->SetCompletionCallback([this](const core::ImportResult& result) {
+      QMetaObject::invokeMethod(this, [this, result]() {
+        if (!result.status.ok) {
+          showError(tr("CSV import failed: %1").arg(QString::fromStdString(result.status.message)));
+        } else if (!result.errors.empty()) {
+          QStringList errors;
+          for (size_t i = 0; i < result.errors.size() && i < 20; ++i) {
+            errors << QString::fromStdString(result.errors[i]);
           }
+          showError(tr("%1 rows were rejected:\n%2")
+                        .arg(result.total_rows_failed)
+                        .arg(errors.join("\n")));
         }
-        insertSql += ")";
-      }
-
-      auto result = db_connection_->execute(insertSql.toStdString());
-      if (result.success) {
-        imported += (batchEnd - i);
-      } else {
-        failed += (batchEnd - i);
-        showError(tr("Batch insert failed: %1").arg(QString::fromStdString(result.error_message)));
-      }
-
-      // Update progress
-      showStatusMessage(tr("Importing: %1/%2 rows").arg(imported).arg(totalRows), 1000);
-      QApplication::processEvents();
+        showStatusMessage(tr("CSV import complete: %1 imported, %2 failed")
+                              .arg(result.total_rows_inserted)
+                              .arg(result.total_rows_failed), 5000);
+      }, Qt::QueuedConnection);
+    });
+
+    const auto problems = csv_importer_->ValidateImportConfig(config);
+    if (!problems.empty()) {
+      showError(QString::fromStdString(problems.front().error_message));
+      return;
     }
-
-    showStatusMessage(tr("CSV import complete: %1 imported, %2 failed").arg(imported).arg(failed), 5000);
+    csv_importer_->ExecuteImportAsync(config);
   }
 }
 
@@ -1876,12 +2165,19 @@ void MainWindow::onToolsImportJson() {
   }
   createSql += ")";
 
-  auto createResult = db_connection_->execute(createSql.toStdString());
-  if (!createResult.success) {
-    showError(tr("Failed to create table: %1").arg(QString::fromStdString(createResult.error_message)));
+  if (!claimConnection()) {
+    return;
+  }
+  const auto createResult = query_router_->execute(createSql.toStdString());
+  if (!createResult.status.ok) {
+    showError(tr("Failed to create table: %1").arg(QString::fromStdString(createResult.status.message)));
     return;
   }
 
+  // The loop below keeps the GUI responsive, so keep other statements off
+  // the connection until it is done
+  query_running_ = true;
+
   // Insert data
   int imported = 0;
   int batchSize = 100;
@@ -1936,6 +2232,7 @@ void MainWindow::onToolsImportJson() {
     showStatusMessage(tr("Importing JSON: %1/%2").arg(imported).arg(array.size()), 1000);
     QApplication::processEvents();
   }
+  query_running_ = false;
 
   showStatusMessage(tr("JSON import complete: %1 rows imported").arg(imported), 5000);
 }
@@ -2393,8 +2690,7 @@ void MainWindow::onToolsScheduler() {
 }
 
 void MainWindow::onToolsMonitorConnections() {
-  if (!db_connection_ || !db_connection_->isConnected()) {
-    showError(tr("Not connected to database"));
+  if (!claimConnection([this]() { onToolsMonitorConnections(); })) {
     return;
   }
   
@@ -2,7 +2,10 @@
 
 #include <QMainWindow>
 #include <QSplitter>
+#include <functional>
 #include <memory>
+#include <string>
+#include <thread>
 
 #include "core/async_query_executor.h"
 
@@ -23,7 +26,18 @@ QT_END_NAMESPACE
 namespace scratchrobin::backend {
 class SessionClient;
 class ScratchbirdConnection;
+class ScratchbirdSbwpClient;
 class ConnectionInfo;
+class QueryRouter;
+class SblrCompileCache;
+}
+
+namespace scratchrobin::core {
+class ScratchBirdCatalogClient;
+class ScriptRunner;
+class StreamingDataImporter;
+struct ScriptPlan;
+struct ScriptRunResult;
 }
 
 namespace scratchrobin::ui {
@@ -78,8 +92,12 @@ class MainWindow : public QMainWindow {
   explicit MainWindow(backend::SessionClient* session_client, QWidget* parent = nullptr);
   ~MainWindow() override;
 
+  // DDL run through the window's router invalidates |cache| as well
+  void setCompileCache(backend::SblrCompileCache* cache);
+
   void executeSql(const QString& sql);
   void showResults(const QList<QStringList>& data, const QStringList& headers);
+  void showResults(core::ResultSet result);
   void showError(const QString& message);
   void showStatusMessage(const QString& message, int timeout = 3000);
 
@@ -247,16 +265,58 @@ class MainWindow : public QMainWindow {
   
   SqlEditor* currentEditor() const;
   void executeCurrentEditor();
+  void onQueryBatch(quint64 generation, core::ResultSet batch, bool has_more);
+  void onQueryFinished(quint64 generation, const core::Status& status,
+                       qint64 rows_returned, qint64 elapsed_ms);
+  // True when db_connection_ is free for a statement on the GUI thread.
+  // False, with a message, while another statement or script needs it. A
+  // query the grid is paging through is cancelled instead, and |retry|
+  // runs once it has let go of the connection.
+  bool claimConnection(std::function<void()> retry = {});
+  // Cancels the running query without waiting for it. Its remaining rows
+  // are dropped and |then| runs when its completion reaches the GUI thread.
+  void cancelRunningQuery(std::function<void()> then = {});
+  void onScriptFinished(const core::ScriptPlan& plan, const core::ScriptRunResult& result);
   void applyPreferences(const Preferences& prefs);
   void updateWindowTitle(const QString& filename = QString());
 
   backend::SessionClient* session_client_;
-  std::unique_ptr<backend::ScratchbirdConnection> db_connection_;
+  std::shared_ptr<backend::ScratchbirdConnection> db_connection_;
+  // The session's SBWP server, where the router prepares parameterized
+  // statements; null without a runtime config or SBWP support
+  std::unique_ptr<backend::ScratchbirdSbwpClient> sbwp_client_;
+  // Statements the GUI runs itself on db_connection_ (import DDL); its
+  // DDL listener invalidates the catalog
+  std::unique_ptr<backend::QueryRouter> query_router_;
+  // Navigator catalog reads, on a connection of their own
+  std::shared_ptr<core::ScratchBirdCatalogClient> catalog_client_;
   
-  // Async query execution
+  // Async query execution. Batches and completion are posted back to the
+  // GUI thread; the generation tags them with the query they belong to.
   core::AsyncQueryExecutor async_executor_;
-  std::string current_query_task_id_;
+  core::QueryTaskId current_query_task_id_ = core::kInvalidQueryTaskId;
   bool query_running_ = false;
+  bool query_abandoned_ = false;  // Cancelled to free db_connection_
+  std::function<void()> after_query_;
+  quint64 query_generation_ = 0;
+  qint64 query_rows_received_ = 0;
+  static constexpr size_t kQueryBatchRows = 1000;
+  static constexpr size_t kQueryPrefetchBatches = 2;
+  
+  // Scripts run on a thread of their own, spreading independent
+  // statements over extra connections like db_connection_
+  std::shared_ptr<core::ScriptRunner> script_runner_;
+  std::thread script_thread_;
+  // A transaction is open on db_connection_ (Transaction > Start, or a
+  // BEGIN run from the editor); scripts then run on it, in order
+  bool transaction_open_ = false;
+  // Query > Run Scripts in Parallel; otherwise scripts run in order on one
+  // connection, since their dependencies are only inferred from names
+  bool parallel_scripts_ = false;
+  
+  // CSV imports stream from the file on the importer's threads
+  std::unique_ptr<core::StreamingDataImporter> csv_importer_;
+  std::string csv_import_id_;
   
   // Dock Workspace (new)
   DockWorkspace* dock_workspace_;
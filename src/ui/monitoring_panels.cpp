@@ -1,5 +1,11 @@
 #include "ui/monitoring_panels.h"
+#include "backend/scratchbird_sbwp_client.h"
 #include "backend/session_client.h"
+#include "core/metrics_sampler.h"
+
+#include <chrono>
+#include <map>
+#include <utility>
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -21,12 +27,121 @@
 #include <QProgressBar>
 #include <QGroupBox>
 #include <QTimer>
-#include <QRandomGenerator>
+#include <QSet>
+#include <QSignalBlocker>
 #include <QDebug>
 #include <QDateTime>
 
 namespace scratchrobin::ui {
 
+namespace {
+
+// Column |name| of a sample, -1 when the source does not return it
+int columnOf(const core::ResultSet& result, const char* name) {
+    for (std::size_t col = 0; col < result.ColumnCount(); ++col) {
+        if (result.columns[col] == name) {
+            return static_cast<int>(col);
+        }
+    }
+    return -1;
+}
+
+// Empty for NULL and missing columns
+QString cellText(const core::ResultSet& result, std::size_t row, int col) {
+    if (col < 0 || result.Column(col).IsNull(row)) {
+        return QString();
+    }
+    return QString::fromStdString(result.Column(col).Format(row));
+}
+
+qint64 cellInt(const core::ResultSet& result, std::size_t row, int col) {
+    return cellText(result, row, col).toLongLong();
+}
+
+QString sampleError(const core::MetricSample& sample) {
+    return QString::fromStdString(sample.status.message);
+}
+
+} // namespace
+
+// ============================================================================
+// Shared Stat Sampling
+// ============================================================================
+
+std::shared_ptr<core::MetricsSampler> sharedMetricsSampler(backend::SessionClient* client) {
+    // Only used from the GUI thread
+    static std::map<backend::SessionClient*, std::weak_ptr<core::MetricsSampler>> samplers;
+    auto& entry = samplers[client];
+    if (auto sampler = entry.lock()) {
+        return sampler;
+    }
+    
+    // Without a runtime config the stat queries go through the session itself
+    core::MetricsSampler::QueryFunction query;
+    if (const auto* runtime = client ? client->GetRuntimeConfig() : nullptr) {
+        auto connection = std::make_shared<backend::ScratchbirdSbwpClient>(*runtime);
+        query = [connection](const std::string& sql, core::ResultSet* result) {
+            auto response = connection->ExecuteSql(sql);
+            *result = std::move(response.result_set);
+            return response.status;
+        };
+    } else if (client) {
+        query = [client](const std::string& sql, core::ResultSet* result) {
+            auto response = client->ExecuteSql(4044, "scratchbird", sql);
+            *result = std::move(response.result_set);
+            return response.status;
+        };
+    }
+    auto sampler = std::make_shared<core::MetricsSampler>(std::move(query));
+    core::AddServerStatSources(sampler.get());
+    entry = sampler;
+    return sampler;
+}
+
+MetricSubscription::MetricSubscription(std::shared_ptr<core::MetricsSampler> sampler,
+                                       std::string source, QObject* receiver, Handler handler)
+    : sampler_(std::move(sampler))
+    , source_(std::move(source))
+    , receiver_(receiver)
+    , handler_(std::make_shared<Handler>(std::move(handler))) {
+    subscribe();
+}
+
+MetricSubscription::~MetricSubscription() {
+    if (sampler_ && id_) {
+        sampler_->Unsubscribe(id_);
+    }
+}
+
+void MetricSubscription::setInterval(int intervalMs) {
+    if (intervalMs == intervalMs_) {
+        return;
+    }
+    intervalMs_ = intervalMs;
+    if (sampler_ && id_) {
+        sampler_->Unsubscribe(id_);
+    }
+    subscribe();
+}
+
+void MetricSubscription::refresh() {
+    if (sampler_) {
+        sampler_->RequestRefresh(source_);
+    }
+}
+
+void MetricSubscription::subscribe() {
+    if (!sampler_) {
+        return;
+    }
+    // The receiver outlives the subscription, so posting to it is safe
+    id_ = sampler_->Subscribe(source_, intervalMs_,
+        [receiver = receiver_, handler = handler_](const core::MetricSample& sample) {
+            QMetaObject::invokeMethod(receiver, [handler, sample]() { (*handler)(sample); },
+                                      Qt::QueuedConnection);
+        });
+}
+
 // ============================================================================
 // ConnectionMonitorPanel
 // ============================================================================
@@ -34,9 +149,14 @@ namespace scratchrobin::ui {
 ConnectionMonitorPanel::ConnectionMonitorPanel(backend::SessionClient* client, QWidget* parent)
     : QWidget(parent), client_(client) {
     setupUi();
-    loadConnections();
+    sessions_ = std::make_unique<MetricSubscription>(
+        sharedMetricsSampler(client_), core::kMetricSessions, this,
+        [this](const core::MetricSample& sample) { onSessionsSample(sample); });
+    refresh();
 }
 
+ConnectionMonitorPanel::~ConnectionMonitorPanel() = default;
+
 void ConnectionMonitorPanel::setupUi() {
     auto* mainLayout = new QVBoxLayout(this);
     mainLayout->setSpacing(8);
@@ -101,74 +221,60 @@ void ConnectionMonitorPanel::setupUi() {
     connect(table_, &QTableWidget::itemSelectionChanged, [this]() {
         terminateBtn_->setEnabled(!table_->selectedItems().isEmpty());
     });
-    
-    // Refresh timer
-    refreshTimer_ = new QTimer(this);
-    connect(refreshTimer_, &QTimer::timeout, this, &ConnectionMonitorPanel::onRefresh);
 }
 
 void ConnectionMonitorPanel::refresh() {
-    loadConnections();
+    sessions_->refresh();
 }
 
 void ConnectionMonitorPanel::setAutoRefresh(bool enabled, int intervalMs) {
-    if (enabled) {
-        refreshTimer_->start(intervalMs);
-    } else {
-        refreshTimer_->stop();
-    }
+    sessions_->setInterval(enabled ? intervalMs : 0);
+    QSignalBlocker blocker(autoRefreshCheck_);
+    autoRefreshCheck_->setChecked(enabled);
 }
 
 void ConnectionMonitorPanel::onRefresh() {
-    loadConnections();
+    refresh();
 }
 
-void ConnectionMonitorPanel::loadConnections() {
-    currentConnections_ = fetchConnections();
-    populateTable(currentConnections_);
-}
-
-QList<DbConnectionInfo> ConnectionMonitorPanel::fetchConnections() {
+void ConnectionMonitorPanel::onSessionsSample(const core::MetricSample& sample) {
+    if (!sample.status.ok) {
+        statusLabel_->setText(tr("Refresh failed: %1").arg(sampleError(sample)));
+        return;
+    }
+    
+    const core::ResultSet& result = *sample.result;
+    const int pid = columnOf(result, "pid");
+    const int user = columnOf(result, "usename");
+    const int database = columnOf(result, "datname");
+    const int address = columnOf(result, "client_addr");
+    const int application = columnOf(result, "application_name");
+    const int state = columnOf(result, "state");
+    const int query = columnOf(result, "query");
+    const int started = columnOf(result, "backend_start_ms");
+    const int queryMs = columnOf(result, "query_ms");
+    
     QList<DbConnectionInfo> connections;
+    for (std::size_t row = 0; row < result.RowCount(); ++row) {
+        DbConnectionInfo conn;
+        conn.pid = static_cast<int>(cellInt(result, row, pid));
+        conn.id = conn.pid;
+        conn.username = cellText(result, row, user);
+        conn.database = cellText(result, row, database);
+        conn.clientAddress = cellText(result, row, address);
+        conn.applicationName = cellText(result, row, application);
+        conn.state = cellText(result, row, state);
+        conn.currentQuery = cellText(result, row, query);
+        conn.connectedSince = QDateTime::fromMSecsSinceEpoch(cellInt(result, row, started));
+        // An idle session's query is its last one, finished long ago
+        if (conn.state != "idle") {
+            conn.queryDurationMs = cellInt(result, row, queryMs);
+        }
+        connections.append(conn);
+    }
     
-    // Mock data - would query database in real implementation
-    DbConnectionInfo conn1;
-    conn1.id = 1;
-    conn1.pid = 12345;
-    conn1.username = "admin";
-    conn1.database = "production";
-    conn1.clientAddress = "192.168.1.100:54321";
-    conn1.state = "active";
-    conn1.currentQuery = "SELECT * FROM orders WHERE created_at > '2026-01-01'";
-    conn1.queryDurationMs = 1500;
-    conn1.connectedSince = QDateTime::currentDateTime().addSecs(-3600);
-    conn1.applicationName = "ScratchRobin";
-    connections.append(conn1);
-    
-    DbConnectionInfo conn2;
-    conn2.id = 2;
-    conn2.pid = 12346;
-    conn2.username = "app_user";
-    conn2.database = "production";
-    conn2.clientAddress = "192.168.1.101:54322";
-    conn2.state = "idle";
-    conn2.connectedSince = QDateTime::currentDateTime().addSecs(-7200);
-    conn2.applicationName = "WebApp";
-    connections.append(conn2);
-    
-    DbConnectionInfo conn3;
-    conn3.id = 3;
-    conn3.pid = 12347;
-    conn3.username = "reporting";
-    conn3.database = "warehouse";
-    conn3.clientAddress = "192.168.1.102:54323";
-    conn3.state = "idle in transaction";
-    conn3.queryDurationMs = 300000;  // 5 minutes - long running
-    conn3.connectedSince = QDateTime::currentDateTime().addSecs(-18000);
-    conn3.applicationName = "ReportGenerator";
-    connections.append(conn3);
-    
-    return connections;
+    currentConnections_ = connections;
+    populateTable(currentConnections_);
 }
 
 void ConnectionMonitorPanel::populateTable(const QList<DbConnectionInfo>& connections) {
@@ -274,8 +380,14 @@ void ConnectionMonitorPanel::updateDisplay() {
 TransactionMonitorPanel::TransactionMonitorPanel(backend::SessionClient* client, QWidget* parent)
     : QWidget(parent), client_(client) {
     setupUi();
+    // Transactions are read off the same session sample as the connections
+    sessions_ = std::make_unique<MetricSubscription>(
+        sharedMetricsSampler(client_), core::kMetricSessions, this,
+        [this](const core::MetricSample& sample) { onSessionsSample(sample); });
 }
 
+TransactionMonitorPanel::~TransactionMonitorPanel() = default;
+
 void TransactionMonitorPanel::setupUi() {
     auto* mainLayout = new QVBoxLayout(this);
     
@@ -317,21 +429,68 @@ void TransactionMonitorPanel::setupUi() {
 }
 
 void TransactionMonitorPanel::refresh() {
-    loadTransactions();
+    sessions_->refresh();
+}
+
+void TransactionMonitorPanel::setAutoRefresh(bool enabled, int intervalMs) {
+    sessions_->setInterval(enabled ? intervalMs : 0);
 }
 
-void TransactionMonitorPanel::loadTransactions() {
-    // Mock transaction data
+void TransactionMonitorPanel::onSessionsSample(const core::MetricSample& sample) {
+    if (!sample.status.ok) {
+        detailsEdit_->setPlainText(tr("Refresh failed: %1").arg(sampleError(sample)));
+        return;
+    }
+    
+    const core::ResultSet& result = *sample.result;
+    const int pid = columnOf(result, "pid");
+    const int database = columnOf(result, "datname");
+    const int state = columnOf(result, "state");
+    const int query = columnOf(result, "query");
+    const int xid = columnOf(result, "xid");
+    const int started = columnOf(result, "xact_start_ms");
+    const int xactMs = columnOf(result, "xact_ms");
+    
     table_->setRowCount(0);
+    int activeCount = 0;
+    int idleCount = 0;
+    int longRunningCount = 0;
+    for (std::size_t row = 0; row < result.RowCount(); ++row) {
+        if (cellText(result, row, started).isEmpty()) {
+            continue;  // No open transaction
+        }
+        const QString sessionState = cellText(result, row, state);
+        const qint64 durationMs = cellInt(result, row, xactMs);
+        const QString id = cellText(result, row, xid);
+        
+        int r = table_->rowCount();
+        table_->insertRow(r);
+        table_->setItem(r, 0, new QTableWidgetItem(id.isEmpty() ? QStringLiteral("-") : id));
+        table_->setItem(r, 1, new QTableWidgetItem(cellText(result, row, pid)));
+        table_->setItem(r, 2, new QTableWidgetItem(cellText(result, row, database)));
+        table_->setItem(r, 3, new QTableWidgetItem(
+            QDateTime::fromMSecsSinceEpoch(cellInt(result, row, started)).toString("hh:mm:ss")));
+        table_->setItem(r, 4, new QTableWidgetItem(QString("%1 ms").arg(durationMs)));
+        table_->setItem(r, 5, new QTableWidgetItem(cellText(result, row, query).left(80)));
+        
+        if (sessionState == "active") {
+            activeCount++;
+        } else if (sessionState.startsWith("idle in transaction")) {
+            idleCount++;
+        }
+        if (durationMs > 60000) {
+            table_->item(r, 4)->setBackground(QColor(255, 200, 200));
+            longRunningCount++;
+        }
+    }
     
-    // Would fetch from database
-    activeCountLabel_->setText(tr("Active: %1").arg(1));
-    idleCountLabel_->setText(tr("Idle: %1").arg(2));
-    longRunningLabel_->setText(tr("Long Running: %1").arg(0));
+    activeCountLabel_->setText(tr("Active: %1").arg(activeCount));
+    idleCountLabel_->setText(tr("Idle: %1").arg(idleCount));
+    longRunningLabel_->setText(tr("Long Running: %1").arg(longRunningCount));
 }
 
 void TransactionMonitorPanel::onRefresh() {
-    loadTransactions();
+    refresh();
 }
 
 void TransactionMonitorPanel::onViewDetails() {
@@ -349,8 +508,13 @@ void TransactionMonitorPanel::onRollbackTransaction() {
 LockMonitorPanel::LockMonitorPanel(backend::SessionClient* client, QWidget* parent)
     : QWidget(parent), client_(client) {
     setupUi();
+    locks_ = std::make_unique<MetricSubscription>(
+        sharedMetricsSampler(client_), core::kMetricLocks, this,
+        [this](const core::MetricSample& sample) { onLocksSample(sample); });
 }
 
+LockMonitorPanel::~LockMonitorPanel() = default;
+
 void LockMonitorPanel::setupUi() {
     auto* mainLayout = new QVBoxLayout(this);
     
@@ -393,40 +557,56 @@ void LockMonitorPanel::setupUi() {
 }
 
 void LockMonitorPanel::refresh() {
-    loadLocks();
+    locks_->refresh();
 }
 
-void LockMonitorPanel::loadLocks() {
-    currentLocks_ = fetchLocks();
-    populateTable(currentLocks_);
-    detectDeadlocks();
+void LockMonitorPanel::setAutoRefresh(bool enabled, int intervalMs) {
+    locks_->setInterval(enabled ? intervalMs : 0);
 }
 
-QList<LockInfo> LockMonitorPanel::fetchLocks() {
+void LockMonitorPanel::onLocksSample(const core::MetricSample& sample) {
+    if (!sample.status.ok) {
+        blockedCountLabel_->setText(tr("Refresh failed: %1").arg(sampleError(sample)));
+        return;
+    }
+    
+    const core::ResultSet& result = *sample.result;
+    const int lockType = columnOf(result, "locktype");
+    const int mode = columnOf(result, "mode");
+    const int granted = columnOf(result, "granted");
+    const int pid = columnOf(result, "pid");
+    const int relation = columnOf(result, "relation");
+    const int transaction = columnOf(result, "transactionid");
+    const int blockedBy = columnOf(result, "blocked_by");
+    
     QList<LockInfo> locks;
+    QSet<int> blockers;
+    for (std::size_t row = 0; row < result.RowCount(); ++row) {
+        LockInfo lock;
+        lock.lockId = static_cast<int>(row) + 1;
+        lock.processId = static_cast<int>(cellInt(result, row, pid));
+        lock.transactionId = static_cast<int>(cellInt(result, row, transaction));
+        lock.lockMode = cellText(result, row, mode);
+        lock.lockType = cellText(result, row, lockType);
+        lock.tableName = cellText(result, row, relation);
+        const QString isGranted = cellText(result, row, granted).toLower();
+        lock.status = (isGranted == "t" || isGranted == "true") ? "granted" : "waiting";
+        const QStringList pids = cellText(result, row, blockedBy).split(',', Qt::SkipEmptyParts);
+        for (const QString& blocker : pids) {
+            blockers.insert(blocker.toInt());
+        }
+        if (!pids.isEmpty()) {
+            lock.blockedProcessId = pids.first().toInt();
+        }
+        locks.append(lock);
+    }
+    for (auto& lock : locks) {
+        lock.isBlocking = lock.status == "granted" && blockers.contains(lock.processId);
+    }
     
-    // Mock lock data
-    LockInfo lock1;
-    lock1.lockId = 1;
-    lock1.processId = 12345;
-    lock1.lockMode = "EXCLUSIVE";
-    lock1.lockType = "relation";
-    lock1.tableName = "orders";
-    lock1.status = "granted";
-    locks.append(lock1);
-    
-    LockInfo lock2;
-    lock2.lockId = 2;
-    lock2.processId = 12346;
-    lock2.lockMode = "SHARE";
-    lock2.lockType = "relation";
-    lock2.tableName = "orders";
-    lock2.status = "waiting";
-    lock2.blockedProcessId = 12345;
-    lock2.isBlocking = true;
-    locks.append(lock2);
-    
-    return locks;
+    currentLocks_ = locks;
+    populateTable(currentLocks_);
+    detectDeadlocks();
 }
 
 void LockMonitorPanel::populateTable(const QList<LockInfo>& locks) {
@@ -462,7 +642,7 @@ void LockMonitorPanel::detectDeadlocks() {
 }
 
 void LockMonitorPanel::onRefresh() {
-    loadLocks();
+    refresh();
 }
 
 void LockMonitorPanel::onKillBlockingProcess() {
@@ -481,10 +661,17 @@ PerformanceMonitorPanel::PerformanceMonitorPanel(backend::SessionClient* client,
     : QWidget(parent), client_(client) {
     setupUi();
     
-    refreshTimer_ = new QTimer(this);
-    connect(refreshTimer_, &QTimer::timeout, this, &PerformanceMonitorPanel::onRefresh);
+    auto sampler = sharedMetricsSampler(client_);
+    database_ = std::make_unique<MetricSubscription>(
+        sampler, core::kMetricDatabase, this,
+        [this](const core::MetricSample& sample) { onDatabaseSample(sample); });
+    sessions_ = std::make_unique<MetricSubscription>(
+        sampler, core::kMetricSessions, this,
+        [this](const core::MetricSample& sample) { onSessionsSample(sample); });
 }
 
+PerformanceMonitorPanel::~PerformanceMonitorPanel() = default;
+
 void PerformanceMonitorPanel::setupUi() {
     auto* mainLayout = new QVBoxLayout(this);
     
@@ -521,7 +708,7 @@ void PerformanceMonitorPanel::setupUi() {
         metricsLayout->addWidget(valueLabel, r, c * 2 + 1);
     };
     
-    addMetric(tr("Queries/sec"), qpsLabel_, row, 0);
+    addMetric(tr("Rows/sec"), qpsLabel_, row, 0);
     addMetric(tr("Trans/sec"), tpsLabel_, row++, 1);
     addMetric(tr("Cache Hit %"), cacheHitLabel_, row, 0);
     addMetric(tr("Connections"), connectionsLabel_, row++, 1);
@@ -552,15 +739,13 @@ void PerformanceMonitorPanel::setupUi() {
 }
 
 void PerformanceMonitorPanel::refresh() {
-    collectMetrics();
+    database_->refresh();
+    sessions_->refresh();
 }
 
 void PerformanceMonitorPanel::setAutoRefresh(bool enabled, int intervalMs) {
-    if (enabled) {
-        refreshTimer_->start(intervalMs);
-    } else {
-        refreshTimer_->stop();
-    }
+    database_->setInterval(enabled ? intervalMs : 0);
+    sessions_->setInterval(enabled ? intervalMs : 0);
 }
 
 void PerformanceMonitorPanel::startRecording() {
@@ -583,11 +768,11 @@ void PerformanceMonitorPanel::exportData(const QString& fileName) {
     if (!file.open(QIODevice::WriteOnly)) return;
     
     QTextStream stream(&file);
-    stream << "timestamp,qps,tps,cache_hit,connections,avg_query_time\n";
+    stream << "timestamp,rows_per_sec,tps,cache_hit,connections,avg_query_time\n";
     
     for (const auto& m : metricsHistory_) {
         stream << m.timestamp.toString(Qt::ISODate) << ","
-               << m.queriesPerSecond << ","
+               << m.rowsPerSecond << ","
                << m.transactionsPerSecond << ","
                << m.cacheHitRatio << ","
                << m.activeConnections << ","
@@ -598,7 +783,7 @@ void PerformanceMonitorPanel::exportData(const QString& fileName) {
 }
 
 void PerformanceMonitorPanel::onRefresh() {
-    collectMetrics();
+    refresh();
 }
 
 void PerformanceMonitorPanel::onToggleRecording(bool checked) {
@@ -626,63 +811,102 @@ void PerformanceMonitorPanel::updateCharts() {
     // Update chart displays
 }
 
-void PerformanceMonitorPanel::collectMetrics() {
-    auto metrics = fetchMetrics();
-    metrics.timestamp = QDateTime::currentDateTime();
+void PerformanceMonitorPanel::onDatabaseSample(const core::MetricSample& sample) {
+    core::DatabaseActivity activity;
+    if (!core::DatabaseActivity::FromSample(sample, &activity)) {
+        return;
+    }
+    if (!lastActivity_) {
+        // Rates need a second sample
+        lastActivity_ = std::make_unique<core::DatabaseActivity>(activity);
+        return;
+    }
+    
+    const auto rates = core::DatabaseRates::Between(*lastActivity_, activity);
+    *lastActivity_ = activity;
+    latest_.rowsPerSecond = rates.rows_per_sec;
+    latest_.transactionsPerSecond = rates.transactions_per_sec;
+    latest_.cacheHitRatio = rates.cache_hit_ratio;
+    // Blocks are 8 kB unless the server was built otherwise
+    latest_.diskIO = rates.blocks_read_per_sec * 8192.0 / (1024.0 * 1024.0);
+    latest_.timestamp = QDateTime::fromMSecsSinceEpoch(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            activity.taken_at.time_since_epoch()).count());
     
     if (isRecording_) {
-        metricsHistory_.append(metrics);
+        metricsHistory_.append(latest_);
     }
     
     updateMetricDisplays();
     checkAlerts();
 }
 
-void PerformanceMonitorPanel::updateMetricDisplays() {
-    if (metricsHistory_.isEmpty()) return;
+void PerformanceMonitorPanel::onSessionsSample(const core::MetricSample& sample) {
+    if (!sample.status.ok) {
+        return;
+    }
     
-    const auto& latest = metricsHistory_.last();
+    const core::ResultSet& result = *sample.result;
+    const int state = columnOf(result, "state");
+    const int wait = columnOf(result, "wait_event_type");
+    const int queryMs = columnOf(result, "query_ms");
+    
+    int active = 0;
+    int idle = 0;
+    int blocked = 0;
+    qint64 activeMs = 0;
+    for (std::size_t row = 0; row < result.RowCount(); ++row) {
+        if (cellText(result, row, state) == "active") {
+            active++;
+            activeMs += cellInt(result, row, queryMs);
+        } else {
+            idle++;
+        }
+        if (cellText(result, row, wait) == "Lock") {
+            blocked++;
+        }
+    }
+    latest_.activeConnections = active;
+    latest_.idleConnections = idle;
+    latest_.blockedConnections = blocked;
+    latest_.avgQueryTime = active > 0 ? static_cast<double>(activeMs) / active : 0.0;
     
-    qpsLabel_->setText(QString::number(latest.queriesPerSecond, 'f', 1));
-    tpsLabel_->setText(QString::number(latest.transactionsPerSecond, 'f', 1));
-    cacheHitLabel_->setText(QString::number(latest.cacheHitRatio, 'f', 1) + "%");
-    connectionsLabel_->setText(QString::number(latest.activeConnections, 'f', 0));
-    avgQueryTimeLabel_->setText(QString::number(latest.avgQueryTime, 'f', 2) + " ms");
-    cpuLabel_->setText(QString::number(latest.cpuUsage, 'f', 1) + "%");
-    memoryLabel_->setText(QString::number(latest.memoryUsage, 'f', 1) + " MB");
-    diskIOLabel_->setText(QString::number(latest.diskIO, 'f', 1) + " MB/s");
+    updateMetricDisplays();
 }
 
-void PerformanceMonitorPanel::checkAlerts() {
-    if (metricsHistory_.isEmpty()) return;
-    
-    const auto& latest = metricsHistory_.last();
-    
-    if (latest.queriesPerSecond > qpsThreshold_) {
-        emit alertTriggered(tr("High query rate: %1 QPS").arg(latest.queriesPerSecond), "warning");
-    }
-    if (latest.activeConnections > connectionThreshold_) {
-        emit alertTriggered(tr("High connection count: %1").arg(latest.activeConnections), "warning");
-    }
-    if (latest.cacheHitRatio < cacheHitThreshold_) {
-        emit alertTriggered(tr("Low cache hit ratio: %1%").arg(latest.cacheHitRatio), "critical");
-    }
+void PerformanceMonitorPanel::updateMetricDisplays() {
+    qpsLabel_->setText(QString::number(latest_.rowsPerSecond, 'f', 1));
+    tpsLabel_->setText(QString::number(latest_.transactionsPerSecond, 'f', 1));
+    cacheHitLabel_->setText(QString::number(latest_.cacheHitRatio, 'f', 1) + "%");
+    connectionsLabel_->setText(QString::number(latest_.activeConnections, 'f', 0));
+    avgQueryTimeLabel_->setText(QString::number(latest_.avgQueryTime, 'f', 2) + " ms");
+    // Host CPU and memory are not exposed through SQL
+    cpuLabel_->setText(tr("n/a"));
+    memoryLabel_->setText(tr("n/a"));
+    diskIOLabel_->setText(QString::number(latest_.diskIO, 'f', 1) + " MB/s");
 }
 
-PerformanceMetrics PerformanceMonitorPanel::fetchMetrics() {
-    PerformanceMetrics metrics;
-    
-    // Mock metrics - would query database statistics
-    metrics.queriesPerSecond = 150.5 + (QRandomGenerator::global()->bounded(50));
-    metrics.transactionsPerSecond = 25.0 + (QRandomGenerator::global()->bounded(10));
-    metrics.cacheHitRatio = 95.0 + (QRandomGenerator::global()->bounded(4));
-    metrics.activeConnections = 15;
-    metrics.avgQueryTime = 5.5 + (QRandomGenerator::global()->bounded(10));
-    metrics.cpuUsage = 25.0 + (QRandomGenerator::global()->bounded(20));
-    metrics.memoryUsage = 512.0 + (QRandomGenerator::global()->bounded(100));
-    metrics.diskIO = 5.0 + (QRandomGenerator::global()->bounded(5));
-    
-    return metrics;
+void PerformanceMonitorPanel::checkAlerts() {
+    if (!latest_.timestamp.isValid()) return;
+    
+    const auto& latest = latest_;
+    
+    // Alert once when a threshold is crossed, not on every sample
+    auto raise = [this](const QString& key, bool exceeded, const QString& message,
+                        const QString& severity) {
+        if (!exceeded) {
+            raisedAlerts_.remove(key);
+        } else if (!raisedAlerts_.contains(key)) {
+            raisedAlerts_.insert(key);
+            emit alertTriggered(message, severity);
+        }
+    };
+    raise("qps", latest.queriesPerSecond > qpsThreshold_,
+          tr("High query rate: %1 QPS").arg(latest.queriesPerSecond), "warning");
+    raise("connections", latest.activeConnections > connectionThreshold_,
+          tr("High connection count: %1").arg(latest.activeConnections), "warning");
+    raise("cache", latest.cacheHitRatio < cacheHitThreshold_,
+          tr("Low cache hit ratio: %1%").arg(latest.cacheHitRatio), "critical");
 }
 
 // ============================================================================
@@ -727,6 +951,13 @@ void MonitoringDashboard::setupUi() {
             this, &MonitoringDashboard::onLockConflict);
     connect(performancePanel_, &PerformanceMonitorPanel::alertTriggered,
             this, &MonitoringDashboard::onPerformanceAlert);
+    
+    // The panels share one sampler, so a source watched by several of them
+    // is still queried once per interval
+    connectionPanel_->setAutoRefresh(true);
+    transactionPanel_->setAutoRefresh(true);
+    lockPanel_->setAutoRefresh(true);
+    performancePanel_->setAutoRefresh(true);
 }
 
 void MonitoringDashboard::setActiveTab(int tabIndex) {
@@ -1,9 +1,15 @@
 #pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
 #include <QWidget>
 #include <QDialog>
 #include <QTimer>
 #include <QDateTime>
 #include <QHash>
+#include <QSet>
 
 QT_BEGIN_NAMESPACE
 class QTableWidget;
@@ -21,6 +27,12 @@ namespace scratchrobin::backend {
 class SessionClient;
 }
 
+namespace scratchrobin::core {
+class MetricsSampler;
+struct MetricSample;
+struct DatabaseActivity;
+}
+
 namespace scratchrobin::ui {
 
 /**
@@ -33,6 +45,43 @@ namespace scratchrobin::ui {
  * - Performance monitor
  */
 
+// ============================================================================
+// Shared Stat Sampling
+// ============================================================================
+
+// The sampler polling |client|'s server for every monitoring panel, on a
+// connection of its own. Created on first use, closed with its last user.
+std::shared_ptr<core::MetricsSampler> sharedMetricsSampler(backend::SessionClient* client);
+
+// A panel's subscription to one sampler source. Samples are queued to
+// |receiver|'s thread and dropped once the receiver is gone.
+class MetricSubscription {
+public:
+    using Handler = std::function<void(const core::MetricSample& sample)>;
+
+    MetricSubscription(std::shared_ptr<core::MetricsSampler> sampler, std::string source,
+                       QObject* receiver, Handler handler);
+    ~MetricSubscription();
+
+    MetricSubscription(const MetricSubscription&) = delete;
+    MetricSubscription& operator=(const MetricSubscription&) = delete;
+
+    // 0 only receives the samples other subscribers or refresh() cause
+    void setInterval(int intervalMs);
+    int interval() const { return intervalMs_; }
+    void refresh();
+
+private:
+    void subscribe();
+
+    std::shared_ptr<core::MetricsSampler> sampler_;
+    std::string source_;
+    QObject* receiver_ = nullptr;
+    std::shared_ptr<Handler> handler_;
+    uint64_t id_ = 0;
+    int intervalMs_ = 0;
+};
+
 // ============================================================================
 // Connection Information (for monitoring)
 // ============================================================================
@@ -70,6 +119,7 @@ struct LockInfo {
 // ============================================================================
 struct PerformanceMetrics {
     double queriesPerSecond = 0.0;
+    double rowsPerSecond = 0.0;
     double transactionsPerSecond = 0.0;
     double cacheHitRatio = 0.0;
     double activeConnections = 0;
@@ -90,6 +140,7 @@ class ConnectionMonitorPanel : public QWidget {
 
 public:
     explicit ConnectionMonitorPanel(backend::SessionClient* client, QWidget* parent = nullptr);
+    ~ConnectionMonitorPanel() override;
 
     void refresh();
     void setAutoRefresh(bool enabled, int intervalMs = 5000);
@@ -107,12 +158,11 @@ private slots:
 
 private:
     void setupUi();
-    void loadConnections();
-    QList<DbConnectionInfo> fetchConnections();
+    void onSessionsSample(const core::MetricSample& sample);
     void populateTable(const QList<DbConnectionInfo>& connections);
 
     backend::SessionClient* client_ = nullptr;
-    QTimer* refreshTimer_ = nullptr;
+    std::unique_ptr<MetricSubscription> sessions_;
     
     QTableWidget* table_ = nullptr;
     QPushButton* refreshBtn_ = nullptr;
@@ -132,8 +182,10 @@ class TransactionMonitorPanel : public QWidget {
 
 public:
     explicit TransactionMonitorPanel(backend::SessionClient* client, QWidget* parent = nullptr);
+    ~TransactionMonitorPanel() override;
 
     void refresh();
+    void setAutoRefresh(bool enabled, int intervalMs = 5000);
 
 signals:
     void transactionSelected(int transactionId);
@@ -145,10 +197,10 @@ private slots:
 
 private:
     void setupUi();
-    void loadTransactions();
+    void onSessionsSample(const core::MetricSample& sample);
 
     backend::SessionClient* client_ = nullptr;
-    QTimer* refreshTimer_ = nullptr;
+    std::unique_ptr<MetricSubscription> sessions_;
     
     QTableWidget* table_ = nullptr;
     QTextEdit* detailsEdit_ = nullptr;
@@ -165,8 +217,10 @@ class LockMonitorPanel : public QWidget {
 
 public:
     explicit LockMonitorPanel(backend::SessionClient* client, QWidget* parent = nullptr);
+    ~LockMonitorPanel() override;
 
     void refresh();
+    void setAutoRefresh(bool enabled, int intervalMs = 5000);
 
 signals:
     void lockConflictDetected(const LockInfo& blocked, const LockInfo& blocker);
@@ -178,13 +232,12 @@ private slots:
 
 private:
     void setupUi();
-    void loadLocks();
-    QList<LockInfo> fetchLocks();
+    void onLocksSample(const core::MetricSample& sample);
     void detectDeadlocks();
     void populateTable(const QList<LockInfo>& locks);
 
     backend::SessionClient* client_ = nullptr;
-    QTimer* refreshTimer_ = nullptr;
+    std::unique_ptr<MetricSubscription> locks_;
     
     QTableWidget* table_ = nullptr;
     QTreeWidget* lockGraph_ = nullptr;
@@ -202,6 +255,7 @@ class PerformanceMonitorPanel : public QWidget {
 
 public:
     explicit PerformanceMonitorPanel(backend::SessionClient* client, QWidget* parent = nullptr);
+    ~PerformanceMonitorPanel() override;
 
     void refresh();
     void setAutoRefresh(bool enabled, int intervalMs = 2000);
@@ -221,15 +275,18 @@ private slots:
 
 private:
     void setupUi();
-    void collectMetrics();
+    void onDatabaseSample(const core::MetricSample& sample);
+    void onSessionsSample(const core::MetricSample& sample);
     void updateMetricDisplays();
     void checkAlerts();
-    PerformanceMetrics fetchMetrics();
 
     backend::SessionClient* client_ = nullptr;
-    QTimer* refreshTimer_ = nullptr;
+    std::unique_ptr<MetricSubscription> database_;
+    std::unique_ptr<MetricSubscription> sessions_;
     bool isRecording_ = false;
     QList<PerformanceMetrics> metricsHistory_;
+    PerformanceMetrics latest_;
+    std::unique_ptr<core::DatabaseActivity> lastActivity_;  // Rates need two samples
     
     // Metric labels
     QLabel* qpsLabel_ = nullptr;
@@ -252,6 +309,7 @@ private:
     double qpsThreshold_ = 1000.0;
     double connectionThreshold_ = 100.0;
     double cacheHitThreshold_ = 90.0;
+    QSet<QString> raisedAlerts_;
 };
 
 // ============================================================================
@@ -13,9 +13,33 @@
 #include <QAction>
 #include <QApplication>
 #include <QClipboard>
+#include <QPointer>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <utility>
+#include <vector>
+
+#include "core/scratchbird_catalog_client.h"
 
 namespace scratchrobin::ui {
 
+namespace {
+
+// Item data roles (column 0)
+constexpr int kLazyRole = Qt::UserRole + 1;         // Children not loaded yet
+constexpr int kPlaceholderRole = Qt::UserRole + 2;  // "Loading..." row
+constexpr int kSchemaRole = Qt::UserRole + 3;
+constexpr int kTableRole = Qt::UserRole + 4;
+constexpr int kMatchRole = Qt::UserRole + 5;  // Filter text a server search matched
+
+QString CatalogKey(const QString& serverName, const QString& dbName) {
+  return serverName + "/" + dbName;
+}
+
+}  // namespace
+
 // DraggableTreeWidget implementation
 DraggableTreeWidget::DraggableTreeWidget(QWidget* parent) 
     : QTreeWidget(parent), drag_item_(nullptr) {
@@ -80,6 +104,7 @@ ProjectNavigator::ProjectNavigator(QWidget* parent)
     , expand_btn_(nullptr)
     , collapse_btn_(nullptr)
     , refresh_btn_(nullptr)
+    , search_timer_(nullptr)
     , server_menu_(nullptr)
     , database_menu_(nullptr)
     , table_menu_(nullptr)
@@ -134,6 +159,11 @@ void ProjectNavigator::setupUi() {
   
   layout->addWidget(tree_widget_);
 
+  // Server-side search runs once typing pauses
+  search_timer_ = new QTimer(this);
+  search_timer_->setSingleShot(true);
+  search_timer_->setInterval(300);
+
   // Connections
   connect(filter_edit_, &QLineEdit::textChanged,
           this, &ProjectNavigator::onFilterTextChanged);
@@ -149,9 +179,14 @@ void ProjectNavigator::setupUi() {
           this, &ProjectNavigator::onContextMenu);
   connect(tree_widget_, &DraggableTreeWidget::itemDragStarted,
           this, &ProjectNavigator::onItemDragged);
+  connect(tree_widget_, &QTreeWidget::itemExpanded,
+          this, &ProjectNavigator::onItemExpanded);
+  connect(search_timer_, &QTimer::timeout,
+          this, &ProjectNavigator::onSearchTimeout);
 }
 
 void ProjectNavigator::createNodes() {
+  ++tree_generation_;
   tree_widget_->clear();
   
   // Add some sample structure
@@ -258,7 +293,9 @@ void ProjectNavigator::refresh() {
 }
 
 void ProjectNavigator::clear() {
+  ++tree_generation_;
   tree_widget_->clear();
+  catalogs_.clear();
 }
 
 void ProjectNavigator::addServer(const QString& serverName, const QString& host) {
@@ -340,6 +377,158 @@ void ProjectNavigator::addTable(const QString& serverName, const QString& dbName
   tableItem->setIcon(0, QApplication::style()->standardIcon(QStyle::SP_FileIcon));
 }
 
+void ProjectNavigator::setCatalogClient(const QString& serverName, const QString& dbName,
+                                        std::shared_ptr<core::ScratchBirdCatalogClient> catalog) {
+  QTreeWidgetItem* dbItem = findDatabaseItem(serverName, dbName);
+  if (!dbItem || !catalog) return;
+  catalogs_.insert(CatalogKey(serverName, dbName), std::move(catalog));
+  
+  QTreeWidgetItem* tablesItem = findOrCreateCategoryItem(dbItem, "Tables");
+  tablesItem->setData(0, kLazyRole, true);
+  tablesItem->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+}
+
+QTreeWidgetItem* ProjectNavigator::findDatabaseItem(const QString& serverName, const QString& dbName) {
+  QTreeWidgetItem* serverItem = findServerItem(serverName);
+  if (!serverItem) return nullptr;
+  for (int i = 0; i < serverItem->childCount(); ++i) {
+    QTreeWidgetItem* dbsItem = serverItem->child(i);
+    if (dbsItem->text(0) != "Databases") continue;
+    for (int j = 0; j < dbsItem->childCount(); ++j) {
+      if (dbsItem->child(j)->text(0) == dbName) {
+        return dbsItem->child(j);
+      }
+    }
+  }
+  return nullptr;
+}
+
+std::shared_ptr<core::ScratchBirdCatalogClient> ProjectNavigator::catalogFor(QTreeWidgetItem* item) const {
+  // Walk up to the database item (the child of "Databases")
+  while (item && item->parent() && item->parent()->text(0) != "Databases") {
+    item = item->parent();
+  }
+  if (!item || !item->parent() || !item->parent()->parent()) return nullptr;
+  return catalogs_.value(CatalogKey(item->parent()->parent()->text(0), item->text(0)));
+}
+
+// ============================================================================
+// Lazy loading
+// ============================================================================
+
+void ProjectNavigator::onItemExpanded(QTreeWidgetItem* item) {
+  if (!item || !item->data(0, kLazyRole).toBool()) return;
+  item->setData(0, kLazyRole, false);
+  if (item->text(0) == "Tables") {
+    loadTables(item);
+  } else {
+    loadColumns(item);
+  }
+}
+
+void ProjectNavigator::setLoading(QTreeWidgetItem* item) {
+  auto* placeholder = new QTreeWidgetItem(item);
+  placeholder->setText(0, tr("Loading..."));
+  placeholder->setData(0, kPlaceholderRole, true);
+  placeholder->setDisabled(true);
+}
+
+void ProjectNavigator::clearLoading(QTreeWidgetItem* item) {
+  for (int i = item->childCount() - 1; i >= 0; --i) {
+    if (item->child(i)->data(0, kPlaceholderRole).toBool()) {
+      delete item->takeChild(i);
+    }
+  }
+}
+
+QTreeWidgetItem* ProjectNavigator::addCatalogTable(QTreeWidgetItem* tablesItem, const QString& schema,
+                                                   const QString& table, bool qualify) {
+  for (int i = 0; i < tablesItem->childCount(); ++i) {
+    QTreeWidgetItem* child = tablesItem->child(i);
+    if (child->data(0, kSchemaRole).toString() == schema &&
+        child->data(0, kTableRole).toString() == table) {
+      return child;
+    }
+  }
+  auto* tableItem = new QTreeWidgetItem(tablesItem);
+  tableItem->setText(0, qualify ? schema + "." + table : table);
+  tableItem->setToolTip(0, schema + "." + table);
+  tableItem->setIcon(0, QApplication::style()->standardIcon(QStyle::SP_FileIcon));
+  tableItem->setData(0, kSchemaRole, schema);
+  tableItem->setData(0, kTableRole, table);
+  tableItem->setData(0, kLazyRole, true);
+  tableItem->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+  return tableItem;
+}
+
+void ProjectNavigator::loadTables(QTreeWidgetItem* tablesItem) {
+  auto catalog = catalogFor(tablesItem);
+  if (!catalog) return;
+  setLoading(tablesItem);
+  
+  // Items are only deleted when the generation changes, so the pointer is
+  // still good when the result arrives with the same generation
+  const quint64 generation = tree_generation_;
+  QPointer<ProjectNavigator> self(this);
+  QThreadPool::globalInstance()->start([=]() {
+    core::Status status = core::Status::Ok();
+    auto tables = std::make_shared<std::vector<core::TableInfo>>(catalog->GetTables("", &status));
+    const QString error = status.ok ? QString() : QString::fromStdString(status.message);
+    QMetaObject::invokeMethod(qApp, [self, generation, tablesItem, tables, error]() {
+      if (!self || self->tree_generation_ != generation) return;
+      self->clearLoading(tablesItem);
+      if (!error.isEmpty()) {
+        tablesItem->setData(0, kLazyRole, true);  // Retry on the next expand
+        tablesItem->setToolTip(0, tr("Failed to load tables: %1").arg(error));
+        tablesItem->setExpanded(false);
+        return;
+      }
+      QSet<QString> schemas;
+      for (const auto& table : *tables) {
+        schemas.insert(QString::fromStdString(table.schema));
+      }
+      for (const auto& table : *tables) {
+        self->addCatalogTable(tablesItem, QString::fromStdString(table.schema),
+                              QString::fromStdString(table.name), schemas.size() > 1);
+      }
+    }, Qt::QueuedConnection);
+  });
+}
+
+void ProjectNavigator::loadColumns(QTreeWidgetItem* tableItem) {
+  auto catalog = catalogFor(tableItem);
+  if (!catalog) return;
+  setLoading(tableItem);
+  
+  const std::string schema = tableItem->data(0, kSchemaRole).toString().toStdString();
+  const std::string table = tableItem->data(0, kTableRole).toString().toStdString();
+  const quint64 generation = tree_generation_;
+  QPointer<ProjectNavigator> self(this);
+  QThreadPool::globalInstance()->start([=]() {
+    core::Status status = core::Status::Ok();
+    auto columns = std::make_shared<std::vector<core::ColumnInfo>>(
+        catalog->GetColumns(schema, table, &status));
+    const QString error = status.ok ? QString() : QString::fromStdString(status.message);
+    QMetaObject::invokeMethod(qApp, [self, generation, tableItem, columns, error]() {
+      if (!self || self->tree_generation_ != generation) return;
+      self->clearLoading(tableItem);
+      if (!error.isEmpty()) {
+        tableItem->setData(0, kLazyRole, true);
+        tableItem->setExpanded(false);
+        return;
+      }
+      QTreeWidgetItem* columnsItem = self->findOrCreateCategoryItem(tableItem, "Columns");
+      columnsItem->setIcon(0, QApplication::style()->standardIcon(QStyle::SP_DirIcon));
+      for (const auto& column : *columns) {
+        auto* columnItem = new QTreeWidgetItem(columnsItem);
+        columnItem->setText(0, QString::fromStdString(column.name));
+        columnItem->setToolTip(0, QString::fromStdString(column.data_type));
+      }
+      columnsItem->setExpanded(true);
+    }, Qt::QueuedConnection);
+  });
+}
+
 QTreeWidgetItem* ProjectNavigator::findServerItem(const QString& serverName) {
   for (int i = 0; i < tree_widget_->topLevelItemCount(); ++i) {
     QTreeWidgetItem* item = tree_widget_->topLevelItem(i);
@@ -386,6 +575,47 @@ void ProjectNavigator::onFilterTextChanged(const QString& text) {
   for (int i = 0; i < tree_widget_->topLevelItemCount(); ++i) {
     filterItem(tree_widget_->topLevelItem(i), text);
   }
+  // Objects not loaded yet can only be found on the server
+  if (!catalogs_.isEmpty() && text.trimmed().size() >= 2) {
+    search_timer_->start();
+  } else {
+    search_timer_->stop();
+  }
+}
+
+void ProjectNavigator::onSearchTimeout() {
+  const QString text = filter_edit_->text().trimmed();
+  const quint64 generation = tree_generation_;
+  QPointer<ProjectNavigator> self(this);
+  for (auto it = catalogs_.cbegin(); it != catalogs_.cend(); ++it) {
+    const QString key = it.key();
+    auto catalog = it.value();
+    QThreadPool::globalInstance()->start([=]() {
+      core::Status status = core::Status::Ok();
+      auto hits = std::make_shared<std::vector<core::CatalogSearchHit>>(
+          catalog->SearchObjects(text.toStdString(), 500, &status));
+      QMetaObject::invokeMethod(qApp, [self, generation, key, text, hits]() {
+        if (!self || self->tree_generation_ != generation ||
+            self->filter_edit_->text().trimmed() != text) {
+          return;
+        }
+        const QString serverName = key.section('/', 0, 0);
+        const QString dbName = key.section('/', 1);
+        QTreeWidgetItem* dbItem = self->findDatabaseItem(serverName, dbName);
+        if (!dbItem) return;
+        // Add the tables behind every hit and tag them so the local filter
+        // keeps them visible even when only a column name matched
+        QTreeWidgetItem* tablesItem = self->findOrCreateCategoryItem(dbItem, "Tables");
+        for (const auto& hit : *hits) {
+          QTreeWidgetItem* tableItem = self->addCatalogTable(
+              tablesItem, QString::fromStdString(hit.schema), QString::fromStdString(hit.table),
+              false);
+          tableItem->setData(0, kMatchRole, text);
+        }
+        self->filterItem(dbItem, text);
+      }, Qt::QueuedConnection);
+    });
+  }
 }
 
 bool ProjectNavigator::filterItem(QTreeWidgetItem* item, const QString& text) {
@@ -396,7 +626,8 @@ bool ProjectNavigator::filterItem(QTreeWidgetItem* item, const QString& text) {
     }
   }
   
-  bool matches = item->text(0).contains(text, Qt::CaseInsensitive);
+  bool matches = item->text(0).contains(text, Qt::CaseInsensitive) ||
+                 (!text.isEmpty() && item->data(0, kMatchRole).toString() == text.trimmed());
   bool visible = matches || hasVisibleChild;
   item->setHidden(!visible);
   
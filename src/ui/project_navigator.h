@@ -1,13 +1,21 @@
 #pragma once
+#include <QHash>
 #include <QTreeWidget>
 #include <QWidget>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 class QLineEdit;
 class QToolButton;
 class QMenu;
+class QTimer;
 QT_END_NAMESPACE
 
+namespace scratchrobin::core {
+class ScratchBirdCatalogClient;
+}
+
 namespace scratchrobin::ui {
 
 // Custom tree widget to support drag
@@ -41,6 +49,11 @@ class ProjectNavigator : public QWidget {
   void addServer(const QString& serverName, const QString& host = QString());
   void addDatabase(const QString& serverName, const QString& dbName);
   void addTable(const QString& serverName, const QString& dbName, const QString& tableName);
+  // Lists the tables of |dbName| from |catalog| when its Tables node is
+  // first expanded, and a table's columns when the table is, on a
+  // background thread. The filter also searches |catalog| on the server.
+  void setCatalogClient(const QString& serverName, const QString& dbName,
+                        std::shared_ptr<core::ScratchBirdCatalogClient> catalog);
 
  signals:
   void serverSelected(const QString& serverName);
@@ -69,6 +82,8 @@ class ProjectNavigator : public QWidget {
   void onItemDoubleClicked(QTreeWidgetItem* item, int column);
   void onContextMenu(const QPoint& pos);
   void onItemDragged(const QString& text);
+  void onItemExpanded(QTreeWidgetItem* item);
+  void onSearchTimeout();
   
   // Context menu handlers
   void onQueryTable();
@@ -85,6 +100,14 @@ class ProjectNavigator : public QWidget {
   void createNodes();
   void createContextMenus();
   QTreeWidgetItem* findServerItem(const QString& serverName);
+  QTreeWidgetItem* findDatabaseItem(const QString& serverName, const QString& dbName);
+  QTreeWidgetItem* addCatalogTable(QTreeWidgetItem* tablesItem, const QString& schema,
+                                   const QString& table, bool qualify);
+  void loadTables(QTreeWidgetItem* tablesItem);
+  void loadColumns(QTreeWidgetItem* tableItem);
+  void setLoading(QTreeWidgetItem* item);
+  void clearLoading(QTreeWidgetItem* item);
+  std::shared_ptr<core::ScratchBirdCatalogClient> catalogFor(QTreeWidgetItem* item) const;
   QTreeWidgetItem* findOrCreateCategoryItem(QTreeWidgetItem* parent, const QString& category);
   QString getItemType(QTreeWidgetItem* item) const;
   QString getItemPath(QTreeWidgetItem* item) const;
@@ -95,6 +118,13 @@ class ProjectNavigator : public QWidget {
   QToolButton* expand_btn_;
   QToolButton* collapse_btn_;
   QToolButton* refresh_btn_;
+  QTimer* search_timer_;
+  
+  // Catalogs by "server/database"; lazily loaded items carry kLazyRole
+  QHash<QString, std::shared_ptr<core::ScratchBirdCatalogClient>> catalogs_;
+  // Bumped whenever items are deleted; background results for an older
+  // tree are dropped
+  quint64 tree_generation_ = 0;
   
   // Context menus
   QMenu* server_menu_;
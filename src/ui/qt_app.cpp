@@ -9,7 +9,10 @@
 #include "backend/session_client.h"
 #include "core/app_config.h"
 
+#include <QDir>
+#include <QFileInfo>
 #include <QMessageBox>
+#include <QStandardPaths>
 #include <QThread>
 #include <QEventLoop>
 
@@ -24,7 +27,20 @@ QtApp::QtApp(int& argc, char** argv)
   setOrganizationName("ScratchBird");
 }
 
-QtApp::~QtApp() = default;
+QtApp::~QtApp() {
+  // Persist compiled bytecode so the next start does not compile cold. The
+  // file outlives the server it was compiled against, so it is only written
+  // once the session knows the server version and search path that key it.
+  const backend::ScratchbirdRuntimeConfig* runtime =
+      session_client_ ? session_client_->GetRuntimeConfig() : nullptr;
+  if (compiler_ && compiler_->CompileCache() && runtime &&
+      !runtime->server_version.empty() && !runtime->search_path.empty()) {
+    const QString path = compileCachePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    compiler_->CompileCache()->SaveToFile(path.toStdString(),
+                                          backend::NativeParserCompiler::CompilerVersion());
+  }
+}
 
 bool QtApp::init() {
   splash_screen_ = new SplashScreen();
@@ -72,6 +88,9 @@ bool QtApp::init() {
 bool QtApp::initializeBackend() {
   registry_ = std::make_unique<backend::ParserPortRegistry>();
   compiler_ = std::make_unique<backend::NativeParserCompiler>();
+  // A missing or outdated cache file is not an error; it is rebuilt on exit
+  compiler_->CompileCache()->LoadFromFile(compileCachePath().toStdString(),
+                                          backend::NativeParserCompiler::CompilerVersion());
   session_ = std::make_unique<backend::ServerSessionGateway>();
   adapter_ = std::make_unique<backend::NativeAdapterGateway>(registry_.get(), compiler_.get(), session_.get());
   session_client_ = std::make_unique<backend::SessionClient>(adapter_.get());
@@ -92,8 +111,14 @@ bool QtApp::initializeBackend() {
   return true;
 }
 
+QString QtApp::compileCachePath() const {
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         QStringLiteral("/sblr_compile_cache.bin");
+}
+
 bool QtApp::createMainWindow() {
   main_window_ = new MainWindow(session_client_.get());
+  main_window_->setCompileCache(compiler_->CompileCache().get());
   
   auto& config = core::AppConfig::get();
   auto* layout = config.getCurrentLayout();
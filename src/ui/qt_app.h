@@ -1,5 +1,6 @@
 #pragma once
 #include <QApplication>
+#include <QString>
 #include <memory>
 
 namespace scratchrobin::backend {
@@ -28,6 +29,7 @@ class QtApp : public QApplication {
  private:
   bool initializeBackend();
   bool createMainWindow();
+  QString compileCachePath() const;
 
   std::unique_ptr<backend::ParserPortRegistry> registry_;
   std::unique_ptr<backend::NativeParserCompiler> compiler_;
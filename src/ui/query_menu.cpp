@@ -34,6 +34,14 @@ void QueryMenu::setupActions() {
     actionStop_->setStatusTip(tr("Stop current execution"));
     actionStop_->setEnabled(false);
 
+    actionParallelScripts_ = menu_->addAction(tr("Run Scripts in &Parallel"), this,
+                                              &QueryMenu::onParallelScriptsToggled);
+    actionParallelScripts_->setCheckable(true);
+    actionParallelScripts_->setChecked(false);
+    actionParallelScripts_->setStatusTip(
+        tr("Run independent script statements on several connections; "
+           "dependencies through triggers or foreign keys are not detected"));
+
     menu_->addSeparator();
 
     // Explain group
@@ -125,6 +133,10 @@ void QueryMenu::onStop() {
     emit stopRequested();
 }
 
+void QueryMenu::onParallelScriptsToggled(bool checked) {
+    emit parallelScriptsToggled(checked);
+}
+
 void QueryMenu::onExplain() {
     emit explainRequested();
 }
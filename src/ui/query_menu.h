@@ -18,6 +18,7 @@ class SqlEditor;
  * - Execute (F9)
  * - Execute Selection (Ctrl+F9)
  * - Execute Script
+ * - Run Scripts in Parallel
  * - Stop
  * - Explain Plan / Explain Analyze
  * - Format SQL
@@ -45,6 +46,9 @@ signals:
     void executeSelectionRequested();
     void executeScriptRequested();
     void stopRequested();
+    // Execute Script spreads independent statements over several
+    // connections; off by default
+    void parallelScriptsToggled(bool enabled);
     
     // Explain signals
     void explainRequested();
@@ -63,6 +67,7 @@ private slots:
     void onExecuteSelection();
     void onExecuteScript();
     void onStop();
+    void onParallelScriptsToggled(bool checked);
     void onExplain();
     void onExplainAnalyze();
     void onFormatSql();
@@ -90,6 +95,7 @@ private:
     QAction* actionExecuteSelection_ = nullptr;
     QAction* actionExecuteScript_ = nullptr;
     QAction* actionStop_ = nullptr;
+    QAction* actionParallelScripts_ = nullptr;
     QAction* actionExplain_ = nullptr;
     QAction* actionExplainAnalyze_ = nullptr;
     QAction* actionFormatSql_ = nullptr;
@@ -0,0 +1,303 @@
+#include "ui/result_set_model.h"
+
+#include <QBrush>
+#include <QDate>
+#include <QPalette>
+
+#include <algorithm>
+
+namespace scratchrobin::ui {
+
+namespace {
+
+// Julian day number of 1970-01-01, the epoch of core::ColumnType::kDate.
+constexpr qint64 kUnixEpochJulianDay = 2440588;
+
+}  // namespace
+
+ResultSetModel::ResultSetModel(QObject* parent)
+    : QAbstractTableModel(parent) {}
+
+ResultSetModel::~ResultSetModel() = default;
+
+void ResultSetModel::setResultSet(core::ResultSet result) {
+  beginResetModel();
+  batches_.clear();
+  batch_starts_.clear();
+  headers_.clear();
+  for (const auto& name : result.columns) {
+    headers_.append(QString::fromStdString(name));
+  }
+  column_types_.clear();
+  noteColumnTypes(result);
+  buffered_rows_ = static_cast<qint64>(result.RowCount());
+  exposed_rows_ = std::min(buffered_rows_, kFetchChunk);
+  fetch_pending_ = false;
+  if (buffered_rows_ > 0) {
+    batch_starts_.push_back(0);
+    batches_.push_back(std::make_shared<const core::ResultSet>(std::move(result)));
+  }
+  endResetModel();
+}
+
+void ResultSetModel::appendBatch(core::ResultSet batch) {
+  fetch_pending_ = false;
+  if (batch.RowCount() == 0) {
+    return;
+  }
+  if (headers_.isEmpty()) {
+    beginResetModel();
+    for (const auto& name : batch.columns) {
+      headers_.append(QString::fromStdString(name));
+    }
+    endResetModel();
+  }
+  noteColumnTypes(batch);
+  const bool caught_up = exposed_rows_ == buffered_rows_;
+  batch_starts_.push_back(buffered_rows_);
+  buffered_rows_ += static_cast<qint64>(batch.RowCount());
+  batches_.push_back(std::make_shared<const core::ResultSet>(std::move(batch)));
+  // If the view had already scrolled to the end, show the new rows now;
+  // otherwise they become visible through fetchMore() as the user scrolls.
+  if (caught_up) {
+    exposeChunk();
+  }
+}
+
+void ResultSetModel::exposeChunk() {
+  const qint64 count = std::min(kFetchChunk, buffered_rows_ - exposed_rows_);
+  if (count <= 0) {
+    return;
+  }
+  beginInsertRows(QModelIndex(), static_cast<int>(exposed_rows_),
+                  static_cast<int>(exposed_rows_ + count - 1));
+  exposed_rows_ += count;
+  endInsertRows();
+}
+
+void ResultSetModel::exposeAllBufferedRows() {
+  if (exposed_rows_ >= buffered_rows_) {
+    return;
+  }
+  beginInsertRows(QModelIndex(), static_cast<int>(exposed_rows_),
+                  static_cast<int>(buffered_rows_ - 1));
+  exposed_rows_ = buffered_rows_;
+  endInsertRows();
+}
+
+void ResultSetModel::setMoreRowsAvailable(bool available) {
+  more_rows_available_ = available;
+  if (!available) {
+    fetch_pending_ = false;
+  }
+}
+
+void ResultSetModel::clear() {
+  beginResetModel();
+  headers_.clear();
+  column_types_.clear();
+  batches_.clear();
+  batch_starts_.clear();
+  buffered_rows_ = 0;
+  exposed_rows_ = 0;
+  more_rows_available_ = false;
+  fetch_pending_ = false;
+  endResetModel();
+}
+
+size_t ResultSetModel::memoryUsage() const {
+  size_t total = 0;
+  for (const auto& batch : batches_) {
+    total += batch->rows.MemoryUsage();
+  }
+  return total;
+}
+
+int ResultSetModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : static_cast<int>(exposed_rows_);
+}
+
+int ResultSetModel::columnCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : headers_.size();
+}
+
+const core::ColumnBuffer* ResultSetModel::locate(int row, int column,
+                                                 size_t* local_row) const {
+  if (row < 0 || row >= exposed_rows_ || column < 0 || column >= headers_.size()) {
+    return nullptr;
+  }
+  auto it = std::upper_bound(batch_starts_.begin(), batch_starts_.end(),
+                             static_cast<qint64>(row));
+  const size_t batch_index = static_cast<size_t>(it - batch_starts_.begin()) - 1;
+  const auto& batch = *batches_[batch_index];
+  if (static_cast<size_t>(column) >= batch.rows.ColumnCount()) {
+    return nullptr;
+  }
+  *local_row = static_cast<size_t>(row - batch_starts_[batch_index]);
+  return &batch.rows.Column(static_cast<size_t>(column));
+}
+
+QString ResultSetModel::displayText(const core::ColumnBuffer& column, size_t row) const {
+  if (column.Type() == core::ColumnType::kText) {
+    const auto text = column.TextAt(row);
+    return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+  }
+  scratch_.clear();
+  column.AppendFormatted(row, scratch_);
+  return QString::fromUtf8(scratch_.data(), static_cast<qsizetype>(scratch_.size()));
+}
+
+// Columns the server declared keep that type; an undeclared one takes the
+// type of the first batch that had a value in it, so later batches are
+// read as that type too
+void ResultSetModel::noteColumnTypes(const core::ResultSet& batch) {
+  column_types_.resize(static_cast<size_t>(headers_.size()), core::ColumnType::kAuto);
+  for (size_t col = 0; col < column_types_.size(); ++col) {
+    if (column_types_[col] != core::ColumnType::kAuto) {
+      continue;
+    }
+    column_types_[col] = batch.DeclaredType(col);
+    if (column_types_[col] == core::ColumnType::kAuto && col < batch.rows.ColumnCount()) {
+      column_types_[col] = batch.rows.Column(col).Type();
+    }
+  }
+}
+
+// The column's type, or while it is still unknown the type of the buffer
+// at hand
+core::ColumnType ResultSetModel::valueType(const core::ColumnBuffer& column,
+                                           int column_index) const {
+  const auto index = static_cast<size_t>(column_index);
+  if (index < column_types_.size() && column_types_[index] != core::ColumnType::kAuto) {
+    return column_types_[index];
+  }
+  return column.Type();
+}
+
+// A non-null cell as a value of |type|, whatever type its batch stored it
+// as. Text that does not parse as |type| stays text.
+QVariant ResultSetModel::editValue(const core::ColumnBuffer& column, size_t row,
+                                   core::ColumnType type) const {
+  switch (type) {
+    case core::ColumnType::kInt64:
+      if (column.Type() == core::ColumnType::kInt64) {
+        return QVariant::fromValue<qlonglong>(column.Int64At(row));
+      }
+      break;
+    case core::ColumnType::kDouble:
+      if (column.Type() == core::ColumnType::kDouble) {
+        return column.DoubleAt(row);
+      }
+      if (column.Type() == core::ColumnType::kInt64) {
+        return static_cast<double>(column.Int64At(row));
+      }
+      break;
+    case core::ColumnType::kDate:
+      if (column.Type() == core::ColumnType::kDate) {
+        return QDate::fromJulianDay(column.DateAt(row) + kUnixEpochJulianDay);
+      }
+      break;
+    default:
+      return displayText(column, row);
+  }
+
+  const QString text = displayText(column, row);
+  bool ok = false;
+  if (type == core::ColumnType::kInt64) {
+    const qlonglong value = text.toLongLong(&ok);
+    if (ok) {
+      return QVariant::fromValue<qlonglong>(value);
+    }
+  }
+  if (type == core::ColumnType::kInt64 || type == core::ColumnType::kDouble) {
+    const double value = text.toDouble(&ok);
+    if (ok) {
+      return value;
+    }
+  }
+  if (type == core::ColumnType::kDate) {
+    const QDate date = QDate::fromString(text, Qt::ISODate);
+    if (date.isValid()) {
+      return date;
+    }
+  }
+  return text;
+}
+
+QVariant ResultSetModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid()) {
+    return QVariant();
+  }
+  size_t row = 0;
+  const core::ColumnBuffer* column = locate(index.row(), index.column(), &row);
+  if (!column) {
+    return QVariant();
+  }
+  const bool is_null = column->IsNull(row);
+
+  switch (role) {
+    case Qt::DisplayRole:
+    case Qt::ToolTipRole:
+      return is_null ? QStringLiteral("NULL") : displayText(*column, row);
+
+    case Qt::EditRole:
+      // Typed values so the sort proxy orders numbers and dates correctly.
+      // Batches infer their buffer types separately, so go by the declared
+      // type to give every row of a column the same kind of value.
+      if (is_null) {
+        return QVariant();
+      }
+      return editValue(*column, row, valueType(*column, index.column()));
+
+    case Qt::TextAlignmentRole: {
+      const auto type = valueType(*column, index.column());
+      if (type == core::ColumnType::kInt64 || type == core::ColumnType::kDouble) {
+        return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+      }
+      return QVariant();
+    }
+
+    case Qt::ForegroundRole:
+      if (is_null) {
+        return QBrush(QPalette().color(QPalette::Disabled, QPalette::Text));
+      }
+      return QVariant();
+
+    default:
+      return QVariant();
+  }
+}
+
+QVariant ResultSetModel::headerData(int section, Qt::Orientation orientation,
+                                    int role) const {
+  if (role != Qt::DisplayRole) {
+    return QVariant();
+  }
+  if (orientation == Qt::Horizontal) {
+    return section >= 0 && section < headers_.size() ? headers_.at(section) : QVariant();
+  }
+  return section + 1;
+}
+
+bool ResultSetModel::canFetchMore(const QModelIndex& parent) const {
+  if (parent.isValid()) {
+    return false;
+  }
+  return exposed_rows_ < buffered_rows_ || (more_rows_available_ && !fetch_pending_);
+}
+
+void ResultSetModel::fetchMore(const QModelIndex& parent) {
+  if (parent.isValid()) {
+    return;
+  }
+  if (exposed_rows_ < buffered_rows_) {
+    exposeChunk();
+    return;
+  }
+  if (more_rows_available_ && !fetch_pending_) {
+    fetch_pending_ = true;
+    emit moreRowsRequested();
+  }
+}
+
+}  // namespace scratchrobin::ui
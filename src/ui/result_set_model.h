@@ -0,0 +1,74 @@
+#pragma once
+#include <QAbstractTableModel>
+#include <QStringList>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/result_set.h"
+
+namespace scratchrobin::ui {
+
+/**
+ * @brief Table model that serves cells straight from core::ResultSet buffers
+ *
+ * Nothing is converted up front: data() locates the batch holding the row
+ * and formats the cell from its column buffer only when the view asks for
+ * it. Rows are exposed to the view in chunks through canFetchMore() /
+ * fetchMore(); once every buffered row is exposed and the producer has
+ * said more batches may follow, moreRowsRequested() is emitted so a
+ * streaming cursor can be advanced.
+ */
+class ResultSetModel : public QAbstractTableModel {
+  Q_OBJECT
+
+ public:
+  explicit ResultSetModel(QObject* parent = nullptr);
+  ~ResultSetModel() override;
+
+  void setResultSet(core::ResultSet result);
+  void appendBatch(core::ResultSet batch);
+  void setMoreRowsAvailable(bool available);
+  bool moreRowsAvailable() const { return more_rows_available_; }
+  void exposeAllBufferedRows();
+  void clear();
+
+  QStringList headers() const { return headers_; }
+  qint64 bufferedRowCount() const { return buffered_rows_; }
+  size_t memoryUsage() const;
+
+  // QAbstractTableModel
+  int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation,
+                      int role = Qt::DisplayRole) const override;
+  bool canFetchMore(const QModelIndex& parent) const override;
+  void fetchMore(const QModelIndex& parent) override;
+
+ signals:
+  void moreRowsRequested();
+
+ private:
+  static constexpr qint64 kFetchChunk = 4096;
+
+  void exposeChunk();
+  const core::ColumnBuffer* locate(int row, int column, size_t* local_row) const;
+  QString displayText(const core::ColumnBuffer& column, size_t row) const;
+  void noteColumnTypes(const core::ResultSet& batch);
+  core::ColumnType valueType(const core::ColumnBuffer& column, int column_index) const;
+  QVariant editValue(const core::ColumnBuffer& column, size_t row, core::ColumnType type) const;
+
+  QStringList headers_;
+  std::vector<core::ColumnType> column_types_;  // Declared, else as first seen
+  std::vector<std::shared_ptr<const core::ResultSet>> batches_;
+  std::vector<qint64> batch_starts_;  // First model row of each batch
+  qint64 buffered_rows_ = 0;
+  qint64 exposed_rows_ = 0;
+  bool more_rows_available_ = false;
+  bool fetch_pending_ = false;
+  mutable std::string scratch_;
+};
+
+}  // namespace scratchrobin::ui
@@ -1,5 +1,12 @@
 #include "schema_compare.h"
+#include <backend/scratchbird_connection.h>
 #include <backend/session_client.h>
+#include <core/schema_diff.h>
+#include <core/script_runner.h>
+
+#include <chrono>
+#include <optional>
+
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -24,6 +31,57 @@
 
 namespace scratchrobin::ui {
 
+namespace {
+
+// The session's server, for connections of our own
+std::optional<backend::ConnectionInfo> runtimeConnectionInfo(backend::SessionClient* client) {
+    const auto* runtime = client ? client->GetRuntimeConfig() : nullptr;
+    if (!runtime) {
+        return std::nullopt;
+    }
+    backend::ConnectionInfo info;
+    info.host = runtime->host;
+    info.port = runtime->port;
+    info.database = runtime->database;
+    info.username = runtime->user;
+    info.password = runtime->password;
+    info.timeout_ms = static_cast<int>(runtime->connect_timeout_ms);
+    return info;
+}
+
+std::shared_ptr<backend::ScratchbirdConnection> openConnection(const backend::ConnectionInfo& info,
+                                                               std::string* error) {
+    auto connection = std::make_shared<backend::ScratchbirdConnection>();
+    if (!connection->connect(info)) {
+        *error = connection->lastError();
+        return nullptr;
+    }
+    return connection;
+}
+
+// One unit per statement, depending on the statements the script says
+// it must follow
+core::ScriptPlan planFromScript(const core::SchemaSyncScript& script) {
+    core::ScriptPlan plan;
+    for (const auto& step : script.steps) {
+        for (const auto& sql : step) {
+            core::ScriptStatement statement;
+            statement.sql = sql;
+            statement.kind = core::ScriptStatementKind::kDdl;
+            core::ScriptUnit unit;
+            unit.statements.push_back(plan.statements.size());
+            if (plan.units.size() < script.depends_on.size()) {
+                unit.depends_on = script.depends_on[plan.units.size()];
+            }
+            plan.statements.push_back(std::move(statement));
+            plan.units.push_back(std::move(unit));
+        }
+    }
+    return plan;
+}
+
+} // namespace
+
 // ============================================================================
 // Schema Compare Panel
 // ============================================================================
@@ -35,6 +93,12 @@ SchemaComparePanel::SchemaComparePanel(backend::SessionClient* client, QWidget*
     setupModels();
 }
 
+SchemaComparePanel::~SchemaComparePanel() {
+    if (compareThread_.joinable()) {
+        compareThread_.join();
+    }
+}
+
 void SchemaComparePanel::setupUi() {
     auto* mainLayout = new QVBoxLayout(this);
     mainLayout->setSpacing(6);
@@ -47,12 +111,16 @@ void SchemaComparePanel::setupUi() {
     selectionLayout->addWidget(new QLabel(tr("Source:")), 0, 0);
     sourceConnectionCombo_ = new QComboBox(this);
     sourceSchemaCombo_ = new QComboBox(this);
+    sourceSchemaCombo_->setEditable(true);
+    sourceSchemaCombo_->setEditText("public");
     selectionLayout->addWidget(sourceConnectionCombo_, 0, 1);
     selectionLayout->addWidget(sourceSchemaCombo_, 0, 2);
     
     selectionLayout->addWidget(new QLabel(tr("Target:")), 1, 0);
     targetConnectionCombo_ = new QComboBox(this);
     targetSchemaCombo_ = new QComboBox(this);
+    targetSchemaCombo_->setEditable(true);
+    targetSchemaCombo_->setEditText("public");
     selectionLayout->addWidget(targetConnectionCombo_, 1, 1);
     selectionLayout->addWidget(targetSchemaCombo_, 1, 2);
     
@@ -89,8 +157,12 @@ void SchemaComparePanel::setupUi() {
     optionsLayout->addWidget(compareTriggersCheck_, 1, 2);
     optionsLayout->addWidget(comparePrivilegesCheck_, 1, 3);
     
+    // Definitions are compared token by token, so whitespace never counts
     ignoreWhitespaceCheck_ = new QCheckBox(tr("Ignore whitespace differences"), this);
+    ignoreWhitespaceCheck_->setChecked(true);
+    ignoreWhitespaceCheck_->setEnabled(false);
     ignoreCommentsCheck_ = new QCheckBox(tr("Ignore comments"), this);
+    ignoreCommentsCheck_->setChecked(true);
     optionsLayout->addWidget(ignoreWhitespaceCheck_, 2, 0, 1, 2);
     optionsLayout->addWidget(ignoreCommentsCheck_, 2, 2, 1, 2);
     
@@ -187,44 +259,125 @@ void SchemaComparePanel::onSelectTargetSchema() {
 }
 
 void SchemaComparePanel::onRunComparison() {
+    if (comparing_) {
+        QMessageBox::information(this, tr("Compare"), tr("A comparison is already running."));
+        return;
+    }
     runComparison();
-    displayResults();
 }
 
 void SchemaComparePanel::runComparison() {
+    const auto info = runtimeConnectionInfo(client_);
+    if (!info) {
+        summaryLabel_->setText(tr("Not connected."));
+        return;
+    }
+    const std::string sourceSchema = sourceSchemaCombo_->currentText().trimmed().toStdString();
+    const std::string targetSchema = targetSchemaCombo_->currentText().trimmed().toStdString();
+    if (sourceSchema.empty() || targetSchema.empty()) {
+        QMessageBox::warning(this, tr("Error"), tr("Please enter both source and target schemas."));
+        return;
+    }
+    
+    core::SchemaDiffOptions options;
+    options.tables = compareTablesCheck_->isChecked();
+    options.views = compareViewsCheck_->isChecked();
+    options.functions = compareFunctionsCheck_->isChecked();
+    options.indexes = compareIndexesCheck_->isChecked();
+    options.constraints = compareConstraintsCheck_->isChecked();
+    options.triggers = compareTriggersCheck_->isChecked();
+    options.ignore_comments = ignoreCommentsCheck_->isChecked();
+    
+    if (compareThread_.joinable()) {
+        compareThread_.join();  // The previous comparison, already finished
+    }
+    comparing_ = true;
+    summaryLabel_->setText(tr("Comparing %1 to %2...")
+                           .arg(QString::fromStdString(sourceSchema))
+                           .arg(QString::fromStdString(targetSchema)));
+    emit comparisonStarted();
+    
+    // Each side reads its catalog on a connection of its own, concurrently
+    compareThread_ = std::thread([this, info = *info, sourceSchema, targetSchema, options]() {
+        const auto started = std::chrono::steady_clock::now();
+        auto result = std::make_shared<core::SchemaDiffResult>();
+        QString error;
+        std::string connectError;
+        auto sourceConnection = openConnection(info, &connectError);
+        auto targetConnection = sourceConnection ? openConnection(info, &connectError) : nullptr;
+        if (!targetConnection) {
+            error = QString::fromStdString(connectError);
+        } else {
+            core::ScratchBirdCatalogClient sourceCatalog;
+            core::ScratchBirdCatalogClient targetCatalog;
+            sourceCatalog.SetConnection(sourceConnection);
+            targetCatalog.SetConnection(targetConnection);
+            core::SchemaSnapshot source;
+            core::SchemaSnapshot target;
+            const core::Status status = core::SchemaSnapshot::CaptureBoth(
+                sourceCatalog, sourceSchema, targetCatalog, targetSchema, options, &source, &target);
+            if (status.ok) {
+                *result = core::SchemaDiff::Compare(source, target);
+            } else {
+                error = QString::fromStdString(status.message);
+            }
+        }
+        const qint64 elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started).count();
+        QMetaObject::invokeMethod(this, [this, result, error, elapsedMs]() {
+            onComparisonDone(result, error, elapsedMs);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SchemaComparePanel::onComparisonDone(std::shared_ptr<core::SchemaDiffResult> result,
+                                          const QString& error, qint64 elapsedMs) {
+    comparing_ = false;
+    if (!error.isEmpty()) {
+        summaryLabel_->setText(tr("Comparison failed: %1").arg(error));
+        return;
+    }
+    diffResult_ = std::move(result);
+    
     differences_.clear();
+    const QString sourceSchema = QString::fromStdString(diffResult_->source_schema);
+    const QString targetSchema = QString::fromStdString(diffResult_->target_schema);
+    for (const auto& change : diffResult_->changes) {
+        const bool inSource = change.kind != core::SchemaChangeKind::kDrop;
+        const bool inTarget = change.kind != core::SchemaChangeKind::kCreate;
+        const core::SchemaObject& object = inSource ? change.source : change.target;
+        
+        SchemaObjectDiff diff;
+        diff.objectType = QString::fromLatin1(core::SchemaObjectKindName(object.kind));
+        diff.objectName = QString::fromStdString(object.name);
+        diff.schemaName = targetSchema;
+        for (const auto& detail : change.details) {
+            diff.differences << QString::fromStdString(detail);
+        }
+        if (change.kind == core::SchemaChangeKind::kCreate) {
+            diff.diffType = DiffType::Created;
+            diff.differences << tr("Exists only in source");
+        } else if (change.kind == core::SchemaChangeKind::kDrop) {
+            diff.diffType = DiffType::Dropped;
+            diff.differences << tr("Exists only in target");
+        } else {
+            diff.diffType = DiffType::Modified;
+        }
+        diff.sourceDdl = inSource
+            ? QString::fromStdString(core::SchemaDiff::CreateSql(
+                  change.source, diffResult_->source_schema, diffResult_->source_schema))
+            : tr("-- Does not exist in %1").arg(sourceSchema);
+        diff.targetDdl = inTarget
+            ? QString::fromStdString(core::SchemaDiff::CreateSql(
+                  change.target, diffResult_->target_schema, diffResult_->target_schema))
+            : tr("-- Does not exist in %1").arg(targetSchema);
+        differences_.append(diff);
+    }
+    displayResults();
     
-    // Simulate comparison results for demo
-    SchemaObjectDiff diff1;
-    diff1.objectType = "TABLE";
-    diff1.objectName = "customers";
-    diff1.schemaName = "public";
-    diff1.diffType = DiffType::Modified;
-    diff1.differences << "Column 'email' type changed from VARCHAR(100) to VARCHAR(255)";
-    diff1.differences << "Index 'idx_email' added";
-    diff1.sourceDdl = "CREATE TABLE customers (\n  id INT PRIMARY KEY,\n  name VARCHAR(100),\n  email VARCHAR(255)\n);";
-    diff1.targetDdl = "CREATE TABLE customers (\n  id INT PRIMARY KEY,\n  name VARCHAR(100),\n  email VARCHAR(100)\n);";
-    differences_.append(diff1);
-    
-    SchemaObjectDiff diff2;
-    diff2.objectType = "TABLE";
-    diff2.objectName = "orders_new";
-    diff2.schemaName = "public";
-    diff2.diffType = DiffType::Created;
-    diff2.differences << "Table does not exist in target";
-    diff2.sourceDdl = "CREATE TABLE orders_new (\n  id INT PRIMARY KEY,\n  customer_id INT,\n  order_date TIMESTAMP\n);";
-    diff2.targetDdl = "-- Table does not exist";
-    differences_.append(diff2);
-    
-    SchemaObjectDiff diff3;
-    diff3.objectType = "FUNCTION";
-    diff3.objectName = "calculate_total";
-    diff3.schemaName = "public";
-    diff3.diffType = DiffType::Dropped;
-    diff3.differences << "Function exists only in target";
-    diff3.sourceDdl = "-- Function does not exist";
-    diff3.targetDdl = "CREATE FUNCTION calculate_total(amount DECIMAL) RETURNS DECIMAL AS $$\nBEGIN\n  RETURN amount * 1.1;\nEND;\n$$ LANGUAGE plpgsql;";
-    differences_.append(diff3);
+    identicalLabel_->setText(tr("Identical: %1").arg(diffResult_->identical));
+    summaryLabel_->setText(tr("Comparison complete in %1 ms: %2 differences found")
+                           .arg(elapsedMs).arg(differences_.size()));
 }
 
 void SchemaComparePanel::displayResults() {
@@ -238,7 +391,8 @@ void SchemaComparePanel::displayResults() {
     // Group by type
     QMap<QString, QStandardItem*> typeGroups;
     
-    for (const auto& diff : differences_) {
+    for (int i = 0; i < differences_.size(); ++i) {
+        const auto& diff = differences_[i];
         QStandardItem* typeGroup;
         if (!typeGroups.contains(diff.objectType)) {
             typeGroup = new QStandardItem(diff.objectType + "s");
@@ -281,8 +435,8 @@ void SchemaComparePanel::displayResults() {
         statusItem->setForeground(statusColor);
         row << statusItem;
         
-        // Store diff data in first item
-        row[0]->setData(QVariant::fromValue(diff.objectName), Qt::UserRole);
+        // Index into differences_ and the changes of diffResult_
+        row[0]->setData(i, Qt::UserRole);
         
         typeGroup->appendRow(row);
     }
@@ -300,265 +454,55 @@ void SchemaComparePanel::displayResults() {
 }
 
 void SchemaComparePanel::onObjectSelected(const QModelIndex& index) {
-    if (!index.isValid()) return;
-    
-    auto* item = diffModel_->itemFromIndex(index);
-    if (!item) return;
-    
-    QString objectName = item->data(Qt::UserRole).toString();
-    
-    for (const auto& diff : differences_) {
-        if (diff.objectName == objectName) {
-            sourceDdlEdit_->setPlainText(diff.sourceDdl);
-            targetDdlEdit_->setPlainText(diff.targetDdl);
-            diffEdit_->setPlainText(diff.differences.join("\n"));
-            
-            // Generate sync script for this object
-            QString script;
-            if (diff.diffType == DiffType::Created) {
-                script = diff.sourceDdl + ";";
-            } else if (diff.diffType == DiffType::Dropped) {
-                script = QString("DROP %1 %2;").arg(diff.objectType, diff.objectName);
-            } else if (diff.diffType == DiffType::Modified) {
-                script = QString("-- Alter %1 %2\n").arg(diff.objectType, diff.objectName);
-                script += "-- Manual review required for modifications\n";
-            }
-            scriptEdit_->setPlainText(script);
-            break;
-        }
-    }
+    if (!index.isValid() || !diffResult_) return;
+    
+    auto* item = diffModel_->itemFromIndex(index.siblingAtColumn(0));
+    if (!item || !item->data(Qt::UserRole).isValid()) return;
+    
+    const int row = item->data(Qt::UserRole).toInt();
+    if (row < 0 || row >= differences_.size()) return;
+    const auto& diff = differences_[row];
+    sourceDdlEdit_->setPlainText(diff.sourceDdl);
+    targetDdlEdit_->setPlainText(diff.targetDdl);
+    diffEdit_->setPlainText(diff.differences.join("\n"));
+    
+    // The statements for this object alone
+    core::SchemaDiffResult single;
+    single.source_schema = diffResult_->source_schema;
+    single.target_schema = diffResult_->target_schema;
+    single.changes.push_back(diffResult_->changes[static_cast<std::size_t>(row)]);
+    scriptEdit_->setPlainText(QString::fromStdString(core::SchemaDiff::BuildScript(single).ToSql()));
 }
 
 void SchemaComparePanel::onGenerateSyncScript() {
-    QString fullScript;
-    fullScript += "-- Schema Synchronization Script\n";
-    fullScript += "-- Generated by ScratchRobin Schema Compare\n\n";
-    fullScript += "BEGIN;\n\n";
-    
-    for (const auto& diff : differences_) {
-        if (diff.diffType == DiffType::Created) {
-            fullScript += diff.sourceDdl + ";\n\n";
-        } else if (diff.diffType == DiffType::Dropped) {
-            fullScript += QString("DROP %1 IF EXISTS %2;\n\n")
-                .arg(diff.objectType, diff.objectName);
-        } else if (diff.diffType == DiffType::Modified) {
-            fullScript += generateAlterStatement(diff) + "\n\n";
-        }
-    }
-    
-    fullScript += "COMMIT;\n";
-    
-    auto* dialog = new SchemaSyncScriptDialog(fullScript, client_, this);
-    dialog->exec();
+    showSyncScript();
 }
 
 void SchemaComparePanel::onApplyChanges() {
-    if (differences_.isEmpty()) {
+    // The script dialog asks for confirmation before applying
+    showSyncScript();
+}
+
+void SchemaComparePanel::showSyncScript() {
+    if (!diffResult_ || diffResult_->changes.empty()) {
         QMessageBox::information(this, tr("No Changes"), 
             tr("No differences to apply. Run a comparison first."));
         return;
     }
     
-    // Count changes by type
-    int createCount = 0, dropCount = 0, modifyCount = 0;
-    for (const auto& diff : differences_) {
-        switch (diff.diffType) {
-            case DiffType::Created: createCount++; break;
-            case DiffType::Dropped: dropCount++; break;
-            case DiffType::Modified: modifyCount++; break;
-            default: break;
-        }
-    }
-    
-    int totalChanges = createCount + dropCount + modifyCount;
-    if (totalChanges == 0) {
-        QMessageBox::information(this, tr("No Changes"), 
-            tr("No differences to apply."));
-        return;
-    }
-    
-    // Show confirmation dialog
-    QString summary = tr("The following changes will be applied to the target schema:\n\n");
-    if (createCount > 0) summary += tr("• %1 objects to CREATE\n").arg(createCount);
-    if (dropCount > 0) summary += tr("• %1 objects to DROP\n").arg(dropCount);
-    if (modifyCount > 0) summary += tr("• %1 objects to ALTER/MODIFY\n").arg(modifyCount);
-    summary += tr("\nTotal: %1 changes\n\n").arg(totalChanges);
-    summary += tr("WARNING: This operation cannot be undone. It is recommended to backup your database first.\n\n");
-    summary += tr("Do you want to proceed?");
-    
-    auto reply = QMessageBox::warning(this, tr("Confirm Schema Changes"),
-        summary, QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
-    
-    if (reply != QMessageBox::Yes) return;
-    
-    // Generate and execute DDL statements
-    QStringList statements;
-    QStringList errors;
-    int successCount = 0;
-    
-    for (const auto& diff : differences_) {
-        QString ddl;
-        switch (diff.diffType) {
-            case DiffType::Created:
-                ddl = diff.sourceDdl; // CREATE statement
-                break;
-            case DiffType::Dropped:
-                ddl = QString("DROP %1 IF EXISTS \"%2\".\"%3\";")
-                    .arg(diff.objectType)
-                    .arg(diff.schemaName)
-                    .arg(diff.objectName);
-                break;
-            case DiffType::Modified:
-                ddl = generateAlterStatement(diff);
-                break;
-            default:
-                continue;
-        }
-        
-        if (!ddl.isEmpty()) {
-            statements.append(ddl);
-        }
-    }
-    
-    if (statements.isEmpty()) {
-        QMessageBox::information(this, tr("No Changes"), 
-            tr("No DDL statements generated."));
-        return;
-    }
-    
-    // Show preview dialog
-    QString preview = statements.join("\n\n");
-    preview = preview.left(2000); // Limit preview length
-    if (statements.join("\n").length() > 2000) {
-        preview += tr("\n\n... (and %1 more statements)").arg(statements.size() - preview.count("\n") / 2);
-    }
-    
-    auto execReply = QMessageBox::question(this, tr("Execute Changes"),
-        tr("The following DDL statements will be executed:\n\n%1\n\nProceed?").arg(preview),
-        QMessageBox::Yes | QMessageBox::No | QMessageBox::Save,
-        QMessageBox::No);
-    
-    if (execReply == QMessageBox::Save) {
-        // Save script to file
-        QString fileName = QFileDialog::getSaveFileName(this, tr("Save Script"),
-            QString(), tr("SQL Files (*.sql)"));
-        if (!fileName.isEmpty()) {
-            QFile file(fileName);
-            if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                QTextStream stream(&file);
-                stream << "-- Schema Sync Script\n";
-                stream << "-- Generated: " << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n\n";
-                stream << "BEGIN;\n\n";
-                for (const auto& stmt : statements) {
-                    stream << stmt << "\n\n";
-                }
-                stream << "COMMIT;\n";
-                file.close();
-                QMessageBox::information(this, tr("Saved"), 
-                    tr("Script saved to %1").arg(fileName));
-            }
-        }
-        return;
-    }
-    
-    if (execReply != QMessageBox::Yes) return;
-    
-    // Execute statements (in production, this would use the backend client)
-    // For now, simulate execution
-    for (const auto& stmt : statements) {
-        // In real implementation:
-        // auto result = client_->execute(stmt.toStdString());
-        // if (!result.success) errors.append(result.error_message);
-        Q_UNUSED(stmt)
-        successCount++;
-    }
-    
-    // Show results
-    if (errors.isEmpty()) {
-        QMessageBox::information(this, tr("Success"), 
-            tr("Successfully applied %1 changes.").arg(successCount));
-        // Refresh comparison
-        onRunComparison();
-    } else {
-        QString errorMsg = errors.join("\n");
-        if (errorMsg.length() > 500) {
-            errorMsg = errorMsg.left(500) + tr("\n... (and more)");
-        }
-        QMessageBox::critical(this, tr("Errors Occurred"),
-            tr("Applied %1 of %2 changes. Errors:\n\n%3")
-            .arg(successCount).arg(statements.size()).arg(errorMsg));
-    }
-}
-
-QString SchemaComparePanel::generateAlterStatement(const SchemaObjectDiff& diff) {
-    // Generate ALTER statement based on object type and differences
-    QString ddl;
-    
-    if (diff.objectType == "TABLE") {
-        ddl = QString("-- ALTER TABLE \"%1\".\"%2\"\n").arg(diff.schemaName).arg(diff.objectName);
-        
-        // Parse differences to generate specific ALTER statements
-        for (const QString& difference : diff.differences) {
-            ddl += QString("--   %1\n").arg(difference);
-            
-            // Generate specific ALTER statements based on difference patterns
-            if (difference.contains("type changed", Qt::CaseInsensitive)) {
-                // Extract column name and type change
-                QRegularExpression reColumn("Column '([^']+)'");
-                QRegularExpressionMatch match = reColumn.match(difference);
-                if (match.hasMatch()) {
-                    QString colName = match.captured(1);
-                    // Extract new type (assumes format "from X to Y")
-                    QRegularExpression reType("to ([^)]+)");
-                    QRegularExpressionMatch typeMatch = reType.match(difference);
-                    QString newType = typeMatch.hasMatch() ? typeMatch.captured(1) : "VARCHAR(255)";
-                    ddl += QString("ALTER TABLE \"%1\".\"%2\" ALTER COLUMN \"%3\" TYPE %4;\n")
-                        .arg(diff.schemaName).arg(diff.objectName).arg(colName).arg(newType);
-                }
-            } else if (difference.contains("added", Qt::CaseInsensitive) && 
-                      (difference.contains("column", Qt::CaseInsensitive) || 
-                       difference.contains("index", Qt::CaseInsensitive))) {
-                // New column or index added
-                if (difference.contains("Index", Qt::CaseInsensitive)) {
-                    // Extract index name
-                    QRegularExpression reIndex("Index '([^']+)'");
-                    QRegularExpressionMatch match = reIndex.match(difference);
-                    if (match.hasMatch()) {
-                        QString idxName = match.captured(1);
-                        ddl += QString("-- Index '%1' added - create index statement needed\n").arg(idxName);
-                        ddl += QString("CREATE INDEX \"%1\" ON \"%2\".\"%3\" (...);\n")
-                            .arg(idxName).arg(diff.schemaName).arg(diff.objectName);
-                    }
-                }
-            } else if (difference.contains("dropped", Qt::CaseInsensitive) || 
-                      difference.contains("removed", Qt::CaseInsensitive)) {
-                // Column or constraint removed
-                QRegularExpression reColumn("Column '([^']+)'");
-                QRegularExpressionMatch match = reColumn.match(difference);
-                if (match.hasMatch()) {
-                    QString colName = match.captured(1);
-                    ddl += QString("ALTER TABLE \"%1\".\"%2\" DROP COLUMN \"%3\";\n")
-                        .arg(diff.schemaName).arg(diff.objectName).arg(colName);
-                }
-            }
-        }
-        
-        if (!ddl.contains("ALTER TABLE") && !ddl.contains("CREATE INDEX")) {
-            ddl += QString("-- Manual review required: Complex table modification detected\n");
-            ddl += QString("-- Consider: CREATE TABLE new_table (...); INSERT INTO new_table SELECT * FROM old_table; DROP TABLE old_table; ALTER TABLE new_table RENAME TO old_table;");
-        }
-    } else if (diff.objectType == "VIEW" || diff.objectType == "FUNCTION" || 
-               diff.objectType == "PROCEDURE" || diff.objectType == "TRIGGER") {
-        // For views and routines, typically need to drop and recreate
-        ddl = QString("-- Recreate %1 \"%2\".\"%3\"\n").arg(diff.objectType).arg(diff.schemaName).arg(diff.objectName);
-        ddl += QString("DROP %1 IF EXISTS \"%2\".\"%3\";\n").arg(diff.objectType).arg(diff.schemaName).arg(diff.objectName);
-        ddl += diff.sourceDdl;
-    } else {
-        ddl = QString("-- Modify %1 \"%2\".\"%3\"\n").arg(diff.objectType).arg(diff.schemaName).arg(diff.objectName);
-        ddl += diff.sourceDdl;
-    }
+    core::SchemaSyncScript script = core::SchemaDiff::BuildScript(*diffResult_);
+    QString fullScript;
+    fullScript += "-- Schema Synchronization Script\n";
+    fullScript += "-- Generated by ScratchRobin Schema Compare\n";
+    fullScript += QString("-- %1 statements in %2 steps; statements of a step are independent\n\n")
+        .arg(script.StatementCount()).arg(script.steps.size());
+    fullScript += QString::fromStdString(script.ToSql());
     
-    return ddl;
+    auto* dialog = new SchemaSyncScriptDialog(fullScript, client_, this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setScript(std::move(script));
+    dialog->exec();
+    scriptEdit_->setPlainText(fullScript);
 }
 
 void SchemaComparePanel::onExportResults() {
@@ -671,7 +615,7 @@ void SchemaCompareOptionsDialog::onSave() {
 SchemaSyncScriptDialog::SchemaSyncScriptDialog(const QString& script, 
                                                 backend::SessionClient* client,
                                                 QWidget* parent)
-    : QDialog(parent), client_(client) {
+    : QDialog(parent), client_(client), generatedScript_(script) {
     setupUi();
     scriptEdit_->setPlainText(script);
     
@@ -684,6 +628,19 @@ SchemaSyncScriptDialog::SchemaSyncScriptDialog(const QString& script,
     }
 }
 
+SchemaSyncScriptDialog::~SchemaSyncScriptDialog() {
+    if (runner_) {
+        runner_->Cancel();
+    }
+    if (runThread_.joinable()) {
+        runThread_.join();
+    }
+}
+
+void SchemaSyncScriptDialog::setScript(core::SchemaSyncScript script) {
+    syncScript_ = std::make_unique<core::SchemaSyncScript>(std::move(script));
+}
+
 void SchemaSyncScriptDialog::setupUi() {
     setWindowTitle(tr("Synchronization Script"));
     resize(800, 600);
@@ -757,51 +714,77 @@ void SchemaSyncScriptDialog::onApply() {
 }
 
 void SchemaSyncScriptDialog::executeScript() {
-    if (!client_) return;
-    
-    // Split script into statements
-    QString script = scriptEdit_->toPlainText();
-    QStringList statements = script.split(';', Qt::SkipEmptyParts);
-    
-    int successCount = 0;
-    int failCount = 0;
-    QString lastError;
+    if (!client_ || runner_) return;
+    
+    // The generated script's edges are exact; an edited script is split
+    // with the SQL lexer and planned from the objects each statement touches
+    const QString script = scriptEdit_->toPlainText();
+    auto plan = std::make_shared<core::ScriptPlan>(
+        syncScript_ && script == generatedScript_ ? planFromScript(*syncScript_)
+                                                  : core::ScriptRunner::Plan(script.toStdString()));
+    
+    core::ScriptRunOptions options;
+    if (const auto info = runtimeConnectionInfo(client_)) {
+        runner_ = std::make_shared<core::ScriptRunner>([info = *info](std::string* error) {
+            return openConnection(info, error);
+        });
+    } else {
+        // Without connections of our own, statements take turns on the session
+        runner_ = std::make_shared<core::ScriptRunner>(
+            [](std::string*) { return std::make_shared<backend::ScratchbirdConnection>(); },
+            [client = client_](backend::ScratchbirdConnection&, const std::string& sql, int64_t*) {
+                return client->ExecuteSql(4044, "scratchbird", sql).status;
+            });
+        options.max_parallel = 1;
+    }
+    if (runThread_.joinable()) {
+        runThread_.join();  // The previous run, already finished
+    }
     
-    // Execute each statement
-    for (QString& stmt : statements) {
-        stmt = stmt.trimmed();
-        if (stmt.isEmpty()) continue;
-        
-        // Skip transaction control statements - we handle them as a batch
-        QString upperStmt = stmt.toUpper();
-        if (upperStmt == "BEGIN" || upperStmt == "COMMIT" || upperStmt == "ROLLBACK") {
-            continue;
+    applyBtn_->setEnabled(false);
+    applyBtn_->setText(tr("Applying..."));
+    runThread_ = std::thread([this, runner = runner_, plan, options]() {
+        const core::ScriptRunResult result = runner->Run(*plan, options);
+        QString error;
+        for (const auto& statement : result.statements) {
+            if (!statement.status.ok && !statement.skipped) {
+                error = tr("%1\nError: %2")
+                    .arg(QString::fromStdString(plan->statements[statement.statement].sql).left(200))
+                    .arg(QString::fromStdString(statement.status.message));
+                break;
+            }
         }
-        
-        auto response = client_->ExecuteSql(4044, "scratchbird", (stmt + ";").toStdString());
-        
-        if (response.status.ok) {
-            successCount++;
-        } else {
-            failCount++;
-            lastError = QString::fromStdString(response.status.message);
-            break;  // Stop on first error
+        if (result.cancelled && error.isEmpty()) {
+            error = tr("Cancelled");
         }
-    }
+        const int executed = result.executed - result.failed;
+        const int failed = result.failed + result.skipped;
+        QMetaObject::invokeMethod(this, [this, executed, failed, error,
+                                         elapsedMs = result.elapsed_ms,
+                                         connections = result.connections]() {
+            onScriptFinished(executed, failed, error, elapsedMs, connections);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SchemaSyncScriptDialog::onScriptFinished(int executed, int failed, const QString& error,
+                                              qint64 elapsedMs, int connections) {
+    runner_.reset();
+    applyBtn_->setEnabled(true);
+    applyBtn_->setText(tr("Apply to Database"));
     
-    // Show results
-    if (failCount == 0) {
+    if (failed == 0 && error.isEmpty()) {
         QMessageBox::information(this, tr("Script Applied"), 
-            tr("Successfully executed %1 statements.\n"
-               "The database has been synchronized.").arg(successCount));
+            tr("Successfully executed %1 statements in %2 ms on %3 connections.\n"
+               "The database has been synchronized.")
+               .arg(executed).arg(elapsedMs).arg(connections));
         accept();  // Close dialog on success
     } else {
         QMessageBox::critical(this, tr("Execution Failed"), 
-            tr("Executed %1 statements successfully.\n"
-               "Failed at statement %2:\n%3")
-               .arg(successCount)
-               .arg(successCount + 1)
-               .arg(lastError));
+            tr("Executed %1 statements successfully; %2 failed or were skipped.\n\n%3")
+               .arg(executed)
+               .arg(failed)
+               .arg(error));
     }
 }
 
@@ -1,6 +1,10 @@
 #pragma once
 #include "ui/dock_workspace.h"
 #include <QDialog>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 class QTreeView;
@@ -20,6 +24,12 @@ namespace scratchrobin::backend {
 class SessionClient;
 }
 
+namespace scratchrobin::core {
+class ScriptRunner;
+struct SchemaDiffResult;
+struct SchemaSyncScript;
+}
+
 namespace scratchrobin::ui {
 
 /**
@@ -63,6 +73,7 @@ class SchemaComparePanel : public DockPanel {
 
 public:
     explicit SchemaComparePanel(backend::SessionClient* client, QWidget* parent = nullptr);
+    ~SchemaComparePanel() override;
     
     QString panelTitle() const override { return tr("Schema Compare"); }
     QString panelCategory() const override { return "database"; }
@@ -87,8 +98,10 @@ private:
     void setupUi();
     void setupModels();
     void runComparison();
+    void onComparisonDone(std::shared_ptr<core::SchemaDiffResult> result, const QString& error,
+                          qint64 elapsedMs);
     void displayResults();
-    QString generateAlterStatement(const SchemaObjectDiff& diff);
+    void showSyncScript();
     
     backend::SessionClient* client_;
     
@@ -128,6 +141,11 @@ private:
     QLabel* modifiedLabel_ = nullptr;
     
     QList<SchemaObjectDiff> differences_;
+    
+    // Both schemas are captured on compareThread_, one connection each
+    std::shared_ptr<core::SchemaDiffResult> diffResult_;
+    std::thread compareThread_;
+    bool comparing_ = false;
 };
 
 // ============================================================================
@@ -164,6 +182,11 @@ public:
     explicit SchemaSyncScriptDialog(const QString& script, 
                                     backend::SessionClient* client = nullptr,
                                     QWidget* parent = nullptr);
+    ~SchemaSyncScriptDialog() override;
+    
+    // The script's statements and the edges between them; while the text
+    // is not edited, each statement starts once its predecessors are done
+    void setScript(core::SchemaSyncScript script);
 
 public slots:
     void onApply();
@@ -173,10 +196,17 @@ public slots:
 private:
     void setupUi();
     void executeScript();
+    void onScriptFinished(int executed, int failed, const QString& error, qint64 elapsedMs,
+                          int connections);
     
     QTextEdit* scriptEdit_ = nullptr;
     backend::SessionClient* client_ = nullptr;
     QPushButton* applyBtn_ = nullptr;
+    
+    QString generatedScript_;
+    std::unique_ptr<core::SchemaSyncScript> syncScript_;
+    std::shared_ptr<core::ScriptRunner> runner_;
+    std::thread runThread_;
 };
 
 } // namespace scratchrobin::ui
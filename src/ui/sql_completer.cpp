@@ -1,6 +1,11 @@
 #include "ui/sql_completer.h"
+#include "ui/catalog_tree_model.h"
 #include "backend/session_client.h"
+#include "core/catalog_cache.h"
+#include "core/scratchbird_catalog_client.h"
 
+#include <QAbstractItemView>
+#include <QApplication>
 #include <QStringListModel>
 #include <QSortFilterProxyModel>
 #include <QTimer>
@@ -8,10 +13,13 @@
 #include <QTreeView>
 #include <QVBoxLayout>
 #include <QPainter>
-#include <QStandardItemModel>
+#include <QPointer>
+#include <QThreadPool>
 #include <QMenu>
 #include <QDebug>
 
+#include <algorithm>
+
 namespace scratchrobin::ui {
 
 // ============================================================================
@@ -75,122 +83,260 @@ SqlCompleterEngine::SqlCompleterEngine(backend::SessionClient* client, QObject*
     loadFunctions();
 }
 
+void SqlCompleterEngine::setCatalogClient(std::shared_ptr<core::ScratchBirdCatalogClient> catalog) {
+    catalog_ = std::move(catalog);
+    ++generation_;
+    objects_.reset();
+    tableNames_.clear();
+    columnVersions_.clear();
+    pendingColumns_.clear();
+    schemaLoaded_ = false;
+    schemaLoading_ = false;
+    loadSchemaObjects();
+}
+
 void SqlCompleterEngine::loadKeywords() {
     for (int i = 0; SQL_KEYWORDS[i]; ++i) {
-        CompletionItem item;
-        item.text = SQL_KEYWORDS[i];
-        item.type = "keyword";
-        item.description = "SQL Keyword";
-        item.priority = 100;
-        keywords_.append(item);
+        core::CompletionEntry entry;
+        entry.text = SQL_KEYWORDS[i];
+        entry.kind = core::CompletionKind::kKeyword;
+        entry.priority = 100;
+        builtins_.Add(std::move(entry));
     }
 }
 
 void SqlCompleterEngine::loadFunctions() {
     for (int i = 0; SQL_FUNCTIONS[i]; ++i) {
-        CompletionItem item;
-        item.text = SQL_FUNCTIONS[i];
-        item.type = "function";
-        item.description = "SQL Function";
-        item.priority = 90;
-        functions_.append(item);
+        core::CompletionEntry entry;
+        entry.text = SQL_FUNCTIONS[i];
+        entry.kind = core::CompletionKind::kFunction;
+        entry.priority = 90;
+        builtins_.Add(std::move(entry));
     }
 }
 
 void SqlCompleterEngine::refreshSchemaCache() {
-    schemaLoaded_ = false;
+    ++generation_;
+    pendingColumns_.clear();
+    schemaLoading_ = false;
     loadSchemaObjects();
 }
 
 void SqlCompleterEngine::loadSchemaObjects() {
-    if (!client_) return;
-    
-    // Mock data for now - in real implementation would query database
-    tables_.clear();
-    views_.clear();
-    schemas_.clear();
-    
-    // Sample tables
-    QStringList sampleTables = {"users", "orders", "products", "categories", 
-                                "customers", "employees", "departments"};
-    for (const auto& table : sampleTables) {
-        CompletionItem item;
-        item.text = table;
-        item.type = "table";
-        item.description = "Table";
-        item.priority = 80;
-        tables_.append(item);
-    }
-    
+    if (!catalog_ || schemaLoading_) return;
+    schemaLoading_ = true;
+
+    auto catalog = catalog_;
+    const quint64 generation = generation_;
+    QPointer<SqlCompleterEngine> self(this);
+    QThreadPool::globalInstance()->start([=]() {
+        core::CatalogCache& cache = catalog->Cache();
+        std::uint64_t listingVersion = cache.ListingVersion();
+        core::Status status = core::Status::Ok();
+        auto tables = catalog->GetTables("", &status);
+        if (cache.ListingVersion() != listingVersion) {
+            // GetTables() read the listing first; index what it read
+            listingVersion = cache.ListingVersion();
+            tables = cache.Tables();
+        }
+
+        auto index = std::make_shared<core::CompletionIndex>();
+        QHash<QString, QPair<QString, QString>> tableNames;
+        std::string lastSchema;
+        for (const auto& table : tables) {
+            if (table.schema != lastSchema) {
+                lastSchema = table.schema;
+                index->Add({table.schema, core::CompletionKind::kSchema, "", "", 70});
+            }
+            const QString name = QString::fromStdString(table.name);
+            const QString group = name.toLower();
+            if (!tableNames.contains(group)) {
+                tableNames.insert(group, {QString::fromStdString(table.schema), name});
+            }
+            index->Add({table.name, core::CompletionKind::kTable, "", table.schema, 80});
+            for (const auto& column : table.columns) {
+                index->Add({column.name, core::CompletionKind::kColumn, group.toStdString(),
+                            table.name, 85});
+            }
+        }
+        QMetaObject::invokeMethod(qApp, [self, generation, listingVersion, index, tableNames]() {
+            if (self) {
+                self->finishSchemaObjects(generation, listingVersion, index, tableNames);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SqlCompleterEngine::finishSchemaObjects(quint64 generation, std::uint64_t listingVersion,
+                                             std::shared_ptr<core::CompletionIndex> index,
+                                             QHash<QString, QPair<QString, QString>> tableNames) {
+    if (generation != generation_) return;
+    objects_ = std::move(index);
+    tableNames_ = std::move(tableNames);
+    // The new index holds whatever columns the cache had; versions are
+    // re-read the next time each table is referenced
+    columnVersions_.clear();
+    indexedListing_ = listingVersion;
     schemaLoaded_ = true;
+    schemaLoading_ = false;
+    emit catalogUpdated();
 }
 
 void SqlCompleterEngine::refreshTables() {
-    loadSchemaObjects();
+    refreshSchemaCache();
 }
 
 void SqlCompleterEngine::refreshColumns(const QString& tableName) {
-    // Mock column data
-    QHash<QString, QStringList> sampleColumns = {
-        {"users", {"id", "username", "email", "created_at", "updated_at"}},
-        {"orders", {"id", "user_id", "product_id", "quantity", "total", "created_at"}},
-        {"products", {"id", "name", "description", "price", "category_id", "in_stock"}},
-        {"categories", {"id", "name", "parent_id"}},
-        {"customers", {"id", "company_name", "contact_name", "phone", "address"}},
-        {"employees", {"id", "first_name", "last_name", "email", "department_id", "hire_date"}},
-        {"departments", {"id", "name", "location"}}
-    };
-    
-    QStringList columns = sampleColumns.value(tableName.toLower());
-    QList<CompletionItem> columnItems;
-    for (const auto& col : columns) {
-        CompletionItem item;
-        item.text = col;
-        item.type = "column";
-        item.description = "Column";
-        item.detail = tableName;  // Source table
-        item.priority = 85;
-        columnItems.append(item);
+    // A version no cache entry has forces a reload
+    columnVersions_.insert(tableName.toLower(), ~quint64{0});
+    ensureColumns({tableName});
+}
+
+QStringList SqlCompleterEngine::referencedTables(const QString& text) {
+    const std::string sql = text.toStdString();
+    const std::vector<core::SqlToken> tokens = significantTokens(sql);
+    QStringList tables;
+    for (std::size_t i = 0; i + 1 < tokens.size(); ++i) {
+        if (!(tokens[i].Is(sql, "FROM") || tokens[i].Is(sql, "JOIN") ||
+              tokens[i].Is(sql, "UPDATE") || tokens[i].Is(sql, "INTO"))) {
+            continue;
+        }
+        // [schema.]table
+        std::size_t name = i + 1;
+        if (name + 2 < tokens.size() &&
+            tokens[name + 1].kind == core::SqlTokenKind::kPunctuation &&
+            sql[tokens[name + 1].offset] == '.') {
+            name += 2;
+        }
+        if (!tokens[name].IsWord()) {
+            continue;
+        }
+        const QString table = QString::fromStdString(std::string(tokens[name].Text(sql))).toLower();
+        if (!tables.contains(table)) {
+            tables.append(table);
+        }
+    }
+    return tables;
+}
+
+std::vector<core::SqlToken> SqlCompleterEngine::significantTokens(const std::string& sql) {
+    static const core::SqlLexer lexer;
+    std::vector<core::SqlToken> tokens;
+    core::SqlToken token;
+    core::SqlLexState state = core::SqlLexState::kNormal;
+    for (std::size_t pos = 0; pos < sql.size(); pos += token.length) {
+        state = lexer.Next(sql, pos, state, &token);
+        if (token.kind != core::SqlTokenKind::kWhitespace &&
+            token.kind != core::SqlTokenKind::kComment) {
+            tokens.push_back(token);
+        }
+    }
+    return tokens;
+}
+
+void SqlCompleterEngine::ensureColumns(const QStringList& tables) {
+    if (!catalog_ || !objects_) return;
+    const core::CatalogCache& cache = catalog_->Cache();
+    for (const QString& name : tables) {
+        const QString group = name.toLower();
+        const auto found = tableNames_.constFind(group);
+        if (found == tableNames_.constEnd() || pendingColumns_.contains(group)) {
+            continue;
+        }
+        const std::string schema = found->first.toStdString();
+        const std::string table = found->second.toStdString();
+        std::uint64_t version = 0;
+        if (!cache.Find(schema, table, &version)) {
+            continue;
+        }
+        // Current when loaded at this version, or, before the first load,
+        // when the index was built with the table's cached columns
+        const auto known = columnVersions_.constFind(group);
+        if (known != columnVersions_.constEnd() ? *known == version
+                                                : objects_->HasGroup(group.toStdString())) {
+            columnVersions_.insert(group, version);
+            continue;
+        }
+
+        pendingColumns_.insert(group);
+        auto catalog = catalog_;
+        const quint64 generation = generation_;
+        QPointer<SqlCompleterEngine> self(this);
+        QThreadPool::globalInstance()->start([=]() {
+            core::Status status = core::Status::Ok();
+            std::vector<core::CompletionEntry> columns;
+            for (const auto& column : catalog->GetColumns(schema, table, &status)) {
+                columns.push_back({column.name, core::CompletionKind::kColumn, "", table, 85});
+            }
+            auto loaded = std::make_shared<std::vector<core::CompletionEntry>>(std::move(columns));
+            QMetaObject::invokeMethod(qApp, [self, generation, group, version, loaded]() {
+                if (self) {
+                    self->finishColumns(generation, group, version, std::move(*loaded));
+                }
+            }, Qt::QueuedConnection);
+        });
     }
-    tableColumns_[tableName.toLower()] = columnItems;
+}
+
+void SqlCompleterEngine::finishColumns(quint64 generation, const QString& table,
+                                       std::uint64_t version,
+                                       std::vector<core::CompletionEntry> columns) {
+    if (generation != generation_ || !objects_) return;
+    pendingColumns_.remove(table);
+    objects_->ReplaceGroup(table.toStdString(), std::move(columns));
+    // Kept on failure too, so a broken table is not refetched on every
+    // keystroke; DDL on it changes the version
+    columnVersions_.insert(table, version);
+    emit catalogUpdated();
 }
 
 SqlCompleterEngine::CompletionContext SqlCompleterEngine::detectContext(
     const QString& text, int cursorPosition) const {
     
-    QString beforeCursor = text.left(cursorPosition).toUpper();
-    
-    // Remove strings and comments for analysis
-    QRegularExpression stringRegex("'[^']*'");
-    beforeCursor.replace(stringRegex, "''");
+    // Walk the words before the cursor; strings, comments and names that
+    // merely contain a keyword never match
+    const std::string sql = text.left(cursorPosition).toStdString();
+    const std::vector<core::SqlToken> tokens = significantTokens(sql);
     
-    // Check for context keywords
-    static const QHash<QString, CompletionContext> contextMap = {
-        {"SELECT", CompletionContext::AfterSelect},
-        {"FROM", CompletionContext::AfterFrom},
-        {"JOIN", CompletionContext::AfterJoin},
-        {"WHERE", CompletionContext::AfterWhere},
-        {"ORDER BY", CompletionContext::AfterOrderBy},
-        {"GROUP BY", CompletionContext::AfterGroupBy},
-        {"INSERT INTO", CompletionContext::AfterInsert},
-        {"UPDATE", CompletionContext::AfterUpdate},
-        {"CREATE", CompletionContext::AfterCreate},
-    };
-    
-    // Find the most recent context keyword
-    int lastPos = -1;
     CompletionContext context = CompletionContext::General;
-    
-    for (auto it = contextMap.begin(); it != contextMap.end(); ++it) {
-        int pos = beforeCursor.lastIndexOf(it.key());
-        if (pos > lastPos) {
-            lastPos = pos;
-            context = it.value();
+    std::vector<bool> parens;  // Per open '(': whether it follows a name
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        const core::SqlToken& token = tokens[i];
+        if (token.kind == core::SqlTokenKind::kPunctuation) {
+            const char c = sql[token.offset];
+            if (c == '(') {
+                parens.push_back(i > 0 && tokens[i - 1].IsWord());
+            } else if (c == ')' && !parens.empty()) {
+                parens.pop_back();
+            }
+            continue;
+        }
+        if (!token.IsWord()) {
+            continue;
+        }
+        const bool afterOrder = i > 0 && tokens[i - 1].Is(sql, "ORDER");
+        const bool afterGroup = i > 0 && tokens[i - 1].Is(sql, "GROUP");
+        if (token.Is(sql, "SELECT")) {
+            context = CompletionContext::AfterSelect;
+        } else if (token.Is(sql, "FROM")) {
+            context = CompletionContext::AfterFrom;
+        } else if (token.Is(sql, "JOIN")) {
+            context = CompletionContext::AfterJoin;
+        } else if (token.Is(sql, "WHERE")) {
+            context = CompletionContext::AfterWhere;
+        } else if (token.Is(sql, "BY") && (afterOrder || afterGroup)) {
+            context = afterOrder ? CompletionContext::AfterOrderBy : CompletionContext::AfterGroupBy;
+        } else if (token.Is(sql, "INTO") && i > 0 && tokens[i - 1].Is(sql, "INSERT")) {
+            context = CompletionContext::AfterInsert;
+        } else if (token.Is(sql, "UPDATE")) {
+            context = CompletionContext::AfterUpdate;
+        } else if (token.Is(sql, "CREATE")) {
+            context = CompletionContext::AfterCreate;
         }
     }
     
-    // Check if we're in a function call
-    if (beforeCursor.contains(QRegularExpression("\\w+\\s*\\([^)]*$"))) {
+    // Inside the argument list of a call
+    if (!parens.empty() && parens.back()) {
         return CompletionContext::InFunction;
     }
     
@@ -198,149 +344,96 @@ SqlCompleterEngine::CompletionContext SqlCompleterEngine::detectContext(
 }
 
 QList<SqlCompleterEngine::CompletionItem> SqlCompleterEngine::getCompletions(
-    const QString& text, int cursorPosition, const QString& currentWord) {
-    
-    QList<CompletionItem> allItems;
-    
-    // Always include keywords
-    allItems.append(keywords_);
+    const QString& text, int cursorPosition, const QString& currentWord, int limit, bool fuzzy) {
     
-    // Add functions
-    allItems.append(functions_);
-    
-    // Add schema objects if loaded
-    if (!schemaLoaded_) {
-        loadSchemaObjects();
+    if (catalog_ && !schemaLoading_ &&
+        (!schemaLoaded_ || catalog_->Cache().ListingVersion() != indexedListing_)) {
+        loadSchemaObjects();  // The current index answers until the new one is ready
     }
     
-    // Context-aware filtering
-    auto context = detectContext(text, cursorPosition);
+    using core::CompletionKind;
+    using core::CompletionKindBit;
+    core::CompletionQuery query;
+    query.pattern = currentWord.toStdString();
+    query.limit = static_cast<std::size_t>(std::max(limit, 0));
+    query.fuzzy = fuzzy;
+    query.kinds = CompletionKindBit(CompletionKind::kSchema) | CompletionKindBit(CompletionKind::kTable) |
+                  CompletionKindBit(CompletionKind::kView);
     
-    switch (context) {
-        case CompletionContext::AfterFrom:
-        case CompletionContext::AfterJoin:
-        case CompletionContext::AfterUpdate:
-            // Prioritize tables
-            allItems.append(tables_);
-            allItems.append(views_);
-            break;
-            
+    // Context-aware filtering
+    switch (detectContext(text, cursorPosition)) {
         case CompletionContext::AfterSelect:
         case CompletionContext::AfterWhere:
         case CompletionContext::AfterOrderBy:
-        case CompletionContext::AfterGroupBy:
-            // Add columns from tables mentioned in query
-            allItems.append(tables_);  // Can also use table names in expressions
-            // Try to extract table names from query
-            {
-                QRegularExpression fromRegex("FROM\\s+(\\w+)", QRegularExpression::CaseInsensitiveOption);
-                auto match = fromRegex.match(text);
-                if (match.hasMatch()) {
-                    QString tableName = match.captured(1).toLower();
-                    if (!tableColumns_.contains(tableName)) {
-                        const_cast<SqlCompleterEngine*>(this)->refreshColumns(tableName);
-                    }
-                    allItems.append(tableColumns_.value(tableName));
-                }
+        case CompletionContext::AfterGroupBy: {
+            // Columns of the tables mentioned in the query
+            const QStringList tables = referencedTables(text);
+            ensureColumns(tables);
+            for (const QString& table : tables) {
+                query.column_groups.push_back(table.toStdString());
             }
+            query.kinds = CompletionKindBit(CompletionKind::kTable) |
+                          CompletionKindBit(CompletionKind::kColumn);
             break;
-            
-        case CompletionContext::AfterInsert:
-            allItems.append(tables_);
-            break;
-            
+        }
         default:
-            allItems.append(tables_);
-            allItems.append(views_);
             break;
     }
     
-    // Filter by current word
-    if (!currentWord.isEmpty()) {
-        allItems = fuzzyMatch(allItems, currentWord.toUpper());
-    }
-    
-    // Sort by priority
-    std::sort(allItems.begin(), allItems.end(), 
-              [](const CompletionItem& a, const CompletionItem& b) {
-                  if (a.priority != b.priority) return a.priority > b.priority;
-                  return a.text < b.text;
-              });
-    
-    return allItems;
-}
-
-QList<SqlCompleterEngine::CompletionItem> SqlCompleterEngine::fuzzyMatch(
-    const QList<CompletionItem>& items, const QString& pattern) {
-    
-    QList<QPair<CompletionItem, int>> scored;  // item, score
-    
-    for (const auto& item : items) {
-        int score = calculateMatchScore(item.text, pattern);
-        if (score > 0) {
-            scored.append({item, score});
-        }
-    }
-    
-    // Sort by score descending
-    std::sort(scored.begin(), scored.end(),
-              [](const auto& a, const auto& b) { return a.second > b.second; });
-    
-    QList<CompletionItem> result;
-    for (const auto& pair : scored) {
-        result.append(pair.first);
+    // Keywords and functions are always offered
+    std::vector<core::CompletionMatch> matches = builtins_.Search(query);
+    if (objects_) {
+        auto objects = objects_->Search(query);
+        matches.insert(matches.end(), objects.begin(), objects.end());
     }
-    
-    return result;
-}
-
-int SqlCompleterEngine::calculateMatchScore(const QString& item, const QString& pattern) {
-    QString itemUpper = item.toUpper();
-    QString patternUpper = pattern.toUpper();
-    
-    // Exact match - highest score
-    if (itemUpper == patternUpper) return 1000;
-    
-    // Starts with - high score
-    if (itemUpper.startsWith(patternUpper)) return 800 - item.length();
-    
-    // Contains as word - good score
-    if (itemUpper.contains(" " + patternUpper) || 
-        itemUpper.contains("(" + patternUpper)) {
-        return 600 - item.length();
-    }
-    
-    // Contains anywhere - medium score
-    if (itemUpper.contains(patternUpper)) {
-        return 400 - item.length();
-    }
-    
-    // Fuzzy match - calculate character sequence match
-    int patternIdx = 0;
-    int itemIdx = 0;
-    int matchCount = 0;
-    int lastMatchIdx = -1;
-    int totalGap = 0;
-    
-    while (patternIdx < patternUpper.length() && itemIdx < itemUpper.length()) {
-        if (patternUpper[patternIdx] == itemUpper[itemIdx]) {
-            matchCount++;
-            if (lastMatchIdx >= 0) {
-                totalGap += itemIdx - lastMatchIdx - 1;
-            }
-            lastMatchIdx = itemIdx;
-            patternIdx++;
+    const std::size_t keep = std::min(query.limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + keep, matches.end(),
+                      [](const core::CompletionMatch& a, const core::CompletionMatch& b) {
+                          if (a.score != b.score) return a.score > b.score;
+                          if (a.entry->priority != b.entry->priority) {
+                              return a.entry->priority > b.entry->priority;
+                          }
+                          return a.entry->text < b.entry->text;
+                      });
+    matches.resize(keep);
+    
+    QList<CompletionItem> items;
+    items.reserve(static_cast<int>(matches.size()));
+    for (const auto& match : matches) {
+        const core::CompletionEntry& entry = *match.entry;
+        CompletionItem item;
+        item.text = QString::fromStdString(entry.text);
+        item.detail = QString::fromStdString(entry.detail);
+        item.priority = entry.priority;
+        switch (entry.kind) {
+            case CompletionKind::kKeyword:
+                item.type = "keyword";
+                item.description = "SQL Keyword";
+                break;
+            case CompletionKind::kFunction:
+                item.type = "function";
+                item.description = "SQL Function";
+                break;
+            case CompletionKind::kSchema:
+                item.type = "schema";
+                item.description = "Schema";
+                break;
+            case CompletionKind::kTable:
+                item.type = "table";
+                item.description = "Table";
+                break;
+            case CompletionKind::kView:
+                item.type = "view";
+                item.description = "View";
+                break;
+            case CompletionKind::kColumn:
+                item.type = "column";
+                item.description = "Column";
+                break;
         }
-        itemIdx++;
-    }
-    
-    // All characters matched
-    if (matchCount == patternUpper.length()) {
-        // Score based on gap size (smaller gaps = better)
-        return 200 - (totalGap * 10) - item.length();
+        items.append(item);
     }
-    
-    return 0;  // No match
+    return items;
 }
 
 // ============================================================================
@@ -352,8 +445,9 @@ SqlCompleter::SqlCompleter(backend::SessionClient* client, QObject* parent)
     
     setupModel();
     
-    // Configure popup
-    setCompletionMode(QCompleter::PopupCompletion);
+    // Configure popup; the engine ranks fuzzy and substring matches, which
+    // the completer's own prefix filter would hide
+    setCompletionMode(QCompleter::UnfilteredPopupCompletion);
     setCaseSensitivity(Qt::CaseInsensitive);
     setWrapAround(false);
     setMaxVisibleItems(15);
@@ -363,6 +457,17 @@ SqlCompleter::SqlCompleter(backend::SessionClient* client, QObject* parent)
     triggerTimer_->setSingleShot(true);
     triggerTimer_->setInterval(TRIGGER_DELAY_MS);
     connect(triggerTimer_, &QTimer::timeout, this, &SqlCompleter::performCompletion);
+
+    // Catalog names and columns load in the background; refresh an open popup
+    connect(engine_, &SqlCompleterEngine::catalogUpdated, this, [this]() {
+        if (popup() && popup()->isVisible()) {
+            performCompletion();
+        }
+    });
+}
+
+void SqlCompleter::setCatalogClient(std::shared_ptr<core::ScratchBirdCatalogClient> catalog) {
+    engine_->setCatalogClient(std::move(catalog));
 }
 
 void SqlCompleter::setupModel() {
@@ -400,13 +505,9 @@ void SqlCompleter::performCompletion() {
     
     QString currentWord = textBeforeCursor.mid(wordStart);
     
-    // Get completions
-    auto items = engine_->getCompletions(editorText_, cursorPosition_, currentWord);
-    
-    // Limit results
-    if (items.size() > maxSuggestions_) {
-        items = items.mid(0, maxSuggestions_);
-    }
+    // Get completions, already ranked and limited
+    auto items = engine_->getCompletions(editorText_, cursorPosition_, currentWord,
+                                         maxSuggestions_, fuzzyMatching_);
     
     // Update model
     updateModel(items);
@@ -475,17 +576,9 @@ void CompletionItemDelegate::drawIcon(QPainter* painter, const QRect& rect,
 // SchemaBrowserPanel
 // ============================================================================
 
-class SchemaBrowserPanel::SchemaTreeModel : public QStandardItemModel {
-public:
-    explicit SchemaTreeModel(QObject* parent = nullptr) : QStandardItemModel(parent) {
-        setHorizontalHeaderLabels({"Object", "Type"});
-    }
-};
-
 SchemaBrowserPanel::SchemaBrowserPanel(backend::SessionClient* client, QWidget* parent)
     : QWidget(parent), client_(client) {
     setupUi();
-    loadSchemaTree();
 }
 
 void SchemaBrowserPanel::setupUi() {
@@ -495,20 +588,41 @@ void SchemaBrowserPanel::setupUi() {
     
     // Filter
     filterEdit_ = new QLineEdit(this);
-    filterEdit_->setPlaceholderText(tr("Filter objects..."));
+    filterEdit_->setPlaceholderText(tr("Search all objects..."));
+    filterEdit_->setClearButtonEnabled(true);
     layout->addWidget(filterEdit_);
     
     // Tree view
     treeView_ = new QTreeView(this);
     treeView_->setHeaderHidden(true);
     treeView_->setAlternatingRowColors(true);
+    treeView_->setUniformRowHeights(true);
     layout->addWidget(treeView_);
     
-    treeModel_ = new SchemaTreeModel(this);
+    treeModel_ = new CatalogTreeModel(this);
     treeView_->setModel(treeModel_);
     
+    // Typing restarts the timer; the search runs once it pauses
+    filterTimer_ = new QTimer(this);
+    filterTimer_->setSingleShot(true);
+    filterTimer_->setInterval(300);
+    
     // Connections
-    connect(filterEdit_, &QLineEdit::textChanged, this, &SchemaBrowserPanel::setFilter);
+    connect(filterEdit_, &QLineEdit::textChanged, this, [this]() { filterTimer_->start(); });
+    connect(filterTimer_, &QTimer::timeout, this, [this]() { setFilter(filterEdit_->text()); });
+    connect(treeModel_, &CatalogTreeModel::searchFinished, this, [this]() {
+        // Open the paths to the hits, but not tables that would have to be fetched
+        for (int i = 0; i < treeModel_->rowCount(); ++i) {
+            const QModelIndex schema = treeModel_->index(i, 0);
+            treeView_->expand(schema);
+            for (int j = 0; j < treeModel_->rowCount(schema); ++j) {
+                const QModelIndex table = treeModel_->index(j, 0, schema);
+                if (!treeModel_->canFetchMore(table)) {
+                    treeView_->expand(table);
+                }
+            }
+        }
+    });
     connect(treeView_, &QTreeView::clicked, this, &SchemaBrowserPanel::onItemClicked);
     connect(treeView_, &QTreeView::doubleClicked, this, &SchemaBrowserPanel::onItemDoubleClicked);
     treeView_->setContextMenuPolicy(Qt::CustomContextMenu);
@@ -516,75 +630,27 @@ void SchemaBrowserPanel::setupUi() {
             this, &SchemaBrowserPanel::showContextMenu);
 }
 
-void SchemaBrowserPanel::loadSchemaTree() {
-    treeModel_->clear();
-    
-    // Tables category
-    auto* tablesItem = new QStandardItem(tr("Tables"));
-    tablesItem->setIcon(QIcon::fromTheme("folder"));
-    treeModel_->appendRow(tablesItem);
-    
-    QStringList tables = {"users", "orders", "products", "categories", 
-                          "customers", "employees", "departments"};
-    for (const auto& table : tables) {
-        auto* item = new QStandardItem(table);
-        item->setData("table", Qt::UserRole);
-        tablesItem->appendRow(item);
-    }
-    tablesItem->setRowCount(tables.size());
-    
-    // Views category
-    auto* viewsItem = new QStandardItem(tr("Views"));
-    viewsItem->setIcon(QIcon::fromTheme("folder"));
-    treeModel_->appendRow(viewsItem);
-    
-    QStringList views = {"active_users", "sales_summary", "inventory_status"};
-    for (const auto& view : views) {
-        auto* item = new QStandardItem(view);
-        item->setData("view", Qt::UserRole);
-        viewsItem->appendRow(item);
-    }
-    
-    // Procedures category
-    auto* procsItem = new QStandardItem(tr("Procedures"));
-    procsItem->setIcon(QIcon::fromTheme("folder"));
-    treeModel_->appendRow(procsItem);
-    
-    treeView_->expandAll();
+void SchemaBrowserPanel::setCatalogClient(std::shared_ptr<core::ScratchBirdCatalogClient> catalog) {
+    filterEdit_->clear();
+    filterTimer_->stop();
+    treeModel_->setCatalogClient(std::move(catalog));
 }
 
 void SchemaBrowserPanel::refresh() {
-    loadSchemaTree();
+    treeModel_->reload(true);
 }
 
 void SchemaBrowserPanel::setFilter(const QString& filter) {
-    // Simple filter implementation
-    for (int i = 0; i < treeModel_->rowCount(); ++i) {
-        auto* parent = treeModel_->item(i);
-        bool parentVisible = false;
-        
-        for (int j = 0; j < parent->rowCount(); ++j) {
-            auto* child = parent->child(j);
-            bool match = filter.isEmpty() || 
-                        child->text().contains(filter, Qt::CaseInsensitive);
-            treeView_->setRowHidden(j, parent->index(), !match);
-            if (match) parentVisible = true;
-        }
-        
-        treeView_->setRowHidden(i, QModelIndex(), !parentVisible && !filter.isEmpty());
-    }
+    treeModel_->setSearchText(filter);
 }
 
 void SchemaBrowserPanel::onItemClicked() {
     auto index = treeView_->currentIndex();
     if (!index.isValid()) return;
     
-    auto* item = treeModel_->itemFromIndex(index);
-    if (!item) return;
-    
-    QString type = item->data(Qt::UserRole).toString();
+    QString type = index.siblingAtColumn(0).data(CatalogTreeModel::KindRole).toString();
     if (!type.isEmpty()) {
-        emit objectSelected(item->text(), type);
+        emit objectSelected(index.siblingAtColumn(0).data().toString(), type);
     }
 }
 
@@ -592,12 +658,9 @@ void SchemaBrowserPanel::onItemDoubleClicked() {
     auto index = treeView_->currentIndex();
     if (!index.isValid()) return;
     
-    auto* item = treeModel_->itemFromIndex(index);
-    if (!item) return;
-    
-    QString type = item->data(Qt::UserRole).toString();
+    QString type = index.siblingAtColumn(0).data(CatalogTreeModel::KindRole).toString();
     if (!type.isEmpty()) {
-        emit objectDoubleClicked(item->text(), type);
+        emit objectDoubleClicked(index.siblingAtColumn(0).data().toString(), type);
     }
 }
 
@@ -1,9 +1,18 @@
 #pragma once
 #include <QCompleter>
 #include <QHash>
+#include <QSet>
 #include <QTimer>
 #include <QStyledItemDelegate>
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/completion_index.h"
+#include "core/sql_lexer.h"
+
 QT_BEGIN_NAMESPACE
 class QAbstractItemModel;
 class QStringListModel;
@@ -15,8 +24,14 @@ namespace scratchrobin::backend {
 class SessionClient;
 }
 
+namespace scratchrobin::core {
+class ScratchBirdCatalogClient;
+}
+
 namespace scratchrobin::ui {
 
+class CatalogTreeModel;
+
 /**
  * @brief Enhanced SQL code completion engine
  * 
@@ -25,7 +40,15 @@ namespace scratchrobin::ui {
  * - Schema object completion (tables, views, procedures)
  * - Table/column completion with context awareness
  * - Fuzzy matching for partial input
- * - Performance < 500ms response time
+ * - Performance < 10ms response time with 200k catalog identifiers
+ *
+ * Keywords and functions live in one CompletionIndex; schemas, tables and
+ * the columns cached so far live in a second one that is built from the
+ * catalog cache on the thread pool and swapped in when ready. It is
+ * rebuilt whenever the cache's listing changes, while the old one keeps
+ * answering. Columns are grouped by table: the columns of a table named
+ * in the statement are loaded in the background, replacing just that
+ * group, and catalogUpdated() asks the caller to complete again.
  */
 class SqlCompleterEngine : public QObject {
     Q_OBJECT
@@ -41,13 +64,17 @@ public:
 
     explicit SqlCompleterEngine(backend::SessionClient* client, QObject* parent = nullptr);
 
+    void setCatalogClient(std::shared_ptr<core::ScratchBirdCatalogClient> catalog);
+
     // Schema caching
     void refreshSchemaCache();
     void refreshTables();
     void refreshColumns(const QString& tableName);
     
-    // Completion queries
-    QList<CompletionItem> getCompletions(const QString& text, int cursorPosition, const QString& currentWord);
+    // Completion queries; at most |limit| items, best first
+    QList<CompletionItem> getCompletions(const QString& text, int cursorPosition,
+                                         const QString& currentWord, int limit = 50,
+                                         bool fuzzy = true);
     
     // Context-aware completion
     enum class CompletionContext {
@@ -66,26 +93,40 @@ public:
 
     CompletionContext detectContext(const QString& text, int cursorPosition) const;
 
+signals:
+    // Catalog identifiers or a table's columns arrived
+    void catalogUpdated();
+
 private:
     void loadKeywords();
     void loadFunctions();
     void loadSchemaObjects();
-    
-    QList<CompletionItem> filterByContext(const QList<CompletionItem>& items, CompletionContext context);
-    QList<CompletionItem> fuzzyMatch(const QList<CompletionItem>& items, const QString& pattern);
-    int calculateMatchScore(const QString& item, const QString& pattern);
+    void finishSchemaObjects(quint64 generation, std::uint64_t listingVersion,
+                             std::shared_ptr<core::CompletionIndex> index,
+                             QHash<QString, QPair<QString, QString>> tableNames);
+    void finishColumns(quint64 generation, const QString& table, std::uint64_t version,
+                       std::vector<core::CompletionEntry> columns);
+    static QStringList referencedTables(const QString& text);
+    // Tokens of |sql| without whitespace and comments
+    static std::vector<core::SqlToken> significantTokens(const std::string& sql);
+    void ensureColumns(const QStringList& tables);
 
     backend::SessionClient* client_ = nullptr;
+    std::shared_ptr<core::ScratchBirdCatalogClient> catalog_;
     
     // Cached data
-    QHash<QString, QList<CompletionItem>> tableColumns_;  // table -> columns
-    QList<CompletionItem> keywords_;
-    QList<CompletionItem> functions_;
-    QList<CompletionItem> tables_;
-    QList<CompletionItem> views_;
-    QList<CompletionItem> schemas_;
+    core::CompletionIndex builtins_;  // Keywords and functions
+    // Schemas, tables and columns; columns are grouped by lower-cased table
+    std::shared_ptr<core::CompletionIndex> objects_;
+    QHash<QString, QPair<QString, QString>> tableNames_;  // lower-cased -> (schema, table)
+    QHash<QString, quint64> columnVersions_;  // table -> cache version loaded
+    QSet<QString> pendingColumns_;
     
+    // Bumped when the catalog client changes; older results are dropped
+    quint64 generation_ = 0;
+    std::uint64_t indexedListing_ = 0;
     bool schemaLoaded_ = false;
+    bool schemaLoading_ = false;
 };
 
 // ============================================================================
@@ -97,6 +138,7 @@ class SqlCompleter : public QCompleter {
 public:
     explicit SqlCompleter(backend::SessionClient* client, QObject* parent = nullptr);
 
+    void setCatalogClient(std::shared_ptr<core::ScratchBirdCatalogClient> catalog);
     void setEditorText(const QString& text);
     void setCursorPosition(int pos);
     
@@ -159,7 +201,10 @@ class SchemaBrowserPanel : public QWidget {
 public:
     explicit SchemaBrowserPanel(backend::SessionClient* client, QWidget* parent = nullptr);
 
+    // The tree is browsed lazily from |catalog|; see CatalogTreeModel
+    void setCatalogClient(std::shared_ptr<core::ScratchBirdCatalogClient> catalog);
     void refresh();
+    // Searches the whole catalog on the server once typing pauses
     void setFilter(const QString& filter);
 
 signals:
@@ -168,17 +213,16 @@ signals:
 
 private:
     void setupUi();
-    void loadSchemaTree();
     void onItemClicked();
     void onItemDoubleClicked();
     void showContextMenu(const QPoint& pos);
 
     backend::SessionClient* client_ = nullptr;
     
-    class SchemaTreeModel;
-    SchemaTreeModel* treeModel_ = nullptr;
+    CatalogTreeModel* treeModel_ = nullptr;
     QTreeView* treeView_ = nullptr;
     QLineEdit* filterEdit_ = nullptr;
+    QTimer* filterTimer_ = nullptr;
 };
 
 } // namespace scratchrobin::ui
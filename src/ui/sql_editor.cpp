@@ -22,156 +22,79 @@ namespace scratchrobin::ui {
 
 SqlSyntaxHighlighter::SqlSyntaxHighlighter(QTextDocument* parent)
     : QSyntaxHighlighter(parent) {
-  setupRules();
+  setupFormats("light");
 }
 
-void SqlSyntaxHighlighter::setupRules() {
-  // Keywords
-  QStringList keywords;
-  keywords << "SELECT" << "FROM" << "WHERE" << "INSERT" << "UPDATE" << "DELETE"
-           << "CREATE" << "DROP" << "ALTER" << "TABLE" << "INDEX" << "VIEW"
-           << "JOIN" << "LEFT" << "RIGHT" << "INNER" << "OUTER" << "ON"
-           << "AND" << "OR" << "NOT" << "NULL" << "IS" << "IN" << "EXISTS"
-           << "ORDER" << "BY" << "GROUP" << "HAVING" << "LIMIT" << "OFFSET"
-           << "UNION" << "ALL" << "DISTINCT" << "AS" << "VALUES" << "SET"
-           << "BEGIN" << "COMMIT" << "ROLLBACK" << "TRANSACTION" << "PRIMARY"
-           << "KEY" << "FOREIGN" << "REFERENCES" << "UNIQUE" << "CHECK" << "DEFAULT"
-           << "INT" << "VARCHAR" << "CHAR" << "TEXT" << "DATE" << "TIME"
-           << "DATETIME" << "DECIMAL" << "NUMERIC" << "FLOAT" << "BOOLEAN";
-  
-  keywordFormat_.setForeground(QColor(0, 0, 255));
-  keywordFormat_.setFontWeight(QFont::Bold);
-  
-  for (const QString& keyword : keywords) {
-    HighlightingRule rule;
-    rule.pattern = QRegularExpression(QString("\\b%1\\b").arg(keyword), QRegularExpression::CaseInsensitiveOption);
-    rule.format = keywordFormat_;
-    rules_.append(rule);
-  }
-  
-  // Functions
-  QStringList functions;
-  functions << "COUNT" << "SUM" << "AVG" << "MIN" << "MAX" << "CONCAT"
-            << "SUBSTRING" << "LENGTH" << "UPPER" << "LOWER" << "COALESCE"
-            << "CAST" << "NOW" << "CURRENT_DATE" << "CURRENT_TIMESTAMP";
-  
-  functionFormat_.setForeground(QColor(128, 0, 128));
-  
-  for (const QString& function : functions) {
-    HighlightingRule rule;
-    rule.pattern = QRegularExpression(QString("\\b%1(?=\\s*\\()").arg(function), QRegularExpression::CaseInsensitiveOption);
-    rule.format = functionFormat_;
-    rules_.append(rule);
-  }
-  
-  // Strings
-  stringFormat_.setForeground(QColor(0, 128, 0));
-  HighlightingRule stringRule;
-  stringRule.pattern = QRegularExpression("'[^']*'");
-  stringRule.format = stringFormat_;
-  rules_.append(stringRule);
-  
-  // Comments
-  commentFormat_.setForeground(QColor(128, 128, 128));
-  commentFormat_.setFontItalic(true);
-  HighlightingRule commentRule;
-  commentRule.pattern = QRegularExpression("--[^\\n]*");
-  commentRule.format = commentFormat_;
-  rules_.append(commentRule);
-  
-  // Multi-line comments
-  HighlightingRule multiLineComment;
-  multiLineComment.pattern = QRegularExpression("/\\*.*?\\*/");
-  multiLineComment.format = commentFormat_;
-  rules_.append(multiLineComment);
-  
-  // Numbers
-  numberFormat_.setForeground(QColor(255, 0, 0));
-  HighlightingRule numberRule;
-  numberRule.pattern = QRegularExpression("\\b\\d+(\\.\\d+)?\\b");
-  numberRule.format = numberFormat_;
-  rules_.append(numberRule);
-  
-  // Operators
-  operatorFormat_.setForeground(QColor(0, 0, 128));
-  HighlightingRule operatorRule;
-  operatorRule.pattern = QRegularExpression("[+\\-*/=<>!]+");
-  operatorRule.format = operatorFormat_;
-  rules_.append(operatorRule);
-}
-
-void SqlSyntaxHighlighter::setColorScheme(const QString& scheme) {
-  // Clear existing rules
-  rules_.clear();
+void SqlSyntaxHighlighter::setupFormats(const QString& scheme) {
+  keywordFormat_ = QTextCharFormat();
+  stringFormat_ = QTextCharFormat();
+  commentFormat_ = QTextCharFormat();
+  numberFormat_ = QTextCharFormat();
+  functionFormat_ = QTextCharFormat();
+  operatorFormat_ = QTextCharFormat();
   
   if (scheme == "dark") {
     // Dark theme colors
     keywordFormat_.setForeground(QColor(255, 121, 198));    // Pink
-    keywordFormat_.setFontWeight(QFont::Bold);
-    
     stringFormat_.setForeground(QColor(241, 250, 140));     // Yellow
-    
     commentFormat_.setForeground(QColor(98, 114, 164));     // Gray
-    commentFormat_.setFontItalic(true);
-    
     numberFormat_.setForeground(QColor(189, 147, 249));     // Purple
-    
     functionFormat_.setForeground(QColor(80, 250, 123));    // Green
-    
     operatorFormat_.setForeground(QColor(139, 233, 253));   // Cyan
   } else {
     // Light theme colors (default)
     keywordFormat_.setForeground(QColor(0, 0, 255));        // Blue
-    keywordFormat_.setFontWeight(QFont::Bold);
-    
     stringFormat_.setForeground(QColor(0, 128, 0));         // Green
-    
     commentFormat_.setForeground(QColor(128, 128, 128));    // Gray
-    commentFormat_.setFontItalic(true);
-    
     numberFormat_.setForeground(QColor(255, 0, 0));         // Red
-    
     functionFormat_.setForeground(QColor(0, 128, 128));     // Teal
-    
     operatorFormat_.setForeground(QColor(0, 0, 128));       // Navy
   }
-  
-  // Rebuild rules with new colors
-  setupRules();
+  keywordFormat_.setFontWeight(QFont::Bold);
+  commentFormat_.setFontItalic(true);
+}
+
+void SqlSyntaxHighlighter::setColorScheme(const QString& scheme) {
+  setupFormats(scheme);
   
   // Re-highlight the entire document
   rehighlight();
 }
 
-void SqlSyntaxHighlighter::highlightBlock(const QString& text) {
-  for (const HighlightingRule& rule : rules_) {
-    QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
-    while (matchIterator.hasNext()) {
-      QRegularExpressionMatch match = matchIterator.next();
-      setFormat(match.capturedStart(), match.capturedLength(), rule.format);
-    }
-  }
-  
-  // Handle multi-line comments
-  setCurrentBlockState(0);
-  
-  int startIndex = 0;
-  if (previousBlockState() != 1) {
-    startIndex = text.indexOf("/*");
+const QTextCharFormat* SqlSyntaxHighlighter::formatFor(core::SqlTokenKind kind) const {
+  switch (kind) {
+    case core::SqlTokenKind::kKeyword: return &keywordFormat_;
+    case core::SqlTokenKind::kFunction: return &functionFormat_;
+    case core::SqlTokenKind::kString: return &stringFormat_;
+    case core::SqlTokenKind::kComment: return &commentFormat_;
+    case core::SqlTokenKind::kNumber: return &numberFormat_;
+    case core::SqlTokenKind::kOperator: return &operatorFormat_;
+    default: return nullptr;
   }
-  
-  while (startIndex >= 0) {
-    int endIndex = text.indexOf("*/", startIndex);
-    int commentLength;
-    if (endIndex == -1) {
-      setCurrentBlockState(1);
-      commentLength = text.length() - startIndex;
-    } else {
-      commentLength = endIndex - startIndex + 2;
+}
+
+void SqlSyntaxHighlighter::highlightBlock(const QString& text) {
+  // The lexer works on bytes; one byte per UTF-16 unit keeps token offsets
+  // equal to QString positions. Non-ASCII units lex as identifier bytes.
+  const int length = text.size();
+  blockText_.resize(static_cast<std::size_t>(length));
+  const QChar* chars = text.constData();
+  for (int i = 0; i < length; ++i) {
+    const ushort unit = chars[i].unicode();
+    blockText_[static_cast<std::size_t>(i)] = unit < 0x80 ? static_cast<char>(unit) : '\x80';
+  }
+  
+  const int previous = previousBlockState();
+  const auto state = previous > 0 ? static_cast<core::SqlLexState>(previous)
+                                  : core::SqlLexState::kNormal;
+  tokens_.clear();
+  const core::SqlLexState end = lexer_.Lex(blockText_, state, &tokens_);
+  for (const auto& token : tokens_) {
+    if (const QTextCharFormat* format = formatFor(token.kind)) {
+      setFormat(static_cast<int>(token.offset), static_cast<int>(token.length), *format);
     }
-    setFormat(startIndex, commentLength, commentFormat_);
-    startIndex = text.indexOf("/*", startIndex + commentLength);
   }
+  setCurrentBlockState(static_cast<int>(end));
 }
 
 // ============================================================================
@@ -863,19 +786,27 @@ QString SqlEditor::textUnderCursor() const {
 // ============================================================================
 
 QString SqlFormatter::format(const QString& sql, const FormatOptions& options) {
-  if (sql.trimmed().isEmpty()) return sql;
-  
-  QString upperSql = sql.toUpper().trimmed();
-  
-  if (upperSql.startsWith("SELECT")) {
+  // Dispatch on the first token rather than an upper-cased copy of the text
+  static const core::SqlLexer lexer;
+  const std::string text = sql.toStdString();
+  core::SqlToken token;
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    lexer.Next(text, pos, core::SqlLexState::kNormal, &token);
+    if (token.kind != core::SqlTokenKind::kWhitespace) break;
+    pos += token.length;
+  }
+  if (pos >= text.size() || !token.IsWord()) return sql;
+  
+  if (token.Is(text, "SELECT")) {
     return formatSelect(sql, options);
-  } else if (upperSql.startsWith("INSERT")) {
+  } else if (token.Is(text, "INSERT")) {
     return formatInsert(sql, options);
-  } else if (upperSql.startsWith("UPDATE")) {
+  } else if (token.Is(text, "UPDATE")) {
     return formatUpdate(sql, options);
-  } else if (upperSql.startsWith("DELETE")) {
+  } else if (token.Is(text, "DELETE")) {
     return formatDelete(sql, options);
-  } else if (upperSql.startsWith("CREATE")) {
+  } else if (token.Is(text, "CREATE")) {
     return formatCreate(sql, options);
   }
   
@@ -883,9 +814,39 @@ QString SqlFormatter::format(const QString& sql, const FormatOptions& options) {
 }
 
 QString SqlFormatter::minify(const QString& sql) {
-  QString result = sql.simplified();
-  result.replace(QRegularExpression("\\s*([,;()])\\s*"), "\\1");
-  return result;
+  // Token by token, so whitespace inside strings and quoted names is kept
+  // and a line comment cannot swallow the rest of the one-line result
+  static const core::SqlLexer lexer;
+  const std::string text = sql.toStdString();
+  auto tight = [&](const core::SqlToken& t) {
+    if (t.kind != core::SqlTokenKind::kPunctuation) return false;
+    const char c = text[t.offset];
+    return c == ',' || c == ';' || c == '(' || c == ')';
+  };
+  
+  std::string result;
+  result.reserve(text.size());
+  core::SqlToken token;
+  core::SqlToken prev;
+  bool havePrev = false;
+  bool spaced = false;
+  core::SqlLexState state = core::SqlLexState::kNormal;
+  for (std::size_t pos = 0; pos < text.size(); pos += token.length) {
+    state = lexer.Next(text, pos, state, &token);
+    if (token.kind == core::SqlTokenKind::kWhitespace ||
+        token.kind == core::SqlTokenKind::kComment) {
+      spaced = true;
+      continue;
+    }
+    if (havePrev && spaced && !tight(prev) && !tight(token)) {
+      result += ' ';
+    }
+    result.append(token.Text(text));
+    prev = token;
+    havePrev = true;
+    spaced = false;
+  }
+  return QString::fromStdString(result);
 }
 
 QString SqlFormatter::formatSelect(const QString& sql, const FormatOptions& options) {
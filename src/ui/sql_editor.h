@@ -5,6 +5,11 @@
 #include <QCompleter>
 #include <QStringListModel>
 
+#include <string>
+#include <vector>
+
+#include "core/sql_lexer.h"
+
 QT_BEGIN_NAMESPACE
 class QTextDocument;
 QT_END_NAMESPACE
@@ -21,6 +26,16 @@ class SqlFormatter;
 // ============================================================================
 // SQL Syntax Highlighter
 // ============================================================================
+/**
+ * @brief Highlights SQL with one core::SqlLexer pass per block
+ *
+ * The lexer state at the end of each block (open block comment, string or
+ * quoted identifier) is stored as the block state and resumed by the next
+ * block, so constructs may span lines. QSyntaxHighlighter only re-runs
+ * highlightBlock() for edited blocks and keeps going while the stored
+ * state changes, so an edit costs its own lines unless it opens or closes
+ * a multi-line construct.
+ */
 class SqlSyntaxHighlighter : public QSyntaxHighlighter {
   Q_OBJECT
 
@@ -32,13 +47,13 @@ class SqlSyntaxHighlighter : public QSyntaxHighlighter {
   void highlightBlock(const QString& text) override;
 
  private:
-  void setupRules();
-  
-  struct HighlightingRule {
-    QRegularExpression pattern;
-    QTextCharFormat format;
-  };
-  QVector<HighlightingRule> rules_;
+  void setupFormats(const QString& scheme);
+  const QTextCharFormat* formatFor(core::SqlTokenKind kind) const;
+
+  core::SqlLexer lexer_;
+  // Reused between blocks to avoid an allocation per line
+  std::string blockText_;
+  std::vector<core::SqlToken> tokens_;
   
   QTextCharFormat keywordFormat_;
   QTextCharFormat stringFormat_;
@@ -0,0 +1,276 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/async_query_executor.h"
+
+using scratchrobin::backend::ConnectionInfo;
+using scratchrobin::core::AsyncQueryExecutor;
+using scratchrobin::core::AsyncQueryResult;
+using scratchrobin::core::Connection;
+using scratchrobin::core::QueryExecutionState;
+using scratchrobin::core::QueryPriority;
+using scratchrobin::core::QueryTaskId;
+using scratchrobin::core::ResultSet;
+
+namespace {
+
+std::shared_ptr<Connection> Connect() {
+  auto connection = std::make_shared<Connection>();
+  assert(connection->connect(ConnectionInfo{}));
+  return connection;
+}
+
+// Polls |done| for up to five seconds
+bool Eventually(const std::function<bool()>& done) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// Completion order, as seen by the callbacks on the workers
+struct Log {
+  std::mutex mutex;
+  std::vector<std::string> entries;
+
+  std::function<void(const AsyncQueryResult&)> Note(std::string name) {
+    return [this, name](const AsyncQueryResult& result) {
+      std::lock_guard<std::mutex> lock(mutex);
+      entries.push_back(result.status.ok ? name : name + ":" + result.status.message);
+    };
+  }
+  std::vector<std::string> Entries() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries;
+  }
+};
+
+// A streaming query of one row per batch that stops after its first
+// batch, holding its worker and connection until released
+QueryTaskId Hold(AsyncQueryExecutor& executor, std::shared_ptr<Connection> connection,
+                 std::atomic<int>* batches, AsyncQueryExecutor::CompletionCallback done = nullptr,
+                 QueryPriority priority = QueryPriority::kInteractive) {
+  const QueryTaskId id = executor.SubmitStreamingQuery(
+      "SELECT * FROM t", std::move(connection),
+      [batches](ResultSet&&, bool) { ++*batches; }, std::move(done), 1, priority, 1);
+  assert(id != scratchrobin::core::kInvalidQueryTaskId);
+  assert(Eventually([&] { return batches->load() == 1; }));
+  return id;
+}
+
+}  // namespace
+
+// Runs against the mock connection, which serves five rows for any SELECT
+int main() {
+  // Nothing runs before Initialize or after Shutdown
+  {
+    AsyncQueryExecutor executor;
+    assert(executor.SubmitQuery("SELECT 1", Connect()) == scratchrobin::core::kInvalidQueryTaskId);
+    assert(executor.Initialize(2) && !executor.Initialize(2));
+    executor.Shutdown();
+    assert(executor.SubmitQuery("SELECT 1", Connect()) == scratchrobin::core::kInvalidQueryTaskId);
+  }
+
+  // Results come back through GetResult when there is no callback
+  {
+    AsyncQueryExecutor executor;
+    executor.Initialize(2);
+    const QueryTaskId id = executor.SubmitQuery("SELECT * FROM t", Connect());
+    assert(executor.WaitForQuery(id));
+    assert(executor.GetQueryState(id) == QueryExecutionState::kCompleted);
+    const auto result = executor.GetResult(id);
+    assert(result && result->status.ok && result->result_set.RowCount() == 5);
+    assert(executor.GetCompletedCount() == 1);
+    assert(executor.GetQueryState(id + 100) == QueryExecutionState::kFailed);
+    assert(!executor.WaitForQuery(id + 100, 0));
+
+    const QueryTaskId orphan = executor.SubmitQuery("SELECT 1", nullptr);
+    assert(executor.WaitForQuery(orphan));
+    assert(executor.GetQueryState(orphan) == QueryExecutionState::kFailed);
+  }
+
+  // Streaming hands over every row in order and says when it is done
+  {
+    AsyncQueryExecutor executor;
+    executor.Initialize(2);
+    std::string ids;
+    std::vector<bool> more;
+    const QueryTaskId id = executor.SubmitStreamingQuery(
+        "SELECT * FROM t", Connect(),
+        [&](ResultSet&& batch, bool has_more) {
+          for (size_t row = 0; row < batch.RowCount(); ++row) {
+            ids += batch.rows.Column(0).Format(row);
+          }
+          more.push_back(has_more);
+        },
+        nullptr, 2);
+    assert(executor.WaitForQuery(id));
+    assert(ids == "12345");
+    assert((more == std::vector<bool>{true, true, false}));
+    const auto result = executor.GetResult(id);
+    assert(result && result->status.ok && result->rows_returned == 5);
+    assert(result->result_set.RowCount() == 0);
+  }
+
+  // Tasks on one connection run one at a time, in submission order, while
+  // other connections carry on
+  {
+    AsyncQueryExecutor executor;
+    executor.Initialize(4);
+    auto shared = Connect();
+    Log log;
+    std::atomic<int> batches{0};
+    const QueryTaskId held = Hold(executor, shared, &batches, log.Note("held"));
+
+    std::vector<QueryTaskId> queued;
+    for (int i = 0; i < 20; ++i) {
+      queued.push_back(executor.SubmitQuery("SELECT " + std::to_string(i), shared,
+                                            log.Note(std::to_string(i))));
+    }
+    executor.SubmitQuery("SELECT 1", Connect(), log.Note("other"));
+    assert(Eventually([&] { return log.Entries().size() == 1; }));
+    assert(executor.IsRunning(held) && executor.IsPending(queued.front()));
+    assert(executor.GetPendingCount() == 20 && executor.GetRunningCount() == 1);
+
+    assert(executor.RequestMoreRows(held, 4));
+    assert(executor.WaitForAll(5000));
+    const auto entries = log.Entries();
+    assert(entries.size() == 22 && entries[0] == "other" && entries[1] == "held");
+    for (int i = 0; i < 20; ++i) {
+      assert(entries[static_cast<size_t>(i) + 2] == std::to_string(i));
+    }
+    assert(batches == 5 && !executor.RequestMoreRows(held));
+  }
+
+  // Cancelling a queued task finishes it without running it; cancelling a
+  // running one closes its cursor
+  {
+    AsyncQueryExecutor executor;
+    executor.Initialize(2);
+    auto shared = Connect();
+    Log log;
+    std::atomic<int> batches{0};
+    const QueryTaskId held = Hold(executor, shared, &batches, log.Note("held"));
+    const QueryTaskId queued = executor.SubmitQuery("SELECT 1", shared, log.Note("queued"));
+    const QueryTaskId after = executor.SubmitQuery("SELECT 2", shared, log.Note("after"));
+
+    assert(executor.CancelQuery(queued));
+    assert(!executor.CancelQuery(queued));
+    assert(executor.GetQueryState(queued) == QueryExecutionState::kCancelled);
+    assert(executor.CancelQuery(held));
+    assert(executor.WaitForAll(5000));  // Callbacks run before a task counts as done
+    assert(!shared->hasOpenCursor());
+
+    const auto entries = log.Entries();
+    assert((entries == std::vector<std::string>{"held:Query cancelled", "queued:Query cancelled",
+                                                "after"}));
+    assert(batches == 1);
+    assert(!executor.CancelQuery(after));
+  }
+
+  // Interactive work goes first, and background work never takes the
+  // last free worker
+  {
+    AsyncQueryExecutor executor;
+    executor.Initialize(2);
+    Log log;
+    std::atomic<int> batches{0};
+    const QueryTaskId export_task =
+        Hold(executor, Connect(), &batches, log.Note("export"), QueryPriority::kBackground);
+    const QueryTaskId waiting = executor.SubmitQuery("SELECT 1", Connect(), log.Note("background"),
+                                                     QueryPriority::kBackground);
+    executor.SubmitQuery("SELECT 1", Connect(), log.Note("interactive"));
+    assert(Eventually([&] { return log.Entries().size() == 1; }));
+    assert(executor.IsPending(waiting));
+
+    // The held-back task starts once the first lets go of its worker
+    assert(executor.CancelQuery(export_task));
+    assert(executor.WaitForAll(5000));
+    const auto entries = log.Entries();
+    assert(entries.size() == 3 && entries[0] == "interactive");
+  }
+  {
+    // With one worker busy, queued interactive work overtakes older
+    // background work
+    AsyncQueryExecutor executor;
+    executor.Initialize(1);
+    Log log;
+    std::atomic<int> batches{0};
+    const QueryTaskId held = Hold(executor, Connect(), &batches, log.Note("held"));
+    executor.SubmitQuery("SELECT 1", Connect(), log.Note("background"), QueryPriority::kBackground);
+    executor.SubmitQuery("SELECT 1", Connect(), log.Note("interactive"));
+    executor.RequestMoreRows(held, 4);
+    assert(executor.WaitForAll(5000));
+    assert((log.Entries() == std::vector<std::string>{"held", "interactive", "background"}));
+  }
+
+  // WaitForAll times out while work is outstanding
+  {
+    AsyncQueryExecutor executor;
+    executor.Initialize(2);
+    std::atomic<int> batches{0};
+    const QueryTaskId held = Hold(executor, Connect(), &batches);
+    assert(!executor.WaitForAll(20));
+    assert(!executor.WaitForQuery(held, 20));
+    executor.CancelAllQueries();
+    assert(executor.WaitForAll(5000));
+    assert(executor.GetQueryState(held) == QueryExecutionState::kCancelled);
+  }
+
+  // Finished tasks are reclaimed: at once with a callback, past the
+  // retention limit without one
+  {
+    AsyncQueryExecutor executor;
+    executor.Initialize(2);
+    std::atomic<int> called{0};
+    const QueryTaskId with_callback = executor.SubmitQuery(
+        "SELECT 1", Connect(), [&called](const AsyncQueryResult&) { ++called; });
+    assert(executor.WaitForQuery(with_callback));
+    assert(executor.WaitForAll(5000) && called == 1);
+    assert(!executor.GetResult(with_callback));
+    assert(executor.GetQueryState(with_callback) == QueryExecutionState::kCompleted);
+
+    executor.SetResultRetention(2);
+    auto shared = Connect();
+    std::vector<QueryTaskId> ids;
+    for (int i = 0; i < 4; ++i) {
+      ids.push_back(executor.SubmitQuery("SELECT 1", shared));
+    }
+    assert(executor.WaitForAll(5000));
+    assert(!executor.GetResult(ids[0]) && !executor.GetResult(ids[1]));
+    assert(executor.GetResult(ids[2]) && executor.GetResult(ids[3]));
+    executor.ClearCompletedTasks();
+    assert(!executor.GetResult(ids[3]));
+    assert(executor.WaitForQuery(ids[3]));  // Reclaimed still counts as finished
+  }
+
+  // Shutdown releases a waiting stream and finishes queued work as cancelled
+  {
+    AsyncQueryExecutor executor;
+    executor.Initialize(1);
+    auto shared = Connect();
+    Log log;
+    std::atomic<int> batches{0};
+    const QueryTaskId held = Hold(executor, shared, &batches, log.Note("held"));
+    const QueryTaskId queued = executor.SubmitQuery("SELECT 1", shared);
+    executor.Shutdown();
+    assert(executor.WaitForQuery(held, 0) && executor.WaitForQuery(queued, 0));
+    assert(executor.GetQueryState(queued) == QueryExecutionState::kCancelled);
+    assert(executor.GetResult(queued)->status.message == "Query cancelled");
+    assert((log.Entries() == std::vector<std::string>{"held:Query cancelled"}));
+    assert(!shared->hasOpenCursor());
+  }
+
+  return 0;
+}
@@ -1,11 +1,61 @@
 #include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <set>
+#include <vector>
 
 #include "backend/native_adapter_gateway.h"
 #include "backend/native_parser_compiler.h"
 #include "backend/parser_port_registry.h"
+#include "backend/prepared_statement_cache.h"
+#include "backend/query_router.h"
 #include "backend/session_client.h"
 #include "backend/server_session_gateway.h"
+#include "core/connection_pool_manager.h"
+#include "core/sql_utils.h"
+
+namespace {
+
+using scratchrobin::backend::PreparedStatementSession;
+using scratchrobin::backend::QueryParameter;
+using scratchrobin::backend::QueryResponse;
+
+// Counts the server round trips; Reconnect() makes every open handle stale
+class FakeStatementSession : public PreparedStatementSession {
+ public:
+  QueryResponse Prepare(const std::string&, Handle* handle) override {
+    ++prepares;
+    *handle = next_handle_++;
+    live_.insert(*handle);
+    return QueryResponse{scratchrobin::core::Status::Ok(), {}, "fake::prepare"};
+  }
+
+  QueryResponse ExecutePrepared(Handle handle, const std::vector<QueryParameter>&) override {
+    ++executions;
+    if (!live_.count(handle) || always_stale) {
+      return QueryResponse{scratchrobin::core::Status::Error("stale"), {}, "sbwp::stale_statement"};
+    }
+    return QueryResponse{scratchrobin::core::Status::Ok(), {}, "fake::execute"};
+  }
+
+  void ClosePrepared(Handle handle) override {
+    closed.push_back(handle);
+    live_.erase(handle);
+  }
+
+  void Reconnect() { live_.clear(); }
+
+  int prepares = 0;
+  int executions = 0;
+  bool always_stale = false;
+  std::vector<Handle> closed;
+
+ private:
+  Handle next_handle_ = 1;
+  std::set<Handle> live_;
+};
+
+}  // namespace
 
 int main() {
   scratchrobin::backend::ParserPortRegistry registry;
@@ -46,5 +96,111 @@ int main() {
     assert(!missing_port.status.ok);
   }
 
+  {
+    // Repeated statements are served from the SBLR compile cache; DDL bypasses
+    // it and invalidates what was cached
+    scratchrobin::backend::NativeParserCompiler cached_compiler;
+    auto first = cached_compiler.CompileSqlToSblr("select 1", config, "scratchbird-native");
+    auto second = cached_compiler.CompileSqlToSblr("SELECT  1;", config, "scratchbird-native");
+    assert(first.bytecode.metadata["cache"] == "miss");
+    assert(second.bytecode.metadata["cache"] == "hit");
+    assert(second.bytecode.metadata["cache_hits"] == "1");
+    assert(first.bytecode.body == second.bytecode.body);
+    // Another server, or the same one after an upgrade, compiles afresh
+    auto other_server = config;
+    other_server.port = 4045;
+    assert(cached_compiler.CompileSqlToSblr("select 1", other_server, "scratchbird-native")
+               .bytecode.metadata["cache"] == "miss");
+    auto upgraded = config;
+    upgraded.server_version = "2.1";
+    assert(cached_compiler.CompileSqlToSblr("select 1", upgraded, "scratchbird-native")
+               .bytecode.metadata["cache"] == "miss");
+    auto ddl = cached_compiler.CompileSqlToSblr("create table t (a int)", config, "scratchbird-native");
+    assert(ddl.bytecode.metadata["cache"] == "bypass");
+    assert(cached_compiler.CompileCache()->GetStats().entries == 0);
+  }
+
+  {
+    using scratchrobin::core::normalizeStatementText;
+    assert(normalizeStatementText("select *\n  from t -- all\n;") == "SELECT * FROM T");
+    assert(normalizeStatementText("SELECT 'a  b' FROM \"Mixed\"") == "SELECT 'a  b' FROM \"Mixed\"");
+    assert(normalizeStatementText("select/*c*/1") == normalizeStatementText("SELECT 1"));
+  }
+
+  {
+    scratchrobin::backend::PreparedStatementCache cache(2);
+    assert(cache.insert("A", 1).empty());
+    assert(cache.insert("B", 2).empty());
+    assert(cache.find("A") == 1u);  // A becomes most recent
+    const auto evicted = cache.insert("C", 3);
+    assert(evicted.size() == 1 && evicted[0] == 2u);
+    assert(!cache.find("B"));
+    assert(cache.erase("A") == 1u);
+    assert(cache.clear().size() == 1);
+    assert(cache.size() == 0);
+  }
+
+  {
+    // The router prepares each statement once, evicts the least recently
+    // used handle, and re-prepares a stale handle exactly once
+    FakeStatementSession fake;
+    scratchrobin::backend::QueryRouter router;
+    router.setStatementSession(&fake);
+    router.setStatementCacheCapacity(2);
+    const std::vector<QueryParameter> params{QueryParameter(std::int64_t{7})};
+
+    assert(router.execute("SELECT * FROM a WHERE id = ?", params).status.ok);
+    assert(router.execute("select *  from a where id = ?", params).status.ok);
+    assert(fake.prepares == 1 && fake.executions == 2);
+    assert(router.statistics().statement_cache_hits == 1);
+
+    assert(router.execute("SELECT * FROM b WHERE id = ?", params).status.ok);
+    assert(router.execute("SELECT * FROM c WHERE id = ?", params).status.ok);
+    assert(fake.prepares == 3);
+    assert(fake.closed == std::vector<PreparedStatementSession::Handle>{1});
+    assert(router.statementCacheSize() == 2);
+
+    fake.Reconnect();
+    const auto retried = router.execute("SELECT * FROM c WHERE id = ?", params);
+    assert(retried.status.ok && retried.execution_path == "fake::execute");
+    assert(fake.prepares == 4);
+    assert(fake.closed.size() == 2 && fake.closed[1] == 3u);
+
+    fake.always_stale = true;
+    const auto failed = router.execute("SELECT * FROM b WHERE id = ?", params);
+    assert(!failed.status.ok);
+    assert(failed.execution_path == "query_router::prepare_retry_failed");
+    assert(fake.prepares == 5);  // The cached handle, then one fresh prepare
+
+    router.setStatementSession(nullptr);
+    assert(router.statementCacheSize() == 0);
+  }
+
+  {
+    // Pool warm-up, FIFO hand-off on release and acquire timeout
+    scratchrobin::core::ConnectionPoolManager pools;
+    scratchrobin::core::PoolConfig pool_config;
+    pool_config.pool_id = "contract";
+    pool_config.min_connections = 2;
+    pool_config.max_connections = 2;
+    pool_config.retry_attempts = 1;
+    assert(pools.CreatePool(pool_config).ok);
+    assert(pools.GetStats("contract").idle_connections == 2);
+    auto a = pools.AcquireConnection("contract");
+    auto b = pools.AcquireConnection("contract");
+    assert(a && b && a->connection && a->connection_id != b->connection_id);
+    assert(!pools.AcquireConnection("contract", 10));
+    assert(pools.ReleaseConnection(*a).ok);
+    auto c = pools.AcquireConnection("contract", 0);
+    assert(c && c->use_count == 1);
+    assert(pools.InvalidateConnection(*b).ok);
+    const auto stats = pools.GetStats("contract");
+    assert(stats.total_connections == 1 && stats.active_connections == 1);
+    assert(stats.timed_out_requests == 1);
+    assert(stats.wait_time_histogram.count == 3);
+    assert(pools.DestroyPool("contract").ok);
+    assert(!pools.ReleaseConnection(*c).ok);
+  }
+
   return 0;
 }
@@ -0,0 +1,262 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "backend/bulk_load_pipeline.h"
+
+using scratchrobin::backend::BulkLoadPipeline;
+using scratchrobin::backend::BulkLoadSession;
+using scratchrobin::core::ResultSet;
+using scratchrobin::core::Status;
+
+namespace {
+
+// What the fake server saw; shared with the test after the pipeline
+// takes ownership of the session
+struct Server {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool open = true;           // Statements wait while false
+  bool drop_on_error = false;  // A failed statement drops the connection
+  bool connected = true;
+  std::vector<std::string> executed;
+  int64_t rows_inserted = 0;
+  int started = 0;  // Statements that reached Execute
+  int begins = 0;
+  int commits = 0;
+  int rollbacks = 0;
+  int cancels = 0;
+};
+
+class FakeSession : public BulkLoadSession {
+ public:
+  explicit FakeSession(std::shared_ptr<Server> server) : server_(std::move(server)) {}
+
+  Status Execute(const std::string& sql) override {
+    std::unique_lock<std::mutex> lock(server_->mutex);
+    ++server_->started;
+    server_->cv.notify_all();
+    server_->cv.wait(lock, [&] { return server_->open; });
+    server_->executed.push_back(sql);
+    if (sql.find("'bad'") != std::string::npos) {
+      if (server_->drop_on_error) {
+        server_->connected = false;
+      }
+      return Status::Error("bad value");
+    }
+    if (sql.rfind("INSERT", 0) == 0) {
+      int64_t tuples = 1;
+      for (std::size_t at = sql.find("), ("); at != std::string::npos; at = sql.find("), (", at + 1)) {
+        ++tuples;
+      }
+      server_->rows_inserted += tuples;
+    }
+    return Status::Ok();
+  }
+  Status BeginTransaction() override {
+    std::lock_guard<std::mutex> lock(server_->mutex);
+    ++server_->begins;
+    return Status::Ok();
+  }
+  Status Commit() override {
+    std::lock_guard<std::mutex> lock(server_->mutex);
+    ++server_->commits;
+    return Status::Ok();
+  }
+  void Rollback() override {
+    std::lock_guard<std::mutex> lock(server_->mutex);
+    ++server_->rollbacks;
+  }
+  void Cancel() override {
+    std::lock_guard<std::mutex> lock(server_->mutex);
+    ++server_->cancels;
+  }
+  bool IsConnected() const override {
+    std::lock_guard<std::mutex> lock(server_->mutex);
+    return server_->connected;
+  }
+
+ private:
+  std::shared_ptr<Server> server_;
+};
+
+BulkLoadPipeline::Options Options(std::size_t rows_per_statement) {
+  BulkLoadPipeline::Options options;
+  options.table = "t";
+  options.columns = {{"id", 0, std::nullopt}, {"name", 1, std::nullopt}};
+  options.max_rows_per_statement = rows_per_statement;
+  return options;
+}
+
+// Rows 0..count-1; the rows in |bad| carry a value the server rejects
+ResultSet Rows(int count, const std::vector<int>& bad = {}) {
+  ResultSet rows;
+  rows.columns = {"id", "name"};
+  rows.rows.SetColumnCount(2);
+  for (int i = 0; i < count; ++i) {
+    bool rejected = false;
+    for (int b : bad) rejected = rejected || b == i;
+    rows.rows.Column(0).AppendText(std::to_string(i));
+    rows.rows.Column(1).AppendText(rejected ? "bad" : "r" + std::to_string(i));
+    rows.rows.EndRow();
+  }
+  return rows;
+}
+
+}  // namespace
+
+int main() {
+  // Rows are packed into multi-row INSERTs and committed once
+  {
+    auto server = std::make_shared<Server>();
+    BulkLoadPipeline pipeline(std::make_unique<FakeSession>(server), Options(4));
+    assert(pipeline.Start().ok);
+    assert(pipeline.Add(Rows(10), 0).ok);
+    BulkLoadPipeline::Report report;
+    assert(pipeline.Finish(&report).ok);
+    assert(report.rows_loaded == 10 && report.rows_failed == 0 && report.statements == 3);
+    assert(server->executed.size() == 3 && server->rows_inserted == 10);
+    assert(server->executed[0] ==
+           "INSERT INTO t (id, name) VALUES (0, 'r0'), (1, 'r1'), (2, 'r2'), (3, 'r3')");
+    assert(server->begins == 1 && server->commits == 1 && server->rollbacks == 0);
+  }
+
+  // A rejected statement is bisected until the bad rows stand alone; the
+  // rest still load
+  {
+    auto server = std::make_shared<Server>();
+    BulkLoadPipeline pipeline(std::make_unique<FakeSession>(server), Options(100));
+    assert(pipeline.Start().ok);
+    assert(pipeline.Add(Rows(100, {17, 63}), 1000).ok);
+    BulkLoadPipeline::Report report;
+    assert(pipeline.Finish(&report).ok);
+    assert(report.rows_loaded == 98 && report.rows_failed == 2);
+    assert(report.errors.size() == 2);
+    assert(report.errors[0].row == 1017 && report.errors[1].row == 1063);
+    assert(report.errors[0].message == "bad value");
+    assert(server->rows_inserted == 98);
+    assert(report.statements <= 1 + 2 * 2 * 7);  // ~2*log2(rows) per bad row
+    assert(server->commits == 1);
+  }
+
+  // stop_on_error fails the load on the first rejected statement and
+  // rolls it back
+  {
+    auto server = std::make_shared<Server>();
+    auto options = Options(5);
+    options.stop_on_error = true;
+    BulkLoadPipeline pipeline(std::make_unique<FakeSession>(server), options);
+    assert(pipeline.Start().ok);
+    pipeline.Add(Rows(10, {7}), 0);
+    const Status status = pipeline.Finish(nullptr);
+    assert(!status.ok && status.message == "Rows 5-9: bad value");
+    assert(server->commits == 0 && server->rollbacks == 1);
+  }
+
+  // A lost connection fails the load instead of bisecting
+  {
+    auto server = std::make_shared<Server>();
+    server->drop_on_error = true;
+    BulkLoadPipeline pipeline(std::make_unique<FakeSession>(server), Options(8));
+    assert(pipeline.Start().ok);
+    pipeline.Add(Rows(8, {3}), 0);
+    const Status status = pipeline.Finish(nullptr);
+    assert(!status.ok && status.message == "Connection lost during bulk load: bad value");
+    assert(server->executed.size() == 1);
+  }
+
+  // Periodic commits, and setup_sql first inside the transaction
+  {
+    auto server = std::make_shared<Server>();
+    auto options = Options(2);
+    options.commit_every_rows = 4;
+    options.setup_sql = "DELETE FROM t";
+    BulkLoadPipeline pipeline(std::make_unique<FakeSession>(server), options);
+    assert(pipeline.Start().ok);
+    assert(pipeline.Add(Rows(10), 0).ok);
+    assert(pipeline.Finish(nullptr).ok);
+    assert(server->executed.front() == "DELETE FROM t");
+    assert(server->commits == 3 && server->begins == 3);
+  }
+
+  // A slow server holds the converter back: at most queue_depth
+  // statements wait behind the one running
+  {
+    auto server = std::make_shared<Server>();
+    server->open = false;
+    auto options = Options(1);
+    options.queue_depth = 2;
+    BulkLoadPipeline pipeline(std::make_unique<FakeSession>(server), options);
+    assert(pipeline.Start().ok);
+
+    std::atomic<bool> added{false};
+    std::thread producer([&] {
+      assert(pipeline.Add(Rows(10), 0).ok);
+      added = true;
+    });
+    {
+      std::unique_lock<std::mutex> lock(server->mutex);
+      assert(server->cv.wait_for(lock, std::chrono::seconds(5), [&] { return server->started == 1; }));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(!added);
+    {
+      std::lock_guard<std::mutex> lock(server->mutex);
+      assert(server->started == 1);
+      server->open = true;
+    }
+    server->cv.notify_all();
+    producer.join();
+    BulkLoadPipeline::Report report;
+    assert(pipeline.Finish(&report).ok);
+    assert(report.rows_loaded == 10 && server->rows_inserted == 10);
+  }
+
+  // Abort drops what is queued, interrupts the server and rolls back
+  {
+    auto server = std::make_shared<Server>();
+    server->open = false;
+    auto options = Options(1);
+    options.queue_depth = 8;
+    BulkLoadPipeline pipeline(std::make_unique<FakeSession>(server), options);
+    assert(pipeline.Start().ok);
+    assert(pipeline.Add(Rows(5), 0).ok);
+    {
+      std::unique_lock<std::mutex> lock(server->mutex);
+      server->cv.wait(lock, [&] { return server->started == 1; });
+    }
+    std::thread release([&] {
+      // The fake only returns once opened; a real server returns on cancel
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      {
+        std::lock_guard<std::mutex> lock(server->mutex);
+        server->open = true;
+      }
+      server->cv.notify_all();
+    });
+    pipeline.Abort();
+    release.join();
+    assert(server->cancels == 1 && server->rollbacks == 1 && server->commits == 0);
+    assert(server->executed.size() == 1);
+  }
+
+  // A failing setup statement rolls back and reports the error
+  {
+    auto server = std::make_shared<Server>();
+    auto options = Options(1);
+    options.setup_sql = "DELETE FROM 'bad'";
+    BulkLoadPipeline pipeline(std::make_unique<FakeSession>(server), options);
+    const Status status = pipeline.Start();
+    assert(!status.ok && status.message == "Bulk load setup failed: bad value");
+    assert(server->rollbacks == 1);
+  }
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "core/catalog_cache.h"
+
+using scratchrobin::core::CatalogCache;
+using scratchrobin::core::CatalogTableDetails;
+using scratchrobin::core::CatalogTableStamp;
+using scratchrobin::core::ColumnInfo;
+using scratchrobin::core::IndexInfo;
+
+namespace {
+
+CatalogTableStamp Listing(const std::string& schema, const std::string& name,
+                          const std::string& stamp) {
+  CatalogTableStamp table;
+  table.schema = schema;
+  table.name = name;
+  table.object_id = schema + "." + name;
+  table.table_type = "HEAP";
+  table.stamp = stamp;
+  return table;
+}
+
+// Stores one column and one index for |table| at its current version.
+void Fill(CatalogCache& cache, const std::string& schema, const std::string& table) {
+  std::uint64_t version = 0;
+  assert(cache.Find(schema, table, &version));
+  CatalogTableDetails details;
+  details.columns.emplace_back("id", "INTEGER", false);
+  details.indexes.emplace_back(table + "_pk", table, schema);
+  details.indexes.back().is_unique = true;
+  cache.StoreDetails(schema, table, version, details);
+  assert(cache.Details(schema, table));
+}
+
+}  // namespace
+
+int main() {
+  // Refresh keeps details of unchanged tables and drops the rest
+  {
+    CatalogCache cache;
+    assert(cache.ListingStale());
+    assert(cache.ApplyListing({Listing("public", "a", "1:0:0"), Listing("public", "b", "1:0:0"),
+                               Listing("sales", "c", "1:0:0")}) == 3);
+    assert(!cache.ListingStale());
+    assert((cache.Schemas() == std::vector<std::string>{"public", "sales"}));
+    assert(cache.Tables("public").size() == 2);
+    assert(cache.Tables().size() == 3);
+    Fill(cache, "public", "a");
+    Fill(cache, "public", "b");
+    const auto listing_version = cache.ListingVersion();
+
+    assert(cache.ApplyListing({Listing("public", "a", "1:0:0"), Listing("public", "b", "2:0:0"),
+                               Listing("sales", "d", "1:0:0")}) == 2);
+    assert(cache.ListingVersion() != listing_version);
+    assert(cache.Details("public", "a"));
+    assert(!cache.Details("public", "b"));
+    assert(!cache.Find("sales", "c"));
+    assert(cache.Tables("public")[0].columns.size() == 1);
+  }
+
+  // Uncached lists what a prefetch still has to fetch
+  {
+    CatalogCache cache;
+    cache.ApplyListing({Listing("public", "a", "1"), Listing("public", "b", "1"),
+                        Listing("sales", "c", "1")});
+    Fill(cache, "public", "a");
+    auto uncached = cache.Uncached("public");
+    assert(uncached.size() == 1 && uncached[0].first.name == "b");
+    assert(cache.Uncached("").size() == 2);
+    assert(cache.Uncached("public", {"a", "missing"}).empty());
+    cache.StoreDetails("public", "b", uncached[0].second, CatalogTableDetails{});
+    assert(cache.Uncached("public").empty());
+  }
+
+  // Details fetched before an invalidation are not stored
+  {
+    CatalogCache cache;
+    cache.ApplyListing({Listing("public", "a", "1")});
+    std::uint64_t version = 0;
+    cache.Find("public", "a", &version);
+    cache.Invalidate("public", "a");
+    cache.StoreDetails("public", "a", version, CatalogTableDetails{});
+    assert(!cache.Details("public", "a"));
+  }
+
+  // DDL drops what it may have changed
+  {
+    CatalogCache cache;
+    cache.ApplyListing({Listing("public", "orders", "1"), Listing("public", "Items", "1"),
+                        Listing("sales", "orders", "1")});
+    auto fill_all = [&] {
+      Fill(cache, "public", "orders");
+      Fill(cache, "public", "Items");
+      Fill(cache, "sales", "orders");
+    };
+
+    fill_all();
+    cache.InvalidateForStatement("ALTER TABLE public.Orders ADD COLUMN note TEXT");
+    assert(!cache.Details("public", "orders"));
+    assert(cache.Details("sales", "orders") && cache.Details("public", "Items"));
+    assert(!cache.ListingStale());
+
+    fill_all();
+    cache.InvalidateForStatement("-- add\nCREATE UNIQUE INDEX ix ON \"Items\" (id)");
+    assert(!cache.Details("public", "Items"));
+    assert(cache.Details("public", "orders"));
+
+    fill_all();
+    cache.InvalidateForStatement("drop index if exists sales.orders_pk");
+    assert(!cache.Details("sales", "orders"));
+    assert(cache.Details("public", "orders"));
+
+    fill_all();
+    cache.InvalidateForStatement("TRUNCATE TABLE orders");
+    assert(cache.Details("public", "orders") && !cache.ListingStale());
+
+    // Queries and DML change rows, not structure
+    for (const char* sql : {"SELECT * FROM t", "SELECT a FROM public.orders",
+                            "INSERT INTO orders VALUES (1)", "UPDATE \"Items\" SET id = 2",
+                            "WITH x AS (SELECT 1) DELETE FROM orders"}) {
+      cache.InvalidateForStatement(sql);
+      assert(cache.Details("public", "orders") && cache.Details("sales", "orders") &&
+             cache.Details("public", "Items"));
+      assert(!cache.ListingStale());
+    }
+
+    cache.InvalidateForStatement("ALTER TABLE orders RENAME TO orders_old");
+    assert(!cache.Details("public", "orders") && !cache.Details("sales", "orders"));
+    assert(cache.ListingStale());
+
+    cache.ApplyListing({Listing("public", "orders", "1"), Listing("public", "Items", "1"),
+                        Listing("sales", "orders", "1")});
+    fill_all();
+    cache.InvalidateForStatement("ALTER DOMAIN money_t SET DEFAULT 0");
+    assert(!cache.Details("public", "orders") && !cache.Details("public", "Items"));
+    assert(cache.ListingStale());
+  }
+
+  // Snapshots round-trip and load with a stale listing
+  {
+    const std::string path = "catalog_cache_tests.catalog";
+    CatalogCache cache;
+    cache.ApplyListing({Listing("public", "a", "1"), Listing("public", "b", "1")});
+    Fill(cache, "public", "a");
+    assert(cache.SaveToFile(path).ok);
+
+    CatalogCache loaded;
+    assert(loaded.LoadFromFile(path).ok);
+    assert(loaded.ListingStale());
+    auto details = loaded.Details("public", "a");
+    assert(details && details->columns.size() == 1 && details->columns[0].name == "id");
+    assert(details->indexes.size() == 1 && details->indexes[0].is_unique);
+    assert(details->indexes[0].table_name == "a");
+    assert(!loaded.Details("public", "b"));
+
+    // The same stamps keep the loaded details
+    assert(loaded.ApplyListing({Listing("public", "a", "1"), Listing("public", "b", "1")}) == 0);
+    assert(loaded.Details("public", "a"));
+
+    std::FILE* file = std::fopen(path.c_str(), "r+b");
+    std::fputs("garbage", file);
+    std::fclose(file);
+    assert(!loaded.LoadFromFile(path).ok);
+    assert(loaded.Details("public", "a"));
+    std::remove(path.c_str());
+  }
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "core/completion_index.h"
+
+using scratchrobin::core::CompletionEntry;
+using scratchrobin::core::CompletionIndex;
+using scratchrobin::core::CompletionKind;
+using scratchrobin::core::CompletionKindBit;
+using scratchrobin::core::CompletionMatch;
+using scratchrobin::core::CompletionQuery;
+
+namespace {
+
+CompletionEntry Entry(const std::string& text, CompletionKind kind, int priority = 0,
+                      const std::string& group = "") {
+  CompletionEntry entry;
+  entry.text = text;
+  entry.kind = kind;
+  entry.priority = priority;
+  entry.group = group;
+  return entry;
+}
+
+std::vector<std::string> Texts(const std::vector<CompletionMatch>& matches) {
+  std::vector<std::string> texts;
+  for (const auto& match : matches) {
+    texts.push_back(match.entry->text);
+  }
+  return texts;
+}
+
+CompletionQuery Query(const std::string& pattern, std::size_t limit = 50) {
+  CompletionQuery query;
+  query.pattern = pattern;
+  query.limit = limit;
+  return query;
+}
+
+}  // namespace
+
+int main() {
+  // Tiers rank exact, prefix, word start, contains, then subsequence
+  {
+    CompletionIndex index;
+    for (const char* text : {"ORDER", "orders", "order_items", "sales_order", "reorder",
+                             "o_r_d"}) {
+      index.Add(Entry(text, CompletionKind::kTable));
+    }
+    index.Add(Entry("ORDER", CompletionKind::kKeyword, 100));
+    auto texts = Texts(index.Search(Query("order")));
+    assert((texts == std::vector<std::string>{"ORDER", "ORDER", "orders", "order_items",
+                                              "sales_order", "reorder"}));
+    // Priority breaks the exact-match tie
+    assert(index.Search(Query("order"))[0].entry->kind == CompletionKind::kKeyword);
+
+    texts = Texts(index.Search(Query("ord")));
+    assert(texts.back() == "o_r_d" || texts.back() == "reorder");
+    assert(Texts(index.Search(Query("ord", 1))) == std::vector<std::string>{"ORDER"});
+
+    CompletionQuery strict = Query("ord");
+    strict.fuzzy = false;
+    for (const auto& text : Texts(index.Search(strict))) {
+      assert(text != "o_r_d");
+    }
+  }
+
+  // Kinds and column groups filter; groups replace incrementally
+  {
+    CompletionIndex index;
+    index.Add(Entry("user_id", CompletionKind::kColumn, 85, "orders"));
+    index.ReplaceGroup("users", {Entry("id", CompletionKind::kColumn, 85),
+                                 Entry("user_name", CompletionKind::kColumn, 85)});
+    index.Add(Entry("users", CompletionKind::kTable, 80));
+    assert(index.size() == 4 && index.HasGroup("users"));
+
+    CompletionQuery query = Query("us");
+    assert(Texts(index.Search(query)) == std::vector<std::string>{"users"});
+    query.column_groups = {"users"};
+    assert((Texts(index.Search(query)) == std::vector<std::string>{"users", "user_name"}));
+    query.kinds = CompletionKindBit(CompletionKind::kColumn);
+    query.column_groups = {"orders", "users"};
+    assert((Texts(index.Search(query)) == std::vector<std::string>{"user_id", "user_name"}));
+
+    index.ReplaceGroup("users", {Entry("email", CompletionKind::kColumn, 85)});
+    assert(Texts(index.Search(query)) == std::vector<std::string>{"user_id"});
+    index.RemoveGroup("orders");
+    assert(index.Search(query).empty() && index.size() == 2);
+  }
+
+  // Large catalogs stay correct through compaction and answer quickly
+  {
+    CompletionIndex index;
+    for (int t = 0; t < 2000; ++t) {
+      const std::string table = "table_" + std::to_string(t);
+      index.Add(Entry(table, CompletionKind::kTable, 80));
+      std::vector<CompletionEntry> columns;
+      for (int c = 0; c < 100; ++c) {
+        columns.push_back(Entry("col_" + std::to_string(c) + "_of_" + std::to_string(t),
+                                CompletionKind::kColumn, 85));
+      }
+      index.ReplaceGroup(table, std::move(columns));
+    }
+    assert(index.size() == 2000 + 200000);
+    for (int t = 0; t < 1500; ++t) {
+      index.RemoveGroup("table_" + std::to_string(t));
+    }
+    assert(index.size() == 2000 + 50000);
+
+    CompletionQuery query = Query("of_1999");
+    query.column_groups = {"table_1999"};
+    auto matches = index.Search(query);
+    assert(matches.size() == 50 && matches[0].entry->group == "table_1999");
+
+    const auto start = std::chrono::steady_clock::now();
+    for (const char* pattern : {"t", "table_1", "col_9", "_of_17", "tbl1"}) {
+      CompletionQuery timed = Query(pattern);
+      timed.column_groups = {"table_1700", "table_1800"};
+      assert(!index.Search(timed).empty());
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    (void)elapsed;  // Informational; timing is not asserted on shared CI machines
+  }
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "core/csv_chunk_parser.h"
+#include "core/streaming_data_importer.h"
+
+using scratchrobin::core::CSVOptions;
+using scratchrobin::core::ImportConfig;
+using scratchrobin::core::ResultSet;
+using scratchrobin::core::Status;
+using scratchrobin::core::StreamingDataImporter;
+
+namespace {
+
+std::string WriteTemp(const std::string& name, const std::string& contents) {
+  const std::string path = "csv_import_tests_" + name + ".csv";
+  std::ofstream(path, std::ios::binary) << contents;
+  return path;
+}
+
+// Streams |path| and returns every row as formatted strings ("<NULL>" for NULL)
+std::vector<std::vector<std::string>> Load(const std::string& path, const CSVOptions& options,
+                                           int64_t chunk_bytes, int parallelism,
+                                           scratchrobin::core::ImportResult* result = nullptr) {
+  ImportConfig config;
+  config.import_id = path + std::to_string(chunk_bytes);
+  config.source_path = path;
+  config.csv_options = options;
+  config.chunk_size_bytes = chunk_bytes;
+  config.parallelism = parallelism;
+
+  std::vector<std::vector<std::string>> rows;
+  StreamingDataImporter importer;
+  importer.StreamImport(
+      config,
+      [&rows](const ResultSet& batch, int64_t first_row) {
+        assert(first_row == static_cast<int64_t>(rows.size()) + 1);
+        for (size_t r = 0; r < batch.RowCount(); ++r) {
+          std::vector<std::string> row;
+          for (size_t c = 0; c < batch.ColumnCount(); ++c) {
+            row.push_back(batch.Column(c).IsNull(r) ? "<NULL>" : batch.Column(c).Format(r));
+          }
+          rows.push_back(row);
+        }
+        return Status::Ok();
+      },
+      [result](const scratchrobin::core::ImportResult& done) {
+        if (result) {
+          *result = done;
+        }
+      });
+  return rows;
+}
+
+}  // namespace
+
+int main() {
+  // Chunk boundaries inside quoted fields, doubled quotes and CRLF must not
+  // change the parse, whatever the chunk size
+  {
+    std::string csv = "id,name,note\r\n";
+    for (int i = 0; i < 200; ++i) {
+      csv += std::to_string(i) + ",\"name, " + std::to_string(i) + "\",\"line\nbreak \"\"q\"\"\"\r\n";
+      csv += std::to_string(i) + ",plain,\r\n";
+    }
+    const std::string path = WriteTemp("quoted", csv);
+    const auto expected = Load(path, CSVOptions{}, 0, 1);
+    assert(expected.size() == 400);
+    assert(expected[0][1] == "name, 0");
+    assert(expected[0][2] == "line\nbreak \"q\"");
+    assert(expected[1][2] == "<NULL>");
+    for (int64_t chunk : {1, 3, 7, 16, 64, 1000}) {
+      assert(Load(path, CSVOptions{}, chunk, 4) == expected);
+    }
+    std::remove(path.c_str());
+  }
+
+  // Backslash escapes inside quotes, including an escaped quote that straddles
+  // a chunk boundary
+  {
+    CSVOptions options;
+    options.escape = '\\';
+    options.has_header = false;
+    std::string csv;
+    for (int i = 0; i < 50; ++i) {
+      csv += "\"a\\\"b\\\\\",\"x\ny\"\n";
+    }
+    const std::string path = WriteTemp("escaped", csv);
+    const auto expected = Load(path, options, 0, 1);
+    assert(expected.size() == 50);
+    assert(expected[0][0] == "a\"b\\");
+    for (int64_t chunk : {1, 2, 5, 11}) {
+      assert(Load(path, options, chunk, 3) == expected);
+    }
+    std::remove(path.c_str());
+  }
+
+  // Malformed rows are reported with their row number and skipped
+  {
+    const std::string path = WriteTemp("errors", "a,b\n1,2\n3\n4,5\n");
+    scratchrobin::core::ImportResult result;
+    const auto rows = Load(path, CSVOptions{}, 4, 2, &result);
+    assert(rows.size() == 2);
+    assert(result.total_rows_failed == 1);
+    assert(result.errors.size() == 1 && result.errors[0].rfind("Row 2:", 0) == 0);
+    std::remove(path.c_str());
+  }
+
+  // Single-byte encodings come out as UTF-8; a UTF-8 byte order mark is
+  // not part of the first header
+  {
+    const std::string path = WriteTemp("latin1", "name,sign\ncaf\xE9,\x80\n");
+    CSVOptions options;
+    options.encoding = "iso-8859-1";
+    auto rows = Load(path, options, 4, 2);
+    assert(rows.size() == 1 && rows[0][0] == "caf\xC3\xA9" && rows[0][1] == "\xC2\x80");
+    options.encoding = "Windows-1252";
+    rows = Load(path, options, 1024, 1);
+    assert(rows.size() == 1 && rows[0][1] == "\xE2\x82\xAC");
+
+    const std::string bom = WriteTemp("bom", "\xEF\xBB\xBFid\n7\n");
+    ResultSet sample;
+    StreamingDataImporter importer;
+    assert(importer.PreviewData(bom, scratchrobin::core::ImportFormat::kCSV, 10, &sample).ok);
+    assert(sample.columns.size() == 1 && sample.columns[0] == "id");
+    assert(sample.RowCount() == 1 && sample.rows.Column(0).Format(0) == "7");
+    std::remove(bom.c_str());
+
+    options.encoding = "UTF-16";
+    scratchrobin::core::ImportResult result;
+    assert(Load(path, options, 4, 1, &result).empty());
+    assert(!result.status.ok && result.status.message == "Unsupported CSV encoding: UTF-16");
+    std::remove(path.c_str());
+  }
+
+  return 0;
+}
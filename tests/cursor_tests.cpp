@@ -0,0 +1,109 @@
+#include <cassert>
+#include <string>
+
+#include "backend/query_router.h"
+#include "backend/scratchbird_connection.h"
+
+using scratchrobin::backend::ConnectionInfo;
+using scratchrobin::backend::ExecutionPolicy;
+using scratchrobin::backend::QueryRouter;
+using scratchrobin::backend::ScratchbirdConnection;
+using scratchrobin::core::ColumnType;
+
+// Runs against the mock connection, which serves five rows for any SELECT
+int main() {
+  // Cursors need a connection
+  {
+    ScratchbirdConnection connection;
+    assert(!connection.openCursor("SELECT * FROM t").success);
+    assert(!connection.fetchRows(10).success);
+  }
+
+  ScratchbirdConnection connection;
+  assert(connection.connect(ConnectionInfo{}));
+
+  // Opening returns the columns and no rows
+  {
+    const auto opened = connection.openCursor("SELECT * FROM t");
+    assert(opened.success && opened.has_more);
+    assert(opened.columns.size() == 4 && opened.rows.empty());
+    assert(connection.hasOpenCursor());
+    connection.closeCursor();
+    assert(!connection.hasOpenCursor());
+  }
+
+  // Batches of two: 2 + 2 + 1, has_more only while rows remain
+  {
+    connection.openCursor("SELECT * FROM t");
+    std::string ids;
+    for (int batch = 0; batch < 3; ++batch) {
+      const auto rows = connection.fetchRows(2);
+      assert(rows.success && rows.columns.size() == 4);
+      assert(rows.rows.size() == (batch < 2 ? 2u : 1u));
+      assert(rows.has_more == (batch < 2));
+      for (const auto& row : rows.rows) ids += row[0];
+    }
+    assert(ids == "12345");
+    assert(!connection.hasOpenCursor());
+    assert(!connection.fetchRows(2).success);
+  }
+
+  // A batch ending exactly on the last row reports no more rows, so no
+  // empty fetch follows
+  {
+    connection.openCursor("SELECT * FROM t");
+    const auto all = connection.fetchRows(5);
+    assert(all.success && all.rows.size() == 5 && !all.has_more);
+    assert(!connection.hasOpenCursor());
+  }
+
+  // Statements without rows
+  {
+    connection.openCursor("UPDATE t SET a = 1");
+    const auto none = connection.fetchRows(5);
+    assert(none.success && none.rows.empty() && !none.has_more);
+  }
+
+  // Cancelling fails the next fetch and closes the cursor
+  {
+    connection.openCursor("SELECT * FROM t");
+    assert(connection.fetchRows(1).has_more);
+    assert(connection.cancel());
+    const auto cancelled = connection.fetchRows(1);
+    assert(!cancelled.success && cancelled.error_message == "Query cancelled");
+    assert(!connection.hasOpenCursor());
+  }
+
+  // The router's streaming policy returns the first batch over the
+  // direct connection and keeps the cursor open only while rows remain
+  {
+    QueryRouter router;
+    router.setDirectConnection(&connection);
+
+    ExecutionPolicy policy;
+    policy.streaming = true;
+    policy.fetch_rows = 3;
+    const auto first = router.execute("SELECT * FROM t", policy);
+    assert(first.status.ok && first.has_more);
+    assert(first.result_set.columns.size() == 4 && first.result_set.rows.size() == 3);
+    assert(first.result_set.DeclaredType(0) == ColumnType::kInt64);
+    assert(first.result_set.DeclaredType(1) == ColumnType::kText);
+    assert(first.result_set.DeclaredType(3) == ColumnType::kDate);
+    assert(router.hasOpenCursor());
+    const auto rest = router.fetchRows(2);
+    assert(rest.status.ok && rest.result_set.rows.size() == 2 && !rest.has_more);
+    assert(!router.hasOpenCursor());
+    assert(!router.fetchRows(2).status.ok);
+
+    policy.fetch_rows = 5;
+    const auto exact = router.execute("SELECT * FROM t", policy);
+    assert(exact.status.ok && exact.result_set.rows.size() == 5 && !exact.has_more);
+    assert(!router.hasOpenCursor());
+
+    router.openCursor("SELECT * FROM t");
+    router.closeCursor();
+    assert(!router.hasOpenCursor() && !connection.hasOpenCursor());
+  }
+
+  return 0;
+}
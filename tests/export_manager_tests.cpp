@@ -0,0 +1,362 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "core/export_manager.h"
+#include "core/streaming_data_importer.h"
+
+using scratchrobin::core::ColumnType;
+using scratchrobin::core::ExportConfig;
+using scratchrobin::core::ExportFormat;
+using scratchrobin::core::ExportManager;
+using scratchrobin::core::ExportResult;
+using scratchrobin::core::ImportConfig;
+using scratchrobin::core::ImportFilter;
+using scratchrobin::core::ImportFormat;
+using scratchrobin::core::ResultSet;
+using scratchrobin::core::Status;
+using scratchrobin::core::StreamingDataImporter;
+
+namespace {
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  std::ostringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+ResultSet MakeRows(int count) {
+  ResultSet result;
+  result.columns = {"id", "name", "score"};
+  result.rows.SetColumnCount(3);
+  for (int i = 0; i < count; ++i) {
+    result.rows.Column(0).AppendInt64(i);
+    if (i % 7 == 3) {
+      result.rows.Column(1).AppendNull();
+    } else {
+      result.rows.Column(1).AppendText("n" + std::to_string(i) + (i % 5 == 0 ? ", \"q\"\nx" : ""));
+    }
+    result.rows.Column(2).AppendDouble(i + 0.5);
+    result.rows.EndRow();
+  }
+  return result;
+}
+
+// Imports |config| through the batch callback, one string per cell.
+std::vector<std::vector<std::string>> Import(const ImportConfig& config, Status* status) {
+  std::vector<std::vector<std::string>> rows;
+  StreamingDataImporter importer;
+  *status = importer.StreamImport(config, [&rows](const ResultSet& batch, int64_t) {
+    for (size_t r = 0; r < batch.RowCount(); ++r) {
+      std::vector<std::string> row;
+      for (size_t c = 0; c < batch.ColumnCount(); ++c) {
+        row.push_back(batch.Column(c).IsNull(r) ? "<NULL>" : batch.Column(c).Format(r));
+      }
+      rows.push_back(row);
+    }
+    return Status::Ok();
+  });
+  return rows;
+}
+
+std::string Gunzip(const std::string& data) {
+  z_stream stream{};
+  assert(inflateInit2(&stream, 16 + MAX_WBITS) == Z_OK);
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  std::string out;
+  char buffer[65536];
+  int rc = Z_OK;
+  while (rc == Z_OK) {
+    stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    stream.avail_out = sizeof(buffer);
+    rc = inflate(&stream, Z_NO_FLUSH);
+    out.append(buffer, sizeof(buffer) - stream.avail_out);
+  }
+  assert(rc == Z_STREAM_END && stream.avail_in == 0);
+  inflateEnd(&stream);
+  return out;
+}
+
+ExportResult Export(const ResultSet& rows, ExportConfig config, const std::string& path) {
+  config.export_id = path;
+  config.output_path = path;
+  ExportManager manager;
+  return manager.ExportResultSet(rows, config);
+}
+
+}  // namespace
+
+int main() {
+  const ResultSet source = MakeRows(2500);
+
+  // CSV reads back through the importer unchanged, whatever the batching
+  {
+    for (int batch : {1, 64, 1000}) {
+      ExportConfig config;
+      config.format = ExportFormat::kCSV;
+      config.csv_options.escape = '"';
+      config.batch_size = batch;
+      config.parallelism = 3;
+      const std::string path = "export_manager_tests.csv";
+      const auto result = Export(source, config, path);
+      assert(result.status.ok);
+      assert(result.total_rows == 2500);
+
+      ImportConfig import;
+      import.import_id = path;
+      import.source_path = path;
+      Status status;
+      const auto rows = Import(import, &status);
+      assert(status.ok);
+      assert(rows.size() == 2500);
+      for (size_t r = 0; r < rows.size(); ++r) {
+        for (size_t c = 0; c < 3; ++c) {
+          const auto& column = source.rows.Column(c);
+          assert(rows[r][c] == (column.IsNull(r) ? "<NULL>" : column.Format(r)));
+        }
+      }
+      std::remove(path.c_str());
+    }
+  }
+
+  // JSON arrays and JSON Lines, with skip/max and column aliases
+  {
+    ExportConfig config;
+    config.format = ExportFormat::kJSON;
+    config.json_options.pretty_print = false;
+    config.skip_rows = 3;
+    config.max_rows = 2;
+    config.export_all_columns = false;
+    config.columns.resize(2);
+    config.columns[0].name = "name";
+    config.columns[0].alias = "label";
+    config.columns[1].name = "id";
+    const std::string path = "export_manager_tests.json";
+    assert(Export(source, config, path).status.ok);
+    assert(ReadFile(path) == "[{\"label\":null,\"id\":3},{\"label\":\"n4\",\"id\":4}]\n");
+
+    config.json_options.use_arrays = false;
+    assert(Export(source, config, path).status.ok);
+    assert(ReadFile(path) == "{\"label\":null,\"id\":3}\n{\"label\":\"n4\",\"id\":4}\n");
+    std::remove(path.c_str());
+  }
+
+  // Multi-row INSERTs split on bulk_insert_size regardless of batch_size
+  {
+    ExportConfig config;
+    config.format = ExportFormat::kSQL;
+    config.source_table = "scores";
+    config.batch_size = 3;
+    config.max_rows = 5;
+    config.sql_options.bulk_insert_size = 2;
+    config.sql_options.include_create_table = false;
+    config.sql_options.quote_identifiers = false;
+    const std::string path = "export_manager_tests.sql";
+    const auto result = Export(source, config, path);
+    assert(result.status.ok && result.total_rows == 5);
+    const std::string sql = ReadFile(path);
+    size_t statements = 0;
+    for (size_t at = sql.find("INSERT INTO scores (id, name, score) VALUES");
+         at != std::string::npos; at = sql.find("INSERT INTO", at + 1)) {
+      ++statements;
+    }
+    assert(statements == 3);
+    assert(sql.rfind("BEGIN;\n", 0) == 0);
+    assert(sql.find("VALUES\n  (2, 'n2', 2.5),\n  (3, NULL, 3.5);\n") != std::string::npos);
+    assert(sql.size() >= 8 && sql.compare(sql.size() - 8, 8, "COMMIT;\n") == 0);
+    std::remove(path.c_str());
+  }
+
+  // JSON and SQL follow the declared column types, not what each batch's
+  // values look like: digits in a text column stay strings
+  {
+    ResultSet typed;
+    typed.columns = {"code", "amount"};
+    typed.column_types = {ColumnType::kText, ColumnType::kDouble};
+    typed.rows.SetColumnCount(2);
+    typed.rows.Column(0).AppendText("42");
+    typed.rows.Column(1).AppendText("3");
+    typed.rows.EndRow();
+    assert(typed.rows.Column(0).Type() == ColumnType::kInt64);
+
+    ExportConfig config;
+    config.format = ExportFormat::kJSON;
+    config.json_options.pretty_print = false;
+    const std::string path = "export_manager_tests_typed.json";
+    assert(Export(typed, config, path).status.ok);
+    assert(ReadFile(path) == "[{\"code\":\"42\",\"amount\":3}]\n");
+
+    config.format = ExportFormat::kSQL;
+    config.source_table = "t";
+    config.sql_options.quote_identifiers = false;
+    config.sql_options.include_transactions = false;
+    assert(Export(typed, config, path).status.ok);
+    const std::string sql = ReadFile(path);
+    assert(sql.find("  code TEXT,\n  amount DOUBLE PRECISION\n") != std::string::npos);
+    assert(sql.find("  ('42', 3);\n") != std::string::npos);
+    std::remove(path.c_str());
+
+    // A query export takes the server's types for CREATE TABLE
+    auto connection = std::make_shared<scratchrobin::core::Connection>();
+    assert(connection->connect(scratchrobin::backend::ConnectionInfo{}));
+    config.connection = connection;
+    config.export_id = config.output_path = path;
+    ExportManager manager;
+    assert(manager.ExecuteExport(config).status.ok);
+    const std::string ddl = ReadFile(path);
+    assert(ddl.find("  ID INT8,\n") != std::string::npos);
+    assert(ddl.find("  Created DATE\n") != std::string::npos);
+    assert(ddl.find("(1, 'John Doe', 'john@example.com', '2024-01-15')") != std::string::npos);
+    std::remove(path.c_str());
+  }
+
+  // Parquet and Arrow keep column types across the round trip, and import
+  // reads only selected columns and rows passing the filters
+  {
+    const std::pair<ExportFormat, ImportFormat> formats[] = {
+        {ExportFormat::kParquet, ImportFormat::kParquet},
+        {ExportFormat::kArrow, ImportFormat::kArrow}};
+    for (const auto& [export_format, import_format] : formats) {
+      ExportConfig config;
+      config.format = export_format;
+      config.columnar_options.row_group_rows = 300;
+      config.columnar_options.page_bytes = 512;
+      config.parallelism = 3;
+      const std::string path = "export_manager_tests.columnar";
+      const auto result = Export(source, config, path);
+      assert(result.status.ok && result.total_rows == 2500);
+
+      ImportConfig import;
+      import.import_id = path;
+      import.source_path = path;
+      import.format = import_format;
+      Status status;
+      auto rows = Import(import, &status);
+      assert(status.ok && rows.size() == 2500);
+      for (size_t r = 0; r < rows.size(); ++r) {
+        for (size_t c = 0; c < 3; ++c) {
+          const auto& column = source.rows.Column(c);
+          assert(rows[r][c] == (column.IsNull(r) ? "<NULL>" : column.Format(r)));
+        }
+      }
+
+      import.select_columns = {"score", "name"};
+      import.filters.push_back({"id", ImportFilter::Op::kGreaterEqual, "2000"});
+      import.filters.push_back({"name", ImportFilter::Op::kIsNotNull, ""});
+      import.skip_rows = 1;
+      rows = Import(import, &status);
+      assert(status.ok);
+      std::vector<std::vector<std::string>> expected;
+      for (int i = 2000; i < 2500; ++i) {
+        if (i % 7 != 3) {
+          expected.push_back({source.rows.Column(2).Format(i), source.rows.Column(1).Format(i)});
+        }
+      }
+      expected.erase(expected.begin());
+      assert(rows == expected);
+
+      import.filters = {{"id", ImportFilter::Op::kEqual, "not a number"}};
+      Import(import, &status);
+      assert(!status.ok);
+      std::remove(path.c_str());
+    }
+  }
+
+  // A NUMERIC column whose first row group holds only integers and a later
+  // one 10.5 is stored as double throughout. The row transform re-reads
+  // every batch from text, as a cursor export would; the undeclared
+  // column it turns into text in the second batch is stored as strings.
+  {
+    ResultSet mixed;
+    mixed.columns = {"amount", "label"};
+    mixed.column_types = {ColumnType::kDouble};
+    mixed.rows.SetColumnCount(2);
+    for (int i = 0; i < 600; ++i) {
+      mixed.rows.Column(0).AppendText(i == 450 ? "10.5" : std::to_string(i));
+      mixed.rows.Column(1).AppendInt64(i);
+      mixed.rows.EndRow();
+    }
+    const std::pair<ExportFormat, ImportFormat> formats[] = {
+        {ExportFormat::kParquet, ImportFormat::kParquet},
+        {ExportFormat::kArrow, ImportFormat::kArrow}};
+    for (const auto& [export_format, import_format] : formats) {
+      ExportConfig config;
+      config.format = export_format;
+      config.columnar_options.row_group_rows = 300;
+      config.export_id = config.output_path = "export_manager_tests_mixed.columnar";
+      ExportManager manager;
+      manager.SetRowTransformCallback([](const std::map<std::string, std::string>& row,
+                                         std::map<std::string, std::string>* transformed) {
+        if (row.at("label") == "500") {
+          (*transformed)["label"] = "x";
+        }
+        return Status::Ok();
+      });
+      assert(manager.ExportResultSet(mixed, config).status.ok);
+
+      ImportConfig import;
+      import.import_id = import.source_path = config.output_path;
+      import.format = import_format;
+      Status status;
+      const auto rows = Import(import, &status);
+      assert(status.ok && rows.size() == 600);
+      assert(rows[1][0] == "1" && rows[450][0] == "10.5");
+      assert(rows[499][1] == "499" && rows[500][1] == "x");
+
+      // A value that does not fit the declared type still fails the export
+      mixed.column_types = {ColumnType::kInt64};
+      const auto rejected = manager.ExportResultSet(mixed, config);
+      assert(!rejected.status.ok &&
+             rejected.status.message == "Column amount holds double values but the file stores int64");
+      mixed.column_types = {ColumnType::kDouble};
+      std::remove(config.output_path.c_str());
+    }
+  }
+
+  // gzip output spans several parallel blocks and inflates to the plain
+  // export; the extension is added to the path
+  {
+    const ResultSet many = MakeRows(40000);
+    ExportConfig config;
+    config.format = ExportFormat::kCSV;
+    config.batch_size = 500;
+    config.parallelism = 4;
+    const std::string path = "export_manager_tests_gz.csv";
+    assert(Export(many, config, path).status.ok);
+    const std::string plain = ReadFile(path);
+    assert(plain.size() > 4 * 128 * 1024);
+
+    config.compress_output = true;
+    const auto result = Export(many, config, path);
+    assert(result.status.ok);
+    assert(result.output_path == path + ".gz");
+    const std::string compressed = ReadFile(path + ".gz");
+    assert(compressed.size() < plain.size());
+    assert(Gunzip(compressed) == plain);
+
+    config.compression_format = "bzip2";
+    assert(!Export(many, config, path).status.ok);
+    std::remove(path.c_str());
+    std::remove((path + ".gz").c_str());
+  }
+
+  // A failed export leaves neither the file nor its ".part"
+  {
+    ExportConfig config;
+    config.format = ExportFormat::kExcel;
+    const std::string path = "export_manager_tests.xlsx";
+    assert(!Export(source, config, path).status.ok);
+    assert(!std::ifstream(path).good());
+    assert(!std::ifstream(path + ".part").good());
+  }
+
+  return 0;
+}
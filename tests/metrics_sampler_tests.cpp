@@ -0,0 +1,235 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/metrics_sampler.h"
+
+using scratchrobin::core::DatabaseActivity;
+using scratchrobin::core::DatabaseRates;
+using scratchrobin::core::MetricSample;
+using scratchrobin::core::MetricsSampler;
+using scratchrobin::core::MetricsSamplerOptions;
+using scratchrobin::core::ResultSet;
+using scratchrobin::core::Status;
+
+namespace {
+
+// Polls |done| for up to five seconds
+template <typename Predicate>
+bool WaitFor(Predicate done) {
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  return true;
+}
+
+// A query that blocks until opened
+class Gate {
+ public:
+  void Open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open_ = true;
+    cv_.notify_all();
+  }
+  void Pass() {
+    ++waiting_;
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return open_; });
+  }
+  int Waiting() const { return waiting_.load(); }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool open_ = false;
+  std::atomic<int> waiting_{0};
+};
+
+}  // namespace
+
+int main() {
+  // Ten subscribers of a source share one query per interval
+  {
+    Gate gate;  // Holds the first query until everybody subscribed
+    std::atomic<int> queries{0};
+    MetricsSampler sampler([&](const std::string& sql, ResultSet* result) {
+      assert(sql == "SELECT 1");
+      if (++queries == 1) gate.Pass();
+      result->columns = {"n"};
+      result->rows.push_back({"1"});
+      return Status::Ok();
+    });
+    sampler.AddSource("one", "SELECT 1");
+    assert(sampler.Subscribe("missing", 10, [](const MetricSample&) {}) == 0);
+
+    std::mutex mutex;
+    std::vector<std::vector<uint64_t>> seen(10);
+    std::vector<uint64_t> ids;
+    for (std::size_t i = 0; i < seen.size(); ++i) {
+      ids.push_back(sampler.Subscribe("one", 20 + 10 * static_cast<int64_t>(i),
+                                      [&, i](const MetricSample& sample) {
+        assert(sample.status.ok && sample.result->RowCount() == 1);
+        std::lock_guard<std::mutex> lock(mutex);
+        seen[i].push_back(sample.sequence);
+      }));
+    }
+    gate.Open();
+    assert(WaitFor([&]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      return seen[9].size() >= 5;
+    }));
+    {
+      // Every sample reached every subscriber, and each took one query
+      std::lock_guard<std::mutex> lock(mutex);
+      for (const auto& sequences : seen) {
+        for (std::size_t i = 0; i < sequences.size(); ++i) assert(sequences[i] == i + 1);
+        assert(sequences.size() + 1 >= seen[0].size() && sequences.size() <= seen[0].size());
+      }
+      assert(static_cast<std::size_t>(queries.load()) <= seen[0].size() + 1);
+    }
+    for (uint64_t id : ids) sampler.Unsubscribe(id);
+    assert(sampler.Stats("one").interval_ms == 0);
+
+    // Nobody listens, nothing runs
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    const int total = queries.load();
+    assert(sampler.Stats("one").queries == total);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    assert(queries.load() == total);
+  }
+
+  // Refresh requests during a collection merge into one more collection
+  {
+    Gate gate;
+    std::atomic<int> queries{0};
+    MetricsSampler sampler([&](const std::string&, ResultSet*) {
+      if (++queries == 1) gate.Pass();
+      return Status::Ok();
+    });
+    sampler.AddSource("slow", "SELECT 1");
+    std::atomic<int> samples{0};
+    const uint64_t id = sampler.Subscribe("slow", 60000, [&](const MetricSample&) { ++samples; });
+    assert(WaitFor([&]() { return gate.Waiting() == 1; }));
+    for (int i = 0; i < 5; ++i) sampler.RequestRefresh("slow");
+    gate.Open();
+    assert(WaitFor([&]() { return samples.load() == 2; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    assert(queries.load() == 2 && samples.load() == 2);
+    assert(sampler.Stats("slow").coalesced == 4);
+    sampler.Unsubscribe(id);
+  }
+
+  // Passive subscribers only cause the collections they ask for
+  {
+    std::atomic<int> queries{0};
+    MetricsSampler sampler([&](const std::string&, ResultSet*) {
+      ++queries;
+      return Status::Ok();
+    });
+    sampler.AddSource("quiet", "SELECT 1");
+    std::atomic<int> passive{0};
+    const uint64_t id = sampler.Subscribe("quiet", 0, [&](const MetricSample&) { ++passive; });
+    assert(WaitFor([&]() { return passive.load() == 1; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    assert(queries.load() == 1 && sampler.Stats("quiet").interval_ms == 0);
+    sampler.RequestRefresh("quiet");
+    assert(WaitFor([&]() { return passive.load() == 2; }));
+
+    // ...and see those of a polling subscriber
+    const uint64_t polling = sampler.Subscribe("quiet", 5, [](const MetricSample&) {});
+    assert(WaitFor([&]() { return passive.load() >= 5; }));
+    sampler.Unsubscribe(polling);
+    sampler.Unsubscribe(id);
+  }
+
+  // Slow or failing collections stretch the interval, fast ones shrink it
+  {
+    std::atomic<bool> slow{true};
+    std::atomic<bool> fail{false};
+    MetricsSamplerOptions options;
+    options.max_interval_ms = 160;
+    MetricsSampler sampler([&](const std::string&, ResultSet*) {
+      if (fail) return Status::Error("server busy");
+      if (slow) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      return Status::Ok();
+    }, options);
+    sampler.AddSource("load", "SELECT 1");
+    std::atomic<int64_t> interval{0};
+    const uint64_t id = sampler.Subscribe("load", 20, [&](const MetricSample& sample) {
+      interval = sample.interval_ms;
+    });
+    assert(WaitFor([&]() { return interval.load() == 160; }));
+    assert(sampler.Stats("load").interval_ms == 160);
+
+    slow = false;
+    assert(WaitFor([&]() { return interval.load() == 20; }));
+
+    fail = true;
+    assert(WaitFor([&]() { return interval.load() >= 80; }));
+    assert(sampler.Stats("load").failures > 0);
+    sampler.Unsubscribe(id);
+  }
+
+  // No callback runs once Unsubscribe() or Stop() returns
+  {
+    std::atomic<bool> unsubscribed{false};
+    std::atomic<int> late{0};
+    MetricsSampler sampler([](const std::string&, ResultSet*) { return Status::Ok(); });
+    sampler.AddSource("fast", "SELECT 1");
+    std::atomic<int> samples{0};
+    const uint64_t id = sampler.Subscribe("fast", 1, [&](const MetricSample&) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      if (unsubscribed) ++late;
+      ++samples;
+    });
+    assert(WaitFor([&]() { return samples.load() >= 3; }));
+    sampler.Unsubscribe(id);
+    unsubscribed = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assert(late.load() == 0);
+
+    sampler.Subscribe("fast", 1, [&](const MetricSample&) { ++samples; });
+    sampler.Stop();
+    const int stopped = samples.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    assert(samples.load() == stopped);
+  }
+
+  // Database counters turn into rates
+  {
+    MetricSample sample;
+    sample.status = Status::Ok();
+    auto result = std::make_shared<ResultSet>();
+    result->columns = {"backends", "transactions", "blocks_hit", "blocks_read", "rows"};
+    result->rows.push_back({"4", "1000", "900", "100", "5000"});
+    sample.result = result;
+    sample.taken_at = std::chrono::system_clock::time_point(std::chrono::seconds(100));
+    DatabaseActivity earlier;
+    assert(DatabaseActivity::FromSample(sample, &earlier));
+    assert(earlier.backends == 4 && earlier.blocks_read == 100);
+
+    result = std::make_shared<ResultSet>();
+    result->columns = sample.result->columns;
+    result->rows.push_back({"5", "1200", "1290", "110", "6000"});
+    sample.result = result;
+    sample.taken_at += std::chrono::seconds(2);
+    DatabaseActivity later;
+    assert(DatabaseActivity::FromSample(sample, &later));
+
+    const DatabaseRates rates = DatabaseRates::Between(earlier, later);
+    assert(rates.transactions_per_sec == 100.0 && rates.rows_per_sec == 500.0);
+    assert(rates.cache_hit_ratio > 97.4 && rates.cache_hit_ratio < 97.6);
+
+    sample.status = Status::Error("down");
+    assert(!DatabaseActivity::FromSample(sample, &later));
+  }
+
+  return 0;
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/query_stats.h"
+
+using scratchrobin::core::HashQueryKey;
+using scratchrobin::core::QueryLatencyHistogram;
+using scratchrobin::core::QueryStats;
+using scratchrobin::core::QueryStatsOptions;
+using scratchrobin::core::QueryStatsOrder;
+using scratchrobin::core::StatementFingerprint;
+
+namespace {
+
+// Within 3.2% of |exact|
+bool Close(int64_t estimate, int64_t exact) {
+  return std::abs(static_cast<double>(estimate - exact)) <= 0.032 * static_cast<double>(exact) + 1;
+}
+
+}  // namespace
+
+int main() {
+  // Buckets tile the range and percentiles stay within ~3%
+  {
+    for (int64_t value : {0LL, 1LL, 15LL, 16LL, 31LL, 32LL, 33LL, 1000LL, 123456789LL}) {
+      const std::size_t bucket = QueryLatencyHistogram::BucketFor(value);
+      assert(QueryLatencyHistogram::LowerBoundUs(bucket) <= value);
+      assert(value < QueryLatencyHistogram::LowerBoundUs(bucket) +
+                         QueryLatencyHistogram::WidthUs(bucket));
+    }
+    for (std::size_t b = 1; b < QueryLatencyHistogram::kBucketCount; ++b) {
+      assert(QueryLatencyHistogram::LowerBoundUs(b) ==
+             QueryLatencyHistogram::LowerBoundUs(b - 1) + QueryLatencyHistogram::WidthUs(b - 1));
+    }
+    assert(QueryLatencyHistogram::BucketFor(int64_t{1} << 40) ==
+           QueryLatencyHistogram::kBucketCount - 1);
+
+    std::mt19937_64 random(3);
+    std::lognormal_distribution<double> latency(7.0, 1.5);
+    std::vector<int64_t> values;
+    QueryLatencyHistogram histogram;
+    for (int i = 0; i < 100000; ++i) {
+      values.push_back(static_cast<int64_t>(latency(random)));
+      histogram.Record(values.back());
+    }
+    std::sort(values.begin(), values.end());
+    for (double p : {50.0, 95.0, 99.0}) {
+      const auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * values.size())) - 1;
+      assert(Close(histogram.PercentileUs(p), values[rank]));
+    }
+    assert(histogram.PercentileUs(100.0) == values.back());
+    assert(histogram.min_us == values.front() && histogram.count == 100000);
+  }
+
+  // Fingerprints ignore literals and layout, not structure
+  {
+    const uint64_t a = StatementFingerprint("SELECT * FROM t WHERE id = 1 AND name = 'x';");
+    assert(a == StatementFingerprint("select *\n  from T -- by id\n where id=42 and name = 'it''s'"));
+    assert(a != StatementFingerprint("SELECT * FROM t WHERE id = 1 OR name = 'x'"));
+    assert(a != StatementFingerprint("SELECT * FROM u WHERE id = 1 AND name = 'x'"));
+    assert(StatementFingerprint("SELECT ab") != StatementFingerprint("SELECT a b"));
+    assert(StatementFingerprint("SELECT \"T\"") != StatementFingerprint("SELECT \"t\""));
+  }
+
+  // Threads recording at once lose nothing
+  {
+    QueryStats stats(QueryStatsOptions{64});
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+      threads.emplace_back([&stats, t]() {
+        for (int i = 0; i < 20000; ++i) {
+          const int query = i % 5;
+          stats.Record(HashQueryKey(std::to_string(query)), std::to_string(query),
+                       "SELECT " + std::to_string(query), 100 * (query + 1) + t, 2, (i / 5) % 100 != 0);
+        }
+      });
+    }
+    for (auto& thread : threads) thread.join();
+
+    const auto entries = stats.Entries();
+    assert(entries.size() == 5);
+    for (const auto& entry : entries) {
+      const int query = std::stoi(entry.key);
+      assert(entry.text == "SELECT " + entry.key);
+      assert(entry.count == 32000 && entry.rows == 64000 && entry.errors == 320);
+      assert(entry.min_us == 100 * (query + 1) && entry.max_us == 100 * (query + 1) + 7);
+      assert(Close(entry.p50_us, 100 * (query + 1) + 3));
+    }
+    assert(stats.Dropped() == 0);
+  }
+
+  // Top-k by average latency and by count
+  {
+    QueryStats stats(QueryStatsOptions{64});
+    for (int query = 0; query < 20; ++query) {
+      for (int i = 0; i <= query; ++i) {
+        stats.Record(HashQueryKey(std::to_string(query)), std::to_string(query), "",
+                     1000 * (20 - query), 0, true);
+      }
+    }
+    const auto slow = stats.Top(3, QueryStatsOrder::kSlowest);
+    assert(slow.size() == 3 && slow[0].key == "0" && slow[1].key == "1" && slow[2].key == "2");
+    const auto frequent = stats.Top(2, QueryStatsOrder::kFrequent);
+    assert(frequent.size() == 2 && frequent[0].key == "19" && frequent[1].count == 19);
+    assert(stats.Top(100, QueryStatsOrder::kFrequent).size() == 20);
+    assert(stats.Top(0, QueryStatsOrder::kFrequent).empty());
+
+    const auto found = stats.Find(HashQueryKey("4"));
+    assert(found && found->count == 5 && found->p99_us == 16000);
+    assert(!stats.Find(HashQueryKey("missing")));
+
+    stats.Clear();
+    assert(stats.Entries().empty());
+    stats.Record(HashQueryKey("4"), "4", "", 10, 0, true);
+    assert(stats.Find(HashQueryKey("4"))->count == 1);
+  }
+
+  // A full shard drops further fingerprints and counts them
+  {
+    QueryStats stats(QueryStatsOptions{4});
+    for (int query = 0; query < 10; ++query) {
+      stats.Record(static_cast<uint64_t>(100 + query), "", "", 1, 0, true);
+    }
+    assert(stats.Entries().size() == 4 && stats.Dropped() == 6);
+  }
+
+  // Clear() frees the slots of a full shard for new fingerprints
+  {
+    QueryStats stats(QueryStatsOptions{64});
+    for (int query = 0; query < 200; ++query) {
+      stats.Record(static_cast<uint64_t>(1000 + query), "", "", 1, 0, true);
+    }
+    assert(stats.Entries().size() == 64 && stats.Dropped() == 136);
+    stats.Clear();
+    for (int query = 0; query < 10; ++query) {
+      stats.Record(static_cast<uint64_t>(5000 + query), "", "", 7, 0, true);
+    }
+    const auto entries = stats.Entries();
+    assert(entries.size() == 10 && stats.Dropped() == 0);
+    for (int query = 0; query < 10; ++query) {
+      const auto found = stats.Find(static_cast<uint64_t>(5000 + query));
+      assert(found && found->count == 1 && found->max_us == 7);
+    }
+  }
+
+  return 0;
+}
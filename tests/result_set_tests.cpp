@@ -0,0 +1,131 @@
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "core/result_set.h"
+#include "core/sql_utils.h"
+
+using scratchrobin::core::ColumnTable;
+using scratchrobin::core::ColumnType;
+using scratchrobin::core::ResultSet;
+
+int main() {
+  // Typed columns are chosen only when the text round-trips exactly
+  {
+    ColumnTable table;
+    table.SetColumnCount(4);
+    const std::vector<std::vector<std::string>> input = {
+        {"1", "1.5", "2024-02-29", "007"},
+        {"-42", "2", "1970-01-01", "abc"},
+    };
+    for (const auto& row : input) {
+      for (size_t col = 0; col < row.size(); ++col) {
+        table.Column(col).AppendText(row[col]);
+      }
+      table.EndRow();
+    }
+    assert(table.Column(0).Type() == ColumnType::kInt64);
+    assert(table.Column(1).Type() == ColumnType::kDouble);
+    assert(table.Column(2).Type() == ColumnType::kDate);
+    assert(table.Column(3).Type() == ColumnType::kText);
+    assert(table.Column(0).Int64At(1) == -42);
+    assert(table.Column(2).DateAt(1) == 0);
+    for (size_t row = 0; row < input.size(); ++row) {
+      for (size_t col = 0; col < input[row].size(); ++col) {
+        assert(table[row][col] == input[row][col]);
+      }
+    }
+  }
+
+  // Demotion keeps earlier values and NULLs intact
+  {
+    ColumnTable table;
+    table.SetColumnCount(1);
+    table.Column(0).AppendNull();
+    table.EndRow();
+    table.Column(0).AppendText("10");
+    table.EndRow();
+    table.Column(0).AppendText("10.25");
+    table.EndRow();
+    table.Column(0).AppendText("n/a");
+    table.EndRow();
+    assert(table.Column(0).Type() == ColumnType::kText);
+    assert(table.Column(0).IsNull(0));
+    assert(table[0][0] == "NULL");
+    assert(table[1][0] == "10");
+    assert(table[2][0] == "10.25");
+    assert(table[3][0] == "n/a");
+  }
+
+  // Integers that would not print the same as doubles go straight to text
+  {
+    ColumnTable table;
+    table.SetColumnCount(2);
+    const std::vector<std::vector<std::string>> input = {
+        {"1000000", "7"},
+        {"1.5", "1.5"},
+        {"1e20", "0.25"},
+    };
+    for (const auto& row : input) {
+      for (size_t col = 0; col < row.size(); ++col) {
+        table.Column(col).AppendText(row[col]);
+      }
+      table.EndRow();
+    }
+    assert(table.Column(0).Type() == ColumnType::kText);
+    assert(table.Column(1).Type() == ColumnType::kDouble);
+    for (size_t row = 0; row < input.size(); ++row) {
+      for (size_t col = 0; col < input[row].size(); ++col) {
+        assert(table[row][col] == input[row][col]);
+      }
+    }
+    table.Column(0).AppendNull();
+    table.Column(1).AppendInt64(1000000);
+    table.EndRow();
+    assert(table.Column(1).Type() == ColumnType::kText);
+    assert(table[3][1] == "1000000");
+    assert(table[0][1] == "7");
+  }
+
+  // Row-oriented compatibility view
+  {
+    ResultSet rs;
+    rs.columns = {"status", "message"};
+    rs.rows = {{"ok", "done"}, {"warn"}};
+    assert(rs.rows.size() == 2);
+    assert(!rs.rows.empty());
+    assert(rs.rows[0][1] == "done");
+    assert(rs.rows[1][1] == "NULL");
+    size_t cells = 0;
+    for (const auto& row : rs.rows) {
+      for (const auto& cell : row) {
+        assert(!cell.empty());
+        ++cells;
+      }
+    }
+    assert(cells == 4);
+    rs.rows.push_back({"a", "b", "c"});
+    assert(rs.rows[0].size() == 3);
+    assert(rs.rows[0][2] == "NULL");
+    const std::vector<std::string> copy = rs.rows[2];
+    assert(copy.size() == 3 && copy[2] == "c");
+  }
+
+  // Cells render as SQL literals without a round trip through strings
+  {
+    ColumnTable table;
+    table.SetColumnCount(3);
+    table.Column(0).AppendInt64(42);
+    table.Column(1).AppendText("it's");
+    table.Column(2).AppendNull();
+    table.EndRow();
+    std::string sql;
+    for (std::size_t col = 0; col < 3; ++col) {
+      scratchrobin::core::appendSqlLiteral(table.Column(col), 0, sql);
+      sql += ";";
+    }
+    assert(sql == "42;'it''s';NULL;");
+  }
+
+  return 0;
+}
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include "core/schema_diff.h"
+
+using scratchrobin::core::ColumnInfo;
+using scratchrobin::core::ConstraintInfo;
+using scratchrobin::core::IndexColumnInfo;
+using scratchrobin::core::IndexInfo;
+using scratchrobin::core::SchemaChangeKind;
+using scratchrobin::core::SchemaDiff;
+using scratchrobin::core::SchemaDiffResult;
+using scratchrobin::core::SchemaObjectKind;
+using scratchrobin::core::SchemaSnapshot;
+using scratchrobin::core::SchemaSyncScript;
+using scratchrobin::core::SequenceInfo;
+using scratchrobin::core::TableInfo;
+using scratchrobin::core::ViewInfo;
+
+namespace {
+
+TableInfo Table(const std::string& schema, const std::string& name,
+                const std::vector<ColumnInfo>& columns) {
+  TableInfo table(name, schema);
+  table.columns = columns;
+  for (std::size_t i = 0; i < table.columns.size(); ++i) {
+    table.columns[i].ordinal_position = static_cast<int32_t>(i + 1);
+  }
+  return table;
+}
+
+ViewInfo View(const std::string& schema, const std::string& name, const std::string& sql,
+              const std::vector<std::string>& dependencies) {
+  ViewInfo view(name, schema);
+  view.definition = sql;
+  view.dependencies = dependencies;
+  return view;
+}
+
+// Index of the step holding a statement starting with |prefix|
+std::size_t StepOf(const SchemaSyncScript& script, const std::string& prefix) {
+  for (std::size_t step = 0; step < script.steps.size(); ++step) {
+    for (const auto& statement : script.steps[step]) {
+      if (statement.rfind(prefix, 0) == 0) return step;
+    }
+  }
+  assert(false && "statement not in script");
+  return 0;
+}
+
+}  // namespace
+
+int main() {
+  // The same objects in two schemas hash the same
+  {
+    SchemaSnapshot source("public");
+    SchemaSnapshot target("staging");
+    source.AddTable(Table("public", "t", {ColumnInfo("id", "integer", false)}));
+    target.AddTable(Table("staging", "t", {ColumnInfo("id", "INTEGER", false)}));
+    source.AddView(View("public", "v", "SELECT id\n  FROM public.t -- all rows", {"public.t"}));
+    target.AddView(View("staging", "v", "select ID from \"staging\".t", {"staging.t"}));
+    ColumnInfo serial("n", "bigint", true);
+    serial.default_value = "nextval('public.s')";
+    source.AddTable(Table("public", "u", {serial}));
+    serial.default_value = "NEXTVAL('staging.s')";
+    target.AddTable(Table("staging", "u", {serial}));
+
+    assert(source.Objects()[1].definition == target.Objects()[1].definition);
+    const SchemaDiffResult diff = SchemaDiff::Compare(source, target);
+    assert(diff.changes.empty() && diff.identical == 3);
+    assert(SchemaDiff::BuildScript(diff).steps.empty());
+  }
+
+  // Created, dropped and altered objects, with column details
+  {
+    SchemaSnapshot source("public");
+    SchemaSnapshot target("public");
+    source.AddTable(Table("public", "t", {ColumnInfo("id", "integer", false),
+                                          ColumnInfo("name", "varchar(80)", true),
+                                          ColumnInfo("added", "date", true)}));
+    target.AddTable(Table("public", "t", {ColumnInfo("id", "integer", false),
+                                          ColumnInfo("name", "varchar(40)", true),
+                                          ColumnInfo("gone", "text", true)}));
+    SequenceInfo sequence("s", "public");
+    source.AddSequence(sequence);
+    sequence.current_value = 42;  // Data, not definition
+    target.AddSequence(sequence);
+    target.AddTable(Table("public", "old", {ColumnInfo("x", "integer", true)}));
+    source.AddView(View("public", "v", "SELECT id FROM t", {"t"}));
+
+    const SchemaDiffResult diff = SchemaDiff::Compare(source, target);
+    assert(diff.changes.size() == 3 && diff.identical == 1);
+    assert(diff.changes[0].kind == SchemaChangeKind::kDrop && diff.changes[0].target.name == "old");
+    const auto& table = diff.changes[1];
+    assert(table.kind == SchemaChangeKind::kAlter && table.source.name == "t");
+    assert((table.details == std::vector<std::string>{
+                "Column 'name' type changed from varchar(40) to varchar(80)",
+                "Column 'added' added", "Column 'gone' dropped"}));
+    assert(diff.changes[2].kind == SchemaChangeKind::kCreate &&
+           diff.changes[2].source.kind == SchemaObjectKind::kView);
+
+    const SchemaSyncScript script = SchemaDiff::BuildScript(diff);
+    assert(script.StatementCount() == 3);
+    const std::size_t alter = StepOf(script, "ALTER TABLE \"public\".\"t\" "
+                                             "ALTER COLUMN \"name\" TYPE varchar(80), "
+                                             "ADD COLUMN \"added\" date, DROP COLUMN \"gone\"");
+    assert(alter == 0 && StepOf(script, "DROP TABLE IF EXISTS \"public\".\"old\"") == 0);
+    assert(StepOf(script, "CREATE VIEW \"public\".\"v\"") == 1);
+  }
+
+  // Steps follow dependencies; views over a changed table are recreated
+  {
+    SchemaSnapshot source("app");
+    SchemaSnapshot target("app");
+    source.AddTable(Table("app", "parent", {ColumnInfo("id", "integer", false)}));
+    source.AddTable(Table("app", "child", {ColumnInfo("pid", "integer", true)}));
+    for (const char* table : {"parent", "child"}) {
+      IndexInfo index(std::string("i_") + table, table, "app");
+      IndexColumnInfo column;
+      column.name = table[0] == 'p' ? "id" : "pid";
+      index.columns.push_back(column);
+      source.AddIndex(index);
+    }
+    ConstraintInfo key("pk", "parent", "PRIMARY KEY", "app");
+    key.columns = {"id"};
+    source.AddConstraint(key);
+    ConstraintInfo foreign("fk", "child", "FOREIGN KEY", "app");
+    foreign.columns = {"pid"};
+    foreign.reference_schema = "app";
+    foreign.reference_table = "parent";
+    foreign.reference_columns = {"id"};
+    source.AddConstraint(foreign);
+
+    // A view chain over a table whose column type changes
+    source.AddTable(Table("app", "w", {ColumnInfo("a", "bigint", true)}));
+    target.AddTable(Table("app", "w", {ColumnInfo("a", "integer", true)}));
+    for (SchemaSnapshot* snapshot : {&source, &target}) {
+      snapshot->AddView(View("app", "v1", "SELECT a FROM w", {"app.w"}));
+      snapshot->AddView(View("app", "v2", "SELECT a FROM v1", {"v1"}));
+      snapshot->AddView(View("app", "other", "SELECT 1", {}));
+    }
+
+    const SchemaDiffResult diff = SchemaDiff::Compare(source, target);
+    assert(diff.identical == 1);
+    std::size_t recreated = 0;
+    for (const auto& change : diff.changes) {
+      if (!change.details.empty() && change.details[0].rfind("Recreated", 0) == 0) ++recreated;
+    }
+    assert(recreated == 2);
+
+    const SchemaSyncScript script = SchemaDiff::BuildScript(diff);
+    const std::size_t parent = StepOf(script, "CREATE TABLE \"app\".\"parent\"");
+    const std::size_t child = StepOf(script, "CREATE TABLE \"app\".\"child\"");
+    const std::size_t pk = StepOf(script, "ALTER TABLE \"app\".\"parent\" ADD CONSTRAINT \"pk\"");
+    const std::size_t fk = StepOf(script, "ALTER TABLE \"app\".\"child\" ADD CONSTRAINT \"fk\"");
+    assert(parent == 0 && child == 0 && pk == 1 && fk == 2);
+    assert(StepOf(script, "CREATE INDEX \"i_child\"") == 1);
+
+    // Drop v2, drop v1, alter w, create v1, create v2
+    const std::size_t drop_v2 = StepOf(script, "DROP VIEW IF EXISTS \"app\".\"v2\"");
+    const std::size_t drop_v1 = StepOf(script, "DROP VIEW IF EXISTS \"app\".\"v1\"");
+    const std::size_t alter_w = StepOf(script, "ALTER TABLE \"app\".\"w\"");
+    const std::size_t create_v1 = StepOf(script, "CREATE VIEW \"app\".\"v1\"");
+    const std::size_t create_v2 = StepOf(script, "CREATE VIEW \"app\".\"v2\"");
+    assert(drop_v2 < drop_v1 && drop_v1 < alter_w && alter_w < create_v1 && create_v1 < create_v2);
+
+    // The edges name only real predecessors: the foreign key waits for its
+    // tables and the primary key, not for the indexes of the step before
+    assert(script.depends_on.size() == script.StatementCount());
+    std::vector<std::string> statements;
+    for (const auto& step : script.steps) {
+      statements.insert(statements.end(), step.begin(), step.end());
+    }
+    auto index_of = [&](const std::string& prefix) {
+      for (std::size_t i = 0; i < statements.size(); ++i) {
+        if (statements[i].rfind(prefix, 0) == 0) return i;
+      }
+      assert(false && "statement not in script");
+      return std::size_t{0};
+    };
+    std::vector<std::size_t> fk_deps{index_of("CREATE TABLE \"app\".\"parent\""),
+                                     index_of("CREATE TABLE \"app\".\"child\""),
+                                     index_of("ALTER TABLE \"app\".\"parent\" ADD")};
+    std::sort(fk_deps.begin(), fk_deps.end());
+    assert(script.depends_on[index_of("ALTER TABLE \"app\".\"child\" ADD CONSTRAINT \"fk\"")] ==
+           fk_deps);
+    assert(script.depends_on[index_of("CREATE TABLE \"app\".\"parent\"")].empty());
+    for (std::size_t i = 0; i < script.depends_on.size(); ++i) {
+      for (std::size_t dep : script.depends_on[i]) assert(dep < i);
+    }
+
+    const std::string sql = script.ToSql();
+    assert(sql.rfind("-- Step 1: ", 0) == 0);
+    assert(std::count(sql.begin(), sql.end(), ';') ==
+           static_cast<long>(script.StatementCount()));
+  }
+
+  // Objects move to the target schema, bodies included
+  {
+    SchemaSnapshot source("src");
+    source.AddView(View("src", "v", "SELECT * FROM src.t JOIN other.u USING (id)", {"src.t"}));
+    const std::string sql = SchemaDiff::CreateSql(source.Objects()[0], "src", "dst");
+    assert(sql.rfind("CREATE VIEW \"dst\".\"v\"", 0) == 0);
+    assert(sql.find("FROM \"dst\".t JOIN other.u") != std::string::npos);
+  }
+
+  return 0;
+}
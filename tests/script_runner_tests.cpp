@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/script_runner.h"
+
+using scratchrobin::core::Connection;
+using scratchrobin::core::ScriptPlan;
+using scratchrobin::core::ScriptRunner;
+using scratchrobin::core::ScriptRunOptions;
+using scratchrobin::core::ScriptStatementKind;
+using scratchrobin::core::Status;
+
+namespace {
+
+bool DependsOn(const ScriptPlan& plan, std::size_t unit, std::size_t on) {
+  const auto& deps = plan.units[unit].depends_on;
+  return std::find(deps.begin(), deps.end(), on) != deps.end();
+}
+
+ScriptRunner::ConnectionFactory Factory() {
+  return [](std::string*) { return std::make_shared<Connection>(); };
+}
+
+}  // namespace
+
+int main() {
+  // Splitting skips terminators in strings, comments and bodies
+  {
+    const auto statements = ScriptRunner::Split(
+        "-- setup\n"
+        "INSERT INTO t VALUES ('a;b'); /* ; */\n"
+        "CREATE PROCEDURE p AS BEGIN UPDATE t SET a = CASE WHEN b THEN 1 END; END;\n"
+        "SET TERM ^ ;\n"
+        "CREATE TRIGGER trg FOR t AS BEGIN x = 1; END^\n"
+        "SET TERM ; ^\n"
+        "select 1");
+    assert(statements.size() == 4);
+    assert(statements[0].sql == "INSERT INTO t VALUES ('a;b')" && statements[0].line == 2);
+    assert(statements[1].sql.find("END; END") != std::string::npos);
+    assert(statements[2].sql == "CREATE TRIGGER trg FOR t AS BEGIN x = 1; END");
+    assert(statements[3].sql == "select 1" && statements[3].line == 7);
+  }
+
+  // Objects read and written
+  {
+    const auto statements = ScriptRunner::Split(
+        "INSERT INTO s.t (a) SELECT a FROM u x, \"V\" y;"
+        "CREATE INDEX i ON t (a);"
+        "DELETE FROM t WHERE id IN (SELECT id FROM w);"
+        "CREATE TABLE c (p INT REFERENCES parent (id));"
+        "SET search_path = x");
+    assert(statements[0].kind == ScriptStatementKind::kDml);
+    assert((statements[0].writes == std::vector<std::string>{"t"}));
+    assert((statements[0].reads == std::vector<std::string>{"u", "v"}));
+    assert((statements[1].writes == std::vector<std::string>{"i", "t"}));
+    assert((statements[2].writes == std::vector<std::string>{"t"}));
+    assert((statements[2].reads == std::vector<std::string>{"w"}));
+    assert((statements[3].writes == std::vector<std::string>{"c"}));
+    assert((statements[3].reads == std::vector<std::string>{"parent"}));
+    assert(statements[4].kind == ScriptStatementKind::kSession);
+  }
+
+  // Triggers write their table; WITH is classified by the verb after it
+  {
+    const auto statements = ScriptRunner::Split(
+        "CREATE TRIGGER t1 FOR a AS BEGIN FOR SELECT x FROM r INTO :v DO v = 1; END;"
+        "CREATE TRIGGER t2 BEFORE INSERT ON a FOR EACH ROW EXECUTE FUNCTION f();"
+        "WITH c AS (SELECT * FROM x) INSERT INTO b SELECT * FROM c;"
+        "WITH c AS (SELECT 1 FROM y) DELETE FROM b;"
+        "WITH c AS (SELECT 1) SELECT * FROM c;"
+        "WITH c AS (SELECT 1) CALL p()");
+    assert((statements[0].writes == std::vector<std::string>{"t1", "a"}));
+    assert((statements[0].reads == std::vector<std::string>{"r"}));
+    assert((statements[1].writes == std::vector<std::string>{"t2", "a"}));
+    assert(statements[2].kind == ScriptStatementKind::kDml);
+    assert((statements[2].writes == std::vector<std::string>{"b"}));
+    assert((statements[2].reads == std::vector<std::string>{"x", "c"}));
+    assert(statements[3].kind == ScriptStatementKind::kDml);
+    assert((statements[3].writes == std::vector<std::string>{"b"}));
+    assert((statements[3].reads == std::vector<std::string>{"y"}));
+    assert(statements[4].kind == ScriptStatementKind::kQuery);
+    assert(statements[5].kind == ScriptStatementKind::kOther);
+  }
+
+  // Dependencies, transaction units and barriers
+  {
+    const ScriptPlan plan = ScriptRunner::Plan(
+        "CREATE TABLE a (x INT);"        // 0
+        "CREATE TABLE b (x INT);"        // 1
+        "INSERT INTO a VALUES (1);"      // 2: after 0
+        "SELECT * FROM a JOIN b ON 1=1;" // 3: after 2 and 1
+        "BEGIN;"                         // 4: unit with the next three
+        "UPDATE b SET x = 2;"
+        "UPDATE c SET x = 3;"
+        "COMMIT;"
+        "SET x = 1;"                     // 5: barrier
+        "CREATE INDEX i ON c (x)");      // 6: after 5 only
+    assert(plan.units.size() == 7);
+    assert(plan.units[0].depends_on.empty() && plan.units[1].depends_on.empty());
+    assert(DependsOn(plan, 2, 0) && !DependsOn(plan, 2, 1));
+    assert(DependsOn(plan, 3, 2) && DependsOn(plan, 3, 1));
+    assert(plan.units[4].transaction && plan.units[4].statements.size() == 4);
+    assert(DependsOn(plan, 4, 3) && DependsOn(plan, 4, 1));
+    assert(plan.units[5].barrier && plan.units[5].depends_on.size() == 5);
+    assert((plan.units[6].depends_on == std::vector<std::size_t>{5}));
+  }
+
+  // Independent statements run concurrently, dependent ones in order
+  {
+    std::string script;
+    for (int i = 0; i < 40; ++i) {
+      script += "CREATE INDEX i" + std::to_string(i) + " ON t" + std::to_string(i) + " (a);";
+    }
+    script += "INSERT INTO t0 VALUES (1);";
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    std::mutex mutex;
+    std::vector<std::string> order;
+    ScriptRunner runner(Factory(), [&](Connection&, const std::string& sql, int64_t* rows) {
+      const int now = ++running;
+      int seen = peak;
+      while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(sql);
+      }
+      --running;
+      *rows = 1;
+      return Status::Ok();
+    });
+    ScriptRunOptions options;
+    options.max_parallel = 4;
+    const auto result = runner.Run(ScriptRunner::Plan(script), options);
+    assert(result.executed == 41 && result.failed == 0 && result.skipped == 0);
+    assert(result.connections <= 4 && peak > 1 && peak <= 4);
+    const auto index = std::find(order.begin(), order.end(), "CREATE INDEX i0 ON t0 (a)");
+    const auto insert = std::find(order.begin(), order.end(), "INSERT INTO t0 VALUES (1)");
+    assert(index < insert);
+  }
+
+  // Stop on error skips the rest; otherwise only dependents are skipped
+  {
+    const std::string script =
+        "CREATE TABLE a (x INT);"
+        "INSERT INTO a VALUES (1);"
+        "CREATE TABLE b (x INT);"
+        "INSERT INTO b VALUES (1)";
+    auto executor = [](Connection&, const std::string& sql, int64_t*) {
+      return sql.find("TABLE a") != std::string::npos ? Status::Error("boom") : Status::Ok();
+    };
+    ScriptRunner runner(Factory(), executor);
+    ScriptRunOptions options;
+    options.max_parallel = 1;
+    auto result = runner.Run(ScriptRunner::Plan(script), options);
+    assert(result.failed == 1 && result.executed == 1 && result.skipped == 3);
+    assert(result.statements[0].status.message == "boom");
+
+    options.stop_on_error = false;
+    result = runner.Run(ScriptRunner::Plan(script), options);
+    assert(result.failed == 1 && result.executed == 3 && result.skipped == 1);
+    assert(result.statements[1].skipped && result.statements[3].executed);
+  }
+
+  // Session statements are replayed on every connection, in order
+  {
+    std::mutex mutex;
+    std::vector<std::pair<Connection*, std::string>> calls;
+    ScriptRunner runner(Factory(), [&](Connection& connection, const std::string& sql, int64_t*) {
+      std::lock_guard<std::mutex> lock(mutex);
+      calls.emplace_back(&connection, sql);
+      return Status::Ok();
+    });
+    std::string script = "SET x = 1;";
+    for (int i = 0; i < 20; ++i) {
+      script += "UPDATE t" + std::to_string(i) + " SET a = 1;";
+    }
+    ScriptRunOptions options;
+    options.max_parallel = 3;
+    const auto result = runner.Run(ScriptRunner::Plan(script), options);
+    assert(result.executed == 21);
+    std::vector<Connection*> connections;
+    for (const auto& [connection, sql] : calls) {
+      if (std::find(connections.begin(), connections.end(), connection) == connections.end()) {
+        connections.push_back(connection);
+        assert(sql == "SET x = 1");  // First thing on each connection
+      }
+    }
+  }
+
+  // One connection runs the script in its own order, whatever the plan
+  // infers: the child row follows its parent though no name links them
+  {
+    std::vector<std::pair<Connection*, std::string>> calls;
+    ScriptRunner runner(Factory(), [&](Connection& connection, const std::string& sql, int64_t*) {
+      calls.emplace_back(&connection, sql);
+      return Status::Ok();
+    });
+    const ScriptPlan plan = ScriptRunner::Plan(
+        "INSERT INTO parent VALUES (1); INSERT INTO child VALUES (1, 1); UPDATE other SET x = 1");
+    assert(plan.units[1].depends_on.empty());  // Invisible to the plan
+    ScriptRunOptions options;
+    options.max_parallel = 1;
+    const auto result = runner.Run(plan, options);
+    assert(result.executed == 3 && result.connections == 1);
+    assert(calls.size() == 3 && calls[0].second == "INSERT INTO parent VALUES (1)" &&
+           calls[1].second == "INSERT INTO child VALUES (1, 1)");
+    assert(calls[0].first == calls[1].first && calls[1].first == calls[2].first);
+  }
+
+  // Temporary tables are session state: their DDL and users share one
+  // connection, and the DDL is not replayed on the others
+  {
+    const ScriptPlan plan = ScriptRunner::Plan(
+        "CREATE GLOBAL TEMPORARY TABLE tmp (a INT);"
+        "INSERT INTO tmp SELECT a FROM src;"
+        "UPDATE t1 SET a = 1; UPDATE t2 SET a = 1; UPDATE t3 SET a = 1;"
+        "SELECT * FROM tmp;"
+        "DROP TABLE tmp");
+    assert(plan.statements[0].kind == ScriptStatementKind::kSession &&
+           plan.statements[0].temporary);
+    assert((plan.statements[0].writes == std::vector<std::string>{"tmp"}));
+    assert(plan.units[0].barrier && plan.units[0].pinned && plan.units[1].pinned);
+    assert(!plan.units[2].pinned && plan.units[5].pinned && plan.units[6].pinned);
+
+    std::mutex mutex;
+    std::vector<std::pair<Connection*, std::string>> calls;
+    ScriptRunner runner(Factory(), [&](Connection& connection, const std::string& sql, int64_t*) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      std::lock_guard<std::mutex> lock(mutex);
+      calls.emplace_back(&connection, sql);
+      return Status::Ok();
+    });
+    ScriptRunOptions options;
+    options.max_parallel = 4;
+    const auto result = runner.Run(plan, options);
+    assert(result.executed == 7 && result.failed == 0);
+    Connection* home = nullptr;
+    int creates = 0;
+    for (const auto& [connection, sql] : calls) {
+      if (sql.find("tmp") == std::string::npos) continue;
+      if (sql.rfind("CREATE", 0) == 0) ++creates;
+      if (!home) home = connection;
+      assert(connection == home);
+    }
+    assert(creates == 1);
+  }
+
+  // A script inside the caller's transaction runs on the caller's
+  // connection, one statement at a time, and may leave the transaction open
+  {
+    auto shared = std::make_shared<Connection>();
+    std::vector<std::string> order;
+    int opened = 0;
+    ScriptRunner runner(
+        [&opened](std::string*) {
+          ++opened;
+          return std::make_shared<Connection>();
+        },
+        [&](Connection& connection, const std::string& sql, int64_t*) {
+          assert(&connection == shared.get());
+          order.push_back(sql);
+          return Status::Ok();
+        });
+    const ScriptPlan plan = ScriptRunner::Plan(
+        "UPDATE a SET x = 1; UPDATE b SET x = 1; BEGIN; UPDATE c SET x = 1");
+    assert(ScriptRunner::LeavesTransactionOpen(plan));
+    assert(!ScriptRunner::LeavesTransactionOpen(ScriptRunner::Plan("BEGIN; COMMIT")));
+    assert(!ScriptRunner::LeavesTransactionOpen(ScriptRunner::Plan("UPDATE a SET x = 1")));
+    ScriptRunOptions options;
+    options.max_parallel = 4;
+    options.connection = shared;
+    const auto result = runner.Run(plan, options);
+    assert(result.executed == 4 && result.connections == 1 && opened == 0);
+    assert((order == std::vector<std::string>{"UPDATE a SET x = 1", "UPDATE b SET x = 1",
+                                              "BEGIN", "UPDATE c SET x = 1"}));
+  }
+
+  return 0;
+}
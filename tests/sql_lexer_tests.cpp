@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/sql_lexer.h"
+
+using scratchrobin::core::SqlKeywordTable;
+using scratchrobin::core::SqlLexer;
+using scratchrobin::core::SqlLexState;
+using scratchrobin::core::SqlToken;
+using scratchrobin::core::SqlTokenArena;
+using scratchrobin::core::SqlTokenKind;
+using scratchrobin::core::SqlTokenList;
+
+namespace {
+
+std::vector<SqlTokenKind> Kinds(const std::vector<SqlToken>& tokens) {
+  std::vector<SqlTokenKind> kinds;
+  for (const auto& token : tokens) {
+    if (token.kind != SqlTokenKind::kWhitespace) {
+      kinds.push_back(token.kind);
+    }
+  }
+  return kinds;
+}
+
+// Tokens cover the text exactly, in order
+void AssertTiles(std::string_view text, const std::vector<SqlToken>& tokens) {
+  std::size_t pos = 0;
+  for (const auto& token : tokens) {
+    assert(token.offset == pos && token.length > 0);
+    pos += token.length;
+  }
+  assert(pos == text.size());
+}
+
+}  // namespace
+
+int main() {
+  // Keyword table: perfect hash, case-insensitive
+  {
+    SqlKeywordTable table({"select", "FROM", "Where", "from"});
+    assert(table.size() == 3);
+    assert(table.Contains("SELECT") && table.Contains("from") && table.Contains("wHeRe"));
+    assert(!table.Contains("SELECTS") && !table.Contains("") && !table.Contains("fro"));
+    assert(SqlKeywordTable::DefaultKeywords().Contains("select"));
+    for (const char* word : {"TABLE", "JOIN", "VARCHAR", "ORDER", "WINDOW"}) {
+      assert(SqlKeywordTable::DefaultKeywords().Contains(word));
+    }
+  }
+
+  // One pass classifies every token
+  {
+    SqlLexer lexer;
+    const std::string sql =
+        "SELECT count(*), left(name, 2), \"Order\" FROM t -- note\n"
+        "WHERE a <= 1.5e3 AND b <> 'it''s' LEFT JOIN u ON x::int = $1;";
+    const auto tokens = lexer.Lex(sql);
+    AssertTiles(sql, tokens);
+    using K = SqlTokenKind;
+    assert((Kinds(tokens) ==
+            std::vector<K>{K::kKeyword,     K::kFunction,   K::kPunctuation, K::kOperator,
+                           K::kPunctuation, K::kPunctuation, K::kFunction,   K::kPunctuation,
+                           K::kIdentifier,  K::kPunctuation, K::kNumber,     K::kPunctuation,
+                           K::kPunctuation, K::kQuotedIdentifier, K::kKeyword, K::kIdentifier,
+                           K::kComment,     K::kKeyword,    K::kIdentifier,  K::kOperator,
+                           K::kNumber,      K::kKeyword,    K::kIdentifier,  K::kOperator,
+                           K::kString,      K::kKeyword,    K::kKeyword,     K::kIdentifier,
+                           K::kKeyword,     K::kIdentifier, K::kOperator,    K::kKeyword,
+                           K::kOperator,    K::kUnknown,    K::kNumber,      K::kPunctuation}));
+  }
+
+  // Comments and strings carry over from one piece of text to the next
+  {
+    SqlLexer lexer;
+    std::vector<SqlToken> tokens;
+    SqlLexState state = lexer.Lex("SELECT 1 /* start", SqlLexState::kNormal, &tokens);
+    assert(state == SqlLexState::kBlockComment);
+    assert(tokens.back().kind == SqlTokenKind::kComment);
+
+    tokens.clear();
+    state = lexer.Lex("still comment", state, &tokens);
+    assert(state == SqlLexState::kBlockComment && tokens.size() == 1);
+
+    tokens.clear();
+    state = lexer.Lex("end */ FROM 'open", state, &tokens);
+    assert(state == SqlLexState::kString);
+    assert(tokens[0].kind == SqlTokenKind::kComment && tokens[0].length == 6);
+    assert(tokens.back().kind == SqlTokenKind::kString);
+
+    tokens.clear();
+    state = lexer.Lex("closed' x", state, &tokens);
+    assert(state == SqlLexState::kNormal);
+    assert(Kinds(tokens) == (std::vector<SqlTokenKind>{SqlTokenKind::kString,
+                                                       SqlTokenKind::kIdentifier}));
+  }
+
+  // Arena lists and single steps agree with a full lex
+  {
+    SqlLexer lexer;
+    SqlTokenArena arena;
+    const std::string sql = "select \"a\" , b.c from t where x = 'y'; -- done";
+    const SqlTokenList tokens = lexer.Lex(sql, arena);
+    const auto expected = lexer.Lex(sql);
+    assert(tokens.size() == expected.size());
+    SqlToken token;
+    lexer.Next(sql, 0, SqlLexState::kNormal, &token);
+    assert(token.Is(sql, "SELECT") && token.IsWord());
+    assert(tokens[2].Text(sql) == "\"a\"");
+    arena.Reset();
+  }
+
+  // Relex after edits matches lexing the edited text from scratch
+  {
+    SqlLexer lexer;
+    std::string sql =
+        "SELECT a, count (b) FROM t /* note */ WHERE s = 'x' -- tail\n"
+        "UPDATE u SET v = 1.5 WHERE \"Id\" <> 2;\n";
+    std::vector<SqlToken> tokens = lexer.Lex(sql);
+    const char* inserts[] = {"(", "*/", "/*", "'", "--", "\n", "x", " ", "\"", "1e"};
+    unsigned seed = 7;
+    for (int round = 0; round < 2000; ++round) {
+      seed = seed * 1103515245u + 12345u;
+      const std::size_t offset = (seed >> 8) % (sql.size() + 1);
+      const std::size_t removed = std::min<std::size_t>((seed >> 4) % 3, sql.size() - offset);
+      const std::string inserted = round % 3 == 0 ? "" : inserts[(seed >> 16) % 10];
+      sql.replace(offset, removed, inserted);
+      const std::size_t first = lexer.Relex(sql, offset, removed, inserted.size(), &tokens);
+      const auto expected = lexer.Lex(sql);
+      assert(first <= tokens.size() && tokens.size() == expected.size());
+      for (std::size_t i = 0; i < tokens.size(); ++i) {
+        assert(tokens[i].kind == expected[i].kind && tokens[i].offset == expected[i].offset &&
+               tokens[i].length == expected[i].length);
+      }
+      if (sql.size() > 400) {
+        sql.erase(200);
+        tokens = lexer.Lex(sql);
+      }
+    }
+  }
+
+  return 0;
+}
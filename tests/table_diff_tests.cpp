@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/table_diff.h"
+
+using scratchrobin::core::ResultSet;
+using scratchrobin::core::SqlTableDiffSource;
+using scratchrobin::core::Status;
+using scratchrobin::core::TableDiff;
+using scratchrobin::core::TableDiffOptions;
+using scratchrobin::core::TableDiffResult;
+using scratchrobin::core::TableDiffTable;
+using scratchrobin::core::TableRowDiffKind;
+
+namespace {
+
+using Row = std::vector<std::optional<std::string>>;  // id, name, qty
+
+// Serves the two queries a client-hashing source issues, counting the
+// table scans in |scans|
+SqlTableDiffSource::QueryFunction Serve(const std::map<int, Row>* table, int* scans) {
+  return [table, scans](const std::string& sql, ResultSet* result) {
+    result->columns = {"id", "name", "qty"};
+    result->rows.SetColumnCount(3);
+    if (sql.find("WHERE 1 = 0") != std::string::npos) {
+      return Status::Ok();
+    }
+    assert(sql == "SELECT id, name, qty FROM t");
+    ++*scans;
+    for (const auto& [id, row] : *table) {
+      for (std::size_t col = 0; col < row.size(); ++col) {
+        if (row[col]) {
+          result->rows.Column(col).AppendText(*row[col]);
+        } else {
+          result->rows.Column(col).AppendNull();
+        }
+      }
+      result->rows.EndRow();
+    }
+    return Status::Ok();
+  };
+}
+
+TableDiffResult Diff(const std::map<int, Row>& source, const std::map<int, Row>& target,
+                     const TableDiffOptions& options, int* scans = nullptr) {
+  const TableDiffTable table{"t", {"id"}, {}, ""};
+  int source_scans = 0;
+  int target_scans = 0;
+  auto source_side = std::make_shared<SqlTableDiffSource>(table, Serve(&source, &source_scans), "");
+  auto target_side = std::make_shared<SqlTableDiffSource>(table, Serve(&target, &target_scans), "");
+  TableDiff diff(source_side, target_side);
+  TableDiffResult result = diff.Run(options);
+  if (scans) {
+    *scans = std::max(source_scans, target_scans);
+  }
+  return result;
+}
+
+}  // namespace
+
+int main() {
+  // Only the chunks holding the differences are fetched
+  {
+    std::map<int, Row> source;
+    for (int id = 0; id < 20000; ++id) {
+      source[id] = {std::to_string(id), "name" + std::to_string(id), std::to_string(id % 7)};
+    }
+    std::map<int, Row> target = source;
+    target[17][1] = "changed";
+    target[4242][2] = std::nullopt;
+    target.erase(999);
+    target[20005] = {"20005", "extra", "1"};
+
+    TableDiffOptions options;
+    options.fanout = 16;
+    options.leaf_rows = 50;
+    int scans = 0;
+    const TableDiffResult result = Diff(source, target, options, &scans);
+    assert(result.status.ok && !result.cancelled);
+    assert(scans == 1);  // Every level and the row fetch come from one read
+    assert((result.columns == std::vector<std::string>{"name", "qty"}));
+    assert(result.source_rows == 20000 && result.target_rows == 20000);
+    assert(result.changed == 2 && result.source_only == 1 && result.target_only == 1);
+    assert(result.equal_rows == 20000 - 3);
+    assert(result.rows_fetched < 400 && result.levels >= 3);
+
+    assert(result.rows.size() == 4);
+    const auto& changed = result.rows[0];  // Ordered by key text: "17", "20005", "4242", "999"
+    assert(changed.kind == TableRowDiffKind::kChanged && changed.key[0] == "17");
+    assert((changed.changed_columns == std::vector<std::size_t>{0}));
+    assert(changed.source[0] == "name17" && changed.target[0] == "changed");
+    assert(result.rows[1].kind == TableRowDiffKind::kTargetOnly);
+    assert(result.rows[2].target[1] == std::nullopt);
+    assert(result.rows[3].kind == TableRowDiffKind::kSourceOnly);
+
+    // Past the levels summed during the read, chunks are summed from its
+    // row hashes, still without another query
+    options.leaf_rows = 0;
+    const TableDiffResult deep = Diff(source, target, options, &scans);
+    assert(deep.status.ok && deep.levels == 6 && scans == 1);
+    assert(deep.changed == 2 && deep.source_only == 1 && deep.target_only == 1);
+
+    const std::string script = TableDiff::SyncScript(result, "t", {"id"});
+    assert(script ==
+           "UPDATE t SET name = 'name17' WHERE id = '17';\n"
+           "DELETE FROM t WHERE id = '20005';\n"
+           "UPDATE t SET qty = '0' WHERE id = '4242';\n"
+           "INSERT INTO t (id, name, qty) VALUES ('999', 'name999', '5');\n");
+  }
+
+  // Identical tables stop after one level; ignore options apply to rows
+  {
+    std::map<int, Row> source;
+    for (int id = 0; id < 500; ++id) {
+      source[id] = {std::to_string(id), "Name", "1"};
+    }
+    TableDiffResult result = Diff(source, source, TableDiffOptions{});
+    assert(result.levels == 1 && result.rows.empty() && result.rows_fetched == 0);
+    assert(result.equal_rows == 500);
+
+    std::map<int, Row> target = source;
+    target[3][1] = " name ";
+    TableDiffOptions options;
+    options.ignore_case = true;
+    options.trim_whitespace = true;
+    result = Diff(source, target, options);
+    assert(result.rows.empty() && result.rows_fetched > 0 && result.equal_rows == 500);
+  }
+
+  // Server hashing pushes the work into the queries
+  {
+    const TableDiffTable table{"s.t", {"id"}, {"a"}, "a > 0"};
+    SqlTableDiffSource source(table, nullptr, "HASH");
+    const std::string summary = source.SummarizeSql({{1, 3}, {1, 5}}, 16);
+    assert(summary.find("MOD(diff_key_hash, 256) AS diff_bucket") != std::string::npos);
+    assert(summary.find("WHERE MOD(diff_key_hash, 16) IN (3, 5)") != std::string::npos);
+    assert(summary.find("FROM s.t WHERE a > 0") != std::string::npos);
+    const std::string fetch = source.FetchSql({{2, 7}}, 16);
+    assert(fetch.rfind("SELECT id, a FROM s.t WHERE (a > 0) AND MOD(", 0) == 0);
+    assert(fetch.find(", 256) IN (7)") != std::string::npos);
+  }
+
+  return 0;
+}
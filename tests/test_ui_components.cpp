@@ -2,15 +2,21 @@
  * @file test_ui_components.cpp
  * @brief Unit tests for UI components
  * 
- * Tests the DockWorkspace and panel management functionality.
+ * Tests the DockWorkspace and panel management functionality, the
+ * lazily populated result grid model and the on-demand catalog tree.
  */
 
 #include <QtTest/QtTest>
 #include <QObject>
 #include <QMainWindow>
 #include <QWidget>
+#include <QThreadPool>
 
+#include "core/catalog_cache.h"
+#include "core/scratchbird_catalog_client.h"
+#include "ui/catalog_tree_model.h"
 #include "ui/dock_workspace.h"
+#include "ui/result_set_model.h"
 
 using namespace scratchrobin::ui;
 
@@ -30,6 +36,15 @@ private slots:
     // DockPanel tests
     void testDockPanelLifecycle();
     void testDockPanelPersistence();
+    
+    // ResultSetModel tests
+    void testResultSetModelLazyRows();
+    void testResultSetModelStreamingBatches();
+    void testResultSetModelDeclaredTypes();
+    
+    // CatalogTreeModel tests
+    void testCatalogTreeModelLoadsOnExpand();
+    void testCatalogTreeModelDropsStaleLoads();
 
 private:
     QMainWindow* mainWindow_ = nullptr;
@@ -164,5 +179,205 @@ void TestUiComponents::testDockPanelPersistence() {
     delete panel;
 }
 
+void TestUiComponents::testResultSetModelLazyRows() {
+    scratchrobin::core::ResultSet result;
+    result.columns = {"id", "name"};
+    result.rows.SetColumnCount(2);
+    for (int i = 0; i < 10000; ++i) {
+        result.rows.Column(0).AppendInt64(i);
+        if (i % 2 == 0) {
+            result.rows.Column(1).AppendNull();
+        } else {
+            result.rows.Column(1).AppendText("row");
+        }
+        result.rows.EndRow();
+    }
+    
+    ResultSetModel model;
+    model.setResultSet(std::move(result));
+    
+    // Only the first chunk is exposed until the view asks for more
+    QVERIFY(model.rowCount() < 10000);
+    QCOMPARE(model.bufferedRowCount(), qint64(10000));
+    QCOMPARE(model.columnCount(), 2);
+    QCOMPARE(model.headerData(1, Qt::Horizontal).toString(), QString("name"));
+    QCOMPARE(model.data(model.index(3, 0)).toString(), QString("3"));
+    QCOMPARE(model.data(model.index(3, 0), Qt::EditRole).toLongLong(), 3LL);
+    QCOMPARE(model.data(model.index(2, 1)).toString(), QString("NULL"));
+    QVERIFY(!model.data(model.index(2, 1), Qt::EditRole).isValid());
+    
+    while (model.canFetchMore(QModelIndex())) {
+        model.fetchMore(QModelIndex());
+    }
+    QCOMPARE(model.rowCount(), 10000);
+    QCOMPARE(model.data(model.index(9999, 1)).toString(), QString("row"));
+}
+
+void TestUiComponents::testResultSetModelStreamingBatches() {
+    ResultSetModel model;
+    QSignalSpy spy(&model, &ResultSetModel::moreRowsRequested);
+    
+    scratchrobin::core::ResultSet first;
+    first.columns = {"v"};
+    first.rows = {{"a"}, {"b"}};
+    model.setResultSet(std::move(first));
+    model.setMoreRowsAvailable(true);
+    QCOMPARE(model.rowCount(), 2);
+    
+    // Buffer exhausted: the model asks the producer for another batch once
+    QVERIFY(model.canFetchMore(QModelIndex()));
+    model.fetchMore(QModelIndex());
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    
+    scratchrobin::core::ResultSet second;
+    second.columns = {"v"};
+    second.rows = {{"c"}};
+    model.appendBatch(std::move(second));
+    model.setMoreRowsAvailable(false);
+    QCOMPARE(model.rowCount(), 3);
+    QCOMPARE(model.data(model.index(2, 0)).toString(), QString("c"));
+}
+
+void TestUiComponents::testResultSetModelDeclaredTypes() {
+    using scratchrobin::core::ColumnType;
+    ResultSetModel model;
+    
+    // Each batch infers its own buffer types: "12" is stored as an integer
+    // and "10.5" as a double, but the grid goes by the declared types
+    scratchrobin::core::ResultSet first;
+    first.columns = {"code", "amount", "n"};
+    first.column_types = {ColumnType::kText, ColumnType::kDouble};
+    first.rows = {{"12", "1", "5"}, {"7", "2", "6"}};
+    model.setResultSet(std::move(first));
+    model.setMoreRowsAvailable(true);
+    
+    scratchrobin::core::ResultSet second;
+    second.columns = {"code", "amount", "n"};
+    second.column_types = {ColumnType::kText, ColumnType::kDouble};
+    second.rows = {{"A1", "10.5", "7.5"}};
+    model.appendBatch(std::move(second));
+    QCOMPARE(model.rowCount(), 3);
+    
+    for (int row = 0; row < 3; ++row) {
+        QCOMPARE(model.data(model.index(row, 0), Qt::EditRole).typeId(),
+                 int(QMetaType::QString));
+        QCOMPARE(model.data(model.index(row, 1), Qt::EditRole).typeId(),
+                 int(QMetaType::Double));
+    }
+    QCOMPARE(model.data(model.index(2, 1), Qt::EditRole).toDouble(), 10.5);
+    QVERIFY(!model.data(model.index(0, 0), Qt::TextAlignmentRole).isValid());
+    QVERIFY(model.data(model.index(0, 1), Qt::TextAlignmentRole).isValid());
+    
+    // An undeclared column keeps the type of its first batch; a later
+    // value that no longer fits still sorts as a number
+    QCOMPARE(model.data(model.index(0, 2), Qt::EditRole).typeId(),
+             int(QMetaType::LongLong));
+    QCOMPARE(model.data(model.index(2, 2), Qt::EditRole).toDouble(), 7.5);
+}
+
+namespace {
+
+// A catalog client served entirely from its cache: public.a, public.b
+// and sales.c, with the details of public.a already fetched
+std::shared_ptr<scratchrobin::core::ScratchBirdCatalogClient> makeCatalogClient() {
+    using scratchrobin::core::CatalogTableStamp;
+    auto client = std::make_shared<scratchrobin::core::ScratchBirdCatalogClient>();
+    auto& cache = client->Cache();
+    std::vector<CatalogTableStamp> listing;
+    for (const auto& [schema, name] : {std::pair<std::string, std::string>{"public", "a"},
+                                       {"public", "b"}, {"sales", "c"}}) {
+        CatalogTableStamp table;
+        table.schema = schema;
+        table.name = name;
+        table.object_id = schema + "." + name;
+        table.table_type = "HEAP";
+        table.stamp = "1:0:0";
+        listing.push_back(table);
+    }
+    cache.ApplyListing(listing);
+    
+    std::uint64_t version = 0;
+    cache.Find("public", "a", &version);
+    scratchrobin::core::CatalogTableDetails details;
+    details.columns.emplace_back("id", "INTEGER", false);
+    details.indexes.emplace_back("a_pk", "a", "public");
+    cache.StoreDetails("public", "a", version, details);
+    return client;
+}
+
+}  // namespace
+
+void TestUiComponents::testCatalogTreeModelLoadsOnExpand() {
+    CatalogTreeModel model;
+    QVERIFY(!model.canFetchMore(QModelIndex()));  // No client yet
+    model.setCatalogClient(makeCatalogClient());
+    
+    // Nothing is read until the root is expanded; a placeholder row stands
+    // in while the schemas load
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(model.hasChildren());
+    QVERIFY(model.canFetchMore(QModelIndex()));
+    model.fetchMore(QModelIndex());
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    QCOMPARE(model.rowCount(), 1);
+    QCOMPARE(model.data(model.index(0, 0)).toString(), QString("Loading..."));
+    QCOMPARE(model.data(model.index(0, 0), CatalogTreeModel::KindRole).toString(), QString());
+    
+    QTRY_COMPARE(model.data(model.index(0, 0)).toString(), QString("public"));
+    QCOMPARE(model.rowCount(), 2);
+    QCOMPARE(model.data(model.index(0, 1)).toString(), QString("2"));
+    QCOMPARE(model.data(model.index(1, 0)).toString(), QString("sales"));
+    
+    // Schemas and tables load the same way, one level at a time
+    const QModelIndex publicSchema = model.index(0, 0);
+    QCOMPARE(model.rowCount(publicSchema), 0);
+    QVERIFY(model.canFetchMore(publicSchema));
+    QVERIFY(model.canFetchMore(model.index(1, 0)));
+    model.fetchMore(publicSchema);
+    QCOMPARE(model.rowCount(publicSchema), 1);
+    QTRY_COMPARE(model.data(model.index(0, 0, publicSchema)).toString(), QString("a"));
+    QCOMPARE(model.rowCount(publicSchema), 2);
+    QCOMPARE(model.rowCount(model.index(1, 0)), 0);  // sales was never expanded
+    
+    const QModelIndex table = model.index(0, 0, publicSchema);
+    QCOMPARE(model.data(table, CatalogTreeModel::TableRole).toString(), QString("a"));
+    model.fetchMore(table);
+    QTRY_COMPARE(model.data(model.index(0, 0, table)).toString(), QString("id"));
+    QCOMPARE(model.rowCount(table), 2);
+    QCOMPARE(model.data(model.index(0, 1, table)).toString(), QString("INTEGER NOT NULL"));
+    QCOMPARE(model.data(model.index(1, 0, table), CatalogTreeModel::KindRole).toString(),
+             QString("index"));
+    QVERIFY(!model.canFetchMore(table));
+}
+
+void TestUiComponents::testCatalogTreeModelDropsStaleLoads() {
+    CatalogTreeModel model;
+    model.setCatalogClient(makeCatalogClient());
+    
+    // A reset while the schemas are loading frees the node they were for;
+    // the late result must be dropped rather than applied to the new tree
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 1);
+    model.reload();
+    QThreadPool::globalInstance()->waitForDone();
+    QCoreApplication::processEvents();
+    QCOMPARE(model.rowCount(), 0);
+    QVERIFY(model.canFetchMore(QModelIndex()));
+    
+    // The new tree loads normally
+    model.fetchMore(QModelIndex());
+    QTRY_COMPARE(model.rowCount(), 2);
+    QCOMPARE(model.data(model.index(0, 0)).toString(), QString("public"));
+    
+    // Likewise for a table whose schema is collapsed away by a reset
+    const QModelIndex sales = model.index(1, 0);
+    model.fetchMore(sales);
+    model.reload();
+    QThreadPool::globalInstance()->waitForDone();
+    QCoreApplication::processEvents();
+    QCOMPARE(model.rowCount(), 0);
+}
+
 QTEST_MAIN(TestUiComponents)
 #include "test_ui_components.moc"
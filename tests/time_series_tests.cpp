@@ -0,0 +1,170 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "core/time_series.h"
+
+using scratchrobin::core::TimeSeries;
+using scratchrobin::core::TimeSeriesField;
+using scratchrobin::core::TimeSeriesPoint;
+using scratchrobin::core::TimeSeriesResolution;
+using scratchrobin::core::TimeSeriesRing;
+using scratchrobin::core::TimeSeriesStore;
+
+namespace {
+
+constexpr int64_t kMinute = 60 * 1000;
+constexpr int64_t kHour = 60 * kMinute;
+constexpr int64_t kStart = 1767225600000;  // 2026-01-01, on an hour
+
+struct Sample {
+  double load = 0.0;
+  int64_t bytes = 0;
+  int threads = 0;
+};
+
+}  // namespace
+
+int main() {
+  // Points come back exactly, whatever the spacing and the values
+  {
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> real(-1e9, 1e9);
+    std::uniform_int_distribution<int64_t> gap(0, 5000);
+    TimeSeriesRing ring(3, 1000 * kHour, 1, 16);
+
+    std::vector<std::pair<int64_t, std::vector<double>>> expected;
+    int64_t time = kStart;
+    for (int i = 0; i < 1000; ++i) {
+      time += i % 50 == 0 ? 10 * kHour : gap(random);
+      std::vector<double> values = {real(random), static_cast<double>(i % 7), 0.1 * i};
+      if (i % 3 == 0) values[0] = expected.empty() ? 0.0 : expected.back().second[0];
+      if (i == 500) {
+        values[1] = -0.0;
+        values[2] = std::nan("");
+      }
+      assert(ring.Append(time, values.data()));
+      expected.emplace_back(time, values);
+    }
+    assert(!ring.Append(time - 1, expected.back().second.data()));
+    assert(ring.PointCount() == expected.size() && !ring.Evicted());
+
+    std::size_t i = 0;
+    ring.Scan(kStart, time + 1, [&](int64_t at, const double* values) {
+      assert(at == expected[i].first);
+      for (std::size_t c = 0; c < 3; ++c) {
+        const double want = expected[i].second[c];
+        assert(std::isnan(want) ? std::isnan(values[c])
+                                : values[c] == want && std::signbit(values[c]) == std::signbit(want));
+      }
+      ++i;
+    });
+    assert(i == expected.size());
+
+    // A range in the middle
+    std::size_t inside = 0;
+    ring.Scan(expected[100].first, expected[200].first, [&](int64_t at, const double*) {
+      assert(at >= expected[100].first && at < expected[200].first);
+      ++inside;
+    });
+    assert(inside >= 100);
+  }
+
+  // A week of one point a second stays bounded and small
+  {
+    TimeSeries series;
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> noise(0, 20);
+    std::size_t after_day = 0;
+    for (int64_t s = 0; s < 7 * 24 * 3600; ++s) {
+      const int64_t time = kStart + s * 1000 + (s % 10 == 0 ? 3 : 0);
+      assert(series.Append(time, 100.0 + noise(random)));
+      if (s == 3 * 24 * 3600) after_day = series.MemoryUsage();
+    }
+    const std::size_t memory = series.MemoryUsage();
+    assert(memory < 256 * 1024);
+    assert(memory <= after_day + after_day / 4);
+
+    // The last hour raw, the last two days by the minute, the rest by the hour
+    const int64_t end = kStart + 7 * 24 * kHour;
+    assert(series.Resolve(end - 30 * kMinute, TimeSeriesResolution::kAuto) ==
+           TimeSeriesResolution::kRaw);
+    assert(series.Resolve(end - 24 * kHour, TimeSeriesResolution::kAuto) ==
+           TimeSeriesResolution::kMinute);
+    assert(series.Resolve(kStart, TimeSeriesResolution::kAuto) == TimeSeriesResolution::kHour);
+
+    const auto raw = series.Range(end - 10 * kMinute, end, TimeSeriesResolution::kAuto);
+    assert(raw.size() >= 599 && raw.size() <= 600);
+    const auto hours = series.Range(kStart, end, TimeSeriesResolution::kAuto);
+    assert(hours.size() == 7 * 24);
+    for (const TimeSeriesPoint& point : hours) {
+      assert(point.count == 3600 && point.min >= 100.0 && point.max <= 120.0);
+      assert(point.value > 105.0 && point.value < 115.0);
+    }
+  }
+
+  // Rollups keep the mean, the extremes and the count
+  {
+    TimeSeries series;
+    for (int64_t s = 0; s < 150; ++s) series.Append(kStart + s * 1000, static_cast<double>(s));
+    assert(!series.Append(kStart, 1.0));
+
+    const auto minutes = series.Range(kStart, kStart + kHour, TimeSeriesResolution::kMinute);
+    assert(minutes.size() == 3);
+    assert(minutes[0].time_ms == kStart && minutes[0].count == 60);
+    assert(minutes[0].min == 0.0 && minutes[0].max == 59.0 && minutes[0].value == 29.5);
+    assert(minutes[2].count == 30 && minutes[2].max == 149.0);  // Still open
+
+    // The open hour includes the open minute
+    const auto hours = series.Range(kStart, kStart + kHour, TimeSeriesResolution::kHour);
+    assert(hours.size() == 1 && hours[0].count == 150 && hours[0].value == 74.5);
+
+    // A range starting inside a minute gets that minute
+    const auto partial =
+        series.Range(kStart + 90 * 1000, kStart + 100 * 1000, TimeSeriesResolution::kMinute);
+    assert(partial.size() == 1 && partial[0].time_ms == kStart + kMinute);
+
+    // Points under a second apart only reach the rollups
+    series.Append(kStart + 150 * 1000, 1000.0);
+    series.Append(kStart + 150 * 1000 + 200, 2000.0);
+    const auto raw = series.Range(kStart + 150 * 1000, kStart + kHour, TimeSeriesResolution::kRaw);
+    assert(raw.size() == 1 && raw[0].value == 1000.0);
+    const auto last = series.Range(kStart + 150 * 1000, kStart + kHour, TimeSeriesResolution::kMinute);
+    assert(last.back().max == 2000.0);
+  }
+
+  // A store puts rows of metrics back together
+  {
+    TimeSeriesStore store;
+    for (int64_t s = 0; s < 10; ++s) {
+      store.Append("cpu", kStart + s * 1000, static_cast<double>(s));
+      if (s % 2 == 0) store.Append("memory", kStart + s * 1000, 10.0 * static_cast<double>(s));
+    }
+    assert(store.Contains("cpu") && !store.Contains("disk"));
+    assert(store.Names().size() == 2);
+
+    const auto rows = store.Rows({"cpu", "memory", "disk"}, kStart, kStart + kHour,
+                                 TimeSeriesResolution::kAuto);
+    assert(rows.size() == 10);
+    assert(rows[4].time_ms == kStart + 4000 && rows[4].values.size() == 3);
+    assert(rows[4].values[0] == 4.0 && rows[4].values[1] == 40.0 && rows[4].values[2] == 0.0);
+    assert(rows[5].values[1] == 0.0);
+
+    // Fields of a struct go through as doubles; integers come back rounded
+    const TimeSeriesField<Sample> fields[] = {
+        {"load", &Sample::load}, {"bytes", &Sample::bytes}, {"threads", &Sample::threads}};
+    Sample sample;
+    fields[0].Set(&sample, 0.25);
+    fields[1].Set(&sample, 1e12 + 0.6);
+    fields[2].Set(&sample, 2.5);
+    assert(sample.load == 0.25 && sample.bytes == 1000000000001 && sample.threads == 3);
+    assert(fields[1].Get(sample) == 1e12 + 1);
+
+    store.Clear();
+    assert(store.Names().empty() && store.Range("cpu", 0, kStart * 2, TimeSeriesResolution::kRaw).empty());
+  }
+
+  return 0;
+}